@@ -92,6 +92,9 @@ static volatile uint32_t system_ticks;
 
 static int trigger_event_received = 0;
 
+// callbacks posted from interrupt context, protected by disabling irqs
+static btstack_linked_list_t main_thread_callbacks;
+
 /**
  * Add data_source to run_loop
  */
@@ -209,6 +212,19 @@ static void btstack_run_loop_embedded_disable_data_source_callbacks(btstack_data
 void btstack_run_loop_embedded_execute_once(void) {
     btstack_data_source_t *ds;
 
+    // process all posted callbacks, callback might post again
+    if (main_thread_callbacks){
+        hal_cpu_disable_irqs();
+        btstack_linked_item_t * callbacks = main_thread_callbacks;
+        main_thread_callbacks = NULL;
+        hal_cpu_enable_irqs();
+        while (callbacks){
+            btstack_context_callback_registration_t * callback_registration = (btstack_context_callback_registration_t *) callbacks;
+            callbacks = callbacks->next;
+            callback_registration->callback(callback_registration->context);
+        }
+    }
+
     // process data sources
     btstack_data_source_t *next;
     for (ds = (btstack_data_source_t *) data_sources; ds != NULL ; ds = next){
@@ -290,8 +306,19 @@ void btstack_run_loop_embedded_trigger(void){
     trigger_event_received = 1;
 }
 
+/**
+ * execute callback on main thread, can be called from interrupt context
+ */
+static void btstack_run_loop_embedded_execute_on_main_thread(btstack_context_callback_registration_t * callback_registration){
+    hal_cpu_disable_irqs();
+    btstack_linked_list_add_tail(&main_thread_callbacks, (btstack_linked_item_t *) callback_registration);
+    trigger_event_received = 1;
+    hal_cpu_enable_irqs();
+}
+
 static void btstack_run_loop_embedded_init(void){
     data_sources = NULL;
+    main_thread_callbacks = NULL;
 
 #ifdef TIMER_SUPPORT
     timers = NULL;
@@ -323,4 +350,5 @@ static const btstack_run_loop_t btstack_run_loop_embedded = {
     &btstack_run_loop_embedded_execute,
     &btstack_run_loop_embedded_dump_timer,
     &btstack_run_loop_embedded_get_time_ms,
+    &btstack_run_loop_embedded_execute_on_main_thread,
 };
@@ -146,6 +146,11 @@ void btstack_run_loop_freertos_execute_code_on_main_thread(void (*fn)(void *arg)
     btstack_run_loop_freertos_trigger();
 }
 
+static void btstack_run_loop_freertos_execute_on_main_thread(btstack_context_callback_registration_t * callback_registration){
+    // queue already batch-drained in btstack_run_loop_freertos_execute
+    btstack_run_loop_freertos_execute_code_on_main_thread(callback_registration->callback, callback_registration->context);
+}
+
 #if defined(HAVE_FREERTOS_TASK_NOTIFICATIONS) || (INCLUDE_xEventGroupSetBitFromISR == 1)
 void btstack_run_loop_freertos_trigger_from_isr(void){
     BaseType_t xHigherPriorityTaskWoken;
@@ -282,4 +287,5 @@ static const btstack_run_loop_t btstack_run_loop_freertos = {
     &btstack_run_loop_freertos_execute,
     &btstack_run_loop_freertos_dump_timer,
     &btstack_run_loop_freertos_get_time_ms,
+    &btstack_run_loop_freertos_execute_on_main_thread,
 };
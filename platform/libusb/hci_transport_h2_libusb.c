@@ -59,6 +59,12 @@
 #include <unistd.h>   /* UNIX standard function definitions */
 #include <sys/types.h>
 
+#ifndef _WIN32
+#include <poll.h>
+// libusb provides file descriptors for its events, which are used as run loop data sources
+#define HAVE_USB_POLLFDS
+#endif
+
 #include <libusb.h>
 
 #include "btstack_config.h"
@@ -71,12 +77,19 @@
 #define HAVE_USB_VENDOR_ID_AND_PRODUCT_ID
 #endif
 
+// default number of transfers queued for HCI Events and ACL, can be changed via hci_transport_config_usb_t
 #define ACL_IN_BUFFER_COUNT    3
 #define EVENT_IN_BUFFER_COUNT  3
 #define SCO_IN_BUFFER_COUNT   10
 
+// number of ACL transfers that can be in flight, used by send_packet_with_header
+#define ACL_OUT_BUFFER_COUNT   4
+
 #define ASYNC_POLLING_INTERVAL_MS 1
 
+// max number of file descriptors provided by libusb: event pipe, timerfd, one per device
+#define USB_MAX_POLLFDS 8
+
 //
 // Bluetooth USB Transport Alternate Settings:
 //
@@ -124,6 +137,9 @@ static const uint16_t iso_packet_size_for_alt_setting[] = {
 // prototypes
 static void dummy_handler(uint8_t packet_type, uint8_t *packet, uint16_t size); 
 static int usb_close(void);    
+#ifdef HAVE_USB_POLLFDS
+static void usb_pollfds_update_timeout(void);
+#endif
 
 typedef enum {
     LIB_USB_CLOSED = 0,
@@ -154,9 +170,9 @@ static libusb_device        * dev;
 static libusb_device_handle * handle;
 
 static struct libusb_transfer *command_out_transfer;
-static struct libusb_transfer *acl_out_transfer;
-static struct libusb_transfer *event_in_transfer[EVENT_IN_BUFFER_COUNT];
-static struct libusb_transfer *acl_in_transfer[ACL_IN_BUFFER_COUNT];
+static struct libusb_transfer *acl_out_transfers[ACL_OUT_BUFFER_COUNT];
+static struct libusb_transfer **event_in_transfer;
+static struct libusb_transfer **acl_in_transfer;
 
 #ifdef ENABLE_SCO_OVER_HCI
 
@@ -192,20 +208,36 @@ static uint16_t iso_packet_size;
 // outgoing buffer for HCI Command packets
 static uint8_t hci_cmd_buffer[3 + 256 + LIBUSB_CONTROL_SETUP_SIZE];
 
-// incoming buffer for HCI Events and ACL Packets
-static uint8_t hci_event_in_buffer[EVENT_IN_BUFFER_COUNT][HCI_ACL_BUFFER_SIZE]; // bigger than largest packet
-static uint8_t hci_acl_in_buffer[ACL_IN_BUFFER_COUNT][HCI_INCOMING_PRE_BUFFER_SIZE + HCI_ACL_BUFFER_SIZE]; 
+// outgoing buffers for ACL packets, header and payload are copied into a free one if they are not contiguous
+static uint8_t hci_acl_out_buffer[ACL_OUT_BUFFER_COUNT][HCI_ACL_BUFFER_SIZE];
+static int     acl_out_transfers_in_flight[ACL_OUT_BUFFER_COUNT];
+
+// incoming buffers for HCI Events and ACL Packets, allocated in usb_open
+static uint8_t * hci_event_in_buffer;
+static uint8_t * hci_acl_in_buffer;
+
+// receive queue configuration
+static uint16_t event_in_buffer_count = EVENT_IN_BUFFER_COUNT;
+static uint16_t event_in_buffer_size  = HCI_ACL_BUFFER_SIZE;   // bigger than largest packet
+static uint16_t acl_in_buffer_count   = ACL_IN_BUFFER_COUNT;
+static uint16_t acl_in_buffer_size    = HCI_ACL_BUFFER_SIZE;
+
+// receive queue statistics
+static uint16_t event_in_transfers_queued;
+static uint16_t acl_in_transfers_queued;
+static hci_transport_usb_stats_t usb_stats;
 
 // For (ab)use as a linked list of received packets
 static struct libusb_transfer *handle_packet;
 
 static int doing_pollfds;
-static int num_pollfds;
-static btstack_data_source_t * pollfd_data_sources;
+#ifdef HAVE_USB_POLLFDS
+static btstack_data_source_t pollfd_data_sources[USB_MAX_POLLFDS];
+#endif
 static btstack_timer_source_t usb_timer;
 static int usb_timer_active;
 
-static int usb_acl_out_active = 0;
+static int usb_acl_out_active = 0;     // number of ACL transfers in flight
 static int usb_command_active = 0;
 
 // endpoint addresses
@@ -260,6 +292,36 @@ static void queue_transfer(struct libusb_transfer *transfer){
     temp->user_data = transfer;
 }
 
+// track number of queued transfers per endpoint, count transfers that emptied the queue
+static void usb_update_in_stats(struct libusb_transfer *transfer){
+    if (transfer->endpoint == event_in_addr){
+        usb_stats.event_in_completed++;
+        if (event_in_transfers_queued) event_in_transfers_queued--;
+        if (event_in_transfers_queued == 0){
+            usb_stats.event_in_queue_empty++;
+        }
+    } else if (transfer->endpoint == acl_in_addr){
+        usb_stats.acl_in_completed++;
+        if (acl_in_transfers_queued) acl_in_transfers_queued--;
+        if (acl_in_transfers_queued == 0){
+            usb_stats.acl_in_queue_empty++;
+        }
+    }
+}
+
+static void usb_submit_in_transfer(struct libusb_transfer *transfer){
+    int r = libusb_submit_transfer(transfer);
+    if (r) {
+        log_error("Error re-submitting transfer %d", r);
+        return;
+    }
+    if (transfer->endpoint == event_in_addr){
+        event_in_transfers_queued++;
+    } else if (transfer->endpoint == acl_in_addr){
+        acl_in_transfers_queued++;
+    }
+}
+
 LIBUSB_CALL static void async_callback(struct libusb_transfer *transfer){
 
     int c;
@@ -292,14 +354,14 @@ LIBUSB_CALL static void async_callback(struct libusb_transfer *transfer){
 #endif
 
     if (libusb_state != LIB_USB_TRANSFERS_ALLOCATED) {
-        for (c=0;c<EVENT_IN_BUFFER_COUNT;c++){
+        for (c=0;c<event_in_buffer_count;c++){
             if (transfer == event_in_transfer[c]){
                 libusb_free_transfer(transfer);
                 event_in_transfer[c] = 0;
                 return;
             }
         }
-        for (c=0;c<ACL_IN_BUFFER_COUNT;c++){
+        for (c=0;c<acl_in_buffer_count;c++){
             if (transfer == acl_in_transfer[c]){
                 libusb_free_transfer(transfer);
                 acl_in_transfer[c] = 0;
@@ -322,6 +384,7 @@ LIBUSB_CALL static void async_callback(struct libusb_transfer *transfer){
     // log_info("begin async_callback endpoint %x, status %x, actual length %u", transfer->endpoint, transfer->status, transfer->actual_length );
 
     if (transfer->status == LIBUSB_TRANSFER_COMPLETED) {
+        usb_update_in_stats(transfer);
         queue_transfer(transfer);
     } else if (transfer->status == LIBUSB_TRANSFER_STALL){
         log_info("-> Transfer stalled, trying again");
@@ -380,7 +443,7 @@ static int usb_send_sco_packet(uint8_t *packet, int size){
     // log_info("H2: queued packet at index %u, num active %u", tranfer_index, sco_out_transfers_active);
 
     // notify upper stack that provided buffer can be used again
-    uint8_t event[] = { HCI_EVENT_TRANSPORT_PACKET_SENT, 0};
+    uint8_t event[] = { HCI_EVENT_TRANSPORT_PACKET_SENT, 1, HCI_SCO_DATA_PACKET};
     packet_handler(HCI_EVENT_PACKET, &event[0], sizeof(event));
 
     // and if we have more space for SCO packets
@@ -431,7 +494,7 @@ static void handle_isochronous_data(uint8_t * buffer, uint16_t size){
 static void handle_completed_transfer(struct libusb_transfer *transfer){
 
     int resubmit = 0;
-    int signal_done = 0;
+    uint8_t signal_done = 0;    // packet type of completed outgoing transfer
 
     if (transfer->endpoint == event_in_addr) {
         packet_handler(HCI_EVENT_PACKET, transfer-> buffer, transfer->actual_length);
@@ -443,11 +506,16 @@ static void handle_completed_transfer(struct libusb_transfer *transfer){
     } else if (transfer->endpoint == 0){
         // log_info("command done, size %u", transfer->actual_length);
         usb_command_active = 0;
-        signal_done = 1;
+        signal_done = HCI_COMMAND_DATA_PACKET;
     } else if (transfer->endpoint == acl_out_addr){
         // log_info("acl out done, size %u", transfer->actual_length);
-        usb_acl_out_active = 0;
-        signal_done = 1;
+        int i;
+        for (i = 0; i < ACL_OUT_BUFFER_COUNT; i++){
+            if (transfer != acl_out_transfers[i]) continue;
+            acl_out_transfers_in_flight[i] = 0;
+            usb_acl_out_active--;
+        }
+        signal_done = HCI_ACL_DATA_PACKET;
 #ifdef ENABLE_SCO_OVER_HCI
     } else if (transfer->endpoint == sco_in_addr) {
         // log_info("handle_completed_transfer for SCO IN! num packets %u", transfer->NUM_ISO_PACKETS);
@@ -493,7 +561,7 @@ static void handle_completed_transfer(struct libusb_transfer *transfer){
 
     if (signal_done){
         // notify upper stack that provided buffer can be used again
-        uint8_t event[] = { HCI_EVENT_TRANSPORT_PACKET_SENT, 0};
+        uint8_t event[] = { HCI_EVENT_TRANSPORT_PACKET_SENT, 1, signal_done};
         packet_handler(HCI_EVENT_PACKET, &event[0], sizeof(event));
     }
 
@@ -502,10 +570,7 @@ static void handle_completed_transfer(struct libusb_transfer *transfer){
     if (resubmit){
         // Re-submit transfer 
         transfer->user_data = NULL;
-        int r = libusb_submit_transfer(transfer);
-        if (r) {
-            log_error("Error re-submitting transfer %d", r);
-        }
+        usb_submit_in_transfer(transfer);
     }   
 }
 
@@ -554,6 +619,14 @@ static void usb_process_ts(btstack_timer_source_t *timer) {
     // actually handled the packet in the pollfds function
     usb_process_ds((struct btstack_data_source *) NULL, DATA_SOURCE_CALLBACK_READ);
 
+#ifdef HAVE_USB_POLLFDS
+    // only libusb timeouts are handled by the timer
+    if (doing_pollfds){
+        usb_pollfds_update_timeout();
+        return;
+    }
+#endif
+
     // Get the amount of time until next event is due
     long msec = ASYNC_POLLING_INTERVAL_MS;
 
@@ -565,6 +638,108 @@ static void usb_process_ts(btstack_timer_source_t *timer) {
     return;
 }
 
+#ifdef HAVE_USB_POLLFDS
+
+// start timer for next libusb timeout, if libusb cannot provide a timerfd
+static void usb_pollfds_update_timeout(void){
+    if (libusb_pollfds_handle_timeouts(NULL)) return;
+
+    if (usb_timer_active){
+        btstack_run_loop_remove_timer(&usb_timer);
+        usb_timer_active = 0;
+    }
+
+    struct timeval tv;
+    if (libusb_get_next_timeout(NULL, &tv) != 1) return;
+
+    // round up to next ms
+    uint32_t msec = (uint32_t) (tv.tv_sec * 1000 + (tv.tv_usec + 999) / 1000);
+    btstack_run_loop_set_timer_handler(&usb_timer, &usb_process_ts);
+    btstack_run_loop_set_timer(&usb_timer, msec);
+    btstack_run_loop_add_timer(&usb_timer);
+    usb_timer_active = 1;
+}
+
+static void usb_process_pollfd(btstack_data_source_t *ds, btstack_data_source_callback_type_t callback_type) {
+    usb_process_ds(ds, callback_type);
+    if (libusb_state != LIB_USB_TRANSFERS_ALLOCATED) return;
+    usb_pollfds_update_timeout();
+}
+
+LIBUSB_CALL static void usb_pollfd_added(int fd, short events, void * user_data){
+    UNUSED(user_data);
+    btstack_data_source_t * free_ds = NULL;
+    int i;
+    for (i = 0 ; i < USB_MAX_POLLFDS ; i++){
+        btstack_data_source_t * ds = &pollfd_data_sources[i];
+        if (ds->fd == fd) return;
+        if (ds->fd < 0 && !free_ds){
+            free_ds = ds;
+        }
+    }
+    if (!free_ds){
+        log_error("usb_pollfd_added: no data source for fd %u", fd);
+        return;
+    }
+    // on Linux, completed transfers are signalled via POLLOUT on the device file descriptor
+    uint16_t callbacks = 0;
+    if (events & POLLIN){
+        callbacks |= DATA_SOURCE_CALLBACK_READ;
+    }
+    if (events & POLLOUT){
+        callbacks |= DATA_SOURCE_CALLBACK_WRITE;
+    }
+    log_info("usb_pollfd_added: fd %u, events %x", fd, events);
+    btstack_run_loop_set_data_source_fd(free_ds, fd);
+    btstack_run_loop_set_data_source_handler(free_ds, &usb_process_pollfd);
+    btstack_run_loop_enable_data_source_callbacks(free_ds, callbacks);
+    btstack_run_loop_add_data_source(free_ds);
+}
+
+LIBUSB_CALL static void usb_pollfd_removed(int fd, void * user_data){
+    UNUSED(user_data);
+    int i;
+    for (i = 0 ; i < USB_MAX_POLLFDS ; i++){
+        btstack_data_source_t * ds = &pollfd_data_sources[i];
+        if (ds->fd != fd) continue;
+        log_info("usb_pollfd_removed: fd %u", fd);
+        btstack_run_loop_remove_data_source(ds);
+        memset(ds, 0, sizeof(btstack_data_source_t));
+        ds->fd = -1;
+        return;
+    }
+}
+
+// add libusb file descriptors as data sources and track changes
+static int usb_pollfds_start(void){
+    int i;
+    for (i = 0 ; i < USB_MAX_POLLFDS ; i++){
+        memset(&pollfd_data_sources[i], 0, sizeof(btstack_data_source_t));
+        pollfd_data_sources[i].fd = -1;
+    }
+    const struct libusb_pollfd ** pollfd = libusb_get_pollfds(NULL);
+    if (!pollfd) return -1;
+    libusb_set_pollfd_notifiers(NULL, &usb_pollfd_added, &usb_pollfd_removed, NULL);
+    for (i = 0 ; pollfd[i] ; i++){
+        usb_pollfd_added(pollfd[i]->fd, pollfd[i]->events, NULL);
+    }
+    libusb_free_pollfds(pollfd);
+    usb_pollfds_update_timeout();
+    return 0;
+}
+
+static void usb_pollfds_stop(void){
+    int i;
+    libusb_set_pollfd_notifiers(NULL, NULL, NULL, NULL);
+    for (i = 0 ; i < USB_MAX_POLLFDS ; i++){
+        btstack_data_source_t * ds = &pollfd_data_sources[i];
+        if (ds->fd < 0) continue;
+        btstack_run_loop_remove_data_source(ds);
+        ds->fd = -1;
+    }
+}
+#endif
+
 #ifndef HAVE_USB_VENDOR_ID_AND_PRODUCT_ID
 
 // list of known devices, using VendorID/ProductID tuples
@@ -908,6 +1083,34 @@ static void usb_sco_stop(void){
 
 #endif
 
+static void usb_forget_in_buffers(void){
+    event_in_transfer   = NULL;
+    acl_in_transfer     = NULL;
+    hci_event_in_buffer = NULL;
+    hci_acl_in_buffer   = NULL;
+}
+
+static void usb_free_in_buffers(void){
+    free(event_in_transfer);
+    free(acl_in_transfer);
+    free(hci_event_in_buffer);
+    free(hci_acl_in_buffer);
+    usb_forget_in_buffers();
+}
+
+static int usb_alloc_in_buffers(void){
+    log_info("receive queues: %u x %u bytes for HCI Events, %u x %u bytes for ACL", 
+        event_in_buffer_count, event_in_buffer_size, acl_in_buffer_count, acl_in_buffer_size);
+    event_in_transfer   = (struct libusb_transfer **) calloc(event_in_buffer_count, sizeof(struct libusb_transfer *));
+    acl_in_transfer     = (struct libusb_transfer **) calloc(acl_in_buffer_count,   sizeof(struct libusb_transfer *));
+    hci_event_in_buffer = (uint8_t *) malloc(event_in_buffer_count * event_in_buffer_size);
+    hci_acl_in_buffer   = (uint8_t *) malloc(acl_in_buffer_count * (HCI_INCOMING_PRE_BUFFER_SIZE + acl_in_buffer_size));
+    if (event_in_transfer && acl_in_transfer && hci_event_in_buffer && hci_acl_in_buffer) return 0;
+    log_error("failed to allocate receive buffers");
+    usb_free_in_buffers();
+    return -1;
+}
+
 static int usb_open(void){
     int r;
 
@@ -1019,16 +1222,20 @@ static int usb_open(void){
 
 #endif
     
-    // allocate transfer handlers
+    // allocate transfer handlers and receive buffers
+    if (usb_alloc_in_buffers()){
+        usb_close();
+        return LIBUSB_ERROR_NO_MEM;
+    }
     int c;
-    for (c = 0 ; c < EVENT_IN_BUFFER_COUNT ; c++) {
+    for (c = 0 ; c < event_in_buffer_count ; c++) {
         event_in_transfer[c] = libusb_alloc_transfer(0); // 0 isochronous transfers Events
         if (!event_in_transfer[c]) {
             usb_close();
             return LIBUSB_ERROR_NO_MEM;
         }
     }
-    for (c = 0 ; c < ACL_IN_BUFFER_COUNT ; c++) {
+    for (c = 0 ; c < acl_in_buffer_count ; c++) {
         acl_in_transfer[c]  =  libusb_alloc_transfer(0); // 0 isochronous transfers ACL in
         if (!acl_in_transfer[c]) {
             usb_close();
@@ -1037,64 +1244,56 @@ static int usb_open(void){
     }
 
     command_out_transfer = libusb_alloc_transfer(0);
-    acl_out_transfer     = libusb_alloc_transfer(0);
+    for (c = 0 ; c < ACL_OUT_BUFFER_COUNT ; c++) {
+        acl_out_transfers[c] = libusb_alloc_transfer(0);
+        acl_out_transfers_in_flight[c] = 0;
+    }
+    usb_acl_out_active = 0;
 
     // TODO check for error
 
     libusb_state = LIB_USB_TRANSFERS_ALLOCATED;
 
-    for (c = 0 ; c < EVENT_IN_BUFFER_COUNT ; c++) {
+    event_in_transfers_queued = 0;
+    acl_in_transfers_queued   = 0;
+    memset(&usb_stats, 0, sizeof(usb_stats));
+
+    for (c = 0 ; c < event_in_buffer_count ; c++) {
         // configure event_in handlers
         libusb_fill_interrupt_transfer(event_in_transfer[c], handle, event_in_addr, 
-                hci_event_in_buffer[c], HCI_ACL_BUFFER_SIZE, async_callback, NULL, 0) ;
+                &hci_event_in_buffer[c * event_in_buffer_size], event_in_buffer_size, async_callback, NULL, 0) ;
         r = libusb_submit_transfer(event_in_transfer[c]);
         if (r) {
             log_error("Error submitting interrupt transfer %d", r);
             usb_close();
             return r;
         }
+        event_in_transfers_queued++;
     }
 
-    for (c = 0 ; c < ACL_IN_BUFFER_COUNT ; c++) {
+    uint16_t acl_in_stride = HCI_INCOMING_PRE_BUFFER_SIZE + acl_in_buffer_size;
+    for (c = 0 ; c < acl_in_buffer_count ; c++) {
         // configure acl_in handlers
         libusb_fill_bulk_transfer(acl_in_transfer[c], handle, acl_in_addr, 
-                hci_acl_in_buffer[c] + HCI_INCOMING_PRE_BUFFER_SIZE, HCI_ACL_BUFFER_SIZE, async_callback, NULL, 0) ;
+                &hci_acl_in_buffer[c * acl_in_stride + HCI_INCOMING_PRE_BUFFER_SIZE], acl_in_buffer_size, async_callback, NULL, 0) ;
         r = libusb_submit_transfer(acl_in_transfer[c]);
         if (r) {
             log_error("Error submitting bulk in transfer %d", r);
             usb_close();
             return r;
         }
- 
+        acl_in_transfers_queued++;
      }
 
-    // Check for pollfds functionality
-    doing_pollfds = libusb_pollfds_handle_timeouts(NULL);
-    
-    // NOTE: using pollfds doesn't work on Linux, so it is disable until further investigation here
-    doing_pollfds = 0;
-
-    if (doing_pollfds) {
-        log_info("Async using pollfds:");
+#ifdef HAVE_USB_POLLFDS
+    // use libusb file descriptors as data sources, no polling required
+    if (usb_pollfds_start() == 0){
+        log_info("Async using pollfds");
+        doing_pollfds = 1;
+    }
+#endif
 
-        const struct libusb_pollfd ** pollfd = libusb_get_pollfds(NULL);
-        for (num_pollfds = 0 ; pollfd[num_pollfds] ; num_pollfds++);
-        pollfd_data_sources = (btstack_data_source_t *)malloc(sizeof(btstack_data_source_t) * num_pollfds);
-        if (!pollfd_data_sources){
-            log_error("Cannot allocate data sources for pollfds");
-            usb_close();
-            return 1;            
-        }
-        for (r = 0 ; r < num_pollfds ; r++) {
-            btstack_data_source_t *ds = &pollfd_data_sources[r];
-            btstack_run_loop_set_data_source_fd(ds, pollfd[r]->fd);
-            btstack_run_loop_set_data_source_handler(ds, &usb_process_ds);
-            btstack_run_loop_enable_data_source_callbacks(ds, DATA_SOURCE_CALLBACK_READ);
-            btstack_run_loop_add_data_source(ds);
-            log_info("%u: %p fd: %u, events %x", r, pollfd[r], pollfd[r]->fd, pollfd[r]->events);
-        }
-        free(pollfd);
-    } else {
+    if (!doing_pollfds) {
         log_info("Async using timers:");
 
         usb_timer.process = usb_process_ts;
@@ -1124,28 +1323,23 @@ static int usb_close(void){
                 usb_timer_active = 0;
             }
 
+#ifdef HAVE_USB_POLLFDS
             if (doing_pollfds){
-                int r;
-                for (r = 0 ; r < num_pollfds ; r++) {
-                    btstack_data_source_t *ds = &pollfd_data_sources[r];
-                    btstack_run_loop_remove_data_source(ds);
-                }
-                free(pollfd_data_sources);
-                pollfd_data_sources = NULL;
-                num_pollfds = 0;
+                usb_pollfds_stop();
                 doing_pollfds = 0;
             }
+#endif
 
         case LIB_USB_INTERFACE_CLAIMED:
             // Cancel all transfers, ignore warnings for this
             libusb_set_debug(NULL, LIBUSB_LOG_LEVEL_ERROR);
-            for (c = 0 ; c < EVENT_IN_BUFFER_COUNT ; c++) {
+            for (c = 0 ; event_in_transfer && c < event_in_buffer_count ; c++) {
                 if (event_in_transfer[c]){
                     log_info("cancel event_in_transfer[%u] = %p", c, event_in_transfer[c]);
                     libusb_cancel_transfer(event_in_transfer[c]);
                 }
             }
-            for (c = 0 ; c < ACL_IN_BUFFER_COUNT ; c++) {
+            for (c = 0 ; acl_in_transfer && c < acl_in_buffer_count ; c++) {
                 if (acl_in_transfer[c]){
                     log_info("cancel acl_in_transfer[%u] = %p", c, acl_in_transfer[c]);
                     libusb_cancel_transfer(acl_in_transfer[c]);
@@ -1184,7 +1378,7 @@ static int usb_close(void){
                 libusb_handle_events_timeout(NULL, &tv);
                 // check if all done
                 completed = 1;
-                for (c=0;c<EVENT_IN_BUFFER_COUNT;c++){
+                for (c=0;event_in_transfer && c<event_in_buffer_count;c++){
                     if (event_in_transfer[c]) {
                         log_info("event_in_transfer[%u] still active (%p)", c, event_in_transfer[c]);
                         completed = 0;
@@ -1194,7 +1388,7 @@ static int usb_close(void){
 
                 if (!completed) continue;
 
-                for (c=0;c<ACL_IN_BUFFER_COUNT;c++){
+                for (c=0;acl_in_transfer && c<acl_in_buffer_count;c++){
                     if (acl_in_transfer[c]) {
                         log_info("acl_in_transfer[%u] still active (%p)", c, acl_in_transfer[c]);
                         completed = 0;
@@ -1226,6 +1420,13 @@ static int usb_close(void){
 #endif
             }
 
+            // free receive buffers unless the kernel might still write into them
+            if (completed){
+                usb_free_in_buffers();
+            } else {
+                usb_forget_in_buffers();
+            }
+
             // finally release interface
             libusb_release_interface(handle, 0);
 #ifdef ENABLE_SCO_OVER_HCI
@@ -1275,25 +1476,51 @@ static int usb_send_cmd_packet(uint8_t *packet, int size){
     return 0;
 }
 
-static int usb_send_acl_packet(uint8_t *packet, int size){
+static int usb_send_acl_packet_with_header(const uint8_t * header, uint16_t header_size, const uint8_t * payload, uint16_t payload_size){
     int r;
 
     if (libusb_state != LIB_USB_TRANSFERS_ALLOCATED) return -1;
 
-    // log_info("usb_send_acl_packet enter, size %u", size);
-    
+    // log_info("usb_send_acl_packet_with_header enter, size %u", header_size + payload_size);
+
+    int size = header_size + payload_size;
+    if (size > HCI_ACL_BUFFER_SIZE){
+        log_error("usb_send_acl_packet_with_header: size %u too large", size);
+        return -1;
+    }
+
+    // find free transfer
+    int c;
+    for (c = 0 ; c < ACL_OUT_BUFFER_COUNT ; c++){
+        if (!acl_out_transfers_in_flight[c]) break;
+    }
+    if (c == ACL_OUT_BUFFER_COUNT){
+        log_error("usb_send_acl_packet_with_header: no free transfer");
+        return -1;
+    }
+
+    // send header and payload directly if contiguous, e.g. complete packets and first fragments. Otherwise,
+    // copy them into transfer buffer as libusb bulk transfers take a single buffer
+    uint8_t * buffer = (uint8_t *) header;
+    if (payload_size && payload != &header[header_size]){
+        buffer = hci_acl_out_buffer[c];
+        memcpy(buffer, header, header_size);
+        memcpy(&buffer[header_size], payload, payload_size);
+    }
+
     // prepare transfer
-    int completed = 0;
-    libusb_fill_bulk_transfer(acl_out_transfer, handle, acl_out_addr, packet, size,
-        async_callback, &completed, 0);
-    acl_out_transfer->type = LIBUSB_TRANSFER_TYPE_BULK;
+    struct libusb_transfer * transfer = acl_out_transfers[c];
+    libusb_fill_bulk_transfer(transfer, handle, acl_out_addr, buffer, size, async_callback, NULL, 0);
+    transfer->type = LIBUSB_TRANSFER_TYPE_BULK;
 
     // update stata before submitting transfer
-    usb_acl_out_active = 1;
+    acl_out_transfers_in_flight[c] = 1;
+    usb_acl_out_active++;
 
-    r = libusb_submit_transfer(acl_out_transfer);
+    r = libusb_submit_transfer(transfer);
     if (r < 0) {
-        usb_acl_out_active = 0;
+        acl_out_transfers_in_flight[c] = 0;
+        usb_acl_out_active--;
         log_error("Error submitting acl transfer, %d", r);
         return -1;
     }
@@ -1301,12 +1528,16 @@ static int usb_send_acl_packet(uint8_t *packet, int size){
     return 0;
 }
 
+static int usb_send_acl_packet(uint8_t *packet, int size){
+    return usb_send_acl_packet_with_header(packet, size, NULL, 0);
+}
+
 static int usb_can_send_packet_now(uint8_t packet_type){
     switch (packet_type){
         case HCI_COMMAND_DATA_PACKET:
             return !usb_command_active;
         case HCI_ACL_DATA_PACKET:
-            return !usb_acl_out_active;
+            return usb_acl_out_active < ACL_OUT_BUFFER_COUNT;
 #ifdef ENABLE_SCO_OVER_HCI
         case HCI_SCO_DATA_PACKET:
             return sco_ring_have_space();
@@ -1331,6 +1562,15 @@ static int usb_send_packet(uint8_t packet_type, uint8_t * packet, int size){
     }
 }
 
+static int usb_send_packet_with_header(uint8_t packet_type, const uint8_t * header, uint16_t header_size, const uint8_t * payload, uint16_t payload_size){
+    switch (packet_type){
+        case HCI_ACL_DATA_PACKET:
+            return usb_send_acl_packet_with_header(header, header_size, payload, payload_size);
+        default:
+            return -1;
+    }
+}
+
 #ifdef ENABLE_SCO_OVER_HCI
 static void usb_set_sco_config(uint16_t voice_setting, int num_connections){
     log_info("usb_set_sco_config: voice settings 0x%04x, num connections %u", voice_setting, num_connections);
@@ -1348,6 +1588,42 @@ static void usb_set_sco_config(uint16_t voice_setting, int num_connections){
 }
 #endif
 
+static void usb_init(const void *transport_config){
+    event_in_buffer_count = EVENT_IN_BUFFER_COUNT;
+    event_in_buffer_size  = HCI_ACL_BUFFER_SIZE;
+    acl_in_buffer_count   = ACL_IN_BUFFER_COUNT;
+    acl_in_buffer_size    = HCI_ACL_BUFFER_SIZE;
+
+    if (!transport_config) return;
+    const hci_transport_config_usb_t * config = (const hci_transport_config_usb_t *) transport_config;
+    if (config->type != HCI_TRANSPORT_CONFIG_USB){
+        log_error("usb_init: unexpected config type %u", (int) config->type);
+        return;
+    }
+    if (config->event_in_buffer_count) event_in_buffer_count = config->event_in_buffer_count;
+    if (config->acl_in_buffer_count)   acl_in_buffer_count   = config->acl_in_buffer_count;
+    if (config->event_in_buffer_size){
+        // HCI Events must not get truncated
+        if (config->event_in_buffer_size < HCI_EVENT_HEADER_SIZE + HCI_EVENT_PAYLOAD_SIZE){
+            log_error("usb_init: event_in_buffer_size %u too small", config->event_in_buffer_size);
+        } else {
+            event_in_buffer_size = config->event_in_buffer_size;
+        }
+    }
+    if (config->acl_in_buffer_size){
+        // HCI layer cannot handle ACL packets larger than HCI_ACL_BUFFER_SIZE
+        if (config->acl_in_buffer_size > HCI_ACL_BUFFER_SIZE){
+            log_error("usb_init: acl_in_buffer_size %u larger than HCI_ACL_BUFFER_SIZE", config->acl_in_buffer_size);
+        } else {
+            acl_in_buffer_size = config->acl_in_buffer_size;
+        }
+    }
+}
+
+void hci_transport_usb_get_stats(hci_transport_usb_stats_t * stats){
+    *stats = usb_stats;
+}
+
 static void usb_register_packet_handler(void (*handler)(uint8_t packet_type, uint8_t *packet, uint16_t size)){
     log_info("registering packet handler");
     packet_handler = handler;
@@ -1365,11 +1641,13 @@ const hci_transport_t * hci_transport_usb_instance(void) {
         hci_transport_usb = (hci_transport_t*) malloc( sizeof(hci_transport_t));
         memset(hci_transport_usb, 0, sizeof(hci_transport_t));
         hci_transport_usb->name                          = "H2_LIBUSB";
+        hci_transport_usb->init                          = usb_init;
         hci_transport_usb->open                          = usb_open;
         hci_transport_usb->close                         = usb_close;
         hci_transport_usb->register_packet_handler       = usb_register_packet_handler;
         hci_transport_usb->can_send_packet_now           = usb_can_send_packet_now;
         hci_transport_usb->send_packet                   = usb_send_packet;
+        hci_transport_usb->send_packet_with_header       = usb_send_packet_with_header;
 #ifdef ENABLE_SCO_OVER_HCI
         hci_transport_usb->set_sco_config                = usb_set_sco_config;
 #endif
@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2017 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+#define __BTSTACK_FILE__ "btstack_ring_buffer_spsc.c"
+
+/*
+ *  btstack_ring_buffer_spsc.c
+ *
+ *  Read and write index are free running and only written by their owner. Memory ordering between
+ *  payload and indices is provided by acquire/release atomics (GCC/Clang builtins)
+ */
+
+#include <string.h>
+
+#include "btstack_ring_buffer_spsc.h"
+#include "btstack_util.h"
+
+#define ERROR_CODE_MEMORY_CAPACITY_EXCEEDED 0x07
+
+int btstack_ring_buffer_spsc_init(btstack_ring_buffer_spsc_t * ring_buffer, uint8_t * storage, uint32_t storage_size){
+    // free running indices require power of two
+    if (storage_size == 0 || (storage_size & (storage_size - 1))) return -1;
+    ring_buffer->storage = storage;
+    ring_buffer->size = storage_size;
+    ring_buffer->read_index = 0;
+    ring_buffer->write_index = 0;
+    return 0;
+}
+
+uint32_t btstack_ring_buffer_spsc_bytes_available(btstack_ring_buffer_spsc_t * ring_buffer){
+    uint32_t write_index = __atomic_load_n(&ring_buffer->write_index, __ATOMIC_ACQUIRE);
+    return write_index - ring_buffer->read_index;
+}
+
+uint32_t btstack_ring_buffer_spsc_bytes_free(btstack_ring_buffer_spsc_t * ring_buffer){
+    uint32_t read_index = __atomic_load_n(&ring_buffer->read_index, __ATOMIC_ACQUIRE);
+    return ring_buffer->size - (ring_buffer->write_index - read_index);
+}
+
+uint8_t * btstack_ring_buffer_spsc_get_write_pointer(btstack_ring_buffer_spsc_t * ring_buffer, uint32_t * contiguous_bytes){
+    uint32_t offset = ring_buffer->write_index & (ring_buffer->size - 1);
+    *contiguous_bytes = btstack_min(btstack_ring_buffer_spsc_bytes_free(ring_buffer), ring_buffer->size - offset);
+    return &ring_buffer->storage[offset];
+}
+
+void btstack_ring_buffer_spsc_commit_write(btstack_ring_buffer_spsc_t * ring_buffer, uint32_t data_length){
+    __atomic_store_n(&ring_buffer->write_index, ring_buffer->write_index + data_length, __ATOMIC_RELEASE);
+}
+
+int btstack_ring_buffer_spsc_write(btstack_ring_buffer_spsc_t * ring_buffer, const uint8_t * data, uint32_t data_length){
+    if (btstack_ring_buffer_spsc_bytes_free(ring_buffer) < data_length){
+        return ERROR_CODE_MEMORY_CAPACITY_EXCEEDED;
+    }
+
+    // copy first chunk
+    uint32_t offset = ring_buffer->write_index & (ring_buffer->size - 1);
+    uint32_t bytes_to_copy = btstack_min(ring_buffer->size - offset, data_length);
+    memcpy(&ring_buffer->storage[offset], data, bytes_to_copy);
+
+    // copy second chunk
+    if (data_length > bytes_to_copy){
+        memcpy(&ring_buffer->storage[0], &data[bytes_to_copy], data_length - bytes_to_copy);
+    }
+
+    btstack_ring_buffer_spsc_commit_write(ring_buffer, data_length);
+    return 0;
+}
+
+void btstack_ring_buffer_spsc_read(btstack_ring_buffer_spsc_t * ring_buffer, uint8_t * data, uint32_t data_length, uint32_t * number_of_bytes_read){
+    // limit data to get and report
+    data_length = btstack_min(data_length, btstack_ring_buffer_spsc_bytes_available(ring_buffer));
+    *number_of_bytes_read = data_length;
+
+    if (data_length == 0) return;
+
+    // copy first chunk
+    uint32_t offset = ring_buffer->read_index & (ring_buffer->size - 1);
+    uint32_t bytes_to_copy = btstack_min(ring_buffer->size - offset, data_length);
+    memcpy(data, &ring_buffer->storage[offset], bytes_to_copy);
+
+    // copy second chunk
+    if (data_length > bytes_to_copy){
+        memcpy(&data[bytes_to_copy], &ring_buffer->storage[0], data_length - bytes_to_copy);
+    }
+
+    // release space to producer
+    __atomic_store_n(&ring_buffer->read_index, ring_buffer->read_index + data_length, __ATOMIC_RELEASE);
+}
@@ -0,0 +1,356 @@
+/*
+ * Copyright (C) 2017 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+#define __BTSTACK_FILE__ "btstack_run_loop_epoll.c"
+
+/*
+ *  btstack_run_loop_epoll.c
+ *
+ *  Run loop for Linux based on epoll. Data sources are registered with the epoll instance
+ *  when added and their interest set is updated when callbacks are enabled or disabled.
+ *  Only the data sources reported ready by epoll_wait are dispatched.
+ */
+
+#include "btstack_run_loop.h"
+#include "btstack_run_loop_epoll.h"
+#include "btstack_linked_list.h"
+#include "btstack_timer_wheel.h"
+#include "btstack_debug.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+// max number of ready events fetched per epoll_wait call
+#define MAX_EPOLL_EVENTS 64
+
+// timer wheel with 256 slots of 16 ms
+#define TIMER_WHEEL_NUM_SLOTS  256
+#define TIMER_WHEEL_SLOT_SHIFT   4
+
+static void btstack_run_loop_epoll_dump_timer(void);
+
+// the run loop
+static btstack_linked_list_t data_sources;
+static int data_sources_modified;
+static btstack_timer_wheel_t timer_wheel;
+static btstack_timer_wheel_slot_t timer_wheel_slots[TIMER_WHEEL_NUM_SLOTS];
+static int epoll_fd = -1;
+// start time. tv_usec = 0
+static struct timeval init_tv;
+// callbacks posted from other threads: lock-free stack, reversed when drained
+static btstack_context_callback_registration_t * main_thread_callbacks;
+static btstack_data_source_t main_thread_data_source;
+static int main_thread_wakeup_fd = -1;
+
+static uint32_t btstack_run_loop_epoll_events_for_flags(uint16_t flags){
+    uint32_t events = 0;
+    if (flags & DATA_SOURCE_CALLBACK_READ){
+        events |= EPOLLIN;
+    }
+    if (flags & DATA_SOURCE_CALLBACK_WRITE){
+        events |= EPOLLOUT;
+    }
+    return events;
+}
+
+static int btstack_run_loop_epoll_contains_data_source(btstack_data_source_t * ds){
+    btstack_linked_item_t *it;
+    for (it = (btstack_linked_item_t *) data_sources; it ; it = it->next){
+        if (it == (btstack_linked_item_t *) ds) return 1;
+    }
+    return 0;
+}
+
+/**
+ * Register data source with epoll or update its interest set.
+ * Data sources without read/write interest are not kept in the epoll set, as EPOLLHUP/EPOLLERR
+ * would be reported for them in every iteration.
+ */
+static void btstack_run_loop_epoll_update_data_source(btstack_data_source_t * ds){
+    if (ds->fd < 0) return;
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events   = btstack_run_loop_epoll_events_for_flags(ds->flags);
+    event.data.ptr = ds;
+
+    if (event.events == 0){
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_DEL, ds->fd, &event) < 0 && errno != ENOENT){
+            log_error("btstack_run_loop_epoll: EPOLL_CTL_DEL for fd %u failed, errno %d", ds->fd, errno);
+        }
+        return;
+    }
+
+    // common case: data source already registered
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_MOD, ds->fd, &event) == 0) return;
+    if (errno != ENOENT){
+        log_error("btstack_run_loop_epoll: EPOLL_CTL_MOD for fd %u failed, errno %d", ds->fd, errno);
+        return;
+    }
+
+    // not registered yet: only register data sources that are part of the run loop
+    if (!btstack_run_loop_epoll_contains_data_source(ds)) return;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, ds->fd, &event) < 0){
+        log_error("btstack_run_loop_epoll: EPOLL_CTL_ADD for fd %u failed, errno %d", ds->fd, errno);
+    }
+}
+
+/**
+ * Add data_source to run_loop
+ */
+static void btstack_run_loop_epoll_add_data_source(btstack_data_source_t *ds){
+    data_sources_modified = 1;
+    btstack_linked_list_add(&data_sources, (btstack_linked_item_t *) ds);
+    btstack_run_loop_epoll_update_data_source(ds);
+}
+
+/**
+ * Remove data_source from run loop
+ */
+static int btstack_run_loop_epoll_remove_data_source(btstack_data_source_t *ds){
+    data_sources_modified = 1;
+    if (ds->fd >= 0){
+        struct epoll_event event;
+        memset(&event, 0, sizeof(event));
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, ds->fd, &event);
+    }
+    return btstack_linked_list_remove(&data_sources, (btstack_linked_item_t *) ds);
+}
+
+/**
+ * Add timer to run_loop
+ */
+static void btstack_run_loop_epoll_add_timer(btstack_timer_source_t *ts){
+    btstack_timer_wheel_add(&timer_wheel, ts);
+    log_debug("Added timer %p at %u\n", ts, ts->timeout);
+}
+
+/**
+ * Remove timer from run loop
+ */
+static int btstack_run_loop_epoll_remove_timer(btstack_timer_source_t *ts){
+    return btstack_timer_wheel_remove(&timer_wheel, ts);
+}
+
+static void btstack_run_loop_epoll_dump_timer(void){
+    btstack_timer_wheel_dump(&timer_wheel);
+}
+
+static void btstack_run_loop_epoll_enable_data_source_callbacks(btstack_data_source_t * ds, uint16_t callback_types){
+    uint16_t old_flags = ds->flags;
+    ds->flags |= callback_types;
+    if (ds->flags == old_flags) return;
+    btstack_run_loop_epoll_update_data_source(ds);
+}
+
+static void btstack_run_loop_epoll_disable_data_source_callbacks(btstack_data_source_t * ds, uint16_t callback_types){
+    uint16_t old_flags = ds->flags;
+    ds->flags &= ~callback_types;
+    if (ds->flags == old_flags) return;
+    btstack_run_loop_epoll_update_data_source(ds);
+}
+
+/**
+ * @brief Queries the current time in ms since start
+ */
+static uint32_t btstack_run_loop_epoll_get_time_ms(void){
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    uint32_t time_ms = (uint32_t)((tv.tv_sec  - init_tv.tv_sec) * 1000) + (tv.tv_usec / 1000);
+    log_debug("btstack_run_loop_epoll_get_time_ms: %u <- %u / %u", time_ms, (int) tv.tv_sec, (int) tv.tv_usec);
+    return time_ms;
+}
+
+/**
+ * Execute run_loop
+ */
+static void btstack_run_loop_epoll_execute(void) {
+    struct epoll_event events[MAX_EPOLL_EVENTS];
+    btstack_timer_source_t *ts;
+    uint32_t now_ms;
+    uint32_t next_timeout_ms;
+    int timeout_ms;
+    int num_events;
+    int i;
+
+    while (1) {
+        // get next timeout
+        timeout_ms = -1;
+        if (btstack_timer_wheel_get_next_timeout(&timer_wheel, &next_timeout_ms)) {
+            now_ms = btstack_run_loop_epoll_get_time_ms();
+            int delta = next_timeout_ms - now_ms;
+            if (delta < 0){
+                delta = 0;
+            }
+            timeout_ms = delta;
+            log_debug("btstack_run_loop_execute next timeout in %u ms", delta);
+        }
+
+        // wait for ready FDs
+        num_events = epoll_wait(epoll_fd, events, MAX_EPOLL_EVENTS, timeout_ms);
+        if (num_events < 0){
+            if (errno != EINTR){
+                log_error("btstack_run_loop_epoll: epoll_wait failed, errno %d", errno);
+            }
+            num_events = 0;
+        }
+
+        // dispatch ready data sources. if a data source gets added or removed by a callback, the remaining
+        // events might refer to a removed data source. as epoll is level-triggered, they will be reported again
+        data_sources_modified = 0;
+        for (i = 0; i < num_events && !data_sources_modified; i++){
+            btstack_data_source_t *ds = (btstack_data_source_t *) events[i].data.ptr;
+            uint32_t ready = events[i].events;
+            if ((ready & (EPOLLIN | EPOLLHUP | EPOLLERR)) && (ds->flags & DATA_SOURCE_CALLBACK_READ)){
+                log_debug("btstack_run_loop_epoll_execute: process read ds %p with fd %u\n", ds, ds->fd);
+                ds->process(ds, DATA_SOURCE_CALLBACK_READ);
+            }
+            if (data_sources_modified) break;
+            if ((ready & (EPOLLOUT | EPOLLERR)) && (ds->flags & DATA_SOURCE_CALLBACK_WRITE)){
+                log_debug("btstack_run_loop_epoll_execute: process write ds %p with fd %u\n", ds, ds->fd);
+                ds->process(ds, DATA_SOURCE_CALLBACK_WRITE);
+            }
+        }
+
+        // process timers
+        now_ms = btstack_run_loop_epoll_get_time_ms();
+        // expired timers are removed before processing to allow handler to re-register with run loop
+        while ((ts = btstack_timer_wheel_pop_expired(&timer_wheel, now_ms)) != NULL) {
+            log_debug("btstack_run_loop_epoll_execute: process timer %p\n", ts);
+            ts->process(ts);
+        }
+    }
+}
+
+// set timer
+static void btstack_run_loop_epoll_set_timer(btstack_timer_source_t *a, uint32_t timeout_in_ms){
+    uint32_t time_ms = btstack_run_loop_epoll_get_time_ms();
+    a->timeout = time_ms + timeout_in_ms;
+    log_debug("btstack_run_loop_epoll_set_timer to %u ms (now %u, timeout %u)", a->timeout, time_ms, timeout_in_ms);
+}
+
+// called from any thread
+static void btstack_run_loop_epoll_execute_on_main_thread(btstack_context_callback_registration_t * callback_registration){
+    // push onto stack, callback_registration->item is used as next pointer
+    btstack_context_callback_registration_t * head = __atomic_load_n(&main_thread_callbacks, __ATOMIC_RELAXED);
+    do {
+        callback_registration->item = (btstack_linked_item_t *) head;
+    } while (!__atomic_compare_exchange_n(&main_thread_callbacks, &head, callback_registration, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+    // first callback in queue: wake up run loop
+    if (head != NULL) return;
+    uint64_t value = 1;
+    if (write(main_thread_wakeup_fd, &value, sizeof(value)) < 0 && errno != EAGAIN){
+        log_error("%s: wakeup failed, errno %d", __BTSTACK_FILE__, errno);
+    }
+}
+
+static void btstack_run_loop_epoll_process_main_thread_callbacks(btstack_data_source_t * ds, btstack_data_source_callback_type_t callback_type){
+    UNUSED(callback_type);
+    // reset eventfd
+    uint64_t value;
+    if (read(ds->fd, &value, sizeof(value)) < 0 && errno != EAGAIN){
+        log_error("%s: wakeup read failed, errno %d", __BTSTACK_FILE__, errno);
+    }
+
+    // take all queued callbacks at once and restore posting order
+    btstack_context_callback_registration_t * callbacks = __atomic_exchange_n(&main_thread_callbacks, NULL, __ATOMIC_ACQUIRE);
+    btstack_context_callback_registration_t * ordered = NULL;
+    while (callbacks){
+        btstack_context_callback_registration_t * next = (btstack_context_callback_registration_t *) callbacks->item;
+        callbacks->item = (btstack_linked_item_t *) ordered;
+        ordered = callbacks;
+        callbacks = next;
+    }
+
+    // callback might post registration again
+    while (ordered){
+        btstack_context_callback_registration_t * next = (btstack_context_callback_registration_t *) ordered->item;
+        ordered->callback(ordered->context);
+        ordered = next;
+    }
+}
+
+static void btstack_run_loop_epoll_init(void){
+    data_sources = NULL;
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd < 0){
+        log_error("btstack_run_loop_epoll: epoll_create1 failed, errno %d", errno);
+    }
+    // just assume that we started at tv_usec == 0
+    gettimeofday(&init_tv, NULL);
+    init_tv.tv_usec = 0;
+    btstack_timer_wheel_init(&timer_wheel, timer_wheel_slots, TIMER_WHEEL_NUM_SLOTS, TIMER_WHEEL_SLOT_SHIFT, btstack_run_loop_epoll_get_time_ms());
+    log_debug("btstack_run_loop_epoll_init at %u/%u", (int) init_tv.tv_sec, 0);
+
+    main_thread_callbacks = NULL;
+    main_thread_wakeup_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (main_thread_wakeup_fd < 0){
+        log_error("%s: eventfd failed, errno %d", __BTSTACK_FILE__, errno);
+    }
+    btstack_run_loop_set_data_source_fd(&main_thread_data_source, main_thread_wakeup_fd);
+    btstack_run_loop_set_data_source_handler(&main_thread_data_source, &btstack_run_loop_epoll_process_main_thread_callbacks);
+    main_thread_data_source.flags = DATA_SOURCE_CALLBACK_READ;
+    btstack_run_loop_epoll_add_data_source(&main_thread_data_source);
+}
+
+static const btstack_run_loop_t btstack_run_loop_epoll = {
+    &btstack_run_loop_epoll_init,
+    &btstack_run_loop_epoll_add_data_source,
+    &btstack_run_loop_epoll_remove_data_source,
+    &btstack_run_loop_epoll_enable_data_source_callbacks,
+    &btstack_run_loop_epoll_disable_data_source_callbacks,
+    &btstack_run_loop_epoll_set_timer,
+    &btstack_run_loop_epoll_add_timer,
+    &btstack_run_loop_epoll_remove_timer,
+    &btstack_run_loop_epoll_execute,
+    &btstack_run_loop_epoll_dump_timer,
+    &btstack_run_loop_epoll_get_time_ms,
+    &btstack_run_loop_epoll_execute_on_main_thread,
+};
+
+/**
+ * Provide btstack_run_loop_epoll instance
+ */
+const btstack_run_loop_t * btstack_run_loop_epoll_get_instance(void){
+    return &btstack_run_loop_epoll;
+}
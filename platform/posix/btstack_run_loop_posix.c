@@ -46,6 +46,7 @@
 #include "btstack_run_loop.h"
 #include "btstack_run_loop_posix.h"
 #include "btstack_linked_list.h"
+#include "btstack_timer_wheel.h"
 #include "btstack_debug.h"
 
 #ifdef _WIN32
@@ -58,14 +59,35 @@
 #include <stdlib.h>
 #include <sys/time.h>
 
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+#endif
+
+// timer wheel with 256 slots of 16 ms
+#define TIMER_WHEEL_NUM_SLOTS  256
+#define TIMER_WHEEL_SLOT_SHIFT   4
+
 static void btstack_run_loop_posix_dump_timer(void);
 
 // the run loop
 static btstack_linked_list_t data_sources;
 static int data_sources_modified;
-static btstack_linked_list_t timers;
+static btstack_timer_wheel_t timer_wheel;
+static btstack_timer_wheel_slot_t timer_wheel_slots[TIMER_WHEEL_NUM_SLOTS];
 // start time. tv_usec = 0
 static struct timeval init_tv;
+#ifndef _WIN32
+// callbacks posted from other threads: lock-free stack, reversed when drained
+static btstack_context_callback_registration_t * main_thread_callbacks;
+static btstack_data_source_t main_thread_data_source;
+// eventfd on Linux, pipe otherwise
+static int main_thread_wakeup_fds[2] = { -1, -1 };
+#endif
 
 /**
  * Add data_source to run_loop
@@ -86,42 +108,22 @@ static int btstack_run_loop_posix_remove_data_source(btstack_data_source_t *ds){
 }
 
 /**
- * Add timer to run_loop (keep list sorted)
+ * Add timer to run_loop
  */
 static void btstack_run_loop_posix_add_timer(btstack_timer_source_t *ts){
-    btstack_linked_item_t *it;
-    for (it = (btstack_linked_item_t *) &timers; it->next ; it = it->next){
-        btstack_timer_source_t * next = (btstack_timer_source_t *) it->next;
-        if (next == ts){
-            log_error( "btstack_run_loop_timer_add error: timer to add already in list!");
-            return;
-        }
-        if (next->timeout > ts->timeout) {
-            break;
-        }
-    }
-    ts->item.next = it->next;
-    it->next = (btstack_linked_item_t *) ts;
+    btstack_timer_wheel_add(&timer_wheel, ts);
     log_debug("Added timer %p at %u\n", ts, ts->timeout);
-    // btstack_run_loop_posix_dump_timer();
 }
 
 /**
  * Remove timer from run loop
  */
 static int btstack_run_loop_posix_remove_timer(btstack_timer_source_t *ts){
-    // log_info("Removed timer %x at %u\n", (int) ts, (unsigned int) ts->timeout.tv_sec);
-    // btstack_run_loop_posix_dump_timer();
-    return btstack_linked_list_remove(&timers, (btstack_linked_item_t *) ts);
+    return btstack_timer_wheel_remove(&timer_wheel, ts);
 }
 
 static void btstack_run_loop_posix_dump_timer(void){
-    btstack_linked_item_t *it;
-    int i = 0;
-    for (it = (btstack_linked_item_t *) timers; it ; it = it->next){
-        btstack_timer_source_t *ts = (btstack_timer_source_t*) it;
-        log_info("timer %u, timeout %u\n", i, ts->timeout);
-    }
+    btstack_timer_wheel_dump(&timer_wheel);
 }
 
 static void btstack_run_loop_posix_enable_data_source_callbacks(btstack_data_source_t * ds, uint16_t callback_types){
@@ -155,6 +157,7 @@ static void btstack_run_loop_posix_execute(void) {
     struct timeval * timeout;
     struct timeval tv;
     uint32_t now_ms;
+    uint32_t next_timeout_ms;
 
     while (1) {
         // collect FDs
@@ -183,11 +186,10 @@ static void btstack_run_loop_posix_execute(void) {
         
         // get next timeout
         timeout = NULL;
-        if (timers) {
-            ts = (btstack_timer_source_t *) timers;
+        if (btstack_timer_wheel_get_next_timeout(&timer_wheel, &next_timeout_ms)) {
             timeout = &tv;
             now_ms = btstack_run_loop_posix_get_time_ms();
-            int delta = ts->timeout - now_ms;
+            int delta = next_timeout_ms - now_ms;
             if (delta < 0){
                 delta = 0;
             }
@@ -218,13 +220,9 @@ static void btstack_run_loop_posix_execute(void) {
         
         // process timers
         now_ms = btstack_run_loop_posix_get_time_ms();
-        while (timers) {
-            ts = (btstack_timer_source_t *) timers;
-            if (ts->timeout > now_ms) break;
+        // expired timers are removed before processing to allow handler to re-register with run loop
+        while ((ts = btstack_timer_wheel_pop_expired(&timer_wheel, now_ms)) != NULL) {
             log_debug("btstack_run_loop_posix_execute: process timer %p\n", ts);
-            
-            // remove timer before processing it to allow handler to re-register with run loop
-            btstack_run_loop_posix_remove_timer(ts);
             ts->process(ts);
         }
     }
@@ -237,13 +235,86 @@ static void btstack_run_loop_posix_set_timer(btstack_timer_source_t *a, uint32_t
     log_debug("btstack_run_loop_posix_set_timer to %u ms (now %u, timeout %u)", a->timeout, time_ms, timeout_in_ms);
 }
 
+#ifndef _WIN32
+// called from any thread
+static void btstack_run_loop_posix_execute_on_main_thread(btstack_context_callback_registration_t * callback_registration){
+    // push onto stack, callback_registration->item is used as next pointer
+    btstack_context_callback_registration_t * head = __atomic_load_n(&main_thread_callbacks, __ATOMIC_RELAXED);
+    do {
+        callback_registration->item = (btstack_linked_item_t *) head;
+    } while (!__atomic_compare_exchange_n(&main_thread_callbacks, &head, callback_registration, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+    // first callback in queue: wake up run loop
+    if (head != NULL) return;
+#ifdef __linux__
+    uint64_t value = 1;
+#else
+    uint8_t value = 1;
+#endif
+    if (write(main_thread_wakeup_fds[1], &value, sizeof(value)) < 0 && errno != EAGAIN){
+        log_error("%s: wakeup failed, errno %d", __BTSTACK_FILE__, errno);
+    }
+}
+
+static void btstack_run_loop_posix_process_main_thread_callbacks(btstack_data_source_t * ds, btstack_data_source_callback_type_t callback_type){
+    UNUSED(callback_type);
+    // reset wakeup fd
+#ifdef __linux__
+    uint64_t value;
+    if (read(ds->fd, &value, sizeof(value)) < 0 && errno != EAGAIN){
+        log_error("%s: wakeup read failed, errno %d", __BTSTACK_FILE__, errno);
+    }
+#else
+    uint8_t buffer[16];
+    while (read(ds->fd, buffer, sizeof(buffer)) > 0);
+#endif
+
+    // take all queued callbacks at once and restore posting order
+    btstack_context_callback_registration_t * callbacks = __atomic_exchange_n(&main_thread_callbacks, NULL, __ATOMIC_ACQUIRE);
+    btstack_context_callback_registration_t * ordered = NULL;
+    while (callbacks){
+        btstack_context_callback_registration_t * next = (btstack_context_callback_registration_t *) callbacks->item;
+        callbacks->item = (btstack_linked_item_t *) ordered;
+        ordered = callbacks;
+        callbacks = next;
+    }
+
+    // callback might post registration again
+    while (ordered){
+        btstack_context_callback_registration_t * next = (btstack_context_callback_registration_t *) ordered->item;
+        ordered->callback(ordered->context);
+        ordered = next;
+    }
+}
+#endif
+
 static void btstack_run_loop_posix_init(void){
     data_sources = NULL;
-    timers = NULL;
     // just assume that we started at tv_usec == 0
     gettimeofday(&init_tv, NULL);
     init_tv.tv_usec = 0;
+    btstack_timer_wheel_init(&timer_wheel, timer_wheel_slots, TIMER_WHEEL_NUM_SLOTS, TIMER_WHEEL_SLOT_SHIFT, btstack_run_loop_posix_get_time_ms());
     log_debug("btstack_run_loop_posix_init at %u/%u", (int) init_tv.tv_sec, 0);
+
+#ifndef _WIN32
+    main_thread_callbacks = NULL;
+#ifdef __linux__
+    main_thread_wakeup_fds[0] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    main_thread_wakeup_fds[1] = main_thread_wakeup_fds[0];
+    if (main_thread_wakeup_fds[0] < 0){
+#else
+    if (pipe(main_thread_wakeup_fds) == 0){
+        fcntl(main_thread_wakeup_fds[0], F_SETFL, O_NONBLOCK);
+        fcntl(main_thread_wakeup_fds[1], F_SETFL, O_NONBLOCK);
+    } else {
+#endif
+        log_error("%s: creating wakeup fd failed, errno %d", __BTSTACK_FILE__, errno);
+    }
+    btstack_run_loop_set_data_source_fd(&main_thread_data_source, main_thread_wakeup_fds[0]);
+    btstack_run_loop_set_data_source_handler(&main_thread_data_source, &btstack_run_loop_posix_process_main_thread_callbacks);
+    main_thread_data_source.flags = DATA_SOURCE_CALLBACK_READ;
+    btstack_run_loop_posix_add_data_source(&main_thread_data_source);
+#endif
 }
 
 
@@ -259,6 +330,9 @@ static const btstack_run_loop_t btstack_run_loop_posix = {
     &btstack_run_loop_posix_execute,
     &btstack_run_loop_posix_dump_timer,
     &btstack_run_loop_posix_get_time_ms,
+#ifndef _WIN32
+    &btstack_run_loop_posix_execute_on_main_thread,
+#endif
 };
 
 /**
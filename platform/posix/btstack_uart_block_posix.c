@@ -42,6 +42,10 @@
  *
  *  Common code to access serial port via asynchronous block read/write commands
  *
+ *  With ENABLE_POSIX_UART_READER_THREAD, a dedicated thread reads from the serial port into a
+ *  lock-free ring buffer and wakes up the run loop via a pipe. Received blocks are still delivered
+ *  on the run loop thread, but reading doesn't get delayed by slow packet handlers anymore.
+ *
  */
 
 #include "btstack_uart_block.h"
@@ -57,6 +61,21 @@
 #include <sys/ioctl.h>
 #include <IOKit/serial/ioss.h>
 #endif
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <linux/serial.h>
+#endif
+
+#ifdef ENABLE_POSIX_UART_READER_THREAD
+#include <pthread.h>
+#include <poll.h>
+#include "btstack_ring_buffer_spsc.h"
+
+// size of ring buffer between reader thread and run loop, power of two
+#ifndef POSIX_UART_READER_RING_BUFFER_SIZE
+#define POSIX_UART_READER_RING_BUFFER_SIZE 65536
+#endif
+#endif
 
 // uart config
 static const btstack_uart_config_t * uart_config;
@@ -76,6 +95,26 @@ static uint8_t * read_bytes_data;
 static void (*block_sent)(void);
 static void (*block_received)(void);
 
+#ifdef ENABLE_POSIX_UART_READER_THREAD
+static pthread_t                  reader_thread;
+static int                        reader_thread_running;
+static btstack_ring_buffer_spsc_t reader_ring_buffer;
+static uint8_t                    reader_ring_buffer_storage[POSIX_UART_READER_RING_BUFFER_SIZE];
+// reader thread -> run loop: data available
+static int                        reader_wakeup_pipe[2] = { -1, -1 };
+static btstack_data_source_t      reader_data_source;
+// run loop -> reader thread: space available or stop
+static int                        reader_control_pipe[2] = { -1, -1 };
+// flags shared between threads, accessed via atomics
+static int                        reader_wakeup_pending;
+static int                        reader_waiting_for_space;
+static int                        reader_stop;
+// delivering blocks from ring buffer
+static int                        reader_delivering;
+#endif
+
+static btstack_uart_posix_reader_stats_t reader_stats;
+
 
 static int btstack_uart_posix_init(const btstack_uart_config_t * config){
     uart_config = config;
@@ -156,6 +195,169 @@ static void btstack_uart_posix_process_read(btstack_data_source_t *ds) {
     }
 }
 
+#ifdef ENABLE_POSIX_UART_READER_THREAD
+
+static void btstack_uart_posix_signal(int fd){
+    const uint8_t signal = 1;
+    if (write(fd, &signal, 1) < 0 && errno != EAGAIN){
+        log_error("signal write failed, errno %d", errno);
+    }
+}
+
+static void btstack_uart_posix_drain(int fd){
+    uint8_t buffer[16];
+    while (read(fd, buffer, sizeof(buffer)) > 0);
+}
+
+static void btstack_uart_posix_reader_wakeup_run_loop(void){
+    // only signal once until run loop has seen it
+    if (__atomic_exchange_n(&reader_wakeup_pending, 1, __ATOMIC_SEQ_CST)) return;
+    btstack_uart_posix_signal(reader_wakeup_pipe[1]);
+}
+
+static void btstack_uart_posix_reader_wait_for_space(void){
+    __atomic_fetch_add(&reader_stats.ring_buffer_full, 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&reader_waiting_for_space, 1, __ATOMIC_SEQ_CST);
+    // re-check as run loop might have consumed data before seeing the flag
+    if (btstack_ring_buffer_spsc_bytes_free(&reader_ring_buffer) == 0 && !__atomic_load_n(&reader_stop, __ATOMIC_SEQ_CST)){
+        struct pollfd control_fd = { reader_control_pipe[0], POLLIN, 0 };
+        poll(&control_fd, 1, -1);
+    }
+    __atomic_store_n(&reader_waiting_for_space, 0, __ATOMIC_SEQ_CST);
+    btstack_uart_posix_drain(reader_control_pipe[0]);
+}
+
+static void * btstack_uart_posix_reader_thread(void * context){
+    int fd = *(int *) context;
+    struct pollfd fds[2];
+    fds[0].fd = fd;
+    fds[0].events = POLLIN;
+    fds[1].fd = reader_control_pipe[0];
+    fds[1].events = POLLIN;
+    int read_failed = 0;
+
+    while (!__atomic_load_n(&reader_stop, __ATOMIC_SEQ_CST)){
+
+        // stop reading if run loop doesn't keep up. with flow control, the controller gets stopped via RTS
+        uint32_t contiguous_bytes;
+        uint8_t * buffer = btstack_ring_buffer_spsc_get_write_pointer(&reader_ring_buffer, &contiguous_bytes);
+        if (contiguous_bytes == 0){
+            btstack_uart_posix_reader_wait_for_space();
+            continue;
+        }
+
+        // after read error, wait for stop
+        int num_fds = read_failed ? 1 : 2;
+        if (poll(read_failed ? &fds[1] : fds, num_fds, -1) < 0) continue;
+        if (fds[1].revents & POLLIN){
+            btstack_uart_posix_drain(reader_control_pipe[0]);
+        }
+        if (read_failed || (fds[0].revents == 0)) continue;
+
+        ssize_t bytes_read = read(fd, buffer, contiguous_bytes);
+        if (bytes_read <= 0){
+            if (bytes_read < 0 && (errno == EAGAIN || errno == EINTR)) continue;
+            log_error("reader thread: read returned %d, errno %d", (int) bytes_read, errno);
+            read_failed = 1;
+            continue;
+        }
+        btstack_ring_buffer_spsc_commit_write(&reader_ring_buffer, (uint32_t) bytes_read);
+
+        // update stats
+        __atomic_fetch_add(&reader_stats.bytes_received, (uint32_t) bytes_read, __ATOMIC_RELAXED);
+        uint32_t used = reader_ring_buffer.size - btstack_ring_buffer_spsc_bytes_free(&reader_ring_buffer);
+        if (used > __atomic_load_n(&reader_stats.ring_buffer_max_used, __ATOMIC_RELAXED)){
+            __atomic_store_n(&reader_stats.ring_buffer_max_used, used, __ATOMIC_RELAXED);
+        }
+
+        btstack_uart_posix_reader_wakeup_run_loop();
+    }
+    return NULL;
+}
+
+// deliver requested blocks from ring buffer, runs on run loop thread
+static void btstack_uart_posix_reader_deliver(void){
+    if (reader_delivering) return;
+    reader_delivering = 1;
+    while (read_bytes_len){
+        uint32_t bytes_read;
+        btstack_ring_buffer_spsc_read(&reader_ring_buffer, read_bytes_data, read_bytes_len, &bytes_read);
+        if (bytes_read == 0) break;
+
+        // resume reader thread if it's waiting for space
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (__atomic_exchange_n(&reader_waiting_for_space, 0, __ATOMIC_SEQ_CST)){
+            btstack_uart_posix_signal(reader_control_pipe[1]);
+        }
+
+        read_bytes_len  -= bytes_read;
+        read_bytes_data += bytes_read;
+        if (read_bytes_len) break;
+
+        // block_received usually requests the next block via receive_block
+        if (block_received){
+            block_received();
+        }
+    }
+    reader_delivering = 0;
+}
+
+static void btstack_uart_posix_reader_process(btstack_data_source_t *ds, btstack_data_source_callback_type_t callback_type) {
+    UNUSED(callback_type);
+    btstack_uart_posix_drain(ds->fd);
+    // clear flag before looking at ring buffer, so new data will trigger another wakeup
+    __atomic_store_n(&reader_wakeup_pending, 0, __ATOMIC_SEQ_CST);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    __atomic_fetch_add(&reader_stats.wakeups, 1, __ATOMIC_RELAXED);
+    btstack_uart_posix_reader_deliver();
+}
+
+static int btstack_uart_posix_reader_start(void){
+    if (pipe(reader_wakeup_pipe) || pipe(reader_control_pipe)){
+        log_error("reader thread: pipe failed, errno %d", errno);
+        return -1;
+    }
+    fcntl(reader_wakeup_pipe[0],  F_SETFL, O_NONBLOCK);
+    fcntl(reader_wakeup_pipe[1],  F_SETFL, O_NONBLOCK);
+    fcntl(reader_control_pipe[0], F_SETFL, O_NONBLOCK);
+    fcntl(reader_control_pipe[1], F_SETFL, O_NONBLOCK);
+
+    btstack_ring_buffer_spsc_init(&reader_ring_buffer, reader_ring_buffer_storage, sizeof(reader_ring_buffer_storage));
+    reader_wakeup_pending    = 0;
+    reader_waiting_for_space = 0;
+    reader_stop              = 0;
+
+    btstack_run_loop_set_data_source_fd(&reader_data_source, reader_wakeup_pipe[0]);
+    btstack_run_loop_set_data_source_handler(&reader_data_source, &btstack_uart_posix_reader_process);
+    btstack_run_loop_enable_data_source_callbacks(&reader_data_source, DATA_SOURCE_CALLBACK_READ);
+    btstack_run_loop_add_data_source(&reader_data_source);
+
+    if (pthread_create(&reader_thread, NULL, &btstack_uart_posix_reader_thread, &transport_data_source.fd)){
+        log_error("reader thread: pthread_create failed");
+        return -1;
+    }
+    reader_thread_running = 1;
+    return 0;
+}
+
+static void btstack_uart_posix_reader_stop(void){
+    if (reader_thread_running){
+        __atomic_store_n(&reader_stop, 1, __ATOMIC_SEQ_CST);
+        btstack_uart_posix_signal(reader_control_pipe[1]);
+        pthread_join(reader_thread, NULL);
+        reader_thread_running = 0;
+    }
+    btstack_run_loop_remove_data_source(&reader_data_source);
+    int i;
+    for (i = 0; i < 2; i++){
+        if (reader_wakeup_pipe[i] >= 0)  close(reader_wakeup_pipe[i]);
+        if (reader_control_pipe[i] >= 0) close(reader_control_pipe[i]);
+        reader_wakeup_pipe[i]  = -1;
+        reader_control_pipe[i] = -1;
+    }
+}
+#endif
+
 static void hci_uart_posix_process(btstack_data_source_t *ds, btstack_data_source_callback_type_t callback_type) {
     if (ds->fd < 0) return;
     switch (callback_type){
@@ -355,6 +557,16 @@ static int btstack_uart_posix_open(void){
     btstack_run_loop_set_data_source_handler(&transport_data_source, &hci_uart_posix_process);
     btstack_run_loop_add_data_source(&transport_data_source);
 
+    memset(&reader_stats, 0, sizeof(reader_stats));
+
+#ifdef ENABLE_POSIX_UART_READER_THREAD
+    // reading is done by reader thread, data source is only used for writing
+    if (btstack_uart_posix_reader_start() < 0){
+        btstack_uart_posix_reader_stop();
+        return -1;
+    }
+#endif
+
     // wait a bit - at least cheap FTDI232 clones might send the first byte out incorrectly
     usleep(100000);
 
@@ -363,6 +575,11 @@ static int btstack_uart_posix_open(void){
 
 static int btstack_uart_posix_close_new(void){
 
+#ifdef ENABLE_POSIX_UART_READER_THREAD
+    // stop reader thread before closing device
+    btstack_uart_posix_reader_stop();
+#endif
+
     // first remove run loop handler
     btstack_run_loop_remove_data_source(&transport_data_source);
     
@@ -393,6 +610,13 @@ static void btstack_uart_posix_send_block(const uint8_t *data, uint16_t size){
 static void btstack_uart_posix_receive_block(uint8_t *buffer, uint16_t len){
     read_bytes_data = buffer;
     read_bytes_len = len;
+#ifdef ENABLE_POSIX_UART_READER_THREAD
+    // data already buffered: deliver from run loop, unless we're already delivering
+    if (!reader_delivering && btstack_ring_buffer_spsc_bytes_available(&reader_ring_buffer)){
+        btstack_uart_posix_reader_wakeup_run_loop();
+    }
+    return;
+#endif
     btstack_run_loop_enable_data_source_callbacks(&transport_data_source, DATA_SOURCE_CALLBACK_READ);
 
     // go
@@ -420,6 +644,27 @@ static const btstack_uart_block_t btstack_uart_posix = {
     /* void (*set_wakeup_handler)(void (*handler)(void)); */          NULL,
 };
 
+void btstack_uart_block_posix_get_reader_stats(btstack_uart_posix_reader_stats_t * stats){
+#ifdef ENABLE_POSIX_UART_READER_THREAD
+    stats->bytes_received       = __atomic_load_n(&reader_stats.bytes_received,       __ATOMIC_RELAXED);
+    stats->wakeups              = __atomic_load_n(&reader_stats.wakeups,              __ATOMIC_RELAXED);
+    stats->ring_buffer_full     = __atomic_load_n(&reader_stats.ring_buffer_full,     __ATOMIC_RELAXED);
+    stats->ring_buffer_max_used = __atomic_load_n(&reader_stats.ring_buffer_max_used, __ATOMIC_RELAXED);
+#else
+    memset(stats, 0, sizeof(btstack_uart_posix_reader_stats_t));
+#endif
+    stats->uart_overrun        = 0;
+    stats->uart_buffer_overrun = 0;
+#if defined(__linux__) && defined(TIOCGICOUNT)
+    // not supported by all drivers, e.g. pseudo terminals
+    struct serial_icounter_struct icount;
+    if (transport_data_source.fd >= 0 && ioctl(transport_data_source.fd, TIOCGICOUNT, &icount) == 0){
+        stats->uart_overrun        = icount.overrun;
+        stats->uart_buffer_overrun = icount.buf_overrun;
+    }
+#endif
+}
+
 const btstack_uart_block_t * btstack_uart_block_posix_instance(void){
 	return &btstack_uart_posix;
 }
@@ -39,6 +39,7 @@
 
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "ble/att_db.h"
@@ -73,10 +74,59 @@ static uint16_t att_prepare_write_error_handle = 0x0000;
 
 static btstack_linked_list_t service_handlers;
 
+// optional tables generated by compile_gatt.py --dispatch-table
+static const uint16_t                * att_db_offsets;
+static uint16_t                        att_db_num_offsets;
+static const att_db_dispatch_entry_t * att_db_dispatch_table;
+static uint16_t                        att_db_dispatch_table_size;
+
+#ifdef ENABLE_ATT_DB_INDEX
+
+// ATT DB Index: handle -> offset, uuid16 -> handles, service group ranges
+// attributes with 128-bit UUIDs that are not based on the Bluetooth Base UUID are listed with uuid16 = 0
+
+#define ATT_DB_INDEX_INVALID_OFFSET 0xffff
+
+typedef struct {
+    uint16_t uuid16;
+    uint16_t handle;
+} att_db_index_uuid_t;
+
+typedef struct {
+    uint16_t start_handle;
+    uint16_t end_handle;
+} att_db_index_service_t;
+
+// ATT DB Index Storage
+#ifndef HAVE_MALLOC
+#ifdef MAX_ATT_DB_INDEX_ATTRIBUTES
+static uint16_t               att_db_index_offsets_storage[MAX_ATT_DB_INDEX_ATTRIBUTES];
+static att_db_index_uuid_t    att_db_index_uuids_storage[MAX_ATT_DB_INDEX_ATTRIBUTES];
+static att_db_index_service_t att_db_index_services_storage[MAX_ATT_DB_INDEX_ATTRIBUTES];
+#else
+#error ENABLE_ATT_DB_INDEX requires either HAVE_MALLOC or MAX_ATT_DB_INDEX_ATTRIBUTES
+#endif
+#endif
+
+static int                      att_db_index_valid;
+static uint16_t                 att_db_index_num_handles;      // size of offsets table, indexed by handle - 1
+static uint16_t                 att_db_index_num_attributes;
+static uint16_t                 att_db_index_num_services;
+static uint16_t               * att_db_index_offsets;
+static att_db_index_uuid_t    * att_db_index_uuids;             // sorted by uuid16, then handle
+static att_db_index_service_t * att_db_index_services;          // sorted by start handle
+#endif
+
 // new java-style iterator
 typedef struct att_iterator {
     // private
     uint8_t const * att_ptr;
+#ifdef ENABLE_ATT_DB_INDEX
+    // walk attributes listed in uuid index instead of complete db
+    uint8_t  uuid_index_active;
+    uint16_t uuid_index_pos;
+    uint16_t uuid_index_key;
+#endif
     // public
     uint16_t size;
     uint16_t flags;
@@ -88,13 +138,28 @@ typedef struct att_iterator {
 
 static void att_iterator_init(att_iterator_t *it){
     it->att_ptr = att_db;
+#ifdef ENABLE_ATT_DB_INDEX
+    it->uuid_index_active = 0;
+#endif
 }
 
 static int att_iterator_has_next(att_iterator_t *it){
+#ifdef ENABLE_ATT_DB_INDEX
+    if (it->uuid_index_active){
+        if (it->uuid_index_pos >= att_db_index_num_attributes) return 0;
+        return att_db_index_uuids[it->uuid_index_pos].uuid16 == it->uuid_index_key;
+    }
+#endif
     return it->att_ptr != NULL;
 }
 
 static void att_iterator_fetch_next(att_iterator_t *it){
+#ifdef ENABLE_ATT_DB_INDEX
+    if (it->uuid_index_active){
+        uint16_t handle = att_db_index_uuids[it->uuid_index_pos++].handle;
+        it->att_ptr = &att_db[att_db_index_offsets[handle - 1]];
+    }
+#endif
     it->size   = little_endian_read_16(it->att_ptr, 0);
     if (it->size == 0){
         it->flags = 0;
@@ -145,8 +210,184 @@ static int att_iterator_match_uuid(att_iterator_t *it, uint8_t *uuid, uint16_t u
 }
 
 
+static void att_iterator_fetch_at_offset(att_iterator_t *it, uint16_t offset){
+    att_iterator_init(it);
+    it->att_ptr = &att_db[offset];
+    att_iterator_fetch_next(it);
+}
+
+#ifdef ENABLE_ATT_DB_INDEX
+
+static uint16_t att_db_index_uuid16_for_attribute(att_iterator_t *it){
+    if ((it->flags & ATT_PROPERTY_UUID128) == 0) return little_endian_read_16(it->uuid, 0);
+    if (!is_Bluetooth_Base_UUID(it->uuid)) return 0;
+    return little_endian_read_16(it->uuid, 12);
+}
+
+static int att_db_index_uuid_less(const att_db_index_uuid_t * a, const att_db_index_uuid_t * b){
+    if (a->uuid16 != b->uuid16) return a->uuid16 < b->uuid16;
+    return a->handle < b->handle;
+}
+
+static int att_db_index_allocate(void){
+#ifdef HAVE_MALLOC
+    free(att_db_index_offsets);
+    free(att_db_index_uuids);
+    free(att_db_index_services);
+    att_db_index_offsets  = (uint16_t *) malloc(att_db_index_num_handles * sizeof(uint16_t));
+    att_db_index_uuids    = (att_db_index_uuid_t *) malloc(att_db_index_num_attributes * sizeof(att_db_index_uuid_t));
+    att_db_index_services = (att_db_index_service_t *) malloc(att_db_index_num_services * sizeof(att_db_index_service_t));
+    return att_db_index_offsets && att_db_index_uuids && (att_db_index_services || att_db_index_num_services == 0);
+#else
+    if (att_db_index_num_handles    > MAX_ATT_DB_INDEX_ATTRIBUTES) return 0;
+    if (att_db_index_num_attributes > MAX_ATT_DB_INDEX_ATTRIBUTES) return 0;
+    att_db_index_offsets  = att_db_index_offsets_storage;
+    att_db_index_uuids    = att_db_index_uuids_storage;
+    att_db_index_services = att_db_index_services_storage;
+    return 1;
+#endif
+}
+
+static void att_db_index_build(void){
+    att_db_index_valid = 0;
+    att_db_index_num_handles = 0;
+    att_db_index_num_attributes = 0;
+    att_db_index_num_services = 0;
+    if (!att_db) return;
+
+    // count attributes and services, index requires ascending handles
+    att_iterator_t it;
+    att_iterator_init(&it);
+    while (att_iterator_has_next(&it)){
+        att_iterator_fetch_next(&it);
+        if (it.handle == 0) break;
+        if (it.handle <= att_db_index_num_handles || (it.att_ptr - att_db) >= ATT_DB_INDEX_INVALID_OFFSET){
+            log_error("att_db_index: handle 0x%04x not supported, index disabled", it.handle);
+            return;
+        }
+        att_db_index_num_handles = it.handle;
+        att_db_index_num_attributes++;
+        if (att_iterator_match_uuid16(&it, GATT_PRIMARY_SERVICE_UUID) || att_iterator_match_uuid16(&it, GATT_SECONDARY_SERVICE_UUID)){
+            att_db_index_num_services++;
+        }
+    }
+    if (att_db_index_num_attributes == 0) return;
+
+    if (!att_db_index_allocate()){
+        log_error("att_db_index: not enough memory for %u attributes, index disabled", att_db_index_num_attributes);
+        return;
+    }
+
+    // fill tables
+    memset(att_db_index_offsets, 0xff, att_db_index_num_handles * sizeof(uint16_t));
+    uint16_t num_uuids = 0;
+    uint16_t num_services = 0;
+    uint16_t prev_handle = 0;
+    att_iterator_init(&it);
+    while (att_iterator_has_next(&it)){
+        uint16_t offset = it.att_ptr - att_db;
+        att_iterator_fetch_next(&it);
+        if (it.handle == 0) break;
+        att_db_index_offsets[it.handle - 1] = offset;
+        att_db_index_uuids[num_uuids].uuid16 = att_db_index_uuid16_for_attribute(&it);
+        att_db_index_uuids[num_uuids].handle = it.handle;
+        num_uuids++;
+        if (att_iterator_match_uuid16(&it, GATT_PRIMARY_SERVICE_UUID) || att_iterator_match_uuid16(&it, GATT_SECONDARY_SERVICE_UUID)){
+            if (num_services){
+                att_db_index_services[num_services-1].end_handle = prev_handle;
+            }
+            att_db_index_services[num_services].start_handle = it.handle;
+            num_services++;
+        }
+        prev_handle = it.handle;
+    }
+    if (num_services){
+        att_db_index_services[num_services-1].end_handle = prev_handle;
+    }
+
+    // sort uuid index, attributes are already ordered by handle, so insertion sort keeps handle order for same uuid16
+    int i;
+    for (i = 1; i < att_db_index_num_attributes; i++){
+        att_db_index_uuid_t entry = att_db_index_uuids[i];
+        int j = i;
+        while (j > 0 && att_db_index_uuid_less(&entry, &att_db_index_uuids[j-1])){
+            att_db_index_uuids[j] = att_db_index_uuids[j-1];
+            j--;
+        }
+        att_db_index_uuids[j] = entry;
+    }
+
+    att_db_index_valid = 1;
+    log_info("att_db_index: %u attributes, %u services, max handle 0x%04x", att_db_index_num_attributes, att_db_index_num_services, att_db_index_num_handles);
+}
+
+// returns position of first entry with uuid16 >= key and handle >= start_handle
+static uint16_t att_db_index_lower_bound_uuid(uint16_t uuid16, uint16_t start_handle){
+    att_db_index_uuid_t key = { uuid16, start_handle };
+    uint16_t low  = 0;
+    uint16_t high = att_db_index_num_attributes;
+    while (low < high){
+        uint16_t mid = (low + high) / 2;
+        if (att_db_index_uuid_less(&att_db_index_uuids[mid], &key)){
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+// returns position of first service with start handle >= start_handle
+static uint16_t att_db_index_lower_bound_service(uint16_t start_handle){
+    uint16_t low  = 0;
+    uint16_t high = att_db_index_num_services;
+    while (low < high){
+        uint16_t mid = (low + high) / 2;
+        if (att_db_index_services[mid].start_handle < start_handle){
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+static void att_db_index_fetch_handle(att_iterator_t *it, uint16_t handle){
+    att_iterator_fetch_at_offset(it, att_db_index_offsets[handle - 1]);
+}
+#endif
+
+// iterate over attributes with given type starting at start_handle. without index, all attributes are visited
+static void att_iterator_init_for_uuid(att_iterator_t *it, uint16_t start_handle, uint8_t * uuid, uint16_t uuid_len){
+    att_iterator_init(it);
+#ifdef ENABLE_ATT_DB_INDEX
+    if (!att_db_index_valid) return;
+    it->uuid_index_active = 1;
+    it->uuid_index_key = uuid16_from_uuid(uuid_len, uuid);
+    it->uuid_index_pos = att_db_index_lower_bound_uuid(it->uuid_index_key, start_handle);
+#else
+    UNUSED(start_handle);
+    UNUSED(uuid);
+    UNUSED(uuid_len);
+#endif
+}
+
 static int att_find_handle(att_iterator_t *it, uint16_t handle){
     if (handle == 0) return 0;
+    if (att_db_offsets){
+        if (handle > att_db_num_offsets) return 0;
+        if (att_db_offsets[handle - 1] == 0xffff) return 0;
+        att_iterator_fetch_at_offset(it, att_db_offsets[handle - 1]);
+        return 1;
+    }
+#ifdef ENABLE_ATT_DB_INDEX
+    if (att_db_index_valid){
+        if (handle > att_db_index_num_handles) return 0;
+        if (att_db_index_offsets[handle - 1] == ATT_DB_INDEX_INVALID_OFFSET) return 0;
+        att_db_index_fetch_handle(it, handle);
+        return 1;
+    }
+#endif
     att_iterator_init(it);
     while (att_iterator_has_next(it)){
         att_iterator_fetch_next(it);
@@ -180,6 +421,57 @@ static att_write_callback_t att_write_callback_for_handle(uint16_t handle){
     return att_write_callback;
 }
 
+static const att_db_dispatch_entry_t * att_dispatch_entry_for_handle(uint16_t handle){
+    uint16_t low  = 0;
+    uint16_t high = att_db_dispatch_table_size;
+    while (low < high){
+        uint16_t mid = (low + high) / 2;
+        uint16_t mid_handle = att_db_dispatch_table[mid].handle;
+        if (mid_handle == handle) return &att_db_dispatch_table[mid];
+        if (mid_handle < handle){
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return NULL;
+}
+
+// dynamic attributes: dispatch table, then service handlers, then default callbacks
+static int att_has_read_handler(uint16_t handle){
+    const att_db_dispatch_entry_t * entry = att_dispatch_entry_for_handle(handle);
+    if (entry) return entry->read_handler != NULL;
+    return att_read_callback_for_handle(handle) != NULL;
+}
+
+static uint16_t att_read_dynamic(hci_con_handle_t con_handle, uint16_t handle, uint16_t offset, uint8_t * buffer, uint16_t buffer_size){
+    const att_db_dispatch_entry_t * entry = att_dispatch_entry_for_handle(handle);
+    if (entry){
+        if (!entry->read_handler) return 0;
+        return (*entry->read_handler)(con_handle, offset, buffer, buffer_size);
+    }
+    att_read_callback_t callback = att_read_callback_for_handle(handle);
+    if (!callback) return 0;
+    return (*callback)(con_handle, handle, offset, buffer, buffer_size);
+}
+
+static int att_has_write_handler(uint16_t handle){
+    const att_db_dispatch_entry_t * entry = att_dispatch_entry_for_handle(handle);
+    if (entry) return entry->write_handler != NULL;
+    return att_write_callback_for_handle(handle) != NULL;
+}
+
+static int att_write_dynamic(hci_con_handle_t con_handle, uint16_t handle, uint16_t transaction_mode, uint16_t offset, uint8_t * buffer, uint16_t buffer_size){
+    const att_db_dispatch_entry_t * entry = att_dispatch_entry_for_handle(handle);
+    if (entry){
+        if (!entry->write_handler) return 0;
+        return (*entry->write_handler)(con_handle, transaction_mode, offset, buffer, buffer_size);
+    }
+    att_write_callback_t callback = att_write_callback_for_handle(handle);
+    if (!callback) return 0;
+    return (*callback)(con_handle, handle, transaction_mode, offset, buffer, buffer_size);
+}
+
 // experimental client API
 uint16_t att_uuid_for_handle(uint16_t attribute_handle){
     att_iterator_t it;
@@ -192,9 +484,8 @@ uint16_t att_uuid_for_handle(uint16_t attribute_handle){
 
 static void att_update_value_len(att_iterator_t *it, hci_con_handle_t con_handle){
     if ((it->flags & ATT_PROPERTY_DYNAMIC) == 0) return;
-    att_read_callback_t callback = att_read_callback_for_handle(it->handle);
-    if (!callback) return;
-    it->value_len = (*callback)(con_handle, it->handle, 0, NULL, 0);
+    if (!att_has_read_handler(it->handle)) return;
+    it->value_len = att_read_dynamic(con_handle, it->handle, 0, NULL, 0);
     return;
 }
 
@@ -203,9 +494,7 @@ static int att_copy_value(att_iterator_t *it, uint16_t offset, uint8_t * buffer,
     
     // DYNAMIC 
     if (it->flags & ATT_PROPERTY_DYNAMIC){
-        att_read_callback_t callback = att_read_callback_for_handle(it->handle);
-        if (!callback) return 0;
-        return (*callback)(con_handle, it->handle, offset, buffer, buffer_size);
+        return att_read_dynamic(con_handle, it->handle, offset, buffer, buffer_size);
     }
     
     // STATIC
@@ -219,6 +508,23 @@ static int att_copy_value(att_iterator_t *it, uint16_t offset, uint8_t * buffer,
 
 void att_set_db(uint8_t const * db){
     att_db = db;
+    att_db_offsets = NULL;
+    att_db_num_offsets = 0;
+    att_db_dispatch_table = NULL;
+    att_db_dispatch_table_size = 0;
+#ifdef ENABLE_ATT_DB_INDEX
+    att_db_index_build();
+#endif
+}
+
+void att_set_db_offsets(const uint16_t * offsets, uint16_t num_handles){
+    att_db_offsets = offsets;
+    att_db_num_offsets = num_handles;
+}
+
+void att_set_db_dispatch_table(const att_db_dispatch_entry_t * table, uint16_t num_entries){
+    att_db_dispatch_table = table;
+    att_db_dispatch_table_size = num_entries;
 }
 
 void att_set_read_callback(att_read_callback_t callback){
@@ -513,7 +819,7 @@ static uint16_t handle_read_by_type_request2(att_connection_t * att_connection,
     uint16_t pair_len = 0;
 
     att_iterator_t it;
-    att_iterator_init(&it);
+    att_iterator_init_for_uuid(&it, start_handle, attribute_type, attribute_type_len);
     uint8_t error_code = 0;
     uint16_t first_matching_but_unreadable_handle = 0;
 
@@ -787,6 +1093,84 @@ static uint16_t handle_read_multiple_request(att_connection_t * att_connection,
 //  confidential information, and therefore the Service and Characteristic Discovery procedures
 //  shall always be permitted. " 
 //
+#ifdef ENABLE_ATT_DB_INDEX
+// range scan over precomputed service groups, same results as linear scan in handle_read_by_group_type_request2:
+// a group is reported if the attribute after its last attribute (next service declaration or end of db) is within range
+static uint16_t handle_read_by_group_type_request_indexed(uint8_t * response_buffer, uint16_t response_buffer_size,
+                                            uint16_t start_handle, uint16_t end_handle,
+                                            uint16_t attribute_type_len, uint8_t * attribute_type){
+
+    uint8_t request_type = ATT_READ_BY_GROUP_TYPE_REQUEST;
+    uint16_t offset   = 1;
+    uint16_t pair_len = 0;
+    uint16_t in_group = 0;
+    uint16_t group_start_handle = 0;
+    uint8_t const * group_start_value = NULL;
+
+    att_iterator_t it;
+    uint16_t i = att_db_index_lower_bound_service(start_handle);
+    for (; i < att_db_index_num_services; i++){
+        att_db_index_service_t * service = &att_db_index_services[i];
+        if (service->start_handle > end_handle) break;
+
+        // close current group
+        if (in_group){
+            little_endian_store_16(response_buffer, offset, group_start_handle);
+            offset += 2;
+            little_endian_store_16(response_buffer, offset, att_db_index_services[i-1].end_handle);
+            offset += 2;
+            memcpy(response_buffer + offset, group_start_value, pair_len - 4);
+            offset += pair_len - 4;
+            in_group = 0;
+
+            // check if space for another handle pair available
+            if (offset + pair_len > response_buffer_size){
+                break;
+            }
+        }
+
+        att_db_index_fetch_handle(&it, service->start_handle);
+        if (!att_iterator_match_uuid(&it, attribute_type, attribute_type_len)) continue;
+
+        // check if value has same len as last one
+        uint16_t this_pair_len = 4 + it.value_len;
+        if (offset > 1){
+            if (this_pair_len != pair_len) {
+                break;
+            }
+        }
+
+        // first
+        if (offset == 1) {
+            pair_len = this_pair_len;
+            response_buffer[offset] = this_pair_len;
+            offset++;
+        }
+
+        group_start_handle = it.handle;
+        group_start_value  = it.value;
+        in_group = 1;
+    }
+
+    // close last group if end of db is within range
+    if (in_group && i == att_db_index_num_services && att_db_index_num_handles <= end_handle){
+        little_endian_store_16(response_buffer, offset, group_start_handle);
+        offset += 2;
+        little_endian_store_16(response_buffer, offset, att_db_index_services[i-1].end_handle);
+        offset += 2;
+        memcpy(response_buffer + offset, group_start_value, pair_len - 4);
+        offset += pair_len - 4;
+    }
+
+    if (offset == 1){
+        return setup_error_atribute_not_found(response_buffer, request_type, start_handle);
+    }
+
+    response_buffer[0] = ATT_READ_BY_GROUP_TYPE_RESPONSE;
+    return offset;
+}
+#endif
+
 static uint16_t handle_read_by_group_type_request2(att_connection_t * att_connection, uint8_t * response_buffer, uint16_t response_buffer_size,
                                             uint16_t start_handle, uint16_t end_handle,
                                             uint16_t attribute_type_len, uint8_t * attribute_type){
@@ -807,6 +1191,12 @@ static uint16_t handle_read_by_group_type_request2(att_connection_t * att_connec
         return setup_error(response_buffer, request_type, start_handle, ATT_ERROR_UNSUPPORTED_GROUP_TYPE);
     }
 
+#ifdef ENABLE_ATT_DB_INDEX
+    if (att_db_index_valid){
+        return handle_read_by_group_type_request_indexed(response_buffer, response_buffer_size, start_handle, end_handle, attribute_type_len, attribute_type);
+    }
+#endif
+
     uint16_t offset   = 1;
     uint16_t pair_len = 0;
     uint16_t in_group = 0;
@@ -906,8 +1296,7 @@ static uint16_t handle_write_request(att_connection_t * att_connection, uint8_t
     if (!ok) {
         return setup_error_invalid_handle(response_buffer, request_type, handle);
     }
-    att_write_callback_t callback = att_write_callback_for_handle(handle);
-    if (!callback) {
+    if (!att_has_write_handler(handle)) {
         return setup_error_write_not_permitted(response_buffer, request_type, handle);
     }
     if ((it.flags & ATT_PROPERTY_WRITE) == 0) {
@@ -921,7 +1310,7 @@ static uint16_t handle_write_request(att_connection_t * att_connection, uint8_t
     if (error_code) {
         return setup_error(response_buffer, request_type, handle, error_code);
     }
-    error_code = (*callback)(att_connection->con_handle, handle, ATT_TRANSACTION_MODE_NONE, 0, request_buffer + 3, request_len - 3);
+    error_code = att_write_dynamic(att_connection->con_handle, handle, ATT_TRANSACTION_MODE_NONE, 0, request_buffer + 3, request_len - 3);
     if (error_code) {
         return setup_error(response_buffer, request_type, handle, error_code);
     }
@@ -940,8 +1329,7 @@ static uint16_t handle_prepare_write_request(att_connection_t * att_connection,
 
     uint16_t handle = little_endian_read_16(request_buffer, 1);
     uint16_t offset = little_endian_read_16(request_buffer, 3);
-    att_write_callback_t callback = att_write_callback_for_handle(handle);
-    if (!callback) {
+    if (!att_has_write_handler(handle)) {
         return setup_error_write_not_permitted(response_buffer, request_type, handle);
     }
     att_iterator_t it;
@@ -961,7 +1349,7 @@ static uint16_t handle_prepare_write_request(att_connection_t * att_connection,
         return setup_error(response_buffer, request_type, handle, error_code);
     }
 
-    error_code = (*callback)(att_connection->con_handle, handle, ATT_TRANSACTION_MODE_ACTIVE, offset, request_buffer + 5, request_len - 5);
+    error_code = att_write_dynamic(att_connection->con_handle, handle, ATT_TRANSACTION_MODE_ACTIVE, offset, request_buffer + 5, request_len - 5);
     switch (error_code){
         case 0:
             break;
@@ -982,6 +1370,11 @@ static uint16_t handle_prepare_write_request(att_connection_t * att_connection,
 
 static void att_notify_write_callbacks(att_connection_t * att_connection, uint16_t transaction_mode){
     // notify all 
+    uint16_t i;
+    for (i = 0; i < att_db_dispatch_table_size; i++){
+        if (!att_db_dispatch_table[i].write_handler) continue;
+        (*att_db_dispatch_table[i].write_handler)(att_connection->con_handle, transaction_mode, 0, NULL, 0);
+    }
     btstack_linked_list_iterator_t it;
     btstack_linked_list_iterator_init(&it, &service_handlers);
     while (btstack_linked_list_iterator_has_next(&it)){
@@ -995,6 +1388,12 @@ static void att_notify_write_callbacks(att_connection_t * att_connection, uint16
 
 // returns first reported error or 0
 static uint8_t att_validate_prepared_write(att_connection_t * att_connection){
+    uint16_t i;
+    for (i = 0; i < att_db_dispatch_table_size; i++){
+        if (!att_db_dispatch_table[i].write_handler) continue;
+        uint8_t error_code = (*att_db_dispatch_table[i].write_handler)(att_connection->con_handle, ATT_TRANSACTION_MODE_VALIDATE, 0, NULL, 0);
+        if (error_code) return error_code;
+    }
     btstack_linked_list_iterator_t it;
     btstack_linked_list_iterator_init(&it, &service_handlers);
     while (btstack_linked_list_iterator_has_next(&it)){
@@ -1054,8 +1453,7 @@ static void handle_write_command(att_connection_t * att_connection, uint8_t * re
     UNUSED(response_buffer_size);
 
     uint16_t handle = little_endian_read_16(request_buffer, 1);
-    att_write_callback_t callback = att_write_callback_for_handle(handle);
-    if (!callback) return;
+    if (!att_has_write_handler(handle)) return;
 
     att_iterator_t it;
     int ok = att_find_handle(&it, handle);
@@ -1063,7 +1461,7 @@ static void handle_write_command(att_connection_t * att_connection, uint8_t * re
     if ((it.flags & ATT_PROPERTY_DYNAMIC) == 0) return;
     if ((it.flags & ATT_PROPERTY_WRITE_WITHOUT_RESPONSE) == 0) return;
     if (att_validate_security(att_connection, &it)) return;
-    (*callback)(att_connection->con_handle, handle, ATT_TRANSACTION_MODE_NONE, 0, request_buffer + 3, request_len - 3);
+    att_write_dynamic(att_connection->con_handle, handle, ATT_TRANSACTION_MODE_NONE, 0, request_buffer + 3, request_len - 3);
 }
 
 // MARK: helper for ATT_HANDLE_VALUE_NOTIFICATION and ATT_HANDLE_VALUE_INDICATION
@@ -1182,6 +1580,21 @@ int gatt_server_get_get_handle_range_for_service_with_uuid16(uint16_t uuid16, ui
     int attribute_len = sizeof(attribute_value);
     little_endian_store_16(attribute_value, 0, uuid16);
 
+#ifdef ENABLE_ATT_DB_INDEX
+    if (att_db_index_valid){
+        att_iterator_t service_it;
+        uint16_t i;
+        for (i = 0; i < att_db_index_num_services; i++){
+            att_db_index_fetch_handle(&service_it, att_db_index_services[i].start_handle);
+            if (attribute_len != service_it.value_len || memcmp(attribute_value, service_it.value, service_it.value_len) != 0) continue;
+            *start_handle = att_db_index_services[i].start_handle;
+            *end_handle   = att_db_index_services[i].end_handle;
+            return 1;
+        }
+        return 0;
+    }
+#endif
+
     att_iterator_t it;
     att_iterator_init(&it);
     while (att_iterator_has_next(&it)){
@@ -1209,8 +1622,10 @@ int gatt_server_get_get_handle_range_for_service_with_uuid16(uint16_t uuid16, ui
 
 // returns 0 if not found
 uint16_t gatt_server_get_value_handle_for_characteristic_with_uuid16(uint16_t start_handle, uint16_t end_handle, uint16_t uuid16){
+    uint8_t attribute_type[2];
+    little_endian_store_16(attribute_type, 0, uuid16);
     att_iterator_t it;
-    att_iterator_init(&it);
+    att_iterator_init_for_uuid(&it, start_handle, attribute_type, sizeof(attribute_type));
     while (att_iterator_has_next(&it)){
         att_iterator_fetch_next(&it);
         if (it.handle && it.handle < start_handle) continue;
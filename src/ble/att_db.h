@@ -101,13 +101,45 @@ typedef struct att_service_handler {
   att_write_callback_t write_callback;
 } att_service_handler_t;
 
+// Read Handler for a single dynamic attribute, e.g. from dispatch table generated by compile_gatt.py
+// same as att_read_callback_t without attribute_handle
+typedef uint16_t (*att_db_read_handler_t)(hci_con_handle_t con_handle, uint16_t offset, uint8_t * buffer, uint16_t buffer_size);
+
+// Write Handler for a single dynamic attribute, e.g. from dispatch table generated by compile_gatt.py
+// same as att_write_callback_t without attribute_handle
+typedef int (*att_db_write_handler_t)(hci_con_handle_t con_handle, uint16_t transaction_mode, uint16_t offset, uint8_t *buffer, uint16_t buffer_size);
+
+// Read & Write Handlers for a single attribute handle
+typedef struct {
+  uint16_t handle;
+  att_db_read_handler_t  read_handler;
+  att_db_write_handler_t write_handler;
+} att_db_dispatch_entry_t;
+
 // MARK: ATT Operations
 
 /*
  * @brief setup ATT database
+ * @note With ENABLE_ATT_DB_INDEX, a lookup index is built here. Call again after the database was modified.
  */
 void att_set_db(uint8_t const * db);
 
+/*
+ * @brief set table with offset of each attribute in ATT database, indexed by handle - 1, generated by compile_gatt.py --dispatch-table
+ * @note must be called after att_set_db or att_server_init
+ * @param offsets
+ * @param num_handles
+ */
+void att_set_db_offsets(const uint16_t * offsets, uint16_t num_handles);
+
+/*
+ * @brief set table of read and write handlers for dynamic attributes sorted by handle, generated by compile_gatt.py --dispatch-table
+ * @note must be called after att_set_db or att_server_init. Handlers in the table take precedence over service handlers and read/write callbacks
+ * @param table
+ * @param num_entries
+ */
+void att_set_db_dispatch_table(const att_db_dispatch_entry_t * table, uint16_t num_entries);
+
 /*
  * @brief set callback for read of dynamic attributes
  * @param callback
@@ -74,24 +74,58 @@ static btstack_packet_handler_t               att_client_packet_handler = NULL;
 static btstack_linked_list_t                  can_send_now_clients;
 static uint8_t                                att_client_waiting_for_can_send;
 
+// round-robin over connections with validated requests
+static hci_con_handle_t                       att_server_last_served_con_handle = HCI_CON_HANDLE_INVALID;
+
+#ifdef ENABLE_ATT_SERVER_NOTIFICATION_QUEUE
+// queued notifications and can send now clients take turns, set if queued notifications were sent last
+static uint8_t                                att_server_notifications_sent_last;
+#endif
+
+#ifdef ENABLE_LE_SIGNED_WRITE
+// connection with signed write in validation, sm cmac engine is used by one connection at a time
+static hci_con_handle_t                       att_server_signed_write_con_handle = HCI_CON_HANDLE_INVALID;
+#endif
+
 static att_server_t * att_server_for_handle(hci_con_handle_t con_handle){
     hci_connection_t * hci_connection = hci_connection_for_handle(con_handle);
     if (!hci_connection) return NULL;
     return &hci_connection->att_server;
 }
 
-#ifdef ENABLE_LE_SIGNED_WRITE
-static att_server_t * att_server_for_state(att_server_state_t state){
+// returns next connection in given state after the last served one
+static att_server_t * att_server_next_for_state(att_server_state_t state){
+    att_server_t * first = NULL;
+    att_server_t * last_served = NULL;
+    int last_served_found = 0;
     btstack_linked_list_iterator_t it;
     hci_connections_get_iterator(&it);
     while(btstack_linked_list_iterator_has_next(&it)){
         hci_connection_t * connection = (hci_connection_t *) btstack_linked_list_iterator_next(&it);
         att_server_t * att_server = &connection->att_server;
-        if (att_server->state == state) return att_server;
+        if (connection->con_handle == att_server_last_served_con_handle){
+            last_served_found = 1;
+            if (att_server->state == state){
+                last_served = att_server;
+            }
+            continue;
+        }
+        if (att_server->state != state) continue;
+        if (last_served_found) return att_server;
+        if (!first){
+            first = att_server;
+        }
     }
-    return NULL;
+    if (first) return first;
+    return last_served;
+}
+
+// resume request that waits for user authorization or pairing
+static void att_server_resume_authorization(att_server_t * att_server){
+    if (att_server->state != ATT_SERVER_W4_AUTHORIZATION) return;
+    att_server->state = ATT_SERVER_REQUEST_RECEIVED_AND_VALIDATED;
+    att_dispatch_server_request_can_send_now_event(att_server->connection.con_handle);
 }
-#endif
 
 static void att_handle_value_indication_notify_client(uint8_t status, uint16_t client_handle, uint16_t attribute_handle){
     if (!att_client_packet_handler) return;
@@ -170,6 +204,11 @@ static void att_event_packet_handler (uint8_t packet_type, uint16_t channel, uin
                             att_server->connection.authenticated = 0;
 		                	att_server->connection.authorized = 0;
                             att_server->ir_le_device_db_index = -1;
+#ifdef ENABLE_ATT_SERVER_NOTIFICATION_QUEUE
+                            att_server->notification_queue_head = 0;
+                            att_server->notification_queue_count = 0;
+                            memset(&att_server->notification_stats, 0, sizeof(att_server_notification_stats_t));
+#endif
                             break;
 
                         default:
@@ -185,6 +224,7 @@ static void att_event_packet_handler (uint8_t packet_type, uint16_t channel, uin
                     if (!att_server) break;
                 	att_server->connection.encryption_key_size = sm_encryption_key_size(con_handle);
                 	att_server->connection.authenticated = sm_authenticated(con_handle);
+                    att_server_resume_authorization(att_server);
                 	break;
 
                 case HCI_EVENT_DISCONNECTION_COMPLETE:
@@ -193,6 +233,10 @@ static void att_event_packet_handler (uint8_t packet_type, uint16_t channel, uin
                     att_server = att_server_for_handle(con_handle);
                     if (!att_server) break;
                     att_clear_transaction_queue(&att_server->connection);
+#ifdef ENABLE_ATT_SERVER_NOTIFICATION_QUEUE
+                    att_server->notification_stats.dropped += att_server->notification_queue_count;
+                    att_server->notification_queue_count = 0;
+#endif
                     att_server->connection.con_handle = 0;
                     att_server->value_indication_handle = 0; // reset error state
                     att_server->state = ATT_SERVER_IDLE;
@@ -228,7 +272,7 @@ static void att_event_packet_handler (uint8_t packet_type, uint16_t channel, uin
                     att_server = att_server_for_handle(con_handle);
                     if (!att_server) break;
                     att_server->connection.authorized = sm_event_authorization_result_get_authorization_result(packet);
-                    att_dispatch_server_request_can_send_now_event(con_handle);
+                    att_server_resume_authorization(att_server);
                 	break;
                 }
                 default:
@@ -241,11 +285,7 @@ static void att_event_packet_handler (uint8_t packet_type, uint16_t channel, uin
 }
 
 #ifdef ENABLE_LE_SIGNED_WRITE
-static void att_signed_write_handle_cmac_result(uint8_t hash[8]){
-    
-    att_server_t * att_server = att_server_for_state(ATT_SERVER_W4_SIGNED_WRITE_VALIDATION);
-    if (!att_server) return;
-
+static void att_signed_write_validate(att_server_t * att_server, uint8_t hash[8]){
     uint8_t hash_flipped[8];
     reverse_64(hash, hash_flipped);
     if (memcmp(hash_flipped, &att_server->request_buffer[att_server->request_size-8], 8)){
@@ -261,6 +301,20 @@ static void att_signed_write_handle_cmac_result(uint8_t hash[8]){
     att_server->state = ATT_SERVER_REQUEST_RECEIVED_AND_VALIDATED;
     att_dispatch_server_request_can_send_now_event(att_server->connection.con_handle);
 }
+
+static void att_signed_write_handle_cmac_result(uint8_t hash[8]){
+    att_server_t * att_server = att_server_for_handle(att_server_signed_write_con_handle);
+    att_server_signed_write_con_handle = HCI_CON_HANDLE_INVALID;
+    if (att_server && att_server->state == ATT_SERVER_W4_SIGNED_WRITE_VALIDATION){
+        att_signed_write_validate(att_server, hash);
+    }
+
+    // start validation of next signed write waiting for sm cmac engine
+    att_server = att_server_next_for_state(ATT_SERVER_REQUEST_RECEIVED);
+    if (!att_server) return;
+    att_server_last_served_con_handle = att_server->connection.con_handle;
+    att_run_for_context(att_server);
+}
 #endif
 
 // pre: att_server->state == ATT_SERVER_REQUEST_RECEIVED_AND_VALIDATED
@@ -278,13 +332,16 @@ static int att_server_process_validated_request(att_server_t * att_server){
     && (att_response_buffer[4] == ATT_ERROR_INSUFFICIENT_AUTHORIZATION)
     && (att_server->connection.authenticated)){
 
+        // keep request until pairing is complete or user authorization is given
         switch (sm_authorization_state(att_server->connection.con_handle)){
             case AUTHORIZATION_UNKNOWN:
                 l2cap_release_packet_buffer();
+                att_server->state = ATT_SERVER_W4_AUTHORIZATION;
                 sm_request_pairing(att_server->connection.con_handle);
                 return 0;
             case AUTHORIZATION_PENDING:
                 l2cap_release_packet_buffer();
+                att_server->state = ATT_SERVER_W4_AUTHORIZATION;
                 return 0;
             default:
                 break;
@@ -312,6 +369,10 @@ static void att_run_for_context(att_server_t * att_server){
 #ifdef ENABLE_LE_SIGNED_WRITE
             if (att_server->request_buffer[0] == ATT_SIGNED_WRITE_COMMAND){
                 log_info("ATT Signed Write!");
+                if (att_server_signed_write_con_handle != HCI_CON_HANDLE_INVALID){
+                    log_info("ATT Signed Write, wait for validation of other signed write");
+                    return;
+                }
                 if (!sm_cmac_ready()) {
                     log_info("ATT Signed Write, sm_cmac engine not ready. Abort");
                     att_server->state = ATT_SERVER_IDLE;
@@ -345,6 +406,7 @@ static void att_run_for_context(att_server_t * att_server){
                 sm_key_t csrk;
                 le_device_db_remote_csrk_get(att_server->ir_le_device_db_index, csrk);
                 att_server->state = ATT_SERVER_W4_SIGNED_WRITE_VALIDATION;
+                att_server_signed_write_con_handle = att_server->connection.con_handle;
                 log_info("Orig Signature: ");
                 log_info_hexdump( &att_server->request_buffer[att_server->request_size-8], 8);
                 uint16_t attribute_handle = little_endian_read_16(att_server->request_buffer, 1);
@@ -362,23 +424,103 @@ static void att_run_for_context(att_server_t * att_server){
     }   
 }
 
-static void att_server_handle_can_send_now(void){
+#ifdef ENABLE_ATT_SERVER_NOTIFICATION_QUEUE
+static att_server_t * att_server_with_queued_notifications(void){
+    btstack_linked_list_iterator_t it;
+    hci_connections_get_iterator(&it);
+    while(btstack_linked_list_iterator_has_next(&it)){
+        hci_connection_t * connection = (hci_connection_t *) btstack_linked_list_iterator_next(&it);
+        if (connection->att_server.notification_queue_count) return &connection->att_server;
+    }
+    return NULL;
+}
 
-    // NOTE: we get l2cap fixed channel instead of con_handle 
+static int att_server_notifications_queued(void){
+    return att_server_with_queued_notifications() != NULL;
+}
+
+// pre: can send now
+static void att_server_send_queued_notification(att_server_t * att_server){
+    att_server_queued_notification_t * notification = &att_server->notification_queue[att_server->notification_queue_head];
+    att_server->notification_queue_head++;
+    if (att_server->notification_queue_head == ATT_SERVER_NOTIFICATION_QUEUE_SIZE){
+        att_server->notification_queue_head = 0;
+    }
+    att_server->notification_queue_count--;
 
+    l2cap_reserve_packet_buffer();
+    uint8_t * packet_buffer = l2cap_get_outgoing_buffer();
+    uint16_t size = att_prepare_handle_value_notification(&att_server->connection, notification->attribute_handle, notification->value, notification->value_len, packet_buffer);
+    l2cap_send_prepared_connectionless(att_server->connection.con_handle, L2CAP_CID_ATTRIBUTE_PROTOCOL, size);
+
+    att_server_notification_stats_t * stats = &att_server->notification_stats;
+    uint32_t latency_ms = btstack_run_loop_get_time_ms() - notification->queued_ms;
+    stats->sent++;
+    stats->latency_ms_total += latency_ms;
+    if (latency_ms > stats->latency_ms_max){
+        stats->latency_ms_max = latency_ms;
+    }
+}
+
+// send one queued notification per connection
+// returns 1 if can send now event was requested as controller buffers are used up
+static int att_server_send_queued_notifications(void){
+    hci_con_handle_t con_handle = HCI_CON_HANDLE_INVALID;
     btstack_linked_list_iterator_t it;
     hci_connections_get_iterator(&it);
     while(btstack_linked_list_iterator_has_next(&it)){
         hci_connection_t * connection = (hci_connection_t *) btstack_linked_list_iterator_next(&it);
         att_server_t * att_server = &connection->att_server;
-        if (att_server->state == ATT_SERVER_REQUEST_RECEIVED_AND_VALIDATED){
-            int sent = att_server_process_validated_request(att_server);
-            if (sent && (att_client_waiting_for_can_send || !btstack_linked_list_empty(&can_send_now_clients))){
-                att_dispatch_server_request_can_send_now_event(att_server->connection.con_handle);
-                return;
-            }
+        if (att_server->notification_queue_count == 0) continue;
+        con_handle = att_server->connection.con_handle;
+        if (!att_dispatch_server_can_send_now(con_handle)){
+            att_dispatch_server_request_can_send_now_event(con_handle);
+            return 1;
         }
+        att_server_send_queued_notification(att_server);
+        att_server_notifications_sent_last = 1;
     }
+    if (con_handle == HCI_CON_HANDLE_INVALID) return 0;
+    if (att_dispatch_server_can_send_now(con_handle)) return 0;
+    if (att_server_notifications_queued() || att_client_waiting_for_can_send || !btstack_linked_list_empty(&can_send_now_clients)){
+        att_dispatch_server_request_can_send_now_event(con_handle);
+    }
+    return 1;
+}
+#endif
+
+static void att_server_handle_can_send_now(void){
+
+    // NOTE: we get l2cap fixed channel instead of con_handle 
+
+    // answer validated requests round-robin, starting after the connection served last
+    while (1){
+        att_server_t * att_server = att_server_next_for_state(ATT_SERVER_REQUEST_RECEIVED_AND_VALIDATED);
+        if (!att_server) break;
+        hci_con_handle_t con_handle = att_server->connection.con_handle;
+        if (!att_dispatch_server_can_send_now(con_handle)){
+            att_dispatch_server_request_can_send_now_event(con_handle);
+            return;
+        }
+        att_server_last_served_con_handle = con_handle;
+        int sent = att_server_process_validated_request(att_server);
+        int pending = att_client_waiting_for_can_send || !btstack_linked_list_empty(&can_send_now_clients);
+#ifdef ENABLE_ATT_SERVER_NOTIFICATION_QUEUE
+        pending = pending || att_server_notifications_queued();
+#endif
+        if (sent && pending){
+            att_dispatch_server_request_can_send_now_event(con_handle);
+            return;
+        }
+    }
+
+#ifdef ENABLE_ATT_SERVER_NOTIFICATION_QUEUE
+    // one round of queued notifications, unless it's the turn of can send now callbacks and events
+    int clients_pending = att_client_waiting_for_can_send || !btstack_linked_list_empty(&can_send_now_clients);
+    if (!clients_pending || !att_server_notifications_sent_last){
+        if (att_server_send_queued_notifications()) return;
+    }
+#endif
 
     while (!btstack_linked_list_empty(&can_send_now_clients)){
         // handle first client
@@ -386,10 +528,17 @@ static void att_server_handle_can_send_now(void){
         hci_con_handle_t con_handle = (uintptr_t) client->context;
         btstack_linked_list_remove(&can_send_now_clients, (btstack_linked_item_t *) client);
         client->callback(client->context);
+#ifdef ENABLE_ATT_SERVER_NOTIFICATION_QUEUE
+        att_server_notifications_sent_last = 0;
+#endif
 
         // request again if needed
         if (!att_dispatch_server_can_send_now(con_handle)){
-            if (!btstack_linked_list_empty(&can_send_now_clients) || att_client_waiting_for_can_send){
+            int pending = !btstack_linked_list_empty(&can_send_now_clients) || att_client_waiting_for_can_send;
+#ifdef ENABLE_ATT_SERVER_NOTIFICATION_QUEUE
+            pending = pending || att_server_notifications_queued();
+#endif
+            if (pending){
                 att_dispatch_server_request_can_send_now_event(con_handle);
             }
             return;
@@ -399,7 +548,18 @@ static void att_server_handle_can_send_now(void){
     if (att_client_waiting_for_can_send){
         att_client_waiting_for_can_send = 0;
         att_emit_can_send_now_event();
+#ifdef ENABLE_ATT_SERVER_NOTIFICATION_QUEUE
+        att_server_notifications_sent_last = 0;
+#endif
     }
+
+#ifdef ENABLE_ATT_SERVER_NOTIFICATION_QUEUE
+    // continue with next round
+    att_server_t * att_server = att_server_with_queued_notifications();
+    if (att_server){
+        att_dispatch_server_request_can_send_now_event(att_server->connection.con_handle);
+    }
+#endif
 }
 
 static void att_packet_handler(uint8_t packet_type, uint16_t handle, uint8_t *packet, uint16_t size){
@@ -532,3 +692,60 @@ int att_server_indicate(hci_con_handle_t con_handle, uint16_t attribute_handle,
 	l2cap_send_prepared_connectionless(att_server->connection.con_handle, L2CAP_CID_ATTRIBUTE_PROTOCOL, size);
     return 0;
 }
+
+#ifdef ENABLE_ATT_SERVER_NOTIFICATION_QUEUE
+int att_server_queue_notification(hci_con_handle_t con_handle, uint16_t attribute_handle, const uint8_t * value, uint16_t value_len){
+    att_server_t * att_server = att_server_for_handle(con_handle);
+    if (!att_server) return ERROR_CODE_UNKNOWN_CONNECTION_IDENTIFIER;
+    if (value_len > ATT_SERVER_NOTIFICATION_QUEUE_VALUE_SIZE) return ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LENGTH;
+
+    // latest value wins if notification for this handle is still queued
+    int i;
+    int index = att_server->notification_queue_head;
+    for (i = 0; i < att_server->notification_queue_count; i++){
+        att_server_queued_notification_t * notification = &att_server->notification_queue[index];
+        if (notification->attribute_handle == attribute_handle){
+            memcpy(notification->value, value, value_len);
+            notification->value_len = value_len;
+            att_server->notification_stats.coalesced++;
+            return 0;
+        }
+        index++;
+        if (index == ATT_SERVER_NOTIFICATION_QUEUE_SIZE){
+            index = 0;
+        }
+    }
+
+    if (att_server->notification_queue_count == ATT_SERVER_NOTIFICATION_QUEUE_SIZE){
+        att_server->notification_stats.dropped++;
+        return BTSTACK_MEMORY_ALLOC_FAILED;
+    }
+
+    // index points to free entry after last queued one
+    att_server_queued_notification_t * notification = &att_server->notification_queue[index];
+    notification->attribute_handle = attribute_handle;
+    notification->value_len = value_len;
+    notification->queued_ms = btstack_run_loop_get_time_ms();
+    memcpy(notification->value, value, value_len);
+    att_server->notification_queue_count++;
+    att_server->notification_stats.queued++;
+
+    // can send now already requested if queue was not empty, might send right away
+    if (att_server->notification_queue_count > 1) return 0;
+    att_dispatch_server_request_can_send_now_event(con_handle);
+    return 0;
+}
+
+int att_server_get_notification_stats(hci_con_handle_t con_handle, att_server_notification_stats_t * stats){
+    att_server_t * att_server = att_server_for_handle(con_handle);
+    if (!att_server) return ERROR_CODE_UNKNOWN_CONNECTION_IDENTIFIER;
+    *stats = att_server->notification_stats;
+    return 0;
+}
+
+void att_server_reset_notification_stats(hci_con_handle_t con_handle){
+    att_server_t * att_server = att_server_for_handle(con_handle);
+    if (!att_server) return;
+    memset(&att_server->notification_stats, 0, sizeof(att_server_notification_stats_t));
+}
+#endif
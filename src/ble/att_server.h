@@ -40,6 +40,7 @@
 #include <stdint.h>
 #include "ble/att_db.h"
 #include "btstack_defines.h"
+#include "hci.h"
 
 #if defined __cplusplus
 extern "C" {
@@ -106,6 +107,35 @@ int att_server_notify(hci_con_handle_t con_handle, uint16_t attribute_handle, ui
  */
 int att_server_indicate(hci_con_handle_t con_handle, uint16_t attribute_handle, uint8_t *value, uint16_t value_len);
 
+#ifdef ENABLE_ATT_SERVER_NOTIFICATION_QUEUE
+/*
+ * @brief queue notification about attribute value change
+ * @note queued notifications are sent as soon as possible, filling all available controller buffers.
+ *       If a notification for the same attribute is still queued, only its value is updated.
+ *       Notifications sent with att_server_notify might overtake queued ones.
+ * @param con_handle
+ * @param attribute_handle
+ * @param value is copied, max ATT_SERVER_NOTIFICATION_QUEUE_VALUE_SIZE bytes
+ * @param value_len
+ * @return 0 if ok, BTSTACK_MEMORY_ALLOC_FAILED if queue is full, error otherwise
+ */
+int att_server_queue_notification(hci_con_handle_t con_handle, uint16_t attribute_handle, const uint8_t * value, uint16_t value_len);
+
+/*
+ * @brief get statistics for queued notifications since connection was established or stats were reset
+ * @param con_handle
+ * @param stats
+ * @return 0 if ok, error otherwise
+ */
+int att_server_get_notification_stats(hci_con_handle_t con_handle, att_server_notification_stats_t * stats);
+
+/*
+ * @brief reset statistics for queued notifications
+ * @param con_handle
+ */
+void att_server_reset_notification_stats(hci_con_handle_t con_handle);
+#endif
+
 /* API_END */
 
 #if defined __cplusplus
@@ -51,6 +51,7 @@
 #include "ble/gatt_client.h"
 #include "ble/le_device_db.h"
 #include "ble/sm.h"
+#include "bluetooth_gatt.h"
 #include "btstack_debug.h"
 #include "btstack_event.h"
 #include "btstack_memory.h"
@@ -75,6 +76,10 @@ static void gatt_client_report_error_if_pending(gatt_client_t *peripheral, uint8
 static void att_signed_write_handle_cmac_result(uint8_t hash[8]);
 #endif
 
+#ifdef ENABLE_GATT_CLIENT_DISCOVERY_CACHE
+static void gatt_client_discovery_cache_handle_query_complete(gatt_client_t * peripheral, uint8_t status);
+#endif
+
 static uint16_t peripheral_mtu(gatt_client_t *peripheral){
     if (peripheral->mtu > l2cap_max_le_mtu()){
         log_error("Peripheral mtu is not initialized");
@@ -492,6 +497,9 @@ static void emit_gatt_complete_event(gatt_client_t * peripheral, uint8_t status)
     packet[1] = 3;
     little_endian_store_16(packet, 2, peripheral->con_handle);
     packet[4] = status;
+#ifdef ENABLE_GATT_CLIENT_DISCOVERY_CACHE
+    gatt_client_discovery_cache_handle_query_complete(peripheral, status);
+#endif
     emit_event_new(peripheral->callback, packet, sizeof(packet));
 }
 
@@ -551,6 +559,355 @@ static void emit_gatt_all_characteristic_descriptors_result_event(
     reverse_128(uuid128, &packet[6]);
     emit_event_new(peripheral->callback, packet, sizeof(packet));
 }
+
+#ifdef ENABLE_GATT_CLIENT_DISCOVERY_CACHE
+
+// Discovery results of bonded devices are stored in btstack_tlv, one tag per LE Device DB entry
+
+#define GATT_CLIENT_DISCOVERY_CACHE_ENTRY_SERVICE         1
+#define GATT_CLIENT_DISCOVERY_CACHE_ENTRY_CHARACTERISTIC  2
+#define GATT_CLIENT_DISCOVERY_CACHE_ENTRY_DESCRIPTOR      3
+
+// Database Hash characteristic (Core 5.1), not part of the generated bluetooth_gatt.h yet
+#ifndef ORG_BLUETOOTH_CHARACTERISTIC_DATABASE_HASH
+#define ORG_BLUETOOTH_CHARACTERISTIC_DATABASE_HASH        0x2B2A
+#endif
+
+static const btstack_tlv_t * gatt_client_discovery_cache_btstack_tlv_impl;
+static       void *          gatt_client_discovery_cache_btstack_tlv_context;
+
+static const char gatt_client_discovery_cache_tag_0 = 'G';
+static const char gatt_client_discovery_cache_tag_1 = 'D';
+static const char gatt_client_discovery_cache_tag_2 = 'C';
+
+static uint32_t gatt_client_discovery_cache_tag_for_index(uint8_t index){
+    return (gatt_client_discovery_cache_tag_0 << 24) | (gatt_client_discovery_cache_tag_1 << 16) | (gatt_client_discovery_cache_tag_2 << 8) | index;
+}
+
+static uint32_t gatt_client_discovery_cache_size(gatt_client_discovery_cache_t * cache){
+    return sizeof(gatt_client_discovery_cache_t) - sizeof(cache->entries) + cache->num_entries * sizeof(gatt_client_discovery_cache_entry_t);
+}
+
+void gatt_client_discovery_cache_configure(const btstack_tlv_t * btstack_tlv_impl, void * btstack_tlv_context){
+    gatt_client_discovery_cache_btstack_tlv_impl    = btstack_tlv_impl;
+    gatt_client_discovery_cache_btstack_tlv_context = btstack_tlv_context;
+}
+
+static void gatt_client_discovery_cache_store(gatt_client_t * peripheral){
+    peripheral->discovery_cache_dirty = 0;
+    gatt_client_discovery_cache_t * cache = &peripheral->discovery_cache;
+    uint32_t tag = gatt_client_discovery_cache_tag_for_index(peripheral->discovery_cache_le_device_index);
+    gatt_client_discovery_cache_btstack_tlv_impl->store_tag(gatt_client_discovery_cache_btstack_tlv_context, tag, (uint8_t*) cache, gatt_client_discovery_cache_size(cache));
+}
+
+// load cache as soon as remote is bonded
+static void gatt_client_discovery_cache_load(gatt_client_t * peripheral){
+    if (peripheral->discovery_cache_state != GATT_CLIENT_DISCOVERY_CACHE_IDLE) return;
+    if (!gatt_client_discovery_cache_btstack_tlv_impl) return;
+    int le_device_index = sm_le_device_index(peripheral->con_handle);
+    if (le_device_index < 0) return;
+
+    int addr_type;
+    bd_addr_t addr;
+    sm_key_t irk;
+    le_device_db_info(le_device_index, &addr_type, addr, irk);
+
+    gatt_client_discovery_cache_t * cache = &peripheral->discovery_cache;
+    uint32_t tag = gatt_client_discovery_cache_tag_for_index(le_device_index);
+    int size = gatt_client_discovery_cache_btstack_tlv_impl->get_tag(gatt_client_discovery_cache_btstack_tlv_context, tag, (uint8_t*) cache, sizeof(gatt_client_discovery_cache_t));
+    // drop entry of previously bonded device with same index
+    if (size < (int) (sizeof(gatt_client_discovery_cache_t) - sizeof(cache->entries))
+    ||  cache->num_entries > GATT_CLIENT_DISCOVERY_CACHE_SIZE
+    ||  size != (int) gatt_client_discovery_cache_size(cache)
+    ||  cache->identity_address_type != addr_type
+    ||  bd_addr_cmp(cache->identity_address, addr) != 0){
+        memset(cache, 0, sizeof(gatt_client_discovery_cache_t));
+        cache->identity_address_type = addr_type;
+        bd_addr_copy(cache->identity_address, addr);
+    }
+    log_info("GATT Client Discovery Cache: loaded %u entries for device index %u", cache->num_entries, le_device_index);
+    peripheral->discovery_cache_le_device_index = le_device_index;
+    peripheral->discovery_cache_state = GATT_CLIENT_DISCOVERY_CACHE_W4_VALIDATION;
+}
+
+static void gatt_client_discovery_cache_clear(gatt_client_t * peripheral){
+    gatt_client_discovery_cache_t * cache = &peripheral->discovery_cache;
+    cache->services_complete = 0;
+    cache->num_entries = 0;
+    peripheral->discovery_cache_recording = P_READY;
+}
+
+static int gatt_client_discovery_cache_entry_matches_uuid(gatt_client_discovery_cache_entry_t * entry, uint8_t type, const uint8_t * uuid128){
+    if (entry->type != type) return 0;
+    return memcmp(entry->uuid128, uuid128, 16) == 0;
+}
+
+static gatt_client_discovery_cache_entry_t * gatt_client_discovery_cache_find(gatt_client_t * peripheral, uint8_t type, uint16_t value_handle, uint16_t end_handle){
+    gatt_client_discovery_cache_t * cache = &peripheral->discovery_cache;
+    int i;
+    for (i = 0; i < cache->num_entries; i++){
+        gatt_client_discovery_cache_entry_t * entry = &cache->entries[i];
+        if (entry->type != type) continue;
+        if (entry->value_handle != value_handle) continue;
+        if (entry->end_handle != end_handle) continue;
+        return entry;
+    }
+    return NULL;
+}
+
+// services are stored with value handle = start group handle
+static gatt_client_discovery_cache_entry_t * gatt_client_discovery_cache_find_service(gatt_client_t * peripheral, uint16_t start_group_handle, uint16_t end_group_handle){
+    return gatt_client_discovery_cache_find(peripheral, GATT_CLIENT_DISCOVERY_CACHE_ENTRY_SERVICE, start_group_handle, end_group_handle);
+}
+
+// descriptor query covers handles after value handle
+static gatt_client_discovery_cache_entry_t * gatt_client_discovery_cache_find_characteristic(gatt_client_t * peripheral, uint16_t start_handle, uint16_t end_handle){
+    return gatt_client_discovery_cache_find(peripheral, GATT_CLIENT_DISCOVERY_CACHE_ENTRY_CHARACTERISTIC, start_handle - 1, end_handle);
+}
+
+static void gatt_client_discovery_cache_add(gatt_client_t * peripheral, uint8_t type, uint16_t start_handle, uint16_t value_handle, uint16_t end_handle, uint16_t properties, const uint8_t * uuid128){
+    gatt_client_discovery_cache_t * cache = &peripheral->discovery_cache;
+    if (cache->num_entries >= GATT_CLIENT_DISCOVERY_CACHE_SIZE){
+        log_info("GATT Client Discovery Cache: full, GATT_CLIENT_DISCOVERY_CACHE_SIZE %u", GATT_CLIENT_DISCOVERY_CACHE_SIZE);
+        cache->num_entries = peripheral->discovery_cache_recording_start;
+        peripheral->discovery_cache_recording = P_READY;
+        return;
+    }
+    gatt_client_discovery_cache_entry_t * entry = &cache->entries[cache->num_entries++];
+    entry->type = type;
+    entry->complete = 0;
+    entry->start_handle = start_handle;
+    entry->value_handle = value_handle;
+    entry->end_handle = end_handle;
+    entry->properties = properties;
+    memcpy(entry->uuid128, uuid128, 16);
+}
+
+static void gatt_client_discovery_cache_add_service(gatt_client_t * peripheral, uint16_t start_group_handle, uint16_t end_group_handle, const uint8_t * uuid128){
+    if (peripheral->discovery_cache_recording != P_W2_SEND_SERVICE_QUERY) return;
+    gatt_client_discovery_cache_add(peripheral, GATT_CLIENT_DISCOVERY_CACHE_ENTRY_SERVICE, start_group_handle, start_group_handle, end_group_handle, 0, uuid128);
+}
+
+static void gatt_client_discovery_cache_add_characteristic(gatt_client_t * peripheral, uint16_t start_handle, uint16_t value_handle, uint16_t end_handle, uint16_t properties, const uint8_t * uuid128){
+    if (peripheral->discovery_cache_recording != P_W2_SEND_ALL_CHARACTERISTICS_OF_SERVICE_QUERY) return;
+    gatt_client_discovery_cache_add(peripheral, GATT_CLIENT_DISCOVERY_CACHE_ENTRY_CHARACTERISTIC, start_handle, value_handle, end_handle, properties, uuid128);
+}
+
+static void gatt_client_discovery_cache_add_descriptor(gatt_client_t * peripheral, uint16_t descriptor_handle, const uint8_t * uuid128){
+    if (peripheral->discovery_cache_recording != P_W2_SEND_ALL_CHARACTERISTIC_DESCRIPTORS_QUERY) return;
+    gatt_client_discovery_cache_add(peripheral, GATT_CLIENT_DISCOVERY_CACHE_ENTRY_DESCRIPTOR, descriptor_handle, descriptor_handle, descriptor_handle, 0, uuid128);
+}
+
+static void gatt_client_discovery_cache_start_recording(gatt_client_t * peripheral){
+    gatt_client_discovery_cache_t * cache = &peripheral->discovery_cache;
+    gatt_client_discovery_cache_entry_t * entry;
+    switch (peripheral->gatt_client_state){
+        case P_W2_SEND_SERVICE_QUERY:
+            // characteristics and descriptors are only stored for known services
+            gatt_client_discovery_cache_clear(peripheral);
+            break;
+        case P_W2_SEND_ALL_CHARACTERISTICS_OF_SERVICE_QUERY:
+            entry = gatt_client_discovery_cache_find_service(peripheral, peripheral->start_group_handle, peripheral->end_group_handle);
+            if (!entry || entry->complete) return;
+            break;
+        case P_W2_SEND_ALL_CHARACTERISTIC_DESCRIPTORS_QUERY:
+            entry = gatt_client_discovery_cache_find_characteristic(peripheral, peripheral->start_group_handle, peripheral->end_group_handle);
+            if (!entry || entry->complete) return;
+            break;
+        default:
+            return;
+    }
+    peripheral->discovery_cache_recording = peripheral->gatt_client_state;
+    peripheral->discovery_cache_recording_start = cache->num_entries;
+    peripheral->discovery_cache_recording_start_handle = peripheral->start_group_handle;
+    peripheral->discovery_cache_recording_end_handle   = peripheral->end_group_handle;
+}
+
+// called for all completed queries
+static void gatt_client_discovery_cache_handle_query_complete(gatt_client_t * peripheral, uint8_t status){
+    gatt_client_state_t recording = peripheral->discovery_cache_recording;
+    if (recording == P_READY) return;
+    peripheral->discovery_cache_recording = P_READY;
+
+    gatt_client_discovery_cache_t * cache = &peripheral->discovery_cache;
+    if (status){
+        cache->num_entries = peripheral->discovery_cache_recording_start;
+        return;
+    }
+
+    gatt_client_discovery_cache_entry_t * entry = NULL;
+    switch (recording){
+        case P_W2_SEND_SERVICE_QUERY:
+            cache->services_complete = 1;
+            break;
+        case P_W2_SEND_ALL_CHARACTERISTICS_OF_SERVICE_QUERY:
+            entry = gatt_client_discovery_cache_find_service(peripheral, peripheral->discovery_cache_recording_start_handle, peripheral->discovery_cache_recording_end_handle);
+            break;
+        case P_W2_SEND_ALL_CHARACTERISTIC_DESCRIPTORS_QUERY:
+            entry = gatt_client_discovery_cache_find_characteristic(peripheral, peripheral->discovery_cache_recording_start_handle, peripheral->discovery_cache_recording_end_handle);
+            break;
+        default:
+            break;
+    }
+    if (entry){
+        entry->complete = 1;
+    }
+    peripheral->discovery_cache_dirty = 1;
+}
+
+// @returns 1 if query was answered from cache
+static int gatt_client_discovery_cache_serve(gatt_client_t * peripheral){
+    gatt_client_discovery_cache_t * cache = &peripheral->discovery_cache;
+    gatt_client_discovery_cache_entry_t * entry;
+    uint8_t  type;
+    uint16_t start_handle = peripheral->start_group_handle;
+    uint16_t end_handle   = peripheral->end_group_handle;
+    int      filter_with_uuid = 0;
+
+    switch (peripheral->gatt_client_state){
+        case P_W2_SEND_SERVICE_WITH_UUID_QUERY:
+            filter_with_uuid = 1;
+            /* fall through */
+        case P_W2_SEND_SERVICE_QUERY:
+            if (!cache->services_complete) return 0;
+            type = GATT_CLIENT_DISCOVERY_CACHE_ENTRY_SERVICE;
+            break;
+        case P_W2_SEND_CHARACTERISTIC_WITH_UUID_QUERY:
+            filter_with_uuid = 1;
+            /* fall through */
+        case P_W2_SEND_ALL_CHARACTERISTICS_OF_SERVICE_QUERY:
+            entry = gatt_client_discovery_cache_find_service(peripheral, start_handle, end_handle);
+            if (!entry || !entry->complete) return 0;
+            type = GATT_CLIENT_DISCOVERY_CACHE_ENTRY_CHARACTERISTIC;
+            break;
+        case P_W2_SEND_ALL_CHARACTERISTIC_DESCRIPTORS_QUERY:
+            entry = gatt_client_discovery_cache_find_characteristic(peripheral, start_handle, end_handle);
+            if (!entry || !entry->complete) return 0;
+            type = GATT_CLIENT_DISCOVERY_CACHE_ENTRY_DESCRIPTOR;
+            break;
+        default:
+            return 0;
+    }
+
+    log_info("GATT Client Discovery Cache: answer query for 0x%04x-0x%04x", start_handle, end_handle);
+    int i;
+    for (i = 0; i < cache->num_entries; i++){
+        entry = &cache->entries[i];
+        if (entry->type != type) continue;
+        if (entry->start_handle < start_handle || entry->start_handle > end_handle) continue;
+        if (filter_with_uuid && !gatt_client_discovery_cache_entry_matches_uuid(entry, type, peripheral->uuid128)) continue;
+        switch (type){
+            case GATT_CLIENT_DISCOVERY_CACHE_ENTRY_SERVICE:
+                emit_gatt_service_query_result_event(peripheral, entry->start_handle, entry->end_handle, entry->uuid128);
+                break;
+            case GATT_CLIENT_DISCOVERY_CACHE_ENTRY_CHARACTERISTIC:
+                emit_gatt_characteristic_query_result_event(peripheral, entry->start_handle, entry->value_handle, entry->end_handle, entry->properties, entry->uuid128);
+                break;
+            default:
+                emit_gatt_all_characteristic_descriptors_result_event(peripheral, entry->start_handle, entry->uuid128);
+                break;
+        }
+    }
+    gatt_client_handle_transaction_complete(peripheral);
+    emit_gatt_complete_event(peripheral, 0);
+    return 1;
+}
+
+// @returns 1 if query was answered from cache
+static int gatt_client_discovery_cache_handle_query(gatt_client_t * peripheral){
+    switch (peripheral->gatt_client_state){
+        case P_W2_SEND_SERVICE_QUERY:
+        case P_W2_SEND_SERVICE_WITH_UUID_QUERY:
+        case P_W2_SEND_ALL_CHARACTERISTICS_OF_SERVICE_QUERY:
+        case P_W2_SEND_CHARACTERISTIC_WITH_UUID_QUERY:
+        case P_W2_SEND_ALL_CHARACTERISTIC_DESCRIPTORS_QUERY:
+            break;
+        default:
+            return 0;
+    }
+    // follow-up request of query that is recorded
+    if (peripheral->discovery_cache_recording != P_READY) return 0;
+
+    gatt_client_discovery_cache_load(peripheral);
+    switch (peripheral->discovery_cache_state){
+        case GATT_CLIENT_DISCOVERY_CACHE_W4_VALIDATION:
+            peripheral->discovery_cache_pending_state = peripheral->gatt_client_state;
+            peripheral->gatt_client_state = P_W2_SEND_DATABASE_HASH_QUERY;
+            return 0;
+        case GATT_CLIENT_DISCOVERY_CACHE_VALIDATED:
+            if (gatt_client_discovery_cache_serve(peripheral)) return 1;
+            gatt_client_discovery_cache_start_recording(peripheral);
+            return 0;
+        default:
+            return 0;
+    }
+}
+
+// @param database_hash or NULL if not supported by remote
+static void gatt_client_discovery_cache_validate(gatt_client_t * peripheral, const uint8_t * database_hash){
+    gatt_client_discovery_cache_t * cache = &peripheral->discovery_cache;
+    int valid;
+    if (database_hash){
+        valid = cache->database_hash_present && (memcmp(cache->database_hash, database_hash, 16) == 0);
+    } else {
+        valid = !cache->database_hash_present;
+    }
+    if (!valid){
+        log_info("GATT Client Discovery Cache: database hash mismatch, drop %u entries", cache->num_entries);
+        gatt_client_discovery_cache_clear(peripheral);
+        cache->database_hash_present = database_hash != NULL;
+        if (database_hash){
+            memcpy(cache->database_hash, database_hash, 16);
+        }
+        gatt_client_discovery_cache_store(peripheral);
+    }
+    peripheral->discovery_cache_state = GATT_CLIENT_DISCOVERY_CACHE_VALIDATED;
+    peripheral->gatt_client_state = peripheral->discovery_cache_pending_state;
+}
+
+static void gatt_client_discovery_cache_handle_database_hash_response(gatt_client_t * peripheral, uint8_t * packet, uint16_t size){
+    // Read By Type Response with single handle-value pair
+    if (packet[0] == ATT_READ_BY_TYPE_RESPONSE && packet[1] == 2 + 16 && size >= 4 + 16){
+        gatt_client_discovery_cache_validate(peripheral, &packet[4]);
+    } else {
+        gatt_client_discovery_cache_validate(peripheral, NULL);
+    }
+}
+
+static void gatt_client_discovery_cache_drop(gatt_client_t * peripheral){
+    gatt_client_discovery_cache_load(peripheral);
+    if (peripheral->discovery_cache_state == GATT_CLIENT_DISCOVERY_CACHE_IDLE) return;
+    gatt_client_discovery_cache_clear(peripheral);
+    // database hash is read again with next discovery query
+    peripheral->discovery_cache.database_hash_present = 0;
+    peripheral->discovery_cache_state = GATT_CLIENT_DISCOVERY_CACHE_W4_VALIDATION;
+    gatt_client_discovery_cache_store(peripheral);
+}
+
+static void gatt_client_discovery_cache_handle_indication(gatt_client_t * peripheral, uint16_t value_handle){
+    gatt_client_discovery_cache_load(peripheral);
+    if (peripheral->discovery_cache_state == GATT_CLIENT_DISCOVERY_CACHE_IDLE) return;
+    uint8_t service_changed_uuid128[16];
+    uuid_add_bluetooth_prefix(service_changed_uuid128, ORG_BLUETOOTH_CHARACTERISTIC_GATT_SERVICE_CHANGED);
+    gatt_client_discovery_cache_entry_t * entry;
+    gatt_client_discovery_cache_t * cache = &peripheral->discovery_cache;
+    int i;
+    for (i = 0; i < cache->num_entries; i++){
+        entry = &cache->entries[i];
+        if (entry->value_handle != value_handle) continue;
+        if (!gatt_client_discovery_cache_entry_matches_uuid(entry, GATT_CLIENT_DISCOVERY_CACHE_ENTRY_CHARACTERISTIC, service_changed_uuid128)) continue;
+        log_info("GATT Client Discovery Cache: Service Changed, drop %u entries", cache->num_entries);
+        gatt_client_discovery_cache_drop(peripheral);
+        return;
+    }
+}
+
+void gatt_client_discovery_cache_invalidate(hci_con_handle_t con_handle){
+    gatt_client_t * peripheral = get_gatt_client_context_for_handle(con_handle);
+    if (!peripheral) return;
+    gatt_client_discovery_cache_drop(peripheral);
+}
+#endif
 ///
 
 static void report_gatt_services(gatt_client_t * peripheral, uint8_t * packet,  uint16_t size){
@@ -570,6 +927,9 @@ static void report_gatt_services(gatt_client_t * peripheral, uint8_t * packet,
         } else {
             reverse_128(&packet[i+4], uuid128);
         }
+#ifdef ENABLE_GATT_CLIENT_DISCOVERY_CACHE
+        gatt_client_discovery_cache_add_service(peripheral, start_group_handle, end_group_handle, uuid128);
+#endif
         emit_gatt_service_query_result_event(peripheral, start_group_handle, end_group_handle, uuid128);
     }
     // log_info("report_gatt_services for %02X done", peripheral->con_handle);
@@ -603,6 +963,10 @@ static void characteristic_end_found(gatt_client_t * peripheral, uint16_t end_ha
     
     if (!peripheral->characteristic_start_handle) return;
 
+#ifdef ENABLE_GATT_CLIENT_DISCOVERY_CACHE
+    gatt_client_discovery_cache_add_characteristic(peripheral, peripheral->characteristic_start_handle, peripheral->attribute_handle,
+        end_handle, peripheral->characteristic_properties, peripheral->uuid128);
+#endif
     emit_gatt_characteristic_query_result_event(peripheral, peripheral->characteristic_start_handle, peripheral->attribute_handle,
         end_handle, peripheral->characteristic_properties, peripheral->uuid128);    
 
@@ -718,6 +1082,9 @@ static void report_gatt_all_characteristic_descriptors(gatt_client_t * periphera
         } else {
             reverse_128(&packet[i+2], uuid128);
         }        
+#ifdef ENABLE_GATT_CLIENT_DISCOVERY_CACHE
+        gatt_client_discovery_cache_add_descriptor(peripheral, descriptor_handle, uuid128);
+#endif
         emit_gatt_all_characteristic_descriptors_result_event(peripheral, descriptor_handle, uuid128);
     }
     
@@ -846,6 +1213,11 @@ static void gatt_client_run(void){
                 break;
         }
 
+#ifdef ENABLE_GATT_CLIENT_DISCOVERY_CACHE
+        // answer discovery query from cache or validate cache first
+        if (gatt_client_discovery_cache_handle_query(peripheral)) continue;
+#endif
+
         // log_info("gatt_client_state %u", peripheral->gatt_client_state);
         switch (peripheral->gatt_client_state){
             case P_W2_SEND_SERVICE_QUERY:
@@ -973,6 +1345,13 @@ static void gatt_client_run(void){
                 send_gatt_execute_write_request(peripheral);
                 return;
 
+#ifdef ENABLE_GATT_CLIENT_DISCOVERY_CACHE
+            case P_W2_SEND_DATABASE_HASH_QUERY:
+                peripheral->gatt_client_state = P_W4_DATABASE_HASH_QUERY_RESULT;
+                att_read_by_type_or_group_request_for_uuid16(ATT_READ_BY_TYPE_REQUEST, ORG_BLUETOOTH_CHARACTERISTIC_DATABASE_HASH, peripheral->con_handle, 0x0001, 0xffff);
+                return;
+#endif
+
 #ifdef ENABLE_LE_SIGNED_WRITE
             case P_W4_CMAC_READY:
                 if (sm_cmac_ready()){
@@ -1025,6 +1404,11 @@ static void gatt_client_hci_event_packet_handler(uint8_t packet_type, uint16_t c
             gatt_client_t * peripheral = get_gatt_client_context_for_handle(con_handle);
             if (!peripheral) break;
             gatt_client_report_error_if_pending(peripheral, ATT_ERROR_HCI_DISCONNECT_RECEIVED);
+#ifdef ENABLE_GATT_CLIENT_DISCOVERY_CACHE
+            if (peripheral->discovery_cache_dirty){
+                gatt_client_discovery_cache_store(peripheral);
+            }
+#endif
             
             btstack_linked_list_remove(&gatt_client_connections, (btstack_linked_item_t *) peripheral);
             btstack_memory_gatt_client_free(peripheral);
@@ -1083,6 +1467,9 @@ static void gatt_client_att_packet_handler(uint8_t packet_type, uint16_t handle,
             }
             break;
         case ATT_HANDLE_VALUE_INDICATION:
+#ifdef ENABLE_GATT_CLIENT_DISCOVERY_CACHE
+            gatt_client_discovery_cache_handle_indication(peripheral, little_endian_read_16(packet,1));
+#endif
             report_gatt_indication(handle, little_endian_read_16(packet,1), &packet[3], size-3);
             peripheral->send_confirmation = 1;
             break;
@@ -1130,6 +1517,11 @@ static void gatt_client_att_packet_handler(uint8_t packet_type, uint16_t handle,
                     peripheral->client_characteristic_configuration_handle = little_endian_read_16(packet, 2);
                     peripheral->gatt_client_state = P_W2_WRITE_CLIENT_CHARACTERISTIC_CONFIGURATION;
                     break;
+#ifdef ENABLE_GATT_CLIENT_DISCOVERY_CACHE
+                case P_W4_DATABASE_HASH_QUERY_RESULT:
+                    gatt_client_discovery_cache_handle_database_hash_response(peripheral, packet, size);
+                    break;
+#endif
                 case P_W4_READ_BY_TYPE_RESPONSE: {
                     uint16_t pair_size = packet[1];
                     uint16_t offset;
@@ -1318,6 +1710,13 @@ static void gatt_client_att_packet_handler(uint8_t packet_type, uint16_t handle,
 
         case ATT_ERROR_RESPONSE:
 
+#ifdef ENABLE_GATT_CLIENT_DISCOVERY_CACHE
+            // remote without database hash
+            if (peripheral->gatt_client_state == P_W4_DATABASE_HASH_QUERY_RESULT){
+                gatt_client_discovery_cache_handle_database_hash_response(peripheral, packet, size);
+                break;
+            }
+#endif
             switch (packet[4]){
                 case ATT_ERROR_ATTRIBUTE_NOT_FOUND: {
                     switch(peripheral->gatt_client_state){
@@ -40,6 +40,7 @@
 #define btstack_gatt_client_h
 
 #include "hci.h"
+#include "btstack_tlv.h"
 
 #if defined __cplusplus
 extern "C" {
@@ -120,6 +121,10 @@ typedef enum {
     P_W4_CMAC_RESULT,
     P_W2_SEND_SIGNED_WRITE,
     P_W4_SEND_SINGED_WRITE_DONE,
+
+    // discovery cache validation
+    P_W2_SEND_DATABASE_HASH_QUERY,
+    P_W4_DATABASE_HASH_QUERY_RESULT,
 } gatt_client_state_t;
     
     
@@ -129,6 +134,42 @@ typedef enum{
     MTU_EXCHANGED
 } gatt_client_mtu_t;
 
+#ifdef ENABLE_GATT_CLIENT_DISCOVERY_CACHE
+
+#ifndef GATT_CLIENT_DISCOVERY_CACHE_SIZE
+#define GATT_CLIENT_DISCOVERY_CACHE_SIZE 32
+#endif
+
+typedef enum {
+    GATT_CLIENT_DISCOVERY_CACHE_IDLE,           // not loaded, e.g. device not bonded yet
+    GATT_CLIENT_DISCOVERY_CACHE_W4_VALIDATION,  // loaded, database hash not checked yet
+    GATT_CLIENT_DISCOVERY_CACHE_VALIDATED,
+} gatt_client_discovery_cache_state_t;
+
+// cached service, characteristic or descriptor
+typedef struct {
+    uint8_t  type;
+    uint8_t  complete;      // all characteristics of service resp. all descriptors of characteristic discovered
+    uint16_t start_handle;  // service start, characteristic declaration or descriptor handle
+    uint16_t value_handle;
+    uint16_t end_handle;
+    uint16_t properties;
+    uint8_t  uuid128[16];
+} gatt_client_discovery_cache_entry_t;
+
+// stored in btstack_tlv per LE Device DB entry, only the used entries are stored
+typedef struct {
+    bd_addr_t identity_address;
+    uint8_t   identity_address_type;
+    uint8_t   services_complete;
+    uint8_t   database_hash_present;
+    uint8_t   database_hash[16];
+    uint16_t  num_entries;
+    gatt_client_discovery_cache_entry_t entries[GATT_CLIENT_DISCOVERY_CACHE_SIZE];
+} gatt_client_discovery_cache_t;
+
+#endif
+
 typedef struct gatt_client{
     btstack_linked_item_t    item;
     // TODO: rename gatt_client_state -> state
@@ -175,6 +216,21 @@ typedef struct gatt_client{
     uint8_t  cmac[8];
 
     btstack_timer_source_t gc_timeout;
+
+#ifdef ENABLE_GATT_CLIENT_DISCOVERY_CACHE
+    gatt_client_discovery_cache_state_t discovery_cache_state;
+    int                                 discovery_cache_le_device_index;
+    // new entries are stored on disconnect
+    uint8_t                             discovery_cache_dirty;
+    // discovery query started before validation
+    gatt_client_state_t                 discovery_cache_pending_state;
+    // entries added by the current query, to be dropped if it fails
+    gatt_client_state_t                 discovery_cache_recording;
+    uint16_t                            discovery_cache_recording_start;
+    uint16_t                            discovery_cache_recording_start_handle;
+    uint16_t                            discovery_cache_recording_end_handle;
+    gatt_client_discovery_cache_t       discovery_cache;
+#endif
 } gatt_client_t;
 
 typedef struct gatt_client_notification {
@@ -362,6 +418,24 @@ uint8_t gatt_client_execute_write(btstack_packet_handler_t callback, hci_con_han
  */
 uint8_t gatt_client_cancel_write(btstack_packet_handler_t callback, hci_con_handle_t con_handle);
 
+#ifdef ENABLE_GATT_CLIENT_DISCOVERY_CACHE
+/**
+ * @brief Enable GATT Client Discovery Cache. Discovered services, characteristics and descriptors of bonded
+ *        devices are stored in btstack_tlv and used to answer later discovery queries without ATT requests.
+ *        The cache is invalidated by a Service Changed indication and checked against the Database Hash
+ *        characteristic on reconnect.
+ * @param btstack_tlv_impl to use
+ * @param btstack_tlv_context
+ */
+void gatt_client_discovery_cache_configure(const btstack_tlv_t * btstack_tlv_impl, void * btstack_tlv_context);
+
+/**
+ * @brief Delete cached discovery results for a connection, e.g. if the GATT database of the remote is known to have changed
+ * @param con_handle
+ */
+void gatt_client_discovery_cache_invalidate(hci_con_handle_t con_handle);
+#endif
+
 /* API_END */
 
 // used by generated btstack_event.c
@@ -51,6 +51,7 @@
 #include "btstack_memory.h"
 #include "gap.h"
 #include "hci.h"
+#include "hci_cmd_encoder.h"
 #include "hci_dump.h"
 #include "l2cap.h"
 
@@ -108,6 +109,11 @@
 #define ENABLE_CMAC_ENGINE
 #endif
 
+// number of resolved private addresses remembered by address resolution
+#ifndef SM_RPA_CACHE_SIZE
+#define SM_RPA_CACHE_SIZE 8
+#endif
+
 //
 // SM internal types and globals
 //
@@ -258,17 +264,39 @@ static void *    sm_address_resolution_context;
 static address_resolution_mode_t sm_address_resolution_mode;
 static btstack_linked_list_t sm_address_resolution_general_queue;
 
+// recently resolved private addresses, least recently used entry gets replaced
+typedef struct {
+    bd_addr_t address;
+    sm_key_t  irk;
+    int       le_db_index;
+    uint32_t  last_used;
+} sm_rpa_cache_entry_t;
+
+static sm_rpa_cache_entry_t sm_rpa_cache[SM_RPA_CACHE_SIZE];
+static uint32_t             sm_rpa_cache_time;
+
 // aes128 crypto engine. store current sm_connection_t in sm_aes128_context
 static sm_aes128_state_t  sm_aes128_state;
 static void *             sm_aes128_context;
 
 // use aes128 provided by MCU - not needed usually
 #ifdef HAVE_AES128
-static uint8_t                aes128_result_flipped[16];
-static btstack_timer_source_t aes128_timer;
 void btstack_aes128_calc(uint8_t * key, uint8_t * plaintext, uint8_t * result);
+static void sm_aes128_platform_calc(const uint8_t * key, const uint8_t * plaintext, uint8_t * result){
+    btstack_aes128_calc((uint8_t *) key, (uint8_t *) plaintext, result);
+}
 #endif
 
+// host aes128 engine, results are delivered by sm_run
+#ifdef HAVE_AES128
+static void (*sm_aes128_engine)(const uint8_t * key, const uint8_t * plaintext, uint8_t * result) = &sm_aes128_platform_calc;
+#else
+static void (*sm_aes128_engine)(const uint8_t * key, const uint8_t * plaintext, uint8_t * result);
+#endif
+static int     sm_aes128_result_ready;
+static sm_key_t sm_aes128_result_flipped;
+static int     sm_run_nesting;
+
 // random engine. store context (ususally sm_connection_t)
 static void * sm_random_context;
 
@@ -520,16 +548,8 @@ static void gap_random_address_update_stop(void){
 
 static void sm_random_start(void * context){
     sm_random_context = context;
-    hci_send_cmd(&hci_le_rand);
-}
-
-#ifdef HAVE_AES128
-static void aes128_completed(btstack_timer_source_t * ts){
-    UNUSED(ts);
-    sm_handle_encryption_result(&aes128_result_flipped[0]);
-    sm_run();
+    hci_send_le_rand();
 }
-#endif
 
 // pre: sm_aes128_state != SM_AES128_ACTIVE, hci_can_send_command == 1
 // context is made availabe to aes128 result handler by this
@@ -537,29 +557,19 @@ static void sm_aes128_start(sm_key_t key, sm_key_t plaintext, void * context){
     sm_aes128_state = SM_AES128_ACTIVE;
     sm_aes128_context = context;
 
-#ifdef HAVE_AES128
-    // calc result directly
-    sm_key_t result;
-    btstack_aes128_calc(key, plaintext, result);
-
-    // log
-    log_info_key("key", key);
-    log_info_key("txt", plaintext);
-    log_info_key("res", result);
-
-    // flip
-    reverse_128(&result[0], &aes128_result_flipped[0]);
-
-    // deliver via timer
-    btstack_run_loop_set_timer_handler(&aes128_timer, &aes128_completed);
-    btstack_run_loop_set_timer(&aes128_timer, 0);    // no delay
-    btstack_run_loop_add_timer(&aes128_timer);
-#else
+    if (sm_aes128_engine){
+        // calc result directly, flip as done by controller
+        sm_key_t result;
+        (*sm_aes128_engine)(key, plaintext, result);
+        reverse_128(result, sm_aes128_result_flipped);
+        sm_aes128_result_ready = 1;
+        return;
+    }
+
     sm_key_t key_flipped, plaintext_flipped;
     reverse_128(key, key_flipped);
     reverse_128(plaintext, plaintext_flipped);
-    hci_send_cmd(&hci_le_encrypt, key_flipped, plaintext_flipped);
-#endif
+    hci_send_le_encrypt(key_flipped, plaintext_flipped);
 }
 
 // ah(k,r) helper
@@ -880,6 +890,87 @@ static void sm_setup_key_distribution(uint8_t key_set){
 
 // CSRK Key Lookup
 
+static int sm_is_resolvable_private_address(int addr_type, const uint8_t * addr){
+    return addr_type == BD_ADDR_TYPE_LE_RANDOM && (addr[0] & 0xc0) == 0x40;
+}
+
+static int sm_rpa_cache_lookup(const uint8_t * addr){
+    int i;
+    for (i=0;i<SM_RPA_CACHE_SIZE;i++){
+        sm_rpa_cache_entry_t * entry = &sm_rpa_cache[i];
+        if (entry->le_db_index < 0) continue;
+        if (memcmp(entry->address, addr, 6) != 0) continue;
+        // validate against LE Device DB, entry might have been removed or replaced
+        int addr_type = -1;
+        sm_key_t irk;
+        le_device_db_info(entry->le_db_index, &addr_type, NULL, irk);
+        if (addr_type < 0 || addr_type > 1 || memcmp(irk, entry->irk, 16) != 0){
+            entry->le_db_index = -1;
+            return -1;
+        }
+        entry->last_used = ++sm_rpa_cache_time;
+        return entry->le_db_index;
+    }
+    return -1;
+}
+
+static void sm_rpa_cache_add(const uint8_t * addr, int le_db_index){
+    int i;
+    sm_rpa_cache_entry_t * oldest = &sm_rpa_cache[0];
+    for (i=0;i<SM_RPA_CACHE_SIZE;i++){
+        sm_rpa_cache_entry_t * entry = &sm_rpa_cache[i];
+        if (entry->le_db_index < 0) {
+            oldest = entry;
+            break;
+        }
+        if (entry->last_used < oldest->last_used){
+            oldest = entry;
+        }
+    }
+    memcpy(oldest->address, addr, 6);
+    le_device_db_info(le_db_index, NULL, NULL, oldest->irk);
+    oldest->le_db_index = le_db_index;
+    oldest->last_used = ++sm_rpa_cache_time;
+}
+
+static void sm_rpa_cache_reset(void){
+    int i;
+    for (i=0;i<SM_RPA_CACHE_SIZE;i++){
+        sm_rpa_cache[i].le_db_index = -1;
+    }
+    sm_rpa_cache_time = 0;
+}
+
+// check all devices in a single pass using the host aes128 engine
+static int sm_address_resolution_host_lookup(int addr_type, const uint8_t * addr){
+    int resolvable = sm_is_resolvable_private_address(addr_type, addr);
+    if (resolvable){
+        int index = sm_rpa_cache_lookup(addr);
+        if (index >= 0) return index;
+    }
+    sm_key_t r_prime;
+    sm_ah_r_prime((uint8_t *) addr, r_prime);
+    int count = le_device_db_count();
+    int i;
+    for (i=0;i<count;i++){
+        int db_addr_type = -1;
+        bd_addr_t db_addr;
+        sm_key_t irk;
+        le_device_db_info(i, &db_addr_type, db_addr, irk);
+        if (db_addr_type < 0 || db_addr_type > 1) continue;
+        if (addr_type == db_addr_type && memcmp(addr, db_addr, 6) == 0) return i;
+        if (addr_type == 0) continue;
+        // ah(irk, prand) = hash
+        sm_key_t result;
+        (*sm_aes128_engine)(irk, r_prime, result);
+        if (memcmp(&result[13], &addr[3], 3) != 0) continue;
+        if (resolvable){
+            sm_rpa_cache_add(addr, i);
+        }
+        return i;
+    }
+    return -1;
+}
 
 static int sm_address_resolution_idle(void){
     return sm_address_resolution_mode == ADDRESS_RESOLUTION_IDLE;
@@ -1912,7 +2003,106 @@ static void sm_start_calculating_ltk_from_ediv_and_rand(sm_connection_t * sm_con
 }
 #endif
 
-static void sm_run(void){
+// CSRK Lookup
+// -- with host aes128 engine, all pending lookups are processed in a single pass
+// returns 1 if aes128 engine was started
+static int sm_address_resolution_run(void){
+    btstack_linked_list_iterator_t it;
+    while (1) {
+
+        // -- if csrk lookup ready, find connection that require csrk lookup
+        if (sm_address_resolution_idle()){
+            hci_connections_get_iterator(&it);
+            while(btstack_linked_list_iterator_has_next(&it)){
+                hci_connection_t * hci_connection = (hci_connection_t *) btstack_linked_list_iterator_next(&it);
+                sm_connection_t  * sm_connection  = &hci_connection->sm_connection;
+                if (sm_connection->sm_irk_lookup_state == IRK_LOOKUP_W4_READY){
+                    // and start lookup
+                    sm_address_resolution_start_lookup(sm_connection->sm_peer_addr_type, sm_connection->sm_handle, sm_connection->sm_peer_address, ADDRESS_RESOLUTION_FOR_CONNECTION, sm_connection);
+                    sm_connection->sm_irk_lookup_state = IRK_LOOKUP_STARTED;
+                    break;
+                }
+            }
+        }
+
+        // -- if csrk lookup ready, resolved addresses for received addresses
+        if (sm_address_resolution_idle()) {
+            if (!btstack_linked_list_empty(&sm_address_resolution_general_queue)){
+                sm_lookup_entry_t * entry = (sm_lookup_entry_t *) sm_address_resolution_general_queue;
+                btstack_linked_list_remove(&sm_address_resolution_general_queue, (btstack_linked_item_t *) entry);
+                sm_address_resolution_start_lookup(entry->address_type, 0, entry->address, ADDRESS_RESOLUTION_GENERAL, NULL);
+                btstack_memory_sm_lookup_entry_free(entry);
+            }
+        }
+
+        if (sm_address_resolution_idle()) return 0;
+
+        // -- resolve address directly with host aes128 engine
+        if (sm_aes128_engine){
+            sm_address_resolution_test = sm_address_resolution_host_lookup(sm_address_resolution_addr_type, sm_address_resolution_address);
+            if (sm_address_resolution_test >= 0){
+                log_info("LE Device Lookup: found device %u", sm_address_resolution_test);
+                sm_address_resolution_handle_event(ADDRESS_RESOLUTION_SUCEEDED);
+            } else {
+                log_info("LE Device Lookup: not found");
+                sm_address_resolution_handle_event(ADDRESS_RESOLUTION_FAILED);
+            }
+            continue;
+        }
+
+        // -- check recently resolved addresses before asking the controller
+        if (sm_address_resolution_test == 0 && !sm_address_resolution_ah_calculation_active
+        &&  sm_is_resolvable_private_address(sm_address_resolution_addr_type, sm_address_resolution_address)){
+            int index = sm_rpa_cache_lookup(sm_address_resolution_address);
+            if (index >= 0){
+                log_info("LE Device Lookup: found device %u in cache", index);
+                sm_address_resolution_test = index;
+                sm_address_resolution_handle_event(ADDRESS_RESOLUTION_SUCEEDED);
+                return 0;
+            }
+        }
+
+        // -- Continue with CSRK device lookup by public or resolvable private address
+        log_info("LE Device Lookup: device %u/%u", sm_address_resolution_test, le_device_db_count());
+        while (sm_address_resolution_test < le_device_db_count()){
+            int addr_type;
+            bd_addr_t addr;
+            sm_key_t irk;
+            le_device_db_info(sm_address_resolution_test, &addr_type, addr, irk);
+            log_info("device type %u, addr: %s", addr_type, bd_addr_to_str(addr));
+
+            if (sm_address_resolution_addr_type == addr_type && memcmp(addr, sm_address_resolution_address, 6) == 0){
+                log_info("LE Device Lookup: found CSRK by { addr_type, address} ");
+                sm_address_resolution_handle_event(ADDRESS_RESOLUTION_SUCEEDED);
+                break;
+            }
+
+            if (sm_address_resolution_addr_type == 0){
+                sm_address_resolution_test++;
+                continue;
+            }
+
+            if (sm_aes128_state == SM_AES128_ACTIVE) break;
+
+            log_info("LE Device Lookup: calculate AH");
+            log_info_key("IRK", irk);
+
+            sm_key_t r_prime;
+            sm_ah_r_prime(sm_address_resolution_address, r_prime);
+            sm_address_resolution_ah_calculation_active = 1;
+            sm_aes128_start(irk, r_prime, sm_address_resolution_context);   // keep context
+            return 1;
+        }
+
+        if (sm_address_resolution_test >= le_device_db_count()){
+            log_info("LE Device Lookup: not found");
+            sm_address_resolution_handle_event(ADDRESS_RESOLUTION_FAILED);
+        }
+        return 0;
+    }
+}
+
+static void sm_run_once(void){
 
     btstack_linked_list_iterator_t it;
 
@@ -2007,69 +2197,7 @@ static void sm_run(void){
 #endif
 
     // CSRK Lookup
-    // -- if csrk lookup ready, find connection that require csrk lookup
-    if (sm_address_resolution_idle()){
-        hci_connections_get_iterator(&it);
-        while(btstack_linked_list_iterator_has_next(&it)){
-            hci_connection_t * hci_connection = (hci_connection_t *) btstack_linked_list_iterator_next(&it);
-            sm_connection_t  * sm_connection  = &hci_connection->sm_connection;
-            if (sm_connection->sm_irk_lookup_state == IRK_LOOKUP_W4_READY){
-                // and start lookup
-                sm_address_resolution_start_lookup(sm_connection->sm_peer_addr_type, sm_connection->sm_handle, sm_connection->sm_peer_address, ADDRESS_RESOLUTION_FOR_CONNECTION, sm_connection);
-                sm_connection->sm_irk_lookup_state = IRK_LOOKUP_STARTED;
-                break;
-            }
-        }
-    }
-
-    // -- if csrk lookup ready, resolved addresses for received addresses
-    if (sm_address_resolution_idle()) {
-        if (!btstack_linked_list_empty(&sm_address_resolution_general_queue)){
-            sm_lookup_entry_t * entry = (sm_lookup_entry_t *) sm_address_resolution_general_queue;
-            btstack_linked_list_remove(&sm_address_resolution_general_queue, (btstack_linked_item_t *) entry);
-            sm_address_resolution_start_lookup(entry->address_type, 0, entry->address, ADDRESS_RESOLUTION_GENERAL, NULL);
-            btstack_memory_sm_lookup_entry_free(entry);
-        }
-    }
-
-    // -- Continue with CSRK device lookup by public or resolvable private address
-    if (!sm_address_resolution_idle()){
-        log_info("LE Device Lookup: device %u/%u", sm_address_resolution_test, le_device_db_count());
-        while (sm_address_resolution_test < le_device_db_count()){
-            int addr_type;
-            bd_addr_t addr;
-            sm_key_t irk;
-            le_device_db_info(sm_address_resolution_test, &addr_type, addr, irk);
-            log_info("device type %u, addr: %s", addr_type, bd_addr_to_str(addr));
-
-            if (sm_address_resolution_addr_type == addr_type && memcmp(addr, sm_address_resolution_address, 6) == 0){
-                log_info("LE Device Lookup: found CSRK by { addr_type, address} ");
-                sm_address_resolution_handle_event(ADDRESS_RESOLUTION_SUCEEDED);
-                break;
-            }
-
-            if (sm_address_resolution_addr_type == 0){
-                sm_address_resolution_test++;
-                continue;
-            }
-
-            if (sm_aes128_state == SM_AES128_ACTIVE) break;
-
-            log_info("LE Device Lookup: calculate AH");
-            log_info_key("IRK", irk);
-
-            sm_key_t r_prime;
-            sm_ah_r_prime(sm_address_resolution_address, r_prime);
-            sm_address_resolution_ah_calculation_active = 1;
-            sm_aes128_start(irk, r_prime, sm_address_resolution_context);   // keep context
-            return;
-        }
-
-        if (sm_address_resolution_test >= le_device_db_count()){
-            log_info("LE Device Lookup: not found");
-            sm_address_resolution_handle_event(ADDRESS_RESOLUTION_FAILED);
-        }
-    }
+    if (sm_address_resolution_run()) return;
 
     // handle basic actions that don't requires the full context
     hci_connections_get_iterator(&it);
@@ -2713,6 +2841,24 @@ static void sm_run(void){
     }
 }
 
+static void sm_run(void){
+    sm_run_nesting++;
+    sm_run_once();
+    // host aes128 engine: process results here instead of in HCI event handler.
+    // nested calls, e.g. from CMAC done handlers, are handled by the loop of the outermost call
+    if (sm_run_nesting == 1){
+        while (sm_aes128_result_ready){
+            sm_aes128_result_ready = 0;
+            // result buffer gets overwritten if the handler starts the next aes128 operation
+            sm_key_t result;
+            memcpy(result, sm_aes128_result_flipped, 16);
+            sm_handle_encryption_result(result);
+            sm_run_once();
+        }
+    }
+    sm_run_nesting--;
+}
+
 // note: aes engine is ready as we just got the aes result
 static void sm_handle_encryption_result(uint8_t * data){
 
@@ -2725,6 +2871,9 @@ static void sm_handle_encryption_result(uint8_t * data){
         reverse_24(data, hash);
         if (memcmp(&sm_address_resolution_address[3], hash, 3) == 0){
             log_info("LE Device Lookup: matched resolvable private address");
+            if (sm_is_resolvable_private_address(sm_address_resolution_addr_type, sm_address_resolution_address)){
+                sm_rpa_cache_add(sm_address_resolution_address, sm_address_resolution_test);
+            }
             sm_address_resolution_handle_event(ADDRESS_RESOLUTION_SUCEEDED);
             return;
         }
@@ -3901,6 +4050,10 @@ void sm_set_ir(sm_key_t ir){
     memcpy(sm_persistent_ir, ir, 16);
 }
 
+void sm_set_aes128_engine(void (*aes128_calc)(const uint8_t * key, const uint8_t * plaintext, uint8_t * result)){
+    sm_aes128_engine = aes128_calc;
+}
+
 // Testing support only
 void sm_test_set_irk(sm_key_t irk){
     memcpy(sm_persistent_irk, irk, 16);
@@ -3940,10 +4093,12 @@ void sm_init(void){
     dkg_state = DKG_W4_WORKING;
     rau_state = RAU_W4_WORKING;
     sm_aes128_state = SM_AES128_IDLE;
+    sm_aes128_result_ready = 0;
     sm_address_resolution_test = -1;    // no private address to resolve yet
     sm_address_resolution_ah_calculation_active = 0;
     sm_address_resolution_mode = ADDRESS_RESOLUTION_IDLE;
     sm_address_resolution_general_queue = NULL;
+    sm_rpa_cache_reset();
 
     gap_random_adress_update_period = 15 * 60 * 1000L;
     sm_active_connection_handle = HCI_CON_HANDLE_INVALID;
@@ -4204,6 +4359,12 @@ int sm_le_device_index(hci_con_handle_t con_handle ){
     return sm_conn->sm_le_db_index;
 }
 
+int sm_resolve_rpa(bd_addr_t address){
+    if (!sm_aes128_engine) return -1;
+    if (!sm_is_resolvable_private_address(BD_ADDR_TYPE_LE_RANDOM, address)) return -1;
+    return sm_address_resolution_host_lookup(BD_ADDR_TYPE_LE_RANDOM, address);
+}
+
 static int gap_random_address_type_requires_updates(void){
     if (gap_random_adress_type == GAP_RANDOM_ADDRESS_TYPE_OFF) return 0;
     if (gap_random_adress_type == GAP_RANDOM_ADDRESS_TYPE_OFF) return 0;
@@ -115,6 +115,13 @@ void sm_set_er(sm_key_t er);
  */
 void sm_set_ir(sm_key_t ir);
 
+/**
+ * @brief Use host AES-128 implementation instead of HCI LE Encrypt command, e.g. btstack_aes128_host_calc.
+ *        Results are processed right away, so CMAC calculations complete without waiting for the controller.
+ * @param aes128_calc function to encrypt plaintext with key, all values big endian. NULL to use HCI LE Encrypt
+ */
+void sm_set_aes128_engine(void (*aes128_calc)(const uint8_t * key, const uint8_t * plaintext, uint8_t * result));
+
 /**
  *
  * @brief Registers OOB Data Callback. The callback should set the oob_data and return 1 if OOB data is availble
@@ -281,6 +288,15 @@ int sm_address_resolution_lookup(uint8_t addr_type, bd_addr_t addr);
  */
 int sm_le_device_index(hci_con_handle_t con_handle );
 
+/**
+ * @brief Resolve resolvable private address against all devices in LE Device DB without emitting events.
+ *        Recently resolved addresses are cached.
+ * @note Requires an AES128 engine on the host, see sm_set_aes128_engine
+ * @param address
+ * @return index from le_device_db or -1 if not resolved or no host AES128 engine is set
+ */
+int sm_resolve_rpa(bd_addr_t address);
+
 /**
  * @brief Set Elliptic Key Public/Private Keypair
  * @note Using the same key for more than one device is not recommended. 
@@ -0,0 +1,256 @@
+/*
+ * Copyright (C) 2017 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+#define __BTSTACK_FILE__ "btstack_aes128.c"
+
+/*
+ *  btstack_aes128.c
+ *
+ *  AES-128 encryption (FIPS-197). The portable version uses a single 1 kB T-table that is
+ *  computed on first use. On x86 with GCC or Clang, the AESENC instructions are used instead
+ *  if CPUID reports AES-NI. Built with -maes, AES-NI is used without checking the CPU.
+ */
+
+#include "btstack_aes128.h"
+#include "btstack_util.h"
+
+#include <string.h>
+
+#if BTSTACK_AES128_AESNI
+#include <wmmintrin.h>
+#ifndef __AES__
+#include <cpuid.h>
+#endif
+
+#define AES128_AESNI_TARGET __attribute__((target("aes")))
+
+#ifndef __AES__
+// 0 = not checked yet, 1 = not supported, 2 = supported
+static int btstack_aes128_aesni_state;
+#endif
+
+static inline int btstack_aes128_aesni_supported(void){
+#ifdef __AES__
+    return 1;
+#else
+    if (btstack_aes128_aesni_state == 0){
+        unsigned int eax, ebx, ecx, edx;
+        // CPUID leaf 1, ECX bit 25: AES-NI
+        int supported = __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & (1u << 25));
+        btstack_aes128_aesni_state = supported ? 2 : 1;
+    }
+    return btstack_aes128_aesni_state == 2;
+#endif
+}
+
+static inline AES128_AESNI_TARGET __m128i btstack_aes128_expand_round_key(__m128i key, __m128i key_gen_assist){
+    key_gen_assist = _mm_shuffle_epi32(key_gen_assist, _MM_SHUFFLE(3,3,3,3));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    return _mm_xor_si128(key, key_gen_assist);
+}
+
+// rcon has to be an immediate value
+#define AES128_EXPAND_ROUND_KEY(round_keys, round, rcon) \
+    round_keys[round] = btstack_aes128_expand_round_key(round_keys[round-1], _mm_aeskeygenassist_si128(round_keys[round-1], rcon))
+
+static AES128_AESNI_TARGET void btstack_aes128_set_key_aesni(btstack_aes128_t * context, const uint8_t * key){
+    __m128i round_keys[11];
+    round_keys[0] = _mm_loadu_si128((const __m128i *) key);
+    AES128_EXPAND_ROUND_KEY(round_keys,  1, 0x01);
+    AES128_EXPAND_ROUND_KEY(round_keys,  2, 0x02);
+    AES128_EXPAND_ROUND_KEY(round_keys,  3, 0x04);
+    AES128_EXPAND_ROUND_KEY(round_keys,  4, 0x08);
+    AES128_EXPAND_ROUND_KEY(round_keys,  5, 0x10);
+    AES128_EXPAND_ROUND_KEY(round_keys,  6, 0x20);
+    AES128_EXPAND_ROUND_KEY(round_keys,  7, 0x40);
+    AES128_EXPAND_ROUND_KEY(round_keys,  8, 0x80);
+    AES128_EXPAND_ROUND_KEY(round_keys,  9, 0x1b);
+    AES128_EXPAND_ROUND_KEY(round_keys, 10, 0x36);
+    int i;
+    for (i = 0; i < 11; i++){
+        _mm_storeu_si128((__m128i *) &context->round_keys[i * 4], round_keys[i]);
+    }
+}
+
+static AES128_AESNI_TARGET void btstack_aes128_encrypt_aesni(const btstack_aes128_t * context, const uint8_t * plaintext, uint8_t * ciphertext){
+    const __m128i * round_keys = (const __m128i *) context->round_keys;
+    __m128i state = _mm_xor_si128(_mm_loadu_si128((const __m128i *) plaintext), _mm_loadu_si128(&round_keys[0]));
+    int i;
+    for (i = 1; i < 10; i++){
+        state = _mm_aesenc_si128(state, _mm_loadu_si128(&round_keys[i]));
+    }
+    state = _mm_aesenclast_si128(state, _mm_loadu_si128(&round_keys[10]));
+    _mm_storeu_si128((__m128i *) ciphertext, state);
+}
+
+#endif
+
+static const uint8_t aes128_sbox[256] = {
+    0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+    0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+    0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+    0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+    0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+    0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+    0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+    0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+    0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+    0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+    0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+    0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+    0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+    0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+    0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+    0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16,
+};
+
+// SubBytes + MixColumns for one byte in row 0: { 2 s, s, s, 3 s }, other rows by rotation
+static uint32_t aes128_t_table[256];
+static int      aes128_t_table_ready;
+
+static inline uint32_t aes128_ror8(uint32_t value){
+    return (value >> 8) | (value << 24);
+}
+
+static void btstack_aes128_init_t_table(void){
+    int i;
+    for (i = 0; i < 256; i++){
+        uint8_t s  = aes128_sbox[i];
+        uint8_t s2 = (uint8_t) ((s << 1) ^ ((s & 0x80) ? 0x1b : 0x00));
+        uint8_t s3 = s2 ^ s;
+        aes128_t_table[i] = ((uint32_t) s2 << 24) | ((uint32_t) s << 16) | ((uint32_t) s << 8) | s3;
+    }
+    aes128_t_table_ready = 1;
+}
+
+static inline uint32_t aes128_sub_word(uint32_t word){
+    return ((uint32_t) aes128_sbox[word >> 24] << 24) | ((uint32_t) aes128_sbox[(word >> 16) & 0xff] << 16) |
+           ((uint32_t) aes128_sbox[(word >>  8) & 0xff] <<  8) | aes128_sbox[word & 0xff];
+}
+
+static void btstack_aes128_set_key_table(btstack_aes128_t * context, const uint8_t * key){
+    static const uint8_t rcon[10] = { 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36 };
+    uint32_t * rk = context->round_keys;
+    int i;
+    if (!aes128_t_table_ready){
+        btstack_aes128_init_t_table();
+    }
+    for (i = 0; i < 4; i++){
+        rk[i] = big_endian_read_32(key, i * 4);
+    }
+    for (i = 4; i < 44; i++){
+        uint32_t temp = rk[i-1];
+        if ((i & 3) == 0){
+            temp = aes128_sub_word((temp << 8) | (temp >> 24)) ^ ((uint32_t) rcon[i/4 - 1] << 24);
+        }
+        rk[i] = rk[i-4] ^ temp;
+    }
+}
+
+#define AES128_T0(x) (aes128_t_table[(x) >> 24])
+#define AES128_T1(x) aes128_ror8(aes128_t_table[((x) >> 16) & 0xff])
+#define AES128_T2(x) aes128_ror8(aes128_ror8(aes128_t_table[((x) >> 8) & 0xff]))
+#define AES128_T3(x) aes128_ror8(aes128_ror8(aes128_ror8(aes128_t_table[(x) & 0xff])))
+#define AES128_S(x, shift) ((uint32_t) aes128_sbox[((x) >> (shift)) & 0xff] << (shift))
+
+static void btstack_aes128_encrypt_table(const btstack_aes128_t * context, const uint8_t * plaintext, uint8_t * ciphertext){
+    const uint32_t * rk = context->round_keys;
+    uint32_t s0 = big_endian_read_32(plaintext,  0) ^ rk[0];
+    uint32_t s1 = big_endian_read_32(plaintext,  4) ^ rk[1];
+    uint32_t s2 = big_endian_read_32(plaintext,  8) ^ rk[2];
+    uint32_t s3 = big_endian_read_32(plaintext, 12) ^ rk[3];
+    uint32_t t0, t1, t2, t3;
+    int round;
+    for (round = 1; round < 10; round++){
+        rk += 4;
+        t0 = AES128_T0(s0) ^ AES128_T1(s1) ^ AES128_T2(s2) ^ AES128_T3(s3) ^ rk[0];
+        t1 = AES128_T0(s1) ^ AES128_T1(s2) ^ AES128_T2(s3) ^ AES128_T3(s0) ^ rk[1];
+        t2 = AES128_T0(s2) ^ AES128_T1(s3) ^ AES128_T2(s0) ^ AES128_T3(s1) ^ rk[2];
+        t3 = AES128_T0(s3) ^ AES128_T1(s0) ^ AES128_T2(s1) ^ AES128_T3(s2) ^ rk[3];
+        s0 = t0;
+        s1 = t1;
+        s2 = t2;
+        s3 = t3;
+    }
+    // final round without MixColumns
+    rk += 4;
+    t0 = AES128_S(s0, 24) ^ AES128_S(s1, 16) ^ AES128_S(s2, 8) ^ AES128_S(s3, 0) ^ rk[0];
+    t1 = AES128_S(s1, 24) ^ AES128_S(s2, 16) ^ AES128_S(s3, 8) ^ AES128_S(s0, 0) ^ rk[1];
+    t2 = AES128_S(s2, 24) ^ AES128_S(s3, 16) ^ AES128_S(s0, 8) ^ AES128_S(s1, 0) ^ rk[2];
+    t3 = AES128_S(s3, 24) ^ AES128_S(s0, 16) ^ AES128_S(s1, 8) ^ AES128_S(s2, 0) ^ rk[3];
+    big_endian_store_32(ciphertext,  0, t0);
+    big_endian_store_32(ciphertext,  4, t1);
+    big_endian_store_32(ciphertext,  8, t2);
+    big_endian_store_32(ciphertext, 12, t3);
+}
+
+// round keys are stored in the format of the engine, which does not change at runtime
+
+void btstack_aes128_set_key(btstack_aes128_t * context, const uint8_t * key){
+#if BTSTACK_AES128_AESNI
+    if (btstack_aes128_aesni_supported()){
+        btstack_aes128_set_key_aesni(context, key);
+        return;
+    }
+#endif
+    btstack_aes128_set_key_table(context, key);
+}
+
+void btstack_aes128_encrypt(const btstack_aes128_t * context, const uint8_t * plaintext, uint8_t * ciphertext){
+#if BTSTACK_AES128_AESNI
+    if (btstack_aes128_aesni_supported()){
+        btstack_aes128_encrypt_aesni(context, plaintext, ciphertext);
+        return;
+    }
+#endif
+    btstack_aes128_encrypt_table(context, plaintext, ciphertext);
+}
+
+static btstack_aes128_t btstack_aes128_host_context;
+static uint8_t          btstack_aes128_host_key[16];
+static int              btstack_aes128_host_key_valid;
+
+void btstack_aes128_host_calc(const uint8_t * key, const uint8_t * plaintext, uint8_t * ciphertext){
+    if (!btstack_aes128_host_key_valid || memcmp(key, btstack_aes128_host_key, 16) != 0){
+        memcpy(btstack_aes128_host_key, key, 16);
+        btstack_aes128_set_key(&btstack_aes128_host_context, key);
+        btstack_aes128_host_key_valid = 1;
+    }
+    btstack_aes128_encrypt(&btstack_aes128_host_context, plaintext, ciphertext);
+}
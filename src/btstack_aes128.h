@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2017 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+/*
+ *  btstack_aes128.h
+ *
+ *  AES-128 encryption on the host, table-based or using AES-NI if supported by the CPU
+ */
+
+#ifndef __BTSTACK_AES128_H
+#define __BTSTACK_AES128_H
+
+#include <stdint.h>
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+// AES-NI is used on x86 with GCC or Clang if CPUID reports it, define as 0 to always use the T-table
+#ifndef BTSTACK_AES128_AESNI
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define BTSTACK_AES128_AESNI 1
+#else
+#define BTSTACK_AES128_AESNI 0
+#endif
+#endif
+
+typedef struct {
+    // 11 round keys
+    uint32_t round_keys[44];
+} btstack_aes128_t;
+
+/* API_START */
+
+/**
+ * @brief Expand key for AES-128 encryption. On x86, AES-NI is used if CPUID reports it,
+ *        the round keys can only be used with the engine selected at runtime
+ * @param context
+ * @param key (128 bit)
+ */
+void btstack_aes128_set_key(btstack_aes128_t * context, const uint8_t * key);
+
+/**
+ * @brief Encrypt single block with key set by btstack_aes128_set_key
+ * @param context
+ * @param plaintext (128 bit)
+ * @param ciphertext (128 bit), may be same as plaintext
+ */
+void btstack_aes128_encrypt(const btstack_aes128_t * context, const uint8_t * plaintext, uint8_t * ciphertext);
+
+/**
+ * @brief Encrypt single block. The expanded key of the last call is reused if the key did not change, 
+ *        e.g. for the blocks of a CMAC calculation. Can be used with sm_set_aes128_engine
+ * @param key (128 bit)
+ * @param plaintext (128 bit)
+ * @param ciphertext (128 bit)
+ */
+void btstack_aes128_host_calc(const uint8_t * key, const uint8_t * plaintext, uint8_t * ciphertext);
+
+/* API_END */
+
+#if defined __cplusplus
+}
+#endif
+
+#endif // __BTSTACK_AES128_H
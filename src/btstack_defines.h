@@ -410,6 +410,7 @@ typedef uint8_t sm_key_t[16];
 
 /**
  * @brief Outgoing packet 
+ * Transports that implement send_packet_with_header add the packet type as parameter
  */
 #define HCI_EVENT_TRANSPORT_PACKET_SENT                    0x6E
 
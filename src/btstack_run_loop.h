@@ -47,6 +47,7 @@
 #include "btstack_config.h"
 
 #include "btstack_linked_list.h"
+#include "btstack_defines.h"
 
 #include <stdint.h>
 
@@ -105,6 +106,7 @@ typedef struct btstack_run_loop {
 	void (*execute)(void);
 	void (*dump_timer)(void);
 	uint32_t (*get_time_ms)(void);
+	void (*execute_on_main_thread)(btstack_context_callback_registration_t * callback_registration);
 } btstack_run_loop_t;
 
 void btstack_run_loop_timer_dump(void);
@@ -204,6 +206,14 @@ int btstack_run_loop_remove_data_source(btstack_data_source_t * data_source);
  */
 void btstack_run_loop_execute(void);
 
+/**
+ * @brief Execute callback from run loop. Can be called from other threads, and from ISRs on embedded.
+ * @note The callback registration is queued without copying and must not be posted again before its callback was called.
+ *       Not supported by all run loop implementations.
+ * @param callback_registration
+ */
+void btstack_run_loop_execute_on_main_thread(btstack_context_callback_registration_t * callback_registration);
+
 /* API_END */
 
 #if defined __cplusplus
@@ -0,0 +1,294 @@
+/*
+ * Copyright (C) 2017 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+#define __BTSTACK_FILE__ "btstack_timer_wheel.c"
+
+/*
+ *  btstack_timer_wheel.c
+ *
+ *  Hashed timer wheel. Callers may change the timeout of an active timer with btstack_run_loop_set_timer
+ *  before removing or adding it again. Remove then does not find the timer in the slot for its new timeout
+ *  and falls back to searching all slots, which costs about as much as removing it from a sorted timer list.
+ *  Add rejects a timer that is active in any slot: the last timer of a slot points to an end marker
+ *  instead of NULL, so only timers with a successor have to be looked up.
+ */
+
+#include <stddef.h>
+
+#include "btstack_timer_wheel.h"
+#include "btstack_debug.h"
+
+// successor of the last timer in a slot, timers that are not in a slot have no successor
+static btstack_linked_item_t btstack_timer_wheel_end;
+
+static inline btstack_linked_item_t * btstack_timer_wheel_next(btstack_linked_item_t * item){
+    return (item->next == &btstack_timer_wheel_end) ? NULL : item->next;
+}
+
+// wrap-around safe comparison of timestamps
+static inline int btstack_timer_wheel_is_before(uint32_t a, uint32_t b){
+    return (int32_t)(a - b) < 0;
+}
+
+static inline uint32_t btstack_timer_wheel_slot_width(btstack_timer_wheel_t * timer_wheel){
+    return 1u << timer_wheel->slot_shift;
+}
+
+static inline uint32_t btstack_timer_wheel_align(btstack_timer_wheel_t * timer_wheel, uint32_t time){
+    return time & ~(btstack_timer_wheel_slot_width(timer_wheel) - 1);
+}
+
+static inline uint32_t btstack_timer_wheel_index_for_time(btstack_timer_wheel_t * timer_wheel, uint32_t time){
+    return (time >> timer_wheel->slot_shift) & timer_wheel->num_slots_mask;
+}
+
+// timers that already expired before the cursor time are kept in the cursor slot
+static btstack_timer_wheel_slot_t * btstack_timer_wheel_slot_for_timeout(btstack_timer_wheel_t * timer_wheel, uint32_t timeout){
+    if (btstack_timer_wheel_is_before(timeout, timer_wheel->cursor_time)){
+        timeout = timer_wheel->cursor_time;
+    }
+    return &timer_wheel->slots[btstack_timer_wheel_index_for_time(timer_wheel, timeout)];
+}
+
+static int btstack_timer_wheel_slot_remove(btstack_timer_wheel_slot_t * slot, btstack_linked_item_t * item){
+    btstack_linked_item_t * prev = NULL;
+    btstack_linked_item_t * it;
+    for (it = slot->head; it ; it = btstack_timer_wheel_next(it)){
+        if (it != item) {
+            prev = it;
+            continue;
+        }
+        if (prev){
+            prev->next = it->next;
+        } else {
+            slot->head = btstack_timer_wheel_next(it);
+        }
+        if (slot->tail == it){
+            slot->tail = prev;
+        }
+        it->next = NULL;
+        return 1;
+    }
+    return 0;
+}
+
+static int btstack_timer_wheel_slot_contains(btstack_timer_wheel_slot_t * slot, btstack_linked_item_t * item){
+    btstack_linked_item_t * it;
+    for (it = slot->head; it ; it = btstack_timer_wheel_next(it)){
+        if (it == item) return 1;
+    }
+    return 0;
+}
+
+// a successor might also be left in a timer that was never added, search all slots then
+static int btstack_timer_wheel_contains(btstack_timer_wheel_t * timer_wheel, btstack_timer_source_t * timer){
+    btstack_linked_item_t * item = (btstack_linked_item_t *) timer;
+    if (item->next == NULL) return 0;
+    uint32_t i;
+    for (i = 0; i <= timer_wheel->num_slots_mask; i++){
+        if (btstack_timer_wheel_slot_contains(&timer_wheel->slots[i], item)) return 1;
+    }
+    return 0;
+}
+
+static void btstack_timer_wheel_removed(btstack_timer_wheel_t * timer_wheel, btstack_timer_source_t * timer){
+    timer_wheel->num_timers--;
+    if (timer_wheel->next_timeout_valid && timer->timeout == timer_wheel->next_timeout){
+        timer_wheel->next_timeout_valid = 0;
+    }
+}
+
+// find earliest timer in slot, optionally limited to timers before a given time
+static btstack_timer_source_t * btstack_timer_wheel_slot_get_earliest(btstack_timer_wheel_slot_t * slot, int limited, uint32_t limit){
+    btstack_timer_source_t * earliest = NULL;
+    btstack_linked_item_t * it;
+    for (it = slot->head; it ; it = btstack_timer_wheel_next(it)){
+        btstack_timer_source_t * ts = (btstack_timer_source_t *) it;
+        if (limited && !btstack_timer_wheel_is_before(ts->timeout, limit)) continue;
+        if (earliest == NULL || btstack_timer_wheel_is_before(ts->timeout, earliest->timeout)){
+            earliest = ts;
+        }
+    }
+    return earliest;
+}
+
+static btstack_timer_source_t * btstack_timer_wheel_get_earliest(btstack_timer_wheel_t * timer_wheel){
+    btstack_timer_source_t * earliest = NULL;
+    uint32_t i;
+    for (i = 0; i <= timer_wheel->num_slots_mask; i++){
+        btstack_timer_source_t * ts = btstack_timer_wheel_slot_get_earliest(&timer_wheel->slots[i], 0, 0);
+        if (ts == NULL) continue;
+        if (earliest == NULL || btstack_timer_wheel_is_before(ts->timeout, earliest->timeout)){
+            earliest = ts;
+        }
+    }
+    return earliest;
+}
+
+void btstack_timer_wheel_init(btstack_timer_wheel_t * timer_wheel, btstack_timer_wheel_slot_t * slots, uint32_t num_slots, uint8_t slot_shift, uint32_t now){
+    uint32_t i;
+    timer_wheel->slots = slots;
+    timer_wheel->num_slots_mask = num_slots - 1;
+    timer_wheel->slot_shift = slot_shift;
+    timer_wheel->cursor_time = btstack_timer_wheel_align(timer_wheel, now);
+    timer_wheel->num_timers = 0;
+    timer_wheel->next_timeout_valid = 0;
+    for (i = 0; i < num_slots; i++){
+        slots[i].head = NULL;
+        slots[i].tail = NULL;
+    }
+}
+
+int btstack_timer_wheel_add(btstack_timer_wheel_t * timer_wheel, btstack_timer_source_t * timer){
+    // timer might be active in the slot for its previous timeout
+    if (btstack_timer_wheel_contains(timer_wheel, timer)){
+        log_error("btstack_timer_wheel_add error: timer to add already in list!");
+        return 0;
+    }
+    btstack_timer_wheel_slot_t * slot = btstack_timer_wheel_slot_for_timeout(timer_wheel, timer->timeout);
+    // append to keep insertion order for equal timeouts
+    timer->item.next = &btstack_timer_wheel_end;
+    if (slot->tail){
+        slot->tail->next = (btstack_linked_item_t *) timer;
+    } else {
+        slot->head = (btstack_linked_item_t *) timer;
+    }
+    slot->tail = (btstack_linked_item_t *) timer;
+
+    if (timer_wheel->num_timers == 0){
+        timer_wheel->next_timeout = timer->timeout;
+        timer_wheel->next_timeout_valid = 1;
+    } else if (timer_wheel->next_timeout_valid && btstack_timer_wheel_is_before(timer->timeout, timer_wheel->next_timeout)){
+        timer_wheel->next_timeout = timer->timeout;
+    }
+    timer_wheel->num_timers++;
+    return 1;
+}
+
+int btstack_timer_wheel_remove(btstack_timer_wheel_t * timer_wheel, btstack_timer_source_t * timer){
+    // not in a slot
+    if (timer->item.next == NULL) return 0;
+    btstack_timer_wheel_slot_t * slot = btstack_timer_wheel_slot_for_timeout(timer_wheel, timer->timeout);
+    if (!btstack_timer_wheel_slot_remove(slot, (btstack_linked_item_t *) timer)){
+        // timeout changed after add, or timer not active
+        uint32_t i;
+        for (i = 0; i <= timer_wheel->num_slots_mask; i++){
+            if (btstack_timer_wheel_slot_remove(&timer_wheel->slots[i], (btstack_linked_item_t *) timer)) break;
+        }
+        if (i > timer_wheel->num_slots_mask) return 0;
+        // cached earliest timeout may belong to this timer
+        timer_wheel->next_timeout_valid = 0;
+    }
+    btstack_timer_wheel_removed(timer_wheel, timer);
+    return 1;
+}
+
+int btstack_timer_wheel_get_next_timeout(btstack_timer_wheel_t * timer_wheel, uint32_t * timeout){
+    if (timer_wheel->num_timers == 0) return 0;
+    if (!timer_wheel->next_timeout_valid){
+        // the first slot in cursor order that has a timer within the current revolution holds the earliest timer
+        uint32_t slot_width = btstack_timer_wheel_slot_width(timer_wheel);
+        uint32_t window_end = timer_wheel->cursor_time;
+        uint32_t index = btstack_timer_wheel_index_for_time(timer_wheel, timer_wheel->cursor_time);
+        btstack_timer_source_t * earliest = NULL;
+        uint32_t i;
+        for (i = 0; i <= timer_wheel->num_slots_mask && earliest == NULL; i++){
+            window_end += slot_width;
+            earliest = btstack_timer_wheel_slot_get_earliest(&timer_wheel->slots[index], 1, window_end);
+            index = (index + 1) & timer_wheel->num_slots_mask;
+        }
+        // all timers expire in later revolutions
+        if (earliest == NULL){
+            earliest = btstack_timer_wheel_get_earliest(timer_wheel);
+        }
+        timer_wheel->next_timeout = earliest->timeout;
+        timer_wheel->next_timeout_valid = 1;
+    }
+    *timeout = timer_wheel->next_timeout;
+    return 1;
+}
+
+btstack_timer_source_t * btstack_timer_wheel_pop_expired(btstack_timer_wheel_t * timer_wheel, uint32_t now){
+    uint32_t slot_width = btstack_timer_wheel_slot_width(timer_wheel);
+    uint32_t revolution = slot_width * (timer_wheel->num_slots_mask + 1);
+    while (1){
+        if (timer_wheel->num_timers == 0){
+            timer_wheel->cursor_time = btstack_timer_wheel_align(timer_wheel, now);
+            return NULL;
+        }
+
+        if ((now - timer_wheel->cursor_time) >= revolution){
+            // cursor lags more than one revolution behind, skip directly to the earliest timer or to now
+            uint32_t next_timeout;
+            btstack_timer_wheel_get_next_timeout(timer_wheel, &next_timeout);
+            if (btstack_timer_wheel_is_before(now, next_timeout)){
+                next_timeout = now;
+            }
+            next_timeout = btstack_timer_wheel_align(timer_wheel, next_timeout);
+            if (btstack_timer_wheel_is_before(timer_wheel->cursor_time, next_timeout)){
+                timer_wheel->cursor_time = next_timeout;
+            }
+        }
+
+        btstack_timer_wheel_slot_t * slot = &timer_wheel->slots[btstack_timer_wheel_index_for_time(timer_wheel, timer_wheel->cursor_time)];
+        btstack_timer_source_t * ts = btstack_timer_wheel_slot_get_earliest(slot, 1, now + 1);
+        if (ts){
+            btstack_timer_wheel_slot_remove(slot, (btstack_linked_item_t *) ts);
+            btstack_timer_wheel_removed(timer_wheel, ts);
+            return ts;
+        }
+
+        // stay in current slot until its time window has passed
+        if (btstack_timer_wheel_is_before(now, timer_wheel->cursor_time + slot_width)) return NULL;
+        timer_wheel->cursor_time += slot_width;
+    }
+}
+
+uint32_t btstack_timer_wheel_count(btstack_timer_wheel_t * timer_wheel){
+    return timer_wheel->num_timers;
+}
+
+void btstack_timer_wheel_dump(btstack_timer_wheel_t * timer_wheel){
+    uint32_t i;
+    for (i = 0; i <= timer_wheel->num_slots_mask; i++){
+        btstack_linked_item_t * it;
+        for (it = timer_wheel->slots[i].head; it ; it = btstack_timer_wheel_next(it)){
+            btstack_timer_source_t *ts = (btstack_timer_source_t*) it;
+            log_info("timer %p, slot %u, timeout %u\n", ts, i, ts->timeout);
+        }
+    }
+}
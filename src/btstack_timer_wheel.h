@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2017 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+/*
+ *  btstack_timer_wheel.h
+ *
+ *  Hashed timer wheel with O(1) add and O(1) expected remove for btstack_timer_source_t.
+ *  Run loop implementations can use it in their add_timer/remove_timer/execute hooks
+ *  instead of a sorted linked list.
+ *
+ *  Timers are hashed into slots by (timeout >> slot_shift). Each slot keeps a FIFO list of timers
+ *  that expire within its time window in the current or one of the following revolutions.
+ */
+
+#ifndef __BTSTACK_TIMER_WHEEL_H
+#define __BTSTACK_TIMER_WHEEL_H
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "btstack_run_loop.h"
+
+typedef struct {
+    btstack_linked_item_t * head;
+    btstack_linked_item_t * tail;
+} btstack_timer_wheel_slot_t;
+
+typedef struct btstack_timer_wheel {
+    btstack_timer_wheel_slot_t * slots;
+    uint32_t num_slots_mask;
+    uint8_t  slot_shift;
+    // start time of the slot at the cursor, all timers in other slots expire at or after this time
+    uint32_t cursor_time;
+    uint32_t num_timers;
+    // cached earliest timeout
+    uint32_t next_timeout;
+    uint8_t  next_timeout_valid;
+} btstack_timer_wheel_t;
+
+/**
+ * Init timer wheel
+ * @param timer_wheel object
+ * @param slots storage for num_slots slots
+ * @param num_slots power of two
+ * @param slot_shift log2 of slot width in ticks/ms
+ * @param now current time
+ */
+void btstack_timer_wheel_init(btstack_timer_wheel_t * timer_wheel, btstack_timer_wheel_slot_t * slots, uint32_t num_slots, uint8_t slot_shift, uint32_t now);
+
+/**
+ * Add timer. Timers with the same timeout expire in the order they were added
+ * @param timer_wheel object
+ * @param timer
+ * @return 0 if timer is already active, also if its timeout was changed after it was added
+ */
+int btstack_timer_wheel_add(btstack_timer_wheel_t * timer_wheel, btstack_timer_source_t * timer);
+
+/**
+ * Remove timer, also if its timeout was changed after it was added
+ * @param timer_wheel object
+ * @param timer
+ * @return 1 if timer was found
+ */
+int btstack_timer_wheel_remove(btstack_timer_wheel_t * timer_wheel, btstack_timer_source_t * timer);
+
+/**
+ * Get earliest timeout
+ * @param timer_wheel object
+ * @param timeout
+ * @return 0 if no timer is active
+ */
+int btstack_timer_wheel_get_next_timeout(btstack_timer_wheel_t * timer_wheel, uint32_t * timeout);
+
+/**
+ * Remove and return earliest timer that expired at or before now
+ * @param timer_wheel object
+ * @param now current time
+ * @return timer or NULL if none expired
+ */
+btstack_timer_source_t * btstack_timer_wheel_pop_expired(btstack_timer_wheel_t * timer_wheel, uint32_t now);
+
+/**
+ * Get number of active timers
+ * @param timer_wheel object
+ */
+uint32_t btstack_timer_wheel_count(btstack_timer_wheel_t * timer_wheel);
+
+/**
+ * Log all active timers via log_info
+ * @param timer_wheel object
+ */
+void btstack_timer_wheel_dump(btstack_timer_wheel_t * timer_wheel);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif // __BTSTACK_TIMER_WHEEL_H
@@ -145,8 +145,24 @@ typedef struct {
 
 } btstack_uart_block_t;
 
+typedef struct {
+    uint32_t bytes_received;        // bytes read by reader thread
+    uint32_t wakeups;               // run loop wakeups by reader thread
+    uint32_t ring_buffer_full;      // reader thread stopped reading as ring buffer was full
+    uint32_t ring_buffer_max_used;  // high water mark of ring buffer
+    uint32_t uart_overrun;          // UART overruns reported by driver, Linux only
+    uint32_t uart_buffer_overrun;   // driver buffer overruns reported by driver, Linux only
+} btstack_uart_posix_reader_stats_t;
+
 // common implementations
 const btstack_uart_block_t * btstack_uart_block_posix_instance(void);
+
+/**
+ * Get receive statistics of POSIX UART implementation. Reader thread counters require ENABLE_POSIX_UART_READER_THREAD
+ * @param stats
+ */
+void btstack_uart_block_posix_get_reader_stats(btstack_uart_posix_reader_stats_t * stats);
+
 const btstack_uart_block_t * btstack_uart_block_windows_instance(void);
 const btstack_uart_block_t * btstack_uart_block_embedded_instance(void);
 const btstack_uart_block_t * btstack_uart_block_freertos_instance(void);
@@ -71,6 +71,12 @@
 
 #define RFCOMM_CREDITS 10
 
+#ifdef ENABLE_RFCOMM_ADAPTIVE_CREDITS
+// adaptive credits: smallest credit window and period for drain rate samples
+#define RFCOMM_ADAPTIVE_CREDITS_MIN_WINDOW 2
+#define RFCOMM_ADAPTIVE_CREDITS_SAMPLE_MS  50
+#endif
+
 // FCS calc 
 #define BT_RFCOMM_CODE_WORD         0xE0 // pol = x8+x2+x1+1
 #define BT_RFCOMM_CRC_CHECK_LEN     3
@@ -420,16 +426,82 @@ static rfcomm_channel_t * rfcomm_channel_create(rfcomm_multiplexer_t * multiplex
     return channel;
 }
 
+static int rfcomm_channel_ready_for_client(rfcomm_channel_t * channel){
+    if (!channel->waiting_for_can_send_now)    return 0; // didn't try to send yet
+    if (!channel->credits_outgoing)            return 0; // or cannot yet either
+    if ((channel->multiplexer->fcon & 1) == 0) return 0;
+    return 1;
+}
+
+// deficit added per round, also limits the debt of a channel
+static int32_t rfcomm_scheduler_quantum(rfcomm_multiplexer_t * multiplexer){
+    return (int32_t) btstack_max(multiplexer->max_frame_size, 1);
+}
+
+// select next channel on multiplexer that can send: highest priority first, deficit round robin within same priority
+static rfcomm_channel_t * rfcomm_scheduler_next_channel(rfcomm_multiplexer_t * multiplexer){
+    btstack_linked_item_t * it;
+    rfcomm_channel_t * last_channel = NULL;
+    int     ready = 0;
+    uint8_t priority = 0;
+    for (it = (btstack_linked_item_t *) rfcomm_channels; it ; it = it->next){
+        rfcomm_channel_t * channel = (rfcomm_channel_t *) it;
+        if (channel->multiplexer != multiplexer) continue;
+        if (channel->rfcomm_cid == multiplexer->scheduler_last_cid){
+            last_channel = channel;
+        }
+        if (!rfcomm_channel_ready_for_client(channel)){
+            // idle channels neither collect deficit nor keep debt
+            channel->scheduler_deficit = 0;
+            continue;
+        }
+        if (ready && channel->scheduler_priority <= priority) continue;
+        ready = 1;
+        priority = channel->scheduler_priority;
+    }
+    if (!ready) return NULL;
+
+    // last channel continues until its deficit is used up
+    if (last_channel && rfcomm_channel_ready_for_client(last_channel) && last_channel->scheduler_priority == priority
+        && last_channel->scheduler_deficit > 0){
+        return last_channel;
+    }
+
+    // visit following channels and add quantum, terminates as at least one channel is ready
+    int32_t quantum = rfcomm_scheduler_quantum(multiplexer);
+    it = (btstack_linked_item_t *) last_channel;
+    while (1){
+        it = (it && it->next) ? it->next : (btstack_linked_item_t *) rfcomm_channels;
+        rfcomm_channel_t * channel = (rfcomm_channel_t *) it;
+        if (channel->multiplexer != multiplexer) continue;
+        if (!rfcomm_channel_ready_for_client(channel)) continue;
+        if (channel->scheduler_priority != priority) continue;
+        channel->scheduler_deficit += quantum;
+        if (channel->scheduler_deficit <= 0) continue;
+        multiplexer->scheduler_last_cid = channel->rfcomm_cid;
+        return channel;
+    }
+}
+
+static void rfcomm_scheduler_emit_can_send_now(rfcomm_channel_t * channel){
+    channel->waiting_for_can_send_now = 0;
+#ifdef ENABLE_RFCOMM_SCHEDULER_STATS
+    uint32_t wait_ms = btstack_run_loop_get_time_ms() - channel->scheduler_wait_start_ms;
+    channel->scheduler_grants++;
+    channel->scheduler_wait_total_ms += wait_ms;
+    channel->scheduler_wait_max_ms = btstack_max(channel->scheduler_wait_max_ms, wait_ms);
+#endif
+    rfcomm_emit_can_send_now(channel);
+}
+
 static void rfcomm_notify_channel_can_send(void){
+    // request can send now for all multiplexers with channels ready to send, scheduler picks channel
     btstack_linked_list_iterator_t it;
-    btstack_linked_list_iterator_init(&it, &rfcomm_channels);
+    btstack_linked_list_iterator_init(&it, &rfcomm_multiplexers);
     while (btstack_linked_list_iterator_has_next(&it)){
-        rfcomm_channel_t * channel = (rfcomm_channel_t *) btstack_linked_list_iterator_next(&it);
-        if (!channel->waiting_for_can_send_now) continue; // didn't try to send yet
-        if (!rfcomm_channel_can_send(channel)) continue;  // or cannot yet either
-
-        channel->waiting_for_can_send_now = 0;
-        rfcomm_emit_can_send_now(channel);
+        rfcomm_multiplexer_t * multiplexer = (rfcomm_multiplexer_t *) btstack_linked_list_iterator_next(&it);
+        if (!rfcomm_scheduler_next_channel(multiplexer)) continue;
+        l2cap_request_can_send_now_event(multiplexer->l2cap_cid);
     }
 }
 
@@ -879,20 +951,15 @@ static void rfcomm_handle_can_send_now(uint16_t l2cap_cid){
         }
     }
 
-    // forward token to client
-    btstack_linked_list_iterator_init(&it, &rfcomm_channels);
-    while (!token_consumed && btstack_linked_list_iterator_has_next(&it)){
-        rfcomm_channel_t * channel = (rfcomm_channel_t *) btstack_linked_list_iterator_next(&it);
-        if (channel->multiplexer->l2cap_cid != l2cap_cid) continue;
-        // client waiting for can send now
-        if (!channel->waiting_for_can_send_now)    continue;
-        if (!channel->credits_outgoing)            continue;
-        if ((channel->multiplexer->fcon & 1) == 0) continue;
-
-        log_debug("rfcomm_handle_can_send_now enter: client token");
-        token_consumed = 1;
-        channel->waiting_for_can_send_now = 0;
-        rfcomm_emit_can_send_now(channel);
+    // forward token to client selected by scheduler
+    if (!token_consumed){
+        rfcomm_multiplexer_t * multiplexer = rfcomm_multiplexer_for_l2cap_cid(l2cap_cid);
+        rfcomm_channel_t * channel = multiplexer ? rfcomm_scheduler_next_channel(multiplexer) : NULL;
+        if (channel){
+            log_debug("rfcomm_handle_can_send_now enter: client token");
+            token_consumed = 1;
+            rfcomm_scheduler_emit_can_send_now(channel);
+        }
     }
 
     // if token was consumed, request another one
@@ -1238,10 +1305,66 @@ static void rfcomm_multiplexer_state_machine(rfcomm_multiplexer_t * multiplexer,
 // MARK: RFCOMM CHANNEL
 
 static void rfcomm_channel_send_credits(rfcomm_channel_t *channel, uint8_t credits){
+#ifdef ENABLE_RFCOMM_ADAPTIVE_CREDITS
+    // round trip completes with first data frame that uses these credits
+    if (channel->credit_buffer_size && channel->credit_rtt_pending == 0){
+        channel->credit_rtt_pending  = channel->credits_incoming + 1;
+        channel->credit_rtt_start_ms = btstack_run_loop_get_time_ms();
+    }
+    channel->credit_frames++;
+    channel->credits_granted += credits;
+#endif
     channel->credits_incoming += credits;
     rfcomm_send_uih_credits(channel->multiplexer, channel->dlci, credits);
 }
 
+#ifdef ENABLE_RFCOMM_ADAPTIVE_CREDITS
+static uint8_t rfcomm_adaptive_credits_window(rfcomm_channel_t * channel){
+    uint32_t window = btstack_max(channel->credit_window, RFCOMM_ADAPTIVE_CREDITS_MIN_WINDOW);
+    if (channel->credit_drain_rate && channel->credit_srtt_ms){
+        // credits are topped up after half of them have been used, so use twice the bandwidth-delay product
+        uint32_t bytes_per_rtt = channel->credit_drain_rate * channel->credit_srtt_ms / 1000;
+        window = btstack_max(2 * ((bytes_per_rtt + channel->max_frame_size - 1) / channel->max_frame_size), RFCOMM_ADAPTIVE_CREDITS_MIN_WINDOW);
+    }
+    // window covers frames in application buffer, too
+    window = btstack_min(window, channel->credit_buffer_size / channel->max_frame_size);
+    return btstack_min(window, 0xff);
+}
+
+static void rfcomm_adaptive_credits_update(rfcomm_channel_t * channel){
+    if (!channel->credit_buffer_size) return;
+    if (channel->state != RFCOMM_CHANNEL_OPEN) return;
+    channel->credit_window = rfcomm_adaptive_credits_window(channel);
+    // frames granted to remote or not consumed yet
+    uint16_t frames_buffered = (channel->credit_buffered + channel->max_frame_size - 1) / channel->max_frame_size;
+    uint16_t frames_committed = channel->credits_incoming + channel->new_credits_incoming + frames_buffered;
+    // top up when half of the window has been used
+    if (frames_committed * 2 > channel->credit_window) return;
+    if (frames_committed >= channel->credit_window) return;
+    channel->new_credits_incoming += channel->credit_window - frames_committed;
+    log_info("rfcomm adaptive credits cid 0x%02x: window %u, rtt %u ms, drain rate %u bytes/s", channel->rfcomm_cid,
+        channel->credit_window, channel->credit_srtt_ms, (int) channel->credit_drain_rate);
+    l2cap_request_can_send_now_event(channel->multiplexer->l2cap_cid);
+}
+
+static void rfcomm_adaptive_credits_received(rfcomm_channel_t * channel, uint16_t len){
+    if (channel->credits_incoming == 0){
+        channel->credit_stalls++;
+    }
+    if (!channel->credit_buffer_size) return;
+    channel->credit_buffered = btstack_min(channel->credit_buffered + len, 0xffff);
+    if (!channel->credit_rtt_pending) return;
+    channel->credit_rtt_pending--;
+    if (channel->credit_rtt_pending) return;
+    uint32_t rtt_ms = btstack_max(btstack_run_loop_get_time_ms() - channel->credit_rtt_start_ms, 1);
+    if (channel->credit_srtt_ms){
+        channel->credit_srtt_ms = (7 * channel->credit_srtt_ms + rtt_ms) / 8;
+    } else {
+        channel->credit_srtt_ms = rtt_ms;
+    }
+}
+#endif
+
 static int rfcomm_channel_can_send(rfcomm_channel_t * channel){
     if (!channel->credits_outgoing) return 0;
     if ((channel->multiplexer->fcon & 1) == 0) return 0;
@@ -1305,6 +1428,10 @@ static void rfcomm_channel_packet_handler_uih(rfcomm_multiplexer_t *multiplexer,
         if (channel->credits_incoming > 0){
             channel->credits_incoming--;
         }
+
+#ifdef ENABLE_RFCOMM_ADAPTIVE_CREDITS
+        rfcomm_adaptive_credits_received(channel, size-payload_offset-1);
+#endif
         
         // deliver payload
         (channel->packet_handler)(RFCOMM_DATA_PACKET, channel->rfcomm_cid,
@@ -1316,6 +1443,10 @@ static void rfcomm_channel_packet_handler_uih(rfcomm_multiplexer_t *multiplexer,
         channel->new_credits_incoming = RFCOMM_CREDITS;
         l2cap_request_can_send_now_event(multiplexer->l2cap_cid);
     }    
+
+#ifdef ENABLE_RFCOMM_ADAPTIVE_CREDITS
+    rfcomm_adaptive_credits_update(channel);
+#endif
 }
 
 static void rfcomm_channel_accept_pn(rfcomm_channel_t *channel, rfcomm_channel_event_pn_t *event){
@@ -2044,10 +2175,43 @@ void rfcomm_request_can_send_now_event(uint16_t rfcomm_cid){
         log_error("rfcomm_send cid 0x%02x doesn't exist!", rfcomm_cid);
         return;
     }
+#ifdef ENABLE_RFCOMM_SCHEDULER_STATS
+    if (!channel->waiting_for_can_send_now){
+        channel->scheduler_wait_start_ms = btstack_run_loop_get_time_ms();
+    }
+#endif
     channel->waiting_for_can_send_now = 1;
     l2cap_request_can_send_now_event(channel->multiplexer->l2cap_cid);
 }
 
+uint8_t rfcomm_set_channel_priority(uint16_t rfcomm_cid, uint8_t priority){
+    rfcomm_channel_t * channel = rfcomm_channel_for_rfcomm_cid(rfcomm_cid);
+    if (!channel){
+        log_error("rfcomm_set_channel_priority cid 0x%02x doesn't exist!", rfcomm_cid);
+        return ERROR_CODE_UNKNOWN_CONNECTION_IDENTIFIER;
+    }
+    channel->scheduler_priority = priority;
+    return ERROR_CODE_SUCCESS;
+}
+
+#ifdef ENABLE_RFCOMM_SCHEDULER_STATS
+uint8_t rfcomm_get_scheduler_stats(uint16_t rfcomm_cid, rfcomm_scheduler_stats_t * stats){
+    rfcomm_channel_t * channel = rfcomm_channel_for_rfcomm_cid(rfcomm_cid);
+    if (!channel){
+        log_error("rfcomm_get_scheduler_stats cid 0x%02x doesn't exist!", rfcomm_cid);
+        return ERROR_CODE_UNKNOWN_CONNECTION_IDENTIFIER;
+    }
+    stats->grants        = channel->scheduler_grants;
+    stats->frames        = channel->scheduler_frames;
+    stats->bytes         = channel->scheduler_bytes;
+    stats->wait_total_ms = channel->scheduler_wait_total_ms;
+    stats->wait_max_ms   = channel->scheduler_wait_max_ms;
+    stats->deficit       = channel->scheduler_deficit;
+    stats->priority      = channel->scheduler_priority;
+    return ERROR_CODE_SUCCESS;
+}
+#endif
+
 static int rfcomm_assert_send_valid(rfcomm_channel_t * channel , uint16_t len){
     if (len > channel->max_frame_size){
         log_error("rfcomm_send cid 0x%02x, rfcomm data lenght exceeds MTU!", channel->rfcomm_cid);
@@ -2090,25 +2254,13 @@ uint16_t rfcomm_get_max_frame_size(uint16_t rfcomm_cid){
     return channel->max_frame_size;
 }
 
-int rfcomm_send_prepared(uint16_t rfcomm_cid, uint16_t len){
-    rfcomm_channel_t * channel = rfcomm_channel_for_rfcomm_cid(rfcomm_cid);
-    if (!channel){
-        log_error("rfcomm_send_prepared cid 0x%02x doesn't exist!", rfcomm_cid);
-        return 0;
-    }
-
-    int err = rfcomm_assert_send_valid(channel, len);
-    if (err) return err;
-    if (!l2cap_can_send_prepared_packet_now(channel->multiplexer->l2cap_cid)){
-        log_error("rfcomm_send_prepared: l2cap cannot send now");
-        return BTSTACK_ACL_BUFFERS_FULL;
-    }
-
+// pre: packet buffer reserved and payload in place, channel validated
+static int rfcomm_channel_send_prepared(rfcomm_channel_t * channel, uint16_t len){
     // send might cause l2cap to emit new credits, update counters first
     if (len){
         channel->credits_outgoing--;
     } else {
-        log_info("sending empty RFCOMM packet for cid %02x", rfcomm_cid);
+        log_info("sending empty RFCOMM packet for cid %02x", channel->rfcomm_cid);
     }
         
     int result = rfcomm_send_uih_prepared(channel->multiplexer, channel->dlci, len);
@@ -2120,17 +2272,61 @@ int rfcomm_send_prepared(uint16_t rfcomm_cid, uint16_t len){
         log_error("rfcomm_send_prepared: error %d", result);
         return result;
     }
-    
+
+    // charge scheduler, debt is limited to one quantum as frames may be sent without can send now
+    channel->scheduler_deficit -= len;
+    int32_t quantum = rfcomm_scheduler_quantum(channel->multiplexer);
+    if (channel->scheduler_deficit < -quantum){
+        channel->scheduler_deficit = -quantum;
+    }
+#ifdef ENABLE_RFCOMM_SCHEDULER_STATS
+    channel->scheduler_frames++;
+    channel->scheduler_bytes += len;
+#endif
     return result;
 }
 
+int rfcomm_send_prepared(uint16_t rfcomm_cid, uint16_t len){
+    rfcomm_channel_t * channel = rfcomm_channel_for_rfcomm_cid(rfcomm_cid);
+    if (!channel){
+        log_error("rfcomm_send_prepared cid 0x%02x doesn't exist!", rfcomm_cid);
+        return ERROR_CODE_UNKNOWN_CONNECTION_IDENTIFIER;
+    }
+
+    int err = rfcomm_assert_send_valid(channel, len);
+    if (err) return err;
+    if (!l2cap_can_send_prepared_packet_now(channel->multiplexer->l2cap_cid)){
+        log_error("rfcomm_send_prepared: l2cap cannot send now");
+        return BTSTACK_ACL_BUFFERS_FULL;
+    }
+
+    return rfcomm_channel_send_prepared(channel, len);
+}
+
 int rfcomm_send(uint16_t rfcomm_cid, uint8_t *data, uint16_t len){
+    rfcomm_fragment_t fragment;
+    fragment.data = data;
+    fragment.len  = len;
+    return rfcomm_send_scatter(rfcomm_cid, &fragment, 1);
+}
+
+int rfcomm_send_scatter(uint16_t rfcomm_cid, const rfcomm_fragment_t * fragments, int num_fragments){
     rfcomm_channel_t * channel = rfcomm_channel_for_rfcomm_cid(rfcomm_cid);
     if (!channel){
         log_error("cid 0x%02x doesn't exist!", rfcomm_cid);
         return ERROR_CODE_UNKNOWN_CONNECTION_IDENTIFIER;
     }
 
+    uint32_t len = 0;
+    int i;
+    for (i = 0; i < num_fragments; i++){
+        len += fragments[i].len;
+    }
+    if (len > channel->max_frame_size){
+        log_error("rfcomm_send cid 0x%02x, rfcomm data lenght exceeds MTU!", rfcomm_cid);
+        return RFCOMM_DATA_LEN_EXCEEDS_MTU;
+    }
+
     int err = rfcomm_assert_send_valid(channel, len);
     if (err) return err;
     if (!l2cap_can_send_packet_now(channel->multiplexer->l2cap_cid)){
@@ -2138,10 +2334,14 @@ int rfcomm_send(uint16_t rfcomm_cid, uint8_t *data, uint16_t len){
         return BTSTACK_ACL_BUFFERS_FULL;
     }
 
+    // single copy of all fragments directly behind the reserved RFCOMM header
     rfcomm_reserve_packet_buffer();
     uint8_t * rfcomm_payload = rfcomm_get_outgoing_buffer();
-    memcpy(rfcomm_payload, data, len);
-    err = rfcomm_send_prepared(rfcomm_cid, len);    
+    for (i = 0; i < num_fragments; i++){
+        memcpy(rfcomm_payload, fragments[i].data, fragments[i].len);
+        rfcomm_payload += fragments[i].len;
+    }
+    err = rfcomm_channel_send_prepared(channel, len);
     if (err){
         rfcomm_release_packet_buffer();
     }
@@ -2386,10 +2586,79 @@ void rfcomm_grant_credits(uint16_t rfcomm_cid, uint8_t credits){
     rfcomm_channel_t * channel = rfcomm_channel_for_rfcomm_cid(rfcomm_cid);
     if (!channel) return;
     if (!channel->incoming_flow_control) return;
+#ifdef ENABLE_RFCOMM_ADAPTIVE_CREDITS
+    if (channel->credit_buffer_size) return;
+#endif
     channel->new_credits_incoming += credits;
 
     // process
     l2cap_request_can_send_now_event(channel->multiplexer->l2cap_cid);
 }
 
+#ifdef ENABLE_RFCOMM_ADAPTIVE_CREDITS
+uint8_t rfcomm_enable_adaptive_credits(uint16_t rfcomm_cid, uint16_t buffer_size){
+    rfcomm_channel_t * channel = rfcomm_channel_for_rfcomm_cid(rfcomm_cid);
+    if (!channel){
+        log_error("rfcomm_enable_adaptive_credits cid 0x%02x doesn't exist!", rfcomm_cid);
+        return ERROR_CODE_UNKNOWN_CONNECTION_IDENTIFIER;
+    }
+    if (buffer_size < channel->max_frame_size){
+        log_error("rfcomm_enable_adaptive_credits cid 0x%02x, buffer smaller than max frame size %u", rfcomm_cid, channel->max_frame_size);
+        return RFCOMM_DATA_LEN_EXCEEDS_MTU;
+    }
+    channel->incoming_flow_control = 1;
+    channel->credit_buffer_size    = buffer_size;
+    channel->credit_drain_start_ms = btstack_run_loop_get_time_ms();
+    channel->credit_drain_bytes    = 0;
+    // initial credits not sent yet, have to fit into buffer, too
+    uint8_t max_credits = btstack_min(buffer_size / channel->max_frame_size, 0xff);
+    if (channel->new_credits_incoming > max_credits){
+        channel->new_credits_incoming = max_credits;
+    }
+    channel->credit_window = btstack_max(channel->credits_incoming + channel->new_credits_incoming, RFCOMM_ADAPTIVE_CREDITS_MIN_WINDOW);
+    rfcomm_adaptive_credits_update(channel);
+    return 0;
+}
+
+void rfcomm_notify_data_consumed(uint16_t rfcomm_cid, uint16_t size){
+    rfcomm_channel_t * channel = rfcomm_channel_for_rfcomm_cid(rfcomm_cid);
+    if (!channel) return;
+    if (!channel->credit_buffer_size) return;
+    channel->credit_buffered -= btstack_min(size, channel->credit_buffered);
+
+    // drain rate, smoothed over samples of RFCOMM_ADAPTIVE_CREDITS_SAMPLE_MS
+    uint32_t now = btstack_run_loop_get_time_ms();
+    uint32_t elapsed_ms = now - channel->credit_drain_start_ms;
+    channel->credit_drain_bytes += size;
+    if (elapsed_ms >= RFCOMM_ADAPTIVE_CREDITS_SAMPLE_MS){
+        uint32_t rate = channel->credit_drain_bytes * 1000 / elapsed_ms;
+        if (channel->credit_drain_rate){
+            channel->credit_drain_rate = (3 * channel->credit_drain_rate + rate) / 4;
+        } else {
+            channel->credit_drain_rate = rate;
+        }
+        channel->credit_drain_bytes    = 0;
+        channel->credit_drain_start_ms = now;
+    }
+    rfcomm_adaptive_credits_update(channel);
+}
+
+uint8_t rfcomm_get_credit_stats(uint16_t rfcomm_cid, rfcomm_credit_stats_t * stats){
+    rfcomm_channel_t * channel = rfcomm_channel_for_rfcomm_cid(rfcomm_cid);
+    if (!channel){
+        log_error("rfcomm_get_credit_stats cid 0x%02x doesn't exist!", rfcomm_cid);
+        return ERROR_CODE_UNKNOWN_CONNECTION_IDENTIFIER;
+    }
+    stats->credit_stalls     = channel->credit_stalls;
+    stats->credit_frames     = channel->credit_frames;
+    stats->credits_granted   = channel->credits_granted;
+    stats->credits_in_flight = channel->credits_incoming;
+    stats->credit_window     = channel->credit_window;
+    stats->rtt_ms            = channel->credit_srtt_ms;
+    stats->drain_rate        = channel->credit_drain_rate;
+    stats->buffered          = channel->credit_buffered;
+    return 0;
+}
+#endif
+
 
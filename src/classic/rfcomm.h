@@ -42,6 +42,7 @@
 #ifndef __RFCOMM_H
 #define __RFCOMM_H
  
+#include "btstack_config.h"
 #include "btstack_util.h"
 
 #include <stdint.h>
@@ -124,6 +125,47 @@ typedef struct rfcomm_rpn_data {
     uint8_t parameter_mask_1;   // second byte
 } rfcomm_rpn_data_t;
 
+#ifdef ENABLE_RFCOMM_ADAPTIVE_CREDITS
+// credit statistics since channel was created, see rfcomm_get_credit_stats
+typedef struct {
+    // remote used up all credits
+    uint32_t credit_stalls;
+    // UIH frames with credits sent
+    uint32_t credit_frames;
+    uint32_t credits_granted;
+    // credits granted to remote but not used yet
+    uint8_t  credits_in_flight;
+    // adaptive credits: target credits, smoothed round trip time, drain rate in bytes/s, bytes not consumed
+    uint8_t  credit_window;
+    uint16_t rtt_ms;
+    uint32_t drain_rate;
+    uint16_t buffered;
+} rfcomm_credit_stats_t;
+#endif
+
+#ifdef ENABLE_RFCOMM_SCHEDULER_STATS
+// scheduler statistics since channel was created, see rfcomm_get_scheduler_stats
+typedef struct {
+    // RFCOMM_EVENT_CAN_SEND_NOW emitted after rfcomm_request_can_send_now_event
+    uint32_t grants;
+    // UIH frames and bytes sent
+    uint32_t frames;
+    uint32_t bytes;
+    // time from rfcomm_request_can_send_now_event until RFCOMM_EVENT_CAN_SEND_NOW
+    uint32_t wait_total_ms;
+    uint32_t wait_max_ms;
+    // bytes the channel may send in current round
+    int32_t  deficit;
+    uint8_t  priority;
+} rfcomm_scheduler_stats_t;
+#endif
+
+// fragment of an RFCOMM packet, see rfcomm_send_scatter
+typedef struct {
+    const uint8_t * data;
+    uint16_t        len;
+} rfcomm_fragment_t;
+
 // info regarding potential connections
 typedef struct {
     // linked list - assert: first field
@@ -182,6 +224,9 @@ typedef struct {
     uint8_t test_data_len;
     uint8_t test_data[RFCOMM_TEST_DATA_MAX_LEN];
 
+    // scheduler: channel that got the last can send now event
+    uint16_t scheduler_last_cid;
+
 } rfcomm_multiplexer_t;
 
 // info regarding an actual connection
@@ -240,6 +285,39 @@ typedef struct {
 
     //
     uint8_t   waiting_for_can_send_now;
+
+    // scheduler: higher priority first, deficit round robin for channels with same priority
+    uint8_t  scheduler_priority;
+    int32_t  scheduler_deficit;
+#ifdef ENABLE_RFCOMM_SCHEDULER_STATS
+    uint32_t scheduler_wait_start_ms;
+    uint32_t scheduler_grants;
+    uint32_t scheduler_frames;
+    uint32_t scheduler_bytes;
+    uint32_t scheduler_wait_total_ms;
+    uint32_t scheduler_wait_max_ms;
+#endif
+
+#ifdef ENABLE_RFCOMM_ADAPTIVE_CREDITS
+    // adaptive credits: size of application buffer, 0 = disabled
+    uint16_t credit_buffer_size;
+    // bytes delivered but not consumed by application
+    uint16_t credit_buffered;
+    // target number of credits for remote
+    uint8_t  credit_window;
+    // round trip time: from sending credits until first data frame that uses them
+    uint16_t credit_rtt_pending;
+    uint32_t credit_rtt_start_ms;
+    uint16_t credit_srtt_ms;
+    // drain rate of application in bytes/s
+    uint32_t credit_drain_start_ms;
+    uint32_t credit_drain_bytes;
+    uint32_t credit_drain_rate;
+    // stats
+    uint32_t credit_stalls;
+    uint32_t credit_frames;
+    uint32_t credits_granted;
+#endif
         
 } rfcomm_channel_t;
 
@@ -320,6 +398,33 @@ void rfcomm_decline_connection(uint16_t rfcomm_cid);
  */
 void rfcomm_grant_credits(uint16_t rfcomm_cid, uint8_t credits);
 
+#ifdef ENABLE_RFCOMM_ADAPTIVE_CREDITS
+/** 
+ * @brief Let BTstack manage incoming credits based on the measured drain rate of the application and the round trip time.
+ * The credits granted to the remote never allow more data than fits into the free part of the application buffer.
+ * Can be called before accepting an incoming connection or after creating an outgoing one. Disables rfcomm_grant_credits.
+ * @param rfcomm_cid
+ * @param buffer_size of application receive buffer in bytes, at least max frame size
+ * @result status
+ */
+uint8_t rfcomm_enable_adaptive_credits(uint16_t rfcomm_cid, uint16_t buffer_size);
+
+/** 
+ * @brief Report that the application has processed received data and freed its buffer space, used with adaptive credits
+ * @param rfcomm_cid
+ * @param size in bytes
+ */
+void rfcomm_notify_data_consumed(uint16_t rfcomm_cid, uint16_t size);
+
+/** 
+ * @brief Get credit statistics for RFCOMM channel
+ * @param rfcomm_cid
+ * @param stats
+ * @result status
+ */
+uint8_t rfcomm_get_credit_stats(uint16_t rfcomm_cid, rfcomm_credit_stats_t * stats);
+#endif
+
 /** 
  * @brief Checks if RFCOMM can send packet. 
  * @param rfcomm_cid
@@ -335,6 +440,26 @@ int rfcomm_can_send_packet_now(uint16_t rfcomm_cid);
  */
 void rfcomm_request_can_send_now_event(uint16_t rfcomm_cid);
 
+/** 
+ * @brief Set scheduling priority for RFCOMM channel, default 0. If several channels on the same multiplexer
+ * are waiting for RFCOMM_EVENT_CAN_SEND_NOW, channels with higher priority are served first. Channels with
+ * the same priority share the link by deficit round robin, i.e. each one can send about the same number of bytes.
+ * @param rfcomm_cid
+ * @param priority
+ * @result status
+ */
+uint8_t rfcomm_set_channel_priority(uint16_t rfcomm_cid, uint8_t priority);
+
+#ifdef ENABLE_RFCOMM_SCHEDULER_STATS
+/** 
+ * @brief Get scheduler statistics for RFCOMM channel
+ * @param rfcomm_cid
+ * @param stats
+ * @result status
+ */
+uint8_t rfcomm_get_scheduler_stats(uint16_t rfcomm_cid, rfcomm_scheduler_stats_t * stats);
+#endif
+
 /** 
  * @brief Sends RFCOMM data packet to the RFCOMM channel with given identifier.
  * @param rfcomm_cid
@@ -393,6 +518,16 @@ uint8_t * rfcomm_get_outgoing_buffer(void);
 int       rfcomm_send_prepared(uint16_t rfcomm_cid, uint16_t len);
 void      rfcomm_release_packet_buffer(void);
 
+/** 
+ * @brief Send RFCOMM packet assembled from several fragments. The fragments are copied
+ * once into the outgoing buffer behind the RFCOMM header, their total length must not
+ * exceed rfcomm_get_max_frame_size(cid).
+ * @param rfcomm_cid
+ * @param fragments
+ * @param num_fragments
+ */
+int rfcomm_send_scatter(uint16_t rfcomm_cid, const rfcomm_fragment_t * fragments, int num_fragments);
+
 /* API_END */
 
 #if defined __cplusplus
@@ -42,6 +42,7 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "bluetooth_sdp.h"
@@ -116,6 +117,517 @@ uint32_t sdp_create_service_record_handle(void){
     return handle;
 }
 
+#ifdef ENABLE_SDP_RECORD_INDEX
+
+// SDP Record Index: UUID -> records, attribute ID -> offset of attribute value in record
+// records are numbered in the order of sdp_service_records, which is also used for the continuation state
+
+// max number of UUIDs in ServiceSearchPattern handled by index
+#define SDP_RECORD_INDEX_MAX_PATTERN_UUIDS 12
+
+typedef struct {
+    // UUIDs based on the Bluetooth Base UUID are stored as uuid32, others point to the 128-bit UUID in the record
+    const uint8_t * uuid128;
+    uint32_t        uuid32;
+    uint16_t        record_index;
+} sdp_record_index_uuid_t;
+
+typedef struct {
+    uint16_t attribute_id;
+    uint16_t offset;
+} sdp_record_index_attribute_t;
+
+// SDP Record Index Storage
+#ifndef HAVE_MALLOC
+#ifdef MAX_SDP_RECORD_INDEX_ENTRIES
+static service_record_item_t *      sdp_record_index_records_storage[MAX_SDP_RECORD_INDEX_ENTRIES];
+static sdp_record_index_uuid_t      sdp_record_index_uuids_storage[MAX_SDP_RECORD_INDEX_ENTRIES];
+static sdp_record_index_attribute_t sdp_record_index_attributes_storage[MAX_SDP_RECORD_INDEX_ENTRIES];
+#else
+#error ENABLE_SDP_RECORD_INDEX requires either HAVE_MALLOC or MAX_SDP_RECORD_INDEX_ENTRIES
+#endif
+#endif
+
+static int                            sdp_record_index_valid;
+static uint16_t                       sdp_record_index_num_records;
+static uint16_t                       sdp_record_index_num_uuids;
+static uint16_t                       sdp_record_index_num_attributes;
+static service_record_item_t       ** sdp_record_index_records;     // in order of sdp_service_records
+static sdp_record_index_uuid_t      * sdp_record_index_uuids;       // sorted by uuid, then record index
+static sdp_record_index_attribute_t * sdp_record_index_attributes;  // grouped by record, sorted by attribute ID
+
+// pre: element is a valid UUID
+static void sdp_record_index_uuid_for_element(sdp_record_index_uuid_t * entry, const uint8_t * element){
+    if (de_get_size_type(element) == DE_SIZE_128){
+        if (uuid_has_bluetooth_prefix(&element[1])){
+            entry->uuid128 = NULL;
+            entry->uuid32  = big_endian_read_32(element, 1);
+        } else {
+            entry->uuid128 = &element[1];
+            entry->uuid32  = 0;
+        }
+        return;
+    }
+    entry->uuid128 = NULL;
+    entry->uuid32  = de_get_uuid32(element);
+}
+
+static int sdp_record_index_element_is_uuid(const uint8_t * element){
+    uint8_t uuid128[16];
+    return de_get_normalized_uuid(uuid128, element);
+}
+
+static int sdp_record_index_uuid_compare(const sdp_record_index_uuid_t * a, const sdp_record_index_uuid_t * b){
+    // UUIDs based on the Bluetooth Base UUID first
+    if (!a->uuid128 && b->uuid128) return -1;
+    if (a->uuid128 && !b->uuid128) return 1;
+    if (a->uuid128){
+        int res = memcmp(a->uuid128, b->uuid128, 16);
+        if (res) return res;
+    } else if (a->uuid32 != b->uuid32){
+        return a->uuid32 < b->uuid32 ? -1 : 1;
+    }
+    return (int) a->record_index - (int) b->record_index;
+}
+
+// visit UUIDs in record and nested DES like sdp_record_contains_UUID128, store them if entries given
+static uint32_t sdp_record_index_add_uuids(uint8_t * element, uint16_t record_index, sdp_record_index_uuid_t * entries){
+    uint32_t num_uuids = 0;
+    des_iterator_t it;
+    for (des_iterator_init(&it, element); des_iterator_has_more(&it); des_iterator_next(&it)){
+        uint8_t * child = des_iterator_get_element(&it);
+        switch (des_iterator_get_type(&it)){
+            case DE_UUID:
+                if (!sdp_record_index_element_is_uuid(child)) break;
+                if (entries){
+                    sdp_record_index_uuid_for_element(&entries[num_uuids], child);
+                    entries[num_uuids].record_index = record_index;
+                }
+                num_uuids++;
+                break;
+            case DE_DES:
+                num_uuids += sdp_record_index_add_uuids(child, record_index, entries ? &entries[num_uuids] : NULL);
+                break;
+            default:
+                break;
+        }
+    }
+    return num_uuids;
+}
+
+typedef enum {
+    SDP_RECORD_INDEX_ATTRIBUTES_OK = 0,
+    SDP_RECORD_INDEX_ATTRIBUTES_UNSORTED,          // attribute IDs not in ascending order, only detected if entries given
+    SDP_RECORD_INDEX_ATTRIBUTES_OFFSET_TOO_LARGE,  // attribute value beyond 16-bit offset
+} sdp_record_index_attributes_status_t;
+
+// visit attributes like sdp_attribute_list_traverse_sequence, store them if entries given
+static sdp_record_index_attributes_status_t sdp_record_index_add_attributes(uint8_t * record, sdp_record_index_attribute_t * entries, uint16_t * num_attributes){
+    *num_attributes = 0;
+    if (de_get_element_type(record) != DE_DES) return SDP_RECORD_INDEX_ATTRIBUTES_OK;
+    int pos = de_get_header_size(record);
+    int end_pos = de_get_len(record);
+    while (pos < end_pos){
+        if (de_get_element_type(record + pos) != DE_UINT || de_get_size_type(record + pos) != DE_SIZE_16) break;
+        uint16_t attribute_id = big_endian_read_16(record, pos + 1);
+        pos += 3;
+        if (pos >= end_pos) break;
+        if (pos >= 0xffff) return SDP_RECORD_INDEX_ATTRIBUTES_OFFSET_TOO_LARGE;
+        if (entries){
+            if (*num_attributes && entries[*num_attributes - 1].attribute_id >= attribute_id) return SDP_RECORD_INDEX_ATTRIBUTES_UNSORTED;
+            entries[*num_attributes].attribute_id = attribute_id;
+            entries[*num_attributes].offset       = pos;
+        }
+        (*num_attributes)++;
+        pos += de_get_len(record + pos);
+    }
+    return SDP_RECORD_INDEX_ATTRIBUTES_OK;
+}
+
+static int sdp_record_index_allocate(void){
+#ifdef HAVE_MALLOC
+    free(sdp_record_index_records);
+    free(sdp_record_index_uuids);
+    free(sdp_record_index_attributes);
+    sdp_record_index_records    = (service_record_item_t **) malloc(sdp_record_index_num_records * sizeof(service_record_item_t *));
+    sdp_record_index_uuids      = (sdp_record_index_uuid_t *) malloc(sdp_record_index_num_uuids * sizeof(sdp_record_index_uuid_t));
+    sdp_record_index_attributes = (sdp_record_index_attribute_t *) malloc(sdp_record_index_num_attributes * sizeof(sdp_record_index_attribute_t));
+    return sdp_record_index_records && (sdp_record_index_uuids || sdp_record_index_num_uuids == 0)
+        && (sdp_record_index_attributes || sdp_record_index_num_attributes == 0);
+#else
+    if (sdp_record_index_num_records    > MAX_SDP_RECORD_INDEX_ENTRIES) return 0;
+    if (sdp_record_index_num_uuids      > MAX_SDP_RECORD_INDEX_ENTRIES) return 0;
+    if (sdp_record_index_num_attributes > MAX_SDP_RECORD_INDEX_ENTRIES) return 0;
+    sdp_record_index_records    = sdp_record_index_records_storage;
+    sdp_record_index_uuids      = sdp_record_index_uuids_storage;
+    sdp_record_index_attributes = sdp_record_index_attributes_storage;
+    return 1;
+#endif
+}
+
+static void sdp_record_index_build(void){
+    sdp_record_index_valid = 0;
+    sdp_record_index_num_records = 0;
+    sdp_record_index_num_uuids = 0;
+    sdp_record_index_num_attributes = 0;
+
+    // count records, UUIDs and attributes
+    btstack_linked_item_t *it;
+    for (it = (btstack_linked_item_t *) sdp_service_records; it ; it = it->next){
+        service_record_item_t * item = (service_record_item_t *) it;
+        uint16_t num_attributes;
+        if (sdp_record_index_add_attributes(item->service_record, NULL, &num_attributes) == SDP_RECORD_INDEX_ATTRIBUTES_OFFSET_TOO_LARGE){
+            log_error("sdp_record_index: record 0x%08x too large, index disabled", item->service_record_handle);
+            return;
+        }
+        uint32_t num_uuids = sdp_record_index_add_uuids(item->service_record, 0, NULL);
+        if ((sdp_record_index_num_records == 0xffff)
+            || ((uint32_t) sdp_record_index_num_attributes + num_attributes > 0xffff)
+            || ((uint32_t) sdp_record_index_num_uuids + num_uuids > 0xffff)){
+            log_error("sdp_record_index: too many records, attributes or UUIDs, index disabled");
+            return;
+        }
+        sdp_record_index_num_attributes += num_attributes;
+        sdp_record_index_num_uuids      += (uint16_t) num_uuids;
+        sdp_record_index_num_records++;
+    }
+    if (sdp_record_index_num_records == 0) return;
+
+    if (!sdp_record_index_allocate()){
+        log_error("sdp_record_index: not enough memory for %u records, index disabled", sdp_record_index_num_records);
+        return;
+    }
+
+    // fill tables
+    uint16_t record_index = 0;
+    uint16_t num_uuids = 0;
+    uint16_t num_attributes = 0;
+    for (it = (btstack_linked_item_t *) sdp_service_records; it ; it = it->next, record_index++){
+        service_record_item_t * item = (service_record_item_t *) it;
+        sdp_record_index_records[record_index] = item;
+        item->index_first_attribute = num_attributes;
+        switch (sdp_record_index_add_attributes(item->service_record, &sdp_record_index_attributes[num_attributes], &item->index_num_attributes)){
+            case SDP_RECORD_INDEX_ATTRIBUTES_OK:
+                break;
+            case SDP_RECORD_INDEX_ATTRIBUTES_UNSORTED:
+                log_error("sdp_record_index: record 0x%08x has unsorted attribute IDs, index disabled", item->service_record_handle);
+                return;
+            default:
+                log_error("sdp_record_index: record 0x%08x too large, index disabled", item->service_record_handle);
+                return;
+        }
+        num_attributes += item->index_num_attributes;
+        num_uuids += (uint16_t) sdp_record_index_add_uuids(item->service_record, record_index, &sdp_record_index_uuids[num_uuids]);
+    }
+
+    // sort uuid index, entries are added in record order, so insertion sort keeps record order for same uuid
+    int i;
+    for (i = 1; i < sdp_record_index_num_uuids; i++){
+        sdp_record_index_uuid_t entry = sdp_record_index_uuids[i];
+        int j = i;
+        while (j > 0 && sdp_record_index_uuid_compare(&entry, &sdp_record_index_uuids[j-1]) < 0){
+            sdp_record_index_uuids[j] = sdp_record_index_uuids[j-1];
+            j--;
+        }
+        sdp_record_index_uuids[j] = entry;
+    }
+
+    sdp_record_index_valid = 1;
+    log_info("sdp_record_index: %u records, %u uuids, %u attributes", sdp_record_index_num_records, sdp_record_index_num_uuids, sdp_record_index_num_attributes);
+}
+
+// returns position of first entry that is not less than key
+static uint16_t sdp_record_index_lower_bound_uuid(const sdp_record_index_uuid_t * key){
+    uint16_t low  = 0;
+    uint16_t high = sdp_record_index_num_uuids;
+    while (low < high){
+        uint16_t mid = (low + high) / 2;
+        if (sdp_record_index_uuid_compare(&sdp_record_index_uuids[mid], key) < 0){
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+// returns index of first record >= start_index that contains all UUIDs, or sdp_record_index_num_records
+static uint16_t sdp_record_index_next_match(sdp_record_index_uuid_t * uuids, uint16_t num_uuids, uint16_t start_index){
+    uint16_t candidate = start_index;
+    uint16_t i = 0;
+    // intersect sorted record lists of all UUIDs by skipping to the highest record index found
+    while (candidate < sdp_record_index_num_records && i < num_uuids){
+        uuids[i].record_index = candidate;
+        uint16_t pos = sdp_record_index_lower_bound_uuid(&uuids[i]);
+        if (pos == sdp_record_index_num_uuids) return sdp_record_index_num_records;
+        const sdp_record_index_uuid_t * entry = &sdp_record_index_uuids[pos];
+        uuids[i].record_index = entry->record_index;
+        if (sdp_record_index_uuid_compare(&uuids[i], entry) != 0) return sdp_record_index_num_records;
+        if (entry->record_index > candidate){
+            candidate = entry->record_index;
+            i = 0;
+            continue;
+        }
+        i++;
+    }
+    return btstack_min(candidate, sdp_record_index_num_records);
+}
+
+// returns position of first attribute of record with attribute ID >= attribute_id
+static uint16_t sdp_record_index_lower_bound_attribute(service_record_item_t * item, uint16_t attribute_id){
+    uint16_t low  = item->index_first_attribute;
+    uint16_t high = item->index_first_attribute + item->index_num_attributes;
+    while (low < high){
+        uint16_t mid = (low + high) / 2;
+        if (sdp_record_index_attributes[mid].attribute_id < attribute_id){
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+// index can be used if attribute ID list contains only attribute IDs and ranges in ascending order without overlap
+static int sdp_record_index_attribute_list_supported(uint8_t * attributeIDList){
+    des_iterator_t it;
+    if (!des_iterator_init(&it, attributeIDList)) return 0;
+    uint32_t next_id = 0;
+    for ( ; des_iterator_has_more(&it); des_iterator_next(&it)){
+        uint8_t * element = des_iterator_get_element(&it);
+        if (des_iterator_get_type(&it) != DE_UINT) return 0;
+        uint16_t start_id;
+        uint16_t end_id;
+        switch (de_get_size_type(element)){
+            case DE_SIZE_16:
+                start_id = big_endian_read_16(element, 1);
+                end_id   = start_id;
+                break;
+            case DE_SIZE_32:
+                start_id = big_endian_read_16(element, 1);
+                end_id   = big_endian_read_16(element, 3);
+                break;
+            default:
+                return 0;
+        }
+        if (start_id < next_id || end_id < start_id) return 0;
+        next_id = end_id + 1;
+    }
+    return 1;
+}
+
+typedef int (*sdp_record_index_attribute_handler_t)(uint16_t attribute_id, uint8_t * attribute_value, void * context);
+
+// visit attributes of record that are listed in attribute ID list, pre: sdp_record_index_attribute_list_supported
+static void sdp_record_index_visit_attributes(service_record_item_t * item, uint8_t * attributeIDList, sdp_record_index_attribute_handler_t handler, void * context){
+    uint16_t end_pos = item->index_first_attribute + item->index_num_attributes;
+    des_iterator_t it;
+    for (des_iterator_init(&it, attributeIDList); des_iterator_has_more(&it); des_iterator_next(&it)){
+        uint8_t * element = des_iterator_get_element(&it);
+        uint16_t start_id = big_endian_read_16(element, 1);
+        uint16_t end_id   = de_get_size_type(element) == DE_SIZE_32 ? big_endian_read_16(element, 3) : start_id;
+        uint16_t pos;
+        for (pos = sdp_record_index_lower_bound_attribute(item, start_id); pos < end_pos; pos++){
+            const sdp_record_index_attribute_t * attribute = &sdp_record_index_attributes[pos];
+            if (attribute->attribute_id > end_id) break;
+            if ((*handler)(attribute->attribute_id, &item->service_record[attribute->offset], context)) return;
+        }
+    }
+}
+
+static int sdp_record_index_handler_get_filtered_size(uint16_t attribute_id, uint8_t * attribute_value, void * context){
+    UNUSED(attribute_id);
+    *(uint16_t *) context += 3 + de_get_len(attribute_value);
+    return 0;
+}
+
+struct sdp_record_index_context_filter_attributes {
+    uint8_t * buffer;
+    uint16_t  start_offset;
+    uint16_t  max_bytes;
+    uint16_t  used_bytes;
+    int       complete;
+};
+
+// copy data from start offset up to max bytes, returns 0 if not all data fits
+static int sdp_record_index_append_range(struct sdp_record_index_context_filter_attributes * context, uint16_t len, const uint8_t * data){
+    if (context->start_offset >= len){
+        context->start_offset -= len;
+        return 1;
+    }
+    int ok = 1;
+    uint16_t remainder_len = len - context->start_offset;
+    if (context->max_bytes < remainder_len){
+        remainder_len = context->max_bytes;
+        ok = 0;
+    }
+    memcpy(context->buffer, &data[context->start_offset], remainder_len);
+    context->used_bytes  += remainder_len;
+    context->buffer      += remainder_len;
+    context->max_bytes   -= remainder_len;
+    context->start_offset = 0;
+    return ok;
+}
+
+static int sdp_record_index_handler_filter_attributes(uint16_t attribute_id, uint8_t * attribute_value, void * my_context){
+    struct sdp_record_index_context_filter_attributes * context = (struct sdp_record_index_context_filter_attributes *) my_context;
+    // { Attribute ID (Descriptor, big endian 16-bit ID), AttributeValue (data)}
+    uint8_t id_buffer[3];
+    id_buffer[0] = (DE_UINT << 3) | DE_SIZE_16;
+    big_endian_store_16(id_buffer, 1, attribute_id);
+    if (!sdp_record_index_append_range(context, 3, id_buffer) || !sdp_record_index_append_range(context, de_get_len(attribute_value), attribute_value)){
+        context->complete = 0;
+        return 1;
+    }
+    return 0;
+}
+#endif
+
+// iterator over registered records that match a ServiceSearchPattern, uses index if possible
+typedef struct {
+    uint8_t * service_search_pattern;
+    // index of current record in sdp_service_records
+    uint16_t  record_index;
+    btstack_linked_item_t * it;
+#ifdef ENABLE_SDP_RECORD_INDEX
+    int       use_index;
+    uint16_t  num_uuids;
+    sdp_record_index_uuid_t uuids[SDP_RECORD_INDEX_MAX_PATTERN_UUIDS];
+#endif
+} sdp_record_iterator_t;
+
+#ifdef ENABLE_SDP_RECORD_INDEX
+static int sdp_record_iterator_init_index(sdp_record_iterator_t * it){
+    if (!sdp_record_index_valid) return 0;
+    des_iterator_t pattern_it;
+    if (!des_iterator_init(&pattern_it, it->service_search_pattern)) return 0;
+    it->num_uuids = 0;
+    for ( ; des_iterator_has_more(&pattern_it); des_iterator_next(&pattern_it)){
+        uint8_t * element = des_iterator_get_element(&pattern_it);
+        if (it->num_uuids == SDP_RECORD_INDEX_MAX_PATTERN_UUIDS) return 0;
+        if (!sdp_record_index_element_is_uuid(element)) return 0;
+        sdp_record_index_uuid_for_element(&it->uuids[it->num_uuids++], element);
+    }
+    return 1;
+}
+#endif
+
+// start with record at start_index
+static void sdp_record_iterator_init(sdp_record_iterator_t * it, uint8_t * serviceSearchPattern, uint16_t start_index){
+    it->service_search_pattern = serviceSearchPattern;
+    it->record_index = start_index;
+#ifdef ENABLE_SDP_RECORD_INDEX
+    it->use_index = sdp_record_iterator_init_index(it);
+    if (it->use_index) return;
+#endif
+    it->it = (btstack_linked_item_t *) sdp_service_records;
+    uint16_t i;
+    for (i = 0; i < start_index && it->it; i++){
+        it->it = it->it->next;
+    }
+}
+
+// returns next matching record and sets record_index, or NULL
+static service_record_item_t * sdp_record_iterator_next(sdp_record_iterator_t * it){
+#ifdef ENABLE_SDP_RECORD_INDEX
+    if (it->use_index){
+        uint16_t record_index = sdp_record_index_next_match(it->uuids, it->num_uuids, it->record_index);
+        if (record_index >= sdp_record_index_num_records) return NULL;
+        it->record_index = record_index + 1;
+        return sdp_record_index_records[record_index];
+    }
+#endif
+    while (it->it){
+        service_record_item_t * item = (service_record_item_t *) it->it;
+        it->it = it->it->next;
+        it->record_index++;
+        if (sdp_record_matches_service_search_pattern(item->service_record, it->service_search_pattern)) return item;
+    }
+    return NULL;
+}
+
+// index of record returned by last call to sdp_record_iterator_next
+static uint16_t sdp_record_iterator_get_record_index(sdp_record_iterator_t * it){
+    return it->record_index - 1;
+}
+
+static uint16_t sdp_get_filtered_size(service_record_item_t * item, uint8_t * attributeIDList){
+#ifdef ENABLE_SDP_RECORD_INDEX
+    if (sdp_record_index_valid && sdp_record_index_attribute_list_supported(attributeIDList)){
+        uint16_t size = 0;
+        sdp_record_index_visit_attributes(item, attributeIDList, &sdp_record_index_handler_get_filtered_size, &size);
+        return size;
+    }
+#endif
+    return spd_get_filtered_size(item->service_record, attributeIDList);
+}
+
+static int sdp_filter_attributes(service_record_item_t * item, uint8_t * attributeIDList, uint16_t startOffset, uint16_t maxBytes, uint16_t *usedBytes, uint8_t *buffer){
+#ifdef ENABLE_SDP_RECORD_INDEX
+    if (sdp_record_index_valid && sdp_record_index_attribute_list_supported(attributeIDList)){
+        struct sdp_record_index_context_filter_attributes context;
+        context.buffer       = buffer;
+        context.start_offset = startOffset;
+        context.max_bytes    = maxBytes;
+        context.used_bytes   = 0;
+        context.complete     = 1;
+        sdp_record_index_visit_attributes(item, attributeIDList, &sdp_record_index_handler_filter_attributes, &context);
+        *usedBytes = context.used_bytes;
+        return context.complete;
+    }
+#endif
+    return sdp_filter_attributes_in_attributeIDList(item->service_record, attributeIDList, startOffset, maxBytes, usedBytes, buffer);
+}
+
+#ifdef ENABLE_SDP_RESPONSE_CACHE
+
+// SDP Response Cache: complete AttributeLists of ServiceSearchAttribute responses for (ServiceSearchPattern, AttributeIDList)
+// continuation requests for cached responses carry the offset into the AttributeLists and the database generation
+
+#ifndef SDP_RESPONSE_CACHE_ENTRIES
+#define SDP_RESPONSE_CACHE_ENTRIES 4
+#endif
+
+#ifndef HAVE_MALLOC
+#ifndef SDP_RESPONSE_CACHE_SIZE
+#define SDP_RESPONSE_CACHE_SIZE 1024
+#endif
+#endif
+
+// offset (2), generation (1)
+#define SDP_RESPONSE_CACHE_CONTINUATION_STATE_LEN 3
+
+typedef struct {
+    // ServiceSearchPattern, AttributeIDList, AttributeLists
+    uint8_t * data;
+    uint16_t  pattern_len;
+    uint16_t  attribute_id_list_len;
+    // 0 if entry is unused
+    uint16_t  response_len;
+    uint32_t  last_used;
+} sdp_response_cache_entry_t;
+
+static sdp_response_cache_entry_t sdp_response_cache[SDP_RESPONSE_CACHE_ENTRIES];
+#ifndef HAVE_MALLOC
+static uint8_t  sdp_response_cache_storage[SDP_RESPONSE_CACHE_ENTRIES][SDP_RESPONSE_CACHE_SIZE];
+#endif
+static uint32_t sdp_response_cache_use_counter;
+// incremented on each change of the registered records
+static uint8_t  sdp_response_cache_generation;
+
+static void sdp_response_cache_invalidate(void){
+    int i;
+    for (i = 0; i < SDP_RESPONSE_CACHE_ENTRIES; i++){
+#ifdef HAVE_MALLOC
+        free(sdp_response_cache[i].data);
+        sdp_response_cache[i].data = NULL;
+#endif
+        sdp_response_cache[i].response_len = 0;
+    }
+    sdp_response_cache_generation++;
+}
+#endif
+
 /**
  * @brief Register Service Record with database using ServiceRecordHandle stored in record
  * @pre AttributeIDs are in ascending order
@@ -141,7 +653,13 @@ uint8_t sdp_register_service(const uint8_t * record){
     
     // add to linked list
     btstack_linked_list_add(&sdp_service_records, (btstack_linked_item_t *) newRecordItem);
-    
+
+#ifdef ENABLE_SDP_RECORD_INDEX
+    sdp_record_index_build();
+#endif
+#ifdef ENABLE_SDP_RESPONSE_CACHE
+    sdp_response_cache_invalidate();
+#endif
     return 0;
 }
 
@@ -152,6 +670,12 @@ void sdp_unregister_service(uint32_t service_record_handle){
     service_record_item_t * record_item = sdp_get_record_item_for_handle(service_record_handle);
     if (!record_item) return;
     btstack_linked_list_remove(&sdp_service_records, (btstack_linked_item_t *) record_item);
+#ifdef ENABLE_SDP_RECORD_INDEX
+    sdp_record_index_build();
+#endif
+#ifdef ENABLE_SDP_RESPONSE_CACHE
+    sdp_response_cache_invalidate();
+#endif
 }
 
 // PDU
@@ -196,11 +720,11 @@ int sdp_handle_service_search_request(uint8_t * packet, uint16_t remote_mtu){
     }
     
     // get and limit total count
-    btstack_linked_item_t *it;
+    sdp_record_iterator_t it;
+    service_record_item_t * item;
     uint16_t total_service_count   = 0;
-    for (it = (btstack_linked_item_t *) sdp_service_records; it ; it = it->next){
-        service_record_item_t * item = (service_record_item_t *) it;
-        if (!sdp_record_matches_service_search_pattern(item->service_record, serviceSearchPattern)) continue;
+    sdp_record_iterator_init(&it, serviceSearchPattern, 0);
+    while (sdp_record_iterator_next(&it)){
         total_service_count++;
     }
     if (total_service_count > maximumServiceRecordCount){
@@ -212,10 +736,9 @@ int sdp_handle_service_search_request(uint8_t * packet, uint16_t remote_mtu){
     uint16_t current_service_count  = 0;
     uint16_t current_service_index  = 0;
     uint16_t matching_service_count = 0;
-    for (it = (btstack_linked_item_t *) sdp_service_records; it ; it = it->next, ++current_service_index){
-        service_record_item_t * item = (service_record_item_t *) it;
-
-        if (!sdp_record_matches_service_search_pattern(item->service_record, serviceSearchPattern)) continue;
+    sdp_record_iterator_init(&it, serviceSearchPattern, 0);
+    while ((item = sdp_record_iterator_next(&it)) != NULL){
+        current_service_index = sdp_record_iterator_get_record_index(&it);
         matching_service_count++;
         
         if (current_service_index < continuation_index) continue;
@@ -299,7 +822,7 @@ int sdp_handle_service_attribute_request(uint8_t * packet, uint16_t remote_mtu){
     if (continuation_offset == 0){
         
         // get size of this record
-        uint16_t filtered_attributes_size = spd_get_filtered_size(item->service_record, attributeIDList);
+        uint16_t filtered_attributes_size = sdp_get_filtered_size(item, attributeIDList);
         
         // store DES
         de_store_descriptor_with_len(&sdp_response_buffer[pos], DE_DES, DE_SIZE_VAR_16, filtered_attributes_size);
@@ -309,7 +832,7 @@ int sdp_handle_service_attribute_request(uint8_t * packet, uint16_t remote_mtu){
 
     // copy maximumAttributeByteCount from record
     uint16_t bytes_used;
-    int complete = sdp_filter_attributes_in_attributeIDList(item->service_record, attributeIDList, continuation_offset, maximumAttributeByteCount, &bytes_used, &sdp_response_buffer[pos]);
+    int complete = sdp_filter_attributes(item, attributeIDList, continuation_offset, maximumAttributeByteCount, &bytes_used, &sdp_response_buffer[pos]);
     pos += bytes_used;
     
     uint16_t attributeListByteCount = pos - 7;
@@ -332,20 +855,151 @@ int sdp_handle_service_attribute_request(uint8_t * packet, uint16_t remote_mtu){
     return pos;
 }
 
-static uint16_t sdp_get_size_for_service_search_attribute_response(uint8_t * serviceSearchPattern, uint8_t * attributeIDList){
-    uint16_t total_response_size = 0;
-    btstack_linked_item_t *it;
-    for (it = (btstack_linked_item_t *) sdp_service_records; it ; it = it->next){
-        service_record_item_t * item = (service_record_item_t *) it;
-        
-        if (!sdp_record_matches_service_search_pattern(item->service_record, serviceSearchPattern)) continue;
-        
+static uint32_t sdp_get_size_for_service_search_attribute_response(uint8_t * serviceSearchPattern, uint8_t * attributeIDList){
+    uint32_t total_response_size = 0;
+    sdp_record_iterator_t it;
+    service_record_item_t * item;
+    sdp_record_iterator_init(&it, serviceSearchPattern, 0);
+    while ((item = sdp_record_iterator_next(&it)) != NULL){
         // for all service records that match
-        total_response_size += 3 + spd_get_filtered_size(item->service_record, attributeIDList);
+        total_response_size += 3 + sdp_get_filtered_size(item, attributeIDList);
     }
     return total_response_size;
 }
 
+#ifdef ENABLE_SDP_RESPONSE_CACHE
+static sdp_response_cache_entry_t * sdp_response_cache_lookup(uint8_t * serviceSearchPattern, uint16_t serviceSearchPatternLen, uint8_t * attributeIDList, uint16_t attributeIDListLen){
+    int i;
+    for (i = 0; i < SDP_RESPONSE_CACHE_ENTRIES; i++){
+        sdp_response_cache_entry_t * entry = &sdp_response_cache[i];
+        if (entry->response_len == 0) continue;
+        if (entry->pattern_len != serviceSearchPatternLen) continue;
+        if (entry->attribute_id_list_len != attributeIDListLen) continue;
+        if (memcmp(entry->data, serviceSearchPattern, serviceSearchPatternLen) != 0) continue;
+        if (memcmp(&entry->data[serviceSearchPatternLen], attributeIDList, attributeIDListLen) != 0) continue;
+        return entry;
+    }
+    return NULL;
+}
+
+// serialize complete AttributeLists into unused or least recently used entry
+static sdp_response_cache_entry_t * sdp_response_cache_add(uint8_t * serviceSearchPattern, uint16_t serviceSearchPatternLen, uint8_t * attributeIDList, uint16_t attributeIDListLen){
+    uint32_t response_len = 3 + sdp_get_size_for_service_search_attribute_response(serviceSearchPattern, attributeIDList);
+    uint32_t key_len = serviceSearchPatternLen + attributeIDListLen;
+    // AttributeLists are stored in a DES with 16-bit length
+    if (response_len > 0xffff) return NULL;
+#ifndef HAVE_MALLOC
+    if (key_len + response_len > SDP_RESPONSE_CACHE_SIZE) return NULL;
+#endif
+
+    int i;
+    int index = 0;
+    for (i = 1; i < SDP_RESPONSE_CACHE_ENTRIES; i++){
+        if (sdp_response_cache[index].response_len == 0) break;
+        if (sdp_response_cache[i].response_len == 0 || sdp_response_cache[i].last_used < sdp_response_cache[index].last_used){
+            index = i;
+        }
+    }
+    sdp_response_cache_entry_t * entry = &sdp_response_cache[index];
+    entry->response_len = 0;
+#ifdef HAVE_MALLOC
+    free(entry->data);
+    entry->data = (uint8_t *) malloc(key_len + response_len);
+    if (!entry->data) return NULL;
+#else
+    entry->data = sdp_response_cache_storage[index];
+#endif
+
+    memcpy(entry->data, serviceSearchPattern, serviceSearchPatternLen);
+    memcpy(&entry->data[serviceSearchPatternLen], attributeIDList, attributeIDListLen);
+    entry->pattern_len = serviceSearchPatternLen;
+    entry->attribute_id_list_len = attributeIDListLen;
+
+    uint8_t * attribute_lists = &entry->data[key_len];
+    uint16_t pos = 0;
+    de_store_descriptor_with_len(&attribute_lists[pos], DE_DES, DE_SIZE_VAR_16, response_len - 3);
+    pos += 3;
+    sdp_record_iterator_t it;
+    service_record_item_t * item;
+    sdp_record_iterator_init(&it, serviceSearchPattern, 0);
+    while ((item = sdp_record_iterator_next(&it)) != NULL){
+        uint16_t filtered_attributes_size = sdp_get_filtered_size(item, attributeIDList);
+        // don't write beyond the size computed above, entry stays unused
+        if ((uint32_t) pos + 3 + filtered_attributes_size > response_len) return NULL;
+        de_store_descriptor_with_len(&attribute_lists[pos], DE_DES, DE_SIZE_VAR_16, filtered_attributes_size);
+        pos += 3;
+        uint16_t bytes_used;
+        sdp_filter_attributes(item, attributeIDList, 0, (uint16_t) (response_len - pos), &bytes_used, &attribute_lists[pos]);
+        pos += bytes_used;
+    }
+    entry->response_len = pos;
+    log_info("sdp_response_cache: added %u bytes in entry %u", pos, index);
+    return entry;
+}
+
+// returns response size, or 0 if request has to be handled without cache
+static int sdp_response_cache_handle_request(uint16_t transaction_id, uint8_t * serviceSearchPattern, uint16_t serviceSearchPatternLen, uint8_t * attributeIDList,
+    uint16_t attributeIDListLen, uint8_t * continuationState, uint16_t maximumAttributeByteCount){
+
+    uint16_t offset = 0;
+    switch (continuationState[0]){
+        case 0:
+            break;
+        case SDP_RESPONSE_CACHE_CONTINUATION_STATE_LEN:
+            // records changed since first response
+            if (continuationState[3] != sdp_response_cache_generation){
+                return sdp_create_error_response(transaction_id, 0x0005); // invalid Continuation State
+            }
+            offset = big_endian_read_16(continuationState, 1);
+            break;
+        default:
+            // continuation of response created without cache
+            return 0;
+    }
+
+    sdp_response_cache_entry_t * entry = sdp_response_cache_lookup(serviceSearchPattern, serviceSearchPatternLen, attributeIDList, attributeIDListLen);
+    if (!entry){
+        entry = sdp_response_cache_add(serviceSearchPattern, serviceSearchPatternLen, attributeIDList, attributeIDListLen);
+        if (!entry) {
+            // a continuation state from the cache requires a cached response
+            if (offset) return sdp_create_error_response(transaction_id, 0x0005); // invalid Continuation State
+            return 0;
+        }
+    }
+    entry->last_used = ++sdp_response_cache_use_counter;
+
+    if (offset >= entry->response_len){
+        return sdp_create_error_response(transaction_id, 0x0005); // invalid Continuation State
+    }
+
+    // AttributeLists - starts at offset 7
+    uint16_t pos = 7;
+    uint16_t attributeListsByteCount = btstack_min(entry->response_len - offset, maximumAttributeByteCount);
+    memcpy(&sdp_response_buffer[pos], &entry->data[entry->pattern_len + entry->attribute_id_list_len + offset], attributeListsByteCount);
+    pos += attributeListsByteCount;
+    offset += attributeListsByteCount;
+
+    // Continuation State
+    if (offset < entry->response_len){
+        sdp_response_buffer[pos++] = SDP_RESPONSE_CACHE_CONTINUATION_STATE_LEN;
+        big_endian_store_16(sdp_response_buffer, pos, offset);
+        pos += 2;
+        sdp_response_buffer[pos++] = sdp_response_cache_generation;
+    } else {
+        // complete
+        sdp_response_buffer[pos++] = 0;
+    }
+
+    // create SDP header
+    sdp_response_buffer[0] = SDP_ServiceSearchAttributeResponse;
+    big_endian_store_16(sdp_response_buffer, 1, transaction_id);
+    big_endian_store_16(sdp_response_buffer, 3, pos - 5);  // size of variable payload
+    big_endian_store_16(sdp_response_buffer, 5, attributeListsByteCount);
+
+    return pos;
+}
+#endif
+
 int sdp_handle_service_search_attribute_request(uint8_t * packet, uint16_t remote_mtu){
     
     // SDP header before attribute sevice list: 7
@@ -378,6 +1032,12 @@ int sdp_handle_service_search_attribute_request(uint8_t * packet, uint16_t remot
     if (maximumAttributeByteCount2 < maximumAttributeByteCount) {
         maximumAttributeByteCount = maximumAttributeByteCount2;
     }
+
+#ifdef ENABLE_SDP_RESPONSE_CACHE
+    int cached_response_size = sdp_response_cache_handle_request(transaction_id, serviceSearchPattern, serviceSearchPatternLen, attributeIDList,
+        attributeIDListLen, continuationState, maximumAttributeByteCount);
+    if (cached_response_size) return cached_response_size;
+#endif
     
     // continuation state contains: index of next service record to examine
     // continuation state contains: byte offset into this service record
@@ -395,7 +1055,7 @@ int sdp_handle_service_search_attribute_request(uint8_t * packet, uint16_t remot
     
     // add DES with total size for first request
     if (continuation_service_index == 0 && continuation_offset == 0){
-        uint16_t total_response_size = sdp_get_size_for_service_search_attribute_response(serviceSearchPattern, attributeIDList);
+        uint16_t total_response_size = (uint16_t) sdp_get_size_for_service_search_attribute_response(serviceSearchPattern, attributeIDList);
         de_store_descriptor_with_len(&sdp_response_buffer[pos], DE_DES, DE_SIZE_VAR_16, total_response_size);
         // log_info("total response size %u", total_response_size);
         pos += 3;
@@ -406,17 +1066,16 @@ int sdp_handle_service_search_attribute_request(uint8_t * packet, uint16_t remot
     int      first_answer = 1;
     int      continuation = 0;
     uint16_t current_service_index = 0;
-    btstack_linked_item_t *it = (btstack_linked_item_t *) sdp_service_records;
-    for ( ; it ; it = it->next, ++current_service_index){
-        service_record_item_t * item = (service_record_item_t *) it;
-        
-        if (current_service_index < continuation_service_index ) continue;
-        if (!sdp_record_matches_service_search_pattern(item->service_record, serviceSearchPattern)) continue;
+    sdp_record_iterator_t it;
+    service_record_item_t * item;
+    sdp_record_iterator_init(&it, serviceSearchPattern, continuation_service_index);
+    while ((item = sdp_record_iterator_next(&it)) != NULL){
+        current_service_index = sdp_record_iterator_get_record_index(&it);
 
         if (continuation_offset == 0){
             
             // get size of this record
-            uint16_t filtered_attributes_size = spd_get_filtered_size(item->service_record, attributeIDList);
+            uint16_t filtered_attributes_size = sdp_get_filtered_size(item, attributeIDList);
             
             // stop if complete record doesn't fits into response but we already have a partial response
             if ((filtered_attributes_size + 3 > maximumAttributeByteCount) && !first_answer) {
@@ -434,7 +1093,7 @@ int sdp_handle_service_search_attribute_request(uint8_t * packet, uint16_t remot
     
         // copy maximumAttributeByteCount from record
         uint16_t bytes_used;
-        int complete = sdp_filter_attributes_in_attributeIDList(item->service_record, attributeIDList, continuation_offset, maximumAttributeByteCount, &bytes_used, &sdp_response_buffer[pos]);
+        int complete = sdp_filter_attributes(item, attributeIDList, continuation_offset, maximumAttributeByteCount, &bytes_used, &sdp_response_buffer[pos]);
         pos += bytes_used;
         maximumAttributeByteCount -= bytes_used;
         
@@ -52,6 +52,11 @@ typedef struct {
 
     uint32_t        service_record_handle;
     uint8_t *       service_record;
+#ifdef ENABLE_SDP_RECORD_INDEX
+    // attributes of this record in SDP record index
+    uint16_t        index_first_attribute;
+    uint16_t        index_num_attributes;
+#endif
 } service_record_item_t;
 
 int sdp_handle_service_search_request(uint8_t * packet, uint16_t remote_mtu);
@@ -70,6 +75,7 @@ void sdp_init(void);
  * @pre AttributeIDs are in ascending order
  * @pre ServiceRecordHandle is first attribute and valid
  * @param record is not copied!
+ * @note With ENABLE_SDP_RECORD_INDEX, the lookup index for all records is rebuilt here
  * @result status
  */
 uint8_t sdp_register_service(const uint8_t * record);
@@ -175,6 +175,156 @@ static const char * default_classic_name = "BTstack 00:00:00:00:00:00";
 static uint8_t disable_l2cap_timeouts = 0;
 #endif
 
+// Connection Index
+
+typedef uint32_t (*hci_connection_index_hash_t)(const hci_connection_t * conn);
+typedef int      (*hci_connection_index_match_t)(const hci_connection_t * conn_a, const hci_connection_t * conn_b);
+
+#define HCI_CONNECTION_INDEX_MASK (HCI_CONNECTION_INDEX_SIZE - 1)
+
+static uint32_t hci_connection_hash_for_handle(hci_con_handle_t con_handle){
+    // multiplicative hashing, con handles are often small consecutive numbers
+    return (con_handle * 2654435761u) >> 16;
+}
+
+static uint32_t hci_connection_hash_for_address(const uint8_t * addr, bd_addr_type_t addr_type){
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    int i;
+    for (i = 0; i < 6; i++){
+        hash = (hash ^ addr[i]) * 16777619u;
+    }
+    return (hash ^ addr_type) * 16777619u;
+}
+
+static uint32_t hci_connection_index_hash_handle(const hci_connection_t * conn){
+    return hci_connection_hash_for_handle(conn->con_handle);
+}
+
+static int hci_connection_index_match_handle(const hci_connection_t * conn_a, const hci_connection_t * conn_b){
+    return conn_a->con_handle == conn_b->con_handle;
+}
+
+static uint32_t hci_connection_index_hash_address(const hci_connection_t * conn){
+    return hci_connection_hash_for_address(conn->address, conn->address_type);
+}
+
+static int hci_connection_index_match_address(const hci_connection_t * conn_a, const hci_connection_t * conn_b){
+    if (conn_a->address_type != conn_b->address_type) return 0;
+    return memcmp(conn_a->address, conn_b->address, 6) == 0;
+}
+
+static void hci_connection_index_insert(hci_connection_index_t * index, hci_connection_t * conn, hci_connection_index_hash_t hash, hci_connection_index_match_t match){
+    if (index->overflow) return;
+    uint32_t slot = hash(conn) & HCI_CONNECTION_INDEX_MASK;
+    while (index->entries[slot]){
+        if (index->entries[slot] == conn) return;
+        // same key, newer connection shadows older one. older one is re-inserted when newer one is removed
+        if (match(index->entries[slot], conn)){
+            index->entries[slot] = conn;
+            return;
+        }
+        slot = (slot + 1) & HCI_CONNECTION_INDEX_MASK;
+    }
+    // keep load factor <= 3/4
+    if ((index->num_entries + 1) * 4 > HCI_CONNECTION_INDEX_SIZE * 3){
+        log_info("connection index full, using linear search");
+        index->overflow = 1;
+        return;
+    }
+    index->entries[slot] = conn;
+    index->num_entries++;
+}
+
+static void hci_connection_index_remove_entry(hci_connection_index_t * index, hci_connection_t * conn, hci_connection_index_hash_t hash){
+    uint32_t slot = hash(conn) & HCI_CONNECTION_INDEX_MASK;
+    while (index->entries[slot] != conn){
+        if (index->entries[slot] == NULL) return;
+        slot = (slot + 1) & HCI_CONNECTION_INDEX_MASK;
+    }
+    index->entries[slot] = NULL;
+    index->num_entries--;
+    // backward shift deletion: move following entries of the probe sequence into the gap
+    uint32_t gap  = slot;
+    uint32_t next = slot;
+    while (1){
+        next = (next + 1) & HCI_CONNECTION_INDEX_MASK;
+        hci_connection_t * entry = index->entries[next];
+        if (entry == NULL) break;
+        uint32_t home = hash(entry) & HCI_CONNECTION_INDEX_MASK;
+        // entry can be moved if its home slot is not between gap (exclusive) and next (inclusive)
+        if (((next - home) & HCI_CONNECTION_INDEX_MASK) < ((next - gap) & HCI_CONNECTION_INDEX_MASK)) continue;
+        index->entries[gap]  = entry;
+        index->entries[next] = NULL;
+        gap = next;
+    }
+}
+
+// add connections to index except the one that is going away. if same_key_only is set, only re-add connections shadowed by it
+static void hci_connection_index_refill(hci_connection_index_t * index, hci_connection_t * removed, int same_key_only, 
+    int (*indexable)(const hci_connection_t * conn), hci_connection_index_hash_t hash, hci_connection_index_match_t match){
+    btstack_linked_list_iterator_t it;
+    btstack_linked_list_iterator_init(&it, &hci_stack->connections);
+    while (btstack_linked_list_iterator_has_next(&it)){
+        hci_connection_t * conn = (hci_connection_t *) btstack_linked_list_iterator_next(&it);
+        if (conn == removed) continue;
+        if (!indexable(conn)) continue;
+        if (same_key_only && !match(conn, removed)) continue;
+        hci_connection_index_insert(index, conn, hash, match);
+    }
+}
+
+static void hci_connection_index_remove(hci_connection_index_t * index, hci_connection_t * conn, int (*indexable)(const hci_connection_t * conn),
+    hci_connection_index_hash_t hash, hci_connection_index_match_t match){
+    if (index->overflow){
+        // rebuild index without overflow if possible
+        memset(index, 0, sizeof(hci_connection_index_t));
+        hci_connection_index_refill(index, conn, 0, indexable, hash, match);
+        return;
+    }
+    hci_connection_index_remove_entry(index, conn, hash);
+    hci_connection_index_refill(index, conn, 1, indexable, hash, match);
+}
+
+static int hci_connection_index_has_handle(const hci_connection_t * conn){
+    return conn->con_handle != HCI_CON_HANDLE_INVALID;
+}
+
+static int hci_connection_index_has_address(const hci_connection_t * conn){
+    UNUSED(conn);
+    return 1;
+}
+
+static void hci_connection_index_add_connection(hci_connection_t * conn){
+    hci_connection_index_insert(&hci_stack->connections_by_address, conn, &hci_connection_index_hash_address, &hci_connection_index_match_address);
+    if (!hci_connection_index_has_handle(conn)) return;
+    hci_connection_index_insert(&hci_stack->connections_by_handle, conn, &hci_connection_index_hash_handle, &hci_connection_index_match_handle);
+}
+
+static void hci_connection_index_remove_connection(hci_connection_t * conn){
+    hci_connection_index_remove(&hci_stack->connections_by_address, conn, &hci_connection_index_has_address,
+        &hci_connection_index_hash_address, &hci_connection_index_match_address);
+    if (!hci_connection_index_has_handle(conn)) return;
+    hci_connection_index_remove(&hci_stack->connections_by_handle, conn, &hci_connection_index_has_handle, 
+        &hci_connection_index_hash_handle, &hci_connection_index_match_handle);
+}
+
+static void hci_connection_set_con_handle(hci_connection_t * conn, hci_con_handle_t con_handle){
+    if (hci_connection_index_has_handle(conn)){
+        hci_connection_index_remove(&hci_stack->connections_by_handle, conn, &hci_connection_index_has_handle,
+            &hci_connection_index_hash_handle, &hci_connection_index_match_handle);
+    }
+    conn->con_handle = con_handle;
+    if (!hci_connection_index_has_handle(conn)) return;
+    hci_connection_index_insert(&hci_stack->connections_by_handle, conn, &hci_connection_index_hash_handle, &hci_connection_index_match_handle);
+}
+
+static void hci_connection_free(hci_connection_t * conn){
+    hci_connection_index_remove_connection(conn);
+    btstack_linked_list_remove(&hci_stack->connections, (btstack_linked_item_t *) conn);
+    btstack_memory_hci_connection_free( conn );
+}
+
 /**
  * create connection for given address
  *
@@ -202,6 +352,7 @@ static hci_connection_t * create_connection_for_bd_addr_and_type(bd_addr_t addr,
     conn->num_sco_packets_sent = 0;
     conn->le_con_parameter_update_state = CON_PARAMETER_UPDATE_NONE;
     btstack_linked_list_add(&hci_stack->connections, (btstack_linked_item_t *) conn);
+    hci_connection_index_add_connection(conn);
     return conn;
 }
 
@@ -240,6 +391,15 @@ void hci_connections_get_iterator(btstack_linked_list_iterator_t *it){
  * @return connection OR NULL, if not found
  */
 hci_connection_t * hci_connection_for_handle(hci_con_handle_t con_handle){
+    const hci_connection_index_t * index = &hci_stack->connections_by_handle;
+    if (con_handle != HCI_CON_HANDLE_INVALID && !index->overflow){
+        uint32_t slot = hci_connection_hash_for_handle(con_handle) & HCI_CONNECTION_INDEX_MASK;
+        while (index->entries[slot]){
+            if (index->entries[slot]->con_handle == con_handle) return index->entries[slot];
+            slot = (slot + 1) & HCI_CONNECTION_INDEX_MASK;
+        }
+        return NULL;
+    }
     btstack_linked_list_iterator_t it;
     btstack_linked_list_iterator_init(&it, &hci_stack->connections);
     while (btstack_linked_list_iterator_has_next(&it)){
@@ -257,6 +417,16 @@ hci_connection_t * hci_connection_for_handle(hci_con_handle_t con_handle){
  * @return connection OR NULL, if not found
  */
 hci_connection_t * hci_connection_for_bd_addr_and_type(bd_addr_t  addr, bd_addr_type_t addr_type){
+    const hci_connection_index_t * index = &hci_stack->connections_by_address;
+    if (!index->overflow){
+        uint32_t slot = hci_connection_hash_for_address(addr, addr_type) & HCI_CONNECTION_INDEX_MASK;
+        while (index->entries[slot]){
+            hci_connection_t * connection = index->entries[slot];
+            if (connection->address_type == addr_type && memcmp(addr, connection->address, 6) == 0) return connection;
+            slot = (slot + 1) & HCI_CONNECTION_INDEX_MASK;
+        }
+        return NULL;
+    }
     btstack_linked_list_iterator_t it;
     btstack_linked_list_iterator_init(&it, &hci_stack->connections);
     while (btstack_linked_list_iterator_has_next(&it)){
@@ -542,6 +712,86 @@ static int hci_transport_synchronous(void){
     return hci_stack->hci_transport->can_send_packet_now == NULL;
 }
 
+static void hci_drop_acl_fragments(void){
+    hci_stack->acl_fragmentation_total_size = 0;
+    hci_stack->acl_fragmentation_pos = 0;
+    // with scatter/gather send, no "transport done" will release the buffer if no fragment is in flight
+    if (hci_stack->hci_transport->send_packet_with_header && hci_stack->acl_fragments_in_flight == 0){
+        hci_release_packet_buffer();
+    }
+}
+
+// send as many fragments as the controller and the transport accept right away. The ACL header is passed separately,
+// so the packet buffer isn't modified and multiple fragments can be in flight
+static int hci_send_acl_packet_fragments_with_header(hci_connection_t *connection, uint16_t max_acl_data_packet_length){
+
+    const uint16_t handle_and_flags = little_endian_read_16(hci_stack->hci_packet_buffer, 0);
+    int err = 0;
+
+    while (1){
+
+        uint16_t fragment_pos  = hci_stack->acl_fragmentation_pos;
+        uint16_t fragment_size = hci_stack->acl_fragmentation_total_size - fragment_pos;
+        int more_fragments = 0;
+        if (fragment_size > max_acl_data_packet_length){
+            more_fragments = 1;
+            fragment_size = max_acl_data_packet_length;
+        }
+
+        // first fragment uses header in packet buffer directly in front of the payload, so the transport can send
+        // it without copying. Continuing fragments get their own header with packet boundary flags set accordingly
+        uint8_t * payload = &hci_stack->hci_packet_buffer[fragment_pos];
+        uint8_t   continuing_acl_header[4];
+        uint8_t * acl_header;
+        if (fragment_pos == 4){
+            acl_header = hci_stack->hci_packet_buffer;
+        } else {
+            acl_header = continuing_acl_header;
+            little_endian_store_16(acl_header, 0, (handle_and_flags & 0xcfff) | (1 << 12));
+        }
+        little_endian_store_16(acl_header, 2, fragment_size);
+
+        connection->num_acl_packets_sent++;
+
+        // update state before send as "transport done" might be sent during send_packet_with_header already
+        if (more_fragments){
+            hci_stack->acl_fragmentation_pos += fragment_size;
+        } else {
+            hci_stack->acl_fragmentation_pos = 0;
+            hci_stack->acl_fragmentation_total_size = 0;
+        }
+
+        // temporarily store header in front of payload for packet log
+        if (acl_header == continuing_acl_header){
+            uint8_t payload_prefix[4];
+            memcpy(payload_prefix, payload - 4, 4);
+            memcpy(payload - 4, acl_header, 4);
+            hci_dump_packet(HCI_ACL_DATA_PACKET, 0, payload - 4, fragment_size + 4);
+            memcpy(payload - 4, payload_prefix, 4);
+        } else {
+            hci_dump_packet(HCI_ACL_DATA_PACKET, 0, acl_header, fragment_size + 4);
+        }
+
+        if (!hci_transport_synchronous()){
+            hci_stack->acl_fragments_in_flight++;
+        }
+        err = hci_stack->hci_transport->send_packet_with_header(HCI_ACL_DATA_PACKET, acl_header, 4, payload, fragment_size);
+
+        if (!more_fragments) break;
+
+        if (!hci_can_send_prepared_acl_packet_now(connection->con_handle)) return err;
+    }
+
+    // release buffer now for synchronous transport
+    if (hci_transport_synchronous()){
+        hci_release_packet_buffer();
+        uint8_t event[] = { HCI_EVENT_TRANSPORT_PACKET_SENT, 0};
+        hci_emit_event(&event[0], sizeof(event), 0);  // don't dump
+    }
+
+    return err;
+}
+
 static int hci_send_acl_packet_fragments(hci_connection_t *connection){
 
     // log_info("hci_send_acl_packet_fragments  %u/%u (con 0x%04x)", hci_stack->acl_fragmentation_pos, hci_stack->acl_fragmentation_total_size, connection->con_handle);
@@ -555,6 +805,11 @@ static int hci_send_acl_packet_fragments(hci_connection_t *connection){
     // testing: reduce buffer to minimum
     // max_acl_data_packet_length = 52;
 
+    // use scatter/gather send if supported by transport
+    if (hci_stack->hci_transport->send_packet_with_header){
+        return hci_send_acl_packet_fragments_with_header(connection, max_acl_data_packet_length);
+    }
+
     log_debug("hci_send_acl_packet_fragments entered");
 
     int err;
@@ -833,8 +1088,7 @@ static void hci_shutdown_connection(hci_connection_t *conn){
 
     btstack_run_loop_remove_timer(&conn->timeout);
     
-    btstack_linked_list_remove(&hci_stack->connections, (btstack_linked_item_t *) conn);
-    btstack_memory_hci_connection_free( conn );
+    hci_connection_free(conn);
     
     // now it's gone
     hci_emit_nr_connections_changed();
@@ -911,6 +1165,12 @@ uint16_t hci_max_acl_data_packet_length(void){
     return hci_stack->acl_data_packet_length;
 }
 
+uint16_t hci_max_acl_le_data_packet_length(void){
+    // LE and Classic share the same buffers if LE buffer size is zero
+    if (hci_stack->le_data_packets_length > 0) return hci_stack->le_data_packets_length;
+    return hci_stack->acl_data_packet_length;
+}
+
 #ifdef ENABLE_CLASSIC
 int hci_extended_sco_link_supported(void){
     // No. 31, byte 3, bit 7
@@ -1908,7 +2168,7 @@ static void event_handler(uint8_t *packet, int size){
             if (conn) {
                 if (!packet[2]){
                     conn->state = OPEN;
-                    conn->con_handle = little_endian_read_16(packet, 3);
+                    hci_connection_set_con_handle(conn, little_endian_read_16(packet, 3));
                     conn->bonding_flags |= BONDING_REQUEST_REMOTE_FEATURES;
 
                     // restart timer
@@ -1925,8 +2185,7 @@ static void event_handler(uint8_t *packet, int size){
                     memcpy(&bd_address, conn->address, 6);
 
                     // connection failed, remove entry
-                    btstack_linked_list_remove(&hci_stack->connections, (btstack_linked_item_t *) conn);
-                    btstack_memory_hci_connection_free( conn );
+                    hci_connection_free(conn);
                     
                     // notify client if dedicated bonding
                     if (notify_dedicated_bonding_failed){
@@ -1957,7 +2216,7 @@ static void event_handler(uint8_t *packet, int size){
                 break;
             }
             conn->state = OPEN;
-            conn->con_handle = little_endian_read_16(packet, 3);            
+            hci_connection_set_con_handle(conn, little_endian_read_16(packet, 3));
 
 #ifdef ENABLE_SCO_OVER_HCI
             // update SCO
@@ -2094,8 +2353,7 @@ static void event_handler(uint8_t *packet, int size){
             if (hci_stack->acl_fragmentation_total_size > 0) {
                 if (handle == READ_ACL_CONNECTION_HANDLE(hci_stack->hci_packet_buffer)){
                     log_info("hci: drop fragmented ACL data for closed connection");
-                     hci_stack->acl_fragmentation_total_size = 0;
-                     hci_stack->acl_fragmentation_pos = 0;
+                    hci_drop_acl_fragments();
                 }
             }
 
@@ -2139,6 +2397,13 @@ static void event_handler(uint8_t *packet, int size){
                 log_error("Synchronous HCI Transport shouldn't send HCI_EVENT_TRANSPORT_PACKET_SENT");
                 return; // instead of break: to avoid re-entering hci_run()
             }
+            // with scatter/gather send, the event contains the packet type and only the last ACL fragment releases the buffer
+            if (hci_stack->hci_transport->send_packet_with_header){
+                if (size >= 3 && packet[2] == HCI_ACL_DATA_PACKET && hci_stack->acl_fragments_in_flight){
+                    hci_stack->acl_fragments_in_flight--;
+                }
+                if (hci_stack->acl_fragments_in_flight) break;
+            }
             if (hci_stack->acl_fragmentation_total_size) break;
             hci_release_packet_buffer();
             
@@ -2191,8 +2456,7 @@ static void event_handler(uint8_t *packet, int size){
                         hci_stack->le_connecting_state = LE_CONNECTING_IDLE;
                         // remove entry
                         if (conn){
-                            btstack_linked_list_remove(&hci_stack->connections, (btstack_linked_item_t *) conn);
-                            btstack_memory_hci_connection_free( conn );
+                            hci_connection_free(conn);
                         }
                         break;
                     }
@@ -2222,7 +2486,7 @@ static void event_handler(uint8_t *packet, int size){
                     
                     conn->state = OPEN;
                     conn->role  = packet[6];
-                    conn->con_handle = little_endian_read_16(packet, 4);
+                    hci_connection_set_con_handle(conn, little_endian_read_16(packet, 4));
                     
                     // TODO: store - role, peer address type, conn_interval, conn_latency, supervision timeout, master clock
 
@@ -2344,6 +2608,8 @@ void hci_register_sco_packet_handler(btstack_packet_handler_t handler){
 static void hci_state_reset(void){
     // no connections yet
     hci_stack->connections = NULL;
+    memset(&hci_stack->connections_by_handle,  0, sizeof(hci_connection_index_t));
+    memset(&hci_stack->connections_by_address, 0, sizeof(hci_connection_index_t));
 
     // keep discoverable/connectable as this has been requested by the client(s)
     // hci_stack->discoverable = 0;
@@ -2353,6 +2619,7 @@ static void hci_state_reset(void){
 
     // buffer is free
     hci_stack->hci_packet_buffer_reserved = 0;
+    hci_stack->acl_fragments_in_flight = 0;
 
     // no pending cmds
     hci_stack->decline_reason = 0;
@@ -2865,8 +3132,7 @@ static void hci_run(void){
         } else {
             // connection gone -> discard further fragments
             log_info("hci_run: fragmented ACL packet no connection -> discard fragment");
-            hci_stack->acl_fragmentation_total_size = 0;
-            hci_stack->acl_fragmentation_pos = 0;
+            hci_drop_acl_fragments();
         }
     }
 
@@ -3549,18 +3815,23 @@ void gap_ssp_set_auto_accept(int auto_accept){
 #endif
 
 // va_list part of hci_send_cmd
-int hci_send_cmd_va_arg(const hci_cmd_t *cmd, va_list argptr){
+uint8_t * hci_reserve_cmd_packet_buffer(uint16_t opcode){
     if (!hci_can_send_command_packet_now()){ 
         log_error("hci_send_cmd called but cannot send packet now");
-        return 0;
+        return NULL;
     }
 
     // for HCI INITIALIZATION
-    // log_info("hci_send_cmd: opcode %04x", cmd->opcode);
-    hci_stack->last_cmd_opcode = cmd->opcode;
+    // log_info("hci_send_cmd: opcode %04x", opcode);
+    hci_stack->last_cmd_opcode = opcode;
 
     hci_reserve_packet_buffer();
-    uint8_t * packet = hci_stack->hci_packet_buffer;
+    return hci_stack->hci_packet_buffer;
+}
+
+int hci_send_cmd_va_arg(const hci_cmd_t *cmd, va_list argptr){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(cmd->opcode);
+    if (!packet) return 0;
     uint16_t size = hci_cmd_create_from_template(packet, cmd, argptr);
     return hci_send_cmd_packet(packet, size);
 }
@@ -4030,8 +4301,7 @@ uint8_t gap_connect_cancel(void){
         case SEND_CREATE_CONNECTION:
             // skip sending create connection and emit event instead
             hci_emit_le_connection_complete(conn->address_type, conn->address, 0, ERROR_CODE_UNKNOWN_CONNECTION_IDENTIFIER);
-            btstack_linked_list_remove(&hci_stack->connections, (btstack_linked_item_t *) conn);
-            btstack_memory_hci_connection_free( conn );
+            hci_connection_free(conn);
             break;            
         case SENT_CREATE_CONNECTION:
             // request to send cancel connection
@@ -124,6 +124,19 @@ extern "C" {
 #endif
 #endif
 
+// number of slots in hash tables used for connection lookup by handle and by address, must be power of two.
+// if more than 3/4 of the slots would be used, connection lookup falls back to linear search
+#ifndef HCI_CONNECTION_INDEX_SIZE
+#ifdef HAVE_MALLOC
+#define HCI_CONNECTION_INDEX_SIZE 64
+#else
+#define HCI_CONNECTION_INDEX_SIZE 16
+#endif
+#endif
+#if (HCI_CONNECTION_INDEX_SIZE & (HCI_CONNECTION_INDEX_SIZE - 1)) != 0
+#error "HCI_CONNECTION_INDEX_SIZE must be a power of two"
+#endif
+
 // 
 #define IS_COMMAND(packet, command) (little_endian_read_16(packet,0) == command.opcode)
 
@@ -425,8 +438,39 @@ typedef enum {
     ATT_SERVER_REQUEST_RECEIVED,
     ATT_SERVER_W4_SIGNED_WRITE_VALIDATION,
     ATT_SERVER_REQUEST_RECEIVED_AND_VALIDATED,
+    ATT_SERVER_W4_AUTHORIZATION,
 } att_server_state_t;
 
+#ifdef ENABLE_ATT_SERVER_NOTIFICATION_QUEUE
+
+// max number of different attribute handles with queued notifications per connection
+#ifndef ATT_SERVER_NOTIFICATION_QUEUE_SIZE
+#define ATT_SERVER_NOTIFICATION_QUEUE_SIZE 8
+#endif
+
+// max size of queued notification value, default fits into ATT_DEFAULT_MTU
+#ifndef ATT_SERVER_NOTIFICATION_QUEUE_VALUE_SIZE
+#define ATT_SERVER_NOTIFICATION_QUEUE_VALUE_SIZE 20
+#endif
+
+typedef struct {
+    uint16_t attribute_handle;
+    uint16_t value_len;
+    uint32_t queued_ms;
+    uint8_t  value[ATT_SERVER_NOTIFICATION_QUEUE_VALUE_SIZE];
+} att_server_queued_notification_t;
+
+typedef struct {
+    uint32_t queued;            // notifications added to queue
+    uint32_t coalesced;         // updates of already queued notifications
+    uint32_t dropped;           // queue full or discarded on disconnect
+    uint32_t sent;
+    uint32_t latency_ms_max;    // time in queue
+    uint32_t latency_ms_total;
+} att_server_notification_stats_t;
+
+#endif
+
 typedef struct {
     att_server_state_t      state;
 
@@ -444,6 +488,14 @@ typedef struct {
     uint16_t                request_size;
     uint8_t                 request_buffer[ATT_REQUEST_BUFFER_SIZE];
 
+#ifdef ENABLE_ATT_SERVER_NOTIFICATION_QUEUE
+    // ring buffer, at most one entry per attribute handle
+    uint8_t                          notification_queue_head;
+    uint8_t                          notification_queue_count;
+    att_server_queued_notification_t notification_queue[ATT_SERVER_NOTIFICATION_QUEUE_SIZE];
+    att_server_notification_stats_t  notification_stats;
+#endif
+
 } att_server_t;
 
 #endif
@@ -535,6 +587,9 @@ typedef struct {
     l2cap_state_t l2cap_state;
 #endif
 
+    // L2CAP channels on this connection, linked via l2cap_channel_t.connection_item, maintained by l2cap.c
+    btstack_linked_list_t l2cap_channels;
+
 } hci_connection_t;
 
 
@@ -668,6 +723,14 @@ typedef struct {
     uint8_t        state;   
 } whitelist_entry_t;
 
+// open-addressed hash table with linear probing, connections are also kept in hci_stack->connections
+typedef struct {
+    hci_connection_t * entries[HCI_CONNECTION_INDEX_SIZE];
+    uint16_t           num_entries;
+    // set if not all connections could be indexed -> linear search
+    uint8_t            overflow;
+} hci_connection_index_t;
+
 /**
  * main data structure
  */
@@ -688,6 +751,10 @@ typedef struct {
     // list of existing baseband connections
     btstack_linked_list_t     connections;
 
+    // connection lookup by con handle and by address + address type
+    hci_connection_index_t    connections_by_handle;
+    hci_connection_index_t    connections_by_address;
+
     /* callback to L2CAP layer */
     btstack_packet_handler_t acl_packet_handler;
 
@@ -717,6 +784,7 @@ typedef struct {
     uint8_t   hci_packet_buffer_reserved;
     uint16_t  acl_fragmentation_pos;
     uint16_t  acl_fragmentation_total_size;
+    uint8_t   acl_fragments_in_flight;    // only used with send_packet_with_header
      
     /* host to controller flow control */
     uint8_t  num_cmd_packets;
@@ -1014,6 +1082,12 @@ void hci_release_packet_buffer(void);
  */
 int hci_send_cmd_va_arg(const hci_cmd_t *cmd, va_list argtr);
 
+/**
+ * Reserve outgoing packet buffer for HCI command with given opcode, used by hci_cmd_encoder.h
+ * @return packet buffer or NULL if command cannot be sent now
+ */
+uint8_t * hci_reserve_cmd_packet_buffer(uint16_t opcode);
+
 /**
  * Get connection iterator. Only used by l2cap.c and sm.c
  */
@@ -1070,6 +1144,11 @@ int hci_authentication_active_for_handle(hci_con_handle_t handle);
  */
 uint16_t hci_max_acl_data_packet_length(void);
 
+/**
+ * Get maximal ACL LE data packet length based on LE buffer size, which reflects LE Data Length Extension. Called by L2CAP
+ */
+uint16_t hci_max_acl_le_data_packet_length(void);
+
 /**
  * Get supported packet types. Called by L2CAP
  */
@@ -0,0 +1,3021 @@
+/*
+ * Copyright (C) 2017 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+
+/*
+ *  hci_cmd_encoder.h
+ *
+ *  @brief Fixed-layout encoders for HCI Commands
+ *  @note  Don't edit - generated by tool/btstack_hci_cmd_generator.py
+ *
+ *  hci_cmd_encode_NAME(packet, ...) stores command hci_NAME into packet and returns its size.
+ *  hci_send_NAME(...) sends it like hci_send_cmd(&hci_NAME, ...) without parsing the format string.
+ */
+
+#ifndef __HCI_CMD_ENCODER_H
+#define __HCI_CMD_ENCODER_H
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+#include "bluetooth.h"
+#include "btstack_util.h"
+#include "hci.h"
+#include <stdint.h>
+#include <string.h>
+
+#define HCI_CMD_ENCODER_OPCODE(ogf, ocf) ((ocf) | ((ogf) << 10))
+
+/* API_START */
+
+/**
+ * @brief Store HCI command HCI_INQUIRY into packet
+ * @param packet buffer of at least 8 bytes
+ * @param lap
+ * @param inquiry_length
+ * @param num_responses
+ * @return size of command packet
+ * @note: btstack_type 311
+ */
+static inline uint16_t hci_cmd_encode_inquiry(uint8_t * packet, uint32_t lap, uint8_t inquiry_length, uint8_t num_responses){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x01));
+    packet[2] = 5;
+    little_endian_store_16(packet, 3, lap);
+    packet[3+2] = lap >> 16;
+    packet[6] = inquiry_length;
+    packet[7] = num_responses;
+    return 8;
+}
+
+/**
+ * @brief Send HCI command HCI_INQUIRY
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_inquiry(uint32_t lap, uint8_t inquiry_length, uint8_t num_responses){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x01));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_inquiry(packet, lap, inquiry_length, num_responses));
+}
+
+/**
+ * @brief Store HCI command HCI_INQUIRY_CANCEL into packet
+ * @param packet buffer of at least 3 bytes
+ * @return size of command packet
+ * @note: btstack_type 
+ */
+static inline uint16_t hci_cmd_encode_inquiry_cancel(uint8_t * packet){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x02));
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send HCI command HCI_INQUIRY_CANCEL
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_inquiry_cancel(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x02));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_inquiry_cancel(packet));
+}
+
+/**
+ * @brief Store HCI command HCI_CREATE_CONNECTION into packet
+ * @param packet buffer of at least 16 bytes
+ * @param bd_addr
+ * @param packet_type
+ * @param page_scan_repetition_mode
+ * @param reserved
+ * @param clock_offset
+ * @param allow_role_switch
+ * @return size of command packet
+ * @note: btstack_type B21121
+ */
+static inline uint16_t hci_cmd_encode_create_connection(uint8_t * packet, const uint8_t * bd_addr, uint16_t packet_type, uint8_t page_scan_repetition_mode, uint8_t reserved, uint16_t clock_offset, uint8_t allow_role_switch){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x05));
+    packet[2] = 13;
+    reverse_bd_addr(bd_addr, &packet[3]);
+    little_endian_store_16(packet, 9, packet_type);
+    packet[11] = page_scan_repetition_mode;
+    packet[12] = reserved;
+    little_endian_store_16(packet, 13, clock_offset);
+    packet[15] = allow_role_switch;
+    return 16;
+}
+
+/**
+ * @brief Send HCI command HCI_CREATE_CONNECTION
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_create_connection(const uint8_t * bd_addr, uint16_t packet_type, uint8_t page_scan_repetition_mode, uint8_t reserved, uint16_t clock_offset, uint8_t allow_role_switch){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x05));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_create_connection(packet, bd_addr, packet_type, page_scan_repetition_mode, reserved, clock_offset, allow_role_switch));
+}
+
+/**
+ * @brief Store HCI command HCI_DISCONNECT into packet
+ * @param packet buffer of at least 6 bytes
+ * @param handle
+ * @param reason
+ * @return size of command packet
+ * @note: btstack_type H1
+ */
+static inline uint16_t hci_cmd_encode_disconnect(uint8_t * packet, hci_con_handle_t handle, uint8_t reason){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x06));
+    packet[2] = 3;
+    little_endian_store_16(packet, 3, handle);
+    packet[5] = reason;
+    return 6;
+}
+
+/**
+ * @brief Send HCI command HCI_DISCONNECT
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_disconnect(hci_con_handle_t handle, uint8_t reason){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x06));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_disconnect(packet, handle, reason));
+}
+
+/**
+ * @brief Store HCI command HCI_CREATE_CONNECTION_CANCEL into packet
+ * @param packet buffer of at least 9 bytes
+ * @param bd_addr
+ * @return size of command packet
+ * @note: btstack_type B
+ */
+static inline uint16_t hci_cmd_encode_create_connection_cancel(uint8_t * packet, const uint8_t * bd_addr){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x08));
+    packet[2] = 6;
+    reverse_bd_addr(bd_addr, &packet[3]);
+    return 9;
+}
+
+/**
+ * @brief Send HCI command HCI_CREATE_CONNECTION_CANCEL
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_create_connection_cancel(const uint8_t * bd_addr){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x08));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_create_connection_cancel(packet, bd_addr));
+}
+
+/**
+ * @brief Store HCI command HCI_ACCEPT_CONNECTION_REQUEST into packet
+ * @param packet buffer of at least 10 bytes
+ * @param bd_addr
+ * @param role
+ * @return size of command packet
+ * @note: btstack_type B1
+ */
+static inline uint16_t hci_cmd_encode_accept_connection_request(uint8_t * packet, const uint8_t * bd_addr, uint8_t role){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x09));
+    packet[2] = 7;
+    reverse_bd_addr(bd_addr, &packet[3]);
+    packet[9] = role;
+    return 10;
+}
+
+/**
+ * @brief Send HCI command HCI_ACCEPT_CONNECTION_REQUEST
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_accept_connection_request(const uint8_t * bd_addr, uint8_t role){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x09));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_accept_connection_request(packet, bd_addr, role));
+}
+
+/**
+ * @brief Store HCI command HCI_REJECT_CONNECTION_REQUEST into packet
+ * @param packet buffer of at least 10 bytes
+ * @param bd_addr
+ * @param reason
+ * @return size of command packet
+ * @note: btstack_type B1
+ */
+static inline uint16_t hci_cmd_encode_reject_connection_request(uint8_t * packet, const uint8_t * bd_addr, uint8_t reason){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x0a));
+    packet[2] = 7;
+    reverse_bd_addr(bd_addr, &packet[3]);
+    packet[9] = reason;
+    return 10;
+}
+
+/**
+ * @brief Send HCI command HCI_REJECT_CONNECTION_REQUEST
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_reject_connection_request(const uint8_t * bd_addr, uint8_t reason){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x0a));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_reject_connection_request(packet, bd_addr, reason));
+}
+
+/**
+ * @brief Store HCI command HCI_LINK_KEY_REQUEST_REPLY into packet
+ * @param packet buffer of at least 25 bytes
+ * @param bd_addr
+ * @param link_key
+ * @return size of command packet
+ * @note: btstack_type BP
+ */
+static inline uint16_t hci_cmd_encode_link_key_request_reply(uint8_t * packet, const uint8_t * bd_addr, const uint8_t * link_key){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x0b));
+    packet[2] = 22;
+    reverse_bd_addr(bd_addr, &packet[3]);
+    memcpy(&packet[9], link_key, 16);
+    return 25;
+}
+
+/**
+ * @brief Send HCI command HCI_LINK_KEY_REQUEST_REPLY
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_link_key_request_reply(const uint8_t * bd_addr, const uint8_t * link_key){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x0b));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_link_key_request_reply(packet, bd_addr, link_key));
+}
+
+/**
+ * @brief Store HCI command HCI_LINK_KEY_REQUEST_NEGATIVE_REPLY into packet
+ * @param packet buffer of at least 9 bytes
+ * @param bd_addr
+ * @return size of command packet
+ * @note: btstack_type B
+ */
+static inline uint16_t hci_cmd_encode_link_key_request_negative_reply(uint8_t * packet, const uint8_t * bd_addr){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x0c));
+    packet[2] = 6;
+    reverse_bd_addr(bd_addr, &packet[3]);
+    return 9;
+}
+
+/**
+ * @brief Send HCI command HCI_LINK_KEY_REQUEST_NEGATIVE_REPLY
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_link_key_request_negative_reply(const uint8_t * bd_addr){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x0c));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_link_key_request_negative_reply(packet, bd_addr));
+}
+
+/**
+ * @brief Store HCI command HCI_PIN_CODE_REQUEST_REPLY into packet
+ * @param packet buffer of at least 26 bytes
+ * @param bd_addr
+ * @param pin_length
+ * @param pin
+ * @return size of command packet
+ * @note: btstack_type B1P
+ */
+static inline uint16_t hci_cmd_encode_pin_code_request_reply(uint8_t * packet, const uint8_t * bd_addr, uint8_t pin_length, const uint8_t * pin){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x0d));
+    packet[2] = 23;
+    reverse_bd_addr(bd_addr, &packet[3]);
+    packet[9] = pin_length;
+    memcpy(&packet[10], pin, 16);
+    return 26;
+}
+
+/**
+ * @brief Send HCI command HCI_PIN_CODE_REQUEST_REPLY
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_pin_code_request_reply(const uint8_t * bd_addr, uint8_t pin_length, const uint8_t * pin){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x0d));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_pin_code_request_reply(packet, bd_addr, pin_length, pin));
+}
+
+/**
+ * @brief Store HCI command HCI_PIN_CODE_REQUEST_NEGATIVE_REPLY into packet
+ * @param packet buffer of at least 9 bytes
+ * @param bd_addr
+ * @return size of command packet
+ * @note: btstack_type B
+ */
+static inline uint16_t hci_cmd_encode_pin_code_request_negative_reply(uint8_t * packet, const uint8_t * bd_addr){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x0e));
+    packet[2] = 6;
+    reverse_bd_addr(bd_addr, &packet[3]);
+    return 9;
+}
+
+/**
+ * @brief Send HCI command HCI_PIN_CODE_REQUEST_NEGATIVE_REPLY
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_pin_code_request_negative_reply(const uint8_t * bd_addr){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x0e));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_pin_code_request_negative_reply(packet, bd_addr));
+}
+
+/**
+ * @brief Store HCI command HCI_CHANGE_CONNECTION_PACKET_TYPE into packet
+ * @param packet buffer of at least 7 bytes
+ * @param handle
+ * @param packet_type
+ * @return size of command packet
+ * @note: btstack_type H2
+ */
+static inline uint16_t hci_cmd_encode_change_connection_packet_type(uint8_t * packet, hci_con_handle_t handle, uint16_t packet_type){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x0f));
+    packet[2] = 4;
+    little_endian_store_16(packet, 3, handle);
+    little_endian_store_16(packet, 5, packet_type);
+    return 7;
+}
+
+/**
+ * @brief Send HCI command HCI_CHANGE_CONNECTION_PACKET_TYPE
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_change_connection_packet_type(hci_con_handle_t handle, uint16_t packet_type){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x0f));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_change_connection_packet_type(packet, handle, packet_type));
+}
+
+/**
+ * @brief Store HCI command HCI_AUTHENTICATION_REQUESTED into packet
+ * @param packet buffer of at least 5 bytes
+ * @param handle
+ * @return size of command packet
+ * @note: btstack_type H
+ */
+static inline uint16_t hci_cmd_encode_authentication_requested(uint8_t * packet, hci_con_handle_t handle){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x11));
+    packet[2] = 2;
+    little_endian_store_16(packet, 3, handle);
+    return 5;
+}
+
+/**
+ * @brief Send HCI command HCI_AUTHENTICATION_REQUESTED
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_authentication_requested(hci_con_handle_t handle){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x11));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_authentication_requested(packet, handle));
+}
+
+/**
+ * @brief Store HCI command HCI_SET_CONNECTION_ENCRYPTION into packet
+ * @param packet buffer of at least 6 bytes
+ * @param handle
+ * @param encryption_enable
+ * @return size of command packet
+ * @note: btstack_type H1
+ */
+static inline uint16_t hci_cmd_encode_set_connection_encryption(uint8_t * packet, hci_con_handle_t handle, uint8_t encryption_enable){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x13));
+    packet[2] = 3;
+    little_endian_store_16(packet, 3, handle);
+    packet[5] = encryption_enable;
+    return 6;
+}
+
+/**
+ * @brief Send HCI command HCI_SET_CONNECTION_ENCRYPTION
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_set_connection_encryption(hci_con_handle_t handle, uint8_t encryption_enable){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x13));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_set_connection_encryption(packet, handle, encryption_enable));
+}
+
+/**
+ * @brief Store HCI command HCI_CHANGE_CONNECTION_LINK_KEY into packet
+ * @param packet buffer of at least 5 bytes
+ * @param handle
+ * @return size of command packet
+ * @note: btstack_type H
+ */
+static inline uint16_t hci_cmd_encode_change_connection_link_key(uint8_t * packet, hci_con_handle_t handle){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x15));
+    packet[2] = 2;
+    little_endian_store_16(packet, 3, handle);
+    return 5;
+}
+
+/**
+ * @brief Send HCI command HCI_CHANGE_CONNECTION_LINK_KEY
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_change_connection_link_key(hci_con_handle_t handle){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x15));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_change_connection_link_key(packet, handle));
+}
+
+/**
+ * @brief Store HCI command HCI_REMOTE_NAME_REQUEST into packet
+ * @param packet buffer of at least 13 bytes
+ * @param bd_addr
+ * @param page_scan_repetition_mode
+ * @param reserved
+ * @param clock_offset
+ * @return size of command packet
+ * @note: btstack_type B112
+ */
+static inline uint16_t hci_cmd_encode_remote_name_request(uint8_t * packet, const uint8_t * bd_addr, uint8_t page_scan_repetition_mode, uint8_t reserved, uint16_t clock_offset){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x19));
+    packet[2] = 10;
+    reverse_bd_addr(bd_addr, &packet[3]);
+    packet[9] = page_scan_repetition_mode;
+    packet[10] = reserved;
+    little_endian_store_16(packet, 11, clock_offset);
+    return 13;
+}
+
+/**
+ * @brief Send HCI command HCI_REMOTE_NAME_REQUEST
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_remote_name_request(const uint8_t * bd_addr, uint8_t page_scan_repetition_mode, uint8_t reserved, uint16_t clock_offset){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x19));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_remote_name_request(packet, bd_addr, page_scan_repetition_mode, reserved, clock_offset));
+}
+
+/**
+ * @brief Store HCI command HCI_REMOTE_NAME_REQUEST_CANCEL into packet
+ * @param packet buffer of at least 9 bytes
+ * @param bd_addr
+ * @return size of command packet
+ * @note: btstack_type B
+ */
+static inline uint16_t hci_cmd_encode_remote_name_request_cancel(uint8_t * packet, const uint8_t * bd_addr){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x1A));
+    packet[2] = 6;
+    reverse_bd_addr(bd_addr, &packet[3]);
+    return 9;
+}
+
+/**
+ * @brief Send HCI command HCI_REMOTE_NAME_REQUEST_CANCEL
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_remote_name_request_cancel(const uint8_t * bd_addr){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x1A));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_remote_name_request_cancel(packet, bd_addr));
+}
+
+/**
+ * @brief Store HCI command HCI_READ_REMOTE_SUPPORTED_FEATURES_COMMAND into packet
+ * @param packet buffer of at least 5 bytes
+ * @param handle
+ * @return size of command packet
+ * @note: btstack_type H
+ */
+static inline uint16_t hci_cmd_encode_read_remote_supported_features_command(uint8_t * packet, hci_con_handle_t handle){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x1B));
+    packet[2] = 2;
+    little_endian_store_16(packet, 3, handle);
+    return 5;
+}
+
+/**
+ * @brief Send HCI command HCI_READ_REMOTE_SUPPORTED_FEATURES_COMMAND
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_read_remote_supported_features_command(hci_con_handle_t handle){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x1B));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_read_remote_supported_features_command(packet, handle));
+}
+
+/**
+ * @brief Store HCI command HCI_SETUP_SYNCHRONOUS_CONNECTION into packet
+ * @param packet buffer of at least 20 bytes
+ * @param handle
+ * @param transmit_bandwidth
+ * @param receive_bandwidth
+ * @param max_latency
+ * @param voice_settings
+ * @param retransmission_effort
+ * @param packet_type
+ * @return size of command packet
+ * @note: btstack_type H442212
+ */
+static inline uint16_t hci_cmd_encode_setup_synchronous_connection(uint8_t * packet, hci_con_handle_t handle, uint32_t transmit_bandwidth, uint32_t receive_bandwidth, uint16_t max_latency, uint16_t voice_settings, uint8_t retransmission_effort, uint16_t packet_type){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x0028));
+    packet[2] = 17;
+    little_endian_store_16(packet, 3, handle);
+    little_endian_store_32(packet, 5, transmit_bandwidth);
+    little_endian_store_32(packet, 9, receive_bandwidth);
+    little_endian_store_16(packet, 13, max_latency);
+    little_endian_store_16(packet, 15, voice_settings);
+    packet[17] = retransmission_effort;
+    little_endian_store_16(packet, 18, packet_type);
+    return 20;
+}
+
+/**
+ * @brief Send HCI command HCI_SETUP_SYNCHRONOUS_CONNECTION
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_setup_synchronous_connection(hci_con_handle_t handle, uint32_t transmit_bandwidth, uint32_t receive_bandwidth, uint16_t max_latency, uint16_t voice_settings, uint8_t retransmission_effort, uint16_t packet_type){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x0028));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_setup_synchronous_connection(packet, handle, transmit_bandwidth, receive_bandwidth, max_latency, voice_settings, retransmission_effort, packet_type));
+}
+
+/**
+ * @brief Store HCI command HCI_ACCEPT_SYNCHRONOUS_CONNECTION into packet
+ * @param packet buffer of at least 24 bytes
+ * @param bd_addr
+ * @param transmit_bandwidth
+ * @param receive_bandwidth
+ * @param max_latency
+ * @param voice_settings
+ * @param retransmission_effort
+ * @param packet_type
+ * @return size of command packet
+ * @note: btstack_type B442212
+ */
+static inline uint16_t hci_cmd_encode_accept_synchronous_connection(uint8_t * packet, const uint8_t * bd_addr, uint32_t transmit_bandwidth, uint32_t receive_bandwidth, uint16_t max_latency, uint16_t voice_settings, uint8_t retransmission_effort, uint16_t packet_type){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x0029));
+    packet[2] = 21;
+    reverse_bd_addr(bd_addr, &packet[3]);
+    little_endian_store_32(packet, 9, transmit_bandwidth);
+    little_endian_store_32(packet, 13, receive_bandwidth);
+    little_endian_store_16(packet, 17, max_latency);
+    little_endian_store_16(packet, 19, voice_settings);
+    packet[21] = retransmission_effort;
+    little_endian_store_16(packet, 22, packet_type);
+    return 24;
+}
+
+/**
+ * @brief Send HCI command HCI_ACCEPT_SYNCHRONOUS_CONNECTION
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_accept_synchronous_connection(const uint8_t * bd_addr, uint32_t transmit_bandwidth, uint32_t receive_bandwidth, uint16_t max_latency, uint16_t voice_settings, uint8_t retransmission_effort, uint16_t packet_type){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x0029));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_accept_synchronous_connection(packet, bd_addr, transmit_bandwidth, receive_bandwidth, max_latency, voice_settings, retransmission_effort, packet_type));
+}
+
+/**
+ * @brief Store HCI command HCI_IO_CAPABILITY_REQUEST_REPLY into packet
+ * @param packet buffer of at least 12 bytes
+ * @param bd_addr
+ * @param io_capability
+ * @param oob_data_present
+ * @param authentication_requirements
+ * @return size of command packet
+ * @note: btstack_type B111
+ */
+static inline uint16_t hci_cmd_encode_io_capability_request_reply(uint8_t * packet, const uint8_t * bd_addr, uint8_t io_capability, uint8_t oob_data_present, uint8_t authentication_requirements){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x2b));
+    packet[2] = 9;
+    reverse_bd_addr(bd_addr, &packet[3]);
+    packet[9] = io_capability;
+    packet[10] = oob_data_present;
+    packet[11] = authentication_requirements;
+    return 12;
+}
+
+/**
+ * @brief Send HCI command HCI_IO_CAPABILITY_REQUEST_REPLY
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_io_capability_request_reply(const uint8_t * bd_addr, uint8_t io_capability, uint8_t oob_data_present, uint8_t authentication_requirements){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x2b));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_io_capability_request_reply(packet, bd_addr, io_capability, oob_data_present, authentication_requirements));
+}
+
+/**
+ * @brief Store HCI command HCI_USER_CONFIRMATION_REQUEST_REPLY into packet
+ * @param packet buffer of at least 9 bytes
+ * @param bd_addr
+ * @return size of command packet
+ * @note: btstack_type B
+ */
+static inline uint16_t hci_cmd_encode_user_confirmation_request_reply(uint8_t * packet, const uint8_t * bd_addr){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x2c));
+    packet[2] = 6;
+    reverse_bd_addr(bd_addr, &packet[3]);
+    return 9;
+}
+
+/**
+ * @brief Send HCI command HCI_USER_CONFIRMATION_REQUEST_REPLY
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_user_confirmation_request_reply(const uint8_t * bd_addr){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x2c));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_user_confirmation_request_reply(packet, bd_addr));
+}
+
+/**
+ * @brief Store HCI command HCI_USER_CONFIRMATION_REQUEST_NEGATIVE_REPLY into packet
+ * @param packet buffer of at least 9 bytes
+ * @param bd_addr
+ * @return size of command packet
+ * @note: btstack_type B
+ */
+static inline uint16_t hci_cmd_encode_user_confirmation_request_negative_reply(uint8_t * packet, const uint8_t * bd_addr){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x2d));
+    packet[2] = 6;
+    reverse_bd_addr(bd_addr, &packet[3]);
+    return 9;
+}
+
+/**
+ * @brief Send HCI command HCI_USER_CONFIRMATION_REQUEST_NEGATIVE_REPLY
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_user_confirmation_request_negative_reply(const uint8_t * bd_addr){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x2d));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_user_confirmation_request_negative_reply(packet, bd_addr));
+}
+
+/**
+ * @brief Store HCI command HCI_USER_PASSKEY_REQUEST_REPLY into packet
+ * @param packet buffer of at least 13 bytes
+ * @param bd_addr
+ * @param numeric_value
+ * @return size of command packet
+ * @note: btstack_type B4
+ */
+static inline uint16_t hci_cmd_encode_user_passkey_request_reply(uint8_t * packet, const uint8_t * bd_addr, uint32_t numeric_value){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x2e));
+    packet[2] = 10;
+    reverse_bd_addr(bd_addr, &packet[3]);
+    little_endian_store_32(packet, 9, numeric_value);
+    return 13;
+}
+
+/**
+ * @brief Send HCI command HCI_USER_PASSKEY_REQUEST_REPLY
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_user_passkey_request_reply(const uint8_t * bd_addr, uint32_t numeric_value){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x2e));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_user_passkey_request_reply(packet, bd_addr, numeric_value));
+}
+
+/**
+ * @brief Store HCI command HCI_USER_PASSKEY_REQUEST_NEGATIVE_REPLY into packet
+ * @param packet buffer of at least 9 bytes
+ * @param bd_addr
+ * @return size of command packet
+ * @note: btstack_type B
+ */
+static inline uint16_t hci_cmd_encode_user_passkey_request_negative_reply(uint8_t * packet, const uint8_t * bd_addr){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x2f));
+    packet[2] = 6;
+    reverse_bd_addr(bd_addr, &packet[3]);
+    return 9;
+}
+
+/**
+ * @brief Send HCI command HCI_USER_PASSKEY_REQUEST_NEGATIVE_REPLY
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_user_passkey_request_negative_reply(const uint8_t * bd_addr){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x2f));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_user_passkey_request_negative_reply(packet, bd_addr));
+}
+
+/**
+ * @brief Store HCI command HCI_REMOTE_OOB_DATA_REQUEST_REPLY into packet
+ * @param packet buffer of at least 41 bytes
+ * @param bd_addr
+ * @param c
+ * @param r
+ * @return size of command packet
+ * @note: btstack_type BPP
+ */
+static inline uint16_t hci_cmd_encode_remote_oob_data_request_reply(uint8_t * packet, const uint8_t * bd_addr, const uint8_t * c, const uint8_t * r){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x30));
+    packet[2] = 38;
+    reverse_bd_addr(bd_addr, &packet[3]);
+    memcpy(&packet[9], c, 16);
+    memcpy(&packet[25], r, 16);
+    return 41;
+}
+
+/**
+ * @brief Send HCI command HCI_REMOTE_OOB_DATA_REQUEST_REPLY
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_remote_oob_data_request_reply(const uint8_t * bd_addr, const uint8_t * c, const uint8_t * r){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x30));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_remote_oob_data_request_reply(packet, bd_addr, c, r));
+}
+
+/**
+ * @brief Store HCI command HCI_REMOTE_OOB_DATA_REQUEST_NEGATIVE_REPLY into packet
+ * @param packet buffer of at least 9 bytes
+ * @param bd_addr
+ * @return size of command packet
+ * @note: btstack_type B
+ */
+static inline uint16_t hci_cmd_encode_remote_oob_data_request_negative_reply(uint8_t * packet, const uint8_t * bd_addr){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x33));
+    packet[2] = 6;
+    reverse_bd_addr(bd_addr, &packet[3]);
+    return 9;
+}
+
+/**
+ * @brief Send HCI command HCI_REMOTE_OOB_DATA_REQUEST_NEGATIVE_REPLY
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_remote_oob_data_request_negative_reply(const uint8_t * bd_addr){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x33));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_remote_oob_data_request_negative_reply(packet, bd_addr));
+}
+
+/**
+ * @brief Store HCI command HCI_IO_CAPABILITY_REQUEST_NEGATIVE_REPLY into packet
+ * @param packet buffer of at least 10 bytes
+ * @param bd_addr
+ * @param reason
+ * @return size of command packet
+ * @note: btstack_type B1
+ */
+static inline uint16_t hci_cmd_encode_io_capability_request_negative_reply(uint8_t * packet, const uint8_t * bd_addr, uint8_t reason){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x34));
+    packet[2] = 7;
+    reverse_bd_addr(bd_addr, &packet[3]);
+    packet[9] = reason;
+    return 10;
+}
+
+/**
+ * @brief Send HCI command HCI_IO_CAPABILITY_REQUEST_NEGATIVE_REPLY
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_io_capability_request_negative_reply(const uint8_t * bd_addr, uint8_t reason){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x34));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_io_capability_request_negative_reply(packet, bd_addr, reason));
+}
+
+/**
+ * @brief Store HCI command HCI_ENHANCED_SETUP_SYNCHRONOUS_CONNECTION into packet
+ * @param packet buffer of at least 62 bytes
+ * @param handle
+ * @param transmit_bandwidth
+ * @param receive_bandwidth
+ * @param transmit_coding_format_type
+ * @param transmit_coding_format_company
+ * @param transmit_coding_format_codec
+ * @param receive_coding_format_type
+ * @param receive_coding_format_company
+ * @param receive_coding_format_codec
+ * @param transmit_coding_frame_size
+ * @param receive_coding_frame_size
+ * @param input_bandwidth
+ * @param output_bandwidth
+ * @param input_coding_format_type
+ * @param input_coding_format_company
+ * @param input_coding_format_codec
+ * @param output_coding_format_type
+ * @param output_coding_format_company
+ * @param output_coding_format_codec
+ * @param input_coded_data_size
+ * @param outupt_coded_data_size
+ * @param input_pcm_data_format
+ * @param output_pcm_data_format
+ * @param input_pcm_sample_payload_msb_position
+ * @param output_pcm_sample_payload_msb_position
+ * @param input_data_path
+ * @param output_data_path
+ * @param input_transport_unit_size
+ * @param output_transport_unit_size
+ * @param max_latency
+ * @param packet_type
+ * @param retransmission_effort
+ * @return size of command packet
+ * @note: btstack_type H4412212222441221222211111111221
+ */
+static inline uint16_t hci_cmd_encode_enhanced_setup_synchronous_connection(uint8_t * packet, hci_con_handle_t handle, uint32_t transmit_bandwidth, uint32_t receive_bandwidth, uint8_t transmit_coding_format_type, uint16_t transmit_coding_format_company, uint16_t transmit_coding_format_codec, uint8_t receive_coding_format_type, uint16_t receive_coding_format_company, uint16_t receive_coding_format_codec, uint16_t transmit_coding_frame_size, uint16_t receive_coding_frame_size, uint32_t input_bandwidth, uint32_t output_bandwidth, uint8_t input_coding_format_type, uint16_t input_coding_format_company, uint16_t input_coding_format_codec, uint8_t output_coding_format_type, uint16_t output_coding_format_company, uint16_t output_coding_format_codec, uint16_t input_coded_data_size, uint16_t outupt_coded_data_size, uint8_t input_pcm_data_format, uint8_t output_pcm_data_format, uint8_t input_pcm_sample_payload_msb_position, uint8_t output_pcm_sample_payload_msb_position, uint8_t input_data_path, uint8_t output_data_path, uint8_t input_transport_unit_size, uint8_t output_transport_unit_size, uint16_t max_latency, uint16_t packet_type, uint8_t retransmission_effort){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x3d));
+    packet[2] = 59;
+    little_endian_store_16(packet, 3, handle);
+    little_endian_store_32(packet, 5, transmit_bandwidth);
+    little_endian_store_32(packet, 9, receive_bandwidth);
+    packet[13] = transmit_coding_format_type;
+    little_endian_store_16(packet, 14, transmit_coding_format_company);
+    little_endian_store_16(packet, 16, transmit_coding_format_codec);
+    packet[18] = receive_coding_format_type;
+    little_endian_store_16(packet, 19, receive_coding_format_company);
+    little_endian_store_16(packet, 21, receive_coding_format_codec);
+    little_endian_store_16(packet, 23, transmit_coding_frame_size);
+    little_endian_store_16(packet, 25, receive_coding_frame_size);
+    little_endian_store_32(packet, 27, input_bandwidth);
+    little_endian_store_32(packet, 31, output_bandwidth);
+    packet[35] = input_coding_format_type;
+    little_endian_store_16(packet, 36, input_coding_format_company);
+    little_endian_store_16(packet, 38, input_coding_format_codec);
+    packet[40] = output_coding_format_type;
+    little_endian_store_16(packet, 41, output_coding_format_company);
+    little_endian_store_16(packet, 43, output_coding_format_codec);
+    little_endian_store_16(packet, 45, input_coded_data_size);
+    little_endian_store_16(packet, 47, outupt_coded_data_size);
+    packet[49] = input_pcm_data_format;
+    packet[50] = output_pcm_data_format;
+    packet[51] = input_pcm_sample_payload_msb_position;
+    packet[52] = output_pcm_sample_payload_msb_position;
+    packet[53] = input_data_path;
+    packet[54] = output_data_path;
+    packet[55] = input_transport_unit_size;
+    packet[56] = output_transport_unit_size;
+    little_endian_store_16(packet, 57, max_latency);
+    little_endian_store_16(packet, 59, packet_type);
+    packet[61] = retransmission_effort;
+    return 62;
+}
+
+/**
+ * @brief Send HCI command HCI_ENHANCED_SETUP_SYNCHRONOUS_CONNECTION
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_enhanced_setup_synchronous_connection(hci_con_handle_t handle, uint32_t transmit_bandwidth, uint32_t receive_bandwidth, uint8_t transmit_coding_format_type, uint16_t transmit_coding_format_company, uint16_t transmit_coding_format_codec, uint8_t receive_coding_format_type, uint16_t receive_coding_format_company, uint16_t receive_coding_format_codec, uint16_t transmit_coding_frame_size, uint16_t receive_coding_frame_size, uint32_t input_bandwidth, uint32_t output_bandwidth, uint8_t input_coding_format_type, uint16_t input_coding_format_company, uint16_t input_coding_format_codec, uint8_t output_coding_format_type, uint16_t output_coding_format_company, uint16_t output_coding_format_codec, uint16_t input_coded_data_size, uint16_t outupt_coded_data_size, uint8_t input_pcm_data_format, uint8_t output_pcm_data_format, uint8_t input_pcm_sample_payload_msb_position, uint8_t output_pcm_sample_payload_msb_position, uint8_t input_data_path, uint8_t output_data_path, uint8_t input_transport_unit_size, uint8_t output_transport_unit_size, uint16_t max_latency, uint16_t packet_type, uint8_t retransmission_effort){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x3d));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_enhanced_setup_synchronous_connection(packet, handle, transmit_bandwidth, receive_bandwidth, transmit_coding_format_type, transmit_coding_format_company, transmit_coding_format_codec, receive_coding_format_type, receive_coding_format_company, receive_coding_format_codec, transmit_coding_frame_size, receive_coding_frame_size, input_bandwidth, output_bandwidth, input_coding_format_type, input_coding_format_company, input_coding_format_codec, output_coding_format_type, output_coding_format_company, output_coding_format_codec, input_coded_data_size, outupt_coded_data_size, input_pcm_data_format, output_pcm_data_format, input_pcm_sample_payload_msb_position, output_pcm_sample_payload_msb_position, input_data_path, output_data_path, input_transport_unit_size, output_transport_unit_size, max_latency, packet_type, retransmission_effort));
+}
+
+/**
+ * @brief Store HCI command HCI_ENHANCED_ACCEPT_SYNCHRONOUS_CONNECTION into packet
+ * @param packet buffer of at least 66 bytes
+ * @param bd_addr
+ * @param transmit_bandwidth
+ * @param receive_bandwidth
+ * @param transmit_coding_format_type
+ * @param transmit_coding_format_company
+ * @param transmit_coding_format_codec
+ * @param receive_coding_format_type
+ * @param receive_coding_format_company
+ * @param receive_coding_format_codec
+ * @param transmit_coding_frame_size
+ * @param receive_coding_frame_size
+ * @param input_bandwidth
+ * @param output_bandwidth
+ * @param input_coding_format_type
+ * @param input_coding_format_company
+ * @param input_coding_format_codec
+ * @param output_coding_format_type
+ * @param output_coding_format_company
+ * @param output_coding_format_codec
+ * @param input_coded_data_size
+ * @param outupt_coded_data_size
+ * @param input_pcm_data_format
+ * @param output_pcm_data_format
+ * @param input_pcm_sample_payload_msb_position
+ * @param output_pcm_sample_payload_msb_position
+ * @param input_data_path
+ * @param output_data_path
+ * @param input_transport_unit_size
+ * @param output_transport_unit_size
+ * @param max_latency
+ * @param packet_type
+ * @param retransmission_effort
+ * @return size of command packet
+ * @note: btstack_type B4412212222441221222211111111221
+ */
+static inline uint16_t hci_cmd_encode_enhanced_accept_synchronous_connection(uint8_t * packet, const uint8_t * bd_addr, uint32_t transmit_bandwidth, uint32_t receive_bandwidth, uint8_t transmit_coding_format_type, uint16_t transmit_coding_format_company, uint16_t transmit_coding_format_codec, uint8_t receive_coding_format_type, uint16_t receive_coding_format_company, uint16_t receive_coding_format_codec, uint16_t transmit_coding_frame_size, uint16_t receive_coding_frame_size, uint32_t input_bandwidth, uint32_t output_bandwidth, uint8_t input_coding_format_type, uint16_t input_coding_format_company, uint16_t input_coding_format_codec, uint8_t output_coding_format_type, uint16_t output_coding_format_company, uint16_t output_coding_format_codec, uint16_t input_coded_data_size, uint16_t outupt_coded_data_size, uint8_t input_pcm_data_format, uint8_t output_pcm_data_format, uint8_t input_pcm_sample_payload_msb_position, uint8_t output_pcm_sample_payload_msb_position, uint8_t input_data_path, uint8_t output_data_path, uint8_t input_transport_unit_size, uint8_t output_transport_unit_size, uint16_t max_latency, uint16_t packet_type, uint8_t retransmission_effort){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x3e));
+    packet[2] = 63;
+    reverse_bd_addr(bd_addr, &packet[3]);
+    little_endian_store_32(packet, 9, transmit_bandwidth);
+    little_endian_store_32(packet, 13, receive_bandwidth);
+    packet[17] = transmit_coding_format_type;
+    little_endian_store_16(packet, 18, transmit_coding_format_company);
+    little_endian_store_16(packet, 20, transmit_coding_format_codec);
+    packet[22] = receive_coding_format_type;
+    little_endian_store_16(packet, 23, receive_coding_format_company);
+    little_endian_store_16(packet, 25, receive_coding_format_codec);
+    little_endian_store_16(packet, 27, transmit_coding_frame_size);
+    little_endian_store_16(packet, 29, receive_coding_frame_size);
+    little_endian_store_32(packet, 31, input_bandwidth);
+    little_endian_store_32(packet, 35, output_bandwidth);
+    packet[39] = input_coding_format_type;
+    little_endian_store_16(packet, 40, input_coding_format_company);
+    little_endian_store_16(packet, 42, input_coding_format_codec);
+    packet[44] = output_coding_format_type;
+    little_endian_store_16(packet, 45, output_coding_format_company);
+    little_endian_store_16(packet, 47, output_coding_format_codec);
+    little_endian_store_16(packet, 49, input_coded_data_size);
+    little_endian_store_16(packet, 51, outupt_coded_data_size);
+    packet[53] = input_pcm_data_format;
+    packet[54] = output_pcm_data_format;
+    packet[55] = input_pcm_sample_payload_msb_position;
+    packet[56] = output_pcm_sample_payload_msb_position;
+    packet[57] = input_data_path;
+    packet[58] = output_data_path;
+    packet[59] = input_transport_unit_size;
+    packet[60] = output_transport_unit_size;
+    little_endian_store_16(packet, 61, max_latency);
+    little_endian_store_16(packet, 63, packet_type);
+    packet[65] = retransmission_effort;
+    return 66;
+}
+
+/**
+ * @brief Send HCI command HCI_ENHANCED_ACCEPT_SYNCHRONOUS_CONNECTION
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_enhanced_accept_synchronous_connection(const uint8_t * bd_addr, uint32_t transmit_bandwidth, uint32_t receive_bandwidth, uint8_t transmit_coding_format_type, uint16_t transmit_coding_format_company, uint16_t transmit_coding_format_codec, uint8_t receive_coding_format_type, uint16_t receive_coding_format_company, uint16_t receive_coding_format_codec, uint16_t transmit_coding_frame_size, uint16_t receive_coding_frame_size, uint32_t input_bandwidth, uint32_t output_bandwidth, uint8_t input_coding_format_type, uint16_t input_coding_format_company, uint16_t input_coding_format_codec, uint8_t output_coding_format_type, uint16_t output_coding_format_company, uint16_t output_coding_format_codec, uint16_t input_coded_data_size, uint16_t outupt_coded_data_size, uint8_t input_pcm_data_format, uint8_t output_pcm_data_format, uint8_t input_pcm_sample_payload_msb_position, uint8_t output_pcm_sample_payload_msb_position, uint8_t input_data_path, uint8_t output_data_path, uint8_t input_transport_unit_size, uint8_t output_transport_unit_size, uint16_t max_latency, uint16_t packet_type, uint8_t retransmission_effort){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x3e));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_enhanced_accept_synchronous_connection(packet, bd_addr, transmit_bandwidth, receive_bandwidth, transmit_coding_format_type, transmit_coding_format_company, transmit_coding_format_codec, receive_coding_format_type, receive_coding_format_company, receive_coding_format_codec, transmit_coding_frame_size, receive_coding_frame_size, input_bandwidth, output_bandwidth, input_coding_format_type, input_coding_format_company, input_coding_format_codec, output_coding_format_type, output_coding_format_company, output_coding_format_codec, input_coded_data_size, outupt_coded_data_size, input_pcm_data_format, output_pcm_data_format, input_pcm_sample_payload_msb_position, output_pcm_sample_payload_msb_position, input_data_path, output_data_path, input_transport_unit_size, output_transport_unit_size, max_latency, packet_type, retransmission_effort));
+}
+
+/**
+ * @brief Store HCI command HCI_SNIFF_MODE into packet
+ * @param packet buffer of at least 13 bytes
+ * @param handle
+ * @param sniff_max_interval
+ * @param sniff_min_interval
+ * @param sniff_attempt
+ * @param sniff_timeout
+ * @return size of command packet
+ * @note: btstack_type H2222
+ */
+static inline uint16_t hci_cmd_encode_sniff_mode(uint8_t * packet, hci_con_handle_t handle, uint16_t sniff_max_interval, uint16_t sniff_min_interval, uint16_t sniff_attempt, uint16_t sniff_timeout){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LINK_POLICY, 0x03));
+    packet[2] = 10;
+    little_endian_store_16(packet, 3, handle);
+    little_endian_store_16(packet, 5, sniff_max_interval);
+    little_endian_store_16(packet, 7, sniff_min_interval);
+    little_endian_store_16(packet, 9, sniff_attempt);
+    little_endian_store_16(packet, 11, sniff_timeout);
+    return 13;
+}
+
+/**
+ * @brief Send HCI command HCI_SNIFF_MODE
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_sniff_mode(hci_con_handle_t handle, uint16_t sniff_max_interval, uint16_t sniff_min_interval, uint16_t sniff_attempt, uint16_t sniff_timeout){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LINK_POLICY, 0x03));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_sniff_mode(packet, handle, sniff_max_interval, sniff_min_interval, sniff_attempt, sniff_timeout));
+}
+
+/**
+ * @brief Store HCI command HCI_QOS_SETUP into packet
+ * @param packet buffer of at least 23 bytes
+ * @param handle
+ * @param flags
+ * @param service_type
+ * @param token_rate
+ * @param peak_bandwith
+ * @param latency
+ * @param delay_variation
+ * @return size of command packet
+ * @note: btstack_type H114444
+ */
+static inline uint16_t hci_cmd_encode_qos_setup(uint8_t * packet, hci_con_handle_t handle, uint8_t flags, uint8_t service_type, uint32_t token_rate, uint32_t peak_bandwith, uint32_t latency, uint32_t delay_variation){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LINK_POLICY, 0x07));
+    packet[2] = 20;
+    little_endian_store_16(packet, 3, handle);
+    packet[5] = flags;
+    packet[6] = service_type;
+    little_endian_store_32(packet, 7, token_rate);
+    little_endian_store_32(packet, 11, peak_bandwith);
+    little_endian_store_32(packet, 15, latency);
+    little_endian_store_32(packet, 19, delay_variation);
+    return 23;
+}
+
+/**
+ * @brief Send HCI command HCI_QOS_SETUP
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_qos_setup(hci_con_handle_t handle, uint8_t flags, uint8_t service_type, uint32_t token_rate, uint32_t peak_bandwith, uint32_t latency, uint32_t delay_variation){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LINK_POLICY, 0x07));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_qos_setup(packet, handle, flags, service_type, token_rate, peak_bandwith, latency, delay_variation));
+}
+
+/**
+ * @brief Store HCI command HCI_ROLE_DISCOVERY into packet
+ * @param packet buffer of at least 5 bytes
+ * @param handle
+ * @return size of command packet
+ * @note: btstack_type H
+ */
+static inline uint16_t hci_cmd_encode_role_discovery(uint8_t * packet, hci_con_handle_t handle){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LINK_POLICY, 0x09));
+    packet[2] = 2;
+    little_endian_store_16(packet, 3, handle);
+    return 5;
+}
+
+/**
+ * @brief Send HCI command HCI_ROLE_DISCOVERY
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_role_discovery(hci_con_handle_t handle){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LINK_POLICY, 0x09));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_role_discovery(packet, handle));
+}
+
+/**
+ * @brief Store HCI command HCI_SWITCH_ROLE_COMMAND into packet
+ * @param packet buffer of at least 10 bytes
+ * @param bd_addr
+ * @param role
+ * @return size of command packet
+ * @note: btstack_type B1
+ */
+static inline uint16_t hci_cmd_encode_switch_role_command(uint8_t * packet, const uint8_t * bd_addr, uint8_t role){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LINK_POLICY, 0x0b));
+    packet[2] = 7;
+    reverse_bd_addr(bd_addr, &packet[3]);
+    packet[9] = role;
+    return 10;
+}
+
+/**
+ * @brief Send HCI command HCI_SWITCH_ROLE_COMMAND
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_switch_role_command(const uint8_t * bd_addr, uint8_t role){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LINK_POLICY, 0x0b));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_switch_role_command(packet, bd_addr, role));
+}
+
+/**
+ * @brief Store HCI command HCI_READ_LINK_POLICY_SETTINGS into packet
+ * @param packet buffer of at least 5 bytes
+ * @param handle
+ * @return size of command packet
+ * @note: btstack_type H
+ */
+static inline uint16_t hci_cmd_encode_read_link_policy_settings(uint8_t * packet, hci_con_handle_t handle){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LINK_POLICY, 0x0c));
+    packet[2] = 2;
+    little_endian_store_16(packet, 3, handle);
+    return 5;
+}
+
+/**
+ * @brief Send HCI command HCI_READ_LINK_POLICY_SETTINGS
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_read_link_policy_settings(hci_con_handle_t handle){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LINK_POLICY, 0x0c));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_read_link_policy_settings(packet, handle));
+}
+
+/**
+ * @brief Store HCI command HCI_WRITE_LINK_POLICY_SETTINGS into packet
+ * @param packet buffer of at least 7 bytes
+ * @param handle
+ * @param settings
+ * @return size of command packet
+ * @note: btstack_type H2
+ */
+static inline uint16_t hci_cmd_encode_write_link_policy_settings(uint8_t * packet, hci_con_handle_t handle, uint16_t settings){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LINK_POLICY, 0x0d));
+    packet[2] = 4;
+    little_endian_store_16(packet, 3, handle);
+    little_endian_store_16(packet, 5, settings);
+    return 7;
+}
+
+/**
+ * @brief Send HCI command HCI_WRITE_LINK_POLICY_SETTINGS
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_write_link_policy_settings(hci_con_handle_t handle, uint16_t settings){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LINK_POLICY, 0x0d));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_write_link_policy_settings(packet, handle, settings));
+}
+
+/**
+ * @brief Store HCI command HCI_SET_EVENT_MASK into packet
+ * @param packet buffer of at least 11 bytes
+ * @param event_mask_lover_octets
+ * @param event_mask_higher_octets
+ * @return size of command packet
+ * @note: btstack_type 44
+ */
+static inline uint16_t hci_cmd_encode_set_event_mask(uint8_t * packet, uint32_t event_mask_lover_octets, uint32_t event_mask_higher_octets){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x01));
+    packet[2] = 8;
+    little_endian_store_32(packet, 3, event_mask_lover_octets);
+    little_endian_store_32(packet, 7, event_mask_higher_octets);
+    return 11;
+}
+
+/**
+ * @brief Send HCI command HCI_SET_EVENT_MASK
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_set_event_mask(uint32_t event_mask_lover_octets, uint32_t event_mask_higher_octets){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x01));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_set_event_mask(packet, event_mask_lover_octets, event_mask_higher_octets));
+}
+
+/**
+ * @brief Store HCI command HCI_RESET into packet
+ * @param packet buffer of at least 3 bytes
+ * @return size of command packet
+ * @note: btstack_type 
+ */
+static inline uint16_t hci_cmd_encode_reset(uint8_t * packet){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x03));
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send HCI command HCI_RESET
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_reset(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x03));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_reset(packet));
+}
+
+/**
+ * @brief Store HCI command HCI_FLUSH into packet
+ * @param packet buffer of at least 5 bytes
+ * @param handle
+ * @return size of command packet
+ * @note: btstack_type H
+ */
+static inline uint16_t hci_cmd_encode_flush(uint8_t * packet, hci_con_handle_t handle){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x09));
+    packet[2] = 2;
+    little_endian_store_16(packet, 3, handle);
+    return 5;
+}
+
+/**
+ * @brief Send HCI command HCI_FLUSH
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_flush(hci_con_handle_t handle){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x09));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_flush(packet, handle));
+}
+
+/**
+ * @brief Store HCI command HCI_DELETE_STORED_LINK_KEY into packet
+ * @param packet buffer of at least 10 bytes
+ * @param bd_addr
+ * @param delete_all_flags
+ * @return size of command packet
+ * @note: btstack_type B1
+ */
+static inline uint16_t hci_cmd_encode_delete_stored_link_key(uint8_t * packet, const uint8_t * bd_addr, uint8_t delete_all_flags){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x12));
+    packet[2] = 7;
+    reverse_bd_addr(bd_addr, &packet[3]);
+    packet[9] = delete_all_flags;
+    return 10;
+}
+
+/**
+ * @brief Send HCI command HCI_DELETE_STORED_LINK_KEY
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_delete_stored_link_key(const uint8_t * bd_addr, uint8_t delete_all_flags){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x12));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_delete_stored_link_key(packet, bd_addr, delete_all_flags));
+}
+
+/**
+ * @brief Store HCI command HCI_WRITE_LOCAL_NAME into packet
+ * @param packet buffer of at least 251 bytes
+ * @param local_name
+ * @return size of command packet
+ * @note: btstack_type N
+ */
+static inline uint16_t hci_cmd_encode_write_local_name(uint8_t * packet, const char * local_name){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x13));
+    packet[2] = 248;
+    strncpy((char *) &packet[3], local_name, 248);
+    return 251;
+}
+
+/**
+ * @brief Send HCI command HCI_WRITE_LOCAL_NAME
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_write_local_name(const char * local_name){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x13));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_write_local_name(packet, local_name));
+}
+
+/**
+ * @brief Store HCI command HCI_READ_LOCAL_NAME into packet
+ * @param packet buffer of at least 3 bytes
+ * @return size of command packet
+ * @note: btstack_type 
+ */
+static inline uint16_t hci_cmd_encode_read_local_name(uint8_t * packet){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x14));
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send HCI command HCI_READ_LOCAL_NAME
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_read_local_name(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x14));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_read_local_name(packet));
+}
+
+/**
+ * @brief Store HCI command HCI_WRITE_PAGE_TIMEOUT into packet
+ * @param packet buffer of at least 5 bytes
+ * @param page_timeout
+ * @return size of command packet
+ * @note: btstack_type 2
+ */
+static inline uint16_t hci_cmd_encode_write_page_timeout(uint8_t * packet, uint16_t page_timeout){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x18));
+    packet[2] = 2;
+    little_endian_store_16(packet, 3, page_timeout);
+    return 5;
+}
+
+/**
+ * @brief Send HCI command HCI_WRITE_PAGE_TIMEOUT
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_write_page_timeout(uint16_t page_timeout){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x18));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_write_page_timeout(packet, page_timeout));
+}
+
+/**
+ * @brief Store HCI command HCI_WRITE_SCAN_ENABLE into packet
+ * @param packet buffer of at least 4 bytes
+ * @param scan_enable
+ * @return size of command packet
+ * @note: btstack_type 1
+ */
+static inline uint16_t hci_cmd_encode_write_scan_enable(uint8_t * packet, uint8_t scan_enable){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x1A));
+    packet[2] = 1;
+    packet[3] = scan_enable;
+    return 4;
+}
+
+/**
+ * @brief Send HCI command HCI_WRITE_SCAN_ENABLE
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_write_scan_enable(uint8_t scan_enable){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x1A));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_write_scan_enable(packet, scan_enable));
+}
+
+/**
+ * @brief Store HCI command HCI_WRITE_AUTHENTICATION_ENABLE into packet
+ * @param packet buffer of at least 4 bytes
+ * @param authentication_enable
+ * @return size of command packet
+ * @note: btstack_type 1
+ */
+static inline uint16_t hci_cmd_encode_write_authentication_enable(uint8_t * packet, uint8_t authentication_enable){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x20));
+    packet[2] = 1;
+    packet[3] = authentication_enable;
+    return 4;
+}
+
+/**
+ * @brief Send HCI command HCI_WRITE_AUTHENTICATION_ENABLE
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_write_authentication_enable(uint8_t authentication_enable){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x20));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_write_authentication_enable(packet, authentication_enable));
+}
+
+/**
+ * @brief Store HCI command HCI_WRITE_CLASS_OF_DEVICE into packet
+ * @param packet buffer of at least 6 bytes
+ * @param class_of_device
+ * @return size of command packet
+ * @note: btstack_type 3
+ */
+static inline uint16_t hci_cmd_encode_write_class_of_device(uint8_t * packet, uint32_t class_of_device){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x24));
+    packet[2] = 3;
+    little_endian_store_16(packet, 3, class_of_device);
+    packet[3+2] = class_of_device >> 16;
+    return 6;
+}
+
+/**
+ * @brief Send HCI command HCI_WRITE_CLASS_OF_DEVICE
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_write_class_of_device(uint32_t class_of_device){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x24));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_write_class_of_device(packet, class_of_device));
+}
+
+/**
+ * @brief Store HCI command HCI_READ_NUM_BROADCAST_RETRANSMISSIONS into packet
+ * @param packet buffer of at least 3 bytes
+ * @return size of command packet
+ * @note: btstack_type 
+ */
+static inline uint16_t hci_cmd_encode_read_num_broadcast_retransmissions(uint8_t * packet){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x29));
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send HCI command HCI_READ_NUM_BROADCAST_RETRANSMISSIONS
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_read_num_broadcast_retransmissions(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x29));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_read_num_broadcast_retransmissions(packet));
+}
+
+/**
+ * @brief Store HCI command HCI_WRITE_NUM_BROADCAST_RETRANSMISSIONS into packet
+ * @param packet buffer of at least 4 bytes
+ * @param num_broadcast_retransmissions
+ * @return size of command packet
+ * @note: btstack_type 1
+ */
+static inline uint16_t hci_cmd_encode_write_num_broadcast_retransmissions(uint8_t * packet, uint8_t num_broadcast_retransmissions){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x2a));
+    packet[2] = 1;
+    packet[3] = num_broadcast_retransmissions;
+    return 4;
+}
+
+/**
+ * @brief Send HCI command HCI_WRITE_NUM_BROADCAST_RETRANSMISSIONS
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_write_num_broadcast_retransmissions(uint8_t num_broadcast_retransmissions){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x2a));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_write_num_broadcast_retransmissions(packet, num_broadcast_retransmissions));
+}
+
+/**
+ * @brief Store HCI command HCI_WRITE_SYNCHRONOUS_FLOW_CONTROL_ENABLE into packet
+ * @param packet buffer of at least 4 bytes
+ * @param synchronous_flow_control_enable
+ * @return size of command packet
+ * @note: btstack_type 1
+ */
+static inline uint16_t hci_cmd_encode_write_synchronous_flow_control_enable(uint8_t * packet, uint8_t synchronous_flow_control_enable){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x2f));
+    packet[2] = 1;
+    packet[3] = synchronous_flow_control_enable;
+    return 4;
+}
+
+/**
+ * @brief Send HCI command HCI_WRITE_SYNCHRONOUS_FLOW_CONTROL_ENABLE
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_write_synchronous_flow_control_enable(uint8_t synchronous_flow_control_enable){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x2f));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_write_synchronous_flow_control_enable(packet, synchronous_flow_control_enable));
+}
+
+/**
+ * @brief Store HCI command HCI_SET_CONTROLLER_TO_HOST_FLOW_CONTROL into packet
+ * @param packet buffer of at least 4 bytes
+ * @param flow_control_enable
+ * @return size of command packet
+ * @note: btstack_type 1
+ */
+static inline uint16_t hci_cmd_encode_set_controller_to_host_flow_control(uint8_t * packet, uint8_t flow_control_enable){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x31));
+    packet[2] = 1;
+    packet[3] = flow_control_enable;
+    return 4;
+}
+
+/**
+ * @brief Send HCI command HCI_SET_CONTROLLER_TO_HOST_FLOW_CONTROL
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_set_controller_to_host_flow_control(uint8_t flow_control_enable){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x31));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_set_controller_to_host_flow_control(packet, flow_control_enable));
+}
+
+/**
+ * @brief Store HCI command HCI_HOST_BUFFER_SIZE into packet
+ * @param packet buffer of at least 10 bytes
+ * @param host_acl_data_packet_length
+ * @param host_synchronous_data_packet_length
+ * @param host_total_num_acl_data_packets
+ * @param host_total_num_synchronous_data_packets
+ * @return size of command packet
+ * @note: btstack_type 2122
+ */
+static inline uint16_t hci_cmd_encode_host_buffer_size(uint8_t * packet, uint16_t host_acl_data_packet_length, uint8_t host_synchronous_data_packet_length, uint16_t host_total_num_acl_data_packets, uint16_t host_total_num_synchronous_data_packets){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x33));
+    packet[2] = 7;
+    little_endian_store_16(packet, 3, host_acl_data_packet_length);
+    packet[5] = host_synchronous_data_packet_length;
+    little_endian_store_16(packet, 6, host_total_num_acl_data_packets);
+    little_endian_store_16(packet, 8, host_total_num_synchronous_data_packets);
+    return 10;
+}
+
+/**
+ * @brief Send HCI command HCI_HOST_BUFFER_SIZE
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_host_buffer_size(uint16_t host_acl_data_packet_length, uint8_t host_synchronous_data_packet_length, uint16_t host_total_num_acl_data_packets, uint16_t host_total_num_synchronous_data_packets){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x33));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_host_buffer_size(packet, host_acl_data_packet_length, host_synchronous_data_packet_length, host_total_num_acl_data_packets, host_total_num_synchronous_data_packets));
+}
+
+/**
+ * @brief Store HCI command HCI_HOST_NUMBER_OF_COMPLETED_PACKETS into packet
+ * @param packet buffer of at least 8 bytes
+ * @param number_of_handles
+ * @param connection_handle
+ * @param host_num_of_completed_packets
+ * @return size of command packet
+ * @note: btstack_type 1H2
+ */
+static inline uint16_t hci_cmd_encode_host_number_of_completed_packets(uint8_t * packet, uint8_t number_of_handles, hci_con_handle_t connection_handle, uint16_t host_num_of_completed_packets){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x35));
+    packet[2] = 5;
+    packet[3] = number_of_handles;
+    little_endian_store_16(packet, 4, connection_handle);
+    little_endian_store_16(packet, 6, host_num_of_completed_packets);
+    return 8;
+}
+
+/**
+ * @brief Send HCI command HCI_HOST_NUMBER_OF_COMPLETED_PACKETS
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_host_number_of_completed_packets(uint8_t number_of_handles, hci_con_handle_t connection_handle, uint16_t host_num_of_completed_packets){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x35));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_host_number_of_completed_packets(packet, number_of_handles, connection_handle, host_num_of_completed_packets));
+}
+
+/**
+ * @brief Store HCI command HCI_READ_LINK_SUPERVISION_TIMEOUT into packet
+ * @param packet buffer of at least 5 bytes
+ * @param handle
+ * @return size of command packet
+ * @note: btstack_type H
+ */
+static inline uint16_t hci_cmd_encode_read_link_supervision_timeout(uint8_t * packet, hci_con_handle_t handle){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x36));
+    packet[2] = 2;
+    little_endian_store_16(packet, 3, handle);
+    return 5;
+}
+
+/**
+ * @brief Send HCI command HCI_READ_LINK_SUPERVISION_TIMEOUT
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_read_link_supervision_timeout(hci_con_handle_t handle){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x36));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_read_link_supervision_timeout(packet, handle));
+}
+
+/**
+ * @brief Store HCI command HCI_WRITE_LINK_SUPERVISION_TIMEOUT into packet
+ * @param packet buffer of at least 7 bytes
+ * @param handle
+ * @param timeout
+ * @return size of command packet
+ * @note: btstack_type H2
+ */
+static inline uint16_t hci_cmd_encode_write_link_supervision_timeout(uint8_t * packet, hci_con_handle_t handle, uint16_t timeout){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x37));
+    packet[2] = 4;
+    little_endian_store_16(packet, 3, handle);
+    little_endian_store_16(packet, 5, timeout);
+    return 7;
+}
+
+/**
+ * @brief Send HCI command HCI_WRITE_LINK_SUPERVISION_TIMEOUT
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_write_link_supervision_timeout(hci_con_handle_t handle, uint16_t timeout){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x37));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_write_link_supervision_timeout(packet, handle, timeout));
+}
+
+/**
+ * @brief Store HCI command HCI_WRITE_INQUIRY_MODE into packet
+ * @param packet buffer of at least 4 bytes
+ * @param inquiry_mode
+ * @return size of command packet
+ * @note: btstack_type 1
+ */
+static inline uint16_t hci_cmd_encode_write_inquiry_mode(uint8_t * packet, uint8_t inquiry_mode){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x45));
+    packet[2] = 1;
+    packet[3] = inquiry_mode;
+    return 4;
+}
+
+/**
+ * @brief Send HCI command HCI_WRITE_INQUIRY_MODE
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_write_inquiry_mode(uint8_t inquiry_mode){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x45));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_write_inquiry_mode(packet, inquiry_mode));
+}
+
+/**
+ * @brief Store HCI command HCI_WRITE_EXTENDED_INQUIRY_RESPONSE into packet
+ * @param packet buffer of at least 244 bytes
+ * @param fec_required
+ * @param exstended_inquiry_response
+ * @return size of command packet
+ * @note: btstack_type 1E
+ */
+static inline uint16_t hci_cmd_encode_write_extended_inquiry_response(uint8_t * packet, uint8_t fec_required, const uint8_t * exstended_inquiry_response){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x52));
+    packet[2] = 241;
+    packet[3] = fec_required;
+    memcpy(&packet[4], exstended_inquiry_response, 240);
+    return 244;
+}
+
+/**
+ * @brief Send HCI command HCI_WRITE_EXTENDED_INQUIRY_RESPONSE
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_write_extended_inquiry_response(uint8_t fec_required, const uint8_t * exstended_inquiry_response){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x52));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_write_extended_inquiry_response(packet, fec_required, exstended_inquiry_response));
+}
+
+/**
+ * @brief Store HCI command HCI_WRITE_SIMPLE_PAIRING_MODE into packet
+ * @param packet buffer of at least 4 bytes
+ * @param mode
+ * @return size of command packet
+ * @note: btstack_type 1
+ */
+static inline uint16_t hci_cmd_encode_write_simple_pairing_mode(uint8_t * packet, uint8_t mode){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x56));
+    packet[2] = 1;
+    packet[3] = mode;
+    return 4;
+}
+
+/**
+ * @brief Send HCI command HCI_WRITE_SIMPLE_PAIRING_MODE
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_write_simple_pairing_mode(uint8_t mode){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x56));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_write_simple_pairing_mode(packet, mode));
+}
+
+/**
+ * @brief Store HCI command HCI_READ_LOCAL_OOB_DATA into packet
+ * @param packet buffer of at least 3 bytes
+ * @return size of command packet
+ * @note: btstack_type 
+ */
+static inline uint16_t hci_cmd_encode_read_local_oob_data(uint8_t * packet){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x57));
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send HCI command HCI_READ_LOCAL_OOB_DATA
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_read_local_oob_data(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x57));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_read_local_oob_data(packet));
+}
+
+/**
+ * @brief Store HCI command HCI_WRITE_DEFAULT_ERRONEOUS_DATA_REPORTING into packet
+ * @param packet buffer of at least 4 bytes
+ * @param mode
+ * @return size of command packet
+ * @note: btstack_type 1
+ */
+static inline uint16_t hci_cmd_encode_write_default_erroneous_data_reporting(uint8_t * packet, uint8_t mode){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x5B));
+    packet[2] = 1;
+    packet[3] = mode;
+    return 4;
+}
+
+/**
+ * @brief Send HCI command HCI_WRITE_DEFAULT_ERRONEOUS_DATA_REPORTING
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_write_default_erroneous_data_reporting(uint8_t mode){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x5B));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_write_default_erroneous_data_reporting(packet, mode));
+}
+
+/**
+ * @brief Store HCI command HCI_READ_LE_HOST_SUPPORTED into packet
+ * @param packet buffer of at least 3 bytes
+ * @return size of command packet
+ * @note: btstack_type 
+ */
+static inline uint16_t hci_cmd_encode_read_le_host_supported(uint8_t * packet){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x6c));
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send HCI command HCI_READ_LE_HOST_SUPPORTED
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_read_le_host_supported(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x6c));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_read_le_host_supported(packet));
+}
+
+/**
+ * @brief Store HCI command HCI_WRITE_LE_HOST_SUPPORTED into packet
+ * @param packet buffer of at least 5 bytes
+ * @param le_supported_host
+ * @param simultaneous_le_host
+ * @return size of command packet
+ * @note: btstack_type 11
+ */
+static inline uint16_t hci_cmd_encode_write_le_host_supported(uint8_t * packet, uint8_t le_supported_host, uint8_t simultaneous_le_host){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x6d));
+    packet[2] = 2;
+    packet[3] = le_supported_host;
+    packet[4] = simultaneous_le_host;
+    return 5;
+}
+
+/**
+ * @brief Send HCI command HCI_WRITE_LE_HOST_SUPPORTED
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_write_le_host_supported(uint8_t le_supported_host, uint8_t simultaneous_le_host){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x6d));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_write_le_host_supported(packet, le_supported_host, simultaneous_le_host));
+}
+
+/**
+ * @brief Store HCI command HCI_READ_LOCAL_EXTENDED_OB_DATA into packet
+ * @param packet buffer of at least 3 bytes
+ * @return size of command packet
+ * @note: btstack_type 
+ */
+static inline uint16_t hci_cmd_encode_read_local_extended_ob_data(uint8_t * packet){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x7d));
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send HCI command HCI_READ_LOCAL_EXTENDED_OB_DATA
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_read_local_extended_ob_data(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x7d));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_read_local_extended_ob_data(packet));
+}
+
+/**
+ * @brief Store HCI command HCI_READ_LOOPBACK_MODE into packet
+ * @param packet buffer of at least 3 bytes
+ * @return size of command packet
+ * @note: btstack_type 
+ */
+static inline uint16_t hci_cmd_encode_read_loopback_mode(uint8_t * packet){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_TESTING, 0x01));
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send HCI command HCI_READ_LOOPBACK_MODE
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_read_loopback_mode(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_TESTING, 0x01));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_read_loopback_mode(packet));
+}
+
+/**
+ * @brief Store HCI command HCI_WRITE_LOOPBACK_MODE into packet
+ * @param packet buffer of at least 4 bytes
+ * @param loopback_mode
+ * @return size of command packet
+ * @note: btstack_type 1
+ */
+static inline uint16_t hci_cmd_encode_write_loopback_mode(uint8_t * packet, uint8_t loopback_mode){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_TESTING, 0x02));
+    packet[2] = 1;
+    packet[3] = loopback_mode;
+    return 4;
+}
+
+/**
+ * @brief Send HCI command HCI_WRITE_LOOPBACK_MODE
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_write_loopback_mode(uint8_t loopback_mode){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_TESTING, 0x02));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_write_loopback_mode(packet, loopback_mode));
+}
+
+/**
+ * @brief Store HCI command HCI_ENABLE_DEVICE_UNDER_TEST_MODE into packet
+ * @param packet buffer of at least 3 bytes
+ * @return size of command packet
+ * @note: btstack_type 
+ */
+static inline uint16_t hci_cmd_encode_enable_device_under_test_mode(uint8_t * packet){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_TESTING, 0x03));
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send HCI command HCI_ENABLE_DEVICE_UNDER_TEST_MODE
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_enable_device_under_test_mode(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_TESTING, 0x03));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_enable_device_under_test_mode(packet));
+}
+
+/**
+ * @brief Store HCI command HCI_WRITE_SIMPLE_PAIRING_DEBUG_MODE into packet
+ * @param packet buffer of at least 4 bytes
+ * @param simple_pairing_debug_mode
+ * @return size of command packet
+ * @note: btstack_type 1
+ */
+static inline uint16_t hci_cmd_encode_write_simple_pairing_debug_mode(uint8_t * packet, uint8_t simple_pairing_debug_mode){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_TESTING, 0x04));
+    packet[2] = 1;
+    packet[3] = simple_pairing_debug_mode;
+    return 4;
+}
+
+/**
+ * @brief Send HCI command HCI_WRITE_SIMPLE_PAIRING_DEBUG_MODE
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_write_simple_pairing_debug_mode(uint8_t simple_pairing_debug_mode){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_TESTING, 0x04));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_write_simple_pairing_debug_mode(packet, simple_pairing_debug_mode));
+}
+
+/**
+ * @brief Store HCI command HCI_WRITE_SECURE_CONNECTIONS_TEST_MODE into packet
+ * @param packet buffer of at least 7 bytes
+ * @param handle
+ * @param dm1_acl_u_mode
+ * @param esco_loopback_mode
+ * @return size of command packet
+ * @note: btstack_type H11
+ */
+static inline uint16_t hci_cmd_encode_write_secure_connections_test_mode(uint8_t * packet, hci_con_handle_t handle, uint8_t dm1_acl_u_mode, uint8_t esco_loopback_mode){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_TESTING, 0x0a));
+    packet[2] = 4;
+    little_endian_store_16(packet, 3, handle);
+    packet[5] = dm1_acl_u_mode;
+    packet[6] = esco_loopback_mode;
+    return 7;
+}
+
+/**
+ * @brief Send HCI command HCI_WRITE_SECURE_CONNECTIONS_TEST_MODE
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_write_secure_connections_test_mode(hci_con_handle_t handle, uint8_t dm1_acl_u_mode, uint8_t esco_loopback_mode){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_TESTING, 0x0a));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_write_secure_connections_test_mode(packet, handle, dm1_acl_u_mode, esco_loopback_mode));
+}
+
+/**
+ * @brief Store HCI command HCI_READ_LOCAL_VERSION_INFORMATION into packet
+ * @param packet buffer of at least 3 bytes
+ * @return size of command packet
+ * @note: btstack_type 
+ */
+static inline uint16_t hci_cmd_encode_read_local_version_information(uint8_t * packet){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_INFORMATIONAL_PARAMETERS, 0x01));
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send HCI command HCI_READ_LOCAL_VERSION_INFORMATION
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_read_local_version_information(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_INFORMATIONAL_PARAMETERS, 0x01));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_read_local_version_information(packet));
+}
+
+/**
+ * @brief Store HCI command HCI_READ_LOCAL_SUPPORTED_COMMANDS into packet
+ * @param packet buffer of at least 3 bytes
+ * @return size of command packet
+ * @note: btstack_type 
+ */
+static inline uint16_t hci_cmd_encode_read_local_supported_commands(uint8_t * packet){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_INFORMATIONAL_PARAMETERS, 0x02));
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send HCI command HCI_READ_LOCAL_SUPPORTED_COMMANDS
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_read_local_supported_commands(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_INFORMATIONAL_PARAMETERS, 0x02));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_read_local_supported_commands(packet));
+}
+
+/**
+ * @brief Store HCI command HCI_READ_LOCAL_SUPPORTED_FEATURES into packet
+ * @param packet buffer of at least 3 bytes
+ * @return size of command packet
+ * @note: btstack_type 
+ */
+static inline uint16_t hci_cmd_encode_read_local_supported_features(uint8_t * packet){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_INFORMATIONAL_PARAMETERS, 0x03));
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send HCI command HCI_READ_LOCAL_SUPPORTED_FEATURES
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_read_local_supported_features(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_INFORMATIONAL_PARAMETERS, 0x03));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_read_local_supported_features(packet));
+}
+
+/**
+ * @brief Store HCI command HCI_READ_BUFFER_SIZE into packet
+ * @param packet buffer of at least 3 bytes
+ * @return size of command packet
+ * @note: btstack_type 
+ */
+static inline uint16_t hci_cmd_encode_read_buffer_size(uint8_t * packet){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_INFORMATIONAL_PARAMETERS, 0x05));
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send HCI command HCI_READ_BUFFER_SIZE
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_read_buffer_size(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_INFORMATIONAL_PARAMETERS, 0x05));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_read_buffer_size(packet));
+}
+
+/**
+ * @brief Store HCI command HCI_READ_BD_ADDR into packet
+ * @param packet buffer of at least 3 bytes
+ * @return size of command packet
+ * @note: btstack_type 
+ */
+static inline uint16_t hci_cmd_encode_read_bd_addr(uint8_t * packet){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_INFORMATIONAL_PARAMETERS, 0x09));
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send HCI command HCI_READ_BD_ADDR
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_read_bd_addr(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_INFORMATIONAL_PARAMETERS, 0x09));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_read_bd_addr(packet));
+}
+
+/**
+ * @brief Store HCI command HCI_READ_RSSI into packet
+ * @param packet buffer of at least 5 bytes
+ * @param handle
+ * @return size of command packet
+ * @note: btstack_type H
+ */
+static inline uint16_t hci_cmd_encode_read_rssi(uint8_t * packet, hci_con_handle_t handle){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_STATUS_PARAMETERS, 0x05));
+    packet[2] = 2;
+    little_endian_store_16(packet, 3, handle);
+    return 5;
+}
+
+/**
+ * @brief Send HCI command HCI_READ_RSSI
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_read_rssi(hci_con_handle_t handle){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_STATUS_PARAMETERS, 0x05));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_read_rssi(packet, handle));
+}
+
+/**
+ * @brief Store HCI command HCI_LE_SET_EVENT_MASK into packet
+ * @param packet buffer of at least 11 bytes
+ * @param event_mask_lower_octets
+ * @param event_mask_higher_octets
+ * @return size of command packet
+ * @note: btstack_type 44
+ */
+static inline uint16_t hci_cmd_encode_le_set_event_mask(uint8_t * packet, uint32_t event_mask_lower_octets, uint32_t event_mask_higher_octets){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x01));
+    packet[2] = 8;
+    little_endian_store_32(packet, 3, event_mask_lower_octets);
+    little_endian_store_32(packet, 7, event_mask_higher_octets);
+    return 11;
+}
+
+/**
+ * @brief Send HCI command HCI_LE_SET_EVENT_MASK
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_le_set_event_mask(uint32_t event_mask_lower_octets, uint32_t event_mask_higher_octets){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x01));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_le_set_event_mask(packet, event_mask_lower_octets, event_mask_higher_octets));
+}
+
+/**
+ * @brief Store HCI command HCI_LE_READ_BUFFER_SIZE into packet
+ * @param packet buffer of at least 3 bytes
+ * @return size of command packet
+ * @note: btstack_type 
+ */
+static inline uint16_t hci_cmd_encode_le_read_buffer_size(uint8_t * packet){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x02));
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send HCI command HCI_LE_READ_BUFFER_SIZE
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_le_read_buffer_size(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x02));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_le_read_buffer_size(packet));
+}
+
+/**
+ * @brief Store HCI command HCI_LE_READ_SUPPORTED_FEATURES into packet
+ * @param packet buffer of at least 3 bytes
+ * @return size of command packet
+ * @note: btstack_type 
+ */
+static inline uint16_t hci_cmd_encode_le_read_supported_features(uint8_t * packet){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x03));
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send HCI command HCI_LE_READ_SUPPORTED_FEATURES
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_le_read_supported_features(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x03));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_le_read_supported_features(packet));
+}
+
+/**
+ * @brief Store HCI command HCI_LE_SET_RANDOM_ADDRESS into packet
+ * @param packet buffer of at least 9 bytes
+ * @param random_bd_addr
+ * @return size of command packet
+ * @note: btstack_type B
+ */
+static inline uint16_t hci_cmd_encode_le_set_random_address(uint8_t * packet, const uint8_t * random_bd_addr){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x05));
+    packet[2] = 6;
+    reverse_bd_addr(random_bd_addr, &packet[3]);
+    return 9;
+}
+
+/**
+ * @brief Send HCI command HCI_LE_SET_RANDOM_ADDRESS
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_le_set_random_address(const uint8_t * random_bd_addr){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x05));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_le_set_random_address(packet, random_bd_addr));
+}
+
+/**
+ * @brief Store HCI command HCI_LE_SET_ADVERTISING_PARAMETERS into packet
+ * @param packet buffer of at least 18 bytes
+ * @param advertising_interval_min
+ * @param advertising_interval_max
+ * @param advertising_type
+ * @param own_address_type
+ * @param direct_address_type
+ * @param direct_address
+ * @param advertising_channel_map
+ * @param advertising_filter_policy
+ * @return size of command packet
+ * @note: btstack_type 22111B11
+ */
+static inline uint16_t hci_cmd_encode_le_set_advertising_parameters(uint8_t * packet, uint16_t advertising_interval_min, uint16_t advertising_interval_max, uint8_t advertising_type, uint8_t own_address_type, uint8_t direct_address_type, const uint8_t * direct_address, uint8_t advertising_channel_map, uint8_t advertising_filter_policy){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x06));
+    packet[2] = 15;
+    little_endian_store_16(packet, 3, advertising_interval_min);
+    little_endian_store_16(packet, 5, advertising_interval_max);
+    packet[7] = advertising_type;
+    packet[8] = own_address_type;
+    packet[9] = direct_address_type;
+    reverse_bd_addr(direct_address, &packet[10]);
+    packet[16] = advertising_channel_map;
+    packet[17] = advertising_filter_policy;
+    return 18;
+}
+
+/**
+ * @brief Send HCI command HCI_LE_SET_ADVERTISING_PARAMETERS
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_le_set_advertising_parameters(uint16_t advertising_interval_min, uint16_t advertising_interval_max, uint8_t advertising_type, uint8_t own_address_type, uint8_t direct_address_type, const uint8_t * direct_address, uint8_t advertising_channel_map, uint8_t advertising_filter_policy){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x06));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_le_set_advertising_parameters(packet, advertising_interval_min, advertising_interval_max, advertising_type, own_address_type, direct_address_type, direct_address, advertising_channel_map, advertising_filter_policy));
+}
+
+/**
+ * @brief Store HCI command HCI_LE_READ_ADVERTISING_CHANNEL_TX_POWER into packet
+ * @param packet buffer of at least 3 bytes
+ * @return size of command packet
+ * @note: btstack_type 
+ */
+static inline uint16_t hci_cmd_encode_le_read_advertising_channel_tx_power(uint8_t * packet){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x07));
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send HCI command HCI_LE_READ_ADVERTISING_CHANNEL_TX_POWER
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_le_read_advertising_channel_tx_power(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x07));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_le_read_advertising_channel_tx_power(packet));
+}
+
+#ifdef ENABLE_BLE
+/**
+ * @brief Store HCI command HCI_LE_SET_ADVERTISING_DATA into packet
+ * @param packet buffer of at least 35 bytes
+ * @param advertising_data_length
+ * @param advertising_data
+ * @return size of command packet
+ * @note: btstack_type 1A
+ */
+static inline uint16_t hci_cmd_encode_le_set_advertising_data(uint8_t * packet, uint8_t advertising_data_length, const uint8_t * advertising_data){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x08));
+    packet[2] = 32;
+    packet[3] = advertising_data_length;
+    memcpy(&packet[4], advertising_data, 31);
+    return 35;
+}
+
+/**
+ * @brief Send HCI command HCI_LE_SET_ADVERTISING_DATA
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_le_set_advertising_data(uint8_t advertising_data_length, const uint8_t * advertising_data){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x08));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_le_set_advertising_data(packet, advertising_data_length, advertising_data));
+}
+#endif
+
+#ifdef ENABLE_BLE
+/**
+ * @brief Store HCI command HCI_LE_SET_SCAN_RESPONSE_DATA into packet
+ * @param packet buffer of at least 35 bytes
+ * @param scan_response_data_length
+ * @param scan_response_data
+ * @return size of command packet
+ * @note: btstack_type 1A
+ */
+static inline uint16_t hci_cmd_encode_le_set_scan_response_data(uint8_t * packet, uint8_t scan_response_data_length, const uint8_t * scan_response_data){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x09));
+    packet[2] = 32;
+    packet[3] = scan_response_data_length;
+    memcpy(&packet[4], scan_response_data, 31);
+    return 35;
+}
+
+/**
+ * @brief Send HCI command HCI_LE_SET_SCAN_RESPONSE_DATA
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_le_set_scan_response_data(uint8_t scan_response_data_length, const uint8_t * scan_response_data){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x09));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_le_set_scan_response_data(packet, scan_response_data_length, scan_response_data));
+}
+#endif
+
+/**
+ * @brief Store HCI command HCI_LE_SET_ADVERTISE_ENABLE into packet
+ * @param packet buffer of at least 4 bytes
+ * @param advertise_enable
+ * @return size of command packet
+ * @note: btstack_type 1
+ */
+static inline uint16_t hci_cmd_encode_le_set_advertise_enable(uint8_t * packet, uint8_t advertise_enable){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x0a));
+    packet[2] = 1;
+    packet[3] = advertise_enable;
+    return 4;
+}
+
+/**
+ * @brief Send HCI command HCI_LE_SET_ADVERTISE_ENABLE
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_le_set_advertise_enable(uint8_t advertise_enable){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x0a));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_le_set_advertise_enable(packet, advertise_enable));
+}
+
+/**
+ * @brief Store HCI command HCI_LE_SET_SCAN_PARAMETERS into packet
+ * @param packet buffer of at least 10 bytes
+ * @param le_scan_type
+ * @param le_scan_interval
+ * @param le_scan_window
+ * @param own_address_type
+ * @param scanning_filter_policy
+ * @return size of command packet
+ * @note: btstack_type 12211
+ */
+static inline uint16_t hci_cmd_encode_le_set_scan_parameters(uint8_t * packet, uint8_t le_scan_type, uint16_t le_scan_interval, uint16_t le_scan_window, uint8_t own_address_type, uint8_t scanning_filter_policy){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x0b));
+    packet[2] = 7;
+    packet[3] = le_scan_type;
+    little_endian_store_16(packet, 4, le_scan_interval);
+    little_endian_store_16(packet, 6, le_scan_window);
+    packet[8] = own_address_type;
+    packet[9] = scanning_filter_policy;
+    return 10;
+}
+
+/**
+ * @brief Send HCI command HCI_LE_SET_SCAN_PARAMETERS
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_le_set_scan_parameters(uint8_t le_scan_type, uint16_t le_scan_interval, uint16_t le_scan_window, uint8_t own_address_type, uint8_t scanning_filter_policy){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x0b));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_le_set_scan_parameters(packet, le_scan_type, le_scan_interval, le_scan_window, own_address_type, scanning_filter_policy));
+}
+
+/**
+ * @brief Store HCI command HCI_LE_SET_SCAN_ENABLE into packet
+ * @param packet buffer of at least 5 bytes
+ * @param le_scan_enable
+ * @param filter_duplices
+ * @return size of command packet
+ * @note: btstack_type 11
+ */
+static inline uint16_t hci_cmd_encode_le_set_scan_enable(uint8_t * packet, uint8_t le_scan_enable, uint8_t filter_duplices){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x0c));
+    packet[2] = 2;
+    packet[3] = le_scan_enable;
+    packet[4] = filter_duplices;
+    return 5;
+}
+
+/**
+ * @brief Send HCI command HCI_LE_SET_SCAN_ENABLE
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_le_set_scan_enable(uint8_t le_scan_enable, uint8_t filter_duplices){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x0c));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_le_set_scan_enable(packet, le_scan_enable, filter_duplices));
+}
+
+/**
+ * @brief Store HCI command HCI_LE_CREATE_CONNECTION into packet
+ * @param packet buffer of at least 28 bytes
+ * @param le_scan_interval
+ * @param le_scan_window
+ * @param initiator_filter_policy
+ * @param peer_address_type
+ * @param peer_address
+ * @param own_address_type
+ * @param conn_interval_min
+ * @param conn_interval_max
+ * @param conn_latency
+ * @param supervision_timeout
+ * @param minimum_ce_length
+ * @param maximum_ce_length
+ * @return size of command packet
+ * @note: btstack_type 2211B1222222
+ */
+static inline uint16_t hci_cmd_encode_le_create_connection(uint8_t * packet, uint16_t le_scan_interval, uint16_t le_scan_window, uint8_t initiator_filter_policy, uint8_t peer_address_type, const uint8_t * peer_address, uint8_t own_address_type, uint16_t conn_interval_min, uint16_t conn_interval_max, uint16_t conn_latency, uint16_t supervision_timeout, uint16_t minimum_ce_length, uint16_t maximum_ce_length){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x0d));
+    packet[2] = 25;
+    little_endian_store_16(packet, 3, le_scan_interval);
+    little_endian_store_16(packet, 5, le_scan_window);
+    packet[7] = initiator_filter_policy;
+    packet[8] = peer_address_type;
+    reverse_bd_addr(peer_address, &packet[9]);
+    packet[15] = own_address_type;
+    little_endian_store_16(packet, 16, conn_interval_min);
+    little_endian_store_16(packet, 18, conn_interval_max);
+    little_endian_store_16(packet, 20, conn_latency);
+    little_endian_store_16(packet, 22, supervision_timeout);
+    little_endian_store_16(packet, 24, minimum_ce_length);
+    little_endian_store_16(packet, 26, maximum_ce_length);
+    return 28;
+}
+
+/**
+ * @brief Send HCI command HCI_LE_CREATE_CONNECTION
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_le_create_connection(uint16_t le_scan_interval, uint16_t le_scan_window, uint8_t initiator_filter_policy, uint8_t peer_address_type, const uint8_t * peer_address, uint8_t own_address_type, uint16_t conn_interval_min, uint16_t conn_interval_max, uint16_t conn_latency, uint16_t supervision_timeout, uint16_t minimum_ce_length, uint16_t maximum_ce_length){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x0d));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_le_create_connection(packet, le_scan_interval, le_scan_window, initiator_filter_policy, peer_address_type, peer_address, own_address_type, conn_interval_min, conn_interval_max, conn_latency, supervision_timeout, minimum_ce_length, maximum_ce_length));
+}
+
+/**
+ * @brief Store HCI command HCI_LE_CREATE_CONNECTION_CANCEL into packet
+ * @param packet buffer of at least 3 bytes
+ * @return size of command packet
+ * @note: btstack_type 
+ */
+static inline uint16_t hci_cmd_encode_le_create_connection_cancel(uint8_t * packet){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x0e));
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send HCI command HCI_LE_CREATE_CONNECTION_CANCEL
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_le_create_connection_cancel(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x0e));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_le_create_connection_cancel(packet));
+}
+
+/**
+ * @brief Store HCI command HCI_LE_READ_WHITE_LIST_SIZE into packet
+ * @param packet buffer of at least 3 bytes
+ * @return size of command packet
+ * @note: btstack_type 
+ */
+static inline uint16_t hci_cmd_encode_le_read_white_list_size(uint8_t * packet){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x0f));
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send HCI command HCI_LE_READ_WHITE_LIST_SIZE
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_le_read_white_list_size(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x0f));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_le_read_white_list_size(packet));
+}
+
+/**
+ * @brief Store HCI command HCI_LE_CLEAR_WHITE_LIST into packet
+ * @param packet buffer of at least 3 bytes
+ * @return size of command packet
+ * @note: btstack_type 
+ */
+static inline uint16_t hci_cmd_encode_le_clear_white_list(uint8_t * packet){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x10));
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send HCI command HCI_LE_CLEAR_WHITE_LIST
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_le_clear_white_list(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x10));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_le_clear_white_list(packet));
+}
+
+/**
+ * @brief Store HCI command HCI_LE_ADD_DEVICE_TO_WHITE_LIST into packet
+ * @param packet buffer of at least 10 bytes
+ * @param address_type
+ * @param bd_addr
+ * @return size of command packet
+ * @note: btstack_type 1B
+ */
+static inline uint16_t hci_cmd_encode_le_add_device_to_white_list(uint8_t * packet, uint8_t address_type, const uint8_t * bd_addr){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x11));
+    packet[2] = 7;
+    packet[3] = address_type;
+    reverse_bd_addr(bd_addr, &packet[4]);
+    return 10;
+}
+
+/**
+ * @brief Send HCI command HCI_LE_ADD_DEVICE_TO_WHITE_LIST
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_le_add_device_to_white_list(uint8_t address_type, const uint8_t * bd_addr){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x11));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_le_add_device_to_white_list(packet, address_type, bd_addr));
+}
+
+/**
+ * @brief Store HCI command HCI_LE_REMOVE_DEVICE_FROM_WHITE_LIST into packet
+ * @param packet buffer of at least 10 bytes
+ * @param address_type
+ * @param bd_addr
+ * @return size of command packet
+ * @note: btstack_type 1B
+ */
+static inline uint16_t hci_cmd_encode_le_remove_device_from_white_list(uint8_t * packet, uint8_t address_type, const uint8_t * bd_addr){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x12));
+    packet[2] = 7;
+    packet[3] = address_type;
+    reverse_bd_addr(bd_addr, &packet[4]);
+    return 10;
+}
+
+/**
+ * @brief Send HCI command HCI_LE_REMOVE_DEVICE_FROM_WHITE_LIST
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_le_remove_device_from_white_list(uint8_t address_type, const uint8_t * bd_addr){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x12));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_le_remove_device_from_white_list(packet, address_type, bd_addr));
+}
+
+/**
+ * @brief Store HCI command HCI_LE_CONNECTION_UPDATE into packet
+ * @param packet buffer of at least 17 bytes
+ * @param conn_handle
+ * @param conn_interval_min
+ * @param conn_interval_max
+ * @param conn_latency
+ * @param supervision_timeout
+ * @param minimum_ce_length
+ * @param maximum_ce_length
+ * @return size of command packet
+ * @note: btstack_type H222222
+ */
+static inline uint16_t hci_cmd_encode_le_connection_update(uint8_t * packet, hci_con_handle_t conn_handle, uint16_t conn_interval_min, uint16_t conn_interval_max, uint16_t conn_latency, uint16_t supervision_timeout, uint16_t minimum_ce_length, uint16_t maximum_ce_length){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x13));
+    packet[2] = 14;
+    little_endian_store_16(packet, 3, conn_handle);
+    little_endian_store_16(packet, 5, conn_interval_min);
+    little_endian_store_16(packet, 7, conn_interval_max);
+    little_endian_store_16(packet, 9, conn_latency);
+    little_endian_store_16(packet, 11, supervision_timeout);
+    little_endian_store_16(packet, 13, minimum_ce_length);
+    little_endian_store_16(packet, 15, maximum_ce_length);
+    return 17;
+}
+
+/**
+ * @brief Send HCI command HCI_LE_CONNECTION_UPDATE
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_le_connection_update(hci_con_handle_t conn_handle, uint16_t conn_interval_min, uint16_t conn_interval_max, uint16_t conn_latency, uint16_t supervision_timeout, uint16_t minimum_ce_length, uint16_t maximum_ce_length){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x13));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_le_connection_update(packet, conn_handle, conn_interval_min, conn_interval_max, conn_latency, supervision_timeout, minimum_ce_length, maximum_ce_length));
+}
+
+/**
+ * @brief Store HCI command HCI_LE_SET_HOST_CHANNEL_CLASSIFICATION into packet
+ * @param packet buffer of at least 8 bytes
+ * @param channel_map_lower_32bits
+ * @param channel_map_higher_5bits
+ * @return size of command packet
+ * @note: btstack_type 41
+ */
+static inline uint16_t hci_cmd_encode_le_set_host_channel_classification(uint8_t * packet, uint32_t channel_map_lower_32bits, uint8_t channel_map_higher_5bits){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x14));
+    packet[2] = 5;
+    little_endian_store_32(packet, 3, channel_map_lower_32bits);
+    packet[7] = channel_map_higher_5bits;
+    return 8;
+}
+
+/**
+ * @brief Send HCI command HCI_LE_SET_HOST_CHANNEL_CLASSIFICATION
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_le_set_host_channel_classification(uint32_t channel_map_lower_32bits, uint8_t channel_map_higher_5bits){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x14));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_le_set_host_channel_classification(packet, channel_map_lower_32bits, channel_map_higher_5bits));
+}
+
+/**
+ * @brief Store HCI command HCI_LE_READ_CHANNEL_MAP into packet
+ * @param packet buffer of at least 5 bytes
+ * @param conn_handle
+ * @return size of command packet
+ * @note: btstack_type H
+ */
+static inline uint16_t hci_cmd_encode_le_read_channel_map(uint8_t * packet, hci_con_handle_t conn_handle){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x15));
+    packet[2] = 2;
+    little_endian_store_16(packet, 3, conn_handle);
+    return 5;
+}
+
+/**
+ * @brief Send HCI command HCI_LE_READ_CHANNEL_MAP
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_le_read_channel_map(hci_con_handle_t conn_handle){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x15));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_le_read_channel_map(packet, conn_handle));
+}
+
+/**
+ * @brief Store HCI command HCI_LE_READ_REMOTE_USED_FEATURES into packet
+ * @param packet buffer of at least 5 bytes
+ * @param conn_handle
+ * @return size of command packet
+ * @note: btstack_type H
+ */
+static inline uint16_t hci_cmd_encode_le_read_remote_used_features(uint8_t * packet, hci_con_handle_t conn_handle){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x16));
+    packet[2] = 2;
+    little_endian_store_16(packet, 3, conn_handle);
+    return 5;
+}
+
+/**
+ * @brief Send HCI command HCI_LE_READ_REMOTE_USED_FEATURES
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_le_read_remote_used_features(hci_con_handle_t conn_handle){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x16));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_le_read_remote_used_features(packet, conn_handle));
+}
+
+/**
+ * @brief Store HCI command HCI_LE_ENCRYPT into packet
+ * @param packet buffer of at least 35 bytes
+ * @param key
+ * @param plain_text
+ * @return size of command packet
+ * @note: btstack_type PP
+ */
+static inline uint16_t hci_cmd_encode_le_encrypt(uint8_t * packet, const uint8_t * key, const uint8_t * plain_text){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x17));
+    packet[2] = 32;
+    memcpy(&packet[3], key, 16);
+    memcpy(&packet[19], plain_text, 16);
+    return 35;
+}
+
+/**
+ * @brief Send HCI command HCI_LE_ENCRYPT
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_le_encrypt(const uint8_t * key, const uint8_t * plain_text){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x17));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_le_encrypt(packet, key, plain_text));
+}
+
+/**
+ * @brief Store HCI command HCI_LE_RAND into packet
+ * @param packet buffer of at least 3 bytes
+ * @return size of command packet
+ * @note: btstack_type 
+ */
+static inline uint16_t hci_cmd_encode_le_rand(uint8_t * packet){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x18));
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send HCI command HCI_LE_RAND
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_le_rand(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x18));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_le_rand(packet));
+}
+
+/**
+ * @brief Store HCI command HCI_LE_START_ENCRYPTION into packet
+ * @param packet buffer of at least 31 bytes
+ * @param conn_handle
+ * @param random_number_lower_32bits
+ * @param random_number_higher_32bits
+ * @param encryption_diversifier
+ * @param long_term_key
+ * @return size of command packet
+ * @note: btstack_type H442P
+ */
+static inline uint16_t hci_cmd_encode_le_start_encryption(uint8_t * packet, hci_con_handle_t conn_handle, uint32_t random_number_lower_32bits, uint32_t random_number_higher_32bits, uint16_t encryption_diversifier, const uint8_t * long_term_key){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x19));
+    packet[2] = 28;
+    little_endian_store_16(packet, 3, conn_handle);
+    little_endian_store_32(packet, 5, random_number_lower_32bits);
+    little_endian_store_32(packet, 9, random_number_higher_32bits);
+    little_endian_store_16(packet, 13, encryption_diversifier);
+    memcpy(&packet[15], long_term_key, 16);
+    return 31;
+}
+
+/**
+ * @brief Send HCI command HCI_LE_START_ENCRYPTION
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_le_start_encryption(hci_con_handle_t conn_handle, uint32_t random_number_lower_32bits, uint32_t random_number_higher_32bits, uint16_t encryption_diversifier, const uint8_t * long_term_key){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x19));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_le_start_encryption(packet, conn_handle, random_number_lower_32bits, random_number_higher_32bits, encryption_diversifier, long_term_key));
+}
+
+/**
+ * @brief Store HCI command HCI_LE_LONG_TERM_KEY_REQUEST_REPLY into packet
+ * @param packet buffer of at least 21 bytes
+ * @param connection_handle
+ * @param long_term_key
+ * @return size of command packet
+ * @note: btstack_type HP
+ */
+static inline uint16_t hci_cmd_encode_le_long_term_key_request_reply(uint8_t * packet, hci_con_handle_t connection_handle, const uint8_t * long_term_key){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x1a));
+    packet[2] = 18;
+    little_endian_store_16(packet, 3, connection_handle);
+    memcpy(&packet[5], long_term_key, 16);
+    return 21;
+}
+
+/**
+ * @brief Send HCI command HCI_LE_LONG_TERM_KEY_REQUEST_REPLY
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_le_long_term_key_request_reply(hci_con_handle_t connection_handle, const uint8_t * long_term_key){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x1a));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_le_long_term_key_request_reply(packet, connection_handle, long_term_key));
+}
+
+/**
+ * @brief Store HCI command HCI_LE_LONG_TERM_KEY_NEGATIVE_REPLY into packet
+ * @param packet buffer of at least 5 bytes
+ * @param conn_handle
+ * @return size of command packet
+ * @note: btstack_type H
+ */
+static inline uint16_t hci_cmd_encode_le_long_term_key_negative_reply(uint8_t * packet, hci_con_handle_t conn_handle){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x1b));
+    packet[2] = 2;
+    little_endian_store_16(packet, 3, conn_handle);
+    return 5;
+}
+
+/**
+ * @brief Send HCI command HCI_LE_LONG_TERM_KEY_NEGATIVE_REPLY
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_le_long_term_key_negative_reply(hci_con_handle_t conn_handle){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x1b));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_le_long_term_key_negative_reply(packet, conn_handle));
+}
+
+/**
+ * @brief Store HCI command HCI_LE_READ_SUPPORTED_STATES into packet
+ * @param packet buffer of at least 5 bytes
+ * @param conn_handle
+ * @return size of command packet
+ * @note: btstack_type H
+ */
+static inline uint16_t hci_cmd_encode_le_read_supported_states(uint8_t * packet, hci_con_handle_t conn_handle){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x1c));
+    packet[2] = 2;
+    little_endian_store_16(packet, 3, conn_handle);
+    return 5;
+}
+
+/**
+ * @brief Send HCI command HCI_LE_READ_SUPPORTED_STATES
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_le_read_supported_states(hci_con_handle_t conn_handle){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x1c));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_le_read_supported_states(packet, conn_handle));
+}
+
+/**
+ * @brief Store HCI command HCI_LE_RECEIVER_TEST into packet
+ * @param packet buffer of at least 4 bytes
+ * @param rx_frequency
+ * @return size of command packet
+ * @note: btstack_type 1
+ */
+static inline uint16_t hci_cmd_encode_le_receiver_test(uint8_t * packet, uint8_t rx_frequency){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x1d));
+    packet[2] = 1;
+    packet[3] = rx_frequency;
+    return 4;
+}
+
+/**
+ * @brief Send HCI command HCI_LE_RECEIVER_TEST
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_le_receiver_test(uint8_t rx_frequency){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x1d));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_le_receiver_test(packet, rx_frequency));
+}
+
+/**
+ * @brief Store HCI command HCI_LE_TRANSMITTER_TEST into packet
+ * @param packet buffer of at least 6 bytes
+ * @param tx_frequency
+ * @param test_payload_lengh
+ * @param packet_payload
+ * @return size of command packet
+ * @note: btstack_type 111
+ */
+static inline uint16_t hci_cmd_encode_le_transmitter_test(uint8_t * packet, uint8_t tx_frequency, uint8_t test_payload_lengh, uint8_t packet_payload){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x1e));
+    packet[2] = 3;
+    packet[3] = tx_frequency;
+    packet[4] = test_payload_lengh;
+    packet[5] = packet_payload;
+    return 6;
+}
+
+/**
+ * @brief Send HCI command HCI_LE_TRANSMITTER_TEST
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_le_transmitter_test(uint8_t tx_frequency, uint8_t test_payload_lengh, uint8_t packet_payload){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x1e));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_le_transmitter_test(packet, tx_frequency, test_payload_lengh, packet_payload));
+}
+
+/**
+ * @brief Store HCI command HCI_LE_TEST_END into packet
+ * @param packet buffer of at least 4 bytes
+ * @param end_test_cmd
+ * @return size of command packet
+ * @note: btstack_type 1
+ */
+static inline uint16_t hci_cmd_encode_le_test_end(uint8_t * packet, uint8_t end_test_cmd){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x1f));
+    packet[2] = 1;
+    packet[3] = end_test_cmd;
+    return 4;
+}
+
+/**
+ * @brief Send HCI command HCI_LE_TEST_END
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_le_test_end(uint8_t end_test_cmd){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x1f));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_le_test_end(packet, end_test_cmd));
+}
+
+/**
+ * @brief Store HCI command HCI_LE_SET_DATA_LENGTH into packet
+ * @param packet buffer of at least 9 bytes
+ * @param con_handle
+ * @param tx_octets
+ * @param tx_time
+ * @return size of command packet
+ * @note: btstack_type H22
+ */
+static inline uint16_t hci_cmd_encode_le_set_data_length(uint8_t * packet, hci_con_handle_t con_handle, uint16_t tx_octets, uint16_t tx_time){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x22));
+    packet[2] = 6;
+    little_endian_store_16(packet, 3, con_handle);
+    little_endian_store_16(packet, 5, tx_octets);
+    little_endian_store_16(packet, 7, tx_time);
+    return 9;
+}
+
+/**
+ * @brief Send HCI command HCI_LE_SET_DATA_LENGTH
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_le_set_data_length(hci_con_handle_t con_handle, uint16_t tx_octets, uint16_t tx_time){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x22));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_le_set_data_length(packet, con_handle, tx_octets, tx_time));
+}
+
+/**
+ * @brief Store HCI command HCI_LE_READ_SUGGESTED_DEFAULT_DATA_LENGTH into packet
+ * @param packet buffer of at least 3 bytes
+ * @return size of command packet
+ * @note: btstack_type 
+ */
+static inline uint16_t hci_cmd_encode_le_read_suggested_default_data_length(uint8_t * packet){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x23));
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send HCI command HCI_LE_READ_SUGGESTED_DEFAULT_DATA_LENGTH
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_le_read_suggested_default_data_length(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x23));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_le_read_suggested_default_data_length(packet));
+}
+
+/**
+ * @brief Store HCI command HCI_LE_WRITE_SUGGESTED_DEFAULT_DATA_LENGTH into packet
+ * @param packet buffer of at least 7 bytes
+ * @param suggested_max_tx_octets
+ * @param suggested_max_tx_time
+ * @return size of command packet
+ * @note: btstack_type 22
+ */
+static inline uint16_t hci_cmd_encode_le_write_suggested_default_data_length(uint8_t * packet, uint16_t suggested_max_tx_octets, uint16_t suggested_max_tx_time){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x24));
+    packet[2] = 4;
+    little_endian_store_16(packet, 3, suggested_max_tx_octets);
+    little_endian_store_16(packet, 5, suggested_max_tx_time);
+    return 7;
+}
+
+/**
+ * @brief Send HCI command HCI_LE_WRITE_SUGGESTED_DEFAULT_DATA_LENGTH
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_le_write_suggested_default_data_length(uint16_t suggested_max_tx_octets, uint16_t suggested_max_tx_time){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x24));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_le_write_suggested_default_data_length(packet, suggested_max_tx_octets, suggested_max_tx_time));
+}
+
+/**
+ * @brief Store HCI command HCI_LE_READ_LOCAL_P256_PUBLIC_KEY into packet
+ * @param packet buffer of at least 3 bytes
+ * @return size of command packet
+ * @note: btstack_type 
+ */
+static inline uint16_t hci_cmd_encode_le_read_local_p256_public_key(uint8_t * packet){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x25));
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send HCI command HCI_LE_READ_LOCAL_P256_PUBLIC_KEY
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_le_read_local_p256_public_key(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x25));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_le_read_local_p256_public_key(packet));
+}
+
+#ifdef ENABLE_LE_SECURE_CONNECTIONS
+/**
+ * @brief Store HCI command HCI_LE_GENERATE_DHKEY into packet
+ * @param packet buffer of at least 67 bytes
+ * @param arg1
+ * @param arg2
+ * @return size of command packet
+ * @note: btstack_type QQ
+ */
+static inline uint16_t hci_cmd_encode_le_generate_dhkey(uint8_t * packet, const uint8_t * arg1, const uint8_t * arg2){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x26));
+    packet[2] = 64;
+    reverse_bytes(arg1, &packet[3], 32);
+    reverse_bytes(arg2, &packet[35], 32);
+    return 67;
+}
+
+/**
+ * @brief Send HCI command HCI_LE_GENERATE_DHKEY
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_le_generate_dhkey(const uint8_t * arg1, const uint8_t * arg2){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x26));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_le_generate_dhkey(packet, arg1, arg2));
+}
+#endif
+
+/**
+ * @brief Store HCI command HCI_LE_READ_MAXIMUM_DATA_LENGTH into packet
+ * @param packet buffer of at least 3 bytes
+ * @return size of command packet
+ * @note: btstack_type 
+ */
+static inline uint16_t hci_cmd_encode_le_read_maximum_data_length(uint8_t * packet){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x2F));
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send HCI command HCI_LE_READ_MAXIMUM_DATA_LENGTH
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_le_read_maximum_data_length(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x2F));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_le_read_maximum_data_length(packet));
+}
+
+/**
+ * @brief Store HCI command HCI_BCM_WRITE_SCO_PCM_INT into packet
+ * @param packet buffer of at least 8 bytes
+ * @param sco_routing
+ * @param pcm_interface_rate
+ * @param frame_type
+ * @param sync_mode
+ * @param clock_mode
+ * @return size of command packet
+ * @note: btstack_type 11111
+ */
+static inline uint16_t hci_cmd_encode_bcm_write_sco_pcm_int(uint8_t * packet, uint8_t sco_routing, uint8_t pcm_interface_rate, uint8_t frame_type, uint8_t sync_mode, uint8_t clock_mode){
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE(0x3f, 0x1c));
+    packet[2] = 5;
+    packet[3] = sco_routing;
+    packet[4] = pcm_interface_rate;
+    packet[5] = frame_type;
+    packet[6] = sync_mode;
+    packet[7] = clock_mode;
+    return 8;
+}
+
+/**
+ * @brief Send HCI command HCI_BCM_WRITE_SCO_PCM_INT
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_bcm_write_sco_pcm_int(uint8_t sco_routing, uint8_t pcm_interface_rate, uint8_t frame_type, uint8_t sync_mode, uint8_t clock_mode){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE(0x3f, 0x1c));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_bcm_write_sco_pcm_int(packet, sco_routing, pcm_interface_rate, frame_type, sync_mode, clock_mode));
+}
+
+
+/* API_END */
+
+#if defined __cplusplus
+}
+#endif
+
+#endif // __HCI_CMD_ENCODER_H
@@ -109,6 +109,15 @@ typedef struct {
      */
     void   (*set_sco_config)(uint16_t voice_setting, int num_connections);
 
+    /**
+     * optional: send packet given as header and payload (scatter/gather), used for outgoing ACL fragments
+     * payload needs to stay valid until HCI_EVENT_TRANSPORT_PACKET_SENT. header is only valid during the call,
+     * unless it is located directly in front of the payload, which allows to send header and payload without copying.
+     * Async transports emit one HCI_EVENT_TRANSPORT_PACKET_SENT with the packet type as parameter per packet and may
+     * keep can_send_packet_now true while packets are in flight to allow for multiple queued packets.
+     */
+    int    (*send_packet_with_header)(uint8_t packet_type, const uint8_t * header, uint16_t header_size, const uint8_t * payload, uint16_t payload_size);
+
 } hci_transport_t;
 
 typedef enum {
@@ -128,6 +137,21 @@ typedef struct {
     const char *device_name;
 } hci_transport_config_uart_t;
 
+typedef struct {
+    hci_transport_config_type_t type; // == HCI_TRANSPORT_CONFIG_USB
+    uint16_t   event_in_buffer_count; // number of interrupt transfers queued for HCI Events, 0: default
+    uint16_t   event_in_buffer_size;  // size of each HCI Event buffer,  0: default = HCI_ACL_BUFFER_SIZE
+    uint16_t   acl_in_buffer_count;   // number of bulk transfers queued for ACL data, 0: default
+    uint16_t   acl_in_buffer_size;    // size of each ACL buffer, 0: default = HCI_ACL_BUFFER_SIZE
+} hci_transport_config_usb_t;
+
+typedef struct {
+    uint32_t   event_in_completed;    // HCI Event transfers completed
+    uint32_t   event_in_queue_empty;  // HCI Event transfers completed while no other transfer was queued
+    uint32_t   acl_in_completed;      // ACL transfers completed
+    uint32_t   acl_in_queue_empty;    // ACL transfers completed while no other transfer was queued
+} hci_transport_usb_stats_t;
+
 
 // inline various hci_transport_X.h files
 
@@ -154,6 +178,13 @@ void hci_transport_h5_set_auto_sleep(uint16_t inactivity_timeout_ms);
  */
 void hci_transport_h5_enable_bcsp_mode(void);
 
+/*
+ * @brief Set sliding window size offered during link establishment. The smaller of this and the controller's
+ *        window size is used. Window sizes > 1 require HCI_TRANSPORT_H5_MAX_WINDOW_SIZE > 1 in btstack_config.h
+ * @param window_size 1..HCI_TRANSPORT_H5_MAX_WINDOW_SIZE, default: HCI_TRANSPORT_H5_MAX_WINDOW_SIZE
+ */
+void hci_transport_h5_set_sliding_window_size(uint8_t window_size);
+
 /*
  * @brief
  */
@@ -164,6 +195,14 @@ const hci_transport_t * hci_transport_usb_instance(void);
  */
 void hci_transport_usb_set_path(int len, uint8_t * port_numbers);
 
+/**
+ * @brief Get receive statistics for HCI Event and ACL endpoints
+ * @note A non-zero queue_empty count indicates that the receive queue ran dry and packets may have been delayed 
+ *       by the controller. Consider increasing buffer counts in hci_transport_config_usb_t.
+ * @param stats
+ */
+void hci_transport_usb_get_stats(hci_transport_usb_stats_t * stats);
+
 /* API_END */
     
 #if defined __cplusplus
@@ -77,12 +77,20 @@ typedef enum {
 
 } hci_transport_link_actions_t;
 
-// Configuration Field. No packet buffers -> sliding window = 1, no OOF flow control, support data integrity check
-#define LINK_CONFIG_SLIDING_WINDOW_SIZE 1
+// Max sliding window size = number of reliable packets in flight. For window size > 1, outgoing packets are copied into
+// HCI_TRANSPORT_H5_MAX_WINDOW_SIZE resend buffers of HCI_PACKET_BUFFER_SIZE bytes each. Default: no resend buffers
+#ifndef HCI_TRANSPORT_H5_MAX_WINDOW_SIZE
+#define HCI_TRANSPORT_H5_MAX_WINDOW_SIZE 1
+#endif
+#if (HCI_TRANSPORT_H5_MAX_WINDOW_SIZE < 1) || (HCI_TRANSPORT_H5_MAX_WINDOW_SIZE > 7)
+#error "HCI_TRANSPORT_H5_MAX_WINDOW_SIZE must be in range 1..7"
+#endif
+
+// Configuration Field. Sliding window as configured, no OOF flow control, support data integrity check
 #define LINK_CONFIG_OOF_FLOW_CONTROL 0
 #define LINK_CONFIG_DATA_INTEGRITY_CHECK 1
 #define LINK_CONFIG_VERSION_NR 0
-#define LINK_CONFIG_FIELD (LINK_CONFIG_SLIDING_WINDOW_SIZE | (LINK_CONFIG_OOF_FLOW_CONTROL << 3) | (LINK_CONFIG_DATA_INTEGRITY_CHECK << 4) | (LINK_CONFIG_VERSION_NR << 5))
+#define LINK_CONFIG_FIELD(window_size) ((window_size) | (LINK_CONFIG_OOF_FLOW_CONTROL << 3) | (LINK_CONFIG_DATA_INTEGRITY_CHECK << 4) | (LINK_CONFIG_VERSION_NR << 5))
 
 // periodic sending during link establishment
 #define LINK_PERIOD_MS 250
@@ -100,11 +108,8 @@ typedef enum {
 // ---
 static const uint8_t link_control_sync[] =   { 0x01, 0x7e};
 static const uint8_t link_control_sync_response[] = { 0x02, 0x7d};
-static const uint8_t link_control_config[] = { 0x03, 0xfc, LINK_CONFIG_FIELD};
-static const uint8_t link_control_config_prefix_len  = 2;
-static const uint8_t link_control_config_response_empty[] = { 0x04, 0x7b};
-static const uint8_t link_control_config_response[] = { 0x04, 0x7b, LINK_CONFIG_FIELD};
-static const uint8_t link_control_config_response_prefix_len  = 2;
+static const uint8_t link_control_config[] = { 0x03, 0xfc};              // + optional config field
+static const uint8_t link_control_config_response[] = { 0x04, 0x7b};     // + optional config field
 static const uint8_t link_control_wakeup[] = { 0x05, 0xfa};
 static const uint8_t link_control_woken[] =  { 0x06, 0xf9};
 static const uint8_t link_control_sleep[] =  { 0x07, 0x78};
@@ -129,15 +134,31 @@ static uint8_t  link_ack_nr;
 static uint16_t link_resend_timeout_ms;
 static uint8_t  link_peer_asleep;
 static uint8_t  link_peer_supports_data_integrity_check;
+static uint8_t  link_window_size;           // negotiated
+static uint8_t  link_window_size_offered = HCI_TRANSPORT_H5_MAX_WINDOW_SIZE;
 
 // auto sleep-mode
 static btstack_timer_source_t inactivity_timer;
 static uint16_t link_inactivity_timeout_ms; // auto-sleep if set
 
-// Outgoing packet
-static uint8_t   hci_packet_type;
-static uint16_t  hci_packet_size;
-static uint8_t * hci_packet;
+// Outgoing reliable packets, waiting for acknowledgement
+typedef struct {
+    uint8_t * packet;
+    uint16_t  size;
+    uint8_t   type;
+} hci_transport_link_packet_t;
+
+static hci_transport_link_packet_t link_window[HCI_TRANSPORT_H5_MAX_WINDOW_SIZE];
+static uint8_t link_window_head;    // index of oldest unacknowledged packet, which has sequence nr link_seq_nr
+static uint8_t link_window_count;   // number of unacknowledged packets
+static uint8_t link_window_sent;    // number of unacknowledged packets sent since last (re-)transmission started
+
+#if HCI_TRANSPORT_H5_MAX_WINDOW_SIZE > 1
+static uint8_t link_window_buffer[HCI_TRANSPORT_H5_MAX_WINDOW_SIZE][HCI_PACKET_BUFFER_SIZE];
+#endif
+
+// HCI_EVENT_TRANSPORT_PACKET_SENT not emitted yet for last packet from upper stack
+static int hci_packet_sent_pending;
 
 // hci packet handler
 static  void (*packet_handler)(uint8_t packet_type, uint8_t *packet, uint16_t size);
@@ -213,8 +234,8 @@ static void hci_transport_inactivity_timeout_handler(btstack_timer_source_t * ts
 static void hci_transport_inactivity_timer_set(void){
     if (!link_inactivity_timeout_ms) return;
     btstack_run_loop_set_timer_handler(&inactivity_timer, &hci_transport_inactivity_timeout_handler);
-    btstack_run_loop_set_timer(&inactivity_timer, link_inactivity_timeout_ms);
     btstack_run_loop_remove_timer(&inactivity_timer);
+    btstack_run_loop_set_timer(&inactivity_timer, link_inactivity_timeout_ms);
     btstack_run_loop_add_timer(&inactivity_timer);
 }
 
@@ -321,18 +342,24 @@ static void hci_transport_link_send_sync_response(void){
 }
 
 static void hci_transport_link_send_config(void){
-    log_debug("link send config");
-    hci_transport_link_send_control(link_control_config, sizeof(link_control_config));
+    log_debug("link send config, window size %u", link_window_size_offered);
+    uint8_t message[3];
+    memcpy(message, link_control_config, sizeof(link_control_config));
+    message[2] = LINK_CONFIG_FIELD(link_window_size_offered);
+    hci_transport_link_send_control(message, sizeof(message));
 }
 
 static void hci_transport_link_send_config_response(void){
     log_debug("link send config response");
-    hci_transport_link_send_control(link_control_config_response, sizeof(link_control_config_response));
+    uint8_t message[3];
+    memcpy(message, link_control_config_response, sizeof(link_control_config_response));
+    message[2] = LINK_CONFIG_FIELD(link_window_size_offered);
+    hci_transport_link_send_control(message, sizeof(message));
 }
 
 static void hci_transport_link_send_config_response_empty(void){
     log_debug("link send config response empty");
-    hci_transport_link_send_control(link_control_config_response_empty, sizeof(link_control_config_response_empty));
+    hci_transport_link_send_control(link_control_config_response, sizeof(link_control_config_response));
 }
 
 static void hci_transport_link_send_woken(void){
@@ -350,19 +377,24 @@ static void hci_transport_link_send_sleep(void){
     hci_transport_link_send_control(link_control_sleep, sizeof(link_control_sleep));
 }
 
+// send next packet from window, packets are re-transmitted in order starting with the oldest one
 static void hci_transport_link_send_queued_packet(void){
 
+    hci_transport_link_packet_t * link_packet = &link_window[(link_window_head + link_window_sent) % HCI_TRANSPORT_H5_MAX_WINDOW_SIZE];
+    uint8_t seq_nr = (link_seq_nr + link_window_sent) & 0x07;
+    link_window_sent++;
+
     uint8_t header[4];
-    hci_transport_link_calc_header(header, link_seq_nr, link_ack_nr, link_peer_supports_data_integrity_check, 1, hci_packet_type, hci_packet_size);
+    hci_transport_link_calc_header(header, seq_nr, link_ack_nr, link_peer_supports_data_integrity_check, 1, link_packet->type, link_packet->size);
 
     uint16_t data_integrity_check = 0;
     if (link_peer_supports_data_integrity_check){
-        data_integrity_check = crc16_calc_for_slip_frame(header, hci_packet, hci_packet_size);
+        data_integrity_check = crc16_calc_for_slip_frame(header, link_packet->packet, link_packet->size);
     }
-    log_debug("hci_transport_link_send_queued_packet: seq %u, ack %u, size %u. Append dic %u, dic = 0x%04x", link_seq_nr, link_ack_nr, hci_packet_size, link_peer_supports_data_integrity_check, data_integrity_check);
-    log_debug_hexdump(hci_packet, hci_packet_size);
+    log_debug("hci_transport_link_send_queued_packet: seq %u, ack %u, size %u. Append dic %u, dic = 0x%04x", seq_nr, link_ack_nr, link_packet->size, link_peer_supports_data_integrity_check, data_integrity_check);
+    log_debug_hexdump(link_packet->packet, link_packet->size);
 
-    hci_transport_slip_send_frame(header, hci_packet, hci_packet_size, data_integrity_check);
+    hci_transport_slip_send_frame(header, link_packet->packet, link_packet->size, data_integrity_check);
 
     // reset inactvitiy timer
     hci_transport_inactivity_timer_set();
@@ -417,10 +449,15 @@ static void hci_transport_link_run(void){
         return;
     }
     if (hci_transport_link_actions & HCI_TRANSPORT_LINK_SEND_QUEUED_PACKET){
-        hci_transport_link_actions &= ~HCI_TRANSPORT_LINK_SEND_QUEUED_PACKET;
         // packet already contains ack, no need to send addtitional one
         hci_transport_link_actions &= ~HCI_TRANSPORT_LINK_SEND_ACK_PACKET;
-        hci_transport_link_send_queued_packet();
+        if (link_window_sent < link_window_count){
+            hci_transport_link_send_queued_packet();
+        }
+        // more packets in window to send?
+        if (link_window_sent >= link_window_count){
+            hci_transport_link_actions &= ~HCI_TRANSPORT_LINK_SEND_QUEUED_PACKET;
+        }
         return;
     }
     if (hci_transport_link_actions & HCI_TRANSPORT_LINK_SEND_ACK_PACKET){
@@ -439,6 +476,7 @@ static void hci_transport_link_run(void){
 
 static void hci_transport_link_set_timer(uint16_t timeout_ms){
     btstack_run_loop_set_timer_handler(&link_timer, &hci_transport_link_timeout_handler);
+    btstack_run_loop_remove_timer(&link_timer);
     btstack_run_loop_set_timer(&link_timer, timeout_ms);
     btstack_run_loop_add_timer(&link_timer);
 }
@@ -463,7 +501,9 @@ static void hci_transport_link_timeout_handler(btstack_timer_source_t * timer){
                 hci_transport_link_set_timer(LINK_WAKEUP_MS);
                 return;
             }
-            // resend packet
+            // resend all unacknowledged packets
+            log_info("h5 resend %u packet(s) starting with seq nr %u", link_window_count, link_seq_nr);
+            link_window_sent = 0;
             hci_transport_link_actions |= HCI_TRANSPORT_LINK_SEND_QUEUED_PACKET;
             hci_transport_link_set_timer(link_resend_timeout_ms);
             break;
@@ -478,6 +518,7 @@ static void hci_transport_link_init(void){
     link_state = LINK_UNINITIALIZED;
     link_peer_asleep = 0;
     link_peer_supports_data_integrity_check = 0;
+    link_window_size = 1;
  
     // get started
     hci_transport_link_actions |= HCI_TRANSPORT_LINK_SEND_SYNC;
@@ -490,18 +531,64 @@ static int hci_transport_link_inc_seq_nr(int seq_nr){
 }
 
 static int hci_transport_link_have_outgoing_packet(void){
-    return hci_packet != 0;
+    return link_window_count != 0;
 }
 
 static void hci_transport_link_clear_queue(void){
     btstack_run_loop_remove_timer(&link_timer);
-    hci_packet = NULL;
+    link_window_head  = 0;
+    link_window_count = 0;
+    link_window_sent  = 0;
+    hci_packet_sent_pending = 0;
 }
 
 static void hci_transport_h5_queue_packet(uint8_t packet_type, uint8_t *packet, int size){
-    hci_packet = packet;
-    hci_packet_type = packet_type;
-    hci_packet_size = size;
+    hci_transport_link_packet_t * link_packet = &link_window[(link_window_head + link_window_count) % HCI_TRANSPORT_H5_MAX_WINDOW_SIZE];
+#if HCI_TRANSPORT_H5_MAX_WINDOW_SIZE > 1
+    // keep copy for re-transmission as upper stack can re-use buffer after HCI_EVENT_TRANSPORT_PACKET_SENT
+    if (link_window_size > 1){
+        uint8_t * buffer = link_window_buffer[(link_window_head + link_window_count) % HCI_TRANSPORT_H5_MAX_WINDOW_SIZE];
+        memcpy(buffer, packet, size);
+        packet = buffer;
+    }
+#endif
+    link_packet->packet = packet;
+    link_packet->type   = packet_type;
+    link_packet->size   = size;
+    link_window_count++;
+    hci_packet_sent_pending = 1;
+}
+
+// upper stack can send next packet if its buffer was copied or acknowledged and there's room in the window
+static void hci_transport_link_emit_packet_sent_if_ready(void){
+    if (!hci_packet_sent_pending) return;
+    if (link_window_count >= link_window_size) return;
+    hci_packet_sent_pending = 0;
+    uint8_t event[] = { HCI_EVENT_TRANSPORT_PACKET_SENT, 0};
+    packet_handler(HCI_EVENT_PACKET, &event[0], sizeof(event));
+}
+
+// cumulative acknowledgement: ack_nr is the next sequence number expected by the peer
+static void hci_transport_link_process_ack(uint8_t ack_nr){
+    int num_acked = (ack_nr - link_seq_nr) & 0x07;
+    if (num_acked == 0) return;
+    if (num_acked > link_window_count){
+        log_info("ack nr %u out of window (seq nr %u, %u unacknowledged)", ack_nr, link_seq_nr, link_window_count);
+        return;
+    }
+    log_debug("outgoing packets with seq %u..%u ack'ed", link_seq_nr, (ack_nr - 1) & 0x07);
+    link_seq_nr       = ack_nr;
+    link_window_head  = (link_window_head + num_acked) % HCI_TRANSPORT_H5_MAX_WINDOW_SIZE;
+    link_window_count -= num_acked;
+    link_window_sent  = (link_window_sent > num_acked) ? (link_window_sent - num_acked) : 0;
+
+    // restart resend timer for remaining packets
+    btstack_run_loop_remove_timer(&link_timer);
+    if (link_window_count){
+        hci_transport_link_set_timer(link_resend_timeout_ms);
+    }
+
+    hci_transport_link_emit_packet_sent_if_ready();
 }
 
 static void hci_transport_h5_emit_sleep_state(int sleep_active){
@@ -596,8 +683,8 @@ static void hci_transport_h5_process_frame(uint16_t frame_size){
                 hci_transport_link_actions |= HCI_TRANSPORT_LINK_SEND_SYNC_RESPONSE;
                 break;
             }
-            if (memcmp(slip_payload, link_control_config, link_control_config_prefix_len) == 0){
-                if (link_payload_len == link_control_config_prefix_len){
+            if (memcmp(slip_payload, link_control_config, sizeof(link_control_config)) == 0){
+                if (link_payload_len == sizeof(link_control_config)){
                     log_debug("link received config, no config field");
                     hci_transport_link_actions |= HCI_TRANSPORT_LINK_SEND_CONFIG_RESPONSE_EMPTY;
                 } else {
@@ -606,10 +693,22 @@ static void hci_transport_h5_process_frame(uint16_t frame_size){
                 }
                 break;
             }
-            if (memcmp(slip_payload, link_control_config_response, link_control_config_response_prefix_len) == 0){
-                uint8_t config = slip_payload[2];
+            if (memcmp(slip_payload, link_control_config_response, sizeof(link_control_config_response)) == 0){
+                // no config field: sliding window 1, no data integrity check
+                uint8_t config = 0x01;
+                if (link_payload_len > sizeof(link_control_config_response)){
+                    config = slip_payload[2];
+                }
                 link_peer_supports_data_integrity_check = (config & 0x10) != 0;
-                log_info("link received config response 0x%02x, data integrity check supported %u", config, link_peer_supports_data_integrity_check);
+                // use smaller window size
+                link_window_size = config & 0x07;
+                if (link_window_size > link_window_size_offered) {
+                    link_window_size = link_window_size_offered;
+                }
+                if (link_window_size == 0){
+                    link_window_size = 1;
+                }
+                log_info("link received config response 0x%02x, data integrity check supported %u, sliding window size %u", config, link_peer_supports_data_integrity_check, link_window_size);
                 link_state = LINK_ACTIVE;
                 btstack_run_loop_remove_timer(&link_timer);
                 log_info("link activated");
@@ -638,23 +737,16 @@ static void hci_transport_h5_process_frame(uint16_t frame_size){
 
             // Process ACKs in reliable packet and explicit ack packets
             if (reliable_packet || link_packet_type == LINK_ACKNOWLEDGEMENT_TYPE){
-                // our packet is good if the remote expects our seq nr + 1
-                int next_seq_nr = hci_transport_link_inc_seq_nr(link_seq_nr);
-                if (hci_transport_link_have_outgoing_packet() && next_seq_nr == ack_nr){
-                    log_debug("outoing packet with seq %u ack'ed", link_seq_nr);
-                    link_seq_nr = next_seq_nr;
-                    hci_transport_link_clear_queue();
-
-                    // notify upper stack that it can send again
-                    uint8_t event[] = { HCI_EVENT_TRANSPORT_PACKET_SENT, 0};
-                    packet_handler(HCI_EVENT_PACKET, &event[0], sizeof(event));
+                // all our packets up to the one before the seq nr expected by the remote are good
+                if (hci_transport_link_have_outgoing_packet()){
+                    hci_transport_link_process_ack(ack_nr);
                 }
             } 
 
             switch (link_packet_type){
                 case LINK_CONTROL_PACKET_TYPE:
                     if (memcmp(slip_payload, link_control_config, sizeof(link_control_config)) == 0){
-                        if (link_payload_len == link_control_config_prefix_len){
+                        if (link_payload_len == sizeof(link_control_config)){
                             log_debug("link received config, no config field");
                             hci_transport_link_actions |= HCI_TRANSPORT_LINK_SEND_CONFIG_RESPONSE_EMPTY;
                         } else {
@@ -738,7 +830,7 @@ static void hci_transport_h5_read_next_byte(void){
 
 // track time receiving SLIP frame
 static uint32_t hci_transport_h5_receive_start;
-static void hci_transport_h5_block_received(){
+static void hci_transport_h5_block_received(void){
     // track start time when receiving first byte // a bit hackish
     if (hci_transport_h5_receive_start == 0 && hci_transport_link_read_byte != BTSTACK_SLIP_SOF){
         hci_transport_h5_receive_start = btstack_run_loop_get_time_ms();
@@ -782,6 +874,9 @@ static void hci_transport_h5_block_sent(void){
         hci_transport_h5_emit_sleep_state(1);
     }
 
+    // with sliding window > 1, upper stack can send next packet as soon as previous one was copied and sent
+    hci_transport_link_emit_packet_sent_if_ready();
+
     hci_transport_link_run();
 }
 
@@ -857,7 +952,7 @@ static void hci_transport_h5_register_packet_handler(void (*handler)(uint8_t pac
 }
 
 static int hci_transport_h5_can_send_packet_now(uint8_t packet_type){
-    int res = !hci_transport_link_have_outgoing_packet() && link_state == LINK_ACTIVE;
+    int res = link_state == LINK_ACTIVE && !hci_packet_sent_pending && link_window_count < link_window_size;
     // log_info("can_send_packet_now: %u", res);
     return res;
 }
@@ -867,6 +962,10 @@ static int hci_transport_h5_send_packet(uint8_t packet_type, uint8_t *packet, in
         log_error("hci_transport_h5_send_packet called but in state %d", link_state);
         return -1;
     }
+    if (size > HCI_PACKET_BUFFER_SIZE){
+        log_error("hci_transport_h5_send_packet: size %u > HCI_PACKET_BUFFER_SIZE", size);
+        return -1;
+    }
 
     // store request
     hci_transport_h5_queue_packet(packet_type, packet, size);
@@ -882,7 +981,10 @@ static int hci_transport_h5_send_packet(uint8_t packet_type, uint8_t *packet, in
         hci_transport_link_set_timer(LINK_WAKEUP_MS);
     } else {
         hci_transport_link_actions |= HCI_TRANSPORT_LINK_SEND_QUEUED_PACKET;
-        hci_transport_link_set_timer(link_resend_timeout_ms);
+        // start resend timer for first packet in window
+        if (link_window_count == 1){
+            hci_transport_link_set_timer(link_resend_timeout_ms);
+        }
     }
     hci_transport_link_run();
     return 0;
@@ -935,6 +1037,17 @@ void hci_transport_h5_set_auto_sleep(uint16_t inactivity_timeout_ms){
     link_inactivity_timeout_ms = inactivity_timeout_ms;
 }
 
+void hci_transport_h5_set_sliding_window_size(uint8_t window_size){
+    if (window_size < 1){
+        window_size = 1;
+    }
+    if (window_size > HCI_TRANSPORT_H5_MAX_WINDOW_SIZE){
+        log_info("sliding window size %u > HCI_TRANSPORT_H5_MAX_WINDOW_SIZE", window_size);
+        window_size = HCI_TRANSPORT_H5_MAX_WINDOW_SIZE;
+    }
+    link_window_size_offered = window_size;
+}
+
 void hci_transport_h5_enable_bcsp_mode(void){
     hci_transport_bcsp_mode = 1;
 }
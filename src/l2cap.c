@@ -58,6 +58,7 @@
 #endif
 
 #include <stdarg.h>
+#include <stddef.h>
 #include <string.h>
 
 #include <stdio.h>
@@ -72,6 +73,9 @@
 #define L2CAP_LE_DATA_CHANNELS_AUTOMATIC_CREDITS_WATERMARK 5
 #define L2CAP_LE_DATA_CHANNELS_AUTOMATIC_CREDITS_INCREMENT 5
 
+// minimal MPS for LE Data Channels
+#define L2CAP_LE_DATA_CHANNELS_MIN_MPS 23
+
 // offsets for L2CAP SIGNALING COMMANDS
 #define L2CAP_SIGNALING_COMMAND_CODE_OFFSET   0
 #define L2CAP_SIGNALING_COMMAND_SIGID_OFFSET  1
@@ -88,6 +92,8 @@
 #define L2CAP_USES_CHANNELS
 #endif
 
+#define L2CAP_CHANNEL_INDEX_MASK (L2CAP_CHANNEL_INDEX_SIZE - 1)
+
 // prototypes
 static void l2cap_run(void);
 static void l2cap_hci_event_handler(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size);
@@ -109,14 +115,19 @@ static void l2cap_emit_le_channel_opened(l2cap_channel_t *channel, uint8_t statu
 static void l2cap_emit_le_incoming_connection(l2cap_channel_t *channel);
 static l2cap_channel_t * l2cap_le_get_channel_for_local_cid(uint16_t local_cid);
 static void l2cap_le_notify_channel_can_send(l2cap_channel_t *channel);
+static uint16_t l2cap_le_local_mps(l2cap_channel_t *channel);
+static void l2cap_le_apply_credit_policy(l2cap_channel_t *channel);
 static void l2cap_le_finialize_channel_close(l2cap_channel_t *channel);
 static inline l2cap_service_t * l2cap_le_get_service(uint16_t psm);
 #endif
 #ifdef L2CAP_USES_CHANNELS
 static void l2cap_dispatch_to_channel(l2cap_channel_t *channel, uint8_t type, uint8_t * data, uint16_t size);
 static l2cap_channel_t * l2cap_get_channel_for_local_cid(uint16_t local_cid);
-static l2cap_channel_t * l2cap_create_channel_entry(btstack_packet_handler_t packet_handler, bd_addr_t address, bd_addr_type_t address_type, 
+static l2cap_channel_t * l2cap_create_channel_entry(btstack_packet_handler_t packet_handler, l2cap_channel_type_t channel_type, bd_addr_t address, bd_addr_type_t address_type, 
         uint16_t psm, uint16_t local_mtu, gap_security_level_t security_level);
+static void l2cap_channel_add(btstack_linked_list_t * channels, l2cap_channel_t * channel);
+static void l2cap_channel_remove(btstack_linked_list_t * channels, l2cap_channel_t * channel);
+static void l2cap_channel_set_con_handle(l2cap_channel_t * channel, hci_con_handle_t con_handle);
 #endif
 #ifdef ENABLE_L2CAP_ENHANCED_RETRANSMISSION_MODE
 static void l2cap_ertm_notify_channel_can_send(l2cap_channel_t * channel);
@@ -138,6 +149,12 @@ static uint8_t require_security_level2_for_outgoing_sdp;
 #ifdef ENABLE_LE_DATA_CHANNELS
 static btstack_linked_list_t l2cap_le_channels;
 static btstack_linked_list_t l2cap_le_services;
+static uint16_t              l2cap_le_custom_mps;
+#endif
+
+#ifdef L2CAP_USES_CHANNELS
+// classic and LE channels by local CID, linked via l2cap_channel_t.index_item, bucket = local_cid & L2CAP_CHANNEL_INDEX_MASK
+static btstack_linked_list_t l2cap_channel_index[L2CAP_CHANNEL_INDEX_SIZE];
 #endif
 
 // used to cache l2cap rejects, echo, and informational requests
@@ -197,12 +214,8 @@ static int l2cap_next_ertm_seq_nr(int seq_nr){
 }
 
 static int l2cap_ertm_can_store_packet_now(l2cap_channel_t * channel){
-     // get num free tx buffers
-    int num_tx_buffers_used = channel->tx_write_index - channel->tx_read_index;
-    if (num_tx_buffers_used < 0){
-        num_tx_buffers_used += channel->num_tx_buffers;
-    }
-    int num_free_tx_buffers = channel->num_tx_buffers - num_tx_buffers_used;
+    // get num free tx buffers
+    int num_free_tx_buffers = channel->num_tx_buffers - channel->num_stored_frames;
     // calculate num tx buffers for remote MTU
     int num_tx_buffers_for_max_remote_mtu;
     if (channel->remote_mtu <= channel->remote_mps){
@@ -221,6 +234,18 @@ static void l2cap_ertm_next_tx_write_index(l2cap_channel_t * channel){
     channel->tx_write_index = 0;
 }
 
+static void l2cap_ertm_next_tx_send_index(l2cap_channel_t * channel){
+    channel->tx_send_index++;
+    if (channel->tx_send_index < channel->num_tx_buffers) return;
+    channel->tx_send_index = 0;
+}
+
+// restart transmission with oldest unacknowledged I-Frame
+static void l2cap_ertm_retransmit_unacknowleged_frames(l2cap_channel_t * channel){
+    channel->tx_send_index  = channel->tx_read_index;
+    channel->unacked_frames = 0;
+}
+
 static void l2cap_ertm_start_monitor_timer(l2cap_channel_t * channel){
     log_info("Start Monitor timer");
     btstack_run_loop_remove_timer(&channel->monitor_timer);
@@ -299,7 +324,18 @@ static int l2cap_ertm_send_information_frame(l2cap_channel_t * channel, int inde
     uint16_t control = l2cap_encanced_control_field_for_information_frame(tx_state->tx_seq, final, channel->req_seq, tx_state->sar);
     log_info("I-Frame: control 0x%04x", control);
     little_endian_store_16(acl_buffer, 8, control);
-    memcpy(&acl_buffer[8+2], &channel->tx_packets_data[index * channel->local_mtu], tx_state->len);
+    memcpy(&acl_buffer[8+2], &channel->tx_packets_data[index * channel->local_mps], tx_state->len);
+    // I-Frame acknowledges received I-Frames up to req_seq, RR not needed anymore
+    if (channel->send_supervisor_frame_receiver_ready){
+        channel->send_supervisor_frame_receiver_ready = 0;
+        channel->ertm_stats.acks_piggybacked++;
+    }
+    // stats
+    tx_state->num_transmissions++;
+    channel->ertm_stats.i_frames_sent++;
+    if (tx_state->num_transmissions > 1){
+        channel->ertm_stats.retransmissions++;
+    }
     // (re-)start retransmission timer on 
     l2cap_ertm_start_retransmission_timer(channel);
     // send
@@ -312,20 +348,22 @@ static void l2cap_ertm_store_fragment(l2cap_channel_t * channel, l2cap_segmentat
 
     l2cap_ertm_tx_packet_state_t * tx_state = &channel->tx_packets_state[index];
     tx_state->tx_seq = channel->next_tx_seq;
-    tx_state->len = len;
     tx_state->sar = sar;
     tx_state->retry_count = 0;
+    tx_state->num_transmissions = 0;
 
-    uint8_t * tx_packet = &channel->tx_packets_data[index * channel->local_mtu];
+    uint8_t * tx_packet = &channel->tx_packets_data[index * channel->local_mps];
     int pos = 0;
     if (sar == L2CAP_SEGMENTATION_AND_REASSEMBLY_START_OF_L2CAP_SDU){
         little_endian_store_16(tx_packet, 0, sdu_length);
         pos += 2;
     }
     memcpy(&tx_packet[pos], data, len);
+    tx_state->len = pos + len;
 
     // update
     channel->next_tx_seq = l2cap_next_ertm_seq_nr(channel->next_tx_seq);
+    channel->num_stored_frames++;
     l2cap_ertm_next_tx_write_index(channel);
 
     log_info("l2cap_ertm_store_fragment: after store, tx_read_index %u, tx_write_index %u", channel->tx_read_index, channel->tx_write_index);
@@ -338,6 +376,11 @@ static int l2cap_ertm_send(l2cap_channel_t * channel, uint8_t * data, uint16_t l
         return L2CAP_DATA_LEN_EXCEEDS_REMOTE_MTU;
     }
 
+    if (!l2cap_ertm_can_store_packet_now(channel)){
+        log_info("l2cap_send cid 0x%02x, cannot send", channel->local_cid);
+        return BTSTACK_ACL_BUFFERS_FULL;
+    }
+
     // check if it needs to get fragmented
     if (len > channel->remote_mps){
         // fragmentation needed.
@@ -348,6 +391,7 @@ static int l2cap_ertm_send(l2cap_channel_t * channel, uint8_t * data, uint16_t l
                 case L2CAP_SEGMENTATION_AND_REASSEMBLY_START_OF_L2CAP_SDU:
                     chunk_len = channel->remote_mps - 2;    // sdu_length
                     l2cap_ertm_store_fragment(channel, sar, len, data, chunk_len);
+                    data += chunk_len;
                     len -= chunk_len;
                     sar = L2CAP_SEGMENTATION_AND_REASSEMBLY_CONTINUATION_OF_L2CAP_SDU;
                     break;
@@ -358,6 +402,7 @@ static int l2cap_ertm_send(l2cap_channel_t * channel, uint8_t * data, uint16_t l
                         chunk_len = len;                       
                     }
                     l2cap_ertm_store_fragment(channel, sar, len, data, chunk_len);
+                    data += chunk_len;
                     len -= chunk_len;
                     break;
                 default:
@@ -410,6 +455,7 @@ static int l2cap_ertm_send_supervisor_frame(l2cap_channel_t * channel, uint16_t
     uint8_t *acl_buffer = hci_get_outgoing_packet_buffer();
     log_info("S-Frame: control 0x%04x", control);
     little_endian_store_16(acl_buffer, 8, control);
+    channel->ertm_stats.s_frames_sent++;
     return l2cap_send_prepared(channel->local_cid, 2);
 }
 
@@ -453,6 +499,7 @@ static void l2cap_ertm_configure_channel(l2cap_channel_t * channel, l2cap_ertm_c
     channel->local_mtu = ertm_config->local_mtu;
     channel->num_rx_buffers = ertm_config->num_rx_buffers;
     channel->num_tx_buffers = ertm_config->num_tx_buffers;
+    memset(&channel->ertm_stats, 0, sizeof(l2cap_ertm_stats_t));
 
     // align buffer to 16-byte boundary, just in case
     int bytes_till_alignment = 16 - (((uintptr_t) buffer) & 0x0f);
@@ -487,7 +534,7 @@ uint8_t l2cap_create_ertm_channel(btstack_packet_handler_t packet_handler, bd_ad
     uint8_t result = l2cap_ertm_validate_local_config(ertm_config);
     if (result) return result;
 
-    l2cap_channel_t * channel = l2cap_create_channel_entry(packet_handler, address, BD_ADDR_TYPE_CLASSIC, psm, ertm_config->local_mtu, LEVEL_0);
+    l2cap_channel_t * channel = l2cap_create_channel_entry(packet_handler, L2CAP_CHANNEL_TYPE_CLASSIC, address, BD_ADDR_TYPE_CLASSIC, psm, ertm_config->local_mtu, LEVEL_0);
     if (!channel) {
         return BTSTACK_MEMORY_ALLOC_FAILED;
     }
@@ -496,7 +543,7 @@ uint8_t l2cap_create_ertm_channel(btstack_packet_handler_t packet_handler, bd_ad
     l2cap_ertm_configure_channel(channel, ertm_config, buffer, size);
 
     // add to connections list
-    btstack_linked_list_add(&l2cap_channels, (btstack_linked_item_t *) channel);
+    l2cap_channel_add(&l2cap_channels, channel);
 
     // store local_cid
     if (out_local_cid){
@@ -520,6 +567,7 @@ uint8_t l2cap_create_ertm_channel(btstack_packet_handler_t packet_handler, bd_ad
 }
 
 static void l2cap_ertm_notify_channel_can_send(l2cap_channel_t * channel){
+    if (!channel->waiting_for_can_send_now) return;
     if (l2cap_ertm_can_store_packet_now(channel)){
         channel->waiting_for_can_send_now = 0;
         l2cap_emit_can_send_now(channel->packet_handler, channel->local_cid);
@@ -579,19 +627,22 @@ uint8_t l2cap_ertm_set_ready(uint16_t local_cid){
     return ERROR_CODE_SUCCESS;
 }
 
+uint8_t l2cap_ertm_get_stats(uint16_t local_cid, l2cap_ertm_stats_t * stats){
+    l2cap_channel_t * channel = l2cap_get_channel_for_local_cid( local_cid);
+    if (!channel) {
+        log_error( "l2cap_ertm_get_stats called but local_cid 0x%x not found", local_cid);
+        return L2CAP_LOCAL_CID_DOES_NOT_EXIST;
+    }
+    memcpy(stats, &channel->ertm_stats, sizeof(l2cap_ertm_stats_t));
+    return ERROR_CODE_SUCCESS;
+}
+
 // Process-ReqSeq
 static void l2cap_ertm_process_req_seq(l2cap_channel_t * l2cap_channel, uint8_t req_seq){
     int num_buffers_acked = 0;
     l2cap_ertm_tx_packet_state_t * tx_state;
     log_info("l2cap_ertm_process_req_seq: tx_read_index %u, tx_write_index %u, req_seq %u", l2cap_channel->tx_read_index, l2cap_channel->tx_write_index, req_seq);
-    while (1){
-
-        // no unack packets left
-        if (l2cap_channel->unacked_frames == 0) {
-            // stop retransmission timer
-            l2cap_ertm_stop_retransmission_timer(l2cap_channel);
-            break;
-        }
+    while (l2cap_channel->num_stored_frames){
 
         tx_state = &l2cap_channel->tx_packets_state[l2cap_channel->tx_read_index];
         // calc delta
@@ -600,16 +651,29 @@ static void l2cap_ertm_process_req_seq(l2cap_channel_t * l2cap_channel, uint8_t
         if (delta > l2cap_channel->remote_tx_window_size) break;   
 
         num_buffers_acked++;
-        l2cap_channel->unacked_frames--;
+        l2cap_channel->num_stored_frames--;
+        if (l2cap_channel->unacked_frames){
+            l2cap_channel->unacked_frames--;
+        } else {
+            // frame was scheduled for retransmission but got acknowledged before
+            l2cap_ertm_next_tx_send_index(l2cap_channel);
+        }
         log_info("RR seq %u => packet with tx_seq %u done", req_seq, tx_state->tx_seq);
 
         l2cap_channel->tx_read_index++;
-        if (l2cap_channel->tx_read_index >= l2cap_channel->num_rx_buffers){
+        if (l2cap_channel->tx_read_index >= l2cap_channel->num_tx_buffers){
             l2cap_channel->tx_read_index = 0;
         }
     }
 
+    // no unack packets left
+    if (l2cap_channel->unacked_frames == 0) {
+        // stop retransmission timer
+        l2cap_ertm_stop_retransmission_timer(l2cap_channel);
+    }
+
     if (num_buffers_acked){
+        l2cap_channel->tx_window_stalled = 0;
         l2cap_ertm_notify_channel_can_send(l2cap_channel);
     }
 }     
@@ -629,7 +693,7 @@ static void l2cap_ertm_handle_out_of_sequence_sdu(l2cap_channel_t * l2cap_channe
     log_info("Store SDU with delta %u", delta);
     // get rx state for packet to store
     int index = l2cap_channel->rx_store_index + delta - 1;
-    if (index > l2cap_channel->num_rx_buffers){
+    if (index >= l2cap_channel->num_rx_buffers){
         index -= l2cap_channel->num_rx_buffers;
     }
     log_info("Index of packet to store %u", index);
@@ -642,7 +706,7 @@ static void l2cap_ertm_handle_out_of_sequence_sdu(l2cap_channel_t * l2cap_channe
     rx_state->valid = 1;
     rx_state->sar = sar;
     rx_state->len = size;
-    uint8_t * rx_buffer = &l2cap_channel->rx_packets_data[index];
+    uint8_t * rx_buffer = &l2cap_channel->rx_packets_data[index * l2cap_channel->local_mps];
     memcpy(rx_buffer, payload, size);
 }
 
@@ -735,6 +799,11 @@ void l2cap_init(void){
 #ifdef ENABLE_LE_DATA_CHANNELS
     l2cap_le_services = NULL;
     l2cap_le_channels = NULL;
+    l2cap_le_custom_mps = 0;
+#endif
+
+#ifdef L2CAP_USES_CHANNELS
+    memset(l2cap_channel_index, 0, sizeof(l2cap_channel_index));
 #endif
 
 #ifdef ENABLE_BLE
@@ -861,6 +930,78 @@ static void l2cap_emit_simple_event_with_cid(l2cap_channel_t * channel, uint8_t
     hci_dump_packet( HCI_EVENT_PACKET, 0, event, sizeof(event));
     l2cap_dispatch_to_channel(channel, HCI_EVENT_PACKET, event, sizeof(event));
 }
+
+static inline l2cap_channel_t * l2cap_channel_for_index_item(btstack_linked_item_t * item){
+    return (l2cap_channel_t *) (((uint8_t *) item) - offsetof(l2cap_channel_t, index_item));
+}
+
+static l2cap_channel_t * l2cap_channel_index_lookup(uint16_t local_cid){
+    btstack_linked_item_t * item;
+    for (item = l2cap_channel_index[local_cid & L2CAP_CHANNEL_INDEX_MASK]; item ; item = item->next){
+        l2cap_channel_t * channel = l2cap_channel_for_index_item(item);
+        if (channel->local_cid == local_cid) return channel;
+    }
+    return NULL;
+}
+
+static uint16_t l2cap_allocate_local_cid(void){
+    // consecutive CIDs are spread evenly over the index. skip reserved CIDs after wrap-around and CIDs still in use
+    uint16_t local_cid;
+    do {
+        local_cid = l2cap_next_local_cid();
+    } while (local_cid < 0x40 || l2cap_channel_index_lookup(local_cid));
+    return local_cid;
+}
+
+static l2cap_channel_t * l2cap_channel_lookup(l2cap_channel_type_t channel_type, uint16_t local_cid){
+    l2cap_channel_t * channel = l2cap_channel_index_lookup(local_cid);
+    if (!channel) return NULL;
+    // local CIDs are unique across classic and LE channels
+    if (channel->channel_type != channel_type) return NULL;
+    return channel;
+}
+
+static void l2cap_channel_add(btstack_linked_list_t * channels, l2cap_channel_t * channel){
+    btstack_linked_list_add(channels, (btstack_linked_item_t *) channel);
+    btstack_linked_list_add(&l2cap_channel_index[channel->local_cid & L2CAP_CHANNEL_INDEX_MASK], &channel->index_item);
+}
+
+// remove channel from channel list, index, and connection. Can be used for the current item while iterating over one of these lists
+static void l2cap_channel_remove(btstack_linked_list_t * channels, l2cap_channel_t * channel){
+    btstack_linked_list_remove(channels, (btstack_linked_item_t *) channel);
+    btstack_linked_list_remove(&l2cap_channel_index[channel->local_cid & L2CAP_CHANNEL_INDEX_MASK], &channel->index_item);
+    hci_connection_t * connection = hci_connection_for_handle(channel->con_handle);
+    if (!connection) return;
+    btstack_linked_list_remove(&connection->l2cap_channels, &channel->connection_item);
+}
+
+// set con handle and add to list of channels for this connection
+static void l2cap_channel_set_con_handle(l2cap_channel_t * channel, hci_con_handle_t con_handle){
+    channel->con_handle = con_handle;
+    hci_connection_t * connection = hci_connection_for_handle(con_handle);
+    if (!connection) return;
+    btstack_linked_list_add(&connection->l2cap_channels, &channel->connection_item);
+}
+
+static inline l2cap_channel_t * l2cap_channel_for_connection_item(btstack_linked_item_t * item){
+    return (l2cap_channel_t *) (((uint8_t *) item) - offsetof(l2cap_channel_t, connection_item));
+}
+
+#ifdef ENABLE_LE_DATA_CHANNELS
+static l2cap_channel_t * l2cap_channel_for_handle_and_sig_id(hci_con_handle_t con_handle, uint8_t sig_id){
+    hci_connection_t * connection = hci_connection_for_handle(con_handle);
+    if (!connection) return NULL;
+    btstack_linked_list_iterator_t it;    
+    btstack_linked_list_iterator_init(&it, &connection->l2cap_channels);
+    while (btstack_linked_list_iterator_has_next(&it)){
+        l2cap_channel_t * channel = l2cap_channel_for_connection_item(btstack_linked_list_iterator_next(&it));
+        if (channel->local_sig_id == sig_id) {
+            return channel;
+        }
+    } 
+    return NULL;
+}
+#endif
 #endif
 
 #ifdef ENABLE_CLASSIC
@@ -906,15 +1047,7 @@ static void l2cap_emit_incoming_connection(l2cap_channel_t *channel) {
 }
 
 static l2cap_channel_t * l2cap_get_channel_for_local_cid(uint16_t local_cid){
-    btstack_linked_list_iterator_t it;    
-    btstack_linked_list_iterator_init(&it, &l2cap_channels);
-    while (btstack_linked_list_iterator_has_next(&it)){
-        l2cap_channel_t * channel = (l2cap_channel_t *) btstack_linked_list_iterator_next(&it);
-        if ( channel->local_cid == local_cid) {
-            return channel;
-        }
-    } 
-    return NULL;
+    return l2cap_channel_lookup(L2CAP_CHANNEL_TYPE_CLASSIC, local_cid);
 }
 
 ///
@@ -987,7 +1120,7 @@ static void l2cap_rtx_timeout(btstack_timer_source_t * ts){
 
     // discard channel
     // no need to stop timer here, it is removed from list during timer callback
-    btstack_linked_list_remove(&l2cap_channels, (btstack_linked_item_t *) channel);
+    l2cap_channel_remove(&l2cap_channels, channel);
     btstack_memory_l2cap_channel_free(channel);
 }
 
@@ -1341,7 +1474,7 @@ static void l2cap_run(void){
                 l2cap_send_signaling_packet(channel->con_handle, CONNECTION_RESPONSE, channel->remote_sig_id, channel->local_cid, channel->remote_cid, channel->reason, 0);
                 // discard channel - l2cap_finialize_channel_close without sending l2cap close event
                 l2cap_stop_rtx(channel);
-                btstack_linked_list_iterator_remove(&it);
+                l2cap_channel_remove(&l2cap_channels, channel);
                 btstack_memory_l2cap_channel_free(channel); 
                 break;
                 
@@ -1423,24 +1556,33 @@ static void l2cap_run(void){
         }
 
 #ifdef ENABLE_L2CAP_ENHANCED_RETRANSMISSION_MODE
-        // send s-frame to acknowledge received packets
-        if (!hci_can_send_acl_packet_now(channel->con_handle)) continue;
-
-        if (channel->tx_send_index != channel->tx_write_index){
+        // send i-frames as long as remote tx window and outgoing ACL buffers allow
+        while (channel->unacked_frames < channel->num_stored_frames){
             // check remote tx window
-            log_info("unacknowledged_packets %u, remote tx window size %u", channel->unacked_frames, channel->remote_tx_window_size);
-            if (channel->unacked_frames < channel->remote_tx_window_size){
-                channel->unacked_frames++;
-                int index = channel->tx_send_index;
-                channel->tx_send_index++;
-                if (channel->tx_send_index >= channel->num_tx_buffers){
-                    channel->tx_send_index = 0;          
+            if (channel->unacked_frames >= channel->remote_tx_window_size){
+                log_info("unacknowledged_packets %u, remote tx window size %u", channel->unacked_frames, channel->remote_tx_window_size);
+                if (!channel->tx_window_stalled){
+                    channel->tx_window_stalled = 1;
+                    channel->ertm_stats.tx_window_stalls++;
                 }
-                l2cap_ertm_send_information_frame(channel, index, 0);   // final = 0
-                continue;
+                break;
+            }
+            if (!hci_can_send_acl_packet_now(channel->con_handle)) break;
+            channel->unacked_frames++;
+            int index = channel->tx_send_index;
+            l2cap_ertm_next_tx_send_index(channel);
+            // piggyback pending RR including final bit
+            int final = 0;
+            if (channel->send_supervisor_frame_receiver_ready){
+                final = channel->set_final_bit_after_packet_with_poll_bit_set;
+                channel->set_final_bit_after_packet_with_poll_bit_set = 0;
             }
+            l2cap_ertm_send_information_frame(channel, index, final);
         }
 
+        // send s-frame to acknowledge received packets
+        if (!hci_can_send_acl_packet_now(channel->con_handle)) continue;
+
         if (channel->send_supervisor_frame_receiver_ready){
             channel->send_supervisor_frame_receiver_ready = 0;
             log_info("Send S-Frame: RR %u, final %u", channel->req_seq, channel->set_final_bit_after_packet_with_poll_bit_set);
@@ -1473,6 +1615,7 @@ static void l2cap_run(void){
         if (channel->send_supervisor_frame_selective_reject){
             channel->send_supervisor_frame_selective_reject = 0;
             log_info("Send S-Frame: SREJ %u", channel->expected_tx_seq);
+            channel->ertm_stats.srej_sent++;
             uint16_t control = l2cap_encanced_control_field_for_supevisor_frame( L2CAP_SUPERVISORY_FUNCTION_SREJ_SELECTIVE_REJECT, 0, channel->set_final_bit_after_packet_with_poll_bit_set, channel->expected_tx_seq);
             channel->set_final_bit_after_packet_with_poll_bit_set = 0;
             l2cap_ertm_send_supervisor_frame(channel, control);
@@ -1521,15 +1664,16 @@ static void l2cap_run(void){
                 channel->local_sig_id = l2cap_next_sig_id();
                 channel->credits_incoming =  channel->new_credits_incoming;
                 channel->new_credits_incoming = 0;
-                l2cap_send_le_signaling_packet( channel->con_handle, LE_CREDIT_BASED_CONNECTION_REQUEST, channel->local_sig_id, channel->psm, channel->local_cid, channel->local_mtu, 23, channel->credits_incoming);
+                channel->local_mps = l2cap_le_local_mps(channel);
+                l2cap_send_le_signaling_packet( channel->con_handle, LE_CREDIT_BASED_CONNECTION_REQUEST, channel->local_sig_id, channel->psm, channel->local_cid, channel->local_mtu, channel->local_mps, channel->credits_incoming);
                 break;
             case L2CAP_STATE_WILL_SEND_LE_CONNECTION_RESPONSE_ACCEPT:
                 if (!hci_can_send_acl_packet_now(channel->con_handle)) break;
-                // TODO: support larger MPS
                 channel->state = L2CAP_STATE_OPEN;
                 channel->credits_incoming =  channel->new_credits_incoming;
                 channel->new_credits_incoming = 0;
-                l2cap_send_le_signaling_packet(channel->con_handle, LE_CREDIT_BASED_CONNECTION_RESPONSE, channel->remote_sig_id, channel->local_cid, channel->local_mtu, 23, channel->credits_incoming, 0);
+                channel->local_mps = l2cap_le_local_mps(channel);
+                l2cap_send_le_signaling_packet(channel->con_handle, LE_CREDIT_BASED_CONNECTION_RESPONSE, channel->remote_sig_id, channel->local_cid, channel->local_mtu, channel->local_mps, channel->credits_incoming, 0);
                 // notify client
                 l2cap_emit_le_channel_opened(channel, 0);
                 break;                       
@@ -1539,10 +1683,12 @@ static void l2cap_run(void){
                 l2cap_send_le_signaling_packet(channel->con_handle, LE_CREDIT_BASED_CONNECTION_RESPONSE, channel->remote_sig_id, 0, 0, 0, 0, channel->reason);
                 // discard channel - l2cap_finialize_channel_close without sending l2cap close event
                 l2cap_stop_rtx(channel);
-                btstack_linked_list_iterator_remove(&it);
+                l2cap_channel_remove(&l2cap_le_channels, channel);
                 btstack_memory_l2cap_channel_free(channel);
                 break;
             case L2CAP_STATE_OPEN:
+                // check for pending credits or data first, hci_can_send_acl_packet_now is comparatively expensive
+                if (!channel->new_credits_incoming && !(channel->send_sdu_buffer && channel->credits_outgoing)) break;
                 if (!hci_can_send_acl_packet_now(channel->con_handle)) break;
 
                 // send credits
@@ -1571,7 +1717,8 @@ static void l2cap_run(void){
                     little_endian_store_16(l2cap_payload, pos, channel->send_sdu_len);
                     pos += 2;
                 }
-                payload_size = btstack_min(channel->send_sdu_len + 2 - channel->send_sdu_pos, channel->remote_mps - pos);
+                // PDU must fit into outgoing ACL buffer
+                payload_size = btstack_min(channel->send_sdu_len + 2 - channel->send_sdu_pos, btstack_min(channel->remote_mps, HCI_ACL_PAYLOAD_SIZE - L2CAP_HEADER_SIZE) - pos);
                 log_info("len %u, pos %u => payload %u, credits %u", channel->send_sdu_len, channel->send_sdu_pos, payload_size, channel->credits_outgoing);
                 memcpy(&l2cap_payload[pos], &channel->send_sdu_buffer[channel->send_sdu_pos-2], payload_size); // -2 for virtual SDU len
                 pos += payload_size;
@@ -1614,6 +1761,10 @@ static void l2cap_run(void){
     while(btstack_linked_list_iterator_has_next(&it)){
         hci_connection_t * connection = (hci_connection_t *) btstack_linked_list_iterator_next(&it);
         if (connection->address_type != BD_ADDR_TYPE_LE_PUBLIC && connection->address_type != BD_ADDR_TYPE_LE_RANDOM) continue;
+        // check for pending signaling first, hci_can_send_acl_packet_now is comparatively expensive
+        if (connection->le_con_parameter_update_state != CON_PARAMETER_UPDATE_SEND_REQUEST
+        &&  connection->le_con_parameter_update_state != CON_PARAMETER_UPDATE_SEND_RESPONSE
+        &&  connection->le_con_parameter_update_state != CON_PARAMETER_UPDATE_DENY) continue;
         if (!hci_can_send_acl_packet_now(connection->con_handle)) continue;
         switch (connection->le_con_parameter_update_state){
             case CON_PARAMETER_UPDATE_SEND_REQUEST:
@@ -1643,7 +1794,7 @@ static void l2cap_handle_connection_complete(hci_con_handle_t con_handle, l2cap_
     if (channel->state == L2CAP_STATE_WAIT_CONNECTION_COMPLETE || channel->state == L2CAP_STATE_WILL_SEND_CREATE_CONNECTION) {
         log_info("l2cap_handle_connection_complete expected state");
         // success, start l2cap handshake
-        channel->con_handle = con_handle;
+        l2cap_channel_set_con_handle(channel, con_handle);
         // check remote SSP feature first
         channel->state = L2CAP_STATE_WAIT_REMOTE_SUPPORTED_FEATURES;
     }
@@ -1683,7 +1834,7 @@ static void l2cap_handle_remote_supported_features_received(l2cap_channel_t * ch
 #endif
 
 #ifdef L2CAP_USES_CHANNELS
-static l2cap_channel_t * l2cap_create_channel_entry(btstack_packet_handler_t packet_handler, bd_addr_t address, bd_addr_type_t address_type, 
+static l2cap_channel_t * l2cap_create_channel_entry(btstack_packet_handler_t packet_handler, l2cap_channel_type_t channel_type, bd_addr_t address, bd_addr_type_t address_type, 
     uint16_t psm, uint16_t local_mtu, gap_security_level_t security_level){
 
     l2cap_channel_t * channel = btstack_memory_l2cap_channel_get();
@@ -1696,6 +1847,7 @@ static l2cap_channel_t * l2cap_create_channel_entry(btstack_packet_handler_t pac
         
     // fill in 
     channel->packet_handler = packet_handler;
+    channel->channel_type = channel_type;
     bd_addr_copy(channel->address, address);
     channel->address_type = address_type;
     channel->psm = psm;
@@ -1704,7 +1856,7 @@ static l2cap_channel_t * l2cap_create_channel_entry(btstack_packet_handler_t pac
     channel->required_security_level = security_level;
 
     // 
-    channel->local_cid = l2cap_next_local_cid();
+    channel->local_cid = l2cap_allocate_local_cid();
     channel->con_handle = 0;
 
     // set initial state
@@ -1734,7 +1886,7 @@ uint8_t l2cap_create_channel(btstack_packet_handler_t channel_packet_handler, bd
 
     log_info("L2CAP_CREATE_CHANNEL addr %s psm 0x%x mtu %u -> local mtu %u", bd_addr_to_str(address), psm, mtu, local_mtu);
 
-    l2cap_channel_t * channel = l2cap_create_channel_entry(channel_packet_handler, address, BD_ADDR_TYPE_CLASSIC, psm, local_mtu, LEVEL_0);
+    l2cap_channel_t * channel = l2cap_create_channel_entry(channel_packet_handler, L2CAP_CHANNEL_TYPE_CLASSIC, address, BD_ADDR_TYPE_CLASSIC, psm, local_mtu, LEVEL_0);
     if (!channel) {
         return BTSTACK_MEMORY_ALLOC_FAILED;
     }
@@ -1744,7 +1896,7 @@ uint8_t l2cap_create_channel(btstack_packet_handler_t channel_packet_handler, bd
 #endif    
 
     // add to connections list
-    btstack_linked_list_add(&l2cap_channels, (btstack_linked_item_t *) channel);
+    l2cap_channel_add(&l2cap_channels, channel);
 
     // store local_cid
     if (out_local_cid){
@@ -1793,7 +1945,7 @@ static void l2cap_handle_connection_failed_for_addr(bd_addr_t address, uint8_t s
                 l2cap_emit_channel_opened(channel, status);
                 // discard channel
                 l2cap_stop_rtx(channel);
-                btstack_linked_list_iterator_remove(&it);
+                l2cap_channel_remove(&l2cap_channels, channel);
                 btstack_memory_l2cap_channel_free(channel);
                 break;
             default:
@@ -1915,6 +2067,7 @@ static void l2cap_hci_event_handler(uint8_t packet_type, uint16_t cid, uint8_t *
 #endif
 #ifdef L2CAP_USES_CHANNELS
     hci_con_handle_t handle;
+    hci_connection_t * hci_con;
     btstack_linked_list_iterator_t it;
 #endif
 
@@ -1961,25 +2114,25 @@ static void l2cap_hci_event_handler(uint8_t packet_type, uint16_t cid, uint8_t *
         case HCI_EVENT_DISCONNECTION_COMPLETE:
             handle = little_endian_read_16(packet, 3);
             // send l2cap open failed or closed events for all channels on this handle and free them
+            // hci_connection_t is still valid here, it gets freed after all event handlers have been called
+            hci_con = hci_connection_for_handle(handle);
+            if (!hci_con) break;
+            while (hci_con->l2cap_channels){
+                l2cap_channel_t * channel = l2cap_channel_for_connection_item(hci_con->l2cap_channels);
+                hci_con->l2cap_channels = channel->connection_item.next;
 #ifdef ENABLE_CLASSIC
-            btstack_linked_list_iterator_init(&it, &l2cap_channels);
-            while (btstack_linked_list_iterator_has_next(&it)){
-                l2cap_channel_t * channel = (l2cap_channel_t *) btstack_linked_list_iterator_next(&it);
-                if (channel->con_handle != handle) continue;
-                btstack_linked_list_iterator_remove(&it);
-                l2cap_stop_rtx(channel);
-                l2cap_handle_hci_disconnect_event(channel);
-            }
+                if (channel->channel_type == L2CAP_CHANNEL_TYPE_CLASSIC){
+                    l2cap_channel_remove(&l2cap_channels, channel);
+                    l2cap_stop_rtx(channel);
+                }
 #endif
 #ifdef ENABLE_LE_DATA_CHANNELS
-            btstack_linked_list_iterator_init(&it, &l2cap_le_channels);
-            while (btstack_linked_list_iterator_has_next(&it)){
-                l2cap_channel_t * channel = (l2cap_channel_t *) btstack_linked_list_iterator_next(&it);
-                if (channel->con_handle != handle) continue;
-                btstack_linked_list_iterator_remove(&it);
+                if (channel->channel_type == L2CAP_CHANNEL_TYPE_LE_DATA_CHANNEL){
+                    l2cap_channel_remove(&l2cap_le_channels, channel);
+                }
+#endif
                 l2cap_handle_hci_disconnect_event(channel);
             }
-#endif
             break;
 #endif
 
@@ -1989,14 +2142,8 @@ static void l2cap_hci_event_handler(uint8_t packet_type, uint16_t cid, uint8_t *
             handle = little_endian_read_16(packet, 2);
             if (gap_get_connection_type(handle) != GAP_CONNECTION_ACL) break;
             if (hci_authentication_active_for_handle(handle)) break;
-            hci_con_used = 0;
-            btstack_linked_list_iterator_init(&it, &l2cap_channels);
-            while (btstack_linked_list_iterator_has_next(&it)){
-                l2cap_channel_t * channel = (l2cap_channel_t *) btstack_linked_list_iterator_next(&it);
-                if (channel->con_handle != handle) continue;
-                hci_con_used = 1;
-                break;
-            }
+            hci_con = hci_connection_for_handle(handle);
+            hci_con_used = hci_con && hci_con->l2cap_channels;
             if (hci_con_used) break;
             if (!hci_can_send_command_packet_now()) break;
             hci_send_cmd(&hci_disconnect, handle, 0x13); // remote closed connection             
@@ -2004,10 +2151,11 @@ static void l2cap_hci_event_handler(uint8_t packet_type, uint16_t cid, uint8_t *
 
         case HCI_EVENT_READ_REMOTE_SUPPORTED_FEATURES_COMPLETE:
             handle = little_endian_read_16(packet, 3);
-            btstack_linked_list_iterator_init(&it, &l2cap_channels);
+            hci_con = hci_connection_for_handle(handle);
+            if (!hci_con) break;
+            btstack_linked_list_iterator_init(&it, &hci_con->l2cap_channels);
             while (btstack_linked_list_iterator_has_next(&it)){
-                l2cap_channel_t * channel = (l2cap_channel_t *) btstack_linked_list_iterator_next(&it);
-                if (channel->con_handle != handle) continue;
+                l2cap_channel_t * channel = l2cap_channel_for_connection_item(btstack_linked_list_iterator_next(&it));
                 l2cap_handle_remote_supported_features_received(channel);
                 break;
             }
@@ -2016,10 +2164,12 @@ static void l2cap_hci_event_handler(uint8_t packet_type, uint16_t cid, uint8_t *
         case GAP_EVENT_SECURITY_LEVEL:
             handle = little_endian_read_16(packet, 2);
             log_info("l2cap - security level update");
-            btstack_linked_list_iterator_init(&it, &l2cap_channels);
+            hci_con = hci_connection_for_handle(handle);
+            if (!hci_con) break;
+            btstack_linked_list_iterator_init(&it, &hci_con->l2cap_channels);
             while (btstack_linked_list_iterator_has_next(&it)){
-                l2cap_channel_t * channel = (l2cap_channel_t *) btstack_linked_list_iterator_next(&it);
-                if (channel->con_handle != handle) continue;
+                l2cap_channel_t * channel = l2cap_channel_for_connection_item(btstack_linked_list_iterator_next(&it));
+                if (channel->channel_type != L2CAP_CHANNEL_TYPE_CLASSIC) continue;
 
                 gap_security_level_t actual_level = (gap_security_level_t) packet[4];
                 gap_security_level_t required_level = channel->required_security_level;
@@ -2106,7 +2256,7 @@ static void l2cap_handle_connection_request(hci_con_handle_t handle, uint8_t sig
 
     // alloc structure
     // log_info("l2cap_handle_connection_request register channel");
-    l2cap_channel_t * channel = l2cap_create_channel_entry(service->packet_handler, hci_connection->address, BD_ADDR_TYPE_CLASSIC, 
+    l2cap_channel_t * channel = l2cap_create_channel_entry(service->packet_handler, L2CAP_CHANNEL_TYPE_CLASSIC, hci_connection->address, BD_ADDR_TYPE_CLASSIC, 
     psm, service->mtu, service->required_security_level);
     if (!channel){
         // 0x0004 No resources available
@@ -2114,7 +2264,7 @@ static void l2cap_handle_connection_request(hci_con_handle_t handle, uint8_t sig
         return;
     }
 
-    channel->con_handle = handle;
+    l2cap_channel_set_con_handle(channel, handle);
     channel->remote_cid = source_cid;
     channel->remote_sig_id = sig_id; 
 
@@ -2128,7 +2278,7 @@ static void l2cap_handle_connection_request(hci_con_handle_t handle, uint8_t sig
     channel->state_var  = (L2CAP_CHANNEL_STATE_VAR) (L2CAP_CHANNEL_STATE_VAR_SEND_CONN_RESP_PEND | L2CAP_CHANNEL_STATE_VAR_INCOMING);
     
     // add to connections list
-    btstack_linked_list_add(&l2cap_channels, (btstack_linked_item_t *) channel);
+    l2cap_channel_add(&l2cap_channels, channel);
 
     // assert security requirements
     gap_request_security_level(handle, channel->required_security_level);
@@ -2211,7 +2361,8 @@ static void l2cap_signaling_handle_configure_request(l2cap_channel_t *channel, u
                     channel->remote_max_transmit   = command[pos+2];
                     channel->remote_retransmission_timeout_ms = little_endian_read_16(command, pos + 3);
                     channel->remote_monitor_timeout_ms = little_endian_read_16(command, pos + 5);
-                    channel->remote_mps = little_endian_read_16(command, pos + 7);
+                    // outgoing I-Frames are stored in tx buffers of local_mps size
+                    channel->remote_mps = btstack_min(little_endian_read_16(command, pos + 7), channel->local_mps);
                     log_info("FC&C config: tx window: %u, max transmit %u, retrans timeout %u, monitor timeout %u, mps %u",
                         channel->remote_tx_window_size,
                         channel->remote_max_transmit,
@@ -2380,7 +2531,7 @@ static void l2cap_signaling_handler_channel(l2cap_channel_t *channel, uint8_t *c
                             }
                             
                             // discard channel
-                            btstack_linked_list_remove(&l2cap_channels, (btstack_linked_item_t *) channel);
+                            l2cap_channel_remove(&l2cap_channels, channel);
                             btstack_memory_l2cap_channel_free(channel);
                             break;
                     }
@@ -2527,10 +2678,9 @@ static void l2cap_signaling_handler_dispatch(hci_con_handle_t handle, uint8_t *
                     connection->l2cap_state.extended_feature_mask = little_endian_read_16(command, L2CAP_SIGNALING_COMMAND_DATA_OFFSET+4);
                     log_info("extended features mask 0x%02x", connection->l2cap_state.extended_feature_mask);
                     // trigger connection request
-                    btstack_linked_list_iterator_init(&it, &l2cap_channels);
+                    btstack_linked_list_iterator_init(&it, &connection->l2cap_channels);
                     while (btstack_linked_list_iterator_has_next(&it)){
-                        l2cap_channel_t * channel = (l2cap_channel_t *) btstack_linked_list_iterator_next(&it);
-                        if (channel->con_handle != handle) continue;
+                        l2cap_channel_t * channel = l2cap_channel_for_connection_item(btstack_linked_list_iterator_next(&it));
                         // bail if ERTM was requested but is not supported
                         if ((channel->mode == L2CAP_CHANNEL_MODE_ENHANCED_RETRANSMISSION) && ((connection->l2cap_state.extended_feature_mask & 0x08) == 0)){
                             if (channel->ertm_mandatory){
@@ -2539,7 +2689,7 @@ static void l2cap_signaling_handler_dispatch(hci_con_handle_t handle, uint8_t *
                                 // map l2cap connection response result to BTstack status enumeration
                                 l2cap_emit_channel_opened(channel, L2CAP_CONNECTION_RESPONSE_RESULT_ERTM_NOT_SUPPORTED);
                                 // discard channel
-                                btstack_linked_list_remove(&l2cap_channels, (btstack_linked_item_t *) channel);
+                                l2cap_channel_remove(&l2cap_channels, channel);
                                 btstack_memory_l2cap_channel_free(channel);
                                 continue;
                             } else {
@@ -2573,10 +2723,11 @@ static void l2cap_signaling_handler_dispatch(hci_con_handle_t handle, uint8_t *
     uint16_t dest_cid = little_endian_read_16(command, L2CAP_SIGNALING_COMMAND_DATA_OFFSET);
     
     // Find channel for this sig_id and connection handle
-    btstack_linked_list_iterator_init(&it, &l2cap_channels);
+    hci_connection_t * hci_connection = hci_connection_for_handle(handle);
+    if (!hci_connection) return;
+    btstack_linked_list_iterator_init(&it, &hci_connection->l2cap_channels);
     while (btstack_linked_list_iterator_has_next(&it)){
-        l2cap_channel_t * channel = (l2cap_channel_t *) btstack_linked_list_iterator_next(&it);
-        if (channel->con_handle != handle) continue;
+        l2cap_channel_t * channel = l2cap_channel_for_connection_item(btstack_linked_list_iterator_next(&it));
         if (code & 1) {
             // match odd commands (responses) by previous signaling identifier 
             if (channel->local_sig_id == sig_id) {
@@ -2688,15 +2839,7 @@ static int l2cap_le_signaling_handler_dispatch(hci_con_handle_t handle, uint8_t
 
         case COMMAND_REJECT:
             // Find channel for this sig_id and connection handle
-            channel = NULL;
-            btstack_linked_list_iterator_init(&it, &l2cap_le_channels);
-            while (btstack_linked_list_iterator_has_next(&it)){
-                l2cap_channel_t * a_channel = (l2cap_channel_t *) btstack_linked_list_iterator_next(&it);
-                if (a_channel->con_handle   != handle) continue;
-                if (a_channel->local_sig_id != sig_id) continue;
-                channel = a_channel;
-                break; 
-            }
+            channel = l2cap_channel_for_handle_and_sig_id(handle, sig_id);
             if (!channel) break;
 
             // if received while waiting for le connection response, assume legacy device
@@ -2706,7 +2849,7 @@ static int l2cap_le_signaling_handler_dispatch(hci_con_handle_t handle, uint8_t
                 l2cap_emit_le_channel_opened(channel, 0x0002);
                                 
                 // discard channel
-                btstack_linked_list_remove(&l2cap_le_channels, (btstack_linked_item_t *) channel);
+                l2cap_channel_remove(&l2cap_le_channels, channel);
                 btstack_memory_l2cap_channel_free(channel);
                 break;
             }
@@ -2733,10 +2876,9 @@ static int l2cap_le_signaling_handler_dispatch(hci_con_handle_t handle, uint8_t
                 }
 
                 // go through list of channels for this ACL connection and check if we get a match
-                btstack_linked_list_iterator_init(&it, &l2cap_le_channels);
+                btstack_linked_list_iterator_init(&it, &connection->l2cap_channels);
                 while (btstack_linked_list_iterator_has_next(&it)){
-                    l2cap_channel_t * a_channel = (l2cap_channel_t *) btstack_linked_list_iterator_next(&it);
-                    if (a_channel->con_handle != handle) continue;
+                    l2cap_channel_t * a_channel = l2cap_channel_for_connection_item(btstack_linked_list_iterator_next(&it));
                     if (a_channel->remote_cid != source_cid) continue;
                     // 0x000a Connection refused - Source CID already allocated
                     l2cap_register_signaling_response(handle, LE_CREDIT_BASED_CONNECTION_REQUEST, sig_id, source_cid, 0x000a);
@@ -2777,7 +2919,7 @@ static int l2cap_le_signaling_handler_dispatch(hci_con_handle_t handle, uint8_t
                 }
 
                 // allocate channel
-                channel = l2cap_create_channel_entry(service->packet_handler, connection->address,
+                channel = l2cap_create_channel_entry(service->packet_handler, L2CAP_CHANNEL_TYPE_LE_DATA_CHANNEL, connection->address,
                     BD_ADDR_TYPE_LE_RANDOM, le_psm, service->mtu, service->required_security_level);
                 if (!channel){
                     // 0x0004 Connection refused – no resources available
@@ -2785,7 +2927,7 @@ static int l2cap_le_signaling_handler_dispatch(hci_con_handle_t handle, uint8_t
                     return 1;
                 }
 
-                channel->con_handle = handle;
+                l2cap_channel_set_con_handle(channel, handle);
                 channel->remote_cid = source_cid;
                 channel->remote_sig_id = sig_id; 
                 channel->remote_mtu = little_endian_read_16(command, 8);
@@ -2797,7 +2939,7 @@ static int l2cap_le_signaling_handler_dispatch(hci_con_handle_t handle, uint8_t
                 channel->state_var |= L2CAP_CHANNEL_STATE_VAR_INCOMING;
 
                 // add to connections list
-                btstack_linked_list_add(&l2cap_le_channels, (btstack_linked_item_t *) channel);
+                l2cap_channel_add(&l2cap_le_channels, channel);
 
                 // post connection request event
                 l2cap_emit_le_incoming_connection(channel);
@@ -2813,15 +2955,7 @@ static int l2cap_le_signaling_handler_dispatch(hci_con_handle_t handle, uint8_t
             if (len < 10) return 0;
 
             // Find channel for this sig_id and connection handle
-            channel = NULL;
-            btstack_linked_list_iterator_init(&it, &l2cap_le_channels);
-            while (btstack_linked_list_iterator_has_next(&it)){
-                l2cap_channel_t * a_channel = (l2cap_channel_t *) btstack_linked_list_iterator_next(&it);
-                if (a_channel->con_handle   != handle) continue;
-                if (a_channel->local_sig_id != sig_id) continue;
-                channel = a_channel;
-                break; 
-            }
+            channel = l2cap_channel_for_handle_and_sig_id(handle, sig_id);
             if (!channel) break;
 
             // cid + 0
@@ -2832,7 +2966,7 @@ static int l2cap_le_signaling_handler_dispatch(hci_con_handle_t handle, uint8_t
                 l2cap_emit_le_channel_opened(channel, result);
                                 
                 // discard channel
-                btstack_linked_list_remove(&l2cap_le_channels, (btstack_linked_item_t *) channel);
+                l2cap_channel_remove(&l2cap_le_channels, channel);
                 btstack_memory_l2cap_channel_free(channel);
                 break;
             }
@@ -2931,7 +3065,7 @@ static void l2cap_acl_classic_handler(hci_con_handle_t handle, uint8_t *packet,
         default: 
             // Find channel for this channel_id and connection handle
             l2cap_channel = l2cap_get_channel_for_local_cid(channel_id);
-            if (l2cap_channel) {
+            if (l2cap_channel && l2cap_channel->con_handle == handle) {
 #ifdef ENABLE_L2CAP_ENHANCED_RETRANSMISSION_MODE
                 if (l2cap_channel->mode == L2CAP_CHANNEL_MODE_ENHANCED_RETRANSMISSION){
 
@@ -2996,20 +3130,21 @@ static void l2cap_acl_classic_handler(hci_con_handle_t handle, uint8_t *packet,
                                     }
 
                                     // final bit set <- response to RR with poll bit set. All not acknowledged packets need to be retransmitted
-                                    l2cap_channel->tx_send_index = l2cap_channel->tx_read_index;
+                                    l2cap_ertm_retransmit_unacknowleged_frames(l2cap_channel);
                                 }                       
                                 break;
                             case L2CAP_SUPERVISORY_FUNCTION_REJ_REJECT:
                                 log_info("L2CAP_SUPERVISORY_FUNCTION_REJ_REJECT");
                                 l2cap_ertm_process_req_seq(l2cap_channel, req_seq);
                                 // rsetart transmittion from last unacknowledted packet (earlier packets already freed in l2cap_ertm_process_req_seq)
-                                l2cap_channel->tx_send_index = l2cap_channel->tx_read_index;
+                                l2cap_ertm_retransmit_unacknowleged_frames(l2cap_channel);
                                 break;
                             case L2CAP_SUPERVISORY_FUNCTION_RNR_RECEIVER_NOT_READY:
                                 log_error("L2CAP_SUPERVISORY_FUNCTION_RNR_RECEIVER_NOT_READY");
                                 break;
                             case L2CAP_SUPERVISORY_FUNCTION_SREJ_SELECTIVE_REJECT:
                                 log_info("L2CAP_SUPERVISORY_FUNCTION_SREJ_SELECTIVE_REJECT");
+                                l2cap_channel->ertm_stats.srej_received++;
                                 if (poll){
                                     l2cap_ertm_process_req_seq(l2cap_channel, req_seq);
                                 }
@@ -3037,7 +3172,7 @@ static void l2cap_acl_classic_handler(hci_con_handle_t handle, uint8_t *packet,
                         l2cap_ertm_process_req_seq(l2cap_channel, req_seq);
                         if (final){
                             // final bit set <- response to RR with poll bit set. All not acknowledged packets need to be retransmitted
-                            l2cap_channel->tx_send_index = l2cap_channel->tx_read_index;
+                            l2cap_ertm_retransmit_unacknowleged_frames(l2cap_channel);
                         }
 
                         // get SDU
@@ -3067,7 +3202,7 @@ static void l2cap_acl_classic_handler(hci_con_handle_t handle, uint8_t *packet,
                                 l2cap_channel->req_seq         = l2cap_channel->expected_tx_seq;
 
                                 rx_state->valid = 0;
-                                l2cap_ertm_handle_in_sequence_sdu(l2cap_channel, rx_state->sar, &l2cap_channel->rx_packets_data[index], rx_state->len);
+                                l2cap_ertm_handle_in_sequence_sdu(l2cap_channel, rx_state->sar, &l2cap_channel->rx_packets_data[index * l2cap_channel->local_mps], rx_state->len);
 
                                 // update rx store index
                                 index++;
@@ -3143,8 +3278,9 @@ static void l2cap_acl_le_handler(hci_con_handle_t handle, uint8_t *packet, uint1
         default:
 
 #ifdef ENABLE_LE_DATA_CHANNELS
+            // Find channel for this channel_id and connection handle
             l2cap_channel = l2cap_le_get_channel_for_local_cid(channel_id);
-            if (l2cap_channel) {
+            if (l2cap_channel && l2cap_channel->con_handle == handle) {
                 // credit counting
                 if (l2cap_channel->credits_incoming == 0){
                     log_error("LE Data Channel packet received but no incoming credits");
@@ -3153,11 +3289,23 @@ static void l2cap_acl_le_handler(hci_con_handle_t handle, uint8_t *packet, uint1
                 }
                 l2cap_channel->credits_incoming--;
 
+                // PDU larger than MPS
+                if (size - COMPLETE_L2CAP_HEADER > l2cap_channel->local_mps){
+                    log_error("LE Data Channel PDU with %u bytes exceeds MPS %u", size - COMPLETE_L2CAP_HEADER, l2cap_channel->local_mps);
+                    l2cap_channel->state = L2CAP_STATE_WILL_SEND_DISCONNECT_REQUEST;
+                    break;
+                }
+
                 // automatic credits
                 if (l2cap_channel->credits_incoming < L2CAP_LE_DATA_CHANNELS_AUTOMATIC_CREDITS_WATERMARK && l2cap_channel->automatic_credits){
                     l2cap_channel->new_credits_incoming = L2CAP_LE_DATA_CHANNELS_AUTOMATIC_CREDITS_INCREMENT;
                 }
 
+                // credit policy
+                if (l2cap_channel->credits_batch_size){
+                    l2cap_channel->credits_consumed++;
+                }
+
                 // first fragment
                 uint16_t pos = 0;
                 if (!l2cap_channel->receive_sdu_len){
@@ -3179,6 +3327,8 @@ static void l2cap_acl_le_handler(hci_con_handle_t handle, uint8_t *packet, uint1
                     l2cap_dispatch_to_channel(l2cap_channel, L2CAP_DATA_PACKET, l2cap_channel->receive_sdu_buffer, l2cap_channel->receive_sdu_len);
                     l2cap_channel->receive_sdu_len = 0;
                 }
+                // return credits after SDU was delivered
+                l2cap_le_apply_credit_policy(l2cap_channel);
             } else {
                 log_error("LE Data Channel packet received but no channel found for cid 0x%02x", channel_id);
             }
@@ -3226,7 +3376,7 @@ void l2cap_finialize_channel_close(l2cap_channel_t * channel){
     l2cap_emit_channel_closed(channel);
     // discard channel
     l2cap_stop_rtx(channel);
-    btstack_linked_list_remove(&l2cap_channels, (btstack_linked_item_t *) channel);
+    l2cap_channel_remove(&l2cap_channels, channel);
     btstack_memory_l2cap_channel_free(channel);
 }
 
@@ -3300,6 +3450,28 @@ uint8_t l2cap_unregister_service(uint16_t psm){
 
 #ifdef ENABLE_LE_DATA_CHANNELS
 
+static uint16_t l2cap_le_local_mps(l2cap_channel_t *channel){
+    uint16_t mps = l2cap_le_custom_mps;
+    if (mps == 0){
+        // one PDU per LE ACL packet
+        mps = hci_max_acl_le_data_packet_length() - L2CAP_HEADER_SIZE;
+    }
+    // PDU has to fit into incoming ACL buffer, and larger PDUs than SDU len + SDU don't make sense
+    mps = btstack_min(mps, HCI_ACL_PAYLOAD_SIZE - L2CAP_HEADER_SIZE);
+    mps = btstack_min(mps, channel->local_mtu + 2);
+    return btstack_max(mps, L2CAP_LE_DATA_CHANNELS_MIN_MPS);
+}
+
+static void l2cap_le_apply_credit_policy(l2cap_channel_t *channel){
+    if (!channel->credits_batch_size) return;
+    if (!channel->credits_consumed) return;
+    // remote credits = credits incoming + credits not sent yet
+    if (channel->credits_consumed < channel->credits_batch_size
+    &&  channel->credits_incoming + channel->new_credits_incoming >= channel->credits_watermark) return;
+    channel->new_credits_incoming += channel->credits_consumed;
+    channel->credits_consumed = 0;
+}
+
 static void l2cap_le_notify_channel_can_send(l2cap_channel_t *channel){
     if (!channel->waiting_for_can_send_now) return;
     if (channel->send_sdu_buffer) return;
@@ -3348,15 +3520,7 @@ static void l2cap_emit_le_channel_opened(l2cap_channel_t *channel, uint8_t statu
 }
 
 static l2cap_channel_t * l2cap_le_get_channel_for_local_cid(uint16_t local_cid){
-    btstack_linked_list_iterator_t it;    
-    btstack_linked_list_iterator_init(&it, &l2cap_le_channels);
-    while (btstack_linked_list_iterator_has_next(&it)){
-        l2cap_channel_t * channel = (l2cap_channel_t *) btstack_linked_list_iterator_next(&it);
-        if ( channel->local_cid == local_cid) {
-            return channel;
-        }
-    } 
-    return NULL;
+    return l2cap_channel_lookup(L2CAP_CHANNEL_TYPE_LE_DATA_CHANNEL, local_cid);
 }
 
 // finalize closed channel - l2cap_handle_disconnect_request & DISCONNECTION_RESPONSE
@@ -3364,7 +3528,7 @@ void l2cap_le_finialize_channel_close(l2cap_channel_t * channel){
     channel->state = L2CAP_STATE_CLOSED;
     l2cap_emit_simple_event_with_cid(channel, L2CAP_EVENT_CHANNEL_CLOSED);
     // discard channel
-    btstack_linked_list_remove(&l2cap_le_channels, (btstack_linked_item_t *) channel);
+    l2cap_channel_remove(&l2cap_le_channels, channel);
     btstack_memory_l2cap_channel_free(channel);
 }
 
@@ -3472,7 +3636,7 @@ uint8_t l2cap_le_create_channel(btstack_packet_handler_t packet_handler, hci_con
         return ERROR_CODE_UNKNOWN_CONNECTION_IDENTIFIER;
     }
 
-    l2cap_channel_t * channel = l2cap_create_channel_entry(packet_handler, connection->address, connection->address_type, psm, mtu, security_level);
+    l2cap_channel_t * channel = l2cap_create_channel_entry(packet_handler, L2CAP_CHANNEL_TYPE_LE_DATA_CHANNEL, connection->address, connection->address_type, psm, mtu, security_level);
     if (!channel) {
         return BTSTACK_MEMORY_ALLOC_FAILED;
     }
@@ -3484,14 +3648,14 @@ uint8_t l2cap_le_create_channel(btstack_packet_handler_t packet_handler, hci_con
     }
 
     // provide buffer
-    channel->con_handle = con_handle;
+    l2cap_channel_set_con_handle(channel, con_handle);
     channel->receive_sdu_buffer = receive_sdu_buffer;
     channel->state = L2CAP_STATE_WILL_SEND_LE_CONNECTION_REQUEST;
     channel->new_credits_incoming = initial_credits;
     channel->automatic_credits    = initial_credits == L2CAP_LE_AUTOMATIC_CREDITS;
 
     // add to connections list
-    btstack_linked_list_add(&l2cap_le_channels, (btstack_linked_item_t *) channel);
+    l2cap_channel_add(&l2cap_le_channels, channel);
 
     // go
     l2cap_run();
@@ -3533,6 +3697,27 @@ uint8_t l2cap_le_provide_credits(uint16_t local_cid, uint16_t credits){
     return 0;
 }
 
+uint8_t l2cap_le_set_credit_policy(uint16_t local_cid, uint16_t watermark, uint16_t batch_size){
+    l2cap_channel_t * channel = l2cap_le_get_channel_for_local_cid(local_cid);
+    if (!channel) {
+        log_error("l2cap_le_set_credit_policy no channel for cid 0x%02x", local_cid);
+        return L2CAP_LOCAL_CID_DOES_NOT_EXIST;
+    }
+    channel->credits_watermark  = watermark;
+    channel->credits_batch_size = batch_size;
+    if (batch_size){
+        channel->automatic_credits = 0;
+    }
+    // return credits that are due now
+    l2cap_le_apply_credit_policy(channel);
+    l2cap_run();
+    return 0;
+}
+
+void l2cap_le_set_mps(uint16_t mps){
+    l2cap_le_custom_mps = mps;
+}
+
 /**
  * @brief Check if outgoing buffer is available and that there's space on the Bluetooth module
  * @param local_cid             L2CAP LE Data Channel Identifier
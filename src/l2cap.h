@@ -69,6 +69,19 @@ extern "C" {
 
 #define L2CAP_LE_AUTOMATIC_CREDITS 0xffff
 
+// number of buckets in hash table used for channel lookup by local CID, must be power of two.
+// local CIDs are allocated consecutively, with N channels, a lookup checks up to N / L2CAP_CHANNEL_INDEX_SIZE channels
+#ifndef L2CAP_CHANNEL_INDEX_SIZE
+#ifdef HAVE_MALLOC
+#define L2CAP_CHANNEL_INDEX_SIZE 64
+#else
+#define L2CAP_CHANNEL_INDEX_SIZE 16
+#endif
+#endif
+#if (L2CAP_CHANNEL_INDEX_SIZE & (L2CAP_CHANNEL_INDEX_SIZE - 1)) != 0
+#error "L2CAP_CHANNEL_INDEX_SIZE must be a power of two"
+#endif
+
 // private structs
 typedef enum {
     L2CAP_STATE_CLOSED = 1,           // no baseband
@@ -127,8 +140,26 @@ typedef struct {
     uint8_t tx_seq;
     uint8_t retry_count;
     uint8_t retransmission_requested;
+    uint8_t num_transmissions;
 } l2cap_ertm_tx_packet_state_t;
 
+typedef struct {
+    // sender: I-Frames sent, including retransmissions
+    uint32_t i_frames_sent;
+    // sender: I-Frames sent more than once
+    uint32_t retransmissions;
+    // sender: number of times outgoing I-Frames were blocked by a full remote tx window
+    uint32_t tx_window_stalls;
+    // sender: SREJ frames received
+    uint32_t srej_received;
+    // receiver: S-Frames sent
+    uint32_t s_frames_sent;
+    // receiver: SREJ frames sent
+    uint32_t srej_sent;
+    // receiver: acknowledgements carried by I-Frames instead of RR frames
+    uint32_t acks_piggybacked;
+} l2cap_ertm_stats_t;
+
 typedef struct {
     // If not mandatory, the use of ERTM can be decided by the remote 
     uint8_t  ertm_mandatory; 
@@ -153,6 +184,11 @@ typedef struct {
 
 } l2cap_ertm_config_t;
 
+typedef enum {
+    L2CAP_CHANNEL_TYPE_CLASSIC,             // Classic Basic or ERTM
+    L2CAP_CHANNEL_TYPE_LE_DATA_CHANNEL,     // LE Credit Based Flow Control Mode
+} l2cap_channel_type_t;
+
 // info regarding an actual connection
 typedef struct {
     // linked list - assert: first field
@@ -206,6 +242,9 @@ typedef struct {
     // max PDU size
     uint16_t  remote_mps;
 
+    // local mps = max PDU size we can receive (LE Data Channels) / size of rx/tx buffers (ERTM)
+    uint16_t  local_mps;
+
     // credits for outgoing traffic
     uint16_t credits_outgoing;
     
@@ -218,13 +257,27 @@ typedef struct {
     // automatic credits incoming
     uint16_t automatic_credits;
 
+    // credit policy: credits of received PDUs are returned in batches of credits_batch_size,
+    // or earlier if remote has less than credits_watermark credits left. Disabled if credits_batch_size == 0
+    uint16_t credits_watermark;
+    uint16_t credits_batch_size;
+
+    // credits of received PDUs not returned yet
+    uint16_t credits_consumed;
+
+    // classic or LE Data Channel
+    l2cap_channel_type_t channel_type;
+
+    // linked list of channels on the same HCI connection, see hci_connection_t.l2cap_channels
+    btstack_linked_item_t connection_item;
+
+    // linked list of channels in the same bucket of the local CID index
+    btstack_linked_item_t index_item;
+
 #ifdef ENABLE_L2CAP_ENHANCED_RETRANSMISSION_MODE
 
     // l2cap channel mode: basic or enhanced retransmission mode
     l2cap_channel_mode_t mode;
-    
-    // local mps = size of rx/tx buffers
-    uint16_t local_mps;
 
     // retransmission timer
     btstack_timer_source_t retransmission_timer;
@@ -253,6 +306,9 @@ typedef struct {
     // sender: number of unacknowledeged I-Frames - frames have been sent, but not acknowledged yet
     uint8_t unacked_frames;
 
+    // sender: number of I-Frames in tx buffers - sent or not, but not acknowledged yet
+    uint8_t num_stored_frames;
+
     // sender: buffer index of oldest packet
     uint8_t tx_read_index;
 
@@ -268,6 +324,9 @@ typedef struct {
     // sender: selective retransmission requested
     uint8_t srej_active;
 
+    // sender: remote tx window full, counted once per stall
+    uint8_t tx_window_stalled;
+
 
     // receiver: max num out-of-order packets // tx_window
     uint8_t num_rx_buffers;
@@ -323,6 +382,9 @@ typedef struct {
     // sender: num_tx_buffers of size local_mps
     uint8_t * tx_packets_data;
 
+    // statistics
+    l2cap_ertm_stats_t ertm_stats;
+
 #endif    
 } l2cap_channel_t;
 
@@ -555,6 +617,26 @@ uint8_t l2cap_le_create_channel(btstack_packet_handler_t packet_handler, hci_con
  */
 uint8_t l2cap_le_provide_credits(uint16_t cid, uint16_t credits);
 
+/**
+ * @brief Set credit policy for LE Data Channel. Credits are returned automatically after received
+ *        PDUs have been delivered in batches of batch_size, or earlier if the remote has less than
+ *        watermark credits left. Sending a single LE Flow Control Credit for a batch reduces signaling.
+ * @note Replaces automatic credits. The number of credits provided to the remote never exceeds the initial credits
+ *       plus credits provided by l2cap_le_provide_credits
+ * @param local_cid             L2CAP LE Data Channel Identifier
+ * @param watermark             Return credits if remote has less credits left
+ * @param batch_size            Number of credits returned at once, 0 to disable credit policy
+ */
+uint8_t l2cap_le_set_credit_policy(uint16_t local_cid, uint16_t watermark, uint16_t batch_size);
+
+/**
+ * @brief Set Maximum PDU Size (MPS) for new LE Data Channels
+ * @note By default, MPS follows the LE ACL buffer size of the Controller, which reflects LE Data Length Extension,
+ *       so that each PDU fits into a single LE ACL packet. MPS is limited to HCI_ACL_PAYLOAD_SIZE - 4 and the channel MTU + 2
+ * @param mps                   Maximum PDU Size or 0 to follow LE ACL buffer size
+ */
+void l2cap_le_set_mps(uint16_t mps);
+
 /**
  * @brief Check if packet can be scheduled for transmission
  * @param local_cid             L2CAP LE Data Channel Identifier
@@ -600,6 +682,14 @@ uint8_t l2cap_ertm_set_busy(uint16_t local_cid);
  */
 uint8_t l2cap_ertm_set_ready(uint16_t local_cid);
 
+/**
+ * @brief ERTM Get channel statistics
+ * @note Counters are reset when the channel is configured for ERTM
+ * @param local_cid 
+ * @param stats
+ */
+uint8_t l2cap_ertm_get_stats(uint16_t local_cid, l2cap_ertm_stats_t * stats);
+
 #if defined __cplusplus
 }
 #endif
@@ -0,0 +1,285 @@
+/*
+ * Copyright (C) 2014 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+ 
+// *****************************************************************************
+//
+// att_db dispatch table tests, see compile_gatt.py --dispatch-table
+//
+// *****************************************************************************
+
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/CommandLineTestRunner.h"
+
+#include "ble/att_db.h"
+#include "btstack_util.h"
+#include "bluetooth.h"
+
+#include "dispatch.h"
+
+static att_connection_t att_connection;
+static uint8_t  att_request[32];
+static uint8_t  att_response[32];
+
+static int      counter_read_count;
+static int      ccc_read_count;
+static int      ccc_write_count;
+static int      control_point_write_count;
+static uint16_t control_point_transaction_mode;
+static uint8_t  control_point_value[8];
+static uint16_t control_point_value_len;
+static int      default_read_count;
+static int      default_write_count;
+
+static const uint8_t counter_value[] = { 0x11, 0x22, 0x33, 0x44 };
+
+uint16_t att_characteristic_ff11_counter_value_read(hci_con_handle_t con_handle, uint16_t offset, uint8_t * buffer, uint16_t buffer_size){
+    UNUSED(con_handle);
+    if (buffer) counter_read_count++;
+    return att_read_callback_handle_blob(counter_value, sizeof(counter_value), offset, buffer, buffer_size);
+}
+
+uint16_t att_characteristic_ff11_counter_client_configuration_read(hci_con_handle_t con_handle, uint16_t offset, uint8_t * buffer, uint16_t buffer_size){
+    UNUSED(con_handle);
+    if (buffer) ccc_read_count++;
+    return att_read_callback_handle_little_endian_16(GATT_CLIENT_CHARACTERISTICS_CONFIGURATION_NOTIFICATION, offset, buffer, buffer_size);
+}
+
+int att_characteristic_ff11_counter_client_configuration_write(hci_con_handle_t con_handle, uint16_t transaction_mode, uint16_t offset, uint8_t * buffer, uint16_t buffer_size){
+    UNUSED(con_handle);
+    UNUSED(offset);
+    UNUSED(buffer);
+    UNUSED(buffer_size);
+    if (transaction_mode != ATT_TRANSACTION_MODE_NONE) return 0;
+    ccc_write_count++;
+    return 0;
+}
+
+int att_characteristic_ff12_control_point_value_write(hci_con_handle_t con_handle, uint16_t transaction_mode, uint16_t offset, uint8_t * buffer, uint16_t buffer_size){
+    UNUSED(con_handle);
+    control_point_write_count++;
+    control_point_transaction_mode = transaction_mode;
+    if (buffer == NULL) return 0;
+    if (offset + buffer_size > sizeof(control_point_value)) return ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LENGTH;
+    memcpy(&control_point_value[offset], buffer, buffer_size);
+    control_point_value_len = offset + buffer_size;
+    return 0;
+}
+
+static uint16_t default_read_callback(hci_con_handle_t con_handle, uint16_t attribute_handle, uint16_t offset, uint8_t * buffer, uint16_t buffer_size){
+    UNUSED(con_handle);
+    UNUSED(attribute_handle);
+    if (buffer) default_read_count++;
+    return att_read_callback_handle_byte(0x55, offset, buffer, buffer_size);
+}
+
+static int default_write_callback(hci_con_handle_t con_handle, uint16_t attribute_handle, uint16_t transaction_mode, uint16_t offset, uint8_t *buffer, uint16_t buffer_size){
+    UNUSED(con_handle);
+    UNUSED(attribute_handle);
+    UNUSED(transaction_mode);
+    UNUSED(offset);
+    UNUSED(buffer);
+    UNUSED(buffer_size);
+    default_write_count++;
+    return 0;
+}
+
+static uint16_t read_request(uint16_t handle){
+    att_request[0] = ATT_READ_REQUEST;
+    little_endian_store_16(att_request, 1, handle);
+    return att_handle_request(&att_connection, att_request, 3, att_response);
+}
+
+static uint16_t write_request(uint8_t opcode, uint16_t handle, const uint8_t * value, uint16_t value_len){
+    att_request[0] = opcode;
+    little_endian_store_16(att_request, 1, handle);
+    memcpy(&att_request[3], value, value_len);
+    return att_handle_request(&att_connection, att_request, 3 + value_len, att_response);
+}
+
+static uint16_t prepare_write_request(uint16_t handle, uint16_t offset, const uint8_t * value, uint16_t value_len){
+    att_request[0] = ATT_PREPARE_WRITE_REQUEST;
+    little_endian_store_16(att_request, 1, handle);
+    little_endian_store_16(att_request, 3, offset);
+    memcpy(&att_request[5], value, value_len);
+    return att_handle_request(&att_connection, att_request, 5 + value_len, att_response);
+}
+
+static uint16_t execute_write_request(uint8_t flags){
+    att_request[0] = ATT_EXECUTE_WRITE_REQUEST;
+    att_request[1] = flags;
+    return att_handle_request(&att_connection, att_request, 2, att_response);
+}
+
+TEST_GROUP(AttDbDispatch){
+    void setup(void){
+        memset(&att_connection, 0, sizeof(att_connection));
+        att_connection.mtu = ATT_DEFAULT_MTU;
+        att_connection.max_mtu = ATT_DEFAULT_MTU;
+        counter_read_count = 0;
+        ccc_read_count = 0;
+        ccc_write_count = 0;
+        control_point_write_count = 0;
+        control_point_transaction_mode = 0xffff;
+        control_point_value_len = 0;
+        default_read_count = 0;
+        default_write_count = 0;
+        att_set_db(profile_data);
+        att_set_read_callback(&default_read_callback);
+        att_set_write_callback(&default_write_callback);
+        att_set_db_offsets(profile_data_offsets, sizeof(profile_data_offsets) / sizeof(uint16_t));
+        att_set_db_dispatch_table(profile_data_dispatch_table, sizeof(profile_data_dispatch_table) / sizeof(att_db_dispatch_entry_t));
+    }
+};
+
+TEST(AttDbDispatch, OffsetsMatchDatabase){
+    uint16_t offset = 0;
+    uint16_t handle = 1;
+    while (true){
+        uint16_t size = little_endian_read_16(profile_data, offset);
+        if (size == 0) break;
+        CHECK(handle <= sizeof(profile_data_offsets) / sizeof(uint16_t));
+        CHECK_EQUAL(offset, profile_data_offsets[handle - 1]);
+        CHECK_EQUAL(handle, little_endian_read_16(profile_data, offset + 4));
+        offset += size;
+        handle++;
+    }
+    CHECK_EQUAL(handle - 1, sizeof(profile_data_offsets) / sizeof(uint16_t));
+}
+
+TEST(AttDbDispatch, DynamicReadUsesReadHandler){
+    uint16_t response_len = read_request(ATT_CHARACTERISTIC_FF11_COUNTER_VALUE_HANDLE);
+    CHECK_EQUAL(1 + sizeof(counter_value), response_len);
+    CHECK_EQUAL(ATT_READ_RESPONSE, att_response[0]);
+    MEMCMP_EQUAL(counter_value, &att_response[1], sizeof(counter_value));
+    CHECK_EQUAL(1, counter_read_count);
+    CHECK_EQUAL(0, default_read_count);
+
+    response_len = read_request(ATT_CHARACTERISTIC_FF11_COUNTER_CLIENT_CONFIGURATION_HANDLE);
+    CHECK_EQUAL(3, response_len);
+    CHECK_EQUAL(GATT_CLIENT_CHARACTERISTICS_CONFIGURATION_NOTIFICATION, little_endian_read_16(att_response, 1));
+    CHECK_EQUAL(1, ccc_read_count);
+    CHECK_EQUAL(0, default_read_count);
+}
+
+TEST(AttDbDispatch, StaticRead){
+    const uint8_t expected[] = { 0x01, 0x02, 0x03 };
+    uint16_t response_len = read_request(ATT_CHARACTERISTIC_FF13_STATIC_VALUE_HANDLE);
+    CHECK_EQUAL(1 + sizeof(expected), response_len);
+    CHECK_EQUAL(ATT_READ_RESPONSE, att_response[0]);
+    MEMCMP_EQUAL(expected, &att_response[1], sizeof(expected));
+    CHECK_EQUAL(0, default_read_count);
+}
+
+TEST(AttDbDispatch, InvalidHandle){
+    uint16_t response_len = read_request(0x0042);
+    CHECK_EQUAL(5, response_len);
+    CHECK_EQUAL(ATT_ERROR_RESPONSE, att_response[0]);
+    CHECK_EQUAL(ATT_ERROR_INVALID_HANDLE, att_response[4]);
+}
+
+TEST(AttDbDispatch, ReadWithoutReadHandler){
+    // control point is listed in the dispatch table, but write only
+    uint16_t response_len = read_request(ATT_CHARACTERISTIC_FF12_CONTROL_POINT_VALUE_HANDLE);
+    CHECK_EQUAL(ATT_ERROR_RESPONSE, att_response[0]);
+    CHECK_EQUAL(5, response_len);
+    CHECK_EQUAL(0, default_read_count);
+}
+
+TEST(AttDbDispatch, WriteUsesWriteHandler){
+    const uint8_t value[] = { 0xaa, 0xbb };
+    uint16_t response_len = write_request(ATT_WRITE_REQUEST, ATT_CHARACTERISTIC_FF12_CONTROL_POINT_VALUE_HANDLE, value, sizeof(value));
+    CHECK_EQUAL(1, response_len);
+    CHECK_EQUAL(ATT_WRITE_RESPONSE, att_response[0]);
+    CHECK_EQUAL(1, control_point_write_count);
+    CHECK_EQUAL(ATT_TRANSACTION_MODE_NONE, control_point_transaction_mode);
+    CHECK_EQUAL(sizeof(value), control_point_value_len);
+    MEMCMP_EQUAL(value, control_point_value, sizeof(value));
+
+    response_len = write_request(ATT_WRITE_COMMAND, ATT_CHARACTERISTIC_FF12_CONTROL_POINT_VALUE_HANDLE, value, 1);
+    CHECK_EQUAL(0, response_len);
+    CHECK_EQUAL(2, control_point_write_count);
+    CHECK_EQUAL(1, control_point_value_len);
+
+    const uint8_t notifications_enabled[] = { 0x01, 0x00 };
+    response_len = write_request(ATT_WRITE_REQUEST, ATT_CHARACTERISTIC_FF11_COUNTER_CLIENT_CONFIGURATION_HANDLE, notifications_enabled, sizeof(notifications_enabled));
+    CHECK_EQUAL(1, response_len);
+    CHECK_EQUAL(1, ccc_write_count);
+    CHECK_EQUAL(0, default_write_count);
+}
+
+TEST(AttDbDispatch, PreparedWrite){
+    const uint8_t part_1[] = { 0x01, 0x02 };
+    const uint8_t part_2[] = { 0x03, 0x04 };
+    uint16_t response_len = prepare_write_request(ATT_CHARACTERISTIC_FF12_CONTROL_POINT_VALUE_HANDLE, 0, part_1, sizeof(part_1));
+    CHECK_EQUAL(ATT_PREPARE_WRITE_RESPONSE, att_response[0]);
+    CHECK_EQUAL(5 + sizeof(part_1), response_len);
+    CHECK_EQUAL(ATT_TRANSACTION_MODE_ACTIVE, control_point_transaction_mode);
+    prepare_write_request(ATT_CHARACTERISTIC_FF12_CONTROL_POINT_VALUE_HANDLE, 2, part_2, sizeof(part_2));
+    CHECK_EQUAL(2, control_point_write_count);
+    CHECK_EQUAL(4, control_point_value_len);
+
+    response_len = execute_write_request(1);
+    CHECK_EQUAL(1, response_len);
+    CHECK_EQUAL(ATT_EXECUTE_WRITE_RESPONSE, att_response[0]);
+    // validate + execute
+    CHECK_EQUAL(4, control_point_write_count);
+    CHECK_EQUAL(ATT_TRANSACTION_MODE_EXECUTE, control_point_transaction_mode);
+}
+
+TEST(AttDbDispatch, FallbackWithoutDispatchTable){
+    att_set_db(profile_data);
+    uint16_t response_len = read_request(ATT_CHARACTERISTIC_FF11_COUNTER_VALUE_HANDLE);
+    CHECK_EQUAL(2, response_len);
+    CHECK_EQUAL(0x55, att_response[1]);
+    CHECK_EQUAL(1, default_read_count);
+    CHECK_EQUAL(0, counter_read_count);
+
+    const uint8_t value[] = { 0xaa };
+    write_request(ATT_WRITE_REQUEST, ATT_CHARACTERISTIC_FF12_CONTROL_POINT_VALUE_HANDLE, value, sizeof(value));
+    CHECK_EQUAL(1, default_write_count);
+    CHECK_EQUAL(0, control_point_write_count);
+}
+
+int main (int argc, const char * argv[]){
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
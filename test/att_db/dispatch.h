@@ -0,0 +1,92 @@
+
+// dispatch.h generated from dispatch.gatt for BTstack
+
+// binary representation
+// attribute size in bytes (16), flags(16), handle (16), uuid (16/128), value(...)
+
+#include <stdint.h>
+#include "ble/att_db.h"
+
+const uint8_t profile_data[] =
+{
+    // 0x0001 PRIMARY_SERVICE-GAP_SERVICE
+    0x0a, 0x00, 0x02, 0x00, 0x01, 0x00, 0x00, 0x28, 0x00, 0x18, 
+    // 0x0002 CHARACTERISTIC-GAP_DEVICE_NAME-READ
+    0x0d, 0x00, 0x02, 0x00, 0x02, 0x00, 0x03, 0x28, 0x02, 0x03, 0x00, 0x00, 0x2a, 
+    // 0x0003 VALUE-GAP_DEVICE_NAME-READ-'Dispatch Test'
+    0x15, 0x00, 0x02, 0x00, 0x03, 0x00, 0x00, 0x2a, 0x44, 0x69, 0x73, 0x70, 0x61, 0x74, 0x63, 0x68, 0x20, 0x54, 0x65, 0x73, 0x74, 
+
+    // 0x0004 PRIMARY_SERVICE-GATT_SERVICE
+    0x0a, 0x00, 0x02, 0x00, 0x04, 0x00, 0x00, 0x28, 0x01, 0x18, 
+    // 0x0005 CHARACTERISTIC-GATT_SERVICE_CHANGED-READ
+    0x0d, 0x00, 0x02, 0x00, 0x05, 0x00, 0x03, 0x28, 0x02, 0x06, 0x00, 0x05, 0x2a, 
+    // 0x0006 VALUE-GATT_SERVICE_CHANGED-READ-''
+    0x08, 0x00, 0x02, 0x00, 0x06, 0x00, 0x05, 0x2a, 
+    // Test Service
+
+    // 0x0007 PRIMARY_SERVICE-0000FF10-0000-1000-8000-00805F9B34FB
+    0x18, 0x00, 0x02, 0x00, 0x07, 0x00, 0x00, 0x28, 0xfb, 0x34, 0x9b, 0x5f, 0x80, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x00, 0x10, 0xff, 0x00, 0x00, 
+    // Counter, with read and notify
+    // 0x0008 CHARACTERISTIC-FF11-READ | NOTIFY | DYNAMIC
+    0x0d, 0x00, 0x02, 0x00, 0x08, 0x00, 0x03, 0x28, 0x12, 0x09, 0x00, 0x11, 0xff, 
+    // 0x0009 VALUE-FF11-READ | NOTIFY | DYNAMIC-''
+    0x08, 0x00, 0x02, 0x01, 0x09, 0x00, 0x11, 0xff, 
+    // 0x000a CLIENT_CHARACTERISTIC_CONFIGURATION
+    0x0a, 0x00, 0x1b, 0x01, 0x0a, 0x00, 0x02, 0x29, 0x00, 0x00, 
+    // Control Point, write only
+    // 0x000b CHARACTERISTIC-FF12-WRITE | WRITE_WITHOUT_RESPONSE | DYNAMIC
+    0x0d, 0x00, 0x02, 0x00, 0x0b, 0x00, 0x03, 0x28, 0x0c, 0x0c, 0x00, 0x12, 0xff, 
+    // 0x000c VALUE-FF12-WRITE | WRITE_WITHOUT_RESPONSE | DYNAMIC-''
+    0x08, 0x00, 0x0c, 0x01, 0x0c, 0x00, 0x12, 0xff, 
+    // Static value
+    // 0x000d CHARACTERISTIC-FF13-READ
+    0x0d, 0x00, 0x02, 0x00, 0x0d, 0x00, 0x03, 0x28, 0x02, 0x0e, 0x00, 0x13, 0xff, 
+    // 0x000e VALUE-FF13-READ-'01 02 03'
+    0x0b, 0x00, 0x02, 0x00, 0x0e, 0x00, 0x13, 0xff, 0x01, 0x02, 0x03, 
+
+    // END
+    0x00, 0x00, 
+}; // total size 111 bytes 
+
+
+//
+// list service handle ranges
+//
+#define ATT_SERVICE_GAP_SERVICE_START_HANDLE 0x0001
+#define ATT_SERVICE_GAP_SERVICE_END_HANDLE 0x0003
+#define ATT_SERVICE_GATT_SERVICE_START_HANDLE 0x0004
+#define ATT_SERVICE_GATT_SERVICE_END_HANDLE 0x0006
+#define ATT_SERVICE_0000FF10_0000_1000_8000_00805F9B34FB_START_HANDLE 0x0007
+#define ATT_SERVICE_0000FF10_0000_1000_8000_00805F9B34FB_END_HANDLE 0x000e
+
+//
+// list mapping between characteristics and handles
+//
+#define ATT_CHARACTERISTIC_GAP_DEVICE_NAME_01_VALUE_HANDLE 0x0003
+#define ATT_CHARACTERISTIC_GATT_SERVICE_CHANGED_01_VALUE_HANDLE 0x0006
+#define ATT_CHARACTERISTIC_FF11_COUNTER_VALUE_HANDLE 0x0009
+#define ATT_CHARACTERISTIC_FF11_COUNTER_CLIENT_CONFIGURATION_HANDLE 0x000a
+#define ATT_CHARACTERISTIC_FF12_CONTROL_POINT_VALUE_HANDLE 0x000c
+#define ATT_CHARACTERISTIC_FF13_STATIC_VALUE_HANDLE 0x000e
+
+//
+// offset of attributes in profile_data, indexed by handle - 1, see att_set_db_offsets
+//
+const uint16_t profile_data_offsets[] = {
+    0x0000, 0x000a, 0x0017, 0x002c, 0x0036, 0x0043, 0x004b, 0x0063,
+    0x0070, 0x0078, 0x0082, 0x008f, 0x0097, 0x00a4,
+};
+
+//
+// read and write handlers for dynamic attributes, to be implemented by application, see att_set_db_dispatch_table
+//
+uint16_t att_characteristic_ff11_counter_value_read(hci_con_handle_t con_handle, uint16_t offset, uint8_t * buffer, uint16_t buffer_size);
+uint16_t att_characteristic_ff11_counter_client_configuration_read(hci_con_handle_t con_handle, uint16_t offset, uint8_t * buffer, uint16_t buffer_size);
+int att_characteristic_ff11_counter_client_configuration_write(hci_con_handle_t con_handle, uint16_t transaction_mode, uint16_t offset, uint8_t * buffer, uint16_t buffer_size);
+int att_characteristic_ff12_control_point_value_write(hci_con_handle_t con_handle, uint16_t transaction_mode, uint16_t offset, uint8_t * buffer, uint16_t buffer_size);
+
+const att_db_dispatch_entry_t profile_data_dispatch_table[] = {
+    { 0x0009, &att_characteristic_ff11_counter_value_read, 0 },
+    { 0x000a, &att_characteristic_ff11_counter_client_configuration_read, &att_characteristic_ff11_counter_client_configuration_write },
+    { 0x000c, 0, &att_characteristic_ff12_control_point_value_write },
+};
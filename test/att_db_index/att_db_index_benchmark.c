@@ -0,0 +1,280 @@
+/*
+ * Copyright (C) 2017 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+/*
+ *  att_db_index_benchmark.c
+ *
+ *  Runs GATT discovery and read requests from a client against a generated ATT DB with 1000 attributes.
+ *
+ *  Build with and without ENABLE_ATT_DB_INDEX to compare the lookup tables against a linear scan.
+ *  Both variants print the same checksum over all responses as last line.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "btstack_config.h"
+#include "bluetooth.h"
+#include "btstack_util.h"
+#include "ble/att_db.h"
+#include "ble/att_db_util.h"
+
+#define NUM_ATTRIBUTES          1000
+#define ATTRIBUTES_PER_SERVICE  11
+#define NUM_ROUNDS              20
+#define MAX_SERVICES            100
+
+typedef struct {
+    uint16_t start_handle;
+    uint16_t end_handle;
+} service_range_t;
+
+// characteristic value types used in vendor services
+static const uint16_t characteristic_uuids16[] = { 0x2a19, 0x2a29, 0x2a38, 0x2a3f };
+
+static att_connection_t att_connection;
+static uint8_t  request_buffer[ATT_DEFAULT_MTU];
+static uint8_t  response_buffer[ATT_DEFAULT_MTU];
+static uint32_t checksum = 0x811c9dc5;
+static uint32_t num_responses;
+static uint32_t num_requests;
+
+static uint16_t        num_attributes;
+static service_range_t services[MAX_SERVICES];
+static int             num_services;
+
+static double now_s(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static void fail(const char * reason){
+    printf("%s\n", reason);
+    exit(1);
+}
+
+// FNV-1a
+static void checksum_update(const uint8_t * data, uint16_t len){
+    uint16_t i;
+    for (i=0;i<len;i++){
+        checksum ^= data[i];
+        checksum *= 16777619;
+    }
+}
+
+static uint16_t handle_request(uint16_t request_len){
+    uint16_t response_len = att_handle_request(&att_connection, request_buffer, request_len, response_buffer);
+    checksum_update(response_buffer, response_len);
+    num_requests++;
+    num_responses++;
+    return response_len;
+}
+
+static void uuid128_for_index(uint8_t * uuid128, uint8_t type, uint16_t index){
+    static const uint8_t vendor_uuid128[] = { 0x00, 0x00, 0x00, 0x00, 0x1a, 0x2b, 0x4c, 0x3d, 0x80, 0x00, 0x00, 0x80, 0x5f, 0x9b, 0x34, 0xfb };
+    memcpy(uuid128, vendor_uuid128, 16);
+    uuid128[1] = type;
+    big_endian_store_16(uuid128, 2, index);
+}
+
+static void create_db(void){
+    uint8_t uuid128[16];
+    uint8_t value[8];
+    memset(value, 0, sizeof(value));
+
+    att_db_util_init();
+
+    // GAP Service: 3 attributes
+    att_db_util_add_service_uuid16(0x1800);
+    att_db_util_add_characteristic_uuid16(0x2a00, ATT_PROPERTY_READ, (uint8_t *) "ATT DB Index", 12);
+    num_attributes = 3;
+
+    // GATT Service with Service Changed: 4 attributes
+    att_db_util_add_service_uuid16(0x1801);
+    att_db_util_add_characteristic_uuid16(0x2a05, ATT_PROPERTY_READ | ATT_PROPERTY_INDICATE, value, 4);
+    num_attributes += 4;
+
+    // vendor services with 16 and 128-bit UUIDs
+    uint16_t i = 0;
+    while (num_attributes + ATTRIBUTES_PER_SERVICE <= NUM_ATTRIBUTES){
+        if (i & 1){
+            uuid128_for_index(uuid128, 0, i);
+            att_db_util_add_service_uuid128(uuid128);
+        } else {
+            att_db_util_add_service_uuid16(0xff00 + i);
+        }
+        value[0] = i;
+        att_db_util_add_characteristic_uuid16(characteristic_uuids16[i & 3], ATT_PROPERTY_READ, value, 1);
+        att_db_util_add_characteristic_uuid16(0x2a37, ATT_PROPERTY_READ | ATT_PROPERTY_NOTIFY, value, 2);
+        uuid128_for_index(uuid128, 1, i);
+        att_db_util_add_characteristic_uuid128(uuid128, ATT_PROPERTY_READ | ATT_PROPERTY_WRITE, value, 4);
+        uuid128_for_index(uuid128, 2, i);
+        att_db_util_add_characteristic_uuid128(uuid128, ATT_PROPERTY_READ | ATT_PROPERTY_NOTIFY, value, 8);
+        num_attributes += ATTRIBUTES_PER_SERVICE;
+        i++;
+    }
+
+    // fill up with single characteristic: 3 attributes
+    att_db_util_add_service_uuid16(0xfeff);
+    att_db_util_add_characteristic_uuid16(0x2a19, ATT_PROPERTY_READ, value, 1);
+    num_attributes += 3;
+
+    att_set_db(att_db_util_get_address());
+}
+
+static void read_all_handles(void){
+    uint16_t handle;
+    for (handle = 1; handle <= num_attributes; handle++){
+        request_buffer[0] = ATT_READ_REQUEST;
+        little_endian_store_16(request_buffer, 1, handle);
+        handle_request(3);
+    }
+}
+
+static void read_by_group_type(uint16_t start_handle, uint16_t end_handle, uint16_t uuid16, int store_services){
+    while (1){
+        request_buffer[0] = ATT_READ_BY_GROUP_TYPE_REQUEST;
+        little_endian_store_16(request_buffer, 1, start_handle);
+        little_endian_store_16(request_buffer, 3, end_handle);
+        little_endian_store_16(request_buffer, 5, uuid16);
+        uint16_t response_len = handle_request(7);
+        if (response_buffer[0] != ATT_READ_BY_GROUP_TYPE_RESPONSE) break;
+        uint8_t pair_len = response_buffer[1];
+        uint16_t pos;
+        uint16_t last_end_handle = 0;
+        for (pos = 2; pos + pair_len <= response_len; pos += pair_len){
+            last_end_handle = little_endian_read_16(response_buffer, pos + 2);
+            if (!store_services) continue;
+            if (num_services == MAX_SERVICES) fail("too many services");
+            services[num_services].start_handle = little_endian_read_16(response_buffer, pos);
+            services[num_services].end_handle   = last_end_handle;
+            num_services++;
+        }
+        // response without groups if range ends within a service
+        if (last_end_handle == 0) break;
+        if (last_end_handle >= end_handle) break;
+        start_handle = last_end_handle + 1;
+    }
+}
+
+static void read_by_type(uint16_t start_handle, uint16_t end_handle, uint16_t uuid16){
+    while (1){
+        request_buffer[0] = ATT_READ_BY_TYPE_REQUEST;
+        little_endian_store_16(request_buffer, 1, start_handle);
+        little_endian_store_16(request_buffer, 3, end_handle);
+        little_endian_store_16(request_buffer, 5, uuid16);
+        uint16_t response_len = handle_request(7);
+        if (response_buffer[0] != ATT_READ_BY_TYPE_RESPONSE) break;
+        uint8_t pair_len = response_buffer[1];
+        uint16_t last_handle = little_endian_read_16(response_buffer, response_len - pair_len);
+        if (last_handle >= end_handle) break;
+        start_handle = last_handle + 1;
+    }
+}
+
+static void discover_primary_services(void){
+    read_by_group_type(0x0001, 0xffff, GATT_PRIMARY_SERVICE_UUID, 0);
+    // range ending within a service
+    read_by_group_type(num_attributes / 4, num_attributes / 2, GATT_PRIMARY_SERVICE_UUID, 0);
+}
+
+static void discover_characteristics(void){
+    int i;
+    for (i = 0; i < num_services; i++){
+        read_by_type(services[i].start_handle, services[i].end_handle, GATT_CHARACTERISTICS_UUID);
+    }
+}
+
+static void read_using_characteristic_uuid(void){
+    int i;
+    for (i = 0; i < (int) (sizeof(characteristic_uuids16) / sizeof(uint16_t)); i++){
+        read_by_type(0x0001, 0xffff, characteristic_uuids16[i]);
+    }
+}
+
+static void lookup_uuid_for_all_handles(void){
+    uint16_t handle;
+    for (handle = 1; handle <= num_attributes; handle++){
+        uint8_t uuid16[2];
+        little_endian_store_16(uuid16, 0, att_uuid_for_handle(handle));
+        checksum_update(uuid16, 2);
+        num_requests++;
+    }
+}
+
+static void run_phase(const char * name, void (*phase)(void)){
+    num_requests = 0;
+    double start = now_s();
+    int round;
+    for (round = 0; round < NUM_ROUNDS; round++){
+        (*phase)();
+    }
+    double duration = now_s() - start;
+    printf("%-32s %6u requests, %8.1f ns/request\n", name, num_requests / NUM_ROUNDS, duration * 1e9 / num_requests);
+}
+
+int main(void){
+
+    att_connection.mtu = ATT_DEFAULT_MTU;
+    att_connection.max_mtu = ATT_DEFAULT_MTU;
+
+    double start = now_s();
+    create_db();
+    double setup_duration = now_s() - start;
+
+    // collect service ranges for characteristic discovery
+    read_by_group_type(0x0001, 0xffff, GATT_PRIMARY_SERVICE_UUID, 1);
+
+#ifdef ENABLE_ATT_DB_INDEX
+    const char * variant = "index";
+#else
+    const char * variant = "linear scan";
+#endif
+    printf("ATT DB with %u attributes in %u services, %s, setup %.1f us\n", num_attributes, num_services, variant, setup_duration * 1e6);
+
+    run_phase("Read all handles",               &read_all_handles);
+    run_phase("Discover Primary Services",      &discover_primary_services);
+    run_phase("Discover Characteristics",       &discover_characteristics);
+    run_phase("Read Using Characteristic UUID", &read_using_characteristic_uuid);
+    run_phase("att_uuid_for_handle",            &lookup_uuid_for_all_handles);
+
+    printf("checksum 0x%08x over %u responses\n", checksum, num_responses);
+    return 0;
+}
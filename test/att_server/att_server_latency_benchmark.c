@@ -0,0 +1,302 @@
+/*
+ * Copyright (C) 2017 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+ 
+/*
+ *  att_server_latency_benchmark.c
+ *
+ *  Many centrals read a characteristic from att_server.c over l2cap.c and hci.c with a mock
+ *  controller. Each central sends its next Read Request shortly after it received the response
+ *  to the previous one, so that the responses from BTstack compete for the controller buffers.
+ *
+ *  The first central reads a characteristic that requires authorization, which is granted
+ *  by the application after some time. Until then, its request is pending in att_server.
+ *
+ *  Link model: the controller provides 4 LE ACL buffers and sends one packet per 625 us slot,
+ *  in the order they were sent by the host. Requests from the centrals arrive without delay.
+ *  A central that does not receive a response within 100 ms counts it as lost and sends a new
+ *  request. Time is virtual and also used by the embedded run loop.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "btstack_config.h"
+#include "btstack_event.h"
+#include "btstack_run_loop_embedded.h"
+#include "btstack_util.h"
+#include "hci.h"
+#include "l2cap.h"
+#include "mock_controller.h"
+#include "mock_embedded.h"
+#include "ble/att_server.h"
+#include "ble/sm.h"
+
+#include "att_server_latency_benchmark.h"
+
+#define BASE_CON_HANDLE         0x0040
+#define MAX_CENTRALS            64
+#define CONTROLLER_ACL_BUFFERS  4
+#define SLOT_US                 625
+#define THINK_US                1250
+#define TIMEOUT_US              100000
+#define GRANT_US                500000
+#define DURATION_US             5000000
+#define VALUE_SIZE              (ATT_DEFAULT_MTU - 1)
+
+static const int scenarios[] = { 4, 16, 48 };
+
+typedef struct {
+    hci_con_handle_t con_handle;
+    uint16_t attribute_handle;
+    int      waiting;
+    uint32_t request_us;
+    uint32_t next_request_us;
+    uint32_t responses;
+    uint32_t first_response_us;
+    uint32_t lost;
+    uint64_t latency_us_total;
+    uint32_t latency_us_max;
+} central_t;
+
+static btstack_packet_callback_registration_t * sm_event_callback_registration;
+
+// remote devices
+static central_t centrals[MAX_CENTRALS];
+static int       num_centrals;
+
+// application
+static int      authorization_granted;
+static uint32_t authorization_checks;
+
+static double now_s(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static void fail(const char * reason){
+    printf("%u centrals: %s\n", num_centrals, reason);
+    exit(1);
+}
+
+// simulated centrals
+
+static void central_receive(central_t * central, const uint8_t * pdu){
+    if (!central->waiting) return;
+    if (pdu[0] != ATT_READ_RESPONSE) fail("unexpected ATT PDU");
+    uint32_t latency_us = mock_time_us() - central->request_us;
+    central->latency_us_total += latency_us;
+    if (latency_us > central->latency_us_max){
+        central->latency_us_max = latency_us;
+    }
+    if (central->responses == 0){
+        central->first_response_us = mock_time_us();
+    }
+    central->responses++;
+    central->waiting = 0;
+    central->next_request_us = mock_time_us() + THINK_US;
+}
+
+// mock controller: send oldest packet to remote and report it as completed
+static void controller_slot(void){
+    if (mock_controller_num_acl() == 0) return;
+    const uint8_t * packet = mock_controller_acl(0)->data;
+    hci_con_handle_t con_handle = little_endian_read_16(packet, 0) & 0x0fff;
+    if (little_endian_read_16(packet, 6) != L2CAP_CID_ATTRIBUTE_PROTOCOL) fail("unexpected CID");
+    central_receive(&centrals[con_handle - BASE_CON_HANDLE], &packet[8]);
+    mock_controller_acl_remove(1);
+    mock_controller_number_of_completed_packets(con_handle, 1);
+}
+
+static void central_send_request(central_t * central){
+    uint8_t acl[4 + 4 + 3];
+    little_endian_store_16(acl, 0, central->con_handle | (0x02 << 12));
+    little_endian_store_16(acl, 2, 4 + 3);
+    little_endian_store_16(acl, 4, 3);
+    little_endian_store_16(acl, 6, L2CAP_CID_ATTRIBUTE_PROTOCOL);
+    acl[8] = ATT_READ_REQUEST;
+    little_endian_store_16(acl, 9, central->attribute_handle);
+    central->waiting = 1;
+    central->request_us = mock_time_us();
+    mock_controller_receive_acl(acl, sizeof(acl));
+}
+
+static void centrals_run(void){
+    int i;
+    for (i = 0; i < num_centrals; i++){
+        central_t * central = &centrals[i];
+        if (central->waiting && (mock_time_us() - central->request_us) >= TIMEOUT_US){
+            central->lost++;
+            central->waiting = 0;
+            central->next_request_us = mock_time_us();
+        }
+        if (central->waiting) continue;
+        if (central->next_request_us > mock_time_us()) continue;
+        central_send_request(central);
+    }
+}
+
+// application
+
+static uint16_t att_read_callback(hci_con_handle_t con_handle, uint16_t attribute_handle, uint16_t offset, uint8_t * buffer, uint16_t buffer_size){
+    UNUSED(con_handle);
+    UNUSED(attribute_handle);
+    uint8_t value[VALUE_SIZE];
+    if (buffer){
+        memset(value, (uint8_t) mock_time_us(), sizeof(value));
+    }
+    return att_read_callback_handle_blob(value, sizeof(value), offset, buffer, buffer_size);
+}
+
+static void grant_authorization(hci_con_handle_t con_handle){
+    authorization_granted = 1;
+    uint8_t event[12];
+    event[0] = SM_EVENT_AUTHORIZATION_RESULT;
+    event[1] = sizeof(event) - 2;
+    little_endian_store_16(event, 2, con_handle);
+    event[4] = BD_ADDR_TYPE_LE_RANDOM;
+    memset(&event[5], 0, 6);
+    event[11] = 1;
+    (*sm_event_callback_registration->callback)(HCI_EVENT_PACKET, 0, event, sizeof(event));
+}
+
+static void benchmark(int the_num_centrals){
+    num_centrals = the_num_centrals;
+    mock_init(btstack_run_loop_embedded_get_instance(), mock_transport_get_instance());
+    mock_controller_set_acl_buffers(CONTROLLER_ACL_BUFFERS);
+    l2cap_init();
+    att_server_init(profile_data, &att_read_callback, NULL);
+
+    mock_controller_le_read_buffer_size(27, CONTROLLER_ACL_BUFFERS);
+    int i;
+    for (i = 0; i < num_centrals; i++){
+        central_t * central = &centrals[i];
+        central->con_handle = BASE_CON_HANDLE + i;
+        central->attribute_handle = ATT_CHARACTERISTIC_0000FF11_0000_1000_8000_00805F9B34FB_01_VALUE_HANDLE;
+        mock_controller_le_connection_complete(central->con_handle, HCI_ROLE_SLAVE, BD_ADDR_TYPE_LE_RANDOM, NULL);
+    }
+    // first central is authenticated and reads protected value
+    centrals[0].attribute_handle = ATT_CHARACTERISTIC_0000FF12_0000_1000_8000_00805F9B34FB_01_VALUE_HANDLE;
+    mock_controller_encryption_change(centrals[0].con_handle);
+
+    double start = now_s();
+    uint32_t time_us;
+    for (time_us = 0; time_us < DURATION_US; time_us += SLOT_US){
+        mock_set_time_us(time_us);
+        if (time_us == GRANT_US){
+            grant_authorization(centrals[0].con_handle);
+        }
+        centrals_run();
+        controller_slot();
+        btstack_run_loop_embedded_execute_once();
+    }
+    double elapsed = now_s() - start;
+
+    uint32_t responses = 0;
+    uint32_t responses_min = 0xffffffff;
+    uint32_t responses_max = 0;
+    uint32_t lost = 0;
+    uint64_t latency_us_total = 0;
+    uint32_t latency_us_max = 0;
+    for (i = 1; i < num_centrals; i++){
+        central_t * central = &centrals[i];
+        responses += central->responses;
+        responses_min = btstack_min(responses_min, central->responses);
+        responses_max = btstack_max(responses_max, central->responses);
+        lost += central->lost;
+        latency_us_total += central->latency_us_total;
+        latency_us_max = btstack_max(latency_us_max, central->latency_us_max);
+    }
+    printf("%2u centrals: %6u responses, per central min %4u max %4u, latency avg %5.1f max %5.1f ms, %3u lost, host %5.0f ns/response\n",
+        num_centrals, responses, responses_min, responses_max, responses ? latency_us_total / 1000.0 / responses : 0.0,
+        latency_us_max / 1000.0, lost, elapsed * 1e9 / responses);
+    if (centrals[0].responses == 0){
+        printf("             authorization pending %.0f ms: %u checks, no response after grant\n",
+            GRANT_US / 1000.0, authorization_checks);
+        return;
+    }
+    printf("             authorization pending %.0f ms: %u checks, first response %5.1f ms after grant\n",
+        GRANT_US / 1000.0, authorization_checks, (centrals[0].first_response_us - GRANT_US) / 1000.0);
+}
+
+// stubs for Security Manager
+
+void sm_add_event_handler(btstack_packet_callback_registration_t * callback_handler){
+    sm_event_callback_registration = callback_handler;
+}
+
+int sm_encryption_key_size(hci_con_handle_t con_handle){
+    return con_handle == centrals[0].con_handle ? 16 : 0;
+}
+
+int sm_authenticated(hci_con_handle_t con_handle){
+    return con_handle == centrals[0].con_handle;
+}
+
+authorization_state_t sm_authorization_state(hci_con_handle_t con_handle){
+    UNUSED(con_handle);
+    authorization_checks++;
+    return authorization_granted ? AUTHORIZATION_GRANTED : AUTHORIZATION_PENDING;
+}
+
+void sm_request_pairing(hci_con_handle_t con_handle){
+    UNUSED(con_handle);
+}
+
+int main(void){
+    printf("ATT Server latency, %u LE ACL buffers, one packet per %u us, next request %u us after response\n",
+        CONTROLLER_ACL_BUFFERS, SLOT_US, THINK_US);
+    unsigned int i;
+    for (i = 0; i < sizeof(scenarios) / sizeof(int); i++){
+        // hci.c can only be initialized once per process
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid == 0){
+            benchmark(scenarios[i]);
+            exit(0);
+        }
+        int status;
+        waitpid(pid, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status)) return 1;
+    }
+    return 0;
+}
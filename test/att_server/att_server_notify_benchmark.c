@@ -0,0 +1,374 @@
+/*
+ * Copyright (C) 2017 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+ 
+/*
+ *  att_server_notify_benchmark.c
+ *
+ *  Stream sensor values as notifications through att_server.c, l2cap.c and hci.c to a mock
+ *  controller, comparing three ways to send them:
+ *  - notify:     call att_server_notify for each sample, drop sample if it fails
+ *  - le_streamer: keep latest value per characteristic and send one notification per
+ *                 ATT_EVENT_CAN_SEND_NOW, as done in example/le_streamer.c
+ *  - queue:      call att_server_queue_notification for each sample
+ *
+ *  Four sensors with their own characteristic produce samples at a fixed interval. Each sample
+ *  carries its time stamp, which is used to calculate the age of a value on delivery.
+ *
+ *  In queue mode, a status service registers a can send now callback every 100 ms, which must
+ *  not be starved by queued notifications. This is also checked on a congested link, where the
+ *  controller only sends 2 packets per connection event and the queues never drain.
+ *
+ *  Link model: the controller provides 8 LE ACL buffers and sends up to 6 packets in each
+ *  connection event every 7.5 ms. After the connection event, it reports the packets as completed.
+ *  Time is virtual and also used by the embedded run loop.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "btstack_config.h"
+#include "btstack_event.h"
+#include "btstack_run_loop_embedded.h"
+#include "btstack_util.h"
+#include "hci.h"
+#include "l2cap.h"
+#include "mock_controller.h"
+#include "mock_embedded.h"
+#include "ble/att_server.h"
+#include "ble/sm.h"
+
+#include "att_server_notify_benchmark.h"
+
+#define CON_HANDLE              0x0040
+#define CONTROLLER_ACL_BUFFERS  8
+#define PACKETS_PER_EVENT       6
+#define PACKETS_PER_EVENT_CONGESTED 2
+#define CONN_INTERVAL_US        7500
+#define DURATION_US             10000000
+#define NUM_SENSORS             4
+#define VALUE_SIZE              (ATT_DEFAULT_MTU - 3)
+#define STATUS_INTERVAL_US      100000
+
+typedef enum {
+    MODE_NOTIFY,
+    MODE_LE_STREAMER,
+    MODE_QUEUE,
+} send_mode_t;
+
+static const char * mode_names[] = { "notify", "le_streamer", "queue" };
+
+static const uint32_t sample_intervals_us[] = { 10000, 5000, 2500, 1000 };
+
+static const uint16_t sensor_value_handles[NUM_SENSORS] = {
+    ATT_CHARACTERISTIC_0000FF11_0000_1000_8000_00805F9B34FB_01_VALUE_HANDLE,
+    ATT_CHARACTERISTIC_0000FF13_0000_1000_8000_00805F9B34FB_01_VALUE_HANDLE,
+    ATT_CHARACTERISTIC_0000FF14_0000_1000_8000_00805F9B34FB_01_VALUE_HANDLE,
+    ATT_CHARACTERISTIC_0000FF15_0000_1000_8000_00805F9B34FB_01_VALUE_HANDLE,
+};
+
+static btstack_packet_callback_registration_t hci_event_callback_registration;
+static send_mode_t mode;
+
+// simulated link
+static int      packets_per_event;
+static uint32_t connection_events;
+static uint32_t delivered;
+static uint64_t age_us_total;
+static uint32_t age_us_max;
+
+// application
+static uint32_t samples;
+static uint32_t samples_dropped;
+static uint32_t can_send_now_events;
+static uint8_t  sensor_values[NUM_SENSORS][VALUE_SIZE];
+static int      sensor_dirty[NUM_SENSORS];
+static int      sensor_index;
+
+// status service with can send now callback
+static btstack_context_callback_registration_t status_callback_registration;
+static int      status_registered;
+static uint32_t status_registered_us;
+static uint32_t status_requests;
+static uint32_t status_served;
+static uint32_t status_wait_us_max;
+
+static double now_s(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static void fail(const char * reason){
+    printf("%s: %s\n", mode_names[mode], reason);
+    exit(1);
+}
+
+// mock controller
+
+// send buffered notifications to remote and report them as completed
+static void controller_connection_event(void){
+    int num_packets = btstack_min(mock_controller_num_acl(), packets_per_event);
+    int i;
+    for (i = 0; i < num_packets; i++){
+        const uint8_t * packet = mock_controller_acl(i)->data;
+        // ACL header, L2CAP header, ATT opcode, handle, value
+        if (mock_controller_acl(i)->size != 4 + 4 + 3 + VALUE_SIZE) fail("unexpected packet size");
+        if (little_endian_read_16(packet, 6) != L2CAP_CID_ATTRIBUTE_PROTOCOL) fail("unexpected CID");
+        if (packet[8] != ATT_HANDLE_VALUE_NOTIFICATION) fail("unexpected ATT PDU");
+        uint32_t age_us = mock_time_us() - little_endian_read_32(packet, 11);
+        age_us_total += age_us;
+        if (age_us > age_us_max){
+            age_us_max = age_us;
+        }
+        delivered++;
+    }
+    mock_controller_acl_remove(num_packets);
+    connection_events++;
+    if (num_packets == 0) return;
+    mock_controller_number_of_completed_packets(CON_HANDLE, num_packets);
+}
+
+// application
+
+static void le_streamer_send(void){
+    int i;
+    for (i = 0; i < NUM_SENSORS; i++){
+        if (sensor_dirty[sensor_index]) break;
+        sensor_index = (sensor_index + 1) % NUM_SENSORS;
+    }
+    if (!sensor_dirty[sensor_index]) return;
+    if (att_server_notify(CON_HANDLE, sensor_value_handles[sensor_index], sensor_values[sensor_index], VALUE_SIZE)) fail("att_server_notify failed");
+    sensor_dirty[sensor_index] = 0;
+    sensor_index = (sensor_index + 1) % NUM_SENSORS;
+    for (i = 0; i < NUM_SENSORS; i++){
+        if (!sensor_dirty[i]) continue;
+        att_server_request_can_send_now_event(CON_HANDLE);
+        break;
+    }
+}
+
+static void packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size){
+    UNUSED(channel);
+    UNUSED(size);
+    if (packet_type != HCI_EVENT_PACKET) return;
+    if (hci_event_packet_get_type(packet) != ATT_EVENT_CAN_SEND_NOW) return;
+    can_send_now_events++;
+    le_streamer_send();
+}
+
+static void status_can_send_now(void * context){
+    UNUSED(context);
+    status_served++;
+    status_registered = 0;
+    uint32_t wait_us = mock_time_us() - status_registered_us;
+    if (wait_us > status_wait_us_max){
+        status_wait_us_max = wait_us;
+    }
+    uint8_t value[VALUE_SIZE];
+    memset(value, 'S', VALUE_SIZE);
+    little_endian_store_32(value, 0, mock_time_us());
+    if (att_server_notify(CON_HANDLE, sensor_value_handles[0], value, VALUE_SIZE)) fail("status notification failed");
+}
+
+static void status_request(void){
+    if (status_registered) return;
+    status_requests++;
+    status_registered = 1;
+    status_registered_us = mock_time_us();
+    status_callback_registration.callback = &status_can_send_now;
+    status_callback_registration.context  = (void *) (uintptr_t) CON_HANDLE;
+    att_server_register_can_send_now_callback(&status_callback_registration, CON_HANDLE);
+}
+
+static void sensor_sample(int sensor){
+    samples++;
+    uint8_t * value = sensor_values[sensor];
+    memset(value, 'A' + sensor, VALUE_SIZE);
+    little_endian_store_32(value, 0, mock_time_us());
+    switch (mode){
+        case MODE_NOTIFY:
+            if (att_server_notify(CON_HANDLE, sensor_value_handles[sensor], value, VALUE_SIZE)){
+                samples_dropped++;
+            }
+            break;
+        case MODE_LE_STREAMER:
+            if (sensor_dirty[sensor]) break;
+            sensor_dirty[sensor] = 1;
+            att_server_request_can_send_now_event(CON_HANDLE);
+            break;
+        case MODE_QUEUE:
+            if (att_server_queue_notification(CON_HANDLE, sensor_value_handles[sensor], value, VALUE_SIZE)){
+                samples_dropped++;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+static void benchmark(send_mode_t the_mode, uint32_t sample_interval_us, int the_packets_per_event){
+    mode = the_mode;
+    packets_per_event = the_packets_per_event;
+    mock_init(btstack_run_loop_embedded_get_instance(), mock_transport_get_instance());
+    mock_controller_set_acl_buffers(CONTROLLER_ACL_BUFFERS);
+    l2cap_init();
+    att_server_init(profile_data, NULL, NULL);
+    hci_event_callback_registration.callback = &packet_handler;
+    hci_add_event_handler(&hci_event_callback_registration);
+    att_server_register_packet_handler(&packet_handler);
+
+    mock_controller_le_read_buffer_size(27, CONTROLLER_ACL_BUFFERS);
+    mock_controller_le_connection_complete(CON_HANDLE, HCI_ROLE_SLAVE, BD_ADDR_TYPE_LE_RANDOM, NULL);
+
+    // sensors sample with offset
+    uint32_t next_sample_us[NUM_SENSORS];
+    int i;
+    for (i = 0; i < NUM_SENSORS; i++){
+        next_sample_us[i] = sample_interval_us * i / NUM_SENSORS;
+    }
+    uint32_t next_connection_event_us = CONN_INTERVAL_US;
+    uint32_t next_status_us = STATUS_INTERVAL_US;
+
+    double start = now_s();
+    while (mock_time_us() < DURATION_US){
+        int sensor = 0;
+        for (i = 1; i < NUM_SENSORS; i++){
+            if (next_sample_us[i] < next_sample_us[sensor]){
+                sensor = i;
+            }
+        }
+        if (mode == MODE_QUEUE && next_status_us < next_connection_event_us && next_status_us <= next_sample_us[sensor]){
+            mock_set_time_us(next_status_us);
+            next_status_us += STATUS_INTERVAL_US;
+            status_request();
+        } else if (next_sample_us[sensor] < next_connection_event_us){
+            mock_set_time_us(next_sample_us[sensor]);
+            next_sample_us[sensor] += sample_interval_us;
+            sensor_sample(sensor);
+        } else {
+            mock_set_time_us(next_connection_event_us);
+            next_connection_event_us += CONN_INTERVAL_US;
+            controller_connection_event();
+        }
+        btstack_run_loop_embedded_execute_once();
+    }
+    double elapsed = now_s() - start;
+
+    printf("%-11s sample every %5.1f ms: %5u samples, %5u delivered, %4.2f per event, %5.1f%% dropped, age avg %5.1f max %5.1f ms, %4u can send now, host %6.0f ns/sample\n",
+        mode_names[mode], sample_interval_us / 1000.0, samples, delivered, (double) delivered / connection_events,
+        samples_dropped * 100.0 / samples, delivered ? age_us_total / 1000.0 / delivered : 0.0, age_us_max / 1000.0,
+        can_send_now_events, elapsed * 1e9 / samples);
+
+    if (mode == MODE_QUEUE){
+        att_server_notification_stats_t stats;
+        if (att_server_get_notification_stats(CON_HANDLE, &stats)) fail("no stats");
+        printf("%-11s queued %u, coalesced %u, dropped %u, sent %u, queue latency avg %.1f max %u ms\n", "",
+            stats.queued, stats.coalesced, stats.dropped, stats.sent,
+            stats.sent ? (double) stats.latency_ms_total / stats.sent : 0.0, stats.latency_ms_max);
+        if (stats.queued + stats.coalesced + stats.dropped != samples) fail("samples not accounted for");
+        // include callback still waiting
+        if (status_registered && mock_time_us() - status_registered_us > status_wait_us_max){
+            status_wait_us_max = mock_time_us() - status_registered_us;
+        }
+        printf("%-11s status callbacks %u/%u served, wait max %.1f ms\n", "",
+            status_served, status_requests, status_wait_us_max / 1000.0);
+        if (status_wait_us_max > 2 * CONN_INTERVAL_US) fail("can send now callback starved");
+    }
+}
+
+// stubs for Security Manager
+
+void sm_add_event_handler(btstack_packet_callback_registration_t * callback_handler){
+    UNUSED(callback_handler);
+}
+
+int sm_encryption_key_size(hci_con_handle_t con_handle){
+    UNUSED(con_handle);
+    return 0;
+}
+
+int sm_authenticated(hci_con_handle_t con_handle){
+    UNUSED(con_handle);
+    return 0;
+}
+
+authorization_state_t sm_authorization_state(hci_con_handle_t con_handle){
+    UNUSED(con_handle);
+    return AUTHORIZATION_UNKNOWN;
+}
+
+void sm_request_pairing(hci_con_handle_t con_handle){
+    UNUSED(con_handle);
+}
+
+int main(void){
+    printf("ATT Server notifications, %u sensors with %u byte values, connection interval %.1f ms, up to %u packets per connection event\n",
+        NUM_SENSORS, VALUE_SIZE, CONN_INTERVAL_US / 1000.0, PACKETS_PER_EVENT);
+    unsigned int i;
+    int m;
+    for (i = 0; i < sizeof(sample_intervals_us) / sizeof(uint32_t); i++){
+        for (m = MODE_NOTIFY; m <= MODE_QUEUE; m++){
+            // hci.c can only be initialized once per process
+            fflush(stdout);
+            pid_t pid = fork();
+            if (pid == 0){
+                benchmark((send_mode_t) m, sample_intervals_us[i], PACKETS_PER_EVENT);
+                exit(0);
+            }
+            int status;
+            waitpid(pid, &status, 0);
+            if (!WIFEXITED(status) || WEXITSTATUS(status)) return 1;
+        }
+    }
+
+    printf("Congested link, up to %u packets per connection event\n", PACKETS_PER_EVENT_CONGESTED);
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0){
+        benchmark(MODE_QUEUE, 1000, PACKETS_PER_EVENT_CONGESTED);
+        exit(0);
+    }
+    int status;
+    waitpid(pid, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status)) return 1;
+    return 0;
+}
@@ -0,0 +1,88 @@
+
+// att_server_notify_benchmark.h generated from att_server_notify_benchmark.gatt for BTstack
+
+// binary representation
+// attribute size in bytes (16), flags(16), handle (16), uuid (16/128), value(...)
+
+#include <stdint.h>
+
+const uint8_t profile_data[] =
+{
+    // 0x0001 PRIMARY_SERVICE-GAP_SERVICE
+    0x0a, 0x00, 0x02, 0x00, 0x01, 0x00, 0x00, 0x28, 0x00, 0x18, 
+    // 0x0002 CHARACTERISTIC-GAP_DEVICE_NAME-READ
+    0x0d, 0x00, 0x02, 0x00, 0x02, 0x00, 0x03, 0x28, 0x02, 0x03, 0x00, 0x00, 0x2a, 
+    // 0x0003 VALUE-GAP_DEVICE_NAME-READ-'LE Streamer'
+    0x13, 0x00, 0x02, 0x00, 0x03, 0x00, 0x00, 0x2a, 0x4c, 0x45, 0x20, 0x53, 0x74, 0x72, 0x65, 0x61, 0x6d, 0x65, 0x72, 
+
+    // 0x0004 PRIMARY_SERVICE-GATT_SERVICE
+    0x0a, 0x00, 0x02, 0x00, 0x04, 0x00, 0x00, 0x28, 0x01, 0x18, 
+    // 0x0005 CHARACTERISTIC-GATT_SERVICE_CHANGED-READ
+    0x0d, 0x00, 0x02, 0x00, 0x05, 0x00, 0x03, 0x28, 0x02, 0x06, 0x00, 0x05, 0x2a, 
+    // 0x0006 VALUE-GATT_SERVICE_CHANGED-READ-''
+    0x08, 0x00, 0x02, 0x00, 0x06, 0x00, 0x05, 0x2a, 
+    // Test Service from le_streamer.gatt with additional sensor characteristics
+
+    // 0x0007 PRIMARY_SERVICE-0000FF10-0000-1000-8000-00805F9B34FB
+    0x18, 0x00, 0x02, 0x00, 0x07, 0x00, 0x00, 0x28, 0xfb, 0x34, 0x9b, 0x5f, 0x80, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x00, 0x10, 0xff, 0x00, 0x00, 
+    // Test Characteristic, only notify
+    // 0x0008 CHARACTERISTIC-0000FF11-0000-1000-8000-00805F9B34FB-NOTIFY
+    0x1b, 0x00, 0x02, 0x00, 0x08, 0x00, 0x03, 0x28, 0x10, 0x09, 0x00, 0xfb, 0x34, 0x9b, 0x5f, 0x80, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x00, 0x11, 0xff, 0x00, 0x00, 
+    // 0x0009 VALUE-0000FF11-0000-1000-8000-00805F9B34FB-NOTIFY-''
+    0x16, 0x00, 0x00, 0x02, 0x09, 0x00, 0xfb, 0x34, 0x9b, 0x5f, 0x80, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x00, 0x11, 0xff, 0x00, 0x00, 
+    // 0x000a CLIENT_CHARACTERISTIC_CONFIGURATION
+    0x0a, 0x00, 0x1b, 0x01, 0x0a, 0x00, 0x02, 0x29, 0x00, 0x00, 
+    // Test Characterisitic, only write_without_response
+    // 0x000b CHARACTERISTIC-0000FF12-0000-1000-8000-00805F9B34FB-WRITE_WITHOUT_RESPONSE | DYNAMIC
+    0x1b, 0x00, 0x02, 0x00, 0x0b, 0x00, 0x03, 0x28, 0x04, 0x0c, 0x00, 0xfb, 0x34, 0x9b, 0x5f, 0x80, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x00, 0x12, 0xff, 0x00, 0x00, 
+    // 0x000c VALUE-0000FF12-0000-1000-8000-00805F9B34FB-WRITE_WITHOUT_RESPONSE | DYNAMIC-''
+    0x16, 0x00, 0x04, 0x03, 0x0c, 0x00, 0xfb, 0x34, 0x9b, 0x5f, 0x80, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x00, 0x12, 0xff, 0x00, 0x00, 
+    // Sensor Characteristics, only notify
+    // 0x000d CHARACTERISTIC-0000FF13-0000-1000-8000-00805F9B34FB-NOTIFY
+    0x1b, 0x00, 0x02, 0x00, 0x0d, 0x00, 0x03, 0x28, 0x10, 0x0e, 0x00, 0xfb, 0x34, 0x9b, 0x5f, 0x80, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x00, 0x13, 0xff, 0x00, 0x00, 
+    // 0x000e VALUE-0000FF13-0000-1000-8000-00805F9B34FB-NOTIFY-''
+    0x16, 0x00, 0x00, 0x02, 0x0e, 0x00, 0xfb, 0x34, 0x9b, 0x5f, 0x80, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x00, 0x13, 0xff, 0x00, 0x00, 
+    // 0x000f CLIENT_CHARACTERISTIC_CONFIGURATION
+    0x0a, 0x00, 0x1b, 0x01, 0x0f, 0x00, 0x02, 0x29, 0x00, 0x00, 
+    // 0x0010 CHARACTERISTIC-0000FF14-0000-1000-8000-00805F9B34FB-NOTIFY
+    0x1b, 0x00, 0x02, 0x00, 0x10, 0x00, 0x03, 0x28, 0x10, 0x11, 0x00, 0xfb, 0x34, 0x9b, 0x5f, 0x80, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x00, 0x14, 0xff, 0x00, 0x00, 
+    // 0x0011 VALUE-0000FF14-0000-1000-8000-00805F9B34FB-NOTIFY-''
+    0x16, 0x00, 0x00, 0x02, 0x11, 0x00, 0xfb, 0x34, 0x9b, 0x5f, 0x80, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x00, 0x14, 0xff, 0x00, 0x00, 
+    // 0x0012 CLIENT_CHARACTERISTIC_CONFIGURATION
+    0x0a, 0x00, 0x1b, 0x01, 0x12, 0x00, 0x02, 0x29, 0x00, 0x00, 
+    // 0x0013 CHARACTERISTIC-0000FF15-0000-1000-8000-00805F9B34FB-NOTIFY
+    0x1b, 0x00, 0x02, 0x00, 0x13, 0x00, 0x03, 0x28, 0x10, 0x14, 0x00, 0xfb, 0x34, 0x9b, 0x5f, 0x80, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x00, 0x15, 0xff, 0x00, 0x00, 
+    // 0x0014 VALUE-0000FF15-0000-1000-8000-00805F9B34FB-NOTIFY-''
+    0x16, 0x00, 0x00, 0x02, 0x14, 0x00, 0xfb, 0x34, 0x9b, 0x5f, 0x80, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x00, 0x15, 0xff, 0x00, 0x00, 
+    // 0x0015 CLIENT_CHARACTERISTIC_CONFIGURATION
+    0x0a, 0x00, 0x1b, 0x01, 0x15, 0x00, 0x02, 0x29, 0x00, 0x00, 
+
+    // END
+    0x00, 0x00, 
+}; // total size 207 bytes 
+
+
+//
+// list service handle ranges
+//
+#define ATT_SERVICE_GAP_SERVICE_START_HANDLE 0x0001
+#define ATT_SERVICE_GAP_SERVICE_END_HANDLE 0x0003
+#define ATT_SERVICE_GATT_SERVICE_START_HANDLE 0x0004
+#define ATT_SERVICE_GATT_SERVICE_END_HANDLE 0x0006
+#define ATT_SERVICE_0000FF10_0000_1000_8000_00805F9B34FB_START_HANDLE 0x0007
+#define ATT_SERVICE_0000FF10_0000_1000_8000_00805F9B34FB_END_HANDLE 0x0015
+
+//
+// list mapping between characteristics and handles
+//
+#define ATT_CHARACTERISTIC_GAP_DEVICE_NAME_01_VALUE_HANDLE 0x0003
+#define ATT_CHARACTERISTIC_GATT_SERVICE_CHANGED_01_VALUE_HANDLE 0x0006
+#define ATT_CHARACTERISTIC_0000FF11_0000_1000_8000_00805F9B34FB_01_VALUE_HANDLE 0x0009
+#define ATT_CHARACTERISTIC_0000FF11_0000_1000_8000_00805F9B34FB_01_CLIENT_CONFIGURATION_HANDLE 0x000a
+#define ATT_CHARACTERISTIC_0000FF12_0000_1000_8000_00805F9B34FB_01_VALUE_HANDLE 0x000c
+#define ATT_CHARACTERISTIC_0000FF13_0000_1000_8000_00805F9B34FB_01_VALUE_HANDLE 0x000e
+#define ATT_CHARACTERISTIC_0000FF13_0000_1000_8000_00805F9B34FB_01_CLIENT_CONFIGURATION_HANDLE 0x000f
+#define ATT_CHARACTERISTIC_0000FF14_0000_1000_8000_00805F9B34FB_01_VALUE_HANDLE 0x0011
+#define ATT_CHARACTERISTIC_0000FF14_0000_1000_8000_00805F9B34FB_01_CLIENT_CONFIGURATION_HANDLE 0x0012
+#define ATT_CHARACTERISTIC_0000FF15_0000_1000_8000_00805F9B34FB_01_VALUE_HANDLE 0x0014
+#define ATT_CHARACTERISTIC_0000FF15_0000_1000_8000_00805F9B34FB_01_CLIENT_CONFIGURATION_HANDLE 0x0015
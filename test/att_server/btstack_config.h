@@ -0,0 +1,22 @@
+//
+// btstack_config.h for ATT Server notification benchmark
+//
+
+#ifndef __BTSTACK_CONFIG
+#define __BTSTACK_CONFIG
+
+// Port related features
+#define HAVE_EMBEDDED_TIME_MS
+#define HAVE_MALLOC
+
+// BTstack features that can be enabled
+#define ENABLE_BLE
+#define ENABLE_LE_PERIPHERAL
+#define ENABLE_ATT_SERVER_NOTIFICATION_QUEUE
+#define ENABLE_LOG_ERROR
+
+// BTstack configuration. buffers, sizes, ...
+#define HCI_ACL_PAYLOAD_SIZE 52
+#define HCI_INCOMING_PRE_BUFFER_SIZE 4
+
+#endif
@@ -0,0 +1,22 @@
+//
+// btstack_config.h for GATT Client reconnect benchmark
+//
+
+#ifndef __BTSTACK_CONFIG
+#define __BTSTACK_CONFIG
+
+// Port related features
+#define HAVE_EMBEDDED_TIME_MS
+#define HAVE_MALLOC
+
+// BTstack features that can be enabled
+#define ENABLE_BLE
+#define ENABLE_LE_CENTRAL
+#define ENABLE_GATT_CLIENT_DISCOVERY_CACHE
+#define ENABLE_LOG_ERROR
+
+// BTstack configuration. buffers, sizes, ...
+#define HCI_ACL_PAYLOAD_SIZE 27
+#define HCI_INCOMING_PRE_BUFFER_SIZE 4
+
+#endif
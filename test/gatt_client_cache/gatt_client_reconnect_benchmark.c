@@ -0,0 +1,405 @@
+/*
+ * Copyright (C) 2017 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+/*
+ *  gatt_client_reconnect_benchmark.c
+ *
+ *  A central reconnects to a bonded peripheral and discovers all services, characteristics
+ *  and descriptors with gatt_client.c over l2cap.c and hci.c with a mock controller. The
+ *  peripheral is simulated with att_db.c. Each ATT request is answered one connection interval
+ *  later. Time is virtual and also used by the embedded run loop.
+ *
+ *  The discovery results are compared against an uncached discovery of the same database.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "btstack_config.h"
+#include "btstack_event.h"
+#include "btstack_run_loop_embedded.h"
+#include "btstack_tlv.h"
+#include "btstack_util.h"
+#include "bluetooth_gatt.h"
+#include "hci.h"
+#include "l2cap.h"
+#include "mock_controller.h"
+#include "mock_embedded.h"
+#include "ble/att_db.h"
+#include "ble/gatt_client.h"
+#include "ble/le_device_db.h"
+#include "ble/sm.h"
+
+#include "peripheral_v1.h"
+// v2 has an additional characteristic at the end of the sensor service
+#undef  ATT_SERVICE_0000FF10_0000_1000_8000_00805F9B34FB_END_HANDLE
+#define profile_data peripheral_v2_profile_data
+#include "peripheral_v2.h"
+#undef profile_data
+
+#define CON_HANDLE               0x0040
+#define CONNECTION_INTERVAL_US   30000
+#define MAX_PENDING_PACKETS      4
+#define MAX_SERVICES             16
+#define MAX_CHARACTERISTICS      32
+#define TLV_MAX_TAGS             4
+#define TLV_MAX_VALUE_SIZE       (sizeof(gatt_client_discovery_cache_t))
+
+typedef enum {
+    PERIPHERAL_V1,
+    PERIPHERAL_V2,
+} peripheral_version_t;
+
+typedef struct {
+    uint32_t delivery_us;
+    uint8_t  packet_type;
+    uint16_t size;
+    uint8_t  data[4 + HCI_ACL_PAYLOAD_SIZE];
+} pending_packet_t;
+
+typedef enum {
+    DISCOVER_SERVICES,
+    DISCOVER_CHARACTERISTICS,
+    DISCOVER_DESCRIPTORS,
+    DISCOVERY_DONE,
+} discovery_state_t;
+
+// simulated link and peripheral
+static pending_packet_t pending_packets[MAX_PENDING_PACKETS];
+static int              num_pending_packets;
+static const bd_addr_t  peripheral_address = { 0, 0, 0, 0, 0, 0 };
+static att_connection_t peripheral_connection;
+static uint32_t         att_requests;
+
+// memory tlv
+static uint32_t tlv_tags[TLV_MAX_TAGS];
+static uint8_t  tlv_values[TLV_MAX_TAGS][TLV_MAX_VALUE_SIZE];
+static uint32_t tlv_sizes[TLV_MAX_TAGS];
+static int      tlv_num_tags;
+static uint32_t tlv_bytes_stored;
+
+// central application
+static discovery_state_t      discovery_state;
+static gatt_client_service_t  services[MAX_SERVICES];
+static int                    num_services;
+static int                    service_index;
+static gatt_client_characteristic_t characteristics[MAX_CHARACTERISTICS];
+static int                    num_characteristics;
+static int                    characteristic_index;
+static int                    num_descriptors;
+static uint32_t               results_hash;
+
+// memory tlv
+
+static int tlv_index_for_tag(uint32_t tag){
+    int i;
+    for (i = 0; i < tlv_num_tags; i++){
+        if (tlv_tags[i] == tag) return i;
+    }
+    return -1;
+}
+
+static int tlv_get_tag(void * context, uint32_t tag, uint8_t * buffer, uint32_t buffer_size){
+    UNUSED(context);
+    int index = tlv_index_for_tag(tag);
+    if (index < 0) return 0;
+    uint32_t size = btstack_min(tlv_sizes[index], buffer_size);
+    memcpy(buffer, tlv_values[index], size);
+    return size;
+}
+
+static int tlv_store_tag(void * context, uint32_t tag, const uint8_t * data, uint32_t data_size){
+    UNUSED(context);
+    if (data_size > TLV_MAX_VALUE_SIZE) mock_fail("tlv value too large");
+    int index = tlv_index_for_tag(tag);
+    if (index < 0){
+        if (tlv_num_tags == TLV_MAX_TAGS) mock_fail("tlv full");
+        index = tlv_num_tags++;
+        tlv_tags[index] = tag;
+    }
+    memcpy(tlv_values[index], data, data_size);
+    tlv_sizes[index] = data_size;
+    tlv_bytes_stored += data_size;
+    return 0;
+}
+
+static void tlv_delete_tag(void * context, uint32_t tag){
+    UNUSED(context);
+    int index = tlv_index_for_tag(tag);
+    if (index < 0) return;
+    tlv_num_tags--;
+    tlv_tags[index]   = tlv_tags[tlv_num_tags];
+    tlv_sizes[index]  = tlv_sizes[tlv_num_tags];
+    memcpy(tlv_values[index], tlv_values[tlv_num_tags], TLV_MAX_VALUE_SIZE);
+}
+
+static const btstack_tlv_t memory_tlv = {
+    &tlv_get_tag,
+    &tlv_store_tag,
+    &tlv_delete_tag,
+};
+
+// mock controller
+
+static void queue_packet(uint32_t delivery_us, uint8_t packet_type, const uint8_t * data, uint16_t size){
+    if (num_pending_packets == MAX_PENDING_PACKETS) mock_fail("too many pending packets");
+    pending_packet_t * packet = &pending_packets[num_pending_packets++];
+    packet->delivery_us = delivery_us;
+    packet->packet_type = packet_type;
+    packet->size = size;
+    memcpy(packet->data, data, size);
+}
+
+static void queue_att_pdu(uint32_t delivery_us, const uint8_t * pdu, uint16_t size){
+    uint8_t acl[4 + HCI_ACL_PAYLOAD_SIZE];
+    little_endian_store_16(acl, 0, CON_HANDLE | (0x02 << 12));
+    little_endian_store_16(acl, 2, 4 + size);
+    little_endian_store_16(acl, 4, size);
+    little_endian_store_16(acl, 6, L2CAP_CID_ATTRIBUTE_PROTOCOL);
+    memcpy(&acl[8], pdu, size);
+    queue_packet(delivery_us, HCI_ACL_DATA_PACKET, acl, 8 + size);
+}
+
+// deliver packets in order of delivery time
+static int deliver_next_packet(void){
+    if (num_pending_packets == 0) return 0;
+    int next = 0;
+    int i;
+    for (i = 1; i < num_pending_packets; i++){
+        if (pending_packets[i].delivery_us < pending_packets[next].delivery_us){
+            next = i;
+        }
+    }
+    pending_packet_t packet = pending_packets[next];
+    num_pending_packets--;
+    memmove(&pending_packets[next], &pending_packets[next + 1], (num_pending_packets - next) * sizeof(pending_packet_t));
+    if (packet.delivery_us > mock_time_us()){
+        mock_set_time_us(packet.delivery_us);
+    }
+    if (packet.packet_type == HCI_EVENT_PACKET){
+        mock_controller_send_event(packet.data, packet.size);
+    } else {
+        mock_controller_receive_acl(packet.data, packet.size);
+    }
+    return 1;
+}
+
+// peripheral answers in next connection event, packet is completed right away
+static void peripheral_receive_packet(uint8_t packet_type, uint8_t *packet, uint16_t size){
+    if (packet_type != HCI_ACL_DATA_PACKET) return;
+    if (little_endian_read_16(packet, 6) != L2CAP_CID_ATTRIBUTE_PROTOCOL) mock_fail("unexpected CID");
+
+    uint8_t event[7];
+    event[0] = HCI_EVENT_NUMBER_OF_COMPLETED_PACKETS;
+    event[1] = sizeof(event) - 2;
+    event[2] = 1;
+    little_endian_store_16(event, 3, CON_HANDLE);
+    little_endian_store_16(event, 5, 1);
+    queue_packet(mock_time_us(), HCI_EVENT_PACKET, event, sizeof(event));
+
+    if (packet[8] == ATT_HANDLE_VALUE_CONFIRMATION) return;
+    att_requests++;
+    uint8_t response[ATT_DEFAULT_MTU];
+    uint16_t response_len = att_handle_request(&peripheral_connection, &packet[8], size - 8, response);
+    if (response_len){
+        queue_att_pdu(mock_time_us() + CONNECTION_INTERVAL_US, response, response_len);
+    }
+}
+
+// central application: discover all services, characteristics and descriptors
+
+static void hash_result(const uint8_t * packet, uint16_t size){
+    // FNV-1a over result without event type, length and connection handle
+    uint16_t i;
+    for (i = 4; i < size; i++){
+        results_hash = (results_hash ^ packet[i]) * 16777619;
+    }
+}
+
+static void discovery_next(void);
+
+static void handle_gatt_client_event(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size){
+    UNUSED(packet_type);
+    UNUSED(channel);
+    switch (hci_event_packet_get_type(packet)){
+        case GATT_EVENT_SERVICE_QUERY_RESULT:
+        case GATT_EVENT_CHARACTERISTIC_QUERY_RESULT:
+        case GATT_EVENT_ALL_CHARACTERISTIC_DESCRIPTORS_QUERY_RESULT:
+            // query is only complete after its last result, also if answered from cache
+            if (gatt_client_is_ready(CON_HANDLE)) mock_fail("query complete before last result");
+            break;
+        default:
+            break;
+    }
+    switch (hci_event_packet_get_type(packet)){
+        case GATT_EVENT_SERVICE_QUERY_RESULT:
+            if (num_services == MAX_SERVICES) mock_fail("too many services");
+            gatt_event_service_query_result_get_service(packet, &services[num_services++]);
+            hash_result(packet, size);
+            break;
+        case GATT_EVENT_CHARACTERISTIC_QUERY_RESULT:
+            if (num_characteristics == MAX_CHARACTERISTICS) mock_fail("too many characteristics");
+            gatt_event_characteristic_query_result_get_characteristic(packet, &characteristics[num_characteristics++]);
+            hash_result(packet, size);
+            break;
+        case GATT_EVENT_ALL_CHARACTERISTIC_DESCRIPTORS_QUERY_RESULT:
+            num_descriptors++;
+            hash_result(packet, size);
+            break;
+        case GATT_EVENT_QUERY_COMPLETE:
+            if (gatt_event_query_complete_get_status(packet)) mock_fail("query failed");
+            discovery_next();
+            break;
+        default:
+            break;
+    }
+}
+
+static void discovery_next(void){
+    switch (discovery_state){
+        case DISCOVER_SERVICES:
+            discovery_state = DISCOVER_CHARACTERISTICS;
+            /* fall through */
+        case DISCOVER_CHARACTERISTICS:
+            if (service_index < num_services){
+                gatt_client_discover_characteristics_for_service(&handle_gatt_client_event, CON_HANDLE, &services[service_index++]);
+                return;
+            }
+            discovery_state = DISCOVER_DESCRIPTORS;
+            /* fall through */
+        case DISCOVER_DESCRIPTORS:
+            if (characteristic_index < num_characteristics){
+                gatt_client_discover_characteristic_descriptors(&handle_gatt_client_event, CON_HANDLE, &characteristics[characteristic_index++]);
+                return;
+            }
+            discovery_state = DISCOVERY_DONE;
+            break;
+        default:
+            break;
+    }
+}
+
+// @returns hash over discovery results
+static uint32_t reconnect(const char * name, peripheral_version_t version, int service_changed){
+    att_set_db(version == PERIPHERAL_V1 ? profile_data : peripheral_v2_profile_data);
+    memset(&peripheral_connection, 0, sizeof(peripheral_connection));
+    peripheral_connection.con_handle = CON_HANDLE;
+    peripheral_connection.mtu = ATT_DEFAULT_MTU;
+    peripheral_connection.max_mtu = ATT_DEFAULT_MTU;
+
+    att_requests = 0;
+    tlv_bytes_stored = 0;
+    num_services = 0;
+    service_index = 0;
+    num_characteristics = 0;
+    characteristic_index = 0;
+    num_descriptors = 0;
+    results_hash = 2166136261u;
+    uint32_t start_us = mock_time_us();
+
+    mock_controller_le_connection_complete(CON_HANDLE, HCI_ROLE_MASTER, BD_ADDR_TYPE_LE_PUBLIC, peripheral_address);
+    if (service_changed){
+        // bonded peripheral indicates change of whole database in first connection event
+        uint8_t value[4];
+        little_endian_store_16(value, 0, 0x0001);
+        little_endian_store_16(value, 2, 0xffff);
+        uint8_t indication[ATT_DEFAULT_MTU];
+        uint16_t len = att_prepare_handle_value_indication(&peripheral_connection,
+            ATT_CHARACTERISTIC_GATT_SERVICE_CHANGED_01_VALUE_HANDLE, value, sizeof(value), indication);
+        queue_att_pdu(mock_time_us(), indication, len);
+    }
+    discovery_state = DISCOVER_SERVICES;
+    gatt_client_discover_primary_services(&handle_gatt_client_event, CON_HANDLE);
+    while (discovery_state != DISCOVERY_DONE){
+        btstack_run_loop_embedded_execute_once();
+        if (!deliver_next_packet()) mock_fail("discovery stalled");
+    }
+    uint32_t duration_us = mock_time_us() - start_us;
+
+    // flush completed packets and disconnect
+    while (deliver_next_packet());
+    mock_controller_disconnection_complete(CON_HANDLE);
+    btstack_run_loop_embedded_execute_once();
+    mock_set_time_us(mock_time_us() + 1000000);
+
+    printf("%-38s %2u services, %2u characteristics, %2u descriptors: %3u ATT requests, %6.1f ms, %4u bytes stored\n",
+        name, num_services, num_characteristics, num_descriptors, att_requests, duration_us / 1000.0, tlv_bytes_stored);
+    return results_hash;
+}
+
+static void expect(uint32_t results, uint32_t expected){
+    if (results != expected) mock_fail("discovery results differ from uncached discovery");
+}
+
+// stubs for Security Manager and LE Device DB, peripheral is bonded
+
+int sm_le_device_index(hci_con_handle_t con_handle){
+    UNUSED(con_handle);
+    return 0;
+}
+
+void le_device_db_info(int index, int * addr_type, bd_addr_t addr, sm_key_t irk){
+    UNUSED(index);
+    *addr_type = BD_ADDR_TYPE_LE_PUBLIC;
+    memset(addr, 0x11, sizeof(bd_addr_t));
+    memset(irk, 0, sizeof(sm_key_t));
+}
+
+int main(void){
+    mock_init(btstack_run_loop_embedded_get_instance(), mock_transport_get_instance());
+    mock_register_packet_handler(&peripheral_receive_packet);
+    l2cap_init();
+    gatt_client_init();
+    mock_controller_le_read_buffer_size(27, MAX_PENDING_PACKETS);
+
+    printf("GATT Client reconnect, connection interval %.1f ms, ATT MTU %u\n", CONNECTION_INTERVAL_US / 1000.0, ATT_DEFAULT_MTU);
+
+    // uncached discovery as reference
+    uint32_t v1_results = reconnect("v1, without cache", PERIPHERAL_V1, 0);
+    uint32_t v2_results = reconnect("v2, without cache", PERIPHERAL_V2, 0);
+
+    gatt_client_discovery_cache_configure(&memory_tlv, NULL);
+    expect(reconnect("v1, first connection", PERIPHERAL_V1, 0), v1_results);
+    expect(reconnect("v1, reconnect", PERIPHERAL_V1, 0), v1_results);
+    expect(reconnect("v1, reconnect", PERIPHERAL_V1, 0), v1_results);
+    expect(reconnect("v2, reconnect, database hash changed", PERIPHERAL_V2, 0), v2_results);
+    expect(reconnect("v2, reconnect", PERIPHERAL_V2, 0), v2_results);
+    expect(reconnect("v2, reconnect, service changed", PERIPHERAL_V2, 1), v2_results);
+    expect(reconnect("v2, reconnect", PERIPHERAL_V2, 0), v2_results);
+    return 0;
+}
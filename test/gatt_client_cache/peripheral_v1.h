@@ -0,0 +1,132 @@
+
+// peripheral_v1.h generated from peripheral_v1.gatt for BTstack
+
+// binary representation
+// attribute size in bytes (16), flags(16), handle (16), uuid (16/128), value(...)
+
+#include <stdint.h>
+
+const uint8_t profile_data[] =
+{
+    // Mock peripheral for GATT Client Discovery Cache benchmark
+    // 0x0001 PRIMARY_SERVICE-GAP_SERVICE
+    0x0a, 0x00, 0x02, 0x00, 0x01, 0x00, 0x00, 0x28, 0x00, 0x18, 
+    // 0x0002 CHARACTERISTIC-GAP_DEVICE_NAME-READ
+    0x0d, 0x00, 0x02, 0x00, 0x02, 0x00, 0x03, 0x28, 0x02, 0x03, 0x00, 0x00, 0x2a, 
+    // 0x0003 VALUE-GAP_DEVICE_NAME-READ-'Sensor'
+    0x0e, 0x00, 0x02, 0x00, 0x03, 0x00, 0x00, 0x2a, 0x53, 0x65, 0x6e, 0x73, 0x6f, 0x72, 
+    // 0x0004 CHARACTERISTIC-2A01-READ
+    0x0d, 0x00, 0x02, 0x00, 0x04, 0x00, 0x03, 0x28, 0x02, 0x05, 0x00, 0x01, 0x2a, 
+    // 0x0005 VALUE-2A01-READ-'00 00'
+    0x0a, 0x00, 0x02, 0x00, 0x05, 0x00, 0x01, 0x2a, 0x00, 0x00, 
+
+    // 0x0006 PRIMARY_SERVICE-GATT_SERVICE
+    0x0a, 0x00, 0x02, 0x00, 0x06, 0x00, 0x00, 0x28, 0x01, 0x18, 
+    // 0x0007 CHARACTERISTIC-GATT_SERVICE_CHANGED-INDICATE
+    0x0d, 0x00, 0x02, 0x00, 0x07, 0x00, 0x03, 0x28, 0x20, 0x08, 0x00, 0x05, 0x2a, 
+    // 0x0008 VALUE-GATT_SERVICE_CHANGED-INDICATE-''
+    0x08, 0x00, 0x00, 0x00, 0x08, 0x00, 0x05, 0x2a, 
+    // 0x0009 CLIENT_CHARACTERISTIC_CONFIGURATION
+    0x0a, 0x00, 0x1b, 0x01, 0x09, 0x00, 0x02, 0x29, 0x00, 0x00, 
+    // Database Hash
+    // 0x000a CHARACTERISTIC-2B2A-READ
+    0x0d, 0x00, 0x02, 0x00, 0x0a, 0x00, 0x03, 0x28, 0x02, 0x0b, 0x00, 0x2a, 0x2b, 
+    // 0x000b VALUE-2B2A-READ-'01 01 01 01 01 01 01 01 01 01 01 01 01 01 01 01'
+    0x18, 0x00, 0x02, 0x00, 0x0b, 0x00, 0x2a, 0x2b, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 
+    // Battery Service
+
+    // 0x000c PRIMARY_SERVICE-180F
+    0x0a, 0x00, 0x02, 0x00, 0x0c, 0x00, 0x00, 0x28, 0x0f, 0x18, 
+    // 0x000d CHARACTERISTIC-2A19-READ | NOTIFY
+    0x0d, 0x00, 0x02, 0x00, 0x0d, 0x00, 0x03, 0x28, 0x12, 0x0e, 0x00, 0x19, 0x2a, 
+    // 0x000e VALUE-2A19-READ | NOTIFY-'64'
+    0x09, 0x00, 0x02, 0x00, 0x0e, 0x00, 0x19, 0x2a, 0x64, 
+    // 0x000f CLIENT_CHARACTERISTIC_CONFIGURATION
+    0x0a, 0x00, 0x1b, 0x01, 0x0f, 0x00, 0x02, 0x29, 0x00, 0x00, 
+    // Device Information Service
+
+    // 0x0010 PRIMARY_SERVICE-180A
+    0x0a, 0x00, 0x02, 0x00, 0x10, 0x00, 0x00, 0x28, 0x0a, 0x18, 
+    // 0x0011 CHARACTERISTIC-2A29-READ
+    0x0d, 0x00, 0x02, 0x00, 0x11, 0x00, 0x03, 0x28, 0x02, 0x12, 0x00, 0x29, 0x2a, 
+    // 0x0012 VALUE-2A29-READ-'BlueKitchen'
+    0x13, 0x00, 0x02, 0x00, 0x12, 0x00, 0x29, 0x2a, 0x42, 0x6c, 0x75, 0x65, 0x4b, 0x69, 0x74, 0x63, 0x68, 0x65, 0x6e, 
+    // 0x0013 CHARACTERISTIC-2A24-READ
+    0x0d, 0x00, 0x02, 0x00, 0x13, 0x00, 0x03, 0x28, 0x02, 0x14, 0x00, 0x24, 0x2a, 
+    // 0x0014 VALUE-2A24-READ-'Sensor 1'
+    0x10, 0x00, 0x02, 0x00, 0x14, 0x00, 0x24, 0x2a, 0x53, 0x65, 0x6e, 0x73, 0x6f, 0x72, 0x20, 0x31, 
+    // 0x0015 CHARACTERISTIC-2A26-READ
+    0x0d, 0x00, 0x02, 0x00, 0x15, 0x00, 0x03, 0x28, 0x02, 0x16, 0x00, 0x26, 0x2a, 
+    // 0x0016 VALUE-2A26-READ-'1.0'
+    0x0b, 0x00, 0x02, 0x00, 0x16, 0x00, 0x26, 0x2a, 0x31, 0x2e, 0x30, 
+    // Sensor Service
+
+    // 0x0017 PRIMARY_SERVICE-0000FF10-0000-1000-8000-00805F9B34FB
+    0x18, 0x00, 0x02, 0x00, 0x17, 0x00, 0x00, 0x28, 0xfb, 0x34, 0x9b, 0x5f, 0x80, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x00, 0x10, 0xff, 0x00, 0x00, 
+    // 0x0018 CHARACTERISTIC-0000FF11-0000-1000-8000-00805F9B34FB-NOTIFY
+    0x1b, 0x00, 0x02, 0x00, 0x18, 0x00, 0x03, 0x28, 0x10, 0x19, 0x00, 0xfb, 0x34, 0x9b, 0x5f, 0x80, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x00, 0x11, 0xff, 0x00, 0x00, 
+    // 0x0019 VALUE-0000FF11-0000-1000-8000-00805F9B34FB-NOTIFY-''
+    0x16, 0x00, 0x00, 0x02, 0x19, 0x00, 0xfb, 0x34, 0x9b, 0x5f, 0x80, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x00, 0x11, 0xff, 0x00, 0x00, 
+    // 0x001a CLIENT_CHARACTERISTIC_CONFIGURATION
+    0x0a, 0x00, 0x1b, 0x01, 0x1a, 0x00, 0x02, 0x29, 0x00, 0x00, 
+    // 0x001b CHARACTERISTIC-0000FF12-0000-1000-8000-00805F9B34FB-NOTIFY
+    0x1b, 0x00, 0x02, 0x00, 0x1b, 0x00, 0x03, 0x28, 0x10, 0x1c, 0x00, 0xfb, 0x34, 0x9b, 0x5f, 0x80, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x00, 0x12, 0xff, 0x00, 0x00, 
+    // 0x001c VALUE-0000FF12-0000-1000-8000-00805F9B34FB-NOTIFY-''
+    0x16, 0x00, 0x00, 0x02, 0x1c, 0x00, 0xfb, 0x34, 0x9b, 0x5f, 0x80, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x00, 0x12, 0xff, 0x00, 0x00, 
+    // 0x001d CLIENT_CHARACTERISTIC_CONFIGURATION
+    0x0a, 0x00, 0x1b, 0x01, 0x1d, 0x00, 0x02, 0x29, 0x00, 0x00, 
+    // 0x001e CHARACTERISTIC-0000FF13-0000-1000-8000-00805F9B34FB-NOTIFY
+    0x1b, 0x00, 0x02, 0x00, 0x1e, 0x00, 0x03, 0x28, 0x10, 0x1f, 0x00, 0xfb, 0x34, 0x9b, 0x5f, 0x80, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x00, 0x13, 0xff, 0x00, 0x00, 
+    // 0x001f VALUE-0000FF13-0000-1000-8000-00805F9B34FB-NOTIFY-''
+    0x16, 0x00, 0x00, 0x02, 0x1f, 0x00, 0xfb, 0x34, 0x9b, 0x5f, 0x80, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x00, 0x13, 0xff, 0x00, 0x00, 
+    // 0x0020 CLIENT_CHARACTERISTIC_CONFIGURATION
+    0x0a, 0x00, 0x1b, 0x01, 0x20, 0x00, 0x02, 0x29, 0x00, 0x00, 
+    // 0x0021 CHARACTERISTIC-0000FF14-0000-1000-8000-00805F9B34FB-READ | WRITE
+    0x1b, 0x00, 0x02, 0x00, 0x21, 0x00, 0x03, 0x28, 0x0a, 0x22, 0x00, 0xfb, 0x34, 0x9b, 0x5f, 0x80, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x00, 0x14, 0xff, 0x00, 0x00, 
+    // 0x0022 VALUE-0000FF14-0000-1000-8000-00805F9B34FB-READ | WRITE-'00'
+    0x17, 0x00, 0x0a, 0x02, 0x22, 0x00, 0xfb, 0x34, 0x9b, 0x5f, 0x80, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x00, 0x14, 0xff, 0x00, 0x00, 0x00, 
+    // 0x0023 CHARACTERISTIC-0000FF15-0000-1000-8000-00805F9B34FB-WRITE_WITHOUT_RESPONSE
+    0x1b, 0x00, 0x02, 0x00, 0x23, 0x00, 0x03, 0x28, 0x04, 0x24, 0x00, 0xfb, 0x34, 0x9b, 0x5f, 0x80, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x00, 0x15, 0xff, 0x00, 0x00, 
+    // 0x0024 VALUE-0000FF15-0000-1000-8000-00805F9B34FB-WRITE_WITHOUT_RESPONSE-''
+    0x16, 0x00, 0x04, 0x02, 0x24, 0x00, 0xfb, 0x34, 0x9b, 0x5f, 0x80, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x00, 0x15, 0xff, 0x00, 0x00, 
+
+    // END
+    0x00, 0x00, 
+}; // total size 305 bytes 
+
+
+//
+// list service handle ranges
+//
+#define ATT_SERVICE_GAP_SERVICE_START_HANDLE 0x0001
+#define ATT_SERVICE_GAP_SERVICE_END_HANDLE 0x0005
+#define ATT_SERVICE_GATT_SERVICE_START_HANDLE 0x0006
+#define ATT_SERVICE_GATT_SERVICE_END_HANDLE 0x000b
+#define ATT_SERVICE_180F_START_HANDLE 0x000c
+#define ATT_SERVICE_180F_END_HANDLE 0x000f
+#define ATT_SERVICE_180A_START_HANDLE 0x0010
+#define ATT_SERVICE_180A_END_HANDLE 0x0016
+#define ATT_SERVICE_0000FF10_0000_1000_8000_00805F9B34FB_START_HANDLE 0x0017
+#define ATT_SERVICE_0000FF10_0000_1000_8000_00805F9B34FB_END_HANDLE 0x0024
+
+//
+// list mapping between characteristics and handles
+//
+#define ATT_CHARACTERISTIC_GAP_DEVICE_NAME_01_VALUE_HANDLE 0x0003
+#define ATT_CHARACTERISTIC_2A01_01_VALUE_HANDLE 0x0005
+#define ATT_CHARACTERISTIC_GATT_SERVICE_CHANGED_01_VALUE_HANDLE 0x0008
+#define ATT_CHARACTERISTIC_GATT_SERVICE_CHANGED_01_CLIENT_CONFIGURATION_HANDLE 0x0009
+#define ATT_CHARACTERISTIC_2B2A_01_VALUE_HANDLE 0x000b
+#define ATT_CHARACTERISTIC_2A19_01_VALUE_HANDLE 0x000e
+#define ATT_CHARACTERISTIC_2A19_01_CLIENT_CONFIGURATION_HANDLE 0x000f
+#define ATT_CHARACTERISTIC_2A29_01_VALUE_HANDLE 0x0012
+#define ATT_CHARACTERISTIC_2A24_01_VALUE_HANDLE 0x0014
+#define ATT_CHARACTERISTIC_2A26_01_VALUE_HANDLE 0x0016
+#define ATT_CHARACTERISTIC_0000FF11_0000_1000_8000_00805F9B34FB_01_VALUE_HANDLE 0x0019
+#define ATT_CHARACTERISTIC_0000FF11_0000_1000_8000_00805F9B34FB_01_CLIENT_CONFIGURATION_HANDLE 0x001a
+#define ATT_CHARACTERISTIC_0000FF12_0000_1000_8000_00805F9B34FB_01_VALUE_HANDLE 0x001c
+#define ATT_CHARACTERISTIC_0000FF12_0000_1000_8000_00805F9B34FB_01_CLIENT_CONFIGURATION_HANDLE 0x001d
+#define ATT_CHARACTERISTIC_0000FF13_0000_1000_8000_00805F9B34FB_01_VALUE_HANDLE 0x001f
+#define ATT_CHARACTERISTIC_0000FF13_0000_1000_8000_00805F9B34FB_01_CLIENT_CONFIGURATION_HANDLE 0x0020
+#define ATT_CHARACTERISTIC_0000FF14_0000_1000_8000_00805F9B34FB_01_VALUE_HANDLE 0x0022
+#define ATT_CHARACTERISTIC_0000FF15_0000_1000_8000_00805F9B34FB_01_VALUE_HANDLE 0x0024
@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2017 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+/*
+ *  hci_cmd_encoder_benchmark.c
+ *
+ *  Compare HCI command creation via hci_cmd_create_from_template() with the fixed-layout
+ *  encoders generated into hci_cmd_encoder.h. Verifies that both produce identical packets.
+ */
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "btstack_config.h"
+#include "btstack_util.h"
+#include "hci_cmd.h"
+#include "hci_cmd_encoder.h"
+
+#define NUM_ITERATIONS 10000000
+
+static uint8_t template_packet[HCI_CMD_HEADER_SIZE + 255];
+static uint8_t encoder_packet[HCI_CMD_HEADER_SIZE + 255];
+
+static const uint8_t key[16]        = { 0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c };
+static const uint8_t plaintext[16]  = { 0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a };
+static const uint8_t adv_data[31]   = { 0x02, 0x01, 0x06, 0x08, 0x09, 'B', 'T', 's', 't', 'a', 'c', 'k' };
+static bd_addr_t addr = { 0x00, 0x1b, 0xdc, 0x08, 0xe2, 0x5c };
+
+static uint64_t benchmark_now_ns(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+static uint16_t create_from_template(uint8_t * packet, const hci_cmd_t * cmd, ...){
+    va_list argptr;
+    va_start(argptr, cmd);
+    uint16_t size = hci_cmd_create_from_template(packet, cmd, argptr);
+    va_end(argptr);
+    return size;
+}
+
+static void compare(const char * name, uint16_t template_size, uint16_t encoder_size){
+    if (template_size == encoder_size && memcmp(template_packet, encoder_packet, template_size) == 0) return;
+    printf("%s: encoder output differs from template\n", name);
+    printf("template: "); printf_hexdump(template_packet, template_size);
+    printf("encoder:  "); printf_hexdump(encoder_packet, encoder_size);
+    exit(1);
+}
+
+static void report(const char * name, uint64_t template_ns, uint64_t encoder_ns){
+    printf("%-28s template %6.1f ns, encoder %6.1f ns, speedup %4.1fx\n", name,
+        (double) template_ns / NUM_ITERATIONS, (double) encoder_ns / NUM_ITERATIONS, (double) template_ns / encoder_ns);
+}
+
+// run template and encoder for one command. the packets are consumed by summing them up,
+// so the compiler cannot drop the encoders
+#define BENCHMARK(NAME, TEMPLATE_CALL, ENCODER_CALL) { \
+    compare(NAME, TEMPLATE_CALL, ENCODER_CALL); \
+    uint32_t checksum = 0; \
+    int i; \
+    uint64_t start_ns = benchmark_now_ns(); \
+    for (i = 0; i < NUM_ITERATIONS; i++){ \
+        checksum += TEMPLATE_CALL; \
+        checksum += template_packet[i & 7]; \
+    } \
+    uint64_t template_ns = benchmark_now_ns() - start_ns; \
+    start_ns = benchmark_now_ns(); \
+    for (i = 0; i < NUM_ITERATIONS; i++){ \
+        checksum -= ENCODER_CALL; \
+        checksum -= encoder_packet[i & 7]; \
+    } \
+    uint64_t encoder_ns = benchmark_now_ns() - start_ns; \
+    if (checksum != 0) exit(1); \
+    report(NAME, template_ns, encoder_ns); \
+}
+
+int main(void){
+    BENCHMARK("hci_le_rand",
+        create_from_template(template_packet, &hci_le_rand),
+        hci_cmd_encode_le_rand(encoder_packet));
+    BENCHMARK("hci_le_encrypt",
+        create_from_template(template_packet, &hci_le_encrypt, key, plaintext),
+        hci_cmd_encode_le_encrypt(encoder_packet, key, plaintext));
+    BENCHMARK("hci_disconnect",
+        create_from_template(template_packet, &hci_disconnect, 0x0040, 0x13),
+        hci_cmd_encode_disconnect(encoder_packet, 0x0040, 0x13));
+    BENCHMARK("hci_le_connection_update",
+        create_from_template(template_packet, &hci_le_connection_update, 0x0040, 6, 12, 0, 200, 0, 0),
+        hci_cmd_encode_le_connection_update(encoder_packet, 0x0040, 6, 12, 0, 200, 0, 0));
+    BENCHMARK("hci_le_create_connection",
+        create_from_template(template_packet, &hci_le_create_connection, 0x60, 0x30, 0, 0, addr, 0, 6, 12, 0, 200, 0, 0),
+        hci_cmd_encode_le_create_connection(encoder_packet, 0x60, 0x30, 0, 0, addr, 0, 6, 12, 0, 200, 0, 0));
+    BENCHMARK("hci_le_set_advertising_data",
+        create_from_template(template_packet, &hci_le_set_advertising_data, 12, adv_data),
+        hci_cmd_encode_le_set_advertising_data(encoder_packet, 12, adv_data));
+    BENCHMARK("hci_inquiry",
+        create_from_template(template_packet, &hci_inquiry, HCI_INQUIRY_LAP, 48, 0),
+        hci_cmd_encode_inquiry(encoder_packet, HCI_INQUIRY_LAP, 48, 0));
+    BENCHMARK("hci_write_local_name",
+        create_from_template(template_packet, &hci_write_local_name, "BTstack"),
+        hci_cmd_encode_write_local_name(encoder_packet, "BTstack"));
+    return 0;
+}
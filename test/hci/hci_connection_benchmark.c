@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) 2017 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+/*
+ *  hci_connection_benchmark.c
+ *
+ *  Dispatch ACL packets and Number Of Completed Packets events across N LE connections
+ *  through hci.c using a mock HCI transport. Built with and without connection index.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "btstack_config.h"
+#include "btstack_run_loop_posix.h"
+#include "btstack_util.h"
+#include "hci.h"
+#include "mock_controller.h"
+
+#define MAX_CONNECTIONS 128
+#define NUM_ACL_PACKETS 2000000
+#define NUM_NCP_EVENTS   200000
+#define CON_HANDLE_BASE  0x0040
+
+static uint32_t acl_packets_received[MAX_CONNECTIONS];
+
+static void acl_handler(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size){
+    UNUSED(packet_type);
+    UNUSED(channel);
+    UNUSED(size);
+    hci_con_handle_t con_handle = READ_ACL_CONNECTION_HANDLE(packet);
+    acl_packets_received[con_handle - CON_HANDLE_BASE]++;
+}
+
+static double now_s(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static void address_for_index(int index, bd_addr_t addr){
+    addr[0] = 0xc0;
+    addr[1] = 0x01;
+    addr[2] = 0x02;
+    addr[3] = 0x03;
+    big_endian_store_16(addr, 4, index * 37);
+}
+
+static void le_connection_complete(int index){
+    bd_addr_t addr;
+    address_for_index(index, addr);
+    mock_controller_le_connection_complete(CON_HANDLE_BASE + index, HCI_ROLE_MASTER, BD_ADDR_TYPE_LE_RANDOM, addr);
+}
+
+static void verify_lookup(int index, int expected){
+    bd_addr_t addr;
+    address_for_index(index, addr);
+    hci_connection_t * by_handle  = hci_connection_for_handle(CON_HANDLE_BASE + index);
+    hci_connection_t * by_address = hci_connection_for_bd_addr_and_type(addr, BD_ADDR_TYPE_LE_RANDOM);
+    int ok;
+    if (expected){
+        ok = by_handle && by_handle == by_address && by_handle->con_handle == CON_HANDLE_BASE + index;
+    } else {
+        ok = by_handle == NULL && by_address == NULL;
+    }
+    if (!ok){
+        printf("lookup for connection %u failed\n", index);
+        exit(1);
+    }
+}
+
+static void benchmark_acl(int num_connections){
+    uint8_t acl_packet[4 + 8];
+    memset(acl_packet, 0, sizeof(acl_packet));
+    little_endian_store_16(acl_packet, 2, 8);   // ACL length
+    little_endian_store_16(acl_packet, 4, 4);   // L2CAP length
+    little_endian_store_16(acl_packet, 6, 4);   // L2CAP CID ATT
+    memset(acl_packets_received, 0, sizeof(acl_packets_received));
+
+    double start = now_s();
+    int i;
+    for (i = 0; i < NUM_ACL_PACKETS; i++){
+        // first automatically flushable packet
+        little_endian_store_16(acl_packet, 0, (CON_HANDLE_BASE + (i % num_connections)) | (0x02 << 12));
+        mock_controller_receive_acl(acl_packet, sizeof(acl_packet));
+    }
+    double elapsed = now_s() - start;
+
+    for (i = 0; i < num_connections; i++){
+        uint32_t expected = NUM_ACL_PACKETS / num_connections + (i < NUM_ACL_PACKETS % num_connections ? 1 : 0);
+        if (acl_packets_received[i] != expected){
+            printf("connection %u: received %u ACL packets, expected %u\n", i, acl_packets_received[i], expected);
+            exit(1);
+        }
+    }
+    printf("%3u connections: ACL %6.1f ns/packet", num_connections, elapsed * 1e9 / NUM_ACL_PACKETS);
+}
+
+static void benchmark_number_of_completed_packets(int num_connections){
+    // one event lists up to 8 handles
+    uint8_t event[3 + 8 * 4];
+    int num_handles = num_connections < 8 ? num_connections : 8;
+    int next_connection = 0;
+    event[0] = HCI_EVENT_NUMBER_OF_COMPLETED_PACKETS;
+    event[1] = 1 + num_handles * 4;
+    event[2] = num_handles;
+
+    double start = now_s();
+    int i;
+    for (i = 0; i < NUM_NCP_EVENTS; i++){
+        int j;
+        for (j = 0; j < num_handles; j++){
+            little_endian_store_16(event, 3 + j * 4, CON_HANDLE_BASE + next_connection);
+            little_endian_store_16(event, 5 + j * 4, 0);
+            next_connection = (next_connection + 1) % num_connections;
+        }
+        mock_controller_send_event(event, 3 + num_handles * 4);
+    }
+    double elapsed = now_s() - start;
+    printf(", Number Of Completed Packets %6.1f ns/handle\n", elapsed * 1e9 / (NUM_NCP_EVENTS * num_handles));
+}
+
+int main(void){
+    mock_init(btstack_run_loop_posix_get_instance(), mock_transport_get_instance());
+    hci_register_acl_packet_handler(&acl_handler);
+
+    printf("HCI connection lookup, index size %u\n", HCI_CONNECTION_INDEX_SIZE);
+
+    static const int num_connections[] = { 1, 4, 16, 32, 64, 128 };
+    int connections = 0;
+    unsigned int i;
+    for (i = 0; i < sizeof(num_connections) / sizeof(int); i++){
+        while (connections < num_connections[i]){
+            le_connection_complete(connections++);
+        }
+        benchmark_acl(connections);
+        benchmark_number_of_completed_packets(connections);
+    }
+
+    // disconnect every second connection and verify lookups
+    int j;
+    for (j = 0; j < connections; j += 2){
+        mock_controller_disconnection_complete(CON_HANDLE_BASE + j);
+    }
+    for (j = 0; j < connections; j++){
+        verify_lookup(j, j & 1);
+    }
+    return 0;
+}
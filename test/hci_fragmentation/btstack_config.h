@@ -0,0 +1,25 @@
+//
+// btstack_config.h for HCI fragmentation benchmark
+//
+
+#ifndef __BTSTACK_CONFIG
+#define __BTSTACK_CONFIG
+
+// Port related features
+#define HAVE_MALLOC
+#define HAVE_POSIX_TIME
+
+// BTstack features that can be enabled
+#define ENABLE_BLE
+#define ENABLE_CLASSIC
+#define ENABLE_LOG_ERROR
+#define ENABLE_LOG_INFO 
+#define ENABLE_LE_PERIPHERAL
+#define ENABLE_LE_CENTRAL
+
+// BTstack configuration. buffers, sizes, ...
+// large L2CAP PDUs get fragmented by HCI
+#define HCI_ACL_PAYLOAD_SIZE 4096
+#define HCI_INCOMING_PRE_BUFFER_SIZE 4
+
+#endif
@@ -0,0 +1,324 @@
+/*
+ * Copyright (C) 2017 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+/*
+ *  hci_fragmentation_benchmark.c
+ *
+ *  Send large L2CAP PDUs over an LE connection through hci.c using a mock USB transport.
+ *  The mock transport reports completed transfers once per USB frame, the mock controller
+ *  frees its ACL buffers as soon as a packet was received and verifies the reassembled PDUs.
+ *
+ *  Compares the classic path (one fragment in flight, header written into packet buffer)
+ *  with send_packet_with_header (header passed separately, multiple fragments in flight).
+ *  With send_packet_with_header, a completed HCI Command is reported while ACL fragments are in flight,
+ *  which must not release the packet buffer.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "btstack_config.h"
+#include "btstack_run_loop_posix.h"
+#include "btstack_util.h"
+#include "hci.h"
+#include "hci_transport.h"
+#include "mock_controller.h"
+
+#define CON_HANDLE              0x0040
+#define NUM_PDUS                2000
+#define PDU_SIZE                4000    // ACL payload = L2CAP header + data
+#define CONTROLLER_ACL_BUFFERS  8
+#define MAX_TRANSFERS           8
+
+// USB full speed: completed transfers are reported once per 1 ms frame, ~ 8 Mbit/s usable bulk bandwidth
+#define USB_FRAME_US            1000
+#define USB_BYTES_PER_US        1
+
+typedef struct {
+    const uint8_t * payload;
+    uint8_t         header[4];
+    uint16_t        payload_size;
+    uint32_t        completion_us;
+} transfer_t;
+
+// mock USB
+static transfer_t transfers[MAX_TRANSFERS];
+static int        transfers_head;
+static int        transfers_count;
+static int        transfers_max_in_flight;
+static uint32_t   usb_bus_free_us;
+static uint32_t   now_us;
+static int        transfers_with_header;
+static uint32_t   transfers_contiguous;
+
+// mock controller
+static uint8_t    pdu_pattern[PDU_SIZE];
+static uint32_t   rx_pdus;
+static uint32_t   rx_pdu_pos;
+static uint32_t   rx_fragments;
+
+static int mock_can_send_packet_now(uint8_t packet_type){
+    if (packet_type != HCI_ACL_DATA_PACKET) return 1;
+    return transfers_count < transfers_max_in_flight;
+}
+
+static void mock_submit_transfer(const uint8_t * header, const uint8_t * payload, uint16_t payload_size){
+    if (transfers_count >= transfers_max_in_flight){
+        mock_fail("transfer submitted while transport busy");
+    }
+    transfer_t * transfer = &transfers[(transfers_head + transfers_count) % MAX_TRANSFERS];
+    transfers_count++;
+    memcpy(transfer->header, header, 4);
+    transfer->payload      = payload;
+    transfer->payload_size = payload_size;
+    // transfers are serialized on the bus, completion is reported at the end of the frame
+    uint32_t start_us = btstack_max(now_us, usb_bus_free_us);
+    usb_bus_free_us = start_us + (4 + payload_size) / USB_BYTES_PER_US;
+    transfer->completion_us = (usb_bus_free_us + USB_FRAME_US - 1) / USB_FRAME_US * USB_FRAME_US;
+}
+
+static int mock_send_packet(uint8_t packet_type, uint8_t *packet, int size){
+    if (packet_type != HCI_ACL_DATA_PACKET) return 0;
+    mock_submit_transfer(packet, &packet[4], size - 4);
+    return 0;
+}
+
+static int mock_send_packet_with_header(uint8_t packet_type, const uint8_t * header, uint16_t header_size, const uint8_t * payload, uint16_t payload_size){
+    if (packet_type != HCI_ACL_DATA_PACKET) return 0;
+    if (header_size != 4) {
+        printf("unexpected header size %u\n", header_size);
+        exit(1);
+    }
+    // header directly in front of payload could be sent without copy
+    if (payload == &header[header_size]){
+        transfers_contiguous++;
+    }
+    mock_submit_transfer(header, payload, payload_size);
+    return 0;
+}
+
+static const hci_transport_t mock_transport_classic = {
+    /* const char * name; */                                        "MOCK_CLASSIC",
+    /* void   (*init) (const void *transport_config); */            NULL,
+    /* int    (*open)(void); */                                     NULL,
+    /* int    (*close)(void); */                                    NULL,
+    /* void   (*register_packet_handler)(void (*handler)(...); */   &mock_transport_register_packet_handler,
+    /* int    (*can_send_packet_now)(uint8_t packet_type); */       &mock_can_send_packet_now,
+    /* int    (*send_packet)(...); */                               &mock_send_packet,
+    /* int    (*set_baudrate)(uint32_t baudrate); */                NULL,
+    /* void   (*reset_link)(void); */                               NULL,
+    /* void   (*set_sco_config)(uint16_t voice_setting, int num_connections); */ NULL,
+    /* int    (*send_packet_with_header)(...); */                   NULL,
+};
+
+static const hci_transport_t mock_transport_with_header = {
+    /* const char * name; */                                        "MOCK_WITH_HEADER",
+    /* void   (*init) (const void *transport_config); */            NULL,
+    /* int    (*open)(void); */                                     NULL,
+    /* int    (*close)(void); */                                    NULL,
+    /* void   (*register_packet_handler)(void (*handler)(...); */   &mock_transport_register_packet_handler,
+    /* int    (*can_send_packet_now)(uint8_t packet_type); */       &mock_can_send_packet_now,
+    /* int    (*send_packet)(...); */                               &mock_send_packet,
+    /* int    (*set_baudrate)(uint32_t baudrate); */                NULL,
+    /* void   (*reset_link)(void); */                               NULL,
+    /* void   (*set_sco_config)(uint16_t voice_setting, int num_connections); */ NULL,
+    /* int    (*send_packet_with_header)(...); */                   &mock_send_packet_with_header,
+};
+
+static double now_s(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static void fail(const char * reason){
+    printf("PDU %u, offset %u: %s\n", rx_pdus, rx_pdu_pos, reason);
+    exit(1);
+}
+
+// mock controller: reassemble PDU and compare against sent data
+static void controller_receive(const transfer_t * transfer){
+    uint16_t handle_and_flags = little_endian_read_16(transfer->header, 0);
+    uint16_t acl_length       = little_endian_read_16(transfer->header, 2);
+    if ((handle_and_flags & 0x0fff) != CON_HANDLE) fail("wrong handle");
+    if (acl_length != transfer->payload_size)      fail("wrong ACL length");
+    int packet_boundary_flags = (handle_and_flags >> 12) & 0x03;
+    if (rx_pdu_pos == 0){
+        if (packet_boundary_flags != 0x00) fail("first fragment expected");
+        if (little_endian_read_16(transfer->payload, 0) != PDU_SIZE - 4) fail("wrong L2CAP length");
+        if (little_endian_read_32(transfer->payload, 4) != rx_pdus) fail("wrong PDU index");
+    } else {
+        if (packet_boundary_flags != 0x01) fail("continuation fragment expected");
+    }
+    if (rx_pdu_pos + acl_length > PDU_SIZE) fail("PDU too long");
+    // skip PDU index
+    uint32_t i;
+    for (i = 0; i < acl_length; i++){
+        uint32_t pos = rx_pdu_pos + i;
+        if (pos >= 4 && pos < 8) continue;
+        if (transfer->payload[i] != pdu_pattern[pos]) fail("data mismatch");
+    }
+    rx_fragments++;
+    rx_pdu_pos += acl_length;
+    if (rx_pdu_pos == PDU_SIZE){
+        rx_pdus++;
+        rx_pdu_pos = 0;
+    }
+}
+
+static void usb_complete_next_transfer(void){
+    transfer_t * transfer = &transfers[transfers_head];
+    now_us = btstack_max(now_us, transfer->completion_us);
+
+    // payload must still be valid
+    controller_receive(transfer);
+
+    transfers_head = (transfers_head + 1) % MAX_TRANSFERS;
+    transfers_count--;
+
+    // ACL buffer is free again
+    uint8_t event[7];
+    event[0] = HCI_EVENT_NUMBER_OF_COMPLETED_PACKETS;
+    event[1] = sizeof(event) - 2;
+    event[2] = 1;
+    little_endian_store_16(event, 3, CON_HANDLE);
+    little_endian_store_16(event, 5, 1);
+    mock_controller_send_event(event, sizeof(event));
+
+    if (!transfers_with_header){
+        // transport done
+        uint8_t packet_sent[] = { HCI_EVENT_TRANSPORT_PACKET_SENT, 0};
+        mock_controller_send_event(packet_sent, sizeof(packet_sent));
+        return;
+    }
+
+    // HCI Command completed while ACL fragments are in flight
+    if (transfers_count){
+        uint8_t command_sent[] = { HCI_EVENT_TRANSPORT_PACKET_SENT, 1, HCI_COMMAND_DATA_PACKET};
+        mock_controller_send_event(command_sent, sizeof(command_sent));
+        if (!hci_is_packet_buffer_reserved()) fail("packet buffer released by HCI Command");
+    }
+
+    // transport done
+    uint8_t packet_sent[] = { HCI_EVENT_TRANSPORT_PACKET_SENT, 1, HCI_ACL_DATA_PACKET};
+    mock_controller_send_event(packet_sent, sizeof(packet_sent));
+}
+
+static void send_pdu(uint32_t pdu_index){
+    hci_reserve_packet_buffer();
+    uint8_t * packet = hci_get_outgoing_packet_buffer();
+    // first non-automatically-flushable packet
+    little_endian_store_16(packet, 0, CON_HANDLE);
+    little_endian_store_16(packet, 2, PDU_SIZE);
+    memcpy(&packet[4], pdu_pattern, PDU_SIZE);
+    little_endian_store_32(packet, 8, pdu_index);
+    hci_send_acl_packet_buffer(4 + PDU_SIZE);
+}
+
+static void benchmark(const hci_transport_t * transport, int max_in_flight, uint16_t controller_acl_length){
+    mock_init(btstack_run_loop_posix_get_instance(), transport);
+
+    transfers_max_in_flight = max_in_flight;
+    transfers_with_header = transport->send_packet_with_header != NULL;
+    mock_controller_le_read_buffer_size(controller_acl_length, CONTROLLER_ACL_BUFFERS);
+    mock_controller_le_connection_complete(CON_HANDLE, HCI_ROLE_MASTER, BD_ADDR_TYPE_LE_RANDOM, NULL);
+
+    double start = now_s();
+    uint32_t pdus_sent = 0;
+    while (1){
+        while (pdus_sent < NUM_PDUS && hci_can_send_acl_packet_now(CON_HANDLE)){
+            send_pdu(pdus_sent++);
+        }
+        if (transfers_count == 0) break;
+        usb_complete_next_transfer();
+    }
+    double elapsed = now_s() - start;
+
+    if (rx_pdus != NUM_PDUS || hci_is_packet_buffer_reserved()){
+        printf("%s: stalled after %u PDUs\n", transport->name, rx_pdus);
+        exit(1);
+    }
+    double total_bytes = (double) NUM_PDUS * PDU_SIZE;
+    printf("%-16s %u in flight, ACL %4u: %5u fragments (%5u without copy), %7.1f kB/s over USB, host %5.2f ns/byte\n",
+        transport->name, max_in_flight, controller_acl_length, rx_fragments, transfers_contiguous,
+        total_bytes * 1000.0 / now_us, elapsed * 1e9 / total_bytes);
+}
+
+int main(void){
+    int i;
+    for (i = 0; i < PDU_SIZE; i++){
+        pdu_pattern[i] = (uint8_t) (i * 7);
+    }
+    little_endian_store_16(pdu_pattern, 0, PDU_SIZE - 4);
+    little_endian_store_16(pdu_pattern, 2, 0x0040);
+
+    printf("HCI ACL fragmentation, %u PDUs of %u bytes, %u controller buffers\n", NUM_PDUS, PDU_SIZE, CONTROLLER_ACL_BUFFERS);
+
+    static const uint16_t acl_lengths[] = { 27, 251, 1021 };
+    unsigned int j;
+    for (j = 0; j < sizeof(acl_lengths) / sizeof(uint16_t); j++){
+        // hci.c can only be initialized once per process
+        int k;
+        for (k = 0; k < 3; k++){
+            fflush(stdout);
+            pid_t pid = fork();
+            if (pid == 0){
+                switch (k){
+                    case 0:
+                        benchmark(&mock_transport_classic, 1, acl_lengths[j]);
+                        break;
+                    case 1:
+                        benchmark(&mock_transport_with_header, 1, acl_lengths[j]);
+                        break;
+                    default:
+                        benchmark(&mock_transport_with_header, 4, acl_lengths[j]);
+                        break;
+                }
+                exit(0);
+            }
+            int status;
+            waitpid(pid, &status, 0);
+            if (!WIFEXITED(status) || WEXITSTATUS(status)) return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,316 @@
+/*
+ * Copyright (C) 2017 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+/*
+ *  h5_throughput_test.c
+ *
+ *  Loopback throughput of the H5 transport for sliding window sizes 1 to 7 over a pty pair.
+ *  A forked controller emulator consumes reliable packets at a simulated UART baud rate
+ *  and acknowledges them after a fixed processing delay.
+ */
+
+#define _DEFAULT_SOURCE
+#define _XOPEN_SOURCE 600
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "btstack_config.h"
+#include "btstack_run_loop.h"
+#include "btstack_run_loop_posix.h"
+#include "btstack_slip.h"
+#include "btstack_uart_block.h"
+#include "btstack_util.h"
+#include "hci.h"
+#include "hci_dump.h"
+#include "hci_transport.h"
+
+#define NUM_PACKETS         1000
+#define ACL_PAYLOAD_LEN      252
+#define EMULATED_BAUDRATE   3000000
+#define EMULATED_ACK_DELAY_US  1000
+
+// H5 constants
+#define H5_ACK_PACKET_TYPE      0x00
+#define H5_CONTROL_PACKET_TYPE  0x0f
+#define H5_MAX_FRAME_LEN        (4 + HCI_PACKET_BUFFER_SIZE + 2)
+
+static uint8_t acl_packet[HCI_ACL_HEADER_SIZE + ACL_PAYLOAD_LEN];
+static int     packets_sent;
+static double  start_time;
+static int     emulator_pid;
+static int     window_size;
+
+static double now_s(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// Controller emulator
+
+static int     emulator_fd;
+static uint8_t emulator_frame[H5_MAX_FRAME_LEN];
+static uint8_t emulator_expected_seq_nr;
+static uint8_t emulator_seq_nr;
+static int     emulator_packets_received;
+static double  emulator_ack_due;    // 0 = no ack pending
+
+static void emulator_send_frame(uint8_t seq_nr, int reliable, uint8_t packet_type, const uint8_t * payload, uint16_t len){
+    uint8_t header[4];
+    header[0] = seq_nr | (emulator_expected_seq_nr << 3) | (reliable << 7);
+    header[1] = packet_type | ((len & 0x0f) << 4);
+    header[2] = len >> 4;
+    header[3] = 0xff - (header[0] + header[1] + header[2]);
+
+    uint8_t buffer[2 * (4 + 16) + 2];
+    int pos = 0;
+    buffer[pos++] = BTSTACK_SLIP_SOF;
+    btstack_slip_encoder_start(header, 4);
+    while (btstack_slip_encoder_has_data()){
+        buffer[pos++] = btstack_slip_encoder_get_byte();
+    }
+    if (len){
+        btstack_slip_encoder_start(payload, len);
+        while (btstack_slip_encoder_has_data()){
+            buffer[pos++] = btstack_slip_encoder_get_byte();
+        }
+    }
+    buffer[pos++] = BTSTACK_SLIP_SOF;
+    if (write(emulator_fd, buffer, pos) != pos){
+        exit(1);
+    }
+}
+
+static void emulator_process_frame(uint16_t frame_size){
+    if (frame_size < 4) return;
+    uint8_t  seq_nr      = emulator_frame[0] & 0x07;
+    int      reliable    = (emulator_frame[0] & 0x80) != 0;
+    uint8_t  packet_type = emulator_frame[1] & 0x0f;
+    const uint8_t * payload = &emulator_frame[4];
+
+    if (packet_type == H5_CONTROL_PACKET_TYPE){
+        static const uint8_t sync[]            = { 0x01, 0x7e};
+        static const uint8_t sync_response[]   = { 0x02, 0x7d};
+        static const uint8_t config[]          = { 0x03, 0xfc};
+        // sliding window 7, data integrity check supported
+        static const uint8_t config_response[] = { 0x04, 0x7b, 0x17};
+        if (memcmp(payload, sync, sizeof(sync)) == 0){
+            emulator_send_frame(0, 0, H5_CONTROL_PACKET_TYPE, sync_response, sizeof(sync_response));
+        } else if (memcmp(payload, config, sizeof(config)) == 0){
+            emulator_send_frame(0, 0, H5_CONTROL_PACKET_TYPE, config_response, sizeof(config_response));
+        }
+        return;
+    }
+    if (!reliable) return;
+
+    // out of sequence: discard and ack right away with expected seq nr
+    if (seq_nr != emulator_expected_seq_nr){
+        emulator_send_frame(0, 0, H5_ACK_PACKET_TYPE, NULL, 0);
+        return;
+    }
+    emulator_expected_seq_nr = (emulator_expected_seq_nr + 1) & 0x07;
+    if (emulator_ack_due == 0){
+        emulator_ack_due = now_s() + EMULATED_ACK_DELAY_US / 1e6;
+    }
+    if (packet_type != HCI_ACL_DATA_PACKET) return;
+    emulator_packets_received++;
+    if (emulator_packets_received < NUM_PACKETS) return;
+
+    // all received, report with HCI Event that also acknowledges last packet
+    uint8_t event[] = { HCI_EVENT_VENDOR_SPECIFIC, 0};
+    emulator_send_frame(emulator_seq_nr, 1, HCI_EVENT_PACKET, event, sizeof(event));
+    emulator_seq_nr = (emulator_seq_nr + 1) & 0x07;
+    emulator_ack_due = 0;
+}
+
+static void emulator_run(void){
+    double line_time = 0;
+    btstack_slip_decoder_init(emulator_frame, sizeof(emulator_frame));
+    while (1){
+        int timeout_ms = -1;
+        if (emulator_ack_due != 0){
+            timeout_ms = (int) ((emulator_ack_due - now_s()) * 1000);
+            if (timeout_ms < 0) timeout_ms = 0;
+        }
+        struct pollfd pfd = { emulator_fd, POLLIN, 0};
+        poll(&pfd, 1, timeout_ms);
+        if (pfd.revents & POLLIN){
+            uint8_t buffer[256];
+            int len = read(emulator_fd, buffer, sizeof(buffer));
+            if (len <= 0) exit(0);
+            // simulate UART: delay processing until bytes could have been received at the emulated baud rate
+            double now = now_s();
+            if (line_time < now){
+                line_time = now;
+            }
+            line_time += len * 10.0 / EMULATED_BAUDRATE;
+            double wait = line_time - now_s();
+            if (wait > 0){
+                usleep((useconds_t) (wait * 1e6));
+            }
+            int i;
+            for (i = 0; i < len; i++){
+                btstack_slip_decoder_process(buffer[i]);
+                uint16_t frame_size = btstack_slip_decoder_frame_size();
+                if (!frame_size) continue;
+                emulator_process_frame(frame_size);
+                btstack_slip_decoder_init(emulator_frame, sizeof(emulator_frame));
+            }
+        } else if (pfd.revents & (POLLHUP | POLLERR)){
+            exit(0);
+        }
+        // cumulative ack for all packets received so far
+        if (emulator_ack_due != 0 && now_s() >= emulator_ack_due){
+            emulator_ack_due = 0;
+            emulator_send_frame(0, 0, H5_ACK_PACKET_TYPE, NULL, 0);
+        }
+    }
+}
+
+// Host
+
+static const hci_transport_t * transport;
+
+static void host_send_packets(void){
+    while (packets_sent < NUM_PACKETS && transport->can_send_packet_now(HCI_ACL_DATA_PACKET)){
+        if (packets_sent == 0){
+            start_time = now_s();
+        }
+        little_endian_store_16(acl_packet, 0, 0x0001 | (0x02 << 12));
+        little_endian_store_16(acl_packet, 2, ACL_PAYLOAD_LEN);
+        acl_packet[4] = (uint8_t) packets_sent;
+        transport->send_packet(HCI_ACL_DATA_PACKET, acl_packet, sizeof(acl_packet));
+        packets_sent++;
+    }
+}
+
+static void host_packet_handler(uint8_t packet_type, uint8_t *packet, uint16_t size){
+    UNUSED(size);
+    if (packet_type != HCI_EVENT_PACKET) return;
+    switch (packet[0]){
+        case HCI_EVENT_TRANSPORT_PACKET_SENT:
+            host_send_packets();
+            break;
+        case HCI_EVENT_VENDOR_SPECIFIC: {
+            double elapsed = now_s() - start_time;
+            printf("window %u: %u x %u bytes in %7.3f s -> %7.1f kB/s\n", window_size, NUM_PACKETS,
+                (int) sizeof(acl_packet), elapsed, NUM_PACKETS * sizeof(acl_packet) / elapsed / 1000.0);
+            kill(emulator_pid, SIGTERM);
+            waitpid(emulator_pid, NULL, 0);
+            exit(0);
+        }
+        default:
+            break;
+    }
+}
+
+static void test_window_size(int size){
+    window_size = size;
+
+    int master_fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master_fd < 0 || grantpt(master_fd) || unlockpt(master_fd)){
+        printf("pty setup failed\n");
+        exit(1);
+    }
+    struct termios toptions;
+    tcgetattr(master_fd, &toptions);
+    cfmakeraw(&toptions);
+    tcsetattr(master_fd, TCSANOW, &toptions);
+    const char * slave_name = ptsname(master_fd);
+
+    emulator_pid = fork();
+    if (emulator_pid == 0){
+        emulator_fd = master_fd;
+        emulator_run();
+    }
+
+    btstack_run_loop_init(btstack_run_loop_posix_get_instance());
+    hci_dump_enable_log_level(LOG_LEVEL_DEBUG, 0);
+    hci_dump_enable_log_level(LOG_LEVEL_INFO, 0);
+
+    static hci_transport_config_uart_t config = {
+        HCI_TRANSPORT_CONFIG_UART,
+        EMULATED_BAUDRATE,
+        0,
+        0,
+        NULL,
+    };
+    config.device_name = slave_name;
+
+    transport = hci_transport_h5_instance(btstack_uart_block_posix_instance());
+    hci_transport_h5_set_sliding_window_size(window_size);
+    transport->init(&config);
+    transport->register_packet_handler(&host_packet_handler);
+    if (transport->open()){
+        printf("open %s failed\n", slave_name);
+        exit(1);
+    }
+
+    // limit test duration
+    alarm(60);
+    btstack_run_loop_execute();
+}
+
+int main(void){
+    printf("H5 throughput, emulated baud rate %u, ack delay %u us, max window size %u\n", EMULATED_BAUDRATE, EMULATED_ACK_DELAY_US, HCI_TRANSPORT_H5_MAX_WINDOW_SIZE);
+    int size;
+    for (size = 1; size <= 7; size++){
+        // run loop cannot be initialized twice, use new process for each window size
+        fflush(stdout);
+        int pid = fork();
+        if (pid == 0){
+            test_window_size(size);
+        }
+        int status;
+        waitpid(pid, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0){
+            printf("window %u: failed\n", size);
+            return 1;
+        }
+    }
+    return 0;
+}
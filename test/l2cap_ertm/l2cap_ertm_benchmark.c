@@ -0,0 +1,522 @@
+/*
+ * Copyright (C) 2017 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+/*
+ *  l2cap_ertm_benchmark.c
+ *
+ *  Stream SDUs over an L2CAP ERTM channel through hci.c and l2cap.c to a simulated remote
+ *  device over a lossy link, with a mock transport and controller.
+ *
+ *  The mock transport is synchronous, so ACL buffers in the controller limit the number of
+ *  I-Frames sent in a burst. Time is virtual: a link round delivers all ACL packets buffered in the controller, reports
+ *  them as completed and advances the clock by 1 ms. Retransmission and monitor timers run on
+ *  the embedded run loop.
+ *
+ *  The remote acknowledges in-sequence I-Frames once per link round, rejects gaps with REJ,
+ *  answers polls and streams small I-Frames of its own, so that acknowledgements can be
+ *  piggybacked on I-Frames. Only I-Frames from BTstack to the remote get lost.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "btstack_config.h"
+#include "btstack_event.h"
+#include "btstack_run_loop_embedded.h"
+#include "btstack_util.h"
+#include "hal_time_ms.h"
+#include "hci.h"
+#include "hci_cmd.h"
+#include "l2cap.h"
+#include "l2cap_signaling.h"
+#include "mock_controller.h"
+#include "mock_embedded.h"
+
+#define CON_HANDLE                  0x0001
+#define PSM                         0x1001
+#define REMOTE_CID                  0x0041
+#define CONTROLLER_ACL_BUFFERS      8
+#define CONTROLLER_EVENTS           8
+#define SDU_SIZE                    600
+#define REVERSE_SDU_SIZE            20
+#define NUM_SDUS                    20000
+#define MAX_ROUNDS                  (NUM_SDUS * 100)
+
+// remote accepts up to REMOTE_TX_WINDOW unacknowledged I-Frames
+#define REMOTE_TX_WINDOW            12
+#define REMOTE_MAX_TRANSMIT         50
+#define REMOTE_MPS                  1000
+
+#define NUM_TX_BUFFERS              16
+#define NUM_RX_BUFFERS              4
+#define ERTM_BUFFER_SIZE            (16 + NUM_RX_BUFFERS * sizeof(l2cap_ertm_rx_packet_state_t) \
+                                        + NUM_TX_BUFFERS * sizeof(l2cap_ertm_tx_packet_state_t) \
+                                        + SDU_SIZE + (NUM_RX_BUFFERS + NUM_TX_BUFFERS) * SDU_SIZE)
+
+static l2cap_ertm_config_t ertm_config = {
+    1,      // ertm mandatory
+    50,     // max transmit
+    2000,   // retransmission timeout
+    12000,  // monitor timeout
+    SDU_SIZE,
+    NUM_TX_BUFFERS,
+    NUM_RX_BUFFERS,
+};
+
+static const uint16_t loss_permille[] = { 0, 10, 50, 100 };
+
+typedef struct {
+    uint16_t local_cid;         // destination for I-Frames
+    uint8_t  expected_tx_seq;
+    uint8_t  next_tx_seq;
+    uint8_t  unacked_frames;
+    uint8_t  rej_sent;
+    uint8_t  ack_pending;
+    uint32_t received_sdus;
+} remote_channel_t;
+
+static uint32_t lcg = 12345;
+static uint16_t current_loss_permille;
+
+static mock_packet_t controller_events[CONTROLLER_EVENTS];
+static int           controller_num_events;
+static mock_packet_t remote_acl[CONTROLLER_ACL_BUFFERS];
+static int           remote_num_acl;
+
+static remote_channel_t remote;
+static uint32_t remote_lost_frames;
+static uint8_t  remote_sig_id;
+
+static uint8_t  ertm_buffer[ERTM_BUFFER_SIZE];
+static uint16_t local_cid;
+static int      channel_open;
+static uint32_t sdus_to_send;
+static uint32_t sdus_sent;
+static uint32_t reverse_sdus_received;
+
+static double now_s(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static uint16_t fcs_calc(const uint8_t * data, uint16_t len){
+    uint16_t crc = 0;
+    while (len--){
+        crc ^= *data++;
+        int i;
+        for (i = 0; i < 8; i++){
+            crc = (crc & 1) ? (crc >> 1) ^ 0xa001 : (crc >> 1);
+        }
+    }
+    return crc;
+}
+
+// mock controller
+
+static void controller_queue_command_complete(const uint8_t * command){
+    if (controller_num_events == CONTROLLER_EVENTS) mock_fail("controller event queue full");
+    mock_packet_t * event = &controller_events[controller_num_events++];
+    memset(event->data, 0, sizeof(event->data));
+    uint16_t opcode = little_endian_read_16(command, 0);
+    event->data[0] = HCI_EVENT_COMMAND_COMPLETE;
+    event->data[2] = 1;
+    little_endian_store_16(event->data, 3, opcode);
+    event->data[5] = ERROR_CODE_SUCCESS;
+    if (opcode == hci_read_local_supported_commands.opcode){
+        // Read Buffer Size supported
+        event->data[6 + 14] = 0x80;
+    }
+    if (opcode == hci_read_buffer_size.opcode){
+        little_endian_store_16(event->data, 6, HCI_ACL_PAYLOAD_SIZE);
+        little_endian_store_16(event->data, 9, CONTROLLER_ACL_BUFFERS);
+    }
+    // room for 64 octets of supported commands
+    event->data[1] = 4 + 64;
+    event->size    = 2 + 4 + 64;
+}
+
+// ACL packets are stored in the mock controller buffers
+static void controller_receive_packet(uint8_t packet_type, uint8_t *packet, uint16_t size){
+    UNUSED(size);
+    if (packet_type != HCI_COMMAND_DATA_PACKET) return;
+    controller_queue_command_complete(packet);
+}
+
+static void advance_time(void){
+    mock_set_time_us(mock_time_us() + 1000);
+    btstack_run_loop_embedded_execute_once();
+}
+
+static void controller_process_events(void){
+    int i;
+    // events might trigger new commands
+    while (controller_num_events){
+        mock_packet_t events[CONTROLLER_EVENTS];
+        int num_events = controller_num_events;
+        memcpy(events, controller_events, num_events * sizeof(mock_packet_t));
+        controller_num_events = 0;
+        for (i = 0; i < num_events; i++){
+            mock_controller_send_event(events[i].data, events[i].size);
+        }
+    }
+}
+
+static void controller_connect(void){
+    uint8_t event[13];
+    bd_addr_t address = { 0x00, 0x1b, 0xdc, 0x07, 0x32, 0xef };
+    // incoming connection
+    event[0] = HCI_EVENT_CONNECTION_REQUEST;
+    event[1] = 10;
+    reverse_bd_addr(address, &event[2]);
+    memset(&event[8], 0, 3);
+    event[11] = 1;
+    mock_controller_send_event(event, 12);
+    controller_process_events();
+    // connection complete
+    event[0] = HCI_EVENT_CONNECTION_COMPLETE;
+    event[1] = sizeof(event) - 2;
+    event[2] = 0;
+    little_endian_store_16(event, 3, CON_HANDLE);
+    reverse_bd_addr(address, &event[5]);
+    event[11] = 1;
+    event[12] = 0;
+    mock_controller_send_event(event, sizeof(event));
+    controller_process_events();
+}
+
+// simulated remote device
+
+static uint8_t * remote_prepare_acl(uint16_t cid, uint16_t payload_len){
+    if (remote_num_acl == CONTROLLER_ACL_BUFFERS) mock_fail("remote ACL buffers exceeded");
+    mock_packet_t * packet = &remote_acl[remote_num_acl++];
+    little_endian_store_16(packet->data, 0, CON_HANDLE | (0x02 << 12));
+    little_endian_store_16(packet->data, 2, 4 + payload_len);
+    little_endian_store_16(packet->data, 4, payload_len);
+    little_endian_store_16(packet->data, 6, cid);
+    packet->size = 8 + payload_len;
+    return &packet->data[8];
+}
+
+// responses use identifier of request
+static void remote_send_signaling(uint8_t code, uint8_t sig_id, const uint8_t * data, uint16_t len){
+    uint8_t * command = remote_prepare_acl(L2CAP_CID_SIGNALING, 4 + len);
+    command[0] = code;
+    command[1] = sig_id;
+    little_endian_store_16(command, 2, len);
+    memcpy(&command[4], data, len);
+}
+
+static void remote_send_frame(uint16_t control, const uint8_t * payload, uint16_t payload_len){
+    uint8_t * frame = remote_prepare_acl(remote.local_cid, 2 + payload_len + 2);
+    little_endian_store_16(frame, 0, control);
+    memcpy(&frame[2], payload, payload_len);
+    // fcs over basic l2cap header, control and payload
+    little_endian_store_16(frame, 2 + payload_len, fcs_calc(frame - 4, 4 + 2 + payload_len));
+}
+
+static void remote_send_supervisor_frame(l2cap_supervisory_function_t function, int final){
+    uint16_t control = (remote.expected_tx_seq << 8) | (final << 7) | (((int) function) << 2) | 1;
+    remote_send_frame(control, NULL, 0);
+    remote.ack_pending = 0;
+}
+
+static void remote_send_information_frame(void){
+    uint8_t payload[REVERSE_SDU_SIZE];
+    memset(payload, 0x55, sizeof(payload));
+    uint16_t control = (L2CAP_SEGMENTATION_AND_REASSEMBLY_UNSEGMENTED_L2CAP_SDU << 14) | (remote.expected_tx_seq << 8) | (remote.next_tx_seq << 1);
+    remote_send_frame(control, payload, sizeof(payload));
+    remote.next_tx_seq = (remote.next_tx_seq + 1) & 0x3f;
+    remote.unacked_frames++;
+    remote.ack_pending = 0;
+}
+
+static void remote_process_req_seq(uint8_t req_seq){
+    // oldest unacknowledged frame has tx_seq = next_tx_seq - unacked_frames
+    uint8_t num_acked = (req_seq - (remote.next_tx_seq - remote.unacked_frames)) & 0x3f;
+    if (num_acked > remote.unacked_frames) return;
+    remote.unacked_frames -= num_acked;
+}
+
+static void remote_send_config_request(void){
+    uint8_t request[4 + 4 + 11];
+    little_endian_store_16(request, 0, remote.local_cid);
+    little_endian_store_16(request, 2, 0);
+    // MTU
+    request[4] = L2CAP_CONFIG_OPTION_TYPE_MAX_TRANSMISSION_UNIT;
+    request[5] = 2;
+    little_endian_store_16(request, 6, SDU_SIZE);
+    // Retransmission and Flow Control
+    request[8]  = L2CAP_CONFIG_OPTION_TYPE_RETRANSMISSION_AND_FLOW_CONTROL;
+    request[9]  = 9;
+    request[10] = L2CAP_CHANNEL_MODE_ENHANCED_RETRANSMISSION;
+    request[11] = REMOTE_TX_WINDOW;
+    request[12] = REMOTE_MAX_TRANSMIT;
+    little_endian_store_16(request, 13, 2000);
+    little_endian_store_16(request, 15, 12000);
+    little_endian_store_16(request, 17, REMOTE_MPS);
+    remote_send_signaling(CONFIGURE_REQUEST, ++remote_sig_id, request, sizeof(request));
+}
+
+static void remote_receive_signaling(const uint8_t * command){
+    uint8_t response[8];
+    switch (command[0]){
+        case INFORMATION_REQUEST:
+            // extended features: ERTM + FCS
+            little_endian_store_16(response, 0, L2CAP_INFO_TYPE_EXTENDED_FEATURES_SUPPORTED);
+            little_endian_store_16(response, 2, 0);
+            little_endian_store_32(response, 4, 0x08 | 0x20);
+            remote_send_signaling(INFORMATION_RESPONSE, command[1], response, 8);
+            break;
+        case CONNECTION_RESPONSE:
+            if (little_endian_read_16(command, 8) != 0) break;
+            remote.local_cid = little_endian_read_16(command, 4);
+            remote_send_config_request();
+            break;
+        case CONFIGURE_REQUEST:
+            little_endian_store_16(response, 0, remote.local_cid);
+            little_endian_store_16(response, 2, 0);
+            little_endian_store_16(response, 4, 0);
+            remote_send_signaling(CONFIGURE_RESPONSE, command[1], response, 6);
+            break;
+        default:
+            break;
+    }
+}
+
+static void remote_receive_frame(const uint8_t * frame, uint16_t frame_len){
+    uint16_t control = little_endian_read_16(frame, 0);
+    uint8_t  req_seq = (control >> 8) & 0x3f;
+    if (fcs_calc(frame - 4, 4 + frame_len - 2) != little_endian_read_16(frame, frame_len - 2)) mock_fail("FCS mismatch");
+    remote_process_req_seq(req_seq);
+
+    if (control & 1){
+        // S-Frame: answer poll
+        int poll = (control >> 4) & 1;
+        if (poll){
+            remote_send_supervisor_frame(L2CAP_SUPERVISORY_FUNCTION_RR_RECEIVER_READY, 1);
+        }
+        return;
+    }
+
+    // I-Frame
+    if (((lcg = lcg * 1103515245u + 12345u) >> 16) % 1000 < current_loss_permille){
+        remote_lost_frames++;
+        return;
+    }
+    uint8_t tx_seq = (control >> 1) & 0x3f;
+    uint8_t delta  = (tx_seq - remote.expected_tx_seq) & 0x3f;
+    if (delta == 0){
+        if (frame_len != 2 + SDU_SIZE + 2) mock_fail("wrong SDU size");
+        if (little_endian_read_32(frame, 2) != remote.received_sdus) mock_fail("SDU out of order");
+        remote.received_sdus++;
+        remote.expected_tx_seq = (remote.expected_tx_seq + 1) & 0x3f;
+        remote.rej_sent = 0;
+        remote.ack_pending = 1;
+        return;
+    }
+    // ignore duplicates, reject gaps once
+    if (delta > REMOTE_TX_WINDOW) return;
+    if (remote.rej_sent) return;
+    remote.rej_sent = 1;
+    remote_send_supervisor_frame(L2CAP_SUPERVISORY_FUNCTION_REJ_REJECT, 0);
+}
+
+static void remote_receive_acl(const uint8_t * packet, uint16_t size){
+    uint16_t cid = little_endian_read_16(packet, 6);
+    uint16_t len = little_endian_read_16(packet, 4);
+    if (size != 8 + len) mock_fail("fragmented ACL packet");
+    if (cid == L2CAP_CID_SIGNALING){
+        remote_receive_signaling(&packet[8]);
+    } else if (cid == REMOTE_CID){
+        remote_receive_frame(&packet[8], len);
+    } else {
+        mock_fail("unexpected cid");
+    }
+}
+
+static void remote_connect(void){
+    uint8_t request[4];
+    little_endian_store_16(request, 0, PSM);
+    little_endian_store_16(request, 2, REMOTE_CID);
+    remote_send_signaling(CONNECTION_REQUEST, ++remote_sig_id, request, sizeof(request));
+}
+
+// send everything sent by the controller to the remote and vice versa
+static void link_round(void){
+    int i;
+    mock_packet_t packets[CONTROLLER_ACL_BUFFERS];
+    int num_packets = mock_controller_num_acl();
+    for (i = 0; i < num_packets; i++){
+        packets[i] = *mock_controller_acl(i);
+    }
+    mock_controller_acl_remove(num_packets);
+
+    for (i = 0; i < num_packets; i++){
+        remote_receive_acl(packets[i].data, packets[i].size);
+    }
+
+    // remote streams I-Frames within our tx window, one per round, and acknowledges once per round
+    if (channel_open && remote.unacked_frames < NUM_RX_BUFFERS){
+        remote_send_information_frame();
+    }
+    if (remote.ack_pending){
+        remote_send_supervisor_frame(L2CAP_SUPERVISORY_FUNCTION_RR_RECEIVER_READY, 0);
+    }
+
+    if (num_packets){
+        mock_controller_number_of_completed_packets(CON_HANDLE, num_packets);
+    }
+
+    num_packets = remote_num_acl;
+    memcpy(packets, remote_acl, num_packets * sizeof(mock_packet_t));
+    remote_num_acl = 0;
+    for (i = 0; i < num_packets; i++){
+        mock_controller_receive_acl(packets[i].data, packets[i].size);
+    }
+
+    controller_process_events();
+
+    advance_time();
+}
+
+// local application
+
+static void send_sdus(void){
+    while (sdus_sent < sdus_to_send && l2cap_can_send_packet_now(local_cid)){
+        uint8_t sdu[SDU_SIZE];
+        memset(sdu, 0, sizeof(sdu));
+        little_endian_store_32(sdu, 0, sdus_sent);
+        if (l2cap_send(local_cid, sdu, sizeof(sdu))) mock_fail("l2cap_send failed");
+        sdus_sent++;
+    }
+    if (sdus_sent < sdus_to_send){
+        l2cap_request_can_send_now_event(local_cid);
+    }
+}
+
+static void l2cap_packet_handler(uint8_t packet_type, uint16_t cid, uint8_t *packet, uint16_t size){
+    switch (packet_type){
+        case HCI_EVENT_PACKET:
+            switch (hci_event_packet_get_type(packet)){
+                case L2CAP_EVENT_INCOMING_CONNECTION:
+                    l2cap_accept_ertm_connection(l2cap_event_incoming_connection_get_local_cid(packet),
+                        &ertm_config, ertm_buffer, sizeof(ertm_buffer));
+                    break;
+                case L2CAP_EVENT_CHANNEL_OPENED:
+                    if (l2cap_event_channel_opened_get_status(packet)) mock_fail("channel open failed");
+                    local_cid = l2cap_event_channel_opened_get_local_cid(packet);
+                    channel_open = 1;
+                    break;
+                case L2CAP_EVENT_CHANNEL_CLOSED:
+                    mock_fail("channel closed");
+                    break;
+                case L2CAP_EVENT_CAN_SEND_NOW:
+                    send_sdus();
+                    break;
+                default:
+                    break;
+            }
+            break;
+        case L2CAP_DATA_PACKET:
+            if (cid != local_cid || size != REVERSE_SDU_SIZE) mock_fail("unexpected SDU");
+            reverse_sdus_received++;
+            break;
+        default:
+            break;
+    }
+}
+
+int main(void){
+    mock_init(btstack_run_loop_embedded_get_instance(), mock_transport_get_instance());
+    mock_register_packet_handler(&controller_receive_packet);
+    mock_controller_set_acl_buffers(CONTROLLER_ACL_BUFFERS);
+    l2cap_init();
+    l2cap_register_service(&l2cap_packet_handler, PSM, SDU_SIZE, LEVEL_0);
+
+    // init sequence might wait for timers
+    hci_power_control(HCI_POWER_ON);
+    int i;
+    for (i = 0; i < 1000 && hci_get_state() != HCI_STATE_WORKING; i++){
+        controller_process_events();
+        advance_time();
+    }
+    if (hci_get_state() != HCI_STATE_WORKING) mock_fail("power on failed");
+
+    controller_connect();
+    remote_connect();
+    for (i = 0; i < 100 && !channel_open; i++){
+        link_round();
+    }
+    if (!channel_open) mock_fail("channel not opened");
+
+    for (i = 0; i < (int) (sizeof(loss_permille) / sizeof(loss_permille[0])); i++){
+        current_loss_permille = loss_permille[i];
+        l2cap_ertm_stats_t stats_before;
+        l2cap_ertm_stats_t stats;
+        l2cap_ertm_get_stats(local_cid, &stats_before);
+        uint32_t lost_before     = remote_lost_frames;
+        uint32_t reverse_before  = reverse_sdus_received;
+        uint32_t time_before     = hal_time_ms();
+
+        double start = now_s();
+        sdus_to_send += NUM_SDUS;
+        send_sdus();
+        while (remote.received_sdus < sdus_to_send){
+            link_round();
+            if (hal_time_ms() - time_before > MAX_ROUNDS) mock_fail("transfer stalled");
+        }
+        double transfer_s = now_s() - start;
+
+        l2cap_ertm_get_stats(local_cid, &stats);
+        uint32_t rounds = hal_time_ms() - time_before;
+        printf("loss %4.1f%%: %u SDUs in %6u rounds (%4.2f SDUs/round), %3u ns/SDU | I-Frames %6u, lost %5u, retransmitted %5u, window stalls %4u, S-Frames %5u, piggybacked acks %5u for %5u SDUs received\n",
+            current_loss_permille / 10.0, NUM_SDUS, rounds, (double) NUM_SDUS / rounds, (unsigned int) (transfer_s * 1e9 / NUM_SDUS),
+            stats.i_frames_sent    - stats_before.i_frames_sent,
+            remote_lost_frames     - lost_before,
+            stats.retransmissions  - stats_before.retransmissions,
+            stats.tx_window_stalls - stats_before.tx_window_stalls,
+            stats.s_frames_sent    - stats_before.s_frames_sent,
+            stats.acks_piggybacked - stats_before.acks_piggybacked,
+            reverse_sdus_received  - reverse_before);
+
+        if (stats.retransmissions - stats_before.retransmissions < remote_lost_frames - lost_before) mock_fail("lost frames not retransmitted");
+    }
+    return 0;
+}
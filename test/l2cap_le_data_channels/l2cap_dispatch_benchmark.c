@@ -0,0 +1,265 @@
+/*
+ * Copyright (C) 2017 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+/*
+ *  l2cap_dispatch_benchmark.c
+ *
+ *  Dispatch inbound PDUs to hundreds of LE Data Channels spread over dozens of connections
+ *  through hci.c and l2cap.c with a mock transport, then disconnect all connections.
+ *
+ *  Build with different L2CAP_CHANNEL_INDEX_SIZE to compare against a linear search,
+ *  L2CAP_CHANNEL_INDEX_SIZE = 1 puts all channels into a single bucket.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "btstack_config.h"
+#include "btstack_event.h"
+#include "btstack_run_loop_posix.h"
+#include "btstack_util.h"
+#include "hci.h"
+#include "l2cap.h"
+#include "l2cap_signaling.h"
+#include "mock_controller.h"
+#include "ble/sm.h"
+
+#define NUM_CONNECTIONS             32
+#define CHANNELS_PER_CONNECTION     16
+#define NUM_CHANNELS                (NUM_CONNECTIONS * CHANNELS_PER_CONNECTION)
+#define FIRST_CON_HANDLE            0x0040
+#define PSM                         0x0080
+#define FIRST_REMOTE_CID            0x0040
+#define SDU_SIZE                    20
+#define INITIAL_CREDITS             60000
+#define NUM_PDUS                    500000
+#define CONTROLLER_ACL_BUFFERS      8
+
+typedef struct {
+    hci_con_handle_t con_handle;
+    uint16_t remote_cid;
+    uint16_t local_cid;
+    uint8_t  receive_buffer[SDU_SIZE];
+} benchmark_channel_t;
+
+static btstack_packet_handler_t l2cap_benchmark_handler;
+
+static benchmark_channel_t channels[NUM_CHANNELS];
+static int      num_channels_opened;
+static int      num_channels_closed;
+static uint32_t received_sdus;
+static uint16_t completed_packets[NUM_CONNECTIONS];
+
+static double now_s(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static benchmark_channel_t * channel_for_handle_and_remote_cid(hci_con_handle_t con_handle, uint16_t remote_cid){
+    int connection = con_handle - FIRST_CON_HANDLE;
+    int index      = remote_cid - FIRST_REMOTE_CID;
+    if (connection < 0 || connection >= NUM_CONNECTIONS) return NULL;
+    if (index      < 0 || index      >= CHANNELS_PER_CONNECTION) return NULL;
+    return &channels[connection * CHANNELS_PER_CONNECTION + index];
+}
+
+
+// remote device
+
+static void remote_receive_packet(uint8_t packet_type, uint8_t *packet, uint16_t size){
+    UNUSED(size);
+    if (packet_type != HCI_ACL_DATA_PACKET) return;
+    hci_con_handle_t con_handle = little_endian_read_16(packet, 0) & 0x0fff;
+    if (little_endian_read_16(packet, 6) != L2CAP_CID_SIGNALING_LE) mock_fail("unexpected ACL packet");
+    completed_packets[con_handle - FIRST_CON_HANDLE]++;
+    const uint8_t * command = &packet[8];
+    if (command[0] != LE_CREDIT_BASED_CONNECTION_RESPONSE) mock_fail("unexpected signaling packet");
+    // remote uses sig_id = channel index + 1
+    benchmark_channel_t * channel = channel_for_handle_and_remote_cid(con_handle, FIRST_REMOTE_CID + command[1] - 1);
+    if (!channel) mock_fail("unexpected connection response");
+    channel->local_cid = little_endian_read_16(command, 4);
+}
+
+// mock controller
+
+static void controller_report_completed_packets(void){
+    int i;
+    for (i = 0; i < NUM_CONNECTIONS; i++){
+        while (completed_packets[i]){
+            completed_packets[i]--;
+            mock_controller_number_of_completed_packets(FIRST_CON_HANDLE + i, 1);
+            mock_controller_packet_sent();
+        }
+    }
+}
+
+// send L2CAP PDU from remote in a single ACL packet
+static void remote_send_l2cap(hci_con_handle_t con_handle, uint16_t cid, const uint8_t * payload, uint16_t payload_len){
+    uint8_t acl[8 + SDU_SIZE + 16];
+    little_endian_store_16(acl, 0, con_handle | (0x02 << 12));
+    little_endian_store_16(acl, 2, 4 + payload_len);
+    little_endian_store_16(acl, 4, payload_len);
+    little_endian_store_16(acl, 6, cid);
+    memcpy(&acl[8], payload, payload_len);
+    mock_controller_receive_acl(acl, 8 + payload_len);
+}
+
+static void remote_connect(benchmark_channel_t * channel, uint8_t sig_id){
+    uint8_t request[14];
+    request[0] = LE_CREDIT_BASED_CONNECTION_REQUEST;
+    request[1] = sig_id;
+    little_endian_store_16(request, 2, 10);
+    little_endian_store_16(request, 4, PSM);
+    little_endian_store_16(request, 6, channel->remote_cid);
+    little_endian_store_16(request, 8, SDU_SIZE);
+    little_endian_store_16(request, 10, 247);
+    little_endian_store_16(request, 12, 10);
+    remote_send_l2cap(channel->con_handle, L2CAP_CID_SIGNALING_LE, request, sizeof(request));
+}
+
+// single PDU SDU with target local cid as content
+static void remote_send_sdu(hci_con_handle_t con_handle, uint16_t local_cid){
+    uint8_t payload[2 + SDU_SIZE];
+    little_endian_store_16(payload, 0, SDU_SIZE);
+    memset(&payload[2], 0, SDU_SIZE);
+    little_endian_store_16(payload, 2, local_cid);
+    remote_send_l2cap(con_handle, local_cid, payload, sizeof(payload));
+}
+
+static void l2cap_packet_handler(uint8_t packet_type, uint16_t cid, uint8_t *packet, uint16_t size){
+    switch (packet_type){
+        case HCI_EVENT_PACKET:
+            switch (hci_event_packet_get_type(packet)){
+                case L2CAP_EVENT_LE_INCOMING_CONNECTION:
+                    l2cap_le_accept_connection(l2cap_event_le_incoming_connection_get_local_cid(packet),
+                        channel_for_handle_and_remote_cid(l2cap_event_le_incoming_connection_get_handle(packet),
+                            l2cap_event_le_incoming_connection_get_remote_cid(packet))->receive_buffer,
+                        SDU_SIZE, INITIAL_CREDITS);
+                    break;
+                case L2CAP_EVENT_LE_CHANNEL_OPENED:
+                    if (l2cap_event_le_channel_opened_get_status(packet)) mock_fail("channel open failed");
+                    num_channels_opened++;
+                    break;
+                case L2CAP_EVENT_CHANNEL_CLOSED:
+                case L2CAP_EVENT_LE_CHANNEL_CLOSED:
+                    num_channels_closed++;
+                    break;
+                default:
+                    break;
+            }
+            break;
+        case L2CAP_DATA_PACKET:
+            if (size != SDU_SIZE) mock_fail("wrong SDU size");
+            if (little_endian_read_16(packet, 0) != cid) mock_fail("SDU delivered to wrong channel");
+            received_sdus++;
+            break;
+        default:
+            break;
+    }
+}
+
+int main(void){
+    mock_init(btstack_run_loop_posix_get_instance(), mock_transport_with_can_send_now_get_instance());
+    mock_register_packet_handler(&remote_receive_packet);
+    l2cap_init();
+    l2cap_benchmark_handler = &l2cap_packet_handler;
+    l2cap_le_register_service(l2cap_benchmark_handler, PSM, LEVEL_0);
+    mock_controller_le_read_buffer_size(251, CONTROLLER_ACL_BUFFERS);
+
+    // open channels connection by connection
+    int i;
+    for (i = 0; i < NUM_CHANNELS; i++){
+        benchmark_channel_t * channel = &channels[i];
+        int index = i % CHANNELS_PER_CONNECTION;
+        channel->con_handle = FIRST_CON_HANDLE + i / CHANNELS_PER_CONNECTION;
+        channel->remote_cid = FIRST_REMOTE_CID + index;
+        if (index == 0){
+            mock_controller_le_connection_complete(channel->con_handle, HCI_ROLE_SLAVE, BD_ADDR_TYPE_LE_RANDOM, NULL);
+        }
+        remote_connect(channel, index + 1);
+        controller_report_completed_packets();
+    }
+    if (num_channels_opened != NUM_CHANNELS) mock_fail("not all channels opened");
+
+    // PDU for a channel on a different connection must be dropped
+    remote_send_sdu(channels[0].con_handle, channels[NUM_CHANNELS-1].local_cid);
+    if (received_sdus) mock_fail("PDU for channel on other connection delivered");
+
+    // dispatch PDUs to pseudo-random channels
+    uint32_t lcg = 12345;
+    double start = now_s();
+    for (i = 0; i < NUM_PDUS; i++){
+        lcg = lcg * 1103515245u + 12345u;
+        benchmark_channel_t * channel = &channels[(lcg >> 8) % NUM_CHANNELS];
+        remote_send_sdu(channel->con_handle, channel->local_cid);
+    }
+    double dispatch_s = now_s() - start;
+    if (received_sdus != NUM_PDUS) mock_fail("not all SDUs received");
+
+    // disconnect all
+    start = now_s();
+    for (i = 0; i < NUM_CONNECTIONS; i++){
+        mock_controller_disconnection_complete(FIRST_CON_HANDLE + i);
+    }
+    double disconnect_s = now_s() - start;
+    if (num_channels_closed != NUM_CHANNELS) mock_fail("not all channels closed");
+
+    printf("%u channels on %u connections, L2CAP_CHANNEL_INDEX_SIZE %4u: dispatch %6.1f ns/PDU, disconnect %6.1f us/connection\n",
+        NUM_CHANNELS, NUM_CONNECTIONS, L2CAP_CHANNEL_INDEX_SIZE,
+        dispatch_s * 1e9 / NUM_PDUS, disconnect_s * 1e6 / NUM_CONNECTIONS);
+    return 0;
+}
+
+// stubs for Security Manager
+
+int sm_encryption_key_size(hci_con_handle_t con_handle){
+    UNUSED(con_handle);
+    return 0;
+}
+
+int sm_authenticated(hci_con_handle_t con_handle){
+    UNUSED(con_handle);
+    return 0;
+}
+
+authorization_state_t sm_authorization_state(hci_con_handle_t con_handle){
+    UNUSED(con_handle);
+    return AUTHORIZATION_UNKNOWN;
+}
@@ -0,0 +1,351 @@
+/*
+ * Copyright (C) 2017 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+/*
+ *  le_data_channel_benchmark.c
+ *
+ *  Receive SDUs over an LE Data Channel through hci.c and l2cap.c with a mock transport.
+ *  The remote device is simulated: it segments SDUs into PDUs according to the MPS announced
+ *  by BTstack, sends a PDU whenever it has a credit, and fragments each PDU into LL packets.
+ *
+ *  Link model, 1M PHY: each LL packet takes 8 us per byte plus 10 bytes for preamble, access
+ *  address, header and CRC, followed by an empty acknowledgement and two inter frame spaces.
+ *  LE Flow Control Credit packets sent by BTstack use the link as well and can be used
+ *  by the remote after an additional delay for processing on the remote side.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "btstack_config.h"
+#include "btstack_event.h"
+#include "btstack_run_loop_posix.h"
+#include "btstack_util.h"
+#include "hci.h"
+#include "l2cap.h"
+#include "l2cap_signaling.h"
+#include "mock_controller.h"
+#include "ble/sm.h"
+
+#define CON_HANDLE              0x0040
+#define PSM                     0x0080
+#define REMOTE_CID              0x0040
+#define SDU_SIZE                1000
+#define NUM_SDUS                200
+#define INITIAL_CREDITS         16
+#define CONTROLLER_ACL_BUFFERS  8
+
+#define LL_US_PER_BYTE          8
+#define LL_OVERHEAD_BYTES       10
+#define LL_EMPTY_PDU_US         80
+#define LL_IFS_US               150
+#define REMOTE_CREDIT_DELAY_US  2500
+
+#define MAX_PENDING_CREDITS     64
+
+typedef struct {
+    uint16_t link_octets;   // max LL payload, 27 without / 251 with LE Data Length Extension
+    uint16_t mps;           // 0 = follow LE ACL buffer size
+    uint16_t watermark;
+    uint16_t batch_size;
+} scenario_t;
+
+static const scenario_t scenarios[] = {
+    {  27,  23, 0, 1 },
+    {  27,  23, 4, 8 },
+    {  27, 247, 4, 8 },
+    { 251,  23, 0, 1 },
+    { 251,  23, 4, 8 },
+    { 251,   0, 0, 1 },
+    { 251,   0, 4, 8 },
+};
+
+typedef struct {
+    uint32_t time_us;
+    uint16_t credits;
+} pending_credits_t;
+
+static btstack_packet_handler_t l2cap_benchmark_handler;
+static const scenario_t * scenario;
+
+// simulated link
+static uint32_t now_us;
+static uint32_t ll_packets;
+static uint32_t host_completed_packets;
+
+// remote device
+static uint16_t remote_mps;
+static uint16_t remote_credits;
+static uint16_t remote_dcid;
+static uint32_t remote_sdu;
+static uint16_t remote_sdu_pos;
+static uint32_t remote_pdus;
+static uint32_t remote_credit_packets;
+static uint32_t remote_stall_us;
+static pending_credits_t pending_credits[MAX_PENDING_CREDITS];
+static int      pending_credits_head;
+static int      pending_credits_count;
+
+// local application
+static uint16_t local_cid;
+static uint8_t  receive_buffer[SDU_SIZE];
+static uint32_t received_sdus;
+
+static double now_s(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static void fail(const char * reason){
+    printf("SDU %u: %s\n", received_sdus, reason);
+    exit(1);
+}
+
+static uint8_t sdu_byte(uint32_t sdu, uint16_t pos){
+    return (uint8_t) (sdu * 3 + pos);
+}
+
+static uint32_t ll_packet_us(uint16_t octets){
+    return (octets + LL_OVERHEAD_BYTES) * LL_US_PER_BYTE + LL_IFS_US + LL_EMPTY_PDU_US + LL_IFS_US;
+}
+
+static void remote_handle_signaling(const uint8_t * command){
+    switch (command[0]){
+        case LE_CREDIT_BASED_CONNECTION_RESPONSE:
+            remote_dcid    = little_endian_read_16(command, 4);
+            remote_mps     = little_endian_read_16(command, 8);
+            remote_credits = little_endian_read_16(command, 10);
+            break;
+        case LE_FLOW_CONTROL_CREDIT:
+            if (pending_credits_count == MAX_PENDING_CREDITS) fail("too many credit packets");
+            pending_credits_t * pending = &pending_credits[(pending_credits_head + pending_credits_count) % MAX_PENDING_CREDITS];
+            pending_credits_count++;
+            pending->time_us = now_us + REMOTE_CREDIT_DELAY_US;
+            pending->credits = little_endian_read_16(command, 6);
+            remote_credit_packets++;
+            break;
+        default:
+            fail("unexpected signaling packet");
+            break;
+    }
+}
+
+// signaling packets from BTstack are small and sent in a single LL packet
+static void remote_receive_packet(uint8_t packet_type, uint8_t *packet, uint16_t size){
+    if (packet_type != HCI_ACL_DATA_PACKET) return;
+    if (little_endian_read_16(packet, 6) != L2CAP_CID_SIGNALING_LE) fail("unexpected ACL packet");
+    now_us += ll_packet_us(size - 4);
+    ll_packets++;
+    host_completed_packets++;
+    remote_handle_signaling(&packet[8]);
+}
+
+// mock controller
+
+static void controller_report_completed_packets(void){
+    while (host_completed_packets){
+        host_completed_packets--;
+        mock_controller_number_of_completed_packets(CON_HANDLE, 1);
+        mock_controller_packet_sent();
+    }
+}
+
+// send L2CAP PDU from remote, fragmented into LL packets
+static void remote_send_l2cap(uint16_t cid, const uint8_t * payload, uint16_t payload_len){
+    uint8_t pdu[4 + HCI_ACL_PAYLOAD_SIZE];
+    little_endian_store_16(pdu, 0, payload_len);
+    little_endian_store_16(pdu, 2, cid);
+    memcpy(&pdu[4], payload, payload_len);
+    uint16_t pdu_len = 4 + payload_len;
+    uint16_t pos = 0;
+    while (pos < pdu_len){
+        uint16_t fragment_len = btstack_min(pdu_len - pos, scenario->link_octets);
+        now_us += ll_packet_us(fragment_len);
+        ll_packets++;
+        uint8_t acl[4 + HCI_ACL_PAYLOAD_SIZE];
+        // first automatically flushable / continuing fragment
+        little_endian_store_16(acl, 0, CON_HANDLE | ((pos == 0 ? 0x02 : 0x01) << 12));
+        little_endian_store_16(acl, 2, fragment_len);
+        memcpy(&acl[4], &pdu[pos], fragment_len);
+        mock_controller_receive_acl(acl, 4 + fragment_len);
+        pos += fragment_len;
+    }
+}
+
+static void remote_connect(void){
+    uint8_t request[14];
+    request[0] = LE_CREDIT_BASED_CONNECTION_REQUEST;
+    request[1] = 1;
+    little_endian_store_16(request, 2, 10);
+    little_endian_store_16(request, 4, PSM);
+    little_endian_store_16(request, 6, REMOTE_CID);
+    little_endian_store_16(request, 8, SDU_SIZE);
+    little_endian_store_16(request, 10, 247);
+    little_endian_store_16(request, 12, INITIAL_CREDITS);
+    remote_send_l2cap(L2CAP_CID_SIGNALING_LE, request, sizeof(request));
+}
+
+static void remote_send_pdu(void){
+    uint8_t payload[HCI_ACL_PAYLOAD_SIZE];
+    uint16_t pos = 0;
+    if (remote_sdu_pos == 0){
+        little_endian_store_16(payload, 0, SDU_SIZE);
+        pos = 2;
+    }
+    while (pos < remote_mps && remote_sdu_pos < SDU_SIZE){
+        payload[pos++] = sdu_byte(remote_sdu, remote_sdu_pos++);
+    }
+    if (remote_sdu_pos == SDU_SIZE){
+        remote_sdu_pos = 0;
+        remote_sdu++;
+    }
+    remote_credits--;
+    remote_pdus++;
+    remote_send_l2cap(remote_dcid, payload, pos);
+}
+
+static void l2cap_packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size){
+    UNUSED(channel);
+    uint16_t i;
+    switch (packet_type){
+        case HCI_EVENT_PACKET:
+            switch (hci_event_packet_get_type(packet)){
+                case L2CAP_EVENT_LE_INCOMING_CONNECTION:
+                    local_cid = l2cap_event_le_incoming_connection_get_local_cid(packet);
+                    l2cap_le_accept_connection(local_cid, receive_buffer, sizeof(receive_buffer), INITIAL_CREDITS);
+                    l2cap_le_set_credit_policy(local_cid, scenario->watermark, scenario->batch_size);
+                    break;
+                default:
+                    break;
+            }
+            break;
+        case L2CAP_DATA_PACKET:
+            if (size != SDU_SIZE) fail("wrong SDU size");
+            for (i = 0; i < size; i++){
+                if (packet[i] != sdu_byte(received_sdus, i)) fail("data mismatch");
+            }
+            received_sdus++;
+            break;
+        default:
+            break;
+    }
+}
+
+static void benchmark(const scenario_t * the_scenario){
+    scenario = the_scenario;
+    mock_init(btstack_run_loop_posix_get_instance(), mock_transport_with_can_send_now_get_instance());
+    mock_register_packet_handler(&remote_receive_packet);
+    l2cap_init();
+    l2cap_le_set_mps(scenario->mps);
+    l2cap_benchmark_handler = &l2cap_packet_handler;
+    l2cap_le_register_service(l2cap_benchmark_handler, PSM, LEVEL_0);
+
+    mock_controller_le_read_buffer_size(scenario->link_octets, CONTROLLER_ACL_BUFFERS);
+    mock_controller_le_connection_complete(CON_HANDLE, HCI_ROLE_SLAVE, BD_ADDR_TYPE_LE_RANDOM, NULL);
+    remote_connect();
+    controller_report_completed_packets();
+    if (!remote_dcid) fail("channel not opened");
+
+    now_us = 0;
+    ll_packets = 0;
+    double start = now_s();
+    while (received_sdus < NUM_SDUS){
+        // credits arrived at remote
+        while (pending_credits_count && pending_credits[pending_credits_head].time_us <= now_us){
+            remote_credits += pending_credits[pending_credits_head].credits;
+            pending_credits_head = (pending_credits_head + 1) % MAX_PENDING_CREDITS;
+            pending_credits_count--;
+        }
+        if (remote_credits){
+            remote_send_pdu();
+            controller_report_completed_packets();
+            continue;
+        }
+        // wait for credits
+        if (!pending_credits_count) fail("stalled without credits");
+        remote_stall_us += pending_credits[pending_credits_head].time_us - now_us;
+        now_us = pending_credits[pending_credits_head].time_us;
+    }
+    double elapsed = now_s() - start;
+
+    char mps_info[20];
+    snprintf(mps_info, sizeof(mps_info), "%3u%s", remote_mps, scenario->mps ? "" : " (auto)");
+    printf("LL %3u, MPS %-10s batch %u: %5.1f kB/s, %5u PDUs, %5u LL packets, %4u credit packets, stalled %4.1f%%, host %5.2f ns/byte\n",
+        scenario->link_octets, mps_info, scenario->batch_size,
+        (double) NUM_SDUS * SDU_SIZE * 1000.0 / now_us, remote_pdus, ll_packets, remote_credit_packets,
+        remote_stall_us * 100.0 / now_us, elapsed * 1e9 / (NUM_SDUS * SDU_SIZE));
+}
+
+// stubs for Security Manager
+
+int sm_encryption_key_size(hci_con_handle_t con_handle){
+    UNUSED(con_handle);
+    return 0;
+}
+
+int sm_authenticated(hci_con_handle_t con_handle){
+    UNUSED(con_handle);
+    return 0;
+}
+
+authorization_state_t sm_authorization_state(hci_con_handle_t con_handle){
+    UNUSED(con_handle);
+    return AUTHORIZATION_UNKNOWN;
+}
+
+int main(void){
+    printf("LE Data Channel, %u SDUs of %u bytes, %u initial credits\n", NUM_SDUS, SDU_SIZE, INITIAL_CREDITS);
+    unsigned int i;
+    for (i = 0; i < sizeof(scenarios) / sizeof(scenario_t); i++){
+        // hci.c can only be initialized once per process
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid == 0){
+            benchmark(&scenarios[i]);
+            exit(0);
+        }
+        int status;
+        waitpid(pid, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status)) return 1;
+    }
+    return 0;
+}
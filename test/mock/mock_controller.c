@@ -0,0 +1,239 @@
+/*
+ * Copyright (C) 2017 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+ 
+// *****************************************************************************
+//
+// Controller Mocks: mock HCI transport and controller for hci.c, shared by the benchmarks
+//
+// *****************************************************************************
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "btstack_config.h"
+#include "btstack_memory.h"
+#include "btstack_util.h"
+#include "hci.h"
+#include "hci_cmd.h"
+#include "hci_dump.h"
+#include "mock_controller.h"
+
+static void (*hci_packet_handler)(uint8_t packet_type, uint8_t *packet, uint16_t size);
+static mock_packet_handler_t mock_packet_handler;
+
+static mock_packet_t controller_acl[MOCK_CONTROLLER_ACL_BUFFERS_MAX];
+static int           controller_acl_buffers;
+static int           controller_num_acl;
+
+void mock_fail(const char * reason){
+    printf("%s\n", reason);
+    exit(1);
+}
+
+// mock transport
+
+static int mock_transport_open(void){
+    return 0;
+}
+
+void mock_transport_register_packet_handler(void (*handler)(uint8_t packet_type, uint8_t *packet, uint16_t size)){
+    hci_packet_handler = handler;
+}
+
+static int mock_transport_can_send_packet_now(uint8_t packet_type){
+    UNUSED(packet_type);
+    return 1;
+}
+
+static int mock_transport_send_packet(uint8_t packet_type, uint8_t *packet, int size){
+    if (packet_type == HCI_ACL_DATA_PACKET && controller_acl_buffers){
+        if (controller_num_acl == controller_acl_buffers) mock_fail("controller ACL buffers exceeded");
+        memcpy(controller_acl[controller_num_acl].data, packet, size);
+        controller_acl[controller_num_acl].size = size;
+        controller_num_acl++;
+    }
+    if (mock_packet_handler){
+        (*mock_packet_handler)(packet_type, packet, size);
+    }
+    return 0;
+}
+
+static const hci_transport_t mock_transport = {
+    /* const char * name; */                                        "MOCK",
+    /* void   (*init) (const void *transport_config); */            NULL,
+    /* int    (*open)(void); */                                     &mock_transport_open,
+    /* int    (*close)(void); */                                    NULL,
+    /* void   (*register_packet_handler)(void (*handler)(...); */   &mock_transport_register_packet_handler,
+    /* int    (*can_send_packet_now)(uint8_t packet_type); */       NULL,
+    /* int    (*send_packet)(...); */                               &mock_transport_send_packet,
+    /* int    (*set_baudrate)(uint32_t baudrate); */                NULL,
+    /* void   (*reset_link)(void); */                               NULL,
+    /* void   (*set_sco_config)(uint16_t voice_setting, int num_connections); */ NULL,
+    /* int    (*send_packet_with_header)(...); */                   NULL,
+};
+
+static const hci_transport_t mock_transport_with_can_send_now = {
+    /* const char * name; */                                        "MOCK_WITH_CAN_SEND_NOW",
+    /* void   (*init) (const void *transport_config); */            NULL,
+    /* int    (*open)(void); */                                     &mock_transport_open,
+    /* int    (*close)(void); */                                    NULL,
+    /* void   (*register_packet_handler)(void (*handler)(...); */   &mock_transport_register_packet_handler,
+    /* int    (*can_send_packet_now)(uint8_t packet_type); */       &mock_transport_can_send_packet_now,
+    /* int    (*send_packet)(...); */                               &mock_transport_send_packet,
+    /* int    (*set_baudrate)(uint32_t baudrate); */                NULL,
+    /* void   (*reset_link)(void); */                               NULL,
+    /* void   (*set_sco_config)(uint16_t voice_setting, int num_connections); */ NULL,
+    /* int    (*send_packet_with_header)(...); */                   NULL,
+};
+
+const hci_transport_t * mock_transport_get_instance(void){
+    return &mock_transport;
+}
+
+const hci_transport_t * mock_transport_with_can_send_now_get_instance(void){
+    return &mock_transport_with_can_send_now;
+}
+
+void mock_register_packet_handler(mock_packet_handler_t handler){
+    mock_packet_handler = handler;
+}
+
+void mock_init(const btstack_run_loop_t * run_loop, const hci_transport_t * transport){
+    btstack_memory_init();
+    btstack_run_loop_init(run_loop);
+    hci_dump_enable_log_level(LOG_LEVEL_INFO, 0);
+    hci_dump_enable_log_level(LOG_LEVEL_ERROR, 0);
+    hci_init(transport, NULL);
+}
+
+// mock controller
+
+void mock_controller_send_event(uint8_t * event, uint16_t size){
+    hci_packet_handler(HCI_EVENT_PACKET, event, size);
+}
+
+#ifdef ENABLE_BLE
+void mock_controller_le_read_buffer_size(uint16_t acl_length, uint8_t num_packets){
+    uint8_t event[9];
+    event[0] = HCI_EVENT_COMMAND_COMPLETE;
+    event[1] = sizeof(event) - 2;
+    event[2] = 1;
+    little_endian_store_16(event, 3, hci_le_read_buffer_size.opcode);
+    event[5] = 0;
+    little_endian_store_16(event, 6, acl_length);
+    event[8] = num_packets;
+    hci_packet_handler(HCI_EVENT_PACKET, event, sizeof(event));
+}
+#endif
+
+void mock_controller_number_of_completed_packets(hci_con_handle_t con_handle, uint16_t num_packets){
+    uint8_t event[7];
+    event[0] = HCI_EVENT_NUMBER_OF_COMPLETED_PACKETS;
+    event[1] = sizeof(event) - 2;
+    event[2] = 1;
+    little_endian_store_16(event, 3, con_handle);
+    little_endian_store_16(event, 5, num_packets);
+    hci_packet_handler(HCI_EVENT_PACKET, event, sizeof(event));
+}
+
+void mock_controller_packet_sent(void){
+    uint8_t event[] = { HCI_EVENT_TRANSPORT_PACKET_SENT, 0};
+    hci_packet_handler(HCI_EVENT_PACKET, event, sizeof(event));
+}
+
+void mock_controller_le_connection_complete(hci_con_handle_t con_handle, uint8_t role, bd_addr_type_t address_type, const bd_addr_t address){
+    uint8_t event[21];
+    memset(event, 0, sizeof(event));
+    event[0] = HCI_EVENT_LE_META;
+    event[1] = sizeof(event) - 2;
+    event[2] = HCI_SUBEVENT_LE_CONNECTION_COMPLETE;
+    event[3] = 0;
+    little_endian_store_16(event, 4, con_handle);
+    event[6] = role;
+    event[7] = address_type;
+    if (address){
+        reverse_bd_addr(address, &event[8]);
+    } else {
+        little_endian_store_16(event, 8, con_handle);
+    }
+    hci_packet_handler(HCI_EVENT_PACKET, event, sizeof(event));
+}
+
+void mock_controller_disconnection_complete(hci_con_handle_t con_handle){
+    uint8_t event[6];
+    event[0] = HCI_EVENT_DISCONNECTION_COMPLETE;
+    event[1] = sizeof(event) - 2;
+    event[2] = 0;
+    little_endian_store_16(event, 3, con_handle);
+    event[5] = 0x13;
+    hci_packet_handler(HCI_EVENT_PACKET, event, sizeof(event));
+}
+
+void mock_controller_encryption_change(hci_con_handle_t con_handle){
+    uint8_t event[6];
+    event[0] = HCI_EVENT_ENCRYPTION_CHANGE;
+    event[1] = sizeof(event) - 2;
+    event[2] = 0;
+    little_endian_store_16(event, 3, con_handle);
+    event[5] = 1;
+    hci_packet_handler(HCI_EVENT_PACKET, event, sizeof(event));
+}
+
+void mock_controller_receive_acl(uint8_t * packet, uint16_t size){
+    hci_packet_handler(HCI_ACL_DATA_PACKET, packet, size);
+}
+
+void mock_controller_set_acl_buffers(int num_buffers){
+    if (num_buffers > MOCK_CONTROLLER_ACL_BUFFERS_MAX) mock_fail("too many controller ACL buffers");
+    controller_acl_buffers = num_buffers;
+    controller_num_acl = 0;
+}
+
+int mock_controller_num_acl(void){
+    return controller_num_acl;
+}
+
+const mock_packet_t * mock_controller_acl(int index){
+    return &controller_acl[index];
+}
+
+void mock_controller_acl_remove(int num_packets){
+    controller_num_acl -= num_packets;
+    memmove(&controller_acl[0], &controller_acl[num_packets], controller_num_acl * sizeof(mock_packet_t));
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2017 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+ 
+// *****************************************************************************
+//
+// Controller Mocks: mock HCI transport and controller for hci.c, shared by the benchmarks
+//
+// *****************************************************************************
+
+#ifndef __MOCK_CONTROLLER_H
+#define __MOCK_CONTROLLER_H
+
+#include <stdint.h>
+
+#include "btstack_config.h"
+#include "bluetooth.h"
+#include "btstack_run_loop.h"
+#include "hci_transport.h"
+
+#define MOCK_CONTROLLER_ACL_BUFFERS_MAX 16
+
+typedef struct {
+    uint8_t  data[4 + HCI_ACL_PAYLOAD_SIZE];
+    uint16_t size;
+} mock_packet_t;
+
+// exit with reason
+void mock_fail(const char * reason);
+
+// packets sent by BTstack are passed to the registered handler or dropped
+typedef void (*mock_packet_handler_t)(uint8_t packet_type, uint8_t * packet, uint16_t size);
+void mock_register_packet_handler(mock_packet_handler_t handler);
+
+// synchronous transport: packet buffer is free when send_packet returns
+const hci_transport_t * mock_transport_get_instance(void);
+
+// asynchronous transport: packet buffer is free after mock_controller_packet_sent
+const hci_transport_t * mock_transport_with_can_send_now_get_instance(void);
+
+// for transports of a single benchmark: events and ACL from the mock controller are delivered to the given handler
+void mock_transport_register_packet_handler(void (*handler)(uint8_t packet_type, uint8_t *packet, uint16_t size));
+
+// init memory, run loop and hci.c with given transport
+void mock_init(const btstack_run_loop_t * run_loop, const hci_transport_t * transport);
+
+// controller events
+void mock_controller_send_event(uint8_t * event, uint16_t size);
+#ifdef ENABLE_BLE
+void mock_controller_le_read_buffer_size(uint16_t acl_length, uint8_t num_packets);
+#endif
+void mock_controller_number_of_completed_packets(hci_con_handle_t con_handle, uint16_t num_packets);
+void mock_controller_packet_sent(void);
+// address NULL: unique address for each connection handle
+void mock_controller_le_connection_complete(hci_con_handle_t con_handle, uint8_t role, bd_addr_type_t address_type, const bd_addr_t address);
+void mock_controller_disconnection_complete(hci_con_handle_t con_handle);
+void mock_controller_encryption_change(hci_con_handle_t con_handle);
+
+// ACL packet from remote
+void mock_controller_receive_acl(uint8_t * packet, uint16_t size);
+
+// ACL packets sent by BTstack are stored in up to num_buffers controller buffers, 0 = not stored
+void mock_controller_set_acl_buffers(int num_buffers);
+int  mock_controller_num_acl(void);
+// oldest first
+const mock_packet_t * mock_controller_acl(int index);
+void mock_controller_acl_remove(int num_packets);
+
+#endif
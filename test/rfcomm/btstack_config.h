@@ -0,0 +1,22 @@
+//
+// btstack_config.h for RFCOMM benchmarks
+//
+
+#ifndef __BTSTACK_CONFIG
+#define __BTSTACK_CONFIG
+
+// Port related features
+#define HAVE_EMBEDDED_TIME_MS
+#define HAVE_MALLOC
+
+// BTstack features that can be enabled
+#define ENABLE_CLASSIC
+#define ENABLE_RFCOMM_ADAPTIVE_CREDITS
+#define ENABLE_RFCOMM_SCHEDULER_STATS
+#define ENABLE_LOG_ERROR
+
+// BTstack configuration. buffers, sizes, ...
+#define HCI_ACL_PAYLOAD_SIZE 1021
+#define HCI_INCOMING_PRE_BUFFER_SIZE 4
+
+#endif
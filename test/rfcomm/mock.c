@@ -0,0 +1,645 @@
+/*
+ * Copyright (C) 2017 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+ 
+// *****************************************************************************
+//
+// RFCOMM Mocks: mock transport and controller for hci.c, l2cap.c and rfcomm.c
+// and a simulated remote device that acts as RFCOMM initiator
+//
+// *****************************************************************************
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "btstack_config.h"
+#include "bluetooth_sdp.h"
+#include "btstack_memory.h"
+#include "btstack_run_loop.h"
+#include "btstack_run_loop_embedded.h"
+#include "btstack_util.h"
+#include "hal_cpu.h"
+#include "hal_time_ms.h"
+#include "hci.h"
+#include "hci_cmd.h"
+#include "hci_dump.h"
+#include "hci_transport.h"
+#include "l2cap.h"
+#include "l2cap_signaling.h"
+#include "mock.h"
+
+#define CON_HANDLE                  0x0001
+#define REMOTE_CID                  0x0041
+#define REMOTE_L2CAP_MTU            (HCI_ACL_PAYLOAD_SIZE - 4)
+#define REMOTE_ACL_BUFFERS          16
+#define CONTROLLER_EVENTS           8
+#define MAX_SETUP_ROUNDS            1000
+
+typedef struct {
+    uint8_t  data[HCI_ACL_PAYLOAD_SIZE + 4];
+    uint16_t size;
+    uint32_t queued_ms;
+} mock_packet_t;
+
+typedef struct {
+    mock_packet_t packets[REMOTE_ACL_BUFFERS];
+    int           capacity;
+    int           head;
+    int           count;
+} mock_queue_t;
+
+typedef struct {
+    uint8_t  dlci;
+    uint8_t  ua_received;
+    uint8_t  msc_cmd_received;
+    uint8_t  msc_rsp_received;
+    uint16_t max_frame_size;
+    // credits granted by BTstack, allow remote to send
+    uint16_t credits_outgoing;
+    // credits granted to BTstack
+    uint16_t credits_incoming;
+} remote_dlc_t;
+
+static void (*hci_packet_handler)(uint8_t packet_type, uint8_t *packet, uint16_t size);
+static mock_remote_data_handler_t remote_data_handler;
+
+static uint32_t virtual_time_ms;
+static uint32_t link_latency_ms;
+static uint32_t air_time_us;
+static uint32_t link_idle_ms;
+
+static mock_packet_t controller_events[CONTROLLER_EVENTS];
+static int           controller_num_events;
+static mock_queue_t  controller_acl;
+static mock_queue_t  remote_acl;
+
+static uint8_t      remote_sig_id;
+static uint16_t     remote_l2cap_local_cid;
+static int          remote_l2cap_config_done;
+static int          remote_multiplexer_open;
+static remote_dlc_t remote_dlcs[MOCK_MAX_DLCIS];
+static int          remote_num_dlcs;
+
+void mock_fail(const char * reason){
+    printf("%s\n", reason);
+    exit(1);
+}
+
+// embedded run loop with virtual time
+
+uint32_t hal_time_ms(void){
+    return virtual_time_ms;
+}
+
+void hal_cpu_disable_irqs(void){
+}
+
+void hal_cpu_enable_irqs(void){
+}
+
+void hal_cpu_enable_irqs_and_sleep(void){
+}
+
+uint32_t mock_time_ms(void){
+    return virtual_time_ms;
+}
+
+uint32_t mock_link_idle_ms(void){
+    return link_idle_ms;
+}
+
+void mock_set_link_latency(uint32_t latency_ms){
+    link_latency_ms = latency_ms;
+}
+
+// ACL packet queues
+
+static mock_packet_t * queue_push(mock_queue_t * queue){
+    if (queue->count == queue->capacity) mock_fail("ACL buffers exceeded");
+    mock_packet_t * packet = &queue->packets[(queue->head + queue->count) % queue->capacity];
+    packet->queued_ms = virtual_time_ms;
+    queue->count++;
+    return packet;
+}
+
+// packets can be sent after link latency
+static mock_packet_t * queue_front(mock_queue_t * queue){
+    if (queue->count == 0) return NULL;
+    mock_packet_t * packet = &queue->packets[queue->head];
+    if (virtual_time_ms - packet->queued_ms < link_latency_ms) return NULL;
+    return packet;
+}
+
+static void queue_pop(mock_queue_t * queue){
+    queue->head = (queue->head + 1) % queue->capacity;
+    queue->count--;
+}
+
+// 3-DH1, 3-DH3 or 3-DH5 packet, or 1 slot for POLL/NULL
+static uint32_t air_time_for_packet(const mock_packet_t * packet){
+    if (!packet) return 625;
+    uint16_t acl_len = packet->size - 4;
+    if (acl_len <= 83)  return 625;
+    if (acl_len <= 552) return 1875;
+    return 3125;
+}
+
+// mock transport
+
+static void mock_register_packet_handler(void (*handler)(uint8_t packet_type, uint8_t *packet, uint16_t size)){
+    hci_packet_handler = handler;
+}
+
+static int mock_open(void){
+    return 0;
+}
+
+static void controller_queue_command_complete(const uint8_t * command){
+    if (controller_num_events == CONTROLLER_EVENTS) mock_fail("controller event queue full");
+    mock_packet_t * event = &controller_events[controller_num_events++];
+    memset(event->data, 0, sizeof(event->data));
+    uint16_t opcode = little_endian_read_16(command, 0);
+    event->data[0] = HCI_EVENT_COMMAND_COMPLETE;
+    event->data[2] = 1;
+    little_endian_store_16(event->data, 3, opcode);
+    event->data[5] = ERROR_CODE_SUCCESS;
+    if (opcode == hci_read_local_supported_commands.opcode){
+        // Read Buffer Size supported
+        event->data[6 + 14] = 0x80;
+    }
+    if (opcode == hci_read_buffer_size.opcode){
+        little_endian_store_16(event->data, 6, HCI_ACL_PAYLOAD_SIZE);
+        little_endian_store_16(event->data, 9, MOCK_CONTROLLER_ACL_BUFFERS);
+    }
+    // room for 64 octets of supported commands
+    event->data[1] = 4 + 64;
+    event->size    = 2 + 4 + 64;
+}
+
+static int mock_send_packet(uint8_t packet_type, uint8_t *packet, int size){
+    switch (packet_type){
+        case HCI_COMMAND_DATA_PACKET:
+            controller_queue_command_complete(packet);
+            break;
+        case HCI_ACL_DATA_PACKET: {
+            mock_packet_t * acl = queue_push(&controller_acl);
+            memcpy(acl->data, packet, size);
+            acl->size = size;
+            break;
+        }
+        default:
+            break;
+    }
+    return 0;
+}
+
+static const hci_transport_t mock_transport = {
+    /* const char * name; */                                        "MOCK",
+    /* void   (*init) (const void *transport_config); */            NULL,
+    /* int    (*open)(void); */                                     &mock_open,
+    /* int    (*close)(void); */                                    NULL,
+    /* void   (*register_packet_handler)(void (*handler)(...); */   &mock_register_packet_handler,
+    /* int    (*can_send_packet_now)(uint8_t packet_type); */       NULL,
+    /* int    (*send_packet)(...); */                               &mock_send_packet,
+    /* int    (*set_baudrate)(uint32_t baudrate); */                NULL,
+    /* void   (*reset_link)(void); */                               NULL,
+    /* void   (*set_sco_config)(uint16_t voice_setting, int num_connections); */ NULL,
+    /* int    (*send_packet_with_header)(...); */                   NULL,
+};
+
+// mock controller
+
+static void controller_process_events(void){
+    int i;
+    // events might trigger new commands
+    while (controller_num_events){
+        mock_packet_t events[CONTROLLER_EVENTS];
+        int num_events = controller_num_events;
+        memcpy(events, controller_events, num_events * sizeof(mock_packet_t));
+        controller_num_events = 0;
+        for (i = 0; i < num_events; i++){
+            hci_packet_handler(HCI_EVENT_PACKET, events[i].data, events[i].size);
+        }
+    }
+}
+
+static void controller_report_completed_packets(int num_packets){
+    uint8_t event[7];
+    event[0] = HCI_EVENT_NUMBER_OF_COMPLETED_PACKETS;
+    event[1] = sizeof(event) - 2;
+    event[2] = 1;
+    little_endian_store_16(event, 3, CON_HANDLE);
+    little_endian_store_16(event, 5, num_packets);
+    hci_packet_handler(HCI_EVENT_PACKET, event, sizeof(event));
+}
+
+static void controller_connect(void){
+    uint8_t event[13];
+    bd_addr_t address = { 0x00, 0x1b, 0xdc, 0x07, 0x32, 0xef };
+    // incoming connection
+    event[0] = HCI_EVENT_CONNECTION_REQUEST;
+    event[1] = 10;
+    reverse_bd_addr(address, &event[2]);
+    memset(&event[8], 0, 3);
+    event[11] = 1;
+    hci_packet_handler(HCI_EVENT_PACKET, event, 12);
+    controller_process_events();
+    // connection complete
+    event[0] = HCI_EVENT_CONNECTION_COMPLETE;
+    event[1] = sizeof(event) - 2;
+    event[2] = 0;
+    little_endian_store_16(event, 3, CON_HANDLE);
+    reverse_bd_addr(address, &event[5]);
+    event[11] = 1;
+    event[12] = 0;
+    hci_packet_handler(HCI_EVENT_PACKET, event, sizeof(event));
+    controller_process_events();
+}
+
+// simulated remote device: L2CAP
+
+static uint8_t * remote_prepare_acl(uint16_t cid, uint16_t payload_len){
+    mock_packet_t * packet = queue_push(&remote_acl);
+    little_endian_store_16(packet->data, 0, CON_HANDLE | (0x02 << 12));
+    little_endian_store_16(packet->data, 2, 4 + payload_len);
+    little_endian_store_16(packet->data, 4, payload_len);
+    little_endian_store_16(packet->data, 6, cid);
+    packet->size = 8 + payload_len;
+    return &packet->data[8];
+}
+
+// responses use identifier of request
+static void remote_send_signaling(uint8_t code, uint8_t sig_id, const uint8_t * data, uint16_t len){
+    uint8_t * command = remote_prepare_acl(L2CAP_CID_SIGNALING, 4 + len);
+    command[0] = code;
+    command[1] = sig_id;
+    little_endian_store_16(command, 2, len);
+    memcpy(&command[4], data, len);
+}
+
+static void remote_receive_signaling(const uint8_t * command){
+    uint8_t response[8];
+    switch (command[0]){
+        case INFORMATION_REQUEST:
+            // no extended features
+            little_endian_store_16(response, 0, little_endian_read_16(command, 4));
+            little_endian_store_16(response, 2, 0);
+            little_endian_store_32(response, 4, 0);
+            remote_send_signaling(INFORMATION_RESPONSE, command[1], response, 8);
+            break;
+        case CONNECTION_RESPONSE:
+            if (little_endian_read_16(command, 8) != 0) break;
+            remote_l2cap_local_cid = little_endian_read_16(command, 4);
+            little_endian_store_16(response, 0, remote_l2cap_local_cid);
+            little_endian_store_16(response, 2, 0);
+            response[4] = L2CAP_CONFIG_OPTION_TYPE_MAX_TRANSMISSION_UNIT;
+            response[5] = 2;
+            little_endian_store_16(response, 6, REMOTE_L2CAP_MTU);
+            remote_send_signaling(CONFIGURE_REQUEST, ++remote_sig_id, response, 8);
+            break;
+        case CONFIGURE_REQUEST:
+            little_endian_store_16(response, 0, remote_l2cap_local_cid);
+            little_endian_store_16(response, 2, 0);
+            little_endian_store_16(response, 4, 0);
+            remote_send_signaling(CONFIGURE_RESPONSE, command[1], response, 6);
+            remote_l2cap_config_done |= 1;
+            break;
+        case CONFIGURE_RESPONSE:
+            remote_l2cap_config_done |= 2;
+            break;
+        default:
+            break;
+    }
+}
+
+// simulated remote device: RFCOMM initiator
+
+static remote_dlc_t * remote_dlc_for_dlci(uint8_t dlci){
+    int i;
+    for (i = 0; i < remote_num_dlcs; i++){
+        if (remote_dlcs[i].dlci == dlci) return &remote_dlcs[i];
+    }
+    return NULL;
+}
+
+// DLCI of server channel on responder side
+static remote_dlc_t * remote_dlc_for_server_channel(uint8_t server_channel){
+    remote_dlc_t * dlc = remote_dlc_for_dlci(server_channel << 1);
+    if (!dlc) mock_fail("unknown server channel");
+    return dlc;
+}
+
+// frames sent by initiator have C/R = 1
+static void remote_send_frame(uint8_t dlci, uint8_t control, uint8_t credits, const uint8_t * data, uint16_t len){
+    uint16_t header_len = (len < 128 ? 3 : 4) + (control == BT_RFCOMM_UIH_PF ? 1 : 0);
+    uint8_t * frame = remote_prepare_acl(remote_l2cap_local_cid, header_len + len + 1);
+    uint16_t pos = 0;
+    frame[pos++] = (dlci << 2) | (1 << 1) | 1;
+    frame[pos++] = control;
+    if (len < 128){
+        frame[pos++] = (len << 1) | 1;
+    } else {
+        frame[pos++] = (len & 0x7f) << 1;
+        frame[pos++] = len >> 7;
+    }
+    if (control == BT_RFCOMM_UIH_PF){
+        frame[pos++] = credits;
+    }
+    memcpy(&frame[pos], data, len);
+    pos += len;
+    // UIH frames only calc FCS over address + control
+    frame[pos] = btstack_crc8_calc(frame, ((control & 0xef) == BT_RFCOMM_UIH) ? 2 : 3);
+}
+
+static void remote_send_multiplexer_command(uint8_t type, const uint8_t * data, uint8_t len){
+    uint8_t payload[12];
+    payload[0] = type;
+    payload[1] = (len << 1) | 1;
+    memcpy(&payload[2], data, len);
+    remote_send_frame(0, BT_RFCOMM_UIH, 0, payload, 2 + len);
+}
+
+static void remote_send_msc(uint8_t type, uint8_t dlci){
+    uint8_t msc[2];
+    msc[0] = (dlci << 2) | (1 << 1) | 1;
+    msc[1] = 0x8d;  // ea=1,fc=0,rtc=1,rtr=1,ic=0,dv=1
+    remote_send_multiplexer_command(type, msc, sizeof(msc));
+}
+
+static void remote_receive_multiplexer_command(const uint8_t * payload, uint16_t len){
+    if (len < 3) return;
+    remote_dlc_t * dlc;
+    switch (payload[0]){
+        case BT_RFCOMM_PN_RSP:
+            dlc = remote_dlc_for_dlci(payload[2]);
+            if (!dlc) mock_fail("PN RSP for unknown DLCI");
+            dlc->max_frame_size = btstack_min(dlc->max_frame_size, little_endian_read_16(payload, 6));
+            break;
+        case BT_RFCOMM_MSC_CMD:
+            dlc = remote_dlc_for_dlci(payload[2] >> 2);
+            if (!dlc) mock_fail("MSC CMD for unknown DLCI");
+            dlc->msc_cmd_received = 1;
+            remote_send_msc(BT_RFCOMM_MSC_RSP, dlc->dlci);
+            break;
+        case BT_RFCOMM_MSC_RSP:
+            dlc = remote_dlc_for_dlci(payload[2] >> 2);
+            if (!dlc) mock_fail("MSC RSP for unknown DLCI");
+            dlc->msc_rsp_received = 1;
+            break;
+        default:
+            break;
+    }
+}
+
+static void remote_receive_frame(const uint8_t * frame, uint16_t size){
+    uint8_t  dlci    = frame[0] >> 2;
+    uint8_t  control = frame[1];
+    uint16_t pos;
+    uint16_t len;
+    if (frame[2] & 1){
+        len = frame[2] >> 1;
+        pos = 3;
+    } else {
+        len = (frame[2] >> 1) | (frame[3] << 7);
+        pos = 4;
+    }
+    uint8_t credits = 0;
+    if (control == BT_RFCOMM_UIH_PF){
+        credits = frame[pos++];
+    }
+    if (pos + len + 1 != size) mock_fail("RFCOMM length mismatch");
+    uint8_t fcs_len = ((control & 0xef) == BT_RFCOMM_UIH) ? 2 : 3;
+    if (btstack_crc8_calc((uint8_t *) frame, fcs_len) != frame[pos + len]) mock_fail("RFCOMM FCS mismatch");
+
+    if (dlci == 0){
+        switch (control){
+            case BT_RFCOMM_UA:
+                remote_multiplexer_open = 1;
+                break;
+            case BT_RFCOMM_UIH:
+                remote_receive_multiplexer_command(&frame[pos], len);
+                break;
+            default:
+                mock_fail("unexpected frame on DLCI 0");
+                break;
+        }
+        return;
+    }
+
+    remote_dlc_t * dlc = remote_dlc_for_dlci(dlci);
+    if (!dlc) mock_fail("frame for unknown DLCI");
+    switch (control){
+        case BT_RFCOMM_UA:
+            dlc->ua_received = 1;
+            remote_send_msc(BT_RFCOMM_MSC_CMD, dlci);
+            break;
+        case BT_RFCOMM_UIH_PF:
+            dlc->credits_outgoing += credits;
+            /* fall through */
+        case BT_RFCOMM_UIH:
+            if (len == 0) break;
+            if (dlc->credits_incoming == 0) mock_fail("data frame without credits");
+            if (len > dlc->max_frame_size) mock_fail("data frame exceeds max frame size");
+            dlc->credits_incoming--;
+            if (remote_data_handler){
+                (*remote_data_handler)(dlci, &frame[pos], len);
+            }
+            break;
+        default:
+            mock_fail("unexpected frame on DLC");
+            break;
+    }
+}
+
+static void remote_receive_acl(const uint8_t * packet, uint16_t size){
+    uint16_t cid = little_endian_read_16(packet, 6);
+    uint16_t len = little_endian_read_16(packet, 4);
+    if (size != 8 + len) mock_fail("fragmented ACL packet");
+    if (cid == L2CAP_CID_SIGNALING){
+        remote_receive_signaling(&packet[8]);
+    } else if (cid == REMOTE_CID){
+        remote_receive_frame(&packet[8], len);
+    } else {
+        mock_fail("unexpected cid");
+    }
+}
+
+// link
+
+static void link_deliver_to_remote(int * num_completed){
+    mock_packet_t * packet = queue_front(&controller_acl);
+    remote_receive_acl(packet->data, packet->size);
+    queue_pop(&controller_acl);
+    (*num_completed)++;
+}
+
+// BTstack only queues packets towards the controller, so the packet stays valid
+static void link_deliver_to_controller(void){
+    mock_packet_t * packet = queue_front(&remote_acl);
+    hci_packet_handler(HCI_ACL_DATA_PACKET, packet->data, packet->size);
+    queue_pop(&remote_acl);
+}
+
+void mock_link_round(void){
+    int num_completed = 0;
+    air_time_us += 1000;
+    while (1){
+        mock_packet_t * from_controller = queue_front(&controller_acl);
+        mock_packet_t * from_remote     = queue_front(&remote_acl);
+        if (!from_controller && !from_remote){
+            // idle air time cannot be used later
+            if (air_time_us >= 1000){
+                link_idle_ms++;
+            }
+            air_time_us = 0;
+            break;
+        }
+        // each packet is answered in the following slot(s) by a packet from the other side or a NULL packet
+        uint32_t air_time = air_time_for_packet(from_controller) + air_time_for_packet(from_remote);
+        if (air_time_us < air_time) break;
+        air_time_us -= air_time;
+        if (from_controller){
+            link_deliver_to_remote(&num_completed);
+        }
+        if (from_remote){
+            link_deliver_to_controller();
+        }
+    }
+    if (num_completed){
+        controller_report_completed_packets(num_completed);
+    }
+    controller_process_events();
+
+    virtual_time_ms++;
+    btstack_run_loop_embedded_execute_once();
+}
+
+// mock api
+
+void mock_init(void){
+    controller_acl.capacity = MOCK_CONTROLLER_ACL_BUFFERS;
+    remote_acl.capacity     = REMOTE_ACL_BUFFERS;
+
+    btstack_memory_init();
+    btstack_run_loop_init(btstack_run_loop_embedded_get_instance());
+    hci_dump_enable_log_level(LOG_LEVEL_ERROR, 0);
+    hci_init(&mock_transport, NULL);
+
+    // init sequence might wait for timers
+    hci_power_control(HCI_POWER_ON);
+    int i;
+    for (i = 0; i < MAX_SETUP_ROUNDS && hci_get_state() != HCI_STATE_WORKING; i++){
+        controller_process_events();
+        virtual_time_ms++;
+        btstack_run_loop_embedded_execute_once();
+    }
+    if (hci_get_state() != HCI_STATE_WORKING) mock_fail("power on failed");
+}
+
+void mock_connect(void){
+    controller_connect();
+
+    uint8_t request[4];
+    little_endian_store_16(request, 0, BLUETOOTH_PROTOCOL_RFCOMM);
+    little_endian_store_16(request, 2, REMOTE_CID);
+    remote_send_signaling(CONNECTION_REQUEST, ++remote_sig_id, request, sizeof(request));
+    int i;
+    for (i = 0; i < MAX_SETUP_ROUNDS && remote_l2cap_config_done != 3; i++){
+        mock_link_round();
+    }
+    if (remote_l2cap_config_done != 3) mock_fail("L2CAP channel not opened");
+
+    remote_send_frame(0, BT_RFCOMM_SABM, 0, NULL, 0);
+    for (i = 0; i < MAX_SETUP_ROUNDS && !remote_multiplexer_open; i++){
+        mock_link_round();
+    }
+    if (!remote_multiplexer_open) mock_fail("multiplexer not opened");
+}
+
+void mock_open_dlc(uint8_t server_channel, uint16_t max_frame_size, uint8_t initial_credits){
+    if (remote_num_dlcs == MOCK_MAX_DLCIS) mock_fail("too many DLCs");
+    remote_dlc_t * dlc = &remote_dlcs[remote_num_dlcs++];
+    memset(dlc, 0, sizeof(remote_dlc_t));
+    dlc->dlci             = server_channel << 1;
+    dlc->max_frame_size   = max_frame_size;
+    dlc->credits_incoming = initial_credits;
+
+    uint8_t pn[8];
+    pn[0] = dlc->dlci;
+    pn[1] = 0xf0;   // credit based flow control
+    pn[2] = 0;      // priority
+    pn[3] = 0;      // timer
+    little_endian_store_16(pn, 4, max_frame_size);
+    pn[6] = 0;      // retransmissions
+    pn[7] = initial_credits;
+    remote_send_multiplexer_command(BT_RFCOMM_PN_CMD, pn, sizeof(pn));
+    remote_send_frame(dlc->dlci, BT_RFCOMM_SABM, 0, NULL, 0);
+
+    int i;
+    for (i = 0; i < MAX_SETUP_ROUNDS && !(dlc->ua_received && dlc->msc_cmd_received && dlc->msc_rsp_received); i++){
+        mock_link_round();
+    }
+    if (!dlc->ua_received || !dlc->msc_cmd_received || !dlc->msc_rsp_received) mock_fail("DLC not opened");
+}
+
+void mock_register_remote_data_handler(mock_remote_data_handler_t handler){
+    remote_data_handler = handler;
+}
+
+void mock_remote_grant_credits(uint8_t server_channel, uint8_t credits){
+    remote_dlc_t * dlc = remote_dlc_for_server_channel(server_channel);
+    dlc->credits_incoming += credits;
+    remote_send_frame(dlc->dlci, BT_RFCOMM_UIH_PF, credits, NULL, 0);
+}
+
+int mock_remote_can_send(uint8_t server_channel){
+    remote_dlc_t * dlc = remote_dlc_for_server_channel(server_channel);
+    return dlc->credits_outgoing > 0 && remote_acl.count < MOCK_CONTROLLER_ACL_BUFFERS;
+}
+
+void mock_remote_send_data(uint8_t server_channel, const uint8_t * data, uint16_t len){
+    remote_dlc_t * dlc = remote_dlc_for_server_channel(server_channel);
+    if (dlc->credits_outgoing == 0) mock_fail("remote has no credits");
+    if (len > dlc->max_frame_size) mock_fail("remote data exceeds max frame size");
+    dlc->credits_outgoing--;
+    remote_send_frame(dlc->dlci, BT_RFCOMM_UIH, 0, data, len);
+}
+
+uint16_t mock_remote_outgoing_credits(uint8_t server_channel){
+    return remote_dlc_for_server_channel(server_channel)->credits_outgoing;
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2017 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+ 
+// *****************************************************************************
+//
+// RFCOMM Mocks: mock transport and controller for hci.c, l2cap.c and rfcomm.c
+// and a simulated remote device that acts as RFCOMM initiator
+//
+// *****************************************************************************
+
+#ifndef __RFCOMM_MOCK_H
+#define __RFCOMM_MOCK_H
+
+#include <stdint.h>
+
+// Time is virtual: each link round advances the clock by 1 ms. Each 3-DH1/3-DH3/3-DH5 packet
+// is answered by a packet from the other side or a NULL packet, so both sides share the air time.
+#define MOCK_CONTROLLER_ACL_BUFFERS 8
+#define MOCK_MAX_DLCIS              16
+
+// called for each data frame received by the remote
+typedef void (*mock_remote_data_handler_t)(uint8_t dlci, const uint8_t * data, uint16_t len);
+
+// power on stack, create ACL connection and open RFCOMM multiplexer as initiator
+void mock_init(void);
+void mock_connect(void);
+
+// open DLC for server channel as initiator, the local application has to accept it
+void mock_open_dlc(uint8_t server_channel, uint16_t max_frame_size, uint8_t initial_credits);
+
+// remote data path
+void     mock_register_remote_data_handler(mock_remote_data_handler_t handler);
+void     mock_remote_grant_credits(uint8_t server_channel, uint8_t credits);
+int      mock_remote_can_send(uint8_t server_channel);
+void     mock_remote_send_data(uint8_t server_channel, const uint8_t * data, uint16_t len);
+uint16_t mock_remote_outgoing_credits(uint8_t server_channel);
+
+// deliver packets for 1 ms of air time and run timers
+void     mock_link_round(void);
+uint32_t mock_time_ms(void);
+
+// rounds without any packet sent over the air
+uint32_t mock_link_idle_ms(void);
+
+// delay packets in both directions by latency before they are sent over the air
+void     mock_set_link_latency(uint32_t latency_ms);
+
+void mock_fail(const char * reason);
+
+#endif
@@ -0,0 +1,290 @@
+/*
+ * Copyright (C) 2017 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+ 
+/*
+ *  rfcomm_at_latency_benchmark.c
+ *
+ *  An RFCOMM server in BTstack streams SPP data as fast as possible, like example/spp_streamer.c,
+ *  while a second DLC on the same multiplexer sends a short AT command every AT_INTERVAL_MS, like
+ *  the HFP service level connection. Both DLCs are opened by a simulated remote device with a
+ *  mock transport and controller.
+ *
+ *  The AT command latency is measured in virtual time from rfcomm_request_can_send_now_event
+ *  until the command is received by the remote. Each run uses new DLCs:
+ *  - AT DLC created before or after the SPP DLC, which changes their order in the channel list
+ *  - AT DLC with default priority or with higher priority set by rfcomm_set_channel_priority
+ *  - AT DLC first sends a burst of unsolicited result frames without can send now, like hfp.c does,
+ *    which must not delay the AT commands that wait for can send now afterwards
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "btstack_config.h"
+#include "btstack_event.h"
+#include "btstack_util.h"
+#include "classic/rfcomm.h"
+#include "l2cap.h"
+#include "mock.h"
+
+#define SPP_FRAME_SIZE          1000
+#define SPP_INITIAL_CREDITS     32
+#define SPP_CREDIT_BATCH        8
+#define AT_FRAME_SIZE           127
+#define AT_INITIAL_CREDITS      4
+#define AT_INTERVAL_MS          37
+#define RUN_MS                  5000
+#define MAX_AT_COMMANDS         (RUN_MS / AT_INTERVAL_MS + 1)
+#define AT_MAX_LATENCY_MS       100
+#define NUM_RUNS                4
+#define UNSOLICITED_MS          1000
+
+static const char at_command[] = "AT+CLCC\r";
+
+typedef struct {
+    const char * name;
+    int at_first;
+    int at_priority;
+    int at_unsolicited;
+} run_config_t;
+
+static const run_config_t runs[NUM_RUNS] = {
+    { "AT before SPP, same priority", 1, 0, 0 },
+    { "AT after SPP, same priority ", 0, 0, 0 },
+    { "AT before SPP, AT priority 1", 1, 1, 0 },
+    { "AT with unsolicited frames  ", 1, 0, 1 },
+};
+
+static uint8_t  spp_server_channel;
+static uint8_t  at_server_channel;
+static uint16_t spp_cid;
+static uint16_t at_cid;
+static uint8_t  spp_data[SPP_FRAME_SIZE];
+static uint8_t  at_unsolicited_data[AT_FRAME_SIZE];
+static int      spp_active;
+static uint32_t spp_frames_sent;
+static uint32_t spp_frames_received;
+static uint8_t  spp_credits_to_return;
+
+static uint32_t at_request_ms[MAX_AT_COMMANDS];
+static uint32_t at_requested;
+static uint32_t at_sent;
+static uint32_t at_received;
+static uint32_t at_latency_sum_ms;
+static uint32_t at_latency_max_ms;
+static uint32_t at_unsolicited_sent;
+
+static void spp_send_packet(void){
+    if (!spp_active) return;
+    if (rfcomm_send(spp_cid, spp_data, SPP_FRAME_SIZE)) mock_fail("spp send failed");
+    spp_frames_sent++;
+    rfcomm_request_can_send_now_event(spp_cid);
+}
+
+static void at_send_command(void){
+    if (at_sent == at_requested) return;
+    if (rfcomm_send(at_cid, (uint8_t *) at_command, sizeof(at_command) - 1)) mock_fail("at send failed");
+    at_sent++;
+    if (at_sent < at_requested){
+        rfcomm_request_can_send_now_event(at_cid);
+    }
+}
+
+// send without can send now
+static void at_send_unsolicited(void){
+    while (rfcomm_can_send_packet_now(at_cid)){
+        if (rfcomm_send(at_cid, at_unsolicited_data, AT_FRAME_SIZE)) mock_fail("at unsolicited send failed");
+        at_unsolicited_sent++;
+    }
+}
+
+static void at_request_command(void){
+    if (at_requested == MAX_AT_COMMANDS) mock_fail("too many AT commands");
+    at_request_ms[at_requested++] = mock_time_ms();
+    if (at_requested - at_sent == 1){
+        rfcomm_request_can_send_now_event(at_cid);
+    }
+}
+
+static void packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size){
+    UNUSED(channel);
+    UNUSED(size);
+    uint16_t cid;
+    uint8_t  server_channel;
+    if (packet_type != HCI_EVENT_PACKET) return;
+    switch (hci_event_packet_get_type(packet)){
+        case RFCOMM_EVENT_INCOMING_CONNECTION:
+            rfcomm_accept_connection(rfcomm_event_incoming_connection_get_rfcomm_cid(packet));
+            break;
+        case RFCOMM_EVENT_CHANNEL_OPENED:
+            if (rfcomm_event_channel_opened_get_status(packet)) mock_fail("channel open failed");
+            cid = rfcomm_event_channel_opened_get_rfcomm_cid(packet);
+            server_channel = rfcomm_event_channel_opened_get_server_channel(packet);
+            if (server_channel == spp_server_channel) spp_cid = cid;
+            if (server_channel == at_server_channel)  at_cid  = cid;
+            break;
+        case RFCOMM_EVENT_CHANNEL_CLOSED:
+            mock_fail("channel closed");
+            break;
+        case RFCOMM_EVENT_CAN_SEND_NOW:
+            cid = rfcomm_event_can_send_now_get_rfcomm_cid(packet);
+            if (cid == spp_cid) spp_send_packet();
+            if (cid == at_cid)  at_send_command();
+            break;
+        default:
+            break;
+    }
+}
+
+// remote consumes data immediately, returns SPP credits in batches and a credit for each AT command
+static void remote_data_handler(uint8_t dlci, const uint8_t * data, uint16_t len){
+    UNUSED(data);
+    if (dlci == spp_server_channel << 1){
+        spp_frames_received++;
+        spp_credits_to_return++;
+        if (spp_credits_to_return == SPP_CREDIT_BATCH){
+            mock_remote_grant_credits(spp_server_channel, spp_credits_to_return);
+            spp_credits_to_return = 0;
+        }
+        return;
+    }
+    if (dlci == at_server_channel << 1){
+        if (len == AT_FRAME_SIZE){
+            mock_remote_grant_credits(at_server_channel, 1);
+            return;
+        }
+        if (len != sizeof(at_command) - 1) mock_fail("wrong AT command size");
+        uint32_t latency_ms = mock_time_ms() - at_request_ms[at_received++];
+        at_latency_sum_ms += latency_ms;
+        at_latency_max_ms  = btstack_max(at_latency_max_ms, latency_ms);
+        mock_remote_grant_credits(at_server_channel, 1);
+        return;
+    }
+    mock_fail("data on unexpected DLCI");
+}
+
+static void run(const run_config_t * config){
+    spp_cid = 0;
+    at_cid  = 0;
+    spp_frames_sent       = 0;
+    spp_frames_received   = 0;
+    spp_credits_to_return = 0;
+    at_requested      = 0;
+    at_sent           = 0;
+    at_received       = 0;
+    at_latency_sum_ms = 0;
+    at_latency_max_ms = 0;
+    at_unsolicited_sent = 0;
+
+    if (config->at_first){
+        mock_open_dlc(at_server_channel,  AT_FRAME_SIZE,  AT_INITIAL_CREDITS);
+        mock_open_dlc(spp_server_channel, SPP_FRAME_SIZE, SPP_INITIAL_CREDITS);
+    } else {
+        mock_open_dlc(spp_server_channel, SPP_FRAME_SIZE, SPP_INITIAL_CREDITS);
+        mock_open_dlc(at_server_channel,  AT_FRAME_SIZE,  AT_INITIAL_CREDITS);
+    }
+    if (!spp_cid || !at_cid) mock_fail("channels not opened");
+    rfcomm_set_channel_priority(at_cid, config->at_priority);
+
+    if (config->at_unsolicited){
+        uint32_t unsolicited_start_ms = mock_time_ms();
+        while (mock_time_ms() - unsolicited_start_ms < UNSOLICITED_MS){
+            at_send_unsolicited();
+            mock_link_round();
+        }
+        if (!at_unsolicited_sent) mock_fail("no unsolicited frames sent");
+    }
+
+    spp_active = 1;
+    rfcomm_request_can_send_now_event(spp_cid);
+    uint32_t start_ms = mock_time_ms();
+    uint32_t next_at_ms = start_ms + AT_INTERVAL_MS;
+    while (mock_time_ms() - start_ms < RUN_MS){
+        if (mock_time_ms() == next_at_ms){
+            at_request_command();
+            next_at_ms += AT_INTERVAL_MS;
+        }
+        mock_link_round();
+    }
+    uint32_t duration_ms = mock_time_ms() - start_ms;
+    uint32_t spp_bytes = spp_frames_received * SPP_FRAME_SIZE;
+
+    // drain
+    spp_active = 0;
+    while (at_received < at_requested || spp_frames_received < spp_frames_sent){
+        mock_link_round();
+        if (mock_time_ms() - start_ms > 2 * RUN_MS) mock_fail("transfer stalled");
+    }
+
+    rfcomm_scheduler_stats_t spp_stats;
+    rfcomm_scheduler_stats_t at_stats;
+    rfcomm_get_scheduler_stats(spp_cid, &spp_stats);
+    rfcomm_get_scheduler_stats(at_cid,  &at_stats);
+    printf("%s: AT latency avg %4u max %4u ms, AT wait for can send now avg %4u max %4u ms | SPP %3u.%03u kB/s, wait avg %2u max %3u ms\n",
+        config->name, at_latency_sum_ms / at_received, at_latency_max_ms,
+        at_stats.wait_total_ms / at_stats.grants, at_stats.wait_max_ms,
+        spp_bytes / duration_ms, (spp_bytes % duration_ms) * 1000 / duration_ms,
+        spp_stats.wait_total_ms / spp_stats.grants, spp_stats.wait_max_ms);
+
+    if (at_latency_max_ms > AT_MAX_LATENCY_MS) mock_fail("AT DLC starved by SPP DLC");
+}
+
+int main(void){
+    memset(spp_data, 'x', sizeof(spp_data));
+    memset(at_unsolicited_data, 'u', sizeof(at_unsolicited_data));
+
+    mock_init();
+    l2cap_init();
+    rfcomm_init();
+    rfcomm_set_required_security_level(LEVEL_0);
+    int i;
+    for (i = 0; i < NUM_RUNS * 2; i++){
+        rfcomm_register_service(&packet_handler, 1 + i, (i & 1) ? AT_FRAME_SIZE : SPP_FRAME_SIZE);
+    }
+    mock_register_remote_data_handler(&remote_data_handler);
+    mock_connect();
+
+    printf("SPP frame size %u, AT command every %u ms for %u ms per run\n", SPP_FRAME_SIZE, AT_INTERVAL_MS, RUN_MS);
+    for (i = 0; i < NUM_RUNS; i++){
+        spp_server_channel = 1 + 2 * i;
+        at_server_channel  = 2 + 2 * i;
+        run(&runs[i]);
+    }
+    return 0;
+}
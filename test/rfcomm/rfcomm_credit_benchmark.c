@@ -0,0 +1,247 @@
+/*
+ * Copyright (C) 2017 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+/*
+ *  rfcomm_credit_benchmark.c
+ *
+ *  A simulated remote device streams SPP data as fast as its credits allow, like
+ *  example/spp_streamer.c, to an RFCOMM server in BTstack with a mock transport and controller.
+ *  The local application stores received data in a buffer of APP_BUFFER_SIZE bytes and
+ *  drains it either immediately (fast consumer) or with SLOW_DRAIN_RATE bytes/ms (slow consumer).
+ *
+ *  Each run uses a new DLC with one of the following credit policies:
+ *  - automatic: BTstack grants RFCOMM_CREDITS whenever the remote has less than 5 credits
+ *  - manual:    initial credits for the full buffer, one credit granted per consumed frame
+ *  - adaptive:  rfcomm_enable_adaptive_credits with the buffer size
+ *
+ *  Packets are delayed by the link latency in both directions, so credits take a round trip
+ *  to reach the remote. Throughput is measured in virtual time.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "btstack_config.h"
+#include "btstack_event.h"
+#include "btstack_util.h"
+#include "classic/rfcomm.h"
+#include "l2cap.h"
+#include "mock.h"
+
+#define MAX_FRAME_SIZE          1000
+#define APP_BUFFER_SIZE         (32 * MAX_FRAME_SIZE)
+#define SLOW_DRAIN_RATE         32
+#define TRANSFER_BYTES          1000000
+#define MAX_ROUNDS              200000
+
+typedef enum {
+    CREDITS_AUTOMATIC,
+    CREDITS_MANUAL,
+    CREDITS_ADAPTIVE,
+} credit_policy_t;
+
+static const char * policy_names[] = { "automatic", "manual", "adaptive" };
+static const uint32_t link_latencies_ms[] = { 5, 20 };
+
+static uint8_t         server_channel;
+static credit_policy_t policy;
+static int             slow_consumer;
+static uint16_t        rfcomm_cid;
+static uint32_t        app_buffered;
+static uint32_t        app_max_buffered;
+static uint64_t        app_buffered_sum;
+static uint32_t        app_received;
+static uint32_t        app_consumed;
+static uint32_t        app_frames_granted;
+static uint8_t         remote_frame[MAX_FRAME_SIZE];
+static uint32_t        remote_sent;
+static uint8_t         max_credits_in_flight;
+
+static void app_consume(uint32_t len){
+    app_buffered -= len;
+    app_consumed += len;
+    switch (policy){
+        case CREDITS_MANUAL: {
+            // all frames have max size, grant credit for each consumed frame
+            uint32_t frames_consumed = app_consumed / MAX_FRAME_SIZE;
+            if (frames_consumed > app_frames_granted){
+                rfcomm_grant_credits(rfcomm_cid, frames_consumed - app_frames_granted);
+                app_frames_granted = frames_consumed;
+            }
+            break;
+        }
+        case CREDITS_ADAPTIVE:
+            rfcomm_notify_data_consumed(rfcomm_cid, len);
+            break;
+        default:
+            break;
+    }
+}
+
+static void packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size){
+    uint16_t cid;
+    switch (packet_type){
+        case HCI_EVENT_PACKET:
+            switch (hci_event_packet_get_type(packet)){
+                case RFCOMM_EVENT_INCOMING_CONNECTION:
+                    cid = rfcomm_event_incoming_connection_get_rfcomm_cid(packet);
+                    if (policy == CREDITS_ADAPTIVE){
+                        if (rfcomm_enable_adaptive_credits(cid, APP_BUFFER_SIZE)) mock_fail("enable adaptive credits failed");
+                    }
+                    rfcomm_accept_connection(cid);
+                    break;
+                case RFCOMM_EVENT_CHANNEL_OPENED:
+                    if (rfcomm_event_channel_opened_get_status(packet)) mock_fail("channel open failed");
+                    rfcomm_cid = rfcomm_event_channel_opened_get_rfcomm_cid(packet);
+                    break;
+                case RFCOMM_EVENT_CHANNEL_CLOSED:
+                    mock_fail("channel closed");
+                    break;
+                default:
+                    break;
+            }
+            break;
+        case RFCOMM_DATA_PACKET:
+            if (channel != rfcomm_cid) mock_fail("data on unexpected channel");
+            app_received += size;
+            app_buffered += size;
+            app_max_buffered = btstack_max(app_max_buffered, app_buffered);
+            if (!slow_consumer){
+                app_consume(size);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+static void remote_send_frames(void){
+    if (remote_sent == TRANSFER_BYTES) return;
+    while (remote_sent < TRANSFER_BYTES && mock_remote_can_send(server_channel)){
+        mock_remote_send_data(server_channel, remote_frame, MAX_FRAME_SIZE);
+        remote_sent += MAX_FRAME_SIZE;
+    }
+}
+
+// one server channel per run
+static void register_service(uint8_t channel, credit_policy_t channel_policy){
+    switch (channel_policy){
+        case CREDITS_AUTOMATIC:
+        case CREDITS_ADAPTIVE:
+            rfcomm_register_service(&packet_handler, channel, MAX_FRAME_SIZE);
+            break;
+        case CREDITS_MANUAL:
+            rfcomm_register_service_with_initial_credits(&packet_handler, channel, MAX_FRAME_SIZE, APP_BUFFER_SIZE / MAX_FRAME_SIZE);
+            break;
+        default:
+            break;
+    }
+}
+
+static void run(uint32_t latency_ms){
+    server_channel++;
+    rfcomm_cid         = 0;
+    app_buffered       = 0;
+    app_max_buffered   = 0;
+    app_buffered_sum   = 0;
+    app_received       = 0;
+    app_consumed       = 0;
+    app_frames_granted = 0;
+    remote_sent        = 0;
+    max_credits_in_flight = 0;
+
+    mock_set_link_latency(latency_ms);
+    // remote grants enough credits to not limit control frames
+    mock_open_dlc(server_channel, MAX_FRAME_SIZE, 10);
+    if (!rfcomm_cid) mock_fail("channel not opened");
+
+    uint32_t start_ms = mock_time_ms();
+    uint32_t idle_ms  = mock_link_idle_ms();
+    while (app_consumed < TRANSFER_BYTES){
+        remote_send_frames();
+        mock_link_round();
+        if (slow_consumer){
+            app_consume(btstack_min(app_buffered, SLOW_DRAIN_RATE));
+        }
+        app_buffered_sum += app_buffered;
+        rfcomm_credit_stats_t stats;
+        rfcomm_get_credit_stats(rfcomm_cid, &stats);
+        max_credits_in_flight = btstack_max(max_credits_in_flight, stats.credits_in_flight);
+        if (mock_time_ms() - start_ms > MAX_ROUNDS) mock_fail("transfer stalled");
+    }
+    uint32_t duration_ms = mock_time_ms() - start_ms;
+    idle_ms = mock_link_idle_ms() - idle_ms;
+
+    rfcomm_credit_stats_t stats;
+    rfcomm_get_credit_stats(rfcomm_cid, &stats);
+    printf("%2u ms %s %-9s: %4u.%03u kB/s, link idle %5u ms, credit stalls %4u, credit frames %4u, max credits in flight %3u, buffered avg %6u max %6u bytes%s",
+        latency_ms, slow_consumer ? "slow" : "fast", policy_names[policy],
+        TRANSFER_BYTES / duration_ms, (TRANSFER_BYTES % duration_ms) * 1000 / duration_ms,
+        idle_ms, stats.credit_stalls, stats.credit_frames, max_credits_in_flight, (uint32_t) (app_buffered_sum / duration_ms), app_max_buffered,
+        app_max_buffered > APP_BUFFER_SIZE ? " (overflow)" : "");
+    if (policy == CREDITS_ADAPTIVE){
+        printf(" | window %u, rtt %u ms, drain rate %u bytes/s", stats.credit_window, stats.rtt_ms, stats.drain_rate);
+    }
+    printf("\n");
+
+    if (policy != CREDITS_AUTOMATIC && app_max_buffered > APP_BUFFER_SIZE) mock_fail("application buffer exceeded");
+}
+
+int main(void){
+    mock_init();
+    l2cap_init();
+    rfcomm_init();
+    rfcomm_set_required_security_level(LEVEL_0);
+    int num_latencies = sizeof(link_latencies_ms) / sizeof(link_latencies_ms[0]);
+    int i;
+    for (i = 0; i < num_latencies * 2 * 3; i++){
+        register_service(1 + i, (credit_policy_t) (i % 3));
+    }
+    mock_connect();
+
+    printf("%u bytes per run, frame size %u, application buffer %u bytes, slow consumer drains %u kB/s\n",
+        TRANSFER_BYTES, MAX_FRAME_SIZE, APP_BUFFER_SIZE, SLOW_DRAIN_RATE);
+    for (i = 0; i < num_latencies; i++){
+        for (slow_consumer = 0; slow_consumer < 2; slow_consumer++){
+            for (policy = CREDITS_AUTOMATIC; policy <= CREDITS_ADAPTIVE; policy++){
+                run(link_latencies_ms[i]);
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,227 @@
+/*
+ * Copyright (C) 2017 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+/*
+ *  rfcomm_spp_benchmark.c
+ *
+ *  Stream SPP data from an RFCOMM server through rfcomm.c, l2cap.c and hci.c to a simulated
+ *  remote device, similar to example/spp_streamer.c, with a mock transport and controller.
+ *
+ *  Each frame consists of a sequence number followed by a block of test data. The frames are
+ *  sent with:
+ *  - copy:     frame assembled in application buffer and sent with rfcomm_send
+ *  - prepared: frame assembled in outgoing buffer and sent with rfcomm_send_prepared
+ *  - scatter:  sequence number and test data sent as two fragments with rfcomm_send_scatter
+ *
+ *  Throughput is measured in virtual time and limited by the simulated baseband and the
+ *  credits granted by the remote. Host time is measured for the send path only and for the
+ *  whole transfer including the mock controller and remote.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "btstack_config.h"
+#include "btstack_event.h"
+#include "btstack_util.h"
+#include "classic/rfcomm.h"
+#include "l2cap.h"
+#include "mock.h"
+
+#define RFCOMM_SERVER_CHANNEL   1
+#define MAX_FRAME_SIZE          1000
+#define NUM_FRAMES              20000
+#define REMOTE_INITIAL_CREDITS  32
+#define REMOTE_CREDIT_BATCH     8
+#define MAX_ROUNDS              (NUM_FRAMES * 100)
+
+typedef enum {
+    SEND_COPY,
+    SEND_PREPARED,
+    SEND_SCATTER,
+} send_mode_t;
+
+static const char * send_mode_names[] = { "copy", "prepared", "scatter" };
+
+static uint8_t  test_data[MAX_FRAME_SIZE];
+static uint16_t rfcomm_cid;
+static uint16_t rfcomm_mtu;
+static uint32_t frames_to_send;
+static uint32_t frames_sent;
+static uint32_t frames_received;
+static uint8_t  credits_to_return;
+static send_mode_t send_mode;
+static double   send_path_s;
+
+static double now_s(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static void spp_create_test_data(void){
+    int i;
+    for (i = 0; i < MAX_FRAME_SIZE; i++){
+        test_data[i] = '0' + (i % 10);
+    }
+}
+
+static int spp_send_frame(void){
+    uint16_t payload_len = rfcomm_mtu - 4;
+    uint8_t  sequence_number[4];
+    little_endian_store_32(sequence_number, 0, frames_sent);
+    switch (send_mode){
+        case SEND_COPY: {
+            uint8_t frame[MAX_FRAME_SIZE];
+            memcpy(frame, sequence_number, 4);
+            memcpy(&frame[4], test_data, payload_len);
+            return rfcomm_send(rfcomm_cid, frame, rfcomm_mtu);
+        }
+        case SEND_PREPARED: {
+            rfcomm_reserve_packet_buffer();
+            uint8_t * frame = rfcomm_get_outgoing_buffer();
+            memcpy(frame, sequence_number, 4);
+            memcpy(&frame[4], test_data, payload_len);
+            int err = rfcomm_send_prepared(rfcomm_cid, rfcomm_mtu);
+            if (err){
+                rfcomm_release_packet_buffer();
+            }
+            return err;
+        }
+        case SEND_SCATTER: {
+            rfcomm_fragment_t fragments[2];
+            fragments[0].data = sequence_number;
+            fragments[0].len  = 4;
+            fragments[1].data = test_data;
+            fragments[1].len  = payload_len;
+            return rfcomm_send_scatter(rfcomm_cid, fragments, 2);
+        }
+        default:
+            return -1;
+    }
+}
+
+static void spp_send_packet(void){
+    if (frames_sent == frames_to_send) return;
+    double start = now_s();
+    if (spp_send_frame()) mock_fail("send failed");
+    send_path_s += now_s() - start;
+    frames_sent++;
+    if (frames_sent < frames_to_send){
+        rfcomm_request_can_send_now_event(rfcomm_cid);
+    }
+}
+
+static void packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size){
+    UNUSED(channel);
+    UNUSED(size);
+    if (packet_type != HCI_EVENT_PACKET) return;
+    switch (hci_event_packet_get_type(packet)){
+        case RFCOMM_EVENT_INCOMING_CONNECTION:
+            rfcomm_accept_connection(rfcomm_event_incoming_connection_get_rfcomm_cid(packet));
+            break;
+        case RFCOMM_EVENT_CHANNEL_OPENED:
+            if (rfcomm_event_channel_opened_get_status(packet)) mock_fail("channel open failed");
+            rfcomm_cid = rfcomm_event_channel_opened_get_rfcomm_cid(packet);
+            rfcomm_mtu = rfcomm_event_channel_opened_get_max_frame_size(packet);
+            break;
+        case RFCOMM_EVENT_CHANNEL_CLOSED:
+            mock_fail("channel closed");
+            break;
+        case RFCOMM_EVENT_CAN_SEND_NOW:
+            spp_send_packet();
+            break;
+        default:
+            break;
+    }
+}
+
+// remote consumes data immediately and returns credits in batches
+static void remote_data_handler(uint8_t dlci, const uint8_t * data, uint16_t len){
+    if (dlci != RFCOMM_SERVER_CHANNEL << 1) mock_fail("data on unexpected DLCI");
+    if (len != rfcomm_mtu) mock_fail("wrong frame size");
+    if (little_endian_read_32(data, 0) != frames_received) mock_fail("frame out of order");
+    if (memcmp(&data[4], test_data, len - 4) != 0) mock_fail("frame corrupted");
+    frames_received++;
+    credits_to_return++;
+    if (credits_to_return == REMOTE_CREDIT_BATCH){
+        mock_remote_grant_credits(RFCOMM_SERVER_CHANNEL, credits_to_return);
+        credits_to_return = 0;
+    }
+}
+
+int main(void){
+    spp_create_test_data();
+
+    mock_init();
+    l2cap_init();
+    rfcomm_init();
+    rfcomm_set_required_security_level(LEVEL_0);
+    rfcomm_register_service(&packet_handler, RFCOMM_SERVER_CHANNEL, MAX_FRAME_SIZE);
+    mock_register_remote_data_handler(&remote_data_handler);
+
+    mock_connect();
+    mock_open_dlc(RFCOMM_SERVER_CHANNEL, MAX_FRAME_SIZE, REMOTE_INITIAL_CREDITS);
+    if (!rfcomm_cid) mock_fail("channel not opened");
+    printf("max frame size %u, %u frames per run\n", rfcomm_mtu, NUM_FRAMES);
+
+    int i;
+    for (i = 0; i < (int) (sizeof(send_mode_names) / sizeof(send_mode_names[0])); i++){
+        send_mode      = (send_mode_t) i;
+        send_path_s    = 0;
+        uint32_t time_before = mock_time_ms();
+
+        double start = now_s();
+        frames_to_send += NUM_FRAMES;
+        rfcomm_request_can_send_now_event(rfcomm_cid);
+        while (frames_received < frames_to_send){
+            mock_link_round();
+            if (mock_time_ms() - time_before > MAX_ROUNDS) mock_fail("transfer stalled");
+        }
+        double transfer_s = now_s() - start;
+
+        uint32_t duration_ms = mock_time_ms() - time_before;
+        uint32_t bytes = NUM_FRAMES * rfcomm_mtu;
+        printf("%-8s: %8u bytes in %6u ms virtual time -> %3u.%03u kB/s | send path %4u ns/frame, total %5u ns/frame\n",
+            send_mode_names[send_mode], bytes, duration_ms,
+            bytes / duration_ms, (bytes % duration_ms) * 1000 / duration_ms,
+            (unsigned int) (send_path_s * 1e9 / NUM_FRAMES), (unsigned int) (transfer_s * 1e9 / NUM_FRAMES));
+    }
+    return 0;
+}
@@ -0,0 +1,207 @@
+/*
+ * Copyright (C) 2017 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+/*
+ *  execute_on_main_thread_benchmark.c
+ *
+ *  Producer threads post callbacks via btstack_run_loop_execute_on_main_thread at a fixed rate
+ *  or as fast as possible. Reports achieved posting rate and latency from post to callback
+ *  for the posix and epoll run loops.
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "btstack_run_loop.h"
+#include "btstack_run_loop_posix.h"
+#include "btstack_run_loop_epoll.h"
+
+#define MESSAGES_PER_RUN     200000
+#define MAX_PRODUCERS             4
+#define MESSAGES_PER_PRODUCER    64
+
+typedef struct {
+    btstack_context_callback_registration_t callback_registration;
+    uint64_t posted_ns;
+    int in_flight;
+} message_t;
+
+typedef struct {
+    pthread_t thread;
+    message_t messages[MESSAGES_PER_PRODUCER];
+    int num_messages;
+} producer_t;
+
+static producer_t producers[MAX_PRODUCERS];
+static int num_producers;
+static uint32_t messages_per_second;
+static uint64_t start_ns;
+
+static uint32_t  latencies_ns[MESSAGES_PER_RUN];
+static int       num_received;
+static int       total_messages;
+static const char * run_loop_name;
+
+static uint64_t benchmark_now_ns(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+static int compare_uint32(const void * a, const void * b){
+    uint32_t value_a = *(const uint32_t *) a;
+    uint32_t value_b = *(const uint32_t *) b;
+    return (value_a > value_b) - (value_a < value_b);
+}
+
+static void report(void){
+    uint64_t duration_ns = benchmark_now_ns() - start_ns;
+    uint64_t latency_sum_ns = 0;
+    int i;
+    for (i = 0; i < num_received; i++){
+        latency_sum_ns += latencies_ns[i];
+    }
+    qsort(latencies_ns, num_received, sizeof(uint32_t), &compare_uint32);
+    char rate[16];
+    if (messages_per_second){
+        snprintf(rate, sizeof(rate), "%u/s", messages_per_second);
+    } else {
+        snprintf(rate, sizeof(rate), "max");
+    }
+    printf("%-6s %u producer(s), rate %-9s: posted %9.0f/s, latency avg %8.1f us, p99 %8.1f us, max %8.1f us\n",
+        run_loop_name, num_producers, rate,
+        num_received * 1e9 / duration_ns,
+        latency_sum_ns / 1e3 / num_received,
+        latencies_ns[num_received * 99 / 100] / 1e3,
+        latencies_ns[num_received - 1] / 1e3);
+}
+
+static void message_handler(void * context){
+    message_t * message = (message_t *) context;
+    uint64_t now_ns = benchmark_now_ns();
+    uint64_t latency = now_ns - message->posted_ns;
+    latencies_ns[num_received++] = latency > UINT32_MAX ? UINT32_MAX : (uint32_t) latency;
+    __atomic_store_n(&message->in_flight, 0, __ATOMIC_RELEASE);
+    if (num_received < total_messages) return;
+    report();
+    exit(0);
+}
+
+static void * producer_thread(void * context){
+    producer_t * producer = (producer_t *) context;
+    uint64_t interval_ns = messages_per_second ? 1000000000ull * num_producers / messages_per_second : 0;
+    uint64_t next_ns = benchmark_now_ns();
+    int i;
+    for (i = 0; i < producer->num_messages; i++){
+        // pace posting
+        if (interval_ns){
+            next_ns += interval_ns;
+            uint64_t now_ns = benchmark_now_ns();
+            if (next_ns > now_ns + 100000){
+                struct timespec delay = { 0, (long) (next_ns - now_ns - 50000) };
+                nanosleep(&delay, NULL);
+            }
+            while (benchmark_now_ns() < next_ns);
+        }
+        // wait for message slot to be processed
+        message_t * message = &producer->messages[i % MESSAGES_PER_PRODUCER];
+        while (__atomic_load_n(&message->in_flight, __ATOMIC_ACQUIRE));
+        message->in_flight = 1;
+        message->posted_ns = benchmark_now_ns();
+        btstack_run_loop_execute_on_main_thread(&message->callback_registration);
+    }
+    return NULL;
+}
+
+static void benchmark_run(const btstack_run_loop_t * run_loop, const char * name){
+    int i;
+    int j;
+    btstack_run_loop_init(run_loop);
+    run_loop_name = name;
+
+    int messages_per_run = messages_per_second ? messages_per_second / 10 : MESSAGES_PER_RUN;
+    if (messages_per_run > MESSAGES_PER_RUN){
+        messages_per_run = MESSAGES_PER_RUN;
+    }
+
+    total_messages = (messages_per_run / num_producers) * num_producers;
+    start_ns = benchmark_now_ns();
+    for (i = 0; i < num_producers; i++){
+        producer_t * producer = &producers[i];
+        producer->num_messages = messages_per_run / num_producers;
+        for (j = 0; j < MESSAGES_PER_PRODUCER; j++){
+            producer->messages[j].callback_registration.callback = &message_handler;
+            producer->messages[j].callback_registration.context  = &producer->messages[j];
+        }
+        pthread_create(&producer->thread, NULL, &producer_thread, producer);
+    }
+    btstack_run_loop_execute();
+}
+
+int main(void){
+    static const uint32_t rates[] = { 1000, 10000, 100000, 0 };
+    static const int producer_counts[] = { 1, MAX_PRODUCERS };
+    int use_epoll;
+    unsigned int i;
+    unsigned int j;
+    int status;
+    for (use_epoll = 0; use_epoll <= 1; use_epoll++){
+        for (i = 0; i < sizeof(producer_counts) / sizeof(int); i++){
+            for (j = 0; j < sizeof(rates) / sizeof(uint32_t); j++){
+                num_producers = producer_counts[i];
+                messages_per_second = rates[j];
+                // run loops cannot be stopped or re-initialized, use one process per run
+                pid_t pid = fork();
+                if (pid == 0){
+                    if (use_epoll){
+                        benchmark_run(btstack_run_loop_epoll_get_instance(), "epoll");
+                    } else {
+                        benchmark_run(btstack_run_loop_posix_get_instance(), "posix");
+                    }
+                }
+                waitpid(pid, &status, 0);
+                if (!WIFEXITED(status) || WEXITSTATUS(status)) return 1;
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2017 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+/*
+ *  run_loop_benchmark.c
+ *
+ *  Compare dispatch rate of select() based posix run loop and epoll run loop
+ *  with 10, 100 and 1000 registered data sources of which only one is ready at a time
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include "btstack_run_loop.h"
+#include "btstack_run_loop_posix.h"
+#include "btstack_run_loop_epoll.h"
+
+#define MAX_DATA_SOURCES  1000
+#define NUM_DISPATCHES   20000
+
+static btstack_data_source_t data_sources[MAX_DATA_SOURCES];
+static int num_data_sources;
+static int num_dispatches;
+static struct timespec start_ts;
+static const char * run_loop_name;
+
+static double benchmark_elapsed_s(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start_ts.tv_sec) + (now.tv_nsec - start_ts.tv_nsec) / 1e9;
+}
+
+static void benchmark_signal(int index){
+    uint64_t value = 1;
+    if (write(data_sources[index].fd, &value, sizeof(value)) != sizeof(value)){
+        printf("write failed\n");
+        exit(1);
+    }
+}
+
+static void benchmark_process(btstack_data_source_t * ds, btstack_data_source_callback_type_t callback_type){
+    (void) callback_type;
+    uint64_t value;
+    if (read(ds->fd, &value, sizeof(value)) != sizeof(value)){
+        printf("read failed\n");
+        exit(1);
+    }
+    num_dispatches++;
+    if (num_dispatches == NUM_DISPATCHES){
+        double elapsed = benchmark_elapsed_s();
+        printf("%-8s %5u sources: %8.2f us/dispatch, %9.0f dispatches/s\n", run_loop_name, num_data_sources,
+            elapsed * 1e6 / NUM_DISPATCHES, NUM_DISPATCHES / elapsed);
+        exit(0);
+    }
+    // hand over to another data source, stride is co-prime to all tested sizes
+    int index = (int) (ds - data_sources);
+    benchmark_signal((index + 7) % num_data_sources);
+}
+
+static void benchmark_timeout(btstack_timer_source_t * ts){
+    (void) ts;
+    printf("%-8s %5u sources: timeout after %u dispatches\n", run_loop_name, num_data_sources, num_dispatches);
+    exit(1);
+}
+
+static void benchmark_run(const char * name, const btstack_run_loop_t * run_loop, int count){
+    static btstack_timer_source_t timeout;
+    int i;
+
+    run_loop_name = name;
+    num_data_sources = count;
+    btstack_run_loop_init(run_loop);
+
+    for (i = 0; i < count; i++){
+        int fd = eventfd(0, EFD_NONBLOCK);
+        if (fd < 0){
+            printf("eventfd failed for source %u\n", i);
+            exit(1);
+        }
+        btstack_run_loop_set_data_source_fd(&data_sources[i], fd);
+        btstack_run_loop_set_data_source_handler(&data_sources[i], &benchmark_process);
+        btstack_run_loop_enable_data_source_callbacks(&data_sources[i], DATA_SOURCE_CALLBACK_READ);
+        btstack_run_loop_add_data_source(&data_sources[i]);
+    }
+
+    btstack_run_loop_set_timer_handler(&timeout, &benchmark_timeout);
+    btstack_run_loop_set_timer(&timeout, 10000);
+    btstack_run_loop_add_timer(&timeout);
+
+    clock_gettime(CLOCK_MONOTONIC, &start_ts);
+    benchmark_signal(0);
+    btstack_run_loop_execute();
+}
+
+int main(void){
+    static const int counts[] = { 10, 100, 1000 };
+    struct rlimit limit;
+    unsigned int i;
+    int status;
+
+    // allow for 1000 eventfds
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0){
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    // run loops cannot be stopped or re-initialized, use one process per run
+    for (i = 0; i < sizeof(counts) / sizeof(int); i++){
+        pid_t pid = fork();
+        if (pid == 0) benchmark_run("select", btstack_run_loop_posix_get_instance(), counts[i]);
+        waitpid(pid, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status)) return 1;
+
+        pid = fork();
+        if (pid == 0) benchmark_run("epoll", btstack_run_loop_epoll_get_instance(), counts[i]);
+        waitpid(pid, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status)) return 1;
+    }
+    return 0;
+}
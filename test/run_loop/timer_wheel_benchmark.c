@@ -0,0 +1,277 @@
+/*
+ * Copyright (C) 2017 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+/*
+ *  timer_wheel_benchmark.c
+ *
+ *  Churn thousands of timers like busy L2CAP ERTM links do: every ack restarts the retransmission
+ *  timer of its channel, a few timers expire and get re-armed. Compares the sorted timer list used
+ *  by the run loops so far against btstack_timer_wheel and verifies that both fire the same
+ *  timers in the same order. Also checks that timers can be removed after their timeout was changed,
+ *  as btstack_run_loop_set_timer followed by btstack_run_loop_remove_timer does, and that such a timer
+ *  is not added a second time.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "btstack_linked_list.h"
+#include "btstack_run_loop.h"
+#include "btstack_timer_wheel.h"
+#include "hci_dump.h"
+
+#define MAX_TIMERS       5000
+#define NUM_STEPS       20000
+#define RESTARTS_PER_MS     8
+
+// ERTM retransmission and monitor timeouts
+#define RETRANSMISSION_TIMEOUT_MS  2000
+#define MONITOR_TIMEOUT_MS        12000
+
+typedef struct {
+    const char * name;
+    void (*init)(uint32_t now);
+    void (*add)(btstack_timer_source_t * ts);
+    int  (*remove)(btstack_timer_source_t * ts);
+    btstack_timer_source_t * (*pop_expired)(uint32_t now);
+} timer_impl_t;
+
+static btstack_timer_source_t timers[MAX_TIMERS];
+
+// sorted list, as in btstack_run_loop_posix before
+static btstack_linked_list_t timer_list;
+
+static void list_init(uint32_t now){
+    (void) now;
+    timer_list = NULL;
+}
+
+static void list_add(btstack_timer_source_t * ts){
+    btstack_linked_item_t *it;
+    for (it = (btstack_linked_item_t *) &timer_list; it->next ; it = it->next){
+        btstack_timer_source_t * next = (btstack_timer_source_t *) it->next;
+        if (next == ts) return;
+        if (next->timeout > ts->timeout) break;
+    }
+    ts->item.next = it->next;
+    it->next = (btstack_linked_item_t *) ts;
+}
+
+static int list_remove(btstack_timer_source_t * ts){
+    return btstack_linked_list_remove(&timer_list, (btstack_linked_item_t *) ts);
+}
+
+static btstack_timer_source_t * list_pop_expired(uint32_t now){
+    btstack_timer_source_t * ts = (btstack_timer_source_t *) timer_list;
+    if (ts == NULL || ts->timeout > now) return NULL;
+    timer_list = ts->item.next;
+    return ts;
+}
+
+static const timer_impl_t list_impl = { "list", &list_init, &list_add, &list_remove, &list_pop_expired };
+
+// timer wheel, same configuration as btstack_run_loop_posix
+static btstack_timer_wheel_t timer_wheel;
+static btstack_timer_wheel_slot_t timer_wheel_slots[256];
+
+static void wheel_init(uint32_t now){
+    btstack_timer_wheel_init(&timer_wheel, timer_wheel_slots, 256, 4, now);
+}
+
+static void wheel_add(btstack_timer_source_t * ts){
+    btstack_timer_wheel_add(&timer_wheel, ts);
+}
+
+static int wheel_remove(btstack_timer_source_t * ts){
+    return btstack_timer_wheel_remove(&timer_wheel, ts);
+}
+
+static btstack_timer_source_t * wheel_pop_expired(uint32_t now){
+    return btstack_timer_wheel_pop_expired(&timer_wheel, now);
+}
+
+static const timer_impl_t wheel_impl = { "wheel", &wheel_init, &wheel_add, &wheel_remove, &wheel_pop_expired };
+
+static uint32_t random_state;
+
+static uint32_t benchmark_random(void){
+    random_state = random_state * 1103515245 + 12345;
+    return random_state >> 8;
+}
+
+static uint32_t benchmark_timeout(uint32_t now, int index){
+    // every 4th channel waits for its monitor timer
+    uint32_t base = (index & 3) ? RETRANSMISSION_TIMEOUT_MS : MONITOR_TIMEOUT_MS;
+    return now + base + (benchmark_random() % 100);
+}
+
+static double benchmark_run(const timer_impl_t * impl, int num_timers, uint32_t * fired, uint32_t * checksum){
+    struct timespec start, end;
+    uint32_t now = 1000;
+    int i, step;
+
+    random_state = 0x1234;
+    *fired = 0;
+    *checksum = 0;
+
+    impl->init(now);
+    for (i = 0; i < num_timers; i++){
+        timers[i].timeout = benchmark_timeout(now, i);
+        impl->add(&timers[i]);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (step = 0; step < NUM_STEPS; step++){
+        now++;
+        // acks restart the retransmission timer on even channels, odd channels are idle
+        for (i = 0; i < RESTARTS_PER_MS; i++){
+            int index = (benchmark_random() % num_timers) & ~1;
+            impl->remove(&timers[index]);
+            timers[index].timeout = benchmark_timeout(now, index);
+            impl->add(&timers[index]);
+        }
+        // expired timers trigger a retransmission and get re-armed
+        btstack_timer_source_t * ts;
+        while ((ts = impl->pop_expired(now)) != NULL){
+            int index = (int) (ts - timers);
+            (*fired)++;
+            *checksum = (*checksum * 31) + (uint32_t) index;
+            ts->timeout = benchmark_timeout(now, index);
+            impl->add(ts);
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    for (i = 0; i < num_timers; i++){
+        impl->remove(&timers[i]);
+    }
+    double elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    return elapsed * 1e9 / NUM_STEPS;
+}
+
+// timeout changed while timer is active, then remove and add again
+static int test_remove_after_timeout_change(void){
+    uint32_t now = 1000;
+    wheel_init(now);
+    timers[0].timeout = now + 100;
+    timers[1].timeout = now + 200;
+    wheel_add(&timers[0]);
+    wheel_add(&timers[1]);
+    timers[0].timeout = now + 5000;
+    if (!wheel_remove(&timers[0])) return 0;
+    wheel_add(&timers[0]);
+    if (btstack_timer_wheel_count(&timer_wheel) != 2) return 0;
+
+    int fired_0 = 0;
+    int fired_1 = 0;
+    for (now = 1000; now <= 7000; now++){
+        btstack_timer_source_t * ts;
+        while ((ts = wheel_pop_expired(now)) != NULL){
+            if (ts == &timers[0]){
+                if (now != 6000) return 0;
+                fired_0++;
+            } else {
+                if (now != 1200) return 0;
+                fired_1++;
+            }
+        }
+    }
+    return fired_0 == 1 && fired_1 == 1 && btstack_timer_wheel_count(&timer_wheel) == 0;
+}
+
+// timeout changed while timer is active, then added again without remove
+static int test_add_after_timeout_change(void){
+    uint32_t now = 1000;
+    wheel_init(now);
+    // timers 0 and 2 share a slot
+    timers[0].timeout = now + 100;
+    timers[1].timeout = now + 200;
+    timers[2].timeout = now + 101;
+    wheel_add(&timers[0]);
+    wheel_add(&timers[1]);
+    wheel_add(&timers[2]);
+    timers[0].timeout = now + 5000;
+    // rejected add is logged as error
+    hci_dump_enable_log_level(LOG_LEVEL_ERROR, 0);
+    int added = btstack_timer_wheel_add(&timer_wheel, &timers[0]);
+    hci_dump_enable_log_level(LOG_LEVEL_ERROR, 1);
+    if (added) return 0;
+    if (btstack_timer_wheel_count(&timer_wheel) != 3) return 0;
+
+    // timers behind timer 0 in its slot still fire, timer 0 can still be removed
+    uint32_t fired_at[3] = { 0, 0, 0 };
+    for (now = 1000; now <= 2000; now++){
+        btstack_timer_source_t * ts;
+        while ((ts = wheel_pop_expired(now)) != NULL){
+            int index = (int) (ts - timers);
+            if (fired_at[index]) return 0;
+            fired_at[index] = now;
+        }
+    }
+    if (fired_at[0] != 0 || fired_at[1] != 1200 || fired_at[2] != 1101) return 0;
+    if (!wheel_remove(&timers[0])) return 0;
+    return btstack_timer_wheel_count(&timer_wheel) == 0;
+}
+
+int main(void){
+    if (!test_remove_after_timeout_change()){
+        printf("ERROR: timer with changed timeout not removed\n");
+        return 1;
+    }
+    if (!test_add_after_timeout_change()){
+        printf("ERROR: active timer with changed timeout added twice\n");
+        return 1;
+    }
+
+    static const int counts[] = { 100, 1000, 5000 };
+    unsigned int i;
+    for (i = 0; i < sizeof(counts) / sizeof(int); i++){
+        uint32_t list_fired, list_checksum;
+        uint32_t wheel_fired, wheel_checksum;
+        double list_ns  = benchmark_run(&list_impl,  counts[i], &list_fired,  &list_checksum);
+        double wheel_ns = benchmark_run(&wheel_impl, counts[i], &wheel_fired, &wheel_checksum);
+        printf("%5u timers: list %9.0f ns/ms, wheel %7.0f ns/ms, %u timers fired\n", counts[i], list_ns, wheel_ns, wheel_fired);
+        if (list_fired != wheel_fired || list_checksum != wheel_checksum){
+            printf("ERROR: list fired %u timers (checksum %08x), wheel fired %u timers (checksum %08x)\n",
+                list_fired, list_checksum, wheel_fired, wheel_checksum);
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2017 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+/*
+ *  usb_polling_benchmark.c
+ *
+ *  Loopback stand-in for the libusb transport: a device thread completes "transfers" by writing
+ *  a timestamp into a pipe, as libusb signals completed transfers via its event file descriptors.
+ *  Compares the 1 ms polling timer used by hci_transport_h2_libusb without pollfds against
+ *  registering the file descriptor as a run loop data source. Reports delivery latency
+ *  and CPU time while idle.
+ */
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include "btstack_run_loop.h"
+#include "btstack_run_loop_posix.h"
+
+#define NUM_PACKETS            500
+#define PACKET_INTERVAL_US    2000
+#define IDLE_MS               1000
+#define POLLING_INTERVAL_MS      1
+
+static int pipe_fds[2];
+static int use_polling;
+static btstack_data_source_t data_source;
+static btstack_timer_source_t polling_timer;
+static btstack_timer_source_t idle_timer;
+
+static int      num_received;
+static uint64_t latency_sum_ns;
+static uint64_t latency_max_ns;
+static uint32_t num_wakeups;
+static struct rusage idle_start_usage;
+
+static uint64_t benchmark_now_ns(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+static double benchmark_cpu_ms(struct rusage * usage){
+    return (usage->ru_utime.tv_sec + usage->ru_stime.tv_sec) * 1e3 + (usage->ru_utime.tv_usec + usage->ru_stime.tv_usec) / 1e3;
+}
+
+static void * device_thread(void * context){
+    (void) context;
+    int i;
+    for (i = 0; i < NUM_PACKETS; i++){
+        usleep(PACKET_INTERVAL_US);
+        uint64_t timestamp = benchmark_now_ns();
+        if (write(pipe_fds[1], &timestamp, sizeof(timestamp)) != sizeof(timestamp)) break;
+    }
+    return NULL;
+}
+
+static void idle_done(btstack_timer_source_t * ts){
+    (void) ts;
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    printf("%-8s latency avg %7.1f us, max %7.1f us, idle cpu %6.2f ms/s, %5u wakeups/s\n",
+        use_polling ? "polling" : "pollfd",
+        latency_sum_ns / 1e3 / num_received, latency_max_ns / 1e3,
+        (benchmark_cpu_ms(&usage) - benchmark_cpu_ms(&idle_start_usage)) * 1000 / IDLE_MS,
+        num_wakeups * 1000 / IDLE_MS);
+    exit(0);
+}
+
+// like libusb_handle_events_timeout with zero timeout: handle all completed transfers
+static void handle_events(void){
+    uint64_t timestamp;
+    num_wakeups++;
+    while (read(pipe_fds[0], &timestamp, sizeof(timestamp)) == sizeof(timestamp)){
+        uint64_t latency = benchmark_now_ns() - timestamp;
+        latency_sum_ns += latency;
+        if (latency > latency_max_ns){
+            latency_max_ns = latency;
+        }
+        num_received++;
+        if (num_received < NUM_PACKETS) continue;
+
+        // all packets received, measure idle phase
+        num_wakeups = 0;
+        getrusage(RUSAGE_SELF, &idle_start_usage);
+        btstack_run_loop_set_timer_handler(&idle_timer, &idle_done);
+        btstack_run_loop_set_timer(&idle_timer, IDLE_MS);
+        btstack_run_loop_add_timer(&idle_timer);
+    }
+}
+
+static void process_ds(btstack_data_source_t * ds, btstack_data_source_callback_type_t callback_type){
+    (void) ds;
+    (void) callback_type;
+    handle_events();
+}
+
+static void process_ts(btstack_timer_source_t * ts){
+    handle_events();
+    btstack_run_loop_set_timer(ts, POLLING_INTERVAL_MS);
+    btstack_run_loop_add_timer(ts);
+}
+
+static void benchmark_run(int polling){
+    pthread_t thread;
+
+    use_polling = polling;
+    btstack_run_loop_init(btstack_run_loop_posix_get_instance());
+
+    if (pipe(pipe_fds) < 0) exit(1);
+    fcntl(pipe_fds[0], F_SETFL, O_NONBLOCK);
+
+    if (use_polling){
+        btstack_run_loop_set_timer_handler(&polling_timer, &process_ts);
+        btstack_run_loop_set_timer(&polling_timer, POLLING_INTERVAL_MS);
+        btstack_run_loop_add_timer(&polling_timer);
+    } else {
+        btstack_run_loop_set_data_source_fd(&data_source, pipe_fds[0]);
+        btstack_run_loop_set_data_source_handler(&data_source, &process_ds);
+        btstack_run_loop_enable_data_source_callbacks(&data_source, DATA_SOURCE_CALLBACK_READ);
+        btstack_run_loop_add_data_source(&data_source);
+    }
+
+    pthread_create(&thread, NULL, &device_thread, NULL);
+    btstack_run_loop_execute();
+}
+
+int main(void){
+    int polling;
+    int status;
+    // run loops cannot be stopped or re-initialized, use one process per run
+    for (polling = 1; polling >= 0; polling--){
+        pid_t pid = fork();
+        if (pid == 0) benchmark_run(polling);
+        waitpid(pid, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status)) return 1;
+    }
+    return 0;
+}
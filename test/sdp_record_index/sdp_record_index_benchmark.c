@@ -0,0 +1,468 @@
+/*
+ * Copyright (C) 2017 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+ 
+/*
+ *  sdp_record_index_benchmark.c
+ *
+ *  Runs ServiceSearch, ServiceAttribute and ServiceSearchAttribute requests from a client against
+ *  the SDP server with NUM_RECORDS registered service records, including continuation requests
+ *  for small MTUs. Requests and responses are passed through the L2CAP interface of sdp_server.c.
+ *
+ *  Build with and without ENABLE_SDP_RECORD_INDEX to compare the index against a linear scan.
+ *  Both variants print the same checksum over all responses as last line.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "btstack_config.h"
+#include "bluetooth_sdp.h"
+#include "btstack_event.h"
+#include "btstack_util.h"
+#include "classic/sdp_server.h"
+#include "classic/sdp_util.h"
+#include "l2cap.h"
+
+#define NUM_RECORDS             100
+#define NUM_VENDOR_ATTRIBUTES   8
+#define NUM_ROUNDS              20
+#define RECORD_SIZE             400
+#define SDP_CID                 0x41
+
+#define SMALL_MTU               48
+#define LARGE_MTU               672
+
+typedef enum {
+    REQUEST_SERVICE_SEARCH,
+    REQUEST_SERVICE_ATTRIBUTE,
+    REQUEST_SERVICE_SEARCH_ATTRIBUTE,
+    NUM_REQUEST_TYPES
+} request_type_t;
+
+static const char * request_type_names[] = { "ServiceSearch", "ServiceAttribute", "ServiceSearchAttribute" };
+
+static const uint16_t service_classes[] = {
+    BLUETOOTH_SERVICE_CLASS_SERIAL_PORT,
+    BLUETOOTH_SERVICE_CLASS_HANDSFREE,
+    BLUETOOTH_SERVICE_CLASS_HANDSFREE_AUDIO_GATEWAY,
+    BLUETOOTH_SERVICE_CLASS_HEADSET,
+    BLUETOOTH_SERVICE_CLASS_AUDIO_SOURCE,
+    BLUETOOTH_SERVICE_CLASS_AV_REMOTE_CONTROL,
+    BLUETOOTH_SERVICE_CLASS_PANU,
+    BLUETOOTH_SERVICE_CLASS_HUMAN_INTERFACE_DEVICE_SERVICE,
+};
+#define NUM_SERVICE_CLASSES (sizeof(service_classes) / sizeof(service_classes[0]))
+
+static uint8_t  records[NUM_RECORDS][RECORD_SIZE];
+static uint32_t record_handles[NUM_RECORDS];
+
+static btstack_packet_handler_t sdp_packet_handler;
+static uint16_t sdp_remote_mtu;
+static int      sdp_can_send_now_requested;
+static uint8_t  sdp_response[1024];
+static uint16_t sdp_response_len;
+
+static uint8_t  request_params[256];
+static uint16_t request_params_len;
+static uint16_t transaction_id;
+
+static uint32_t checksum = 0x811c9dc5;
+static uint32_t num_requests[NUM_REQUEST_TYPES];
+static uint32_t num_pdus[NUM_REQUEST_TYPES];
+static double   request_s[NUM_REQUEST_TYPES];
+
+// L2CAP interface used by sdp_server.c
+uint8_t l2cap_register_service(btstack_packet_handler_t packet_handler, uint16_t psm, uint16_t mtu, gap_security_level_t security_level){
+    UNUSED(psm);
+    UNUSED(mtu);
+    UNUSED(security_level);
+    sdp_packet_handler = packet_handler;
+    return 0;
+}
+
+void l2cap_accept_connection(uint16_t local_cid){
+    UNUSED(local_cid);
+}
+
+void l2cap_decline_connection(uint16_t local_cid){
+    UNUSED(local_cid);
+}
+
+uint16_t l2cap_get_remote_mtu_for_local_cid(uint16_t local_cid){
+    UNUSED(local_cid);
+    return sdp_remote_mtu;
+}
+
+void l2cap_request_can_send_now_event(uint16_t local_cid){
+    UNUSED(local_cid);
+    sdp_can_send_now_requested = 1;
+}
+
+int l2cap_send(uint16_t local_cid, uint8_t *data, uint16_t len){
+    UNUSED(local_cid);
+    memcpy(sdp_response, data, len);
+    sdp_response_len = len;
+    return 0;
+}
+
+static double now_s(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static void fail(const char * reason){
+    printf("%s\n", reason);
+    exit(1);
+}
+
+// FNV-1a
+static void checksum_update(const uint8_t * data, uint16_t len){
+    uint16_t i;
+    for (i=0;i<len;i++){
+        checksum ^= data[i];
+        checksum *= 16777619;
+    }
+}
+
+static void uuid128_for_index(uint8_t * uuid128, uint16_t index){
+    static const uint8_t vendor_uuid128[] = { 0x00, 0x00, 0x00, 0x00, 0x1a, 0x2b, 0x4c, 0x3d, 0x80, 0x00, 0x00, 0x80, 0x5f, 0x9b, 0x34, 0xfb };
+    memcpy(uuid128, vendor_uuid128, 16);
+    big_endian_store_16(uuid128, 2, index);
+}
+
+static void create_record(uint8_t * record, uint32_t handle, uint16_t index){
+    uint8_t uuid128[16];
+    char    text[24];
+    uint8_t * attribute;
+    uint16_t service_class = service_classes[index % NUM_SERVICE_CLASSES];
+
+    de_create_sequence(record);
+    de_add_number(record, DE_UINT, DE_SIZE_16, BLUETOOTH_ATTRIBUTE_SERVICE_RECORD_HANDLE);
+    de_add_number(record, DE_UINT, DE_SIZE_32, handle);
+
+    // profile class and vendor specific 128-bit UUID
+    de_add_number(record, DE_UINT, DE_SIZE_16, BLUETOOTH_ATTRIBUTE_SERVICE_CLASS_ID_LIST);
+    attribute = de_push_sequence(record);
+    de_add_number(attribute, DE_UUID, DE_SIZE_16, service_class);
+    uuid128_for_index(uuid128, index);
+    de_add_uuid128(attribute, uuid128);
+    de_pop_sequence(record, attribute);
+
+    // L2CAP + RFCOMM
+    de_add_number(record, DE_UINT, DE_SIZE_16, BLUETOOTH_ATTRIBUTE_PROTOCOL_DESCRIPTOR_LIST);
+    attribute = de_push_sequence(record);
+    {
+        uint8_t * l2cap = de_push_sequence(attribute);
+        de_add_number(l2cap, DE_UUID, DE_SIZE_16, BLUETOOTH_PROTOCOL_L2CAP);
+        de_pop_sequence(attribute, l2cap);
+        uint8_t * rfcomm = de_push_sequence(attribute);
+        de_add_number(rfcomm, DE_UUID, DE_SIZE_16, BLUETOOTH_PROTOCOL_RFCOMM);
+        de_add_number(rfcomm, DE_UINT, DE_SIZE_8, 1 + (index % 30));
+        de_pop_sequence(attribute, rfcomm);
+    }
+    de_pop_sequence(record, attribute);
+
+    // public browse group for every second record
+    if ((index & 1) == 0){
+        de_add_number(record, DE_UINT, DE_SIZE_16, BLUETOOTH_ATTRIBUTE_BROWSE_GROUP_LIST);
+        attribute = de_push_sequence(record);
+        de_add_number(attribute, DE_UUID, DE_SIZE_16, BLUETOOTH_ATTRIBUTE_PUBLIC_BROWSE_ROOT);
+        de_pop_sequence(record, attribute);
+    }
+
+    // profile descriptor with 32-bit UUID
+    de_add_number(record, DE_UINT, DE_SIZE_16, BLUETOOTH_ATTRIBUTE_BLUETOOTH_PROFILE_DESCRIPTOR_LIST);
+    attribute = de_push_sequence(record);
+    {
+        uint8_t * profile = de_push_sequence(attribute);
+        de_add_number(profile, DE_UUID, DE_SIZE_32, service_class);
+        de_add_number(profile, DE_UINT, DE_SIZE_16, 0x0102);
+        de_pop_sequence(attribute, profile);
+    }
+    de_pop_sequence(record, attribute);
+
+    // service name
+    snprintf(text, sizeof(text), "Service %04u", index);
+    de_add_number(record, DE_UINT, DE_SIZE_16, 0x0100);
+    de_add_data(record, DE_STRING, strlen(text), (uint8_t *) text);
+
+    // vendor specific attributes
+    int i;
+    for (i = 0; i < NUM_VENDOR_ATTRIBUTES; i++){
+        snprintf(text, sizeof(text), "Vendor value %04u/%u", index, i);
+        de_add_number(record, DE_UINT, DE_SIZE_16, 0x0200 + 2 * i);
+        de_add_data(record, DE_STRING, strlen(text), (uint8_t *) text);
+    }
+    if (de_get_len(record) > RECORD_SIZE) fail("record too large");
+}
+
+// request parameters before continuation state
+static void request_begin(void){
+    request_params_len = 0;
+}
+
+static void request_add_uint16(uint16_t value){
+    big_endian_store_16(request_params, request_params_len, value);
+    request_params_len += 2;
+}
+
+static void request_add_uint32(uint32_t value){
+    big_endian_store_32(request_params, request_params_len, value);
+    request_params_len += 4;
+}
+
+static uint8_t * request_push_sequence(void){
+    uint8_t * sequence = &request_params[request_params_len];
+    de_create_sequence(sequence);
+    return sequence;
+}
+
+static void request_pop_sequence(uint8_t * sequence){
+    request_params_len += de_get_len(sequence);
+}
+
+static void request_add_pattern_uuid16(uint16_t uuid16, uint16_t uuid16_b){
+    uint8_t * pattern = request_push_sequence();
+    de_add_number(pattern, DE_UUID, DE_SIZE_16, uuid16);
+    if (uuid16_b){
+        de_add_number(pattern, DE_UUID, DE_SIZE_16, uuid16_b);
+    }
+    request_pop_sequence(pattern);
+}
+
+static void request_add_pattern_uuid128(const uint8_t * uuid128){
+    uint8_t * pattern = request_push_sequence();
+    de_add_uuid128(pattern, (uint8_t *) uuid128);
+    request_pop_sequence(pattern);
+}
+
+// attribute IDs and ranges (start << 16 | end)
+static void request_add_attribute_list(const uint32_t * attribute_ids, int num_attribute_ids){
+    uint8_t * list = request_push_sequence();
+    int i;
+    for (i = 0; i < num_attribute_ids; i++){
+        if (attribute_ids[i] > 0xffff){
+            de_add_number(list, DE_UINT, DE_SIZE_32, attribute_ids[i]);
+        } else {
+            de_add_number(list, DE_UINT, DE_SIZE_16, attribute_ids[i]);
+        }
+    }
+    request_pop_sequence(list);
+}
+
+// send request and all continuation requests, returns number of PDUs
+static void request_send(request_type_t type, uint16_t mtu){
+    static const uint8_t pdu_ids[] = { SDP_ServiceSearchRequest, SDP_ServiceAttributeRequest, SDP_ServiceSearchAttributeRequest };
+    uint8_t packet[300];
+    uint8_t continuation_state[17];
+    continuation_state[0] = 0;
+    sdp_remote_mtu = mtu;
+
+    double start = now_s();
+    while (1){
+        uint16_t param_len = request_params_len + 1 + continuation_state[0];
+        packet[0] = pdu_ids[type];
+        big_endian_store_16(packet, 1, ++transaction_id);
+        big_endian_store_16(packet, 3, param_len);
+        memcpy(&packet[5], request_params, request_params_len);
+        memcpy(&packet[5 + request_params_len], continuation_state, 1 + continuation_state[0]);
+
+        sdp_response_len = 0;
+        sdp_can_send_now_requested = 0;
+        (*sdp_packet_handler)(L2CAP_DATA_PACKET, SDP_CID, packet, 5 + param_len);
+        if (!sdp_can_send_now_requested) fail("no response");
+        uint8_t event[4] = { L2CAP_EVENT_CAN_SEND_NOW, 2, 0, 0 };
+        little_endian_store_16(event, 2, SDP_CID);
+        (*sdp_packet_handler)(HCI_EVENT_PACKET, SDP_CID, event, sizeof(event));
+        if (sdp_response_len == 0) fail("response not sent");
+        if (sdp_response_len > mtu) fail("response exceeds MTU");
+        checksum_update(sdp_response, sdp_response_len);
+        num_pdus[type]++;
+
+        // locate continuation state
+        uint16_t pos;
+        switch (type){
+            case REQUEST_SERVICE_SEARCH:
+                pos = 9 + 4 * big_endian_read_16(sdp_response, 7);
+                break;
+            default:
+                pos = 7 + big_endian_read_16(sdp_response, 5);
+                break;
+        }
+        if (sdp_response[0] == SDP_ErrorResponse) break;
+        if (pos >= sdp_response_len || sdp_response[pos] > 16) fail("invalid continuation state");
+        memcpy(continuation_state, &sdp_response[pos], 1 + sdp_response[pos]);
+        if (continuation_state[0] == 0) break;
+    }
+    request_s[type] += now_s() - start;
+    num_requests[type]++;
+}
+
+static void service_search(uint16_t mtu){
+    uint8_t uuid128[16];
+    unsigned int i;
+    for (i = 0; i < NUM_SERVICE_CLASSES; i++){
+        request_begin();
+        request_add_pattern_uuid16(service_classes[i], 0);
+        request_add_uint16(0xffff);
+        request_send(REQUEST_SERVICE_SEARCH, mtu);
+    }
+    uint16_t uuids16[] = { BLUETOOTH_ATTRIBUTE_PUBLIC_BROWSE_ROOT, BLUETOOTH_PROTOCOL_L2CAP, BLUETOOTH_SERVICE_CLASS_GENERIC_AUDIO };
+    for (i = 0; i < sizeof(uuids16) / sizeof(uint16_t); i++){
+        request_begin();
+        request_add_pattern_uuid16(uuids16[i], 0);
+        request_add_uint16(0xffff);
+        request_send(REQUEST_SERVICE_SEARCH, mtu);
+    }
+    // two UUIDs and limited service count
+    request_begin();
+    request_add_pattern_uuid16(BLUETOOTH_SERVICE_CLASS_SERIAL_PORT, BLUETOOTH_ATTRIBUTE_PUBLIC_BROWSE_ROOT);
+    request_add_uint16(5);
+    request_send(REQUEST_SERVICE_SEARCH, mtu);
+    // vendor UUIDs
+    for (i = 0; i < NUM_RECORDS; i += 7){
+        uuid128_for_index(uuid128, i);
+        request_begin();
+        request_add_pattern_uuid128(uuid128);
+        request_add_uint16(0xffff);
+        request_send(REQUEST_SERVICE_SEARCH, mtu);
+    }
+}
+
+static void service_attribute(uint16_t mtu){
+    static const uint32_t all_attributes[]   = { 0x0000ffff };
+    static const uint32_t some_attributes[]  = { 0x0001, 0x0004, 0x0100, 0x02040206 };
+    static const uint32_t unordered_attributes[] = { 0x0100, 0x0001, 0x00000004 };
+    int i;
+    for (i = 0; i < NUM_RECORDS; i++){
+        request_begin();
+        request_add_uint32(record_handles[i]);
+        request_add_uint16(0xffff);
+        switch (i % 3){
+            case 0:
+                request_add_attribute_list(all_attributes, 1);
+                break;
+            case 1:
+                request_add_attribute_list(some_attributes, 4);
+                break;
+            default:
+                request_add_attribute_list(unordered_attributes, 3);
+                break;
+        }
+        request_send(REQUEST_SERVICE_ATTRIBUTE, mtu);
+    }
+    // unknown record
+    request_begin();
+    request_add_uint32(0x20000);
+    request_add_uint16(0xffff);
+    request_add_attribute_list(all_attributes, 1);
+    request_send(REQUEST_SERVICE_ATTRIBUTE, mtu);
+}
+
+static void service_search_attribute(uint16_t mtu){
+    static const uint32_t all_attributes[]  = { 0x0000ffff };
+    static const uint32_t some_attributes[] = { 0x0000, 0x0001, 0x0004, 0x0009, 0x0100 };
+    unsigned int i;
+    for (i = 0; i < NUM_SERVICE_CLASSES; i++){
+        request_begin();
+        request_add_pattern_uuid16(service_classes[i], 0);
+        request_add_uint16(0xffff);
+        request_add_attribute_list(all_attributes, 1);
+        request_send(REQUEST_SERVICE_SEARCH_ATTRIBUTE, mtu);
+    }
+    request_begin();
+    request_add_pattern_uuid16(BLUETOOTH_ATTRIBUTE_PUBLIC_BROWSE_ROOT, 0);
+    request_add_uint16(0xffff);
+    request_add_attribute_list(some_attributes, 5);
+    request_send(REQUEST_SERVICE_SEARCH_ATTRIBUTE, mtu);
+}
+
+static void run_requests(void){
+    service_search(SMALL_MTU);
+    service_search(LARGE_MTU);
+    service_attribute(SMALL_MTU);
+    service_attribute(LARGE_MTU);
+    service_search_attribute(SMALL_MTU);
+    service_search_attribute(LARGE_MTU);
+}
+
+int main(void){
+    sdp_init();
+    uint8_t open_event[2] = { L2CAP_EVENT_INCOMING_CONNECTION, 0 };
+    (*sdp_packet_handler)(HCI_EVENT_PACKET, SDP_CID, open_event, sizeof(open_event));
+
+    double start = now_s();
+    int i;
+    for (i = 0; i < NUM_RECORDS; i++){
+        record_handles[i] = sdp_create_service_record_handle();
+        create_record(records[i], record_handles[i], i);
+        if (sdp_register_service(records[i])) fail("register failed");
+    }
+    double register_s = now_s() - start;
+
+#ifdef ENABLE_SDP_RECORD_INDEX
+    printf("SDP record index: ");
+#else
+    printf("Linear scan:      ");
+#endif
+    printf("%u records, register %.1f us per record\n", NUM_RECORDS, register_s * 1e6 / NUM_RECORDS);
+
+    int round;
+    for (round = 0; round < NUM_ROUNDS; round++){
+        run_requests();
+    }
+
+    // unregister and register some records again, changes record order
+    for (i = 0; i < NUM_RECORDS; i += 3){
+        sdp_unregister_service(record_handles[i]);
+    }
+    for (i = 0; i < NUM_RECORDS; i += 6){
+        if (sdp_register_service(records[i])) fail("register failed");
+    }
+    run_requests();
+
+    for (i = 0; i < NUM_REQUEST_TYPES; i++){
+        printf("%-22s: %6u requests, %6u PDUs, %7.2f us per PDU\n", request_type_names[i],
+            num_requests[i], num_pdus[i], request_s[i] * 1e6 / num_pdus[i]);
+    }
+    printf("checksum %08x\n", checksum);
+    return 0;
+}
@@ -0,0 +1,353 @@
+/*
+ * Copyright (C) 2017 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+ 
+/*
+ *  sdp_response_cache_benchmark.c
+ *
+ *  Fetches large service records with ServiceSearchAttribute requests over small MTUs from the SDP server.
+ *  Each request is followed by continuation requests until the response is complete. Requests and
+ *  responses are passed through the L2CAP interface of sdp_server.c.
+ *
+ *  Build with and without ENABLE_SDP_RESPONSE_CACHE to compare cached responses against
+ *  filtering the records again for each continuation request. Both variants print the
+ *  same checksum over the reassembled AttributeLists as last line.
+ *
+ *  Finally, more records are registered until the response for all records exceeds 64 kB,
+ *  which does not fit into the cache and has to be served without it.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "btstack_config.h"
+#include "bluetooth_sdp.h"
+#include "btstack_event.h"
+#include "btstack_util.h"
+#include "classic/sdp_server.h"
+#include "classic/sdp_util.h"
+#include "l2cap.h"
+
+#define NUM_RECORDS             40
+#define NUM_LARGE_RECORDS       120
+#define NUM_VENDOR_ATTRIBUTES   16
+#define NUM_ROUNDS              10
+#define RECORD_SIZE             800
+#define MAX_ATTRIBUTE_LISTS     0x20000
+#define SDP_CID                 0x41
+
+static const uint16_t mtus[] = { 48, 128, 672 };
+#define NUM_MTUS (sizeof(mtus) / sizeof(mtus[0]))
+
+static const uint16_t service_classes[] = {
+    BLUETOOTH_SERVICE_CLASS_SERIAL_PORT,
+    BLUETOOTH_SERVICE_CLASS_HANDSFREE_AUDIO_GATEWAY,
+    BLUETOOTH_SERVICE_CLASS_AUDIO_SOURCE,
+    BLUETOOTH_SERVICE_CLASS_AV_REMOTE_CONTROL_TARGET,
+};
+#define NUM_SERVICE_CLASSES (sizeof(service_classes) / sizeof(service_classes[0]))
+
+static uint8_t  records[NUM_LARGE_RECORDS][RECORD_SIZE];
+
+static btstack_packet_handler_t sdp_packet_handler;
+static uint16_t sdp_remote_mtu;
+static int      sdp_can_send_now_requested;
+static uint8_t  sdp_response[1024];
+static uint16_t sdp_response_len;
+
+static uint8_t  request_params[64];
+static uint16_t request_params_len;
+static uint16_t transaction_id;
+
+static uint8_t  attribute_lists[MAX_ATTRIBUTE_LISTS];
+static uint32_t attribute_lists_len;
+
+static uint32_t checksum = 0x811c9dc5;
+
+// L2CAP interface used by sdp_server.c
+uint8_t l2cap_register_service(btstack_packet_handler_t packet_handler, uint16_t psm, uint16_t mtu, gap_security_level_t security_level){
+    UNUSED(psm);
+    UNUSED(mtu);
+    UNUSED(security_level);
+    sdp_packet_handler = packet_handler;
+    return 0;
+}
+
+void l2cap_accept_connection(uint16_t local_cid){
+    UNUSED(local_cid);
+}
+
+void l2cap_decline_connection(uint16_t local_cid){
+    UNUSED(local_cid);
+}
+
+uint16_t l2cap_get_remote_mtu_for_local_cid(uint16_t local_cid){
+    UNUSED(local_cid);
+    return sdp_remote_mtu;
+}
+
+void l2cap_request_can_send_now_event(uint16_t local_cid){
+    UNUSED(local_cid);
+    sdp_can_send_now_requested = 1;
+}
+
+int l2cap_send(uint16_t local_cid, uint8_t *data, uint16_t len){
+    UNUSED(local_cid);
+    memcpy(sdp_response, data, len);
+    sdp_response_len = len;
+    return 0;
+}
+
+static double cpu_time_s(void){
+    struct timespec now;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static void fail(const char * reason){
+    printf("%s\n", reason);
+    exit(1);
+}
+
+// FNV-1a
+static void checksum_update(const uint8_t * data, uint32_t len){
+    uint32_t i;
+    for (i=0;i<len;i++){
+        checksum ^= data[i];
+        checksum *= 16777619;
+    }
+}
+
+static void create_record(uint8_t * record, uint32_t handle, uint16_t index){
+    char text[40];
+    uint8_t * attribute;
+    uint16_t service_class = service_classes[index % NUM_SERVICE_CLASSES];
+
+    de_create_sequence(record);
+    de_add_number(record, DE_UINT, DE_SIZE_16, BLUETOOTH_ATTRIBUTE_SERVICE_RECORD_HANDLE);
+    de_add_number(record, DE_UINT, DE_SIZE_32, handle);
+
+    de_add_number(record, DE_UINT, DE_SIZE_16, BLUETOOTH_ATTRIBUTE_SERVICE_CLASS_ID_LIST);
+    attribute = de_push_sequence(record);
+    de_add_number(attribute, DE_UUID, DE_SIZE_16, service_class);
+    de_pop_sequence(record, attribute);
+
+    de_add_number(record, DE_UINT, DE_SIZE_16, BLUETOOTH_ATTRIBUTE_PROTOCOL_DESCRIPTOR_LIST);
+    attribute = de_push_sequence(record);
+    {
+        uint8_t * l2cap = de_push_sequence(attribute);
+        de_add_number(l2cap, DE_UUID, DE_SIZE_16, BLUETOOTH_PROTOCOL_L2CAP);
+        de_pop_sequence(attribute, l2cap);
+        uint8_t * rfcomm = de_push_sequence(attribute);
+        de_add_number(rfcomm, DE_UUID, DE_SIZE_16, BLUETOOTH_PROTOCOL_RFCOMM);
+        de_add_number(rfcomm, DE_UINT, DE_SIZE_8, 1 + (index % 30));
+        de_pop_sequence(attribute, rfcomm);
+    }
+    de_pop_sequence(record, attribute);
+
+    de_add_number(record, DE_UINT, DE_SIZE_16, BLUETOOTH_ATTRIBUTE_BROWSE_GROUP_LIST);
+    attribute = de_push_sequence(record);
+    de_add_number(attribute, DE_UUID, DE_SIZE_16, BLUETOOTH_ATTRIBUTE_PUBLIC_BROWSE_ROOT);
+    de_pop_sequence(record, attribute);
+
+    snprintf(text, sizeof(text), "Service %04u", index);
+    de_add_number(record, DE_UINT, DE_SIZE_16, 0x0100);
+    de_add_data(record, DE_STRING, strlen(text), (uint8_t *) text);
+
+    // vendor specific attributes make the record large
+    int i;
+    for (i = 0; i < NUM_VENDOR_ATTRIBUTES; i++){
+        snprintf(text, sizeof(text), "Vendor specific value %04u/%02u", index, i);
+        de_add_number(record, DE_UINT, DE_SIZE_16, 0x0200 + i);
+        de_add_data(record, DE_STRING, strlen(text), (uint8_t *) text);
+    }
+    if (de_get_len(record) > RECORD_SIZE) fail("record too large");
+}
+
+static void register_record(uint16_t index){
+    uint32_t handle = sdp_create_service_record_handle();
+    create_record(records[index], handle, index);
+    if (sdp_register_service(records[index])) fail("register failed");
+}
+
+// ServiceSearchPattern with uuid16, MaximumAttributeByteCount, AttributeIDList with all attributes
+static void request_create(uint16_t uuid16){
+    uint8_t * pattern = request_params;
+    de_create_sequence(pattern);
+    de_add_number(pattern, DE_UUID, DE_SIZE_16, uuid16);
+    request_params_len = de_get_len(pattern);
+    big_endian_store_16(request_params, request_params_len, 0xffff);
+    request_params_len += 2;
+    uint8_t * attribute_id_list = &request_params[request_params_len];
+    de_create_sequence(attribute_id_list);
+    de_add_number(attribute_id_list, DE_UINT, DE_SIZE_32, 0x0000ffff);
+    request_params_len += de_get_len(attribute_id_list);
+}
+
+// send request with continuation state, returns continuation state length
+static uint8_t request_send(uint8_t * continuation_state, uint16_t mtu){
+    uint8_t packet[100];
+    uint16_t param_len = request_params_len + 1 + continuation_state[0];
+    packet[0] = SDP_ServiceSearchAttributeRequest;
+    big_endian_store_16(packet, 1, ++transaction_id);
+    big_endian_store_16(packet, 3, param_len);
+    memcpy(&packet[5], request_params, request_params_len);
+    memcpy(&packet[5 + request_params_len], continuation_state, 1 + continuation_state[0]);
+
+    sdp_remote_mtu = mtu;
+    sdp_response_len = 0;
+    sdp_can_send_now_requested = 0;
+    (*sdp_packet_handler)(L2CAP_DATA_PACKET, SDP_CID, packet, 5 + param_len);
+    if (!sdp_can_send_now_requested) fail("no response");
+    uint8_t event[4] = { L2CAP_EVENT_CAN_SEND_NOW, 2, 0, 0 };
+    little_endian_store_16(event, 2, SDP_CID);
+    (*sdp_packet_handler)(HCI_EVENT_PACKET, SDP_CID, event, sizeof(event));
+    if (sdp_response_len == 0) fail("response not sent");
+    if (sdp_response_len > mtu) fail("response exceeds MTU");
+    if (sdp_response[0] == SDP_ErrorResponse) return 0xff;
+
+    uint16_t attribute_lists_byte_count = big_endian_read_16(sdp_response, 5);
+    uint16_t pos = 7 + attribute_lists_byte_count;
+    if (pos >= sdp_response_len || sdp_response[pos] > 16) fail("invalid continuation state");
+    if (attribute_lists_len + attribute_lists_byte_count > MAX_ATTRIBUTE_LISTS) fail("response too large");
+    memcpy(&attribute_lists[attribute_lists_len], &sdp_response[7], attribute_lists_byte_count);
+    attribute_lists_len += attribute_lists_byte_count;
+    memcpy(continuation_state, &sdp_response[pos], 1 + sdp_response[pos]);
+    return continuation_state[0];
+}
+
+// fetch all PDUs of response, returns number of PDUs
+static uint32_t fetch_attribute_lists(uint16_t uuid16, uint16_t mtu){
+    uint8_t continuation_state[17];
+    continuation_state[0] = 0;
+    attribute_lists_len = 0;
+    uint32_t num_pdus = 0;
+    request_create(uuid16);
+    do {
+        num_pdus++;
+    } while (request_send(continuation_state, mtu) != 0);
+    checksum_update(attribute_lists, attribute_lists_len);
+    return num_pdus;
+}
+
+// fetch complete response, returns number of PDUs
+static uint32_t fetch(uint16_t uuid16, uint16_t mtu){
+    uint32_t num_pdus = fetch_attribute_lists(uuid16, mtu);
+    if (attribute_lists_len != de_get_len(attribute_lists)) fail("incomplete response");
+    return num_pdus;
+}
+
+static void benchmark(const char * name, uint16_t uuid16){
+    unsigned int i;
+    for (i = 0; i < NUM_MTUS; i++){
+        uint32_t num_pdus = 0;
+        double start = cpu_time_s();
+        int round;
+        for (round = 0; round < NUM_ROUNDS; round++){
+            num_pdus += fetch(uuid16, mtus[i]);
+        }
+        double request_s = (cpu_time_s() - start) / NUM_ROUNDS;
+        printf("%-14s MTU %3u: %5u bytes in %4u PDUs, %8.1f us CPU time per request, %6.2f us per PDU\n",
+            name, mtus[i], attribute_lists_len, num_pdus / NUM_ROUNDS, request_s * 1e6, request_s * 1e6 * NUM_ROUNDS / num_pdus);
+    }
+}
+
+#ifdef ENABLE_SDP_RESPONSE_CACHE
+// records registered during a transfer invalidate the continuation state
+static void test_invalidation(void){
+    uint8_t continuation_state[17];
+    continuation_state[0] = 0;
+    attribute_lists_len = 0;
+    request_create(BLUETOOTH_ATTRIBUTE_PUBLIC_BROWSE_ROOT);
+    if (request_send(continuation_state, mtus[0]) == 0) fail("response not fragmented");
+    register_record(NUM_RECORDS);
+    if (request_send(continuation_state, mtus[0]) != 0xff) fail("continuation state not invalidated");
+    printf("continuation state invalidated by sdp_register_service\n");
+}
+#endif
+
+// AttributeLists above 64 kB cannot be cached, length of outer DES is truncated to 16 bit
+static void test_large_response(void){
+    uint16_t i;
+    for (i = NUM_RECORDS + 1; i < NUM_LARGE_RECORDS; i++){
+        register_record(i);
+    }
+    uint32_t expected_len = 3;
+    for (i = 0; i < NUM_LARGE_RECORDS; i++){
+        expected_len += de_get_len(records[i]);
+    }
+    if (expected_len <= 0xffff) fail("response not larger than 64 kB");
+    uint32_t num_pdus = fetch_attribute_lists(BLUETOOTH_ATTRIBUTE_PUBLIC_BROWSE_ROOT, mtus[NUM_MTUS - 1]);
+    if (attribute_lists_len != expected_len) fail("incomplete large response");
+    printf("%u records: %u bytes in %u PDUs\n", NUM_LARGE_RECORDS, attribute_lists_len, num_pdus);
+}
+
+int main(void){
+    sdp_init();
+    uint8_t open_event[2] = { L2CAP_EVENT_INCOMING_CONNECTION, 0 };
+    (*sdp_packet_handler)(HCI_EVENT_PACKET, SDP_CID, open_event, sizeof(open_event));
+
+    int i;
+    for (i = 0; i < NUM_RECORDS; i++){
+        register_record(i);
+    }
+
+#ifdef ENABLE_SDP_RESPONSE_CACHE
+    printf("SDP response cache: ");
+#else
+    printf("No cache:           ");
+#endif
+    printf("%u records with %u bytes, %u rounds\n", NUM_RECORDS, de_get_len(records[0]), NUM_ROUNDS);
+
+    benchmark("all records", BLUETOOTH_ATTRIBUTE_PUBLIC_BROWSE_ROOT);
+    benchmark("serial port", BLUETOOTH_SERVICE_CLASS_SERIAL_PORT);
+
+#ifdef ENABLE_SDP_RESPONSE_CACHE
+    test_invalidation();
+#else
+    register_record(NUM_RECORDS);
+#endif
+
+    // responses after registration contain the new record
+    fetch(BLUETOOTH_ATTRIBUTE_PUBLIC_BROWSE_ROOT, mtus[0]);
+
+    test_large_response();
+    printf("checksum %08x\n", checksum);
+    return 0;
+}
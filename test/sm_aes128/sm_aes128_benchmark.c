@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2017 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+/*
+ *  sm_aes128_benchmark.c
+ *
+ *  Runs the AES-CMAC calculations of the Security Manager with the controller (HCI LE Encrypt)
+ *  and with the host AES-128 engine. The controller is simulated with a fixed round trip time
+ *  per HCI command. Reports the time for the CMACs of an LE Secure Connections pairing
+ *  (f4, g2, f5 (3x), f6 (2x)) and the throughput of ATT Signed Write verification.
+ *
+ *  HCI and L2CAP are replaced by the stubs in sm_benchmark_hci.c
+ *
+ *  The AES-NI build exits without running if the CPU does not support AES-NI.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "btstack_config.h"
+#include "btstack_aes128.h"
+#include "btstack_debug.h"
+#include "btstack_event.h"
+#include "btstack_memory.h"
+#include "btstack_util.h"
+#include "ble/le_device_db.h"
+#include "ble/sm.h"
+#include "gap.h"
+#include "hci.h"
+#include "hci_dump.h"
+#include "l2cap.h"
+
+#include "sm_benchmark_hci.h"
+
+#define NUM_PAIRINGS          20
+#define NUM_SIGNED_WRITES   2000
+
+// message length of CMACs for LE Secure Connections pairing: f4, g2, f5 salt, f5 mackey, f5 ltk, f6, f6
+static const uint16_t pairing_cmac_lengths[] = { 65, 81, 32, 53, 53, 65, 65 };
+
+static uint8_t  cmac_message[128];
+static uint8_t  signed_write_value[20];
+static int      cmac_done;
+static uint8_t  cmac_hash[16];
+
+static uint8_t cmac_get_byte(uint16_t offset){
+    return cmac_message[offset];
+}
+
+static void cmac_done_handler(uint8_t * hash){
+    memcpy(cmac_hash, hash, 16);
+    cmac_done = 1;
+}
+
+static void cmac_run(uint16_t message_len){
+    static const sm_key_t key = { 0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c };
+    cmac_done = 0;
+    sm_cmac_general_start(key, message_len, &cmac_get_byte, &cmac_done_handler);
+    controller_process();
+    if (!cmac_done){
+        printf("CMAC not completed\n");
+        exit(1);
+    }
+}
+
+static void signed_write_run(uint32_t counter){
+    static const sm_key_t csrk = { 0x4c, 0x68, 0x38, 0x41, 0x39, 0xf5, 0x74, 0xd8, 0x36, 0xbc, 0xf3, 0x4e, 0x9d, 0xfb, 0x01, 0xbf };
+    cmac_done = 0;
+    sm_cmac_signed_write_start(csrk, ATT_SIGNED_WRITE_COMMAND, 0x0010, sizeof(signed_write_value), signed_write_value, counter, &cmac_done_handler);
+    controller_process();
+    if (!cmac_done){
+        printf("Signed Write CMAC not completed\n");
+        exit(1);
+    }
+}
+
+// verify CMAC against RFC 4493 test vector, message length 40
+static void verify_cmac(void){
+    static const uint8_t expected[] = { 0xdf, 0xa6, 0x67, 0x47, 0xde, 0x9a, 0xe6, 0x30, 0x30, 0xca, 0x32, 0x61, 0x14, 0x97, 0xc8, 0x27 };
+    static const uint8_t message[] = {
+        0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a,
+        0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c, 0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51,
+        0x30, 0xc8, 0x1c, 0x46, 0xa3, 0x5c, 0xe4, 0x11 };
+    memcpy(cmac_message, message, sizeof(message));
+    cmac_run(sizeof(message));
+    if (memcmp(cmac_hash, expected, 16) != 0){
+        printf("CMAC test vector failed\n");
+        exit(1);
+    }
+}
+
+static void benchmark_run(const char * name, void (*aes128_calc)(const uint8_t * key, const uint8_t * plaintext, uint8_t * result), uint32_t round_trip_us){
+    int i;
+    unsigned int j;
+    sm_set_aes128_engine(aes128_calc);
+    controller_round_trip_us = round_trip_us;
+
+    verify_cmac();
+    for (i = 0; i < (int) sizeof(cmac_message); i++){
+        cmac_message[i] = i;
+    }
+
+    controller_num_commands = 0;
+    uint64_t start_ns = benchmark_now_ns();
+    for (i = 0; i < NUM_PAIRINGS; i++){
+        for (j = 0; j < sizeof(pairing_cmac_lengths) / sizeof(uint16_t); j++){
+            cmac_run(pairing_cmac_lengths[j]);
+        }
+    }
+    double pairing_ms = (benchmark_now_ns() - start_ns) / 1e6 / NUM_PAIRINGS;
+    uint32_t pairing_commands = controller_num_commands / NUM_PAIRINGS;
+
+    start_ns = benchmark_now_ns();
+    for (i = 0; i < NUM_SIGNED_WRITES; i++){
+        signed_write_run(i);
+    }
+    double signed_writes_per_s = NUM_SIGNED_WRITES * 1e9 / (benchmark_now_ns() - start_ns);
+
+    printf("%-24s SC pairing CMACs %8.3f ms (%2u HCI commands), signed write verification %9.0f/s\n",
+        name, pairing_ms, pairing_commands, signed_writes_per_s);
+}
+
+int main(void){
+#if BTSTACK_AES128_AESNI
+    if (!__builtin_cpu_supports("aes")){
+        printf("AES-NI not supported by CPU, skipped\n");
+        return 0;
+    }
+#endif
+    hci_dump_enable_log_level(LOG_LEVEL_INFO, 0);
+    hci_dump_enable_log_level(LOG_LEVEL_ERROR, 0);
+    btstack_memory_init();
+    le_device_db_init();
+    sm_init();
+
+    controller_start();
+
+    benchmark_run("controller,    0 us RTT", NULL, 0);
+    benchmark_run("controller,  250 us RTT", NULL, 250);
+    benchmark_run("controller, 1000 us RTT", NULL, 1000);
+#if BTSTACK_AES128_AESNI
+    benchmark_run("host, AES-NI", &btstack_aes128_host_calc, 0);
+#else
+    benchmark_run("host, table", &btstack_aes128_host_calc, 0);
+#endif
+    return 0;
+}
@@ -0,0 +1,204 @@
+/*
+ * Copyright (C) 2017 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+/*
+ *  sm_benchmark_hci.c
+ *
+ *  Simulated controller for the Security Manager benchmarks. Handles one HCI command at a time
+ *  and completes it after a fixed round trip time. LE Encrypt is calculated with btstack_aes128.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "btstack_aes128.h"
+#include "btstack_debug.h"
+#include "btstack_event.h"
+#include "btstack_util.h"
+#include "gap.h"
+#include "hci.h"
+#include "l2cap.h"
+
+#include "sm_benchmark_hci.h"
+
+static btstack_packet_handler_t sm_event_handler;
+
+// simulated controller: one command in flight, completed after round trip time
+uint32_t controller_round_trip_us;
+uint32_t controller_num_commands;
+static uint8_t  controller_event[6 + 16];
+static uint16_t controller_event_size;
+static uint64_t controller_event_due_ns;
+static int      controller_event_pending;
+
+uint64_t benchmark_now_ns(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+void controller_process(void){
+    while (controller_event_pending){
+        while (benchmark_now_ns() < controller_event_due_ns);
+        controller_event_pending = 0;
+        (*sm_event_handler)(HCI_EVENT_PACKET, 0, controller_event, controller_event_size);
+    }
+}
+
+void controller_start(void){
+    uint8_t state_event[] = { BTSTACK_EVENT_STATE, 1, HCI_STATE_WORKING };
+    (*sm_event_handler)(HCI_EVENT_PACKET, 0, state_event, sizeof(state_event));
+    controller_process();
+}
+
+// stubs for HCI and L2CAP
+
+int hci_send_cmd_packet(uint8_t *packet, int size){
+    UNUSED(size);
+    uint16_t opcode = little_endian_read_16(packet, 0);
+    controller_num_commands++;
+    controller_event[0] = HCI_EVENT_COMMAND_COMPLETE;
+    controller_event[2] = 1;
+    little_endian_store_16(controller_event, 3, opcode);
+    controller_event[5] = ERROR_CODE_SUCCESS;
+    controller_event_size = 6;
+    if (opcode == hci_le_encrypt.opcode){
+        // key and plaintext are little endian
+        uint8_t key[16];
+        uint8_t plaintext[16];
+        uint8_t result[16];
+        reverse_128(&packet[3], key);
+        reverse_128(&packet[19], plaintext);
+        btstack_aes128_host_calc(key, plaintext, result);
+        reverse_128(result, &controller_event[6]);
+        controller_event_size += 16;
+    } else if (opcode == hci_le_rand.opcode){
+        memset(&controller_event[6], 0x55, 8);
+        controller_event_size += 8;
+    }
+    controller_event[1] = controller_event_size - 2;
+    controller_event_due_ns = benchmark_now_ns() + controller_round_trip_us * 1000ull;
+    controller_event_pending = 1;
+    return 0;
+}
+
+uint8_t * hci_reserve_cmd_packet_buffer(uint16_t opcode){
+    UNUSED(opcode);
+    static uint8_t packet[HCI_CMD_HEADER_SIZE + 255];
+    return packet;
+}
+
+int hci_send_cmd(const hci_cmd_t *cmd, ...){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(cmd->opcode);
+    va_list argptr;
+    va_start(argptr, cmd);
+    uint16_t size = hci_cmd_create_from_template(packet, cmd, argptr);
+    va_end(argptr);
+    return hci_send_cmd_packet(packet, size);
+}
+
+int hci_can_send_command_packet_now(void){
+    return !controller_event_pending;
+}
+
+HCI_STATE hci_get_state(void){
+    return HCI_STATE_WORKING;
+}
+
+void hci_add_event_handler(btstack_packet_callback_registration_t * callback_handler){
+    sm_event_handler = callback_handler->callback;
+}
+
+void hci_connections_get_iterator(btstack_linked_list_iterator_t *it){
+    static btstack_linked_list_t connections;
+    btstack_linked_list_iterator_init(it, &connections);
+}
+
+hci_connection_t * hci_connection_for_handle(hci_con_handle_t con_handle){
+    UNUSED(con_handle);
+    return NULL;
+}
+
+void hci_le_advertisements_set_params(uint16_t adv_int_min, uint16_t adv_int_max, uint8_t adv_type,
+    uint8_t direct_address_typ, bd_addr_t direct_address, uint8_t channel_map, uint8_t filter_policy){
+    UNUSED(adv_int_min);
+    UNUSED(adv_int_max);
+    UNUSED(adv_type);
+    UNUSED(direct_address_typ);
+    (void) direct_address;
+    UNUSED(channel_map);
+    UNUSED(filter_policy);
+}
+
+void hci_le_set_own_address_type(uint8_t own_address_type){
+    UNUSED(own_address_type);
+}
+
+void gap_local_bd_addr(bd_addr_t address_buffer){
+    memset(address_buffer, 0x11, 6);
+}
+
+void gap_le_get_own_address(uint8_t * addr_type, bd_addr_t addr){
+    *addr_type = 0;
+    memset(addr, 0x11, 6);
+}
+
+void l2cap_register_fixed_channel(btstack_packet_handler_t packet_handler, uint16_t channel_id){
+    UNUSED(packet_handler);
+    UNUSED(channel_id);
+}
+
+int l2cap_can_send_fixed_channel_packet_now(hci_con_handle_t con_handle, uint16_t channel_id){
+    UNUSED(con_handle);
+    UNUSED(channel_id);
+    return 1;
+}
+
+void l2cap_request_can_send_fix_channel_now_event(hci_con_handle_t con_handle, uint16_t channel_id){
+    UNUSED(con_handle);
+    UNUSED(channel_id);
+}
+
+int l2cap_send_connectionless(hci_con_handle_t con_handle, uint16_t cid, uint8_t *data, uint16_t len){
+    UNUSED(con_handle);
+    UNUSED(cid);
+    UNUSED(data);
+    UNUSED(len);
+    return 0;
+}
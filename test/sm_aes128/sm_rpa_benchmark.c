@@ -0,0 +1,224 @@
+/*
+ * Copyright (C) 2017 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+/*
+ *  sm_rpa_benchmark.c
+ *
+ *  Resolves advertised resolvable private addresses against LE Device DBs of different sizes,
+ *  using the controller (HCI LE Encrypt, simulated round trip time) or the host AES-128 engine.
+ *  Half of the advertisements are sent by 8 bonded devices, the others use random addresses
+ *  of unknown devices. Reports the time per resolution and the resulting CPU load for different
+ *  advertisement rates. For the controller, the load is the time the resolution is busy.
+ *
+ *  HCI and L2CAP are replaced by the stubs in sm_benchmark_hci.c
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "btstack_config.h"
+#include "btstack_aes128.h"
+#include "btstack_debug.h"
+#include "btstack_event.h"
+#include "btstack_memory.h"
+#include "btstack_util.h"
+#include "ble/le_device_db.h"
+#include "ble/sm.h"
+#include "hci.h"
+#include "hci_dump.h"
+
+#include "sm_benchmark_hci.h"
+
+// same as default SM_RPA_CACHE_SIZE
+#define NUM_BONDED_ADVERTISERS 8
+
+static const int db_sizes[] = { 16, 64, 256 };
+static const int advertisement_rates[] = { 100, 1000, 10000 };
+
+static btstack_packet_callback_registration_t sm_event_callback_registration;
+static int resolving_done;
+static int resolving_index;
+
+static bd_addr_t bonded_advertiser_addresses[NUM_BONDED_ADVERTISERS];
+static int       bonded_advertiser_index[NUM_BONDED_ADVERTISERS];
+
+static void sm_packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size){
+    UNUSED(channel);
+    UNUSED(size);
+    if (packet_type != HCI_EVENT_PACKET) return;
+    switch (hci_event_packet_get_type(packet)){
+        case SM_EVENT_IDENTITY_RESOLVING_SUCCEEDED:
+            // le device db index is stored in a single byte
+            resolving_index = packet[18];
+            resolving_done = 1;
+            break;
+        case SM_EVENT_IDENTITY_RESOLVING_FAILED:
+            resolving_index = -1;
+            resolving_done = 1;
+            break;
+        default:
+            break;
+    }
+}
+
+static void random_bytes(uint8_t * buffer, int len){
+    int i;
+    for (i = 0; i < len; i++){
+        buffer[i] = rand() & 0xff;
+    }
+}
+
+// rpa = hash(irk, prand) || prand
+static void create_rpa(const sm_key_t irk, bd_addr_t rpa){
+    sm_key_t r_prime;
+    sm_key_t result;
+    random_bytes(rpa, 3);
+    rpa[0] = (rpa[0] & 0x3f) | 0x40;
+    memset(r_prime, 0, 16);
+    memcpy(&r_prime[13], rpa, 3);
+    btstack_aes128_host_calc(irk, r_prime, result);
+    memcpy(&rpa[3], &result[13], 3);
+}
+
+static void db_setup(int db_size){
+    int i;
+    le_device_db_init();
+    for (i = 0; i < MAX_NR_LE_DEVICE_DB_ENTRIES; i++){
+        le_device_db_remove(i);
+    }
+    for (i = 0; i < db_size; i++){
+        bd_addr_t addr;
+        sm_key_t irk;
+        random_bytes(addr, 6);
+        random_bytes(irk, 16);
+        le_device_db_add(BD_ADDR_TYPE_LE_PUBLIC, addr, irk);
+    }
+    // bonded advertisers are spread over the database
+    for (i = 0; i < NUM_BONDED_ADVERTISERS; i++){
+        sm_key_t irk;
+        bonded_advertiser_index[i] = (i * db_size) / NUM_BONDED_ADVERTISERS;
+        le_device_db_info(bonded_advertiser_index[i], NULL, NULL, irk);
+        create_rpa(irk, bonded_advertiser_addresses[i]);
+    }
+}
+
+static void advertisement_address(int advertisement, bd_addr_t address){
+    if (advertisement & 1){
+        memcpy(address, bonded_advertiser_addresses[(advertisement >> 1) % NUM_BONDED_ADVERTISERS], 6);
+    } else {
+        random_bytes(address, 6);
+        address[0] = (address[0] & 0x3f) | 0x40;
+    }
+}
+
+// random addresses of unknown devices might match an IRK by chance
+static int resolved_correctly(int advertisement, int index){
+    if ((advertisement & 1) == 0) return 1;
+    return index == bonded_advertiser_index[(advertisement >> 1) % NUM_BONDED_ADVERTISERS];
+}
+
+static int expected_index(int advertisement){
+    if ((advertisement & 1) == 0) return -1;
+    return bonded_advertiser_index[(advertisement >> 1) % NUM_BONDED_ADVERTISERS];
+}
+
+static void resolve_with_events(int advertisement){
+    bd_addr_t address;
+    advertisement_address(advertisement, address);
+    resolving_done = 0;
+    sm_address_resolution_lookup(BD_ADDR_TYPE_LE_RANDOM, address);
+    controller_process();
+    if (!resolving_done || !resolved_correctly(advertisement, resolving_index)){
+        printf("Advertisement %d: resolved to %d, expected %d\n", advertisement, resolving_index, expected_index(advertisement));
+        exit(1);
+    }
+}
+
+static void resolve_direct(int advertisement){
+    bd_addr_t address;
+    advertisement_address(advertisement, address);
+    int index = sm_resolve_rpa(address);
+    if (!resolved_correctly(advertisement, index)){
+        printf("Advertisement %d: sm_resolve_rpa returned %d, expected %d\n", advertisement, index, expected_index(advertisement));
+        exit(1);
+    }
+}
+
+static void benchmark_run(const char * name, void (*aes128_calc)(const uint8_t * key, const uint8_t * plaintext, uint8_t * result),
+    uint32_t round_trip_us, void (*resolve)(int advertisement), int num_advertisements){
+    unsigned int i;
+    int j;
+    sm_set_aes128_engine(aes128_calc);
+    controller_round_trip_us = round_trip_us;
+    for (i = 0; i < sizeof(db_sizes) / sizeof(int); i++){
+        db_setup(db_sizes[i]);
+        uint64_t start_ns = benchmark_now_ns();
+        for (j = 0; j < num_advertisements; j++){
+            (*resolve)(j);
+        }
+        double resolution_us = (benchmark_now_ns() - start_ns) / 1e3 / num_advertisements;
+        printf("%-28s %3u devices: %9.2f us/advertisement, load at", name, db_sizes[i], resolution_us);
+        for (j = 0; j < (int) (sizeof(advertisement_rates) / sizeof(int)); j++){
+            double load = advertisement_rates[j] * resolution_us / 1e4;
+            if (load > 100.0){
+                printf(" %5u/s:  >100%%", advertisement_rates[j]);
+            } else {
+                printf(" %5u/s: %5.1f%%", advertisement_rates[j], load);
+            }
+        }
+        printf("\n");
+    }
+}
+
+int main(void){
+    hci_dump_enable_log_level(LOG_LEVEL_INFO, 0);
+    hci_dump_enable_log_level(LOG_LEVEL_ERROR, 0);
+    btstack_memory_init();
+    le_device_db_init();
+    sm_init();
+    sm_event_callback_registration.callback = &sm_packet_handler;
+    sm_add_event_handler(&sm_event_callback_registration);
+    controller_start();
+    srand(0);
+
+    benchmark_run("controller, 0 us RTT",   NULL, 0,   &resolve_with_events, 200);
+    benchmark_run("controller, 250 us RTT", NULL, 250, &resolve_with_events, 50);
+    benchmark_run("host, events",           &btstack_aes128_host_calc, 0, &resolve_with_events, 20000);
+    benchmark_run("host, sm_resolve_rpa",   &btstack_aes128_host_calc, 0, &resolve_direct, 20000);
+    return 0;
+}
@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2017 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+/*
+ *  btstack_ring_buffer_spsc_test.c
+ *
+ *  Stress test for lock-free SPSC ring buffer: producer thread writes a pseudo-random byte stream
+ *  in chunks of random size, alternating between copy and in-place write, the consumer verifies it.
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "btstack_ring_buffer_spsc.h"
+
+#define RING_BUFFER_SIZE    4096
+#define TOTAL_BYTES         (256 * 1024 * 1024)
+#define MAX_CHUNK           3000
+
+static btstack_ring_buffer_spsc_t ring_buffer;
+static uint8_t ring_buffer_storage[RING_BUFFER_SIZE];
+static uint32_t producer_waits;
+static uint32_t consumer_waits;
+
+static inline uint8_t stream_byte(uint32_t pos){
+    return (uint8_t) (pos ^ (pos >> 8) ^ (pos >> 17));
+}
+
+static uint32_t next_random(uint32_t * state){
+    *state = *state * 1103515245 + 12345;
+    return *state >> 8;
+}
+
+static double now_s(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static void * producer(void * context){
+    (void) context;
+    uint8_t chunk[MAX_CHUNK];
+    uint32_t random_state = 1;
+    uint32_t pos = 0;
+    int in_place = 0;
+    while (pos < TOTAL_BYTES){
+        uint32_t len = 1 + next_random(&random_state) % MAX_CHUNK;
+        if (len > TOTAL_BYTES - pos) len = TOTAL_BYTES - pos;
+        in_place = !in_place;
+        if (in_place){
+            // write directly into ring buffer, up to contiguous space
+            uint32_t contiguous;
+            uint8_t * buffer = btstack_ring_buffer_spsc_get_write_pointer(&ring_buffer, &contiguous);
+            if (contiguous == 0){
+                producer_waits++;
+                sched_yield();
+                continue;
+            }
+            if (len > contiguous) len = contiguous;
+            uint32_t i;
+            for (i = 0; i < len; i++){
+                buffer[i] = stream_byte(pos + i);
+            }
+            btstack_ring_buffer_spsc_commit_write(&ring_buffer, len);
+        } else {
+            uint32_t i;
+            for (i = 0; i < len; i++){
+                chunk[i] = stream_byte(pos + i);
+            }
+            while (btstack_ring_buffer_spsc_write(&ring_buffer, chunk, len)){
+                producer_waits++;
+                sched_yield();
+            }
+        }
+        pos += len;
+    }
+    return NULL;
+}
+
+int main(void){
+    if (btstack_ring_buffer_spsc_init(&ring_buffer, ring_buffer_storage, 1000) == 0){
+        printf("init should reject size that is not a power of two\n");
+        return 1;
+    }
+    btstack_ring_buffer_spsc_init(&ring_buffer, ring_buffer_storage, sizeof(ring_buffer_storage));
+
+    double start = now_s();
+    pthread_t thread;
+    pthread_create(&thread, NULL, &producer, NULL);
+
+    uint8_t chunk[MAX_CHUNK];
+    uint32_t random_state = 2;
+    uint32_t pos = 0;
+    while (pos < TOTAL_BYTES){
+        uint32_t len = 1 + next_random(&random_state) % MAX_CHUNK;
+        uint32_t bytes_read;
+        btstack_ring_buffer_spsc_read(&ring_buffer, chunk, len, &bytes_read);
+        if (bytes_read == 0){
+            consumer_waits++;
+            sched_yield();
+            continue;
+        }
+        uint32_t i;
+        for (i = 0; i < bytes_read; i++){
+            if (chunk[i] != stream_byte(pos + i)){
+                printf("data mismatch at %u\n", pos + i);
+                return 1;
+            }
+        }
+        pos += bytes_read;
+    }
+    pthread_join(thread, NULL);
+    double elapsed = now_s() - start;
+
+    if (btstack_ring_buffer_spsc_bytes_available(&ring_buffer) != 0 || btstack_ring_buffer_spsc_bytes_free(&ring_buffer) != RING_BUFFER_SIZE){
+        printf("ring buffer not empty at end\n");
+        return 1;
+    }
+    printf("SPSC ring buffer %u bytes: %u MB verified, %.0f MB/s, producer waits %u, consumer waits %u\n",
+        RING_BUFFER_SIZE, TOTAL_BYTES >> 20, TOTAL_BYTES / elapsed / 1e6, producer_waits, consumer_waits);
+    return 0;
+}
@@ -0,0 +1,242 @@
+/*
+ * Copyright (C) 2017 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+/*
+ *  uart_reader_test.c
+ *
+ *  Receive a byte stream over a pty pair with btstack_uart_block_posix while the block handler
+ *  regularly blocks the run loop, e.g. like SBC decoding in an A2DP Sink. A forked sender writes
+ *  at 3 Mbaud and reports how long the kernel buffer was full. Without flow control, a real UART
+ *  would have dropped data during that time. Built with and without reader thread.
+ */
+
+#define _DEFAULT_SOURCE
+#define _XOPEN_SOURCE 600
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "btstack_config.h"
+#include "btstack_debug.h"
+#include "btstack_run_loop.h"
+#include "btstack_run_loop_posix.h"
+#include "btstack_uart_block.h"
+#include "hci_dump.h"
+
+#define BYTES_PER_SECOND    300000      // 3 Mbaud
+#define TOTAL_BYTES         1200000
+#define WORK_INTERVAL_BYTES 300000      // simulate heavy processing every x bytes
+#define WORK_DURATION_MS    300
+
+static const btstack_uart_block_t * uart_driver;
+static btstack_timer_source_t done_timer;
+static pid_t    sender_pid;
+static uint8_t  block[300];
+static uint16_t block_len;
+static uint32_t bytes_received;
+static uint32_t next_work;
+static uint32_t random_state = 1;
+
+static inline uint8_t stream_byte(uint32_t pos){
+    return (uint8_t) (pos ^ (pos >> 8) ^ (pos >> 17));
+}
+
+static uint64_t now_us(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+static void sender_run(int fd){
+    fcntl(fd, F_SETFL, O_NONBLOCK);
+    uint8_t chunk[4096];
+    uint32_t bytes_sent = 0;
+    uint32_t buffer_full = 0;
+    uint64_t stalled_us = 0;
+    uint64_t start = now_us();
+    while (bytes_sent < TOTAL_BYTES){
+        uint64_t now = now_us();
+        uint32_t bytes_due = (uint32_t) ((now - start) * BYTES_PER_SECOND / 1000000);
+        if (bytes_due > TOTAL_BYTES) bytes_due = TOTAL_BYTES;
+        if (bytes_due <= bytes_sent){
+            usleep(500);
+            continue;
+        }
+        uint32_t len = bytes_due - bytes_sent;
+        if (len > sizeof(chunk)) len = sizeof(chunk);
+        uint32_t i;
+        for (i = 0; i < len; i++){
+            chunk[i] = stream_byte(bytes_sent + i);
+        }
+        ssize_t written = write(fd, chunk, len);
+        if (written < 0 && errno != EAGAIN){
+            printf("sender: write failed\n");
+            exit(1);
+        }
+        if (written > 0){
+            bytes_sent += (uint32_t) written;
+        }
+        if (written == (ssize_t) len) continue;
+
+        // kernel buffer full, wait until receiver reads again
+        buffer_full++;
+        struct pollfd pfd = { fd, POLLOUT, 0 };
+        uint64_t stall_start = now_us();
+        poll(&pfd, 1, 1000);
+        stalled_us += now_us() - stall_start;
+    }
+    // wait for receiver
+    usleep(500000);
+    printf("  sender: kernel buffer full %u times, stalled %u ms -> %u bytes lost without flow control\n",
+        buffer_full, (unsigned int) (stalled_us / 1000), (unsigned int) (stalled_us * BYTES_PER_SECOND / 1000000));
+    exit(0);
+}
+
+static void busy_wait_ms(uint32_t ms){
+    uint64_t end = now_us() + ms * 1000;
+    while (now_us() < end);
+}
+
+static void done_handler(btstack_timer_source_t * ts){
+    (void) ts;
+    btstack_uart_posix_reader_stats_t stats;
+    btstack_uart_block_posix_get_reader_stats(&stats);
+    uart_driver->close();
+    int status;
+    waitpid(sender_pid, &status, 0);
+#ifdef ENABLE_POSIX_UART_READER_THREAD
+    printf("  receiver: %u bytes verified, reader thread: %u wakeups, ring buffer full %u times, max used %u bytes\n",
+        bytes_received, stats.wakeups, stats.ring_buffer_full, stats.ring_buffer_max_used);
+#else
+    printf("  receiver: %u bytes verified\n", bytes_received);
+#endif
+    exit((WIFEXITED(status) && WEXITSTATUS(status) == 0) ? 0 : 1);
+}
+
+static void receive_next_block(void){
+    // mix of small header reads and larger payload reads like H4
+    block_len = 1 + ((random_state = random_state * 1103515245 + 12345) >> 16) % sizeof(block);
+    if (block_len > TOTAL_BYTES - bytes_received){
+        block_len = TOTAL_BYTES - bytes_received;
+    }
+    uart_driver->receive_block(block, block_len);
+}
+
+static void block_received(void){
+    int i;
+    for (i = 0; i < block_len; i++){
+        if (block[i] != stream_byte(bytes_received + i)){
+            printf("data mismatch at %u\n", bytes_received + i);
+            exit(1);
+        }
+    }
+    bytes_received += block_len;
+
+    if (bytes_received >= next_work){
+        next_work += WORK_INTERVAL_BYTES;
+        busy_wait_ms(WORK_DURATION_MS);
+    }
+
+    if (bytes_received == TOTAL_BYTES){
+        btstack_run_loop_set_timer_handler(&done_timer, &done_handler);
+        btstack_run_loop_set_timer(&done_timer, 1);
+        btstack_run_loop_add_timer(&done_timer);
+        return;
+    }
+    receive_next_block();
+}
+
+int main(void){
+#ifdef ENABLE_POSIX_UART_READER_THREAD
+    printf("UART receive with reader thread, %u bytes at %u bytes/s, %u ms busy every %u bytes\n",
+        TOTAL_BYTES, BYTES_PER_SECOND, WORK_DURATION_MS, WORK_INTERVAL_BYTES);
+#else
+    printf("UART receive on run loop, %u bytes at %u bytes/s, %u ms busy every %u bytes\n",
+        TOTAL_BYTES, BYTES_PER_SECOND, WORK_DURATION_MS, WORK_INTERVAL_BYTES);
+#endif
+    fflush(stdout);
+
+    int master_fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master_fd < 0 || grantpt(master_fd) || unlockpt(master_fd)){
+        printf("pty setup failed\n");
+        return 1;
+    }
+    struct termios toptions;
+    tcgetattr(master_fd, &toptions);
+    cfmakeraw(&toptions);
+    tcsetattr(master_fd, TCSANOW, &toptions);
+    const char * slave_name = ptsname(master_fd);
+
+    btstack_run_loop_init(btstack_run_loop_posix_get_instance());
+    hci_dump_enable_log_level(LOG_LEVEL_INFO, 0);
+
+    static btstack_uart_config_t config = {
+        3000000,
+        0,
+        NULL,
+    };
+    config.device_name = slave_name;
+    uart_driver = btstack_uart_block_posix_instance();
+    uart_driver->init(&config);
+    uart_driver->set_block_received(&block_received);
+    if (uart_driver->open()){
+        printf("open %s failed\n", slave_name);
+        return 1;
+    }
+
+    sender_pid = fork();
+    if (sender_pid == 0){
+        sender_run(master_fd);
+    }
+
+    next_work = WORK_INTERVAL_BYTES;
+    receive_next_block();
+
+    // limit test duration
+    alarm(30);
+    btstack_run_loop_execute();
+    return 0;
+}
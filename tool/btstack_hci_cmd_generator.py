@@ -0,0 +1,236 @@
+#!/usr/bin/env python
+# BlueKitchen GmbH (c) 2017
+
+# generates fixed-layout HCI command encoders from the hci_cmd_t definitions in src/hci_cmd.c
+
+import re
+import sys
+import os
+
+program_info = """
+BTstack HCI Command Encoder Generator for BTstack
+Copyright 2017, BlueKitchen GmbH
+"""
+
+copyright = """/*
+ * Copyright (C) 2017 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+"""
+
+hfile_header_begin = """
+
+/*
+ *  hci_cmd_encoder.h
+ *
+ *  @brief Fixed-layout encoders for HCI Commands
+ *  @note  Don't edit - generated by tool/btstack_hci_cmd_generator.py
+ *
+ *  hci_cmd_encode_NAME(packet, ...) stores command hci_NAME into packet and returns its size.
+ *  hci_send_NAME(...) sends it like hci_send_cmd(&hci_NAME, ...) without parsing the format string.
+ */
+
+#ifndef __HCI_CMD_ENCODER_H
+#define __HCI_CMD_ENCODER_H
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+#include "bluetooth.h"
+#include "btstack_util.h"
+#include "hci.h"
+#include <stdint.h>
+#include <string.h>
+
+#define HCI_CMD_ENCODER_OPCODE(ogf, ocf) ((ocf) | ((ogf) << 10))
+
+/* API_START */
+
+"""
+
+hfile_header_end = """
+/* API_END */
+
+#if defined __cplusplus
+}
+#endif
+
+#endif // __HCI_CMD_ENCODER_H
+"""
+
+encoder_template = """/**
+ * @brief Store HCI command {cmd_name} into packet
+ * @param packet buffer of at least {size} bytes{param_docs}
+ * @return size of command packet
+ * @note: btstack_type {format}
+ */
+static inline uint16_t hci_cmd_encode_{name}(uint8_t * packet{params}){{
+    little_endian_store_16(packet, 0, HCI_CMD_ENCODER_OPCODE({ogf}, {ocf}));
+    packet[2] = {param_size};
+{code}    return {size};
+}}
+
+/**
+ * @brief Send HCI command {cmd_name}
+ * @return 1 if command was sent, 0 if outgoing packet buffer is occupied or controller cannot receive command now
+ */
+static inline int hci_send_{name}({send_params}){{
+    uint8_t * packet = hci_reserve_cmd_packet_buffer(HCI_CMD_ENCODER_OPCODE({ogf}, {ocf}));
+    if (!packet) return 0;
+    return hci_send_cmd_packet(packet, hci_cmd_encode_{name}(packet{args}));
+}}
+
+"""
+
+param_types = {
+    '1' : 'uint8_t',
+    '2' : 'uint16_t',
+    '3' : 'uint32_t',
+    '4' : 'uint32_t',
+    'H' : 'hci_con_handle_t',
+    'B' : 'const uint8_t *',
+    'D' : 'const uint8_t *',
+    'E' : 'const uint8_t *',
+    'N' : 'const char *',
+    'P' : 'const uint8_t *',
+    'A' : 'const uint8_t *',
+    'Q' : 'const uint8_t *',
+}
+
+param_sizes = { '1' : 1, '2' : 2, '3' : 3, '4' : 4, 'H' : 2, 'B' : 6, 'D' : 8, 'E' : 240, 'N' : 248, 'P' : 16, 'A' : 31, 'Q' : 32 }
+
+param_store = {
+    '1' : 'packet[{offset}] = {name};',
+    '2' : 'little_endian_store_16(packet, {offset}, {name});',
+    '3' : 'little_endian_store_16(packet, {offset}, {name});\n    packet[{offset}+2] = {name} >> 16;',
+    '4' : 'little_endian_store_32(packet, {offset}, {name});',
+    'H' : 'little_endian_store_16(packet, {offset}, {name});',
+    'B' : 'reverse_bd_addr({name}, &packet[{offset}]);',
+    'D' : 'memcpy(&packet[{offset}], {name}, 8);',
+    'E' : 'memcpy(&packet[{offset}], {name}, 240);',
+    'N' : 'strncpy((char *) &packet[{offset}], {name}, 248);',
+    'P' : 'memcpy(&packet[{offset}], {name}, 16);',
+    'A' : 'memcpy(&packet[{offset}], {name}, 31);',
+    'Q' : 'reverse_bytes({name}, &packet[{offset}], 32);',
+}
+
+# parameter types that hci_cmd.c only supports if the feature is enabled
+param_guards = {
+    'A' : 'ENABLE_BLE',
+    'Q' : 'ENABLE_LE_SECURE_CONNECTIONS',
+}
+
+# header is also included from C++ code, so C++ keywords cannot be used either. packet is used by the encoders
+reserved_names = ['auto', 'bool', 'char', 'class', 'const', 'default', 'delete', 'int', 'long', 'new', 'packet', 'private',
+              'protected', 'public', 'short', 'signed', 'static', 'template', 'this', 'unsigned', 'void']
+
+def param_names_for_format(params, format):
+    names = [re.sub('\W', '_', param.lower()) for param in params]
+    valid = len(names) == len(format) and len(set(names)) == len(names)
+    for name in names:
+        if name in reserved_names or not re.match('[a-z_]\w*$', name):
+            valid = False
+    if valid:
+        return names
+    return ['arg%u' % (i+1) for i in range(len(format))]
+
+def parse_commands(path):
+    commands = []
+    params = []
+    cmd_name = None
+    with open (path, 'rt') as fin:
+        for line in fin:
+            parts = re.match('.*@param\s*(\w*)', line)
+            if parts:
+                params.append(parts.groups()[0])
+                continue
+            declaration = re.match('const\s+hci_cmd_t\s+(\w+)[\s=]+', line)
+            if declaration:
+                cmd_name = declaration.groups()[0]
+                continue
+            definition = re.match('\s*OPCODE\s*\(\s*(\w+)\s*,\s*(\w+)\s*\)\s*,\s*"(\w*)"', line)
+            if definition and cmd_name:
+                (ogf, ocf, format) = definition.groups()
+                commands.append((cmd_name, ogf, ocf, format, param_names_for_format(params, format)))
+                cmd_name = None
+                params = []
+    return commands
+
+def create_encoder(cmd_name, ogf, ocf, format, names):
+    for f in format:
+        if not f in param_types:
+            print("// %s: format %s not supported, use hci_send_cmd" % (cmd_name, format))
+            return ''
+    offset = 3
+    code = ''
+    param_docs = ''
+    params = ''
+    for f, name in zip(format, names):
+        code += '    ' + param_store[f].format(offset=offset, name=name) + '\n'
+        param_docs += '\n * @param %s' % name
+        params += ', %s %s' % (param_types[f], name)
+        offset += param_sizes[f]
+    send_params = params[2:]
+    if send_params == '':
+        send_params = 'void'
+    args = ''.join([', ' + name for name in names])
+    guards = []
+    for f in format:
+        if f in param_guards and not param_guards[f] in guards:
+            guards.append(param_guards[f])
+    encoder = encoder_template.format(cmd_name=cmd_name.upper(), name=cmd_name[len('hci_'):], ogf=ogf, ocf=ocf, format=format,
+        size=offset, param_size=offset-3, code=code, param_docs=param_docs, params=params, send_params=send_params, args=args)
+    if not guards:
+        return encoder
+    return ''.join(['#ifdef %s\n' % guard for guard in guards]) + encoder.rstrip('\n') + '\n' + '#endif\n' * len(guards) + '\n'
+
+def create_encoders(commands, gen_path):
+    with open(gen_path, 'wt') as fout:
+        fout.write(copyright)
+        fout.write(hfile_header_begin)
+        for cmd_name, ogf, ocf, format, names in commands:
+            fout.write(create_encoder(cmd_name, ogf, ocf, format, names))
+        fout.write(hfile_header_end)
+
+btstack_root = os.path.abspath(os.path.dirname(sys.argv[0]) + '/..')
+gen_path = btstack_root + '/src/hci_cmd_encoder.h'
+
+print(program_info)
+
+commands = parse_commands(btstack_root + '/src/hci_cmd.c')
+create_encoders(commands, gen_path)
+
+print('Done!')
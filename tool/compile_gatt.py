@@ -22,12 +22,15 @@ header = '''
 // attribute size in bytes (16), flags(16), handle (16), uuid (16/128), value(...)
 
 #include <stdint.h>
-
+{2}
 const uint8_t profile_data[] =
 '''
 
 usage = '''
-Usage: ./compile_gatt.py profile.gatt profile.h
+Usage: ./compile_gatt.py [--dispatch-table] profile.gatt profile.h
+
+  --dispatch-table  also emit attribute offsets and read/write handlers for dynamic attributes,
+                    see att_set_db_offsets and att_set_db_dispatch_table in ble/att_db.h
 '''
 
 
@@ -98,6 +101,9 @@ defines_for_services = []
 handle = 1
 total_size = 0
 
+# bytes of profile_data, used for --dispatch-table
+profile_bytes = []
+
 def read_defines(infile):
     defines = dict()
     with open (infile, 'rt') as fin:
@@ -156,13 +162,16 @@ def parseProperties(properties):
 
 def write_8(fout, value):
     fout.write( "0x%02x, " % (value & 0xff))
+    profile_bytes.append(value & 0xff)
 
 def write_16(fout, value):
     fout.write('0x%02x, 0x%02x, ' % (value & 0xff, (value >> 8) & 0xff))
+    profile_bytes.extend([value & 0xff, (value >> 8) & 0xff])
 
 def write_uuid(uuid):
     for byte in uuid:
         fout.write( "0x%02x, " % byte)
+        profile_bytes.append(byte)
 
 def write_string(fout, text):
     for l in text.lstrip('"').rstrip('"'):
@@ -172,6 +181,7 @@ def write_sequence(fout, text):
     parts = text.split()
     for part in parts:
         fout.write("0x%s, " % (part.strip()))
+        profile_bytes.append(int(part.strip(), 16))
 
 def write_indent(fout):
     fout.write("    ")
@@ -290,7 +300,7 @@ def parseCharacteristic(fout, parts):
     uuid       = parseUUID(parts[1])
     uuid_size  = len(uuid)
     properties = parseProperties(parts[2])
-    value = ', '.join([str(x) for x in parts[3:]])
+    value = ', '.join([str(x) for x in parts[3:4]])
 
     # reliable writes is defined in an extended properties
     if (properties & property_flags['RELIABLE_WRITE']):
@@ -671,11 +681,14 @@ def parseLines(fname_in, fin, fout):
 
             print("WARNING: unknown token: %s\n" % (parts[0]))
 
-def parse(fname_in, fin, fname_out, fout):
+def parse(fname_in, fin, fname_out, fout, dispatch_table):
     global handle
     global total_size
     
-    fout.write(header.format(fname_out, fname_in))
+    includes = ''
+    if dispatch_table:
+        includes = '#include "ble/att_db.h"\n'
+    fout.write(header.format(fname_out, fname_in, includes))
     fout.write('{\n')
     
     parseLines(fname_in, fin, fout)
@@ -706,6 +719,78 @@ def listHandles(fout):
         fout.write(define)
         fout.write('\n')
 
+def listDispatchTable(fout):
+    # walk generated profile_data: size (16), flags (16), handle (16), ...
+    offsets = []
+    dynamic_attributes = []
+    pos = 0
+    while True:
+        size = profile_bytes[pos] | (profile_bytes[pos+1] << 8)
+        if size == 0:
+            break
+        flags  = profile_bytes[pos+2] | (profile_bytes[pos+3] << 8)
+        attribute_handle = profile_bytes[pos+4] | (profile_bytes[pos+5] << 8)
+        if attribute_handle != len(offsets) + 1:
+            print("ERROR: handle 0x%04x not in sequence" % attribute_handle)
+            sys.exit(1)
+        offsets.append(pos)
+        if flags & property_flags['DYNAMIC']:
+            dynamic_attributes.append((attribute_handle, flags))
+        pos += size
+
+    # names of dynamic attributes from handle defines, e.g. GAP_DEVICE_NAME_01_VALUE
+    names = dict()
+    for define in defines_for_characteristics:
+        parts = re.match('#define ATT_CHARACTERISTIC_(\w+)_HANDLE 0x(\w+)', define)
+        names[int(parts.group(2), 16)] = parts.group(1).lower()
+
+    fout.write('\n')
+    fout.write('//\n')
+    fout.write('// offset of attributes in profile_data, indexed by handle - 1, see att_set_db_offsets\n')
+    fout.write('//\n')
+    fout.write('const uint16_t profile_data_offsets[] = {\n')
+    for i in range(0, len(offsets), 8):
+        write_indent(fout)
+        fout.write(' '.join(['0x%04x,' % offset for offset in offsets[i:i+8]]))
+        fout.write('\n')
+    fout.write('};\n')
+
+    entries = []
+    fout.write('\n')
+    fout.write('//\n')
+    fout.write('// read and write handlers for dynamic attributes, to be implemented by application, see att_set_db_dispatch_table\n')
+    fout.write('//\n')
+    write_flags = property_flags['WRITE'] | property_flags['WRITE_WITHOUT_RESPONSE'] | property_flags['AUTHENTICATED_SIGNED_WRITE']
+    for (attribute_handle, flags) in dynamic_attributes:
+        if not attribute_handle in names:
+            print("WARNING: dynamic attribute 0x%04x without name, not listed in dispatch table" % attribute_handle)
+            continue
+        read_handler  = '0'
+        write_handler = '0'
+        if flags & property_flags['READ']:
+            read_handler = 'att_characteristic_%s_read' % names[attribute_handle]
+            fout.write('uint16_t %s(hci_con_handle_t con_handle, uint16_t offset, uint8_t * buffer, uint16_t buffer_size);\n' % read_handler)
+            read_handler = '&' + read_handler
+        if flags & write_flags:
+            write_handler = 'att_characteristic_%s_write' % names[attribute_handle]
+            fout.write('int %s(hci_con_handle_t con_handle, uint16_t transaction_mode, uint16_t offset, uint8_t * buffer, uint16_t buffer_size);\n' % write_handler)
+            write_handler = '&' + write_handler
+        entries.append('{ 0x%04x, %s, %s },' % (attribute_handle, read_handler, write_handler))
+    if len(entries) == 0:
+        entries.append('{ 0x0000, 0, 0 },')
+
+    fout.write('\n')
+    fout.write('const att_db_dispatch_entry_t profile_data_dispatch_table[] = {\n')
+    for entry in entries:
+        write_indent(fout)
+        fout.write(entry)
+        fout.write('\n')
+    fout.write('};\n')
+
+dispatch_table = '--dispatch-table' in sys.argv
+if dispatch_table:
+    sys.argv.remove('--dispatch-table')
+
 if (len(sys.argv) < 3):
     print(usage)
     sys.exit(1)
@@ -718,8 +803,10 @@ try:
     filename = sys.argv[2]
     fin  = codecs.open (sys.argv[1], encoding='utf-8')
     fout = open (filename, 'w')
-    parse(sys.argv[1], fin, filename, fout)
+    parse(sys.argv[1], fin, filename, fout, dispatch_table)
     listHandles(fout)    
+    if dispatch_table:
+        listDispatchTable(fout)
     fout.close()
     print('Created %s' % filename)
 